@@ -11,8 +11,6 @@
 
 namespace AK {
 
-// FIXME: There are a lot of raw loops here, that's not necessary an issue but it
-//        has to be verified that the optimizer is able to insert memcpy instead.
 template<size_t Capacity>
 class CircularDuplexStream : public AK::DuplexStream {
 public:
@@ -20,9 +18,10 @@ public:
     {
         const auto nwritten = min(bytes.size(), Capacity - m_queue.size());
 
-        for (size_t idx = 0; idx < nwritten; ++idx)
-            m_queue.enqueue(bytes[idx]);
+        const auto tail_index = (m_queue.head_index() + m_queue.size()) % Capacity;
+        copy_to_storage(bytes.trim(nwritten), tail_index);
 
+        m_queue.m_size += nwritten;
         m_total_written += nwritten;
         return nwritten;
     }
@@ -46,9 +45,10 @@ public:
 
         const auto nread = min(bytes.size(), m_queue.size());
 
-        for (size_t idx = 0; idx < nread; ++idx)
-            bytes[idx] = m_queue.dequeue();
+        copy_from_storage(bytes.trim(nread), m_queue.head_index());
 
+        m_queue.m_head = (m_queue.m_head + nread) % Capacity;
+        m_queue.m_size -= nread;
         return nread;
     }
 
@@ -61,10 +61,7 @@ public:
 
         const auto nread = min(bytes.size(), seekback);
 
-        for (size_t idx = 0; idx < nread; ++idx) {
-            const auto index = (m_total_written - seekback + idx) % Capacity;
-            bytes[idx] = m_queue.m_storage[index];
-        }
+        copy_from_storage(bytes.trim(nread), (m_total_written - seekback) % Capacity);
 
         return nread;
     }
@@ -87,8 +84,8 @@ public:
             return false;
         }
 
-        for (size_t idx = 0; idx < count; ++idx)
-            m_queue.dequeue();
+        m_queue.m_head = (m_queue.m_head + count) % Capacity;
+        m_queue.m_size -= count;
 
         return true;
     }
@@ -114,6 +111,21 @@ public:
     }
 
 private:
+    // These copy between bytes and the storage starting at index, wrapping around the end of the storage if needed.
+    void copy_to_storage(ReadonlyBytes bytes, size_t index)
+    {
+        const auto first_chunk_size = min(bytes.size(), Capacity - index);
+        __builtin_memcpy(m_queue.m_storage + index, bytes.data(), first_chunk_size);
+        __builtin_memcpy(m_queue.m_storage, bytes.data() + first_chunk_size, bytes.size() - first_chunk_size);
+    }
+
+    void copy_from_storage(Bytes bytes, size_t index) const
+    {
+        const auto first_chunk_size = min(bytes.size(), Capacity - index);
+        __builtin_memcpy(bytes.data(), m_queue.m_storage + index, first_chunk_size);
+        __builtin_memcpy(bytes.data() + first_chunk_size, m_queue.m_storage, bytes.size() - first_chunk_size);
+    }
+
     CircularQueue<u8, Capacity> m_queue;
     size_t m_total_written { 0 };
 };
@@ -421,8 +421,11 @@ private:
 
     BucketType& lookup_for_writing(const T& value)
     {
-        if (should_grow())
-            rehash(capacity() * 2);
+        if (should_grow()) {
+            // When most of the used buckets only held values that have since been removed, clearing those out makes
+            // enough room. Otherwise, a table that values keep being added to and removed from would grow forever.
+            rehash(m_deleted_count > m_size ? capacity() : capacity() * 2);
+        }
 
         auto hash = TraitsForT::hash(value);
         BucketType* first_empty_bucket = nullptr;
@@ -16,6 +16,7 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct epoll_event;
 struct pollfd;
 struct timeval;
 struct timespec;
@@ -180,7 +181,11 @@ namespace Kernel {
     S(readv)                      \
     S(emuctl)                     \
     S(statvfs)                    \
-    S(fstatvfs)
+    S(fstatvfs)                   \
+    S(epoll_create)               \
+    S(epoll_ctl)                  \
+    S(epoll_wait)                 \
+    S(sendfile)
 
 namespace Syscall {
 
@@ -265,6 +270,28 @@ struct SC_poll_params {
     const u32* sigmask;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    const struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    const struct timespec* timeout;
+    const u32* sigmask;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    i64* offset;
+    size_t count;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
@@ -121,6 +121,7 @@ class Processor {
     static FPUState s_clean_fpu_state;
     CPUFeature m_features;
     static Atomic<u32> g_total_processors;
+    static bool s_has_fast_string_instructions;
     u8 m_physical_address_bit_width;
 
     ProcessorInfo* m_info;
@@ -427,6 +428,10 @@ public:
         return (static_cast<u32>(m_features) & static_cast<u32>(f)) != 0;
     }
 
+    // Whether the boot processor has ERMS, so that `rep movsb` and `rep stosb` are the fastest way to copy and fill
+    // memory whatever the alignment. Unlike has_feature(), this can be asked before the current processor is set up.
+    ALWAYS_INLINE static bool has_fast_string_instructions() { return s_has_fast_string_instructions; }
+
     void check_invoke_scheduler();
     void invoke_scheduler_async() { m_invoke_scheduler_async = true; }
 
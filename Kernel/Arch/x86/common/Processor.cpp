@@ -32,6 +32,7 @@ READONLY_AFTER_INIT FPUState Processor::s_clean_fpu_state;
 
 READONLY_AFTER_INIT static ProcessorContainer s_processors {};
 READONLY_AFTER_INIT Atomic<u32> Processor::g_total_processors;
+READONLY_AFTER_INIT bool Processor::s_has_fast_string_instructions;
 static volatile bool s_smp_enabled;
 
 static Atomic<ProcessorMessage*> s_message_pool;
@@ -150,6 +151,8 @@ UNMAP_AFTER_INIT void Processor::cpu_detect()
         set_feature(CPUFeature::UMIP);
     if (extended_features.ebx() & (1 << 18))
         set_feature(CPUFeature::RDSEED);
+    if (extended_features.ebx() & (1 << 9))
+        set_feature(CPUFeature::ERMS);
 }
 
 UNMAP_AFTER_INIT void Processor::cpu_setup()
@@ -271,6 +274,8 @@ String Processor::features_string() const
             return "avx";
         case CPUFeature::LM:
             return "lm";
+        case CPUFeature::ERMS:
+            return "erms";
             // no default statement here intentionally so that we get
             // a warning if a new feature is forgotten to be added here
         }
@@ -322,6 +327,9 @@ UNMAP_AFTER_INIT void Processor::early_initialize(u32 cpu)
     cpu_setup();
     gdt_init();
 
+    if (cpu == 0)
+        s_has_fast_string_instructions = has_feature(CPUFeature::ERMS);
+
     VERIFY(is_initialized());   // sanity check
     VERIFY(&current() == this); // sanity check
 }
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AnyOf.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/SpinLock.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Guards the interest sets and ready lists of all EventPolls, and the watch lists of all FileBlockConditions.
+// A watch goes away with either its EventPoll or its FileDescription, and both may be destroyed on any thread,
+// so one lock for everything keeps the teardown simple. It's only held for list manipulation: nothing that could
+// block (like asking a File whether it's ready) happens under it.
+static SpinLock<u8> s_lock;
+
+static constexpr u32 readiness_events = EPOLLIN | EPOLLOUT | EPOLLPRI;
+
+BlockFlags EventPollWatch::block_flags() const
+{
+    auto block_flags = BlockFlags::None;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    return block_flags;
+}
+
+static u32 events_from_block_flags(BlockFlags block_flags)
+{
+    u32 events = 0;
+    if (has_flag(block_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(block_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(block_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    return events;
+}
+
+KResultOr<NonnullRefPtr<EventPoll>> EventPoll::create()
+{
+    auto event_poll = adopt_ref_if_nonnull(new (nothrow) EventPoll);
+    if (event_poll)
+        return event_poll.release_nonnull();
+    return ENOMEM;
+}
+
+EventPoll::~EventPoll()
+{
+    ScopedSpinLock lock(s_lock);
+    for (auto& it : m_watches)
+        unlink(*it.value);
+    m_watches.clear();
+}
+
+bool EventPoll::can_read(const FileDescription&, size_t) const
+{
+    ScopedSpinLock lock(s_lock);
+    return !m_ready_list.is_empty();
+}
+
+void EventPoll::queue_if_enabled(EventPollWatch& watch)
+{
+    VERIFY(s_lock.is_locked());
+    if (!(watch.events & readiness_events) || watch.m_ready_list_node.is_in_list())
+        return;
+    m_ready_list.append(watch);
+}
+
+void EventPoll::unlink(EventPollWatch& watch)
+{
+    VERIFY(s_lock.is_locked());
+    auto& watches = watch.description.block_condition().event_poll_watches({});
+    watches.remove_first_matching([&](auto* entry) { return entry == &watch; });
+    if (watch.m_ready_list_node.is_in_list())
+        m_ready_list.remove(watch);
+}
+
+KResult EventPoll::add(FileDescription& description, u32 events, u64 data)
+{
+    auto new_watch = adopt_own_if_nonnull(new (nothrow) EventPollWatch { *this, description, events, data });
+    if (!new_watch)
+        return ENOMEM;
+
+    {
+        Locker locker(m_lock);
+        ScopedSpinLock lock(s_lock);
+        if (m_watches.contains(&description))
+            return EEXIST;
+
+        auto& watch = *new_watch;
+        if (!description.block_condition().event_poll_watches({}).try_append(&watch))
+            return ENOMEM;
+        m_watches.set(&description, new_watch.release_nonnull());
+
+        // The description may already be ready, which we'd otherwise only notice after its next state change.
+        queue_if_enabled(watch);
+    }
+
+    evaluate_block_conditions();
+    return KSuccess;
+}
+
+KResult EventPoll::modify(FileDescription& description, u32 events, u64 data)
+{
+    {
+        Locker locker(m_lock);
+        ScopedSpinLock lock(s_lock);
+        auto it = m_watches.find(&description);
+        if (it == m_watches.end())
+            return ENOENT;
+
+        auto& watch = *it->value;
+        watch.events = events;
+        watch.data = data;
+        queue_if_enabled(watch);
+    }
+
+    evaluate_block_conditions();
+    return KSuccess;
+}
+
+KResult EventPoll::remove(FileDescription& description)
+{
+    Locker locker(m_lock);
+    ScopedSpinLock lock(s_lock);
+    auto it = m_watches.find(&description);
+    if (it == m_watches.end())
+        return ENOENT;
+
+    unlink(*it->value);
+    m_watches.remove(it);
+    return KSuccess;
+}
+
+size_t EventPoll::collect_events(Span<epoll_event> events)
+{
+    Locker locker(m_lock);
+
+    struct Candidate {
+        EventPollWatch& watch;
+        NonnullRefPtr<FileDescription> description;
+    };
+    Vector<Candidate, 32> candidates;
+    Vector<EventPollWatch*, 32> reported_watches;
+    Vector<EventPollWatch*> requeued_watches;
+    ++m_collection;
+
+    // Watches that turn out not to be ready are dropped from the ready list, so keep going until either the
+    // caller's buffer is full or the list is empty. Watches only go back on the list once we're done, and those
+    // that were queued again by a state change in the meantime are left for the next call, so each watch is
+    // reported at most once.
+    while (reported_watches.size() < events.size()) {
+        size_t first_candidate = candidates.size();
+        {
+            ScopedSpinLock lock(s_lock);
+            while (candidates.size() - first_candidate < events.size() - reported_watches.size()) {
+                auto* watch = m_ready_list.take_first();
+                if (!watch)
+                    break;
+                // Watches we've seen before are kept alive by their candidate entry.
+                if (watch->collection == m_collection) {
+                    requeued_watches.append(watch);
+                    continue;
+                }
+                // A description without references left is about to forget its watches.
+                if (!watch->description.try_ref())
+                    continue;
+                watch->collection = m_collection;
+                candidates.append({ *watch, adopt_ref(watch->description) });
+            }
+        }
+        if (candidates.size() == first_candidate)
+            break;
+
+        // The candidates keep their descriptions alive and m_lock keeps epoll_ctl() out, so their watches stay
+        // around while we ask the Files (which may block) whether they're ready.
+        for (size_t i = first_candidate; i < candidates.size(); ++i) {
+            auto& watch = candidates[i].watch;
+            auto unblock_flags = candidates[i].description->should_unblock(watch.block_flags());
+            if (unblock_flags == BlockFlags::None)
+                continue;
+
+            auto& event = events[reported_watches.size()];
+            event = {};
+            event.events = events_from_block_flags(unblock_flags);
+            event.data.u64 = watch.data;
+            reported_watches.append(&watch);
+        }
+    }
+
+    if (!reported_watches.is_empty() || !requeued_watches.is_empty()) {
+        ScopedSpinLock lock(s_lock);
+        for (auto* watch : reported_watches) {
+            if (watch->events & EPOLLONESHOT)
+                watch->events = 0;
+            else if (!(watch->events & EPOLLET))
+                queue_if_enabled(*watch);
+        }
+        for (auto* watch : requeued_watches)
+            queue_if_enabled(*watch);
+    }
+
+    return reported_watches.size();
+}
+
+void EventPoll::notify_watches(Badge<FileBlockCondition>, FileBlockCondition& condition)
+{
+    Vector<NonnullRefPtr<EventPoll>, 4> event_polls;
+    {
+        ScopedSpinLock lock(s_lock);
+        for (auto* watch : condition.event_poll_watches({})) {
+            auto& event_poll = watch->event_poll;
+            event_poll.queue_if_enabled(*watch);
+
+            if (any_of(event_polls.begin(), event_polls.end(), [&](auto& entry) { return entry.ptr() == &event_poll; }))
+                continue;
+            // An EventPoll without references left has no one waiting on it.
+            if (!event_poll.try_ref())
+                continue;
+            event_polls.append(adopt_ref(event_poll));
+        }
+    }
+
+    for (auto& event_poll : event_polls)
+        event_poll->evaluate_block_conditions();
+}
+
+void EventPoll::forget_description(Badge<FileDescription>, FileDescription& description)
+{
+    ScopedSpinLock lock(s_lock);
+    auto& watches = description.block_condition().event_poll_watches({});
+    for (size_t i = 0; i < watches.size();) {
+        auto& watch = *watches[i];
+        if (&watch.description != &description) {
+            ++i;
+            continue;
+        }
+        auto& event_poll = watch.event_poll;
+        event_poll.unlink(watch);
+        event_poll.m_watches.remove(&description);
+    }
+}
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Span.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/UnixTypes.h>
+
+namespace Kernel {
+
+class EventPoll;
+
+// One description in the interest set of an EventPoll.
+struct EventPollWatch {
+    EventPoll& event_poll;
+    FileDescription& description;
+
+    // EPOLLIN, EPOLLOUT, ... as given to epoll_ctl(), or 0 once a one-shot watch has reported an event.
+    u32 events { 0 };
+    u64 data { 0 };
+
+    // The collect_events() call that last took this watch off the ready list.
+    u64 collection { 0 };
+
+    IntrusiveListNode<EventPollWatch> m_ready_list_node;
+
+    Thread::FileBlocker::BlockFlags block_flags() const;
+};
+
+// The interest set behind epoll_create(), epoll_ctl() and epoll_wait().
+//
+// Each watch is hooked into the FileBlockCondition of the watched File, so every state change that would wake a
+// thread blocked in read(), write() or select() also puts the watch on the ready list of its EventPoll. Waiting
+// only has to look at the watches on that list instead of every description in the set, which is what makes this
+// cheaper than select() and poll() when most descriptions are idle.
+//
+// Whether a watch on the ready list is actually ready is only checked when collecting events. Level-triggered
+// watches that are still ready go back on the list, edge-triggered ones stay off it until the next state change.
+class EventPoll final : public File {
+public:
+    static KResultOr<NonnullRefPtr<EventPoll>> create();
+    virtual ~EventPoll() override;
+
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+
+    virtual String absolute_path(const FileDescription&) const override { return "epoll"; }
+    virtual const char* class_name() const override { return "EventPoll"; }
+    virtual bool is_event_poll() const override { return true; }
+
+    KResult add(FileDescription&, u32 events, u64 data);
+    KResult modify(FileDescription&, u32 events, u64 data);
+    KResult remove(FileDescription&);
+
+    // Fills `events` with the watches that are ready right now and returns how many there were.
+    size_t collect_events(Span<epoll_event> events);
+
+    static void notify_watches(Badge<FileBlockCondition>, FileBlockCondition&);
+    static void forget_description(Badge<FileDescription>, FileDescription&);
+
+private:
+    EventPoll() { }
+
+    void queue_if_enabled(EventPollWatch&);
+    void unlink(EventPollWatch&);
+
+    // Serializes epoll_ctl() and epoll_wait(), so that collect_events() can look at its watches
+    // without holding the spinlock that guards them.
+    Lock m_lock { "EventPoll" };
+
+    HashMap<FileDescription*, NonnullOwnPtr<EventPollWatch>> m_watches;
+    u64 m_collection { 0 };
+    IntrusiveList<EventPollWatch, RawPtr<EventPollWatch>, &EventPollWatch::m_ready_list_node> m_ready_list;
+};
+
+}
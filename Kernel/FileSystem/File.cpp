@@ -5,11 +5,25 @@
  */
 
 #include <AK/StringView.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/FileSystem/FileDescription.h>
 
 namespace Kernel {
 
+void FileBlockCondition::unblock()
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        do_unblock([&](auto& b, void* data, bool&) {
+            VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
+            auto& blocker = static_cast<Thread::FileBlocker&>(b);
+            return blocker.unblock(false, data);
+        });
+    }
+    EventPoll::notify_watches({}, *this);
+}
+
 File::File()
 {
 }
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <AK/Weakable.h>
 #include <Kernel/Forward.h>
 #include <Kernel/KResult.h>
@@ -20,6 +22,7 @@
 namespace Kernel {
 
 class File;
+struct EventPollWatch;
 
 class FileBlockCondition : public Thread::BlockCondition {
 public:
@@ -32,15 +35,13 @@ public:
         return !blocker.unblock(true, data);
     }
 
-    void unblock()
-    {
-        ScopedSpinLock lock(m_lock);
-        do_unblock([&](auto& b, void* data, bool&) {
-            VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
-            auto& blocker = static_cast<Thread::FileBlocker&>(b);
-            return blocker.unblock(false, data);
-        });
-    }
+    void unblock();
+
+    // Guarded by the EventPoll lock, see EventPoll.cpp.
+    Vector<EventPollWatch*>& event_poll_watches(Badge<EventPoll>) { return m_event_poll_watches; }
+
+private:
+    Vector<EventPollWatch*> m_event_poll_watches;
 };
 
 // File is the base class for anything that can be referenced by a FileDescription.
@@ -110,6 +111,7 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_event_poll() const { return false; }
 
     virtual FileBlockCondition& block_condition() { return m_block_condition; }
 
@@ -9,6 +9,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EventPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/FileSystem.h>
@@ -67,6 +68,7 @@ FileDescription::FileDescription(File& file)
 
 FileDescription::~FileDescription()
 {
+    EventPoll::forget_description({}, *this);
     m_file->detach(*this);
     if (is_fifo())
         static_cast<FIFO*>(m_file.ptr())->detach(m_fifo_direction);
@@ -323,6 +325,25 @@ InodeWatcher* FileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool FileDescription::is_event_poll() const
+{
+    return m_file->is_event_poll();
+}
+
+const EventPoll* FileDescription::event_poll() const
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<const EventPoll*>(m_file.ptr());
+}
+
+EventPoll* FileDescription::event_poll()
+{
+    if (!is_event_poll())
+        return nullptr;
+    return static_cast<EventPoll*>(m_file.ptr());
+}
+
 bool FileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
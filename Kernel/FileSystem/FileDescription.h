@@ -81,6 +81,10 @@ public:
     const InodeWatcher* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_event_poll() const;
+    const EventPoll* event_poll() const;
+    EventPoll* event_poll();
+
     bool is_master_pty() const;
     const MasterPTY* master_pty() const;
     MasterPTY* master_pty();
@@ -15,6 +15,7 @@ class Custody;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EventPoll;
 class File;
 class FileDescription;
 class FutexQueue;
@@ -56,6 +56,8 @@ private:
             obj.add("bytes_in", adapter.bytes_in());
             obj.add("packets_out", adapter.packets_out());
             obj.add("bytes_out", adapter.bytes_out());
+            obj.add("packets_dropped", adapter.packets_dropped());
+            obj.add("packet_buffer_allocations", adapter.packet_buffer_allocations());
             obj.add("link_up", adapter.link_up());
             obj.add("mtu", adapter.mtu());
         });
@@ -106,6 +108,8 @@ private:
             obj.add("bytes_in", socket.bytes_in());
             obj.add("packets_out", socket.packets_out());
             obj.add("bytes_out", socket.bytes_out());
+            obj.add("send_window", socket.send_window());
+            obj.add("rtt_ms", socket.smoothed_rtt().to_milliseconds());
         });
         array.finish();
         return true;
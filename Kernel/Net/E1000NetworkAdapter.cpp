@@ -8,6 +8,8 @@
 #include <Kernel/Bus/PCI/IDs.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Net/E1000NetworkAdapter.h>
+#include <Kernel/Net/EtherType.h>
+#include <Kernel/Net/TCP.h>
 #include <Kernel/Sections.h>
 
 namespace Kernel {
@@ -79,6 +81,22 @@ namespace Kernel {
 #define CMD_VLE (1 << 6)  // VLAN Packet Enable
 #define CMD_IDE (1 << 7)  // Interrupt Delay Enable
 
+// Extended Transmit Descriptors
+
+#define CMD_TSE (1 << 2)  // TCP Segmentation Enable
+#define CMD_DEXT (1 << 5) // Descriptor Extension
+
+#define DTYP_CONTEXT (0 << 20)
+#define DTYP_DATA (1 << 20)
+
+#define TUCMD_TCP (1 << 0)  // TCP (rather than UDP) checksum
+#define TUCMD_IP (1 << 1)   // IPv4 (rather than IPv6) packet
+#define TUCMD_TSE (1 << 2)  // TCP Segmentation Enable
+#define TUCMD_DEXT (1 << 5) // Descriptor Extension
+
+#define POPTS_IXSM (1 << 0) // Insert IP Checksum
+#define POPTS_TXSM (1 << 1) // Insert TCP/UDP Checksum
+
 // TCTL Register
 
 #define TCTL_EN (1 << 1)      // Transmit Enable
@@ -181,8 +199,11 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_link()
 
 UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_interrupts()
 {
-    out32(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+    // Each interrupt picks up every packet that arrived since the last one, so throttling bounds the interrupt load
+    // under heavy traffic. 125us is short enough not to run out of receive descriptors in between.
+    out32(REG_INTERRUPT_RATE, 488); // In units of 256ns, so at most 8000 interrupts per second
+    // RXDMT0 fires when half of the receive descriptors are used up, before we'd have to drop packets.
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO | INTERRUPT_RXDMT0 | INTERRUPT_TXDW);
     in32(REG_INTERRUPT_CAUSE_READ);
     enable_irq();
 }
@@ -244,13 +265,10 @@ bool E1000NetworkAdapter::handle_irq(const RegisterState&)
         u32 flags = in32(REG_CTRL);
         out32(REG_CTRL, flags | ECTRL_SLU);
     }
-    if (status & INTERRUPT_RXDMT0) {
-        // Threshold OK?
-    }
     if (status & INTERRUPT_RXO) {
         dbgln_if(E1000_DEBUG, "E1000: RX buffer overrun");
     }
-    if (status & INTERRUPT_RXT0) {
+    if (status & (INTERRUPT_RXT0 | INTERRUPT_RXDMT0 | INTERRUPT_RXO)) {
         receive();
     }
 
@@ -340,13 +358,16 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_tx_descriptors()
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
     for (size_t i = 0; i < number_of_tx_descriptors; ++i) {
         auto& descriptor = tx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 TX buffer", Region::Access::Read | Region::Access::Write);
+        auto region = MM.allocate_contiguous_kernel_region(tx_buffer_size, "E1000 TX buffer", Region::Access::Read | Region::Access::Write);
         VERIFY(region);
         m_tx_buffers_regions.append(region.release_nonnull());
         descriptor.addr = m_tx_buffers_regions[i].physical_page(0)->paddr().get();
         descriptor.cmd = 0;
     }
 
+    // All the 8254x cards we support (82540 and later) can do both.
+    set_capabilities(NetworkAdapterCapabilities::ChecksumOffload | NetworkAdapterCapabilities::TCPSegmentationOffload);
+
     out32(REG_TXDESCLO, m_tx_descriptors_region->physical_page(0)->paddr().get());
     out32(REG_TXDESCHI, 0);
     out32(REG_TXDESCLEN, number_of_tx_descriptors * sizeof(e1000_tx_desc));
@@ -415,40 +436,147 @@ u32 E1000NetworkAdapter::in32(u16 address)
 }
 
 void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    transmit(payload, 0);
+}
+
+void E1000NetworkAdapter::send_raw_tcp_segments(ReadonlyBytes payload, size_t segment_size)
+{
+    transmit(payload, segment_size);
+}
+
+// The card continues the TCP checksum from whatever is in the checksum field, which has to be the sum over
+// the pseudo header.
+static u16 tcp_pseudo_header_sum(const IPv4Packet& ipv4_packet, u16 tcp_length)
+{
+    u32 sum = (u32)IPv4Protocol::TCP + tcp_length;
+    auto* addresses = (const u8*)&ipv4_packet.source();
+    for (size_t i = 0; i < 2 * sizeof(IPv4Address); i += 2)
+        sum += (addresses[i] << 8) | addresses[i + 1];
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return sum;
+}
+
+void E1000NetworkAdapter::transmit(ReadonlyBytes payload, size_t tcp_segment_size)
 {
     disable_irq();
     size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
     dbgln_if(E1000_DEBUG, "E1000: Sending packet ({} bytes)", payload.size());
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    auto& descriptor = tx_descriptors[tx_current];
-    VERIFY(payload.size() <= 8192);
-    auto* vptr = (void*)m_tx_buffers_regions[tx_current].vaddr().as_ptr();
-    memcpy(vptr, payload.data(), payload.size());
-    descriptor.length = payload.size();
-    descriptor.status = 0;
-    descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
-    dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", tx_current, in32(REG_TXDESCHEAD));
-    tx_current = (tx_current + 1) % number_of_tx_descriptors;
+
+    // The card fills in the checksums of IPv4 packets, and the TCP one if there is a TCP header.
+    const size_t ipv4_offset = sizeof(EthernetFrameHeader);
+    bool offload_checksums = false;
+    bool is_tcp = false;
+    size_t tcp_offset = 0;
+    size_t header_size = 0;
+    if (has_capability(NetworkAdapterCapabilities::ChecksumOffload) && payload.size() >= ipv4_offset + sizeof(IPv4Packet)) {
+        auto& eth = *(const EthernetFrameHeader*)payload.data();
+        auto& ipv4_packet = *(const IPv4Packet*)(payload.data() + ipv4_offset);
+        if (eth.ether_type() == EtherType::IPv4 && ipv4_packet.internet_header_length() >= 5) {
+            offload_checksums = true;
+            tcp_offset = ipv4_offset + ipv4_packet.internet_header_length() * sizeof(u32);
+            if (ipv4_packet.protocol() == (u8)IPv4Protocol::TCP && payload.size() >= tcp_offset + sizeof(TCPPacket)) {
+                is_tcp = true;
+                header_size = tcp_offset + ((const TCPPacket*)(payload.data() + tcp_offset))->header_size();
+            }
+        }
+    }
+    VERIFY(!tcp_segment_size || is_tcp);
+
+    // The context descriptor comes first, and the packet is spread over as many data descriptors as it needs.
+    size_t first_data_index = offload_checksums ? (tx_current + 1) % number_of_tx_descriptors : tx_current;
+    size_t data_descriptor_count = max(ceil_div(payload.size(), tx_buffer_size), 1);
+    VERIFY(offload_checksums || data_descriptor_count == 1);
+    VERIFY(data_descriptor_count < number_of_tx_descriptors - 1);
+    for (size_t i = 0; i < data_descriptor_count; ++i) {
+        size_t offset = i * tx_buffer_size;
+        auto* vptr = (void*)m_tx_buffers_regions[(first_data_index + i) % number_of_tx_descriptors].vaddr().as_ptr();
+        memcpy(vptr, payload.data() + offset, min(payload.size() - offset, tx_buffer_size));
+    }
+
+    if (offload_checksums) {
+        // Prepare the headers in our copy the way the card wants them.
+        auto* frame = m_tx_buffers_regions[first_data_index].vaddr().as_ptr();
+        auto& ipv4_packet = *(IPv4Packet*)(frame + ipv4_offset);
+        ipv4_packet.set_checksum(0);
+        // With segmentation, the card fills in the length of each segment in both headers.
+        if (tcp_segment_size)
+            ipv4_packet.set_length(0);
+        if (is_tcp) {
+            auto& tcp_packet = *(TCPPacket*)(frame + tcp_offset);
+            tcp_packet.set_checksum(tcp_pseudo_header_sum(ipv4_packet, tcp_segment_size ? 0 : payload.size() - tcp_offset));
+        }
+
+        auto& context = *(e1000_tx_context_desc*)&tx_descriptors[tx_current];
+        context.ipcss = ipv4_offset;
+        context.ipcso = ipv4_offset + 10;
+        context.ipcse = tcp_offset - 1;
+        context.tucss = is_tcp ? tcp_offset : 0;
+        context.tucso = is_tcp ? tcp_offset + 16 : 0;
+        context.tucse = 0;
+        u32 tucmd = TUCMD_DEXT | TUCMD_IP | (is_tcp ? TUCMD_TCP : 0);
+        u32 payload_length = 0;
+        if (tcp_segment_size) {
+            tucmd |= TUCMD_TSE;
+            payload_length = payload.size() - header_size;
+        }
+        context.paylen_dtyp_tucmd = payload_length | DTYP_CONTEXT | (tucmd << 24);
+        context.status = 0;
+        context.hdrlen = tcp_segment_size ? header_size : 0;
+        context.mss = tcp_segment_size;
+    }
+
+    size_t last_data_index = first_data_index;
+    for (size_t i = 0; i < data_descriptor_count; ++i) {
+        size_t index = (first_data_index + i) % number_of_tx_descriptors;
+        size_t length = min(payload.size() - i * tx_buffer_size, tx_buffer_size);
+        bool is_last = i == data_descriptor_count - 1;
+        auto& descriptor = tx_descriptors[index];
+        // A context descriptor might have taken this slot the last time around.
+        descriptor.addr = m_tx_buffers_regions[index].physical_page(0)->paddr().get();
+        if (offload_checksums) {
+            auto& data = *(e1000_tx_data_desc*)&descriptor;
+            u32 dcmd = CMD_DEXT | CMD_IFCS | (tcp_segment_size ? CMD_TSE : 0) | (is_last ? CMD_EOP | CMD_RS : 0);
+            data.dtalen_dtyp_dcmd = length | DTYP_DATA | (dcmd << 24);
+            data.status = 0;
+            data.popts = POPTS_IXSM | (is_tcp ? POPTS_TXSM : 0);
+            data.special = 0;
+        } else {
+            descriptor.length = length;
+            descriptor.cso = 0;
+            descriptor.css = 0;
+            descriptor.special = 0;
+            descriptor.status = 0;
+            descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+        }
+        last_data_index = index;
+    }
+
+    dbgln_if(E1000_DEBUG, "E1000: Using tx descriptors {} to {} (head is at {})", tx_current, last_data_index, in32(REG_TXDESCHEAD));
+    auto& last_descriptor = tx_descriptors[last_data_index];
+    tx_current = (last_data_index + 1) % number_of_tx_descriptors;
     cli();
     enable_irq();
     out32(REG_TXDESCTAIL, tx_current);
     for (;;) {
-        if (descriptor.status) {
+        if (last_descriptor.status) {
             sti();
             break;
         }
         m_wait_queue.wait_forever("E1000NetworkAdapter");
     }
-    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
+    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)last_descriptor.status);
 }
 
 void E1000NetworkAdapter::receive()
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
+    u32 rx_tail = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
+    size_t packets_received = 0;
     for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
-        rx_current = (rx_current + 1) % number_of_rx_descriptors;
+        u32 rx_current = (rx_tail + 1) % number_of_rx_descriptors;
         if (!(rx_descriptors[rx_current].status & 1))
             break;
         auto* buffer = m_rx_buffers_regions[rx_current].vaddr().as_ptr();
@@ -457,8 +585,12 @@ void E1000NetworkAdapter::receive()
         dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
         did_receive({ buffer, length });
         rx_descriptors[rx_current].status = 0;
-        out32(REG_RXDESCTAIL, rx_current);
+        rx_tail = rx_current;
+        ++packets_received;
     }
+    // Hand all the descriptors back to the card at once, register accesses are slow.
+    if (packets_received > 0)
+        out32(REG_RXDESCTAIL, rx_tail);
 }
 
 }
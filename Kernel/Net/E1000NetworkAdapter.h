@@ -27,6 +27,7 @@ public:
     virtual ~E1000NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_tcp_segments(ReadonlyBytes, size_t segment_size) override;
     virtual bool link_up() override;
 
     virtual const char* purpose() const override { return class_name(); }
@@ -58,6 +59,28 @@ protected:
         volatile uint16_t special { 0 };
     };
 
+    // Sets up checksum offload and TCP segmentation for the data descriptors that follow it.
+    struct [[gnu::packed]] e1000_tx_context_desc {
+        volatile uint8_t ipcss { 0 };
+        volatile uint8_t ipcso { 0 };
+        volatile uint16_t ipcse { 0 };
+        volatile uint8_t tucss { 0 };
+        volatile uint8_t tucso { 0 };
+        volatile uint16_t tucse { 0 };
+        volatile uint32_t paylen_dtyp_tucmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t hdrlen { 0 };
+        volatile uint16_t mss { 0 };
+    };
+
+    struct [[gnu::packed]] e1000_tx_data_desc {
+        volatile uint64_t addr { 0 };
+        volatile uint32_t dtalen_dtyp_dcmd { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t popts { 0 };
+        volatile uint16_t special { 0 };
+    };
+
     virtual void detect_eeprom();
     virtual u32 read_eeprom(u8 address);
     void read_mac_address();
@@ -76,6 +99,7 @@ protected:
     u32 in32(u16 address);
 
     void receive();
+    void transmit(ReadonlyBytes, size_t tcp_segment_size);
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
@@ -89,8 +113,10 @@ protected:
     bool m_use_mmio { false };
     EntropySource m_entropy_source;
 
-    static constexpr size_t number_of_rx_descriptors = 32;
-    static constexpr size_t number_of_tx_descriptors = 8;
+    static constexpr size_t number_of_rx_descriptors = 128;
+    // A packet for TCP segmentation offload takes a context descriptor and up to 8 data descriptors.
+    static constexpr size_t number_of_tx_descriptors = 16;
+    static constexpr size_t tx_buffer_size = 8192;
 
     WaitQueue m_wait_queue;
 };
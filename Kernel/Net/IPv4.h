@@ -11,6 +11,7 @@
 #include <AK/IPv4Address.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <Kernel/Net/InternetChecksum.h>
 
 namespace Kernel {
 
@@ -106,17 +107,9 @@ static_assert(sizeof(IPv4Packet) == 20);
 
 inline NetworkOrdered<u16> internet_checksum(const void* ptr, size_t count)
 {
-    u32 checksum = 0;
-    auto* w = (const u16*)ptr;
-    while (count > 1) {
-        checksum += AK::convert_between_host_and_network_endian(*w++);
-        if (checksum & 0x80000000)
-            checksum = (checksum & 0xffff) | (checksum >> 16);
-        count -= 2;
-    }
-    while (checksum >> 16)
-        checksum = (checksum & 0xffff) + (checksum >> 16);
-    return ~checksum & 0xffff;
+    InternetChecksum checksum;
+    checksum.add({ ptr, count });
+    return checksum.finish();
 }
 
 }
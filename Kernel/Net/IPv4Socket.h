@@ -73,6 +73,8 @@ public:
     };
     BufferMode buffer_mode() const { return m_buffer_mode; }
 
+    static constexpr size_t receive_buffer_size = 256 * KiB;
+
 protected:
     IPv4Socket(int type, int protocol);
     virtual const char* class_name() const override { return "IPv4Socket"; }
@@ -92,6 +94,8 @@ protected:
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
+    size_t receive_buffer_space() const { return m_receive_buffer.space_for_writing(); }
+
 private:
     virtual bool is_ipv4() const override { return true; }
 
@@ -115,7 +119,7 @@ private:
 
     SinglyLinkedListWithCount<ReceivedPacket> m_receive_queue;
 
-    DoubleBuffer m_receive_buffer { 256 * KiB };
+    DoubleBuffer m_receive_buffer { receive_buffer_size };
 
     u16 m_local_port { 0 };
     u16 m_peer_port { 0 };
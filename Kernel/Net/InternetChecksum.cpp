@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <Kernel/Arch/x86/Processor.h>
+#include <Kernel/Net/InternetChecksum.h>
+
+namespace Kernel {
+
+// Below this, setting up the SSE registers costs more than it saves.
+static constexpr size_t minimum_size_for_sse2 = 256;
+static constexpr size_t sse2_block_size = 32;
+
+// Adds up 32-byte blocks as 32-bit words, widened to 64 bits so that they can't overflow.
+//
+// The kernel is built without SSE and doesn't save the SSE registers when entering it, so they still hold whatever
+// userspace left in them. We save the ones we use and put them back afterwards. It doesn't matter if we get
+// preempted in between, since a context switch saves and restores the whole FPU state, including our values.
+static u64 add_blocks_with_sse2(const u8* data, size_t block_count)
+{
+    u8 saved_registers[7 * 16];
+    u64 sums[2];
+    asm volatile(
+        "movdqu %%xmm0, 0(%[saved])\n"
+        "movdqu %%xmm1, 16(%[saved])\n"
+        "movdqu %%xmm2, 32(%[saved])\n"
+        "movdqu %%xmm3, 48(%[saved])\n"
+        "movdqu %%xmm4, 64(%[saved])\n"
+        "movdqu %%xmm5, 80(%[saved])\n"
+        "movdqu %%xmm6, 96(%[saved])\n"
+        "pxor %%xmm0, %%xmm0\n"
+        "pxor %%xmm1, %%xmm1\n"
+        "pxor %%xmm6, %%xmm6\n"
+        "1:\n"
+        "movdqu 0(%[data]), %%xmm2\n"
+        "movdqu 16(%[data]), %%xmm3\n"
+        "movdqa %%xmm2, %%xmm4\n"
+        "movdqa %%xmm3, %%xmm5\n"
+        "punpckldq %%xmm6, %%xmm2\n"
+        "punpckhdq %%xmm6, %%xmm4\n"
+        "punpckldq %%xmm6, %%xmm3\n"
+        "punpckhdq %%xmm6, %%xmm5\n"
+        "paddq %%xmm2, %%xmm0\n"
+        "paddq %%xmm4, %%xmm1\n"
+        "paddq %%xmm3, %%xmm0\n"
+        "paddq %%xmm5, %%xmm1\n"
+        "add $32, %[data]\n"
+        "dec %[block_count]\n"
+        "jnz 1b\n"
+        "paddq %%xmm1, %%xmm0\n"
+        "movdqu %%xmm0, (%[sums])\n"
+        "movdqu 0(%[saved]), %%xmm0\n"
+        "movdqu 16(%[saved]), %%xmm1\n"
+        "movdqu 32(%[saved]), %%xmm2\n"
+        "movdqu 48(%[saved]), %%xmm3\n"
+        "movdqu 64(%[saved]), %%xmm4\n"
+        "movdqu 80(%[saved]), %%xmm5\n"
+        "movdqu 96(%[saved]), %%xmm6\n"
+        : [data] "+r"(data), [block_count] "+r"(block_count)
+        : [saved] "r"(saved_registers), [sums] "r"(sums)
+        : "memory", "cc");
+    return sums[0] + sums[1];
+}
+
+void InternetChecksum::add(ReadonlyBytes bytes)
+{
+    VERIFY(!m_has_odd_size);
+    auto* data = bytes.data();
+    size_t size = bytes.size();
+
+    // Since 2^16 is 1 in one's complement arithmetic, adding up wider words and folding them later gives the
+    // same result as adding up 16-bit words one at a time.
+    if (size >= minimum_size_for_sse2 && Processor::current().has_feature(CPUFeature::SSE2)) {
+        size_t block_count = size / sse2_block_size;
+        m_sum += add_blocks_with_sse2(data, block_count);
+        data += block_count * sse2_block_size;
+        size -= block_count * sse2_block_size;
+    }
+
+    u64 sum = m_sum;
+    for (; size >= 16; data += 16, size -= 16) {
+        sum += ByteReader::load32(data);
+        sum += ByteReader::load32(data + 4);
+        sum += ByteReader::load32(data + 8);
+        sum += ByteReader::load32(data + 12);
+    }
+    for (; size >= 2; data += 2, size -= 2)
+        sum += ByteReader::load16(data);
+    // The odd byte is padded with a zero after it, which makes it the low byte of a word in (little-endian) host
+    // byte order.
+    if (size) {
+        sum += *data;
+        m_has_odd_size = true;
+    }
+    m_sum = sum;
+}
+
+NetworkOrdered<u16> InternetChecksum::finish() const
+{
+    u64 sum = m_sum;
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    // The words we added up were in host byte order, so the result already has its bytes in the order they go
+    // on the wire, and has to be swapped to become the host order value that NetworkOrdered expects.
+    return AK::convert_between_host_and_network_endian(static_cast<u16>(~sum));
+}
+
+}
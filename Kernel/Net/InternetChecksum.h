@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Endian.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// The one's complement sum of RFC 1071, over one or more pieces of data (like the TCP checksum, which covers a
+// pseudo header that isn't part of the packet). All pieces but the last one must have an even size.
+class InternetChecksum {
+public:
+    void add(ReadonlyBytes);
+    NetworkOrdered<u16> finish() const;
+
+private:
+    // The sum is taken over words in host byte order, and only swapped around once at the end (RFC 1071, section 2).
+    u64 m_sum { 0 };
+    bool m_has_odd_size { false };
+};
+
+}
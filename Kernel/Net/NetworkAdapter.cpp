@@ -35,6 +35,22 @@ void NetworkAdapter::send_packet(ReadonlyBytes packet)
     send_raw(packet);
 }
 
+void NetworkAdapter::send_tcp_segments(ReadonlyBytes packet, size_t segment_size)
+{
+    VERIFY(has_capability(NetworkAdapterCapabilities::TCPSegmentationOffload));
+    m_packets_out++;
+    m_bytes_out += packet.size();
+    send_raw_tcp_segments(packet, segment_size);
+}
+
+size_t NetworkAdapter::maximum_ipv4_packet_size() const
+{
+    // The adapter takes care of the length field in each segment, but the packet we give it still has to fit.
+    if (has_capability(NetworkAdapterCapabilities::TCPSegmentationOffload))
+        return NumericLimits<u16>::max();
+    return mtu();
+}
+
 void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet)
 {
     size_t size_in_bytes = sizeof(EthernetFrameHeader) + sizeof(ARPPacket);
@@ -50,7 +66,7 @@ void NetworkAdapter::send(const MACAddress& destination, const ARPPacket& packet
 void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Address const& source_ipv4, MACAddress const& destination_mac, IPv4Address const& destination_ipv4, IPv4Protocol protocol, size_t payload_size, u8 ttl)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    VERIFY(ipv4_packet_size <= mtu());
+    VERIFY(ipv4_packet_size <= maximum_ipv4_packet_size());
 
     size_t ethernet_frame_size = ipv4_payload_offset() + payload_size;
     VERIFY(packet.buffer.size() == ethernet_frame_size);
@@ -68,7 +84,8 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
     ipv4.set_length(sizeof(IPv4Packet) + payload_size);
     ipv4.set_ident(1);
     ipv4.set_ttl(ttl);
-    ipv4.set_checksum(ipv4.compute_checksum());
+    if (!has_capability(NetworkAdapterCapabilities::ChecksumOffload))
+        ipv4.set_checksum(ipv4.compute_checksum());
 }
 
 void NetworkAdapter::did_receive(ReadonlyBytes payload)
@@ -78,72 +95,97 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
     m_bytes_in += payload.size();
 
     if (m_packet_queue_size == max_packet_buffers) {
-        // FIXME: Keep track of the number of dropped packets
+        m_packets_dropped++;
         return;
     }
 
     auto packet = acquire_packet_buffer(payload.size());
     if (!packet) {
         dbgln("Discarding packet because we're out of memory");
+        m_packets_dropped++;
         return;
     }
 
     memcpy(packet->buffer.data(), payload.data(), payload.size());
 
+    bool was_empty = m_packet_queue.is_empty();
     m_packet_queue.append(*packet);
     m_packet_queue_size++;
 
-    if (on_receive)
+    // The network task drains the whole queue once it's awake, so it only needs to hear about the first
+    // packet of a burst.
+    if (was_empty && on_receive)
         on_receive();
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+RefPtr<PacketWithTimestamp> NetworkAdapter::dequeue_packet()
 {
     InterruptDisabler disabler;
     if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
+        return {};
     m_packet_queue_size--;
-    packet_timestamp = packet_with_timestamp->timestamp;
-    auto& packet_buffer = packet_with_timestamp->buffer;
-    size_t packet_size = packet_buffer.size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet_buffer.data(), packet_size);
-    release_packet_buffer(*packet_with_timestamp);
-    return packet_size;
+    return m_packet_queue.take_first();
 }
 
-RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
+size_t NetworkAdapter::packet_buffer_pool_size() const
 {
-    InterruptDisabler disabler;
-    if (m_unused_packets.is_empty()) {
-        auto buffer = KBuffer::create_with_size(size, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
-        auto packet = adopt_ref_if_nonnull(new (nothrow) PacketWithTimestamp { move(buffer), kgettimeofday() });
+    // Every buffer can hold a full frame, so any buffer from the pool will do for any packet.
+    return max(packet_buffer_pool_bytes / page_round_up(packet_buffer_size()), 8);
+}
+
+RefPtr<PacketWithTimestamp> NetworkAdapter::allocate_packet_buffer(size_t size)
+{
+    auto buffer = KBuffer::create_with_size(max(size, packet_buffer_size()), Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
+    if (buffer.is_null())
+        return nullptr;
+    auto packet = adopt_ref_if_nonnull(new (nothrow) PacketWithTimestamp { move(buffer), kgettimeofday() });
+    if (!packet)
+        return nullptr;
+    m_packet_buffer_allocations++;
+    packet->buffer.set_size(size);
+    return packet;
+}
+
+void NetworkAdapter::fill_packet_buffer_pool()
+{
+    auto pool_size = packet_buffer_pool_size();
+    for (;;) {
+        {
+            InterruptDisabler disabler;
+            if (m_unused_packets_size >= pool_size)
+                return;
+        }
+        auto packet = allocate_packet_buffer(0);
         if (!packet)
-            return nullptr;
-        packet->buffer.set_size(size);
-        return packet;
+            return;
+        release_packet_buffer(*packet);
     }
+}
 
-    auto packet = m_unused_packets.take_first();
-    if (packet->buffer.capacity() >= size) {
+RefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
+{
+    InterruptDisabler disabler;
+    // Packets that are larger than a frame (for TCP segmentation offload) get a buffer of their own.
+    if (size <= packet_buffer_size() && !m_unused_packets.is_empty()) {
+        auto packet = m_unused_packets.take_first();
+        m_unused_packets_size--;
         packet->timestamp = kgettimeofday();
         packet->buffer.set_size(size);
         return packet;
     }
 
-    auto buffer = KBuffer::create_with_size(size, Region::Access::Read | Region::Access::Write, "Packet Buffer", AllocationStrategy::AllocateNow);
-    packet = adopt_ref_if_nonnull(new (nothrow) PacketWithTimestamp { move(buffer), kgettimeofday() });
-    if (!packet)
-        return nullptr;
-    packet->buffer.set_size(size);
-    return packet;
+    return allocate_packet_buffer(size);
 }
 
 void NetworkAdapter::release_packet_buffer(PacketWithTimestamp& packet)
 {
     InterruptDisabler disabler;
+    // Hold on to some more than we set aside initially for when lots of packets are in flight, but give the
+    // memory back after an unusually large burst.
+    if (m_unused_packets_size >= 2 * packet_buffer_pool_size() || packet.buffer.capacity() > page_round_up(packet_buffer_size()))
+        return;
     m_unused_packets.append(packet);
+    m_unused_packets_size++;
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/EnumBits.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/MACAddress.h>
@@ -39,6 +40,17 @@ struct PacketWithTimestamp : public RefCounted<PacketWithTimestamp> {
     IntrusiveListNode<PacketWithTimestamp, RefPtr<PacketWithTimestamp>> packet_node;
 };
 
+// Work on outgoing packets that an adapter can do in hardware, so the stack leaves it out.
+enum class NetworkAdapterCapabilities : u8 {
+    None = 0,
+    // Fills in the IPv4 header checksum and the TCP checksum. The stack leaves both at zero.
+    ChecksumOffload = 1 << 0,
+    // Splits a TCP packet with more payload than the segment size into segments (TSO).
+    TCPSegmentationOffload = 1 << 1,
+};
+
+AK_ENUM_BITWISE_OPERATORS(NetworkAdapterCapabilities);
+
 class NetworkAdapter : public RefCounted<NetworkAdapter>
     , public Weakable<NetworkAdapter> {
 public:
@@ -61,20 +73,28 @@ public:
     void send(const MACAddress&, const ARPPacket&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    // The caller hands the packet back with release_packet_buffer() once it's done with it.
+    RefPtr<PacketWithTimestamp> dequeue_packet();
 
     bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
 
+    bool has_capability(NetworkAdapterCapabilities capability) const { return has_flag(m_capabilities, capability); }
+    // With TCP segmentation offload, we can hand down packets that are larger than the MTU.
+    size_t maximum_ipv4_packet_size() const;
+
     u32 packets_in() const { return m_packets_in; }
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 packets_dropped() const { return m_packets_dropped; }
+    u32 packet_buffer_allocations() const { return m_packet_buffer_allocations; }
 
     RefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t);
     void release_packet_buffer(PacketWithTimestamp&);
+    void fill_packet_buffer_pool();
 
     constexpr size_t layer3_payload_offset() const { return sizeof(EthernetFrameHeader); }
     constexpr size_t ipv4_payload_offset() const { return layer3_payload_offset() + sizeof(IPv4Packet); }
@@ -82,6 +102,8 @@ public:
     Function<void()> on_receive;
 
     void send_packet(ReadonlyBytes);
+    // Sends a TCP packet, which the adapter splits into segments with at most `segment_size` bytes of payload.
+    void send_tcp_segments(ReadonlyBytes, size_t segment_size);
 
 protected:
     NetworkAdapter();
@@ -89,6 +111,8 @@ protected:
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     void did_receive(ReadonlyBytes);
     virtual void send_raw(ReadonlyBytes) = 0;
+    virtual void send_raw_tcp_segments(ReadonlyBytes, size_t) { VERIFY_NOT_REACHED(); }
+    void set_capabilities(NetworkAdapterCapabilities capabilities) { m_capabilities = capabilities; }
 
     void set_loopback_name();
 
@@ -98,20 +122,30 @@ private:
     IPv4Address m_ipv4_netmask;
     IPv4Address m_ipv4_gateway;
 
+    RefPtr<PacketWithTimestamp> allocate_packet_buffer(size_t size);
+    size_t packet_buffer_size() const { return layer3_payload_offset() + mtu(); }
+    size_t packet_buffer_pool_size() const;
+
     // FIXME: Make this configurable
     static constexpr size_t max_packet_buffers = 1024;
+    // How much memory to set aside for packet buffers up front, so receiving doesn't have to allocate.
+    static constexpr size_t packet_buffer_pool_bytes = 512 * KiB;
 
     using PacketList = IntrusiveList<PacketWithTimestamp, RefPtr<PacketWithTimestamp>, &PacketWithTimestamp::packet_node>;
 
     PacketList m_packet_queue;
     size_t m_packet_queue_size { 0 };
     PacketList m_unused_packets;
+    size_t m_unused_packets_size { 0 };
     String m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    u32 m_packets_dropped { 0 };
+    u32 m_packet_buffer_allocations { 0 };
     u32 m_mtu { 1500 };
+    NetworkAdapterCapabilities m_capabilities { NetworkAdapterCapabilities::None };
 };
 
 }
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/NonnullRefPtrVector.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/ARP.h>
@@ -24,6 +25,7 @@
 
 namespace Kernel {
 
+static void handle_frame(const u8* frame, size_t frame_size, const Time& packet_timestamp);
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
 static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, const Time& packet_timestamp);
 static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const Time& packet_timestamp);
@@ -36,26 +38,12 @@ static void retransmit_tcp_packets();
 static Thread* network_task = nullptr;
 static HashTable<RefPtr<TCPSocket>>* delayed_ack_sockets;
 
-[[noreturn]] static void NetworkTask_main(void*);
-
-void NetworkTask::spawn()
-{
-    RefPtr<Thread> thread;
-    Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, nullptr);
-    network_task = thread;
-}
-
-bool NetworkTask::is_current()
-{
-    return Thread::current() == network_task;
-}
-
-void NetworkTask_main(void*)
+[[noreturn]] static void NetworkTask_main(void*)
 {
     delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
 
     WaitQueue packet_wait_queue;
-    int pending_packets = 0;
+    NonnullRefPtrVector<NetworkAdapter> adapters;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -65,64 +53,74 @@ void NetworkTask_main(void*)
             adapter.set_ipv4_gateway({ 0, 0, 0, 0 });
         }
 
+        adapter.fill_packet_buffer_pool();
         adapter.on_receive = [&]() {
-            pending_packets++;
             packet_wait_queue.wake_all();
         };
+        adapters.append(adapter);
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
+    // Handle at most this many packets from one adapter before moving on to the next one, so that a busy
+    // adapter can't starve the others or the TCP timers.
+    static constexpr size_t packet_batch_size = 64;
+
+    auto handle_packet_batch = [](NetworkAdapter& adapter) -> size_t {
+        size_t packets_handled = 0;
+        for (; packets_handled < packet_batch_size; ++packets_handled) {
+            auto packet = adapter.dequeue_packet();
+            if (!packet)
+                break;
+            size_t packet_size = packet->buffer.size();
             dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
-        });
-        return packet_size;
+            // The packet is handled right in its buffer, which then goes back to the adapter's pool.
+            handle_frame(packet->buffer.data(), packet_size, packet->timestamp);
+            adapter.release_packet_buffer(*packet);
+        }
+        return packets_handled;
     };
 
-    size_t buffer_size = 64 * KiB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write);
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    Time packet_timestamp;
-
     for (;;) {
+        size_t packets_handled = 0;
+        for (auto& adapter : adapters)
+            packets_handled += handle_packet_batch(adapter);
+
+        // Delayed ACKs for everything in this batch go out together, and the timers are checked once per
+        // batch instead of for every single packet.
         flush_delayed_tcp_acks();
         retransmit_tcp_packets();
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
+
+        if (packets_handled == 0) {
             auto timeout_time = Time::from_milliseconds(500);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
             [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask");
-            continue;
-        }
-        if (packet_size < sizeof(EthernetFrameHeader)) {
-            dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
-            continue;
-        }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
-        dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
-
-        switch (eth.ether_type()) {
-        case EtherType::ARP:
-            handle_arp(eth, packet_size);
-            break;
-        case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
-            break;
-        case EtherType::IPv6:
-            // ignore
-            break;
-        default:
-            dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
         }
     }
 }
 
+void handle_frame(const u8* frame, size_t frame_size, const Time& packet_timestamp)
+{
+    if (frame_size < sizeof(EthernetFrameHeader)) {
+        dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", frame_size);
+        return;
+    }
+    auto& eth = *(const EthernetFrameHeader*)frame;
+    dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), frame_size);
+
+    switch (eth.ether_type()) {
+    case EtherType::ARP:
+        handle_arp(eth, frame_size);
+        break;
+    case EtherType::IPv4:
+        handle_ipv4(eth, frame_size, packet_timestamp);
+        break;
+    case EtherType::IPv6:
+        // ignore
+        break;
+    default:
+        dbgln_if(ETHERNET_DEBUG, "NetworkTask: Unknown ethernet type {:#04x}", eth.ether_type());
+    }
+}
+
 void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
 {
     constexpr size_t minimum_arp_frame_size = sizeof(EthernetFrameHeader) + sizeof(ARPPacket);
@@ -342,6 +340,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     size_t maximum_tcp_header_size = 15 * sizeof(u32);
     if (tcp_packet.header_size() < minimum_tcp_header_size || tcp_packet.header_size() > maximum_tcp_header_size) {
         dbgln("handle_tcp: TCP packet header has invalid size {}", tcp_packet.header_size());
+        return;
     }
 
     if (ipv4_packet.payload_size() < tcp_packet.header_size()) {
@@ -430,6 +429,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->receive_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -443,11 +443,13 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->receive_syn_options(tcp_packet);
             unused_rc = socket->send_ack(true);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->receive_syn_options(tcp_packet);
             unused_rc = socket->send_ack(true);
             socket->set_state(TCPSocket::State::Established);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -21,6 +21,19 @@ struct TCPFlags {
     };
 };
 
+// Sequence numbers wrap around, so they can only be compared relative to each other.
+inline bool tcp_sequence_number_before(u32 a, u32 b) { return static_cast<i32>(a - b) < 0; }
+inline bool tcp_sequence_number_before_or_equal(u32 a, u32 b) { return static_cast<i32>(a - b) <= 0; }
+
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NOP = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -38,6 +51,44 @@ private:
 
 static_assert(sizeof(TCPOptionMSS) == 4);
 
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 value)
+        : m_value(value)
+    {
+    }
+
+    u8 value() const { return m_value; }
+
+private:
+    u8 m_option_kind { 0x03 };
+    u8 m_option_length { sizeof(TCPOptionWindowScale) };
+    u8 m_value;
+};
+
+static_assert(sizeof(TCPOptionWindowScale) == 3);
+
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_option_kind { 0x04 };
+    u8 m_option_length { sizeof(TCPOptionSACKPermitted) };
+};
+
+static_assert(sizeof(TCPOptionSACKPermitted) == 2);
+
+// One block of a SACK option, which tells us the peer has received [left_edge, right_edge) out of order.
+class [[gnu::packed]] TCPSACKBlock {
+public:
+    u32 left_edge() const { return m_left_edge; }
+    u32 right_edge() const { return m_right_edge; }
+
+private:
+    NetworkOrdered<u32> m_left_edge;
+    NetworkOrdered<u32> m_right_edge;
+};
+
+static_assert(sizeof(TCPSACKBlock) == 8);
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -80,6 +131,33 @@ public:
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
+    // Calls `callback(kind, ReadonlyBytes data)` for each option, where `data` excludes the kind and length bytes.
+    // Stops at the end of the option list or at the first malformed option.
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        if (header_size() <= sizeof(TCPPacket))
+            return;
+        auto* options = (const u8*)this + sizeof(TCPPacket);
+        size_t options_size = header_size() - sizeof(TCPPacket);
+        for (size_t offset = 0; offset < options_size;) {
+            auto kind = static_cast<TCPOptionKind>(options[offset]);
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NOP) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= options_size)
+                return;
+            size_t length = options[offset + 1];
+            if (length < 2 || offset + length > options_size)
+                return;
+            callback(kind, ReadonlyBytes { options + offset + 2, length - 2 });
+            offset += length;
+        }
+    }
+
 private:
     NetworkOrdered<u16> m_source_port;
     NetworkOrdered<u16> m_destination_port;
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Net/TCPCongestionControl.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+OwnPtr<TCPCongestionControl> TCPCongestionControl::create(StringView name)
+{
+    if (name == "reno")
+        return adopt_own_if_nonnull(new (nothrow) TCPRenoCongestionControl);
+    if (name == "cubic")
+        return adopt_own_if_nonnull(new (nothrow) TCPCubicCongestionControl);
+    return {};
+}
+
+TCPCongestionControl::TCPCongestionControl()
+{
+    set_maximum_segment_size(m_maximum_segment_size);
+}
+
+void TCPCongestionControl::set_maximum_segment_size(size_t maximum_segment_size)
+{
+    m_maximum_segment_size = maximum_segment_size;
+    // RFC 6928 allows starting out with about ten segments.
+    m_congestion_window = min(10 * maximum_segment_size, max(2 * maximum_segment_size, 14600u));
+}
+
+void TCPCongestionControl::on_partial_ack_in_recovery(size_t acked_bytes)
+{
+    // Take back the inflation for the segments that have now left the network, but leave room for the
+    // retransmission that the partial ACK calls for.
+    m_congestion_window -= min(acked_bytes, m_congestion_window - m_maximum_segment_size);
+    if (acked_bytes >= m_maximum_segment_size)
+        m_congestion_window += m_maximum_segment_size;
+}
+
+size_t TCPCongestionControl::slow_start(size_t acked_bytes)
+{
+    if (m_congestion_window >= m_slow_start_threshold)
+        return acked_bytes;
+
+    // RFC 3465 (Appropriate Byte Counting) with a limit of two segments per ACK, so stretched ACKs
+    // don't make us burst.
+    size_t increase = min(min(acked_bytes, 2 * m_maximum_segment_size), m_slow_start_threshold - m_congestion_window);
+    m_congestion_window += increase;
+    if (m_congestion_window < m_slow_start_threshold)
+        return 0;
+    return acked_bytes - increase;
+}
+
+void TCPRenoCongestionControl::on_ack(size_t acked_bytes, const Time&)
+{
+    acked_bytes = slow_start(acked_bytes);
+    if (acked_bytes == 0)
+        return;
+
+    // One segment for every window's worth of acknowledged data (RFC 5681, section 3.1).
+    m_bytes_acked += acked_bytes;
+    if (m_bytes_acked >= m_congestion_window) {
+        m_bytes_acked -= m_congestion_window;
+        m_congestion_window += m_maximum_segment_size;
+    }
+}
+
+void TCPRenoCongestionControl::on_enter_recovery(size_t flight_size)
+{
+    m_slow_start_threshold = max(flight_size / 2, 2 * m_maximum_segment_size);
+    // The three duplicate ACKs mean three segments have left the network.
+    m_congestion_window = m_slow_start_threshold + 3 * m_maximum_segment_size;
+    m_bytes_acked = 0;
+}
+
+void TCPRenoCongestionControl::on_retransmit_timeout(size_t flight_size)
+{
+    m_slow_start_threshold = max(flight_size / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_maximum_segment_size;
+    m_bytes_acked = 0;
+}
+
+// The kernel can't use the FPU, so the constants of RFC 8312 appear as fractions: beta is 7/10 and C is 4/10.
+// Windows are kept in bytes and times in milliseconds, so C becomes 4/10 * mss bytes per 10^9 ms^3.
+
+// Cube root by the digit-by-digit method, three bits at a time.
+static u64 integer_cube_root(u64 value)
+{
+    u64 root = 0;
+    for (int shift = 63; shift >= 0; shift -= 3) {
+        root *= 2;
+        u64 step = 3 * root * (root + 1) + 1;
+        if ((value >> shift) >= step) {
+            value -= step << shift;
+            ++root;
+        }
+    }
+    return root;
+}
+
+void TCPCubicCongestionControl::reduce_window()
+{
+    // Fast convergence (RFC 8312, section 4.6): If we had to back off before getting back to where the last loss
+    // happened, another flow probably joined, so leave it some room.
+    if (m_congestion_window < m_last_maximum_window)
+        m_last_maximum_window = m_congestion_window * 17 / 20;
+    else
+        m_last_maximum_window = m_congestion_window;
+
+    m_slow_start_threshold = max(m_congestion_window * 7 / 10, 2 * m_maximum_segment_size);
+    m_epoch_start = {};
+    m_bytes_acked = 0;
+}
+
+void TCPCubicCongestionControl::on_enter_recovery(size_t)
+{
+    reduce_window();
+    m_congestion_window = m_slow_start_threshold + 3 * m_maximum_segment_size;
+}
+
+void TCPCubicCongestionControl::on_retransmit_timeout(size_t)
+{
+    reduce_window();
+    m_congestion_window = m_maximum_segment_size;
+}
+
+void TCPCubicCongestionControl::on_ack(size_t acked_bytes, const Time& smoothed_rtt)
+{
+    acked_bytes = slow_start(acked_bytes);
+    if (acked_bytes == 0)
+        return;
+
+    auto now = kgettimeofday();
+    if (m_epoch_start.is_zero()) {
+        m_epoch_start = now;
+        if (m_congestion_window < m_last_maximum_window) {
+            // K is how long it takes the cubic function to get back to the last maximum (RFC 8312, equation 2).
+            m_time_to_origin_in_ms = integer_cube_root(static_cast<u64>(m_last_maximum_window - m_congestion_window) * 2'500'000'000ull / m_maximum_segment_size);
+            m_origin_window = m_last_maximum_window;
+        } else {
+            m_time_to_origin_in_ms = 0;
+            m_origin_window = m_congestion_window;
+        }
+    }
+
+    // Aim for where the cubic function will be one round trip from now (RFC 8312, section 4.1), and never
+    // more than 1.5 times the current window so a long idle period doesn't cause a huge burst.
+    u64 rtt_in_ms = max(smoothed_rtt.to_milliseconds(), 1);
+    u64 time_in_ms = (now - m_epoch_start).to_milliseconds() + rtt_in_ms;
+    u64 offset_in_ms = min(time_in_ms > m_time_to_origin_in_ms ? time_in_ms - m_time_to_origin_in_ms : m_time_to_origin_in_ms - time_in_ms, 100'000ull);
+    u64 delta = offset_in_ms * offset_in_ms * offset_in_ms / 10'000 * 4 * m_maximum_segment_size / 1'000'000;
+    u64 target;
+    if (time_in_ms > m_time_to_origin_in_ms)
+        target = m_origin_window + delta;
+    else
+        target = m_origin_window > delta ? m_origin_window - delta : 0;
+
+    // In the TCP-friendly region, grow at least as fast as Reno would have since the last loss (RFC 8312, section 4.2).
+    u64 reno_window = static_cast<u64>(m_origin_window) * 7 / 10 + 9 * m_maximum_segment_size * time_in_ms / (17 * rtt_in_ms);
+    target = min(max(target, reno_window), m_congestion_window + m_congestion_window / 2);
+
+    // Getting from the current window to the target takes one round trip, so add a segment every time that
+    // fraction of a window has been acknowledged.
+    u64 bytes_per_segment;
+    if (target > m_congestion_window)
+        bytes_per_segment = static_cast<u64>(m_congestion_window) * m_maximum_segment_size / (target - m_congestion_window);
+    else
+        bytes_per_segment = 100 * static_cast<u64>(m_congestion_window);
+
+    m_bytes_acked += acked_bytes;
+    while (m_bytes_acked >= bytes_per_segment) {
+        m_bytes_acked -= bytes_per_segment;
+        m_congestion_window += m_maximum_segment_size;
+    }
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NumericLimits.h>
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+
+namespace Kernel {
+
+// Decides how many bytes a TCPSocket may have in flight. The socket does the bookkeeping (what's acknowledged,
+// what's lost, when to retransmit) and tells the controller about it, so that the controllers only have to deal
+// with growing and shrinking the congestion window.
+class TCPCongestionControl {
+public:
+    static constexpr StringView default_name = "cubic";
+    // Longest name accepted for TCP_CONGESTION, like on other systems.
+    static constexpr size_t maximum_name_length = 16;
+
+    // Returns nullptr if there's no controller with that name, or if we ran out of memory.
+    static OwnPtr<TCPCongestionControl> create(StringView name);
+
+    virtual ~TCPCongestionControl() = default;
+
+    virtual StringView name() const = 0;
+
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t slow_start_threshold() const { return m_slow_start_threshold; }
+    size_t maximum_segment_size() const { return m_maximum_segment_size; }
+
+    // Called once the handshake has told us how large our segments can be. Resets the initial window.
+    void set_maximum_segment_size(size_t);
+
+    // New data was acknowledged outside of loss recovery.
+    virtual void on_ack(size_t acked_bytes, const Time& smoothed_rtt) = 0;
+
+    // Duplicate ACKs told us that a segment was lost while `flight_size` bytes were outstanding.
+    virtual void on_enter_recovery(size_t flight_size) = 0;
+
+    // Every further duplicate ACK means another segment has left the network (RFC 5681, section 3.2).
+    void on_duplicate_ack_in_recovery() { m_congestion_window += m_maximum_segment_size; }
+
+    // Only some of what was outstanding when recovery started got acknowledged (RFC 6582, section 3.2).
+    void on_partial_ack_in_recovery(size_t acked_bytes);
+
+    // Everything that was outstanding when recovery started has been acknowledged.
+    void on_exit_recovery() { m_congestion_window = m_slow_start_threshold; }
+
+    virtual void on_retransmit_timeout(size_t flight_size) = 0;
+
+protected:
+    TCPCongestionControl();
+
+    // Grows the window if we're below the slow start threshold, and returns how many of the acknowledged bytes
+    // are left over for congestion avoidance.
+    size_t slow_start(size_t acked_bytes);
+
+    size_t m_maximum_segment_size { 536 };
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { NumericLimits<size_t>::max() };
+};
+
+// RFC 5681: Grow by one segment per round trip, and halve the window on loss.
+class TCPRenoCongestionControl final : public TCPCongestionControl {
+public:
+    virtual StringView name() const override { return "reno"; }
+
+    virtual void on_ack(size_t acked_bytes, const Time& smoothed_rtt) override;
+    virtual void on_enter_recovery(size_t flight_size) override;
+    virtual void on_retransmit_timeout(size_t flight_size) override;
+
+private:
+    size_t m_bytes_acked { 0 };
+};
+
+// RFC 8312: Grow along a cubic function of the time since the last loss, which quickly gets back to the window
+// where that loss happened and then carefully probes beyond it. That makes it much less dependent on the round
+// trip time than Reno, which takes ages to fill a fast link with a long delay.
+class TCPCubicCongestionControl final : public TCPCongestionControl {
+public:
+    virtual StringView name() const override { return "cubic"; }
+
+    virtual void on_ack(size_t acked_bytes, const Time& smoothed_rtt) override;
+    virtual void on_enter_recovery(size_t flight_size) override;
+    virtual void on_retransmit_timeout(size_t flight_size) override;
+
+private:
+    void reduce_window();
+
+    // The window at the last loss, which the cubic function is centered on.
+    size_t m_last_maximum_window { 0 };
+    // The congestion avoidance epoch started with the first ACK after the last loss.
+    Time m_epoch_start;
+    size_t m_origin_window { 0 };
+    u64 m_time_to_origin_in_ms { 0 };
+    u64 m_bytes_acked { 0 };
+};
+
+}
@@ -21,6 +21,10 @@
 
 namespace Kernel {
 
+// RFC 6298 asks for at least a second, and allows capping the backed off timeout at 60 seconds.
+static constexpr Time minimum_retransmission_timeout = Time::from_seconds(1);
+static constexpr Time maximum_retransmission_timeout = Time::from_seconds(60);
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     Locker locker(sockets_by_tuple().lock(), Lock::Mode::Shared);
@@ -131,8 +135,9 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
     [[maybe_unused]] auto rc = queue_connection_from(*socket);
 }
 
-TCPSocket::TCPSocket(int protocol)
+TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<TCPCongestionControl> congestion_control)
     : IPv4Socket(SOCK_STREAM, protocol)
+    , m_congestion_control(move(congestion_control))
 {
     m_last_retransmit_time = kgettimeofday();
 }
@@ -149,7 +154,10 @@ TCPSocket::~TCPSocket()
 
 KResultOr<NonnullRefPtr<TCPSocket>> TCPSocket::create(int protocol)
 {
-    auto socket = adopt_ref_if_nonnull(new (nothrow) TCPSocket(protocol));
+    auto congestion_control = TCPCongestionControl::create(TCPCongestionControl::default_name);
+    if (!congestion_control)
+        return ENOMEM;
+    auto socket = adopt_ref_if_nonnull(new (nothrow) TCPSocket(protocol, congestion_control.release_nonnull()));
     if (socket)
         return socket.release_nonnull();
     return ENOMEM;
@@ -172,8 +180,24 @@ KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return EHOSTUNREACH;
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    size_t mss = maximum_segment_size(*routing_decision.adapter);
+    size_t window_available;
+    bool has_unacked_data;
+    {
+        Locker locker(m_not_acked_lock, Lock::Mode::Shared);
+        window_available = send_window_available();
+        has_unacked_data = !m_not_acked.is_empty();
+    }
+    // Don't send a tiny segment into a nearly closed window, the ACKs for what's in flight will open it further.
+    if (window_available == 0 || (has_unacked_data && window_available < min(data_length, mss)))
+        return EAGAIN;
+    // With TCP segmentation offload, the adapter cuts large packets into segments for us.
+    size_t packet_payload_size = mss;
+    if (routing_decision.adapter->has_capability(NetworkAdapterCapabilities::TCPSegmentationOffload)) {
+        size_t maximum_payload_size = routing_decision.adapter->maximum_ipv4_packet_size() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+        packet_payload_size = max(maximum_payload_size / mss * mss, mss);
+    }
+    data_length = min(min(data_length, packet_payload_size), window_available);
     int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision);
     if (err < 0)
         return KResult((ErrnoCode)-err);
@@ -195,8 +219,18 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    // When answering a SYN, we may only use the options that the peer offered as well.
+    const bool has_syn_options = flags & TCPFlags::SYN;
+    const bool has_window_scale_option = has_syn_options && (!(flags & TCPFlags::ACK) || m_window_scaling_enabled);
+    const bool has_sack_permitted_option = has_syn_options && (!(flags & TCPFlags::ACK) || m_sack_enabled);
+    size_t options_size = 0;
+    if (has_syn_options)
+        options_size += sizeof(TCPOptionMSS);
+    // The NOPs keep the options (and thus the header) a multiple of four bytes long.
+    if (has_window_scale_option)
+        options_size += 1 + sizeof(TCPOptionWindowScale);
+    if (has_sack_permitted_option)
+        options_size += 2 + sizeof(TCPOptionSACKPermitted);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -210,7 +244,11 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    // The window in SYN segments is never scaled (RFC 7323, section 2.2).
+    u8 window_scale = (flags & TCPFlags::SYN) || !m_window_scaling_enabled ? 0 : receive_window_scale;
+    size_t window = min(receive_buffer_space() >> window_scale, NumericLimits<u16>::max());
+    tcp_packet.set_window_size(window);
+    m_last_advertised_window = window << window_scale;
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -232,22 +270,44 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
+    if (has_syn_options) {
+        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + options_size);
+        auto* options = packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket);
+
         u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
         TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer.size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer.data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        memcpy(options, &mss_option, sizeof(mss_option));
+        options += sizeof(mss_option);
+
+        if (has_window_scale_option) {
+            *options++ = to_underlying(TCPOptionKind::NOP);
+            TCPOptionWindowScale window_scale_option { receive_window_scale };
+            memcpy(options, &window_scale_option, sizeof(window_scale_option));
+            options += sizeof(window_scale_option);
+        }
+
+        if (has_sack_permitted_option) {
+            *options++ = to_underlying(TCPOptionKind::NOP);
+            *options++ = to_underlying(TCPOptionKind::NOP);
+            TCPOptionSACKPermitted sack_permitted_option;
+            memcpy(options, &sack_permitted_option, sizeof(sack_permitted_option));
+        }
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    if (!routing_decision.adapter->has_capability(NetworkAdapterCapabilities::ChecksumOffload))
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
 
-    routing_decision.adapter->send_packet({ packet->buffer.data(), packet->buffer.size() });
+    send_packet_to_adapter(*routing_decision.adapter, *packet, payload_size);
 
     m_packets_out++;
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
         Locker locker(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+        auto now = kgettimeofday();
+        // RFC 6298, section 5.1: Start the retransmission timer unless it's already running.
+        if (m_not_acked.is_empty())
+            m_last_retransmit_time = now;
+        m_not_acked.append({ tcp_packet.sequence_number(), m_sequence_number, move(packet), ipv4_payload_offset, payload_size, *routing_decision.adapter, now });
         m_not_acked_size += payload_size;
         enqueue_for_retransmit();
     } else {
@@ -257,6 +317,16 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     return KSuccess;
 }
 
+void TCPSocket::send_packet_to_adapter(NetworkAdapter& adapter, PacketWithTimestamp& packet, size_t payload_size)
+{
+    ReadonlyBytes bytes { packet.buffer.data(), packet.buffer.size() };
+    size_t mss = maximum_segment_size(adapter);
+    if (payload_size > mss)
+        adapter.send_tcp_segments(bytes, mss);
+    else
+        adapter.send_packet(bytes);
+}
+
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
     if (packet.has_ack()) {
@@ -264,28 +334,72 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
-        int removed = 0;
+        // The window in SYN segments is never scaled (RFC 7323, section 2.2).
+        m_send_window = packet.has_syn() ? packet.window_size() : packet.window_size() << m_send_window_scale;
+
         Locker locker(m_not_acked_lock);
+        if (m_sack_enabled)
+            mark_sacked_segments(packet);
+
+        auto now = kgettimeofday();
+        Optional<Time> rtt_sample;
+        size_t acked_bytes = 0;
+        int removed = 0;
         while (!m_not_acked.is_empty()) {
             auto& packet = m_not_acked.first();
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
 
-            if (packet.ack_number <= ack_number) {
-                auto old_adapter = packet.adapter.strong_ref();
-                if (old_adapter)
-                    old_adapter->release_packet_buffer(*packet.buffer);
-                TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-                auto payload_size = packet.buffer->buffer.data() + packet.buffer->buffer.size() - (u8*)tcp_packet.payload();
-                m_not_acked_size -= payload_size;
-                evaluate_block_conditions();
-                m_not_acked.take_first();
-                removed++;
-            } else {
+            if (!tcp_sequence_number_before_or_equal(packet.ack_number, ack_number))
                 break;
+
+            // Karn's algorithm: We can't tell which transmission an ACK for a retransmitted segment belongs to.
+            if (packet.tx_counter == 0)
+                rtt_sample = now - packet.sent_time;
+
+            auto old_adapter = packet.adapter.strong_ref();
+            if (old_adapter)
+                old_adapter->release_packet_buffer(*packet.buffer);
+            m_not_acked_size -= packet.payload_size;
+            acked_bytes += packet.payload_size;
+            m_not_acked.take_first();
+            removed++;
+        }
+
+        if (rtt_sample.has_value())
+            update_rtt(rtt_sample.value());
+
+        if (removed > 0) {
+            evaluate_block_conditions();
+
+            // RFC 6298, section 5.3: Restart the retransmission timer whenever new data is acknowledged.
+            m_last_retransmit_time = now;
+            m_retransmit_attempts = 0;
+            m_received_duplicate_acks = 0;
+
+            if (!m_in_recovery) {
+                m_congestion_control->on_ack(acked_bytes, m_smoothed_rtt);
+            } else if (!tcp_sequence_number_before(ack_number, m_recovery_point)) {
+                m_in_recovery = false;
+                m_congestion_control->on_exit_recovery();
+            } else {
+                // A partial ACK means the next segment was lost as well (RFC 6582, section 3.2).
+                m_congestion_control->on_partial_ack_in_recovery(acked_bytes);
+                if (!m_not_acked.is_empty())
+                    m_not_acked.first().is_lost = true;
             }
+        } else if (!m_not_acked.is_empty() && ack_number == m_not_acked.first().sequence_number
+            && size == packet.header_size() && !packet.has_syn() && !packet.has_fin()) {
+            // A duplicate ACK (RFC 5681, section 2): The peer got a segment, but it's still missing our oldest one.
+            ++m_received_duplicate_acks;
+            if (m_in_recovery)
+                m_congestion_control->on_duplicate_ack_in_recovery();
+            else if (m_received_duplicate_acks == 3)
+                enter_recovery();
         }
 
+        retransmit_lost_segments();
+
         if (m_not_acked.is_empty()) {
             m_retransmit_attempts = 0;
             dequeue_for_retransmit();
@@ -298,6 +412,164 @@ void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::receive_syn_options(const TCPPacket& packet)
+{
+    VERIFY(packet.has_syn());
+
+    Optional<u8> window_scale;
+    bool sack_permitted = false;
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == 2 && (data[0] || data[1]))
+                m_send_mss = data[0] << 8 | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            // RFC 7323, section 2.3: Larger shifts are treated as 14.
+            if (data.size() == 1)
+                window_scale = min(data[0], 14);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            if (data.size() == 0)
+                sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // Both sides have to send the option for window scaling to be used in either direction (RFC 7323, section 2.2).
+    m_window_scaling_enabled = window_scale.has_value();
+    m_send_window_scale = window_scale.value_or(0);
+    m_sack_enabled = sack_permitted;
+
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (!routing_decision.is_zero())
+        m_congestion_control->set_maximum_segment_size(maximum_segment_size(*routing_decision.adapter));
+}
+
+size_t TCPSocket::maximum_segment_size(const NetworkAdapter& adapter) const
+{
+    return min(adapter.mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_send_mss);
+}
+
+size_t TCPSocket::send_window_available() const
+{
+    size_t window = min(m_congestion_control->congestion_window(), m_send_window);
+    // With nothing in flight, no ACK would tell us when a closed window opens again, so always allow sending
+    // one segment to probe it.
+    if (m_not_acked.is_empty())
+        window = max(window, m_congestion_control->maximum_segment_size());
+    return window > m_not_acked_size ? window - m_not_acked_size : 0;
+}
+
+void TCPSocket::update_rtt(const Time& sample)
+{
+    // RFC 6298, section 2.
+    if (m_smoothed_rtt.is_zero()) {
+        m_smoothed_rtt = sample;
+        m_rtt_variance = Time::from_microseconds(sample.to_microseconds() / 2);
+    } else {
+        i64 smoothed_rtt = m_smoothed_rtt.to_microseconds();
+        i64 deviation = smoothed_rtt - sample.to_microseconds();
+        if (deviation < 0)
+            deviation = -deviation;
+        m_rtt_variance = Time::from_microseconds((3 * m_rtt_variance.to_microseconds() + deviation) / 4);
+        m_smoothed_rtt = Time::from_microseconds((7 * smoothed_rtt + sample.to_microseconds()) / 8);
+    }
+
+    auto timeout = m_smoothed_rtt + Time::from_microseconds(4 * m_rtt_variance.to_microseconds());
+    m_retransmission_timeout = clamp(timeout, minimum_retransmission_timeout, maximum_retransmission_timeout);
+}
+
+void TCPSocket::mark_sacked_segments(const TCPPacket& packet)
+{
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK || data.size() % sizeof(TCPSACKBlock) != 0)
+            return;
+        auto* blocks = reinterpret_cast<const TCPSACKBlock*>(data.data());
+        for (size_t i = 0; i < data.size() / sizeof(TCPSACKBlock); ++i) {
+            for (auto& outgoing_packet : m_not_acked) {
+                if (tcp_sequence_number_before(outgoing_packet.sequence_number, blocks[i].left_edge()))
+                    continue;
+                if (tcp_sequence_number_before(blocks[i].right_edge(), outgoing_packet.ack_number))
+                    break;
+                outgoing_packet.is_sacked = true;
+                outgoing_packet.is_lost = false;
+            }
+        }
+    });
+}
+
+void TCPSocket::enter_recovery()
+{
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) entering fast recovery", this);
+
+    m_in_recovery = true;
+    m_recovery_point = m_sequence_number;
+    m_congestion_control->on_enter_recovery(m_not_acked_size);
+
+    for (auto& packet : m_not_acked)
+        packet.was_retransmitted_in_recovery = false;
+
+    // Fast retransmit doesn't wait for the window (RFC 5681, section 3.2).
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+    auto& packet = m_not_acked.first();
+    retransmit_segment(packet, routing_decision);
+    packet.is_lost = false;
+    packet.was_retransmitted_in_recovery = true;
+}
+
+void TCPSocket::retransmit_lost_segments()
+{
+    // RFC 6675: When the peer SACKs data, everything it's missing below that was most likely lost as well.
+    if (m_in_recovery && m_sack_enabled) {
+        Optional<u32> highest_sacked;
+        for (auto& packet : m_not_acked) {
+            if (packet.is_sacked)
+                highest_sacked = packet.sequence_number;
+        }
+        if (highest_sacked.has_value()) {
+            for (auto& packet : m_not_acked) {
+                if (!tcp_sequence_number_before(packet.sequence_number, highest_sacked.value()))
+                    break;
+                if (!packet.is_sacked && !packet.was_retransmitted_in_recovery)
+                    packet.is_lost = true;
+            }
+        }
+    }
+
+    // Everything that is neither lost nor SACKed is presumably still in the network.
+    size_t bytes_in_flight = 0;
+    bool has_lost_packets = false;
+    for (auto& packet : m_not_acked) {
+        if (packet.is_lost)
+            has_lost_packets = true;
+        else if (!packet.is_sacked)
+            bytes_in_flight += packet.payload_size;
+    }
+    if (!has_lost_packets)
+        return;
+
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+
+    for (auto& packet : m_not_acked) {
+        if (!packet.is_lost)
+            continue;
+        if (bytes_in_flight > 0 && bytes_in_flight + packet.payload_size > m_congestion_control->congestion_window())
+            break;
+        retransmit_segment(packet, routing_decision);
+        packet.is_lost = false;
+        if (m_in_recovery)
+            packet.was_retransmitted_in_recovery = true;
+        bytes_in_flight += packet.payload_size;
+    }
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -326,33 +598,11 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
 
     PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, packet.header_size() + payload_size };
 
-    u32 checksum = 0;
-    auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
-    for (size_t i = 0; i < sizeof(pseudo_header) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    w = (const NetworkOrdered<u16>*)&packet;
-    for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
     VERIFY(packet.data_offset() * 4 == packet.header_size());
-    w = (const NetworkOrdered<u16>*)packet.payload();
-    for (size_t i = 0; i < payload_size / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    if (payload_size & 1) {
-        u16 expanded_byte = ((const u8*)packet.payload())[payload_size - 1] << 8;
-        checksum += expanded_byte;
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    return ~(checksum & 0xffff);
+    InternetChecksum checksum;
+    checksum.add({ &pseudo_header, sizeof(pseudo_header) });
+    checksum.add({ &packet, packet.header_size() + payload_size });
+    return checksum.finish();
 }
 
 KResult TCPSocket::protocol_bind()
@@ -520,13 +770,12 @@ void TCPSocket::retransmit_packets()
 {
     auto now = kgettimeofday();
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    // According to RFC 6298 and RFC1122 we must do exponential backoff - even for SYN packets.
+    auto retransmit_interval = m_retransmission_timeout;
+    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts && retransmit_interval < maximum_retransmission_timeout; i++)
+        retransmit_interval += retransmit_interval;
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    if (m_last_retransmit_time > now - retransmit_interval)
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
@@ -545,38 +794,59 @@ void TCPSocket::retransmit_packets()
     if (routing_decision.is_zero())
         return;
 
-    Locker locker(m_not_acked_lock, Lock::Mode::Shared);
+    Locker locker(m_not_acked_lock);
+    if (m_not_acked.is_empty())
+        return;
+
+    // Only the first timeout tells us something about the network, further ones for the same data don't shrink
+    // the window again (RFC 5681, section 3.1).
+    if (m_retransmit_attempts == 1)
+        m_congestion_control->on_retransmit_timeout(m_not_acked_size);
+    m_in_recovery = false;
+    m_received_duplicate_acks = 0;
+
+    // Everything in flight is presumably gone, and the peer may have dropped what it SACKed (RFC 2018, section 8).
+    // Resend the oldest segment now, and the rest as the ACKs open the window again.
     for (auto& packet : m_not_acked) {
-        packet.tx_counter++;
-
-        if constexpr (TCP_SOCKET_DEBUG) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
-            dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                local_address(), local_port(),
-                peer_address(), peer_port(),
-                (tcp_packet.has_syn() ? "SYN " : ""),
-                (tcp_packet.has_ack() ? "ACK " : ""),
-                (tcp_packet.has_fin() ? "FIN " : ""),
-                (tcp_packet.has_rst() ? "RST " : ""),
-                tcp_packet.sequence_number(),
-                tcp_packet.ack_number(),
-                packet.tx_counter);
-        }
+        packet.is_sacked = false;
+        packet.is_lost = true;
+    }
+    auto& packet = m_not_acked.first();
+    retransmit_segment(packet, routing_decision);
+    packet.is_lost = false;
+}
 
-        size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-        if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-            // FIXME: Add support for this. This can happen if after a route change
-            // we ended up on another adapter which doesn't have the same layer 2 type
-            // like the previous adapter.
-            VERIFY_NOT_REACHED();
-        }
-        routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-            local_address(), routing_decision.next_hop, peer_address(),
-            IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
-        routing_decision.adapter->send_packet({ packet.buffer->buffer.data(), packet.buffer->buffer.size() });
-        m_packets_out++;
-        m_bytes_out += packet.buffer->buffer.size();
+void TCPSocket::retransmit_segment(OutgoingPacket& packet, const RoutingDecision& routing_decision)
+{
+    packet.tx_counter++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer.data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
     }
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet.buffer->buffer.size() - ipv4_payload_offset, ttl());
+    send_packet_to_adapter(*routing_decision.adapter, *packet.buffer, packet.payload_size);
+    m_packets_out++;
+    m_bytes_out += packet.buffer->buffer.size();
 }
 
 bool TCPSocket::can_write(const FileDescription& file_description, size_t size) const
@@ -587,11 +857,77 @@ bool TCPSocket::can_write(const FileDescription& file_description, size_t size)
     if (m_state == State::SynSent || m_state == State::SynReceived)
         return false;
 
-    if (!file_description.is_blocking())
-        return true;
-
+    // Wait until there's room for a full segment, rather than trickling out tiny ones (RFC 1122, section 4.2.3.4).
     Locker lock(m_not_acked_lock);
-    return m_not_acked_size + size <= m_send_window_size;
+    return m_not_acked.is_empty() || send_window_available() >= m_congestion_control->maximum_segment_size();
+}
+
+KResultOr<size_t> TCPSocket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> addr, Userspace<socklen_t*> addr_length, Time& packet_timestamp)
+{
+    auto nreceived_or_error = IPv4Socket::recvfrom(description, buffer, buffer_length, flags, addr, addr_length, packet_timestamp);
+    if (nreceived_or_error.is_error() || nreceived_or_error.value() == 0)
+        return nreceived_or_error;
+
+    // If we advertised a (nearly) closed window, tell the peer once it has opened again instead of leaving it to
+    // probe for it. To avoid silly window syndrome, only do so once it opened by a full segment or half the
+    // buffer (RFC 1122, section 4.2.3.3).
+    Locker locker(lock());
+    if (m_state == State::Established) {
+        size_t threshold = min(receive_buffer_size / 2, m_congestion_control->maximum_segment_size());
+        if (receive_buffer_space() >= m_last_advertised_window + threshold) {
+            [[maybe_unused]] auto rc = send_ack(true);
+        }
+    }
+    return nreceived_or_error;
+}
+
+KResult TCPSocket::setsockopt(int level, int option, Userspace<const void*> user_value, socklen_t user_value_size)
+{
+    if (level != IPPROTO_TCP)
+        return IPv4Socket::setsockopt(level, option, user_value, user_value_size);
+
+    switch (option) {
+    case TCP_CONGESTION: {
+        auto name = copy_string_from_user(static_ptr_cast<const char*>(user_value), min<size_t>(user_value_size, TCPCongestionControl::maximum_name_length));
+        if (name.is_null())
+            return EFAULT;
+        auto congestion_control = TCPCongestionControl::create(name);
+        if (!congestion_control)
+            return ENOENT;
+
+        Locker locker(lock());
+        Locker not_acked_locker(m_not_acked_lock);
+        congestion_control->set_maximum_segment_size(m_congestion_control->maximum_segment_size());
+        m_congestion_control = congestion_control.release_nonnull();
+        return KSuccess;
+    }
+    default:
+        return ENOPROTOOPT;
+    }
+}
+
+KResult TCPSocket::getsockopt(FileDescription& description, int level, int option, Userspace<void*> value, Userspace<socklen_t*> value_size)
+{
+    if (level != IPPROTO_TCP)
+        return IPv4Socket::getsockopt(description, level, option, value, value_size);
+
+    socklen_t size;
+    if (!copy_from_user(&size, value_size.unsafe_userspace_ptr()))
+        return EFAULT;
+
+    switch (option) {
+    case TCP_CONGESTION: {
+        auto name = m_congestion_control->name();
+        size = min(static_cast<size_t>(size), name.length());
+        if (!copy_to_user(static_ptr_cast<char*>(value), name.characters_without_null_termination(), size))
+            return EFAULT;
+        if (!copy_to_user(value_size, &size))
+            return EFAULT;
+        return KSuccess;
+    }
+    default:
+        return ENOPROTOOPT;
+    }
 }
 
 }
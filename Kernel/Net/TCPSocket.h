@@ -12,6 +12,7 @@
 #include <AK/WeakPtr.h>
 #include <Kernel/KResult.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
@@ -135,9 +136,13 @@ public:
     void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
     u32 duplicate_acks() const { return m_duplicate_acks; }
 
+    u32 send_window() const { return m_send_window; }
+    const Time& smoothed_rtt() const { return m_smoothed_rtt; }
+
     KResult send_ack(bool allow_duplicate = false);
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void receive_syn_options(const TCPPacket&);
 
     bool should_delay_next_ack() const;
 
@@ -158,12 +163,15 @@ public:
     virtual KResult close() override;
 
     virtual bool can_write(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> recvfrom(FileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&) override;
+    virtual KResult setsockopt(int level, int option, Userspace<const void*>, socklen_t) override;
+    virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>) override;
 
 protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
 private:
-    explicit TCPSocket(int protocol);
+    TCPSocket(int protocol, NonnullOwnPtr<TCPCongestionControl>);
     virtual const char* class_name() const override { return "TCPSocket"; }
 
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
@@ -181,6 +189,16 @@ private:
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    struct OutgoingPacket;
+    void retransmit_segment(OutgoingPacket&, const RoutingDecision&);
+    void send_packet_to_adapter(NetworkAdapter&, PacketWithTimestamp&, size_t payload_size);
+    void retransmit_lost_segments();
+    void enter_recovery();
+    void mark_sacked_segments(const TCPPacket&);
+    void update_rtt(const Time& sample);
+    size_t maximum_segment_size(const NetworkAdapter&) const;
+    size_t send_window_available() const;
+
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -195,11 +213,19 @@ private:
     u32 m_bytes_out { 0 };
 
     struct OutgoingPacket {
+        u32 sequence_number { 0 };
         u32 ack_number { 0 };
         RefPtr<PacketWithTimestamp> buffer;
         size_t ipv4_payload_offset;
+        size_t payload_size { 0 };
         WeakPtr<NetworkAdapter> adapter;
+        Time sent_time;
         int tx_counter { 0 };
+        // The peer told us it has this segment, it's just missing something before it.
+        bool is_sacked { false };
+        // Waiting to be sent again as soon as the congestion window allows.
+        bool is_lost { false };
+        bool was_retransmitted_in_recovery { false };
     };
 
     mutable Lock m_not_acked_lock { "TCPSocket unacked packets" };
@@ -216,8 +242,30 @@ private:
     Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
-    u32 m_send_window_size { 64 * KiB };
+    // RFC 6298 estimates the round trip time and derives the retransmission timeout from it.
+    Time m_smoothed_rtt;
+    Time m_rtt_variance;
+    Time m_retransmission_timeout { Time::from_seconds(1) };
+
+    // Negotiated in the SYN segments. Without an MSS option, RFC 1122 says to assume 536 bytes.
+    u16 m_send_mss { 536 };
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    bool m_sack_enabled { false };
+
+    // Our receive buffer is 256 KiB, which needs a shift of 3 to fit the 16-bit window field.
+    static constexpr u8 receive_window_scale = 3;
+    static_assert((receive_buffer_size >> receive_window_scale) <= NumericLimits<u16>::max());
+    u32 m_last_advertised_window { 0 };
+
+    // What the peer is willing to receive, as of its latest ACK.
+    u32 m_send_window { NumericLimits<u16>::max() };
+
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+    u32 m_received_duplicate_acks { 0 };
+    bool m_in_recovery { false };
+    // During fast recovery, this is the sequence number that was next when we noticed the loss.
+    u32 m_recovery_point { 0 };
 };
 
 }
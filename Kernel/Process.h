@@ -297,6 +297,7 @@ public:
     KResultOr<FlatPtr> sys$readv(int fd, Userspace<const struct iovec*> iov, int iov_count);
     KResultOr<FlatPtr> sys$write(int fd, Userspace<const u8*>, size_t);
     KResultOr<FlatPtr> sys$writev(int fd, Userspace<const struct iovec*> iov, int iov_count);
+    KResultOr<FlatPtr> sys$sendfile(Userspace<const Syscall::SC_sendfile_params*>);
     KResultOr<FlatPtr> sys$fstat(int fd, Userspace<stat*>);
     KResultOr<FlatPtr> sys$stat(Userspace<const Syscall::SC_stat_params*>);
     KResultOr<FlatPtr> sys$lseek(int fd, Userspace<off_t*>, int whence);
@@ -315,6 +316,9 @@ public:
     KResultOr<FlatPtr> sys$purge(int mode);
     KResultOr<FlatPtr> sys$select(Userspace<const Syscall::SC_select_params*>);
     KResultOr<FlatPtr> sys$poll(Userspace<const Syscall::SC_poll_params*>);
+    KResultOr<FlatPtr> sys$epoll_create(int flags);
+    KResultOr<FlatPtr> sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*>);
+    KResultOr<FlatPtr> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
     KResultOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
     KResultOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     KResultOr<FlatPtr> sys$chdir(Userspace<const char*>, size_t);
@@ -8,6 +8,7 @@
 #include <AK/MemMem.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <Kernel/Arch/x86/Processor.h>
 #include <Kernel/Arch/x86/SmapDisabler.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/StdLib.h>
@@ -240,8 +241,19 @@ void* memcpy(void* dest_ptr, const void* src_ptr, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
     size_t src = (size_t)src_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && !(src & 0x3) && n >= 12) {
+    // With ERMS, `rep movsb` moves whole cache lines at a time on its own, which beats anything we could do here.
+    if (!Kernel::Processor::has_fast_string_instructions() && n >= 12) {
+        // Start on an aligned destination, so the stores don't straddle words. The loads may still be unaligned,
+        // but those are cheap.
+        if (size_t misalignment = dest & (sizeof(size_t) - 1)) {
+            size_t head = sizeof(size_t) - misalignment;
+            n -= head;
+            asm volatile(
+                "rep movsb\n"
+                : "+S"(src), "+D"(dest), "+c"(head)
+                :
+                : "memory");
+        }
         size_t size_ts = n / sizeof(size_t);
 #if ARCH(I386)
         asm volatile(
@@ -300,8 +312,17 @@ const void* memmem(const void* haystack, size_t haystack_length, const void* nee
 void* memset(void* dest_ptr, int c, size_t n)
 {
     size_t dest = (size_t)dest_ptr;
-    // FIXME: Support starting at an unaligned address.
-    if (!(dest & 0x3) && n >= 12) {
+    // See memcpy() above.
+    if (!Kernel::Processor::has_fast_string_instructions() && n >= 12) {
+        if (size_t misalignment = dest & (sizeof(size_t) - 1)) {
+            size_t head = sizeof(size_t) - misalignment;
+            n -= head;
+            asm volatile(
+                "rep stosb\n"
+                : "+D"(dest), "+c"(head)
+                : "a"(c)
+                : "memory");
+        }
         size_t size_ts = n / sizeof(size_t);
         size_t expanded_c = explode_byte((u8)c);
 #if ARCH(I386)
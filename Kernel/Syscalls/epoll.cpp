@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <AK/Time.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+KResultOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    int fd = m_fds.allocate();
+    if (fd < 0)
+        return fd;
+
+    auto event_poll_or_error = EventPoll::create();
+    if (event_poll_or_error.is_error())
+        return event_poll_or_error.error();
+
+    auto description_or_error = FileDescription::create(*event_poll_or_error.value());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    m_fds[fd].set(description_or_error.release_value(), (flags & EPOLL_CLOEXEC) ? FD_CLOEXEC : 0);
+    m_fds[fd].description()->set_readable(true);
+    return fd;
+}
+
+KResultOr<FlatPtr> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_ctl_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto event_poll_description = fds().file_description(params.epfd);
+    if (!event_poll_description)
+        return EBADF;
+    if (!event_poll_description->is_event_poll())
+        return EINVAL;
+    auto& event_poll = *event_poll_description->event_poll();
+
+    auto description = fds().file_description(params.fd);
+    if (!description)
+        return EBADF;
+    // FIXME: Support watching an EventPoll, which needs loop detection.
+    if (description->is_event_poll())
+        return EINVAL;
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL && !copy_from_user(&event, params.event))
+        return EFAULT;
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        return event_poll.add(*description, event.events, event.data.u64);
+    case EPOLL_CTL_MOD:
+        return event_poll.modify(*description, event.events, event.data.u64);
+    case EPOLL_CTL_DEL:
+        return event_poll.remove(*description);
+    default:
+        return EINVAL;
+    }
+}
+
+KResultOr<FlatPtr> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_wait_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.max_events <= 0)
+        return EINVAL;
+
+    auto description = fds().file_description(params.epfd);
+    if (!description)
+        return EBADF;
+    if (!description->is_event_poll())
+        return EINVAL;
+    auto& event_poll = *description->event_poll();
+
+    Thread::BlockTimeout timeout;
+    bool should_block = true;
+    if (params.timeout) {
+        auto timeout_time = copy_time_from_user(params.timeout);
+        if (!timeout_time.has_value())
+            return EFAULT;
+        timeout = Thread::BlockTimeout(false, &timeout_time.value());
+        should_block = !timeout_time.value().is_zero();
+    }
+
+    auto current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask) {
+        sigset_t sigmask_copy;
+        if (!copy_from_user(&sigmask_copy, params.sigmask))
+            return EFAULT;
+        previous_signal_mask = current_thread->update_signal_mask(sigmask_copy);
+    }
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    // Every description can only be reported once, so there's no need for more room than there are fds.
+    Vector<epoll_event, 64> events;
+    if (!events.try_resize(min(static_cast<size_t>(params.max_events), static_cast<size_t>(fds().max_open()))))
+        return ENOMEM;
+
+    size_t event_count = 0;
+    for (;;) {
+        event_count = event_poll.collect_events(events.span());
+        if (event_count > 0 || !should_block)
+            break;
+
+        // The EventPoll is readable while watches are waiting on its ready list, so this wakes up
+        // as soon as any watched description changes state.
+        auto unblock_flags = BlockFlags::None;
+        if (current_thread->block<Thread::ReadBlocker>(timeout, *description, unblock_flags).was_interrupted())
+            return EINTR;
+        if (!has_flag(unblock_flags, BlockFlags::Read))
+            break;
+    }
+
+    if (event_count > 0 && !copy_to_user(params.events, events.data(), event_count * sizeof(epoll_event)))
+        return EFAULT;
+    return event_count;
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Checked.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// Large enough to fill a socket's send buffer in one go, small enough not to hog memory for every caller.
+static constexpr size_t sendfile_chunk_size = 64 * KiB;
+
+KResultOr<FlatPtr> Process::sys$sendfile(Userspace<const Syscall::SC_sendfile_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_sendfile_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = fds().file_description(params.in_fd);
+    if (!in_description)
+        return EBADF;
+    if (!in_description->is_readable())
+        return EBADF;
+    if (in_description->is_directory())
+        return EISDIR;
+    // We read at explicit offsets, which only makes sense for files that can seek.
+    if (!in_description->file().is_seekable())
+        return EINVAL;
+
+    auto out_description = fds().file_description(params.out_fd);
+    if (!out_description)
+        return EBADF;
+    if (!out_description->is_writable())
+        return EBADF;
+
+    off_t offset = in_description->offset();
+    if (params.offset) {
+        if (!copy_from_user(&offset, params.offset))
+            return EFAULT;
+        if (offset < 0)
+            return EINVAL;
+    }
+
+    if (params.count == 0)
+        return 0;
+
+    auto buffer = KBuffer::try_create_with_size(page_round_up(min(params.count, sendfile_chunk_size)), Region::Access::Read | Region::Access::Write, "sendfile");
+    if (!buffer)
+        return ENOMEM;
+    auto kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data());
+
+    // The data goes from the file straight into the destination (e.g. a socket's send buffer) through a
+    // kernel buffer, so it never has to be copied to and from userspace, and a whole file takes one syscall.
+    size_t total_nsent = 0;
+    KResult error = KSuccess;
+    while (total_nsent < params.count) {
+        size_t chunk_size = min(params.count - total_nsent, buffer->size());
+        if (Checked<off_t>::addition_would_overflow(offset, total_nsent)) {
+            error = EOVERFLOW;
+            break;
+        }
+        auto nread_or_error = in_description->file().read(*in_description, offset + total_nsent, kernel_buffer, chunk_size);
+        if (nread_or_error.is_error()) {
+            error = nread_or_error.error();
+            break;
+        }
+        size_t nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out_description, kernel_buffer, nread);
+        if (nwritten_or_error.is_error()) {
+            error = nwritten_or_error.error();
+            break;
+        }
+        total_nsent += nwritten_or_error.value();
+        if (nwritten_or_error.value() < nread)
+            break;
+    }
+
+    // Like write(), report what we managed to send and only fail if nothing went out at all.
+    if (total_nsent == 0 && error.is_error())
+        return error;
+
+    offset += total_nsent;
+    if (params.offset) {
+        if (!copy_to_user(params.offset, &offset))
+            return EFAULT;
+    } else {
+        auto seek_result = in_description->seek(offset, SEEK_SET);
+        if (seek_result.is_error())
+            return seek_result.error();
+    }
+    return total_nsent;
+}
+
+}
@@ -480,6 +480,32 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLLIN (1u << 0)
+#define EPOLLPRI (1u << 1)
+#define EPOLLOUT (1u << 2)
+#define EPOLLERR (1u << 3)
+#define EPOLLHUP (1u << 4)
+#define EPOLLONESHOT (1u << 30)
+#define EPOLLET (1u << 31)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLL_CLOEXEC 02000000
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event {
+    uint32_t events;
+    epoll_data_t data;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
@@ -535,6 +561,8 @@ enum {
 #define IP_ADD_MEMBERSHIP 4
 #define IP_DROP_MEMBERSHIP 5
 
+#define TCP_CONGESTION 13
+
 struct ucred {
     pid_t pid;
     uid_t uid;
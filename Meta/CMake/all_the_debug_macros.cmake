@@ -103,6 +103,7 @@ set(LOCK_DEBUG ON)
 set(LOCK_RESTORE_DEBUG ON)
 set(LOCK_TRACE_DEBUG ON)
 set(LOOKUPSERVER_DEBUG ON)
+set(LZ4_DEBUG ON)
 set(MALLOC_DEBUG ON)
 set(MARKDOWN_DEBUG ON)
 set(MATROSKA_DEBUG ON)
@@ -139,6 +140,7 @@ set(PTHREAD_DEBUG ON)
 set(PTMX_DEBUG ON)
 set(REACHABLE_DEBUG ON)
 set(REGEX_DEBUG ON)
+set(REQUESTSERVER_DEBUG ON)
 set(RESIZE_DEBUG ON)
 set(RESOURCE_DEBUG ON)
 set(ROUTING_DEBUG ON)
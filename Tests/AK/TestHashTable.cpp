@@ -153,6 +153,29 @@ TEST_CASE(space_reuse)
     EXPECT_EQ(strings.capacity(), capacity);
 }
 
+TEST_CASE(space_reuse_without_collisions)
+{
+    HashTable<int> table;
+
+    // Add a few items to allow it to do initial resizing.
+    EXPECT_EQ(table.set(0), AK::HashSetResult::InsertedNewEntry);
+    for (int i = 1; i < 5; ++i) {
+        EXPECT_EQ(table.set(i), AK::HashSetResult::InsertedNewEntry);
+        EXPECT_EQ(table.remove(i - 1), true);
+    }
+
+    auto capacity = table.capacity();
+
+    // Each value lands in a bucket of its own, so the buckets of removed values only get reused by rehashing.
+    for (int i = 5; i < 100000; ++i) {
+        EXPECT_EQ(table.set(i), AK::HashSetResult::InsertedNewEntry);
+        EXPECT_EQ(table.remove(i - 1), true);
+    }
+
+    EXPECT_EQ(table.size(), 1u);
+    EXPECT_EQ(table.capacity(), capacity);
+}
+
 TEST_CASE(basic_remove)
 {
     HashTable<int> table;
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr size_t region_size = 64 * MiB;
+static constexpr size_t page_size = 4096;
+
+// Sends data through a pipe and reads it back, so the kernel copies it in and out of the pipe buffer.
+// The offsets let us start the copies on unaligned addresses.
+static void copy_through_pipe(size_t total_size, size_t chunk_size, size_t write_offset, size_t read_offset)
+{
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+
+    static u8 out_buffer[16 * KiB + 8];
+    static u8 in_buffer[16 * KiB + 8];
+    for (size_t i = 0; i < chunk_size; ++i)
+        out_buffer[write_offset + i] = i % 251;
+
+    for (size_t copied = 0; copied < total_size; copied += chunk_size) {
+        EXPECT_EQ(write(fds[1], out_buffer + write_offset, chunk_size), static_cast<ssize_t>(chunk_size));
+        EXPECT_EQ(read(fds[0], in_buffer + read_offset, chunk_size), static_cast<ssize_t>(chunk_size));
+    }
+    EXPECT_EQ(memcmp(out_buffer + write_offset, in_buffer + read_offset, chunk_size), 0);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE(unaligned_copies_arrive_intact)
+{
+    for (size_t write_offset = 0; write_offset < 8; ++write_offset) {
+        for (size_t read_offset = 0; read_offset < 8; ++read_offset) {
+            for (size_t chunk_size : { 1, 7, 12, 13, 100, 4095, 4097 })
+                copy_through_pipe(chunk_size, chunk_size, write_offset, read_offset);
+        }
+    }
+}
+
+TEST_CASE(copy_on_write_pages_are_copied)
+{
+    auto* region = static_cast<u8*>(mmap(nullptr, 16 * page_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0));
+    EXPECT_NE(region, MAP_FAILED);
+    for (size_t i = 0; i < 16 * page_size; ++i)
+        region[i] = i % 251;
+
+    pid_t child = fork();
+    EXPECT(child >= 0);
+    if (child == 0) {
+        region[0] = 0xff;
+        _exit(region[1] == 1 && region[page_size * 16 - 1] == (page_size * 16 - 1) % 251 ? 0 : 1);
+    }
+    int status = 0;
+    EXPECT_EQ(waitpid(child, &status, 0), child);
+    EXPECT(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(region[0], 0);
+
+    munmap(region, 16 * page_size);
+}
+
+BENCHMARK_CASE(zero_fill_anonymous_pages)
+{
+    auto* region = static_cast<u8*>(mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0));
+    EXPECT_NE(region, MAP_FAILED);
+    for (size_t offset = 0; offset < region_size; offset += page_size)
+        region[offset] = 1;
+    munmap(region, region_size);
+}
+
+BENCHMARK_CASE(copy_pages_on_write)
+{
+    auto* region = static_cast<u8*>(mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0));
+    EXPECT_NE(region, MAP_FAILED);
+    for (size_t offset = 0; offset < region_size; offset += page_size)
+        region[offset] = 1;
+
+    pid_t child = fork();
+    EXPECT(child >= 0);
+    if (child == 0) {
+        for (size_t offset = 0; offset < region_size; offset += page_size)
+            region[offset] = 2;
+        _exit(0);
+    }
+    int status = 0;
+    EXPECT_EQ(waitpid(child, &status, 0), child);
+    munmap(region, region_size);
+}
+
+BENCHMARK_CASE(aligned_copies_through_pipe)
+{
+    copy_through_pipe(region_size, 16 * KiB, 0, 0);
+}
+
+BENCHMARK_CASE(unaligned_copies_through_pipe)
+{
+    copy_through_pipe(region_size, 16 * KiB, 1, 3);
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static constexpr size_t transfer_size = 16 * MiB;
+
+// Connects a socket to a listener on the loopback interface, and sends data through it to a thread on the
+// other end that checks it arrived intact.
+struct LoopbackTransfer {
+    explicit LoopbackTransfer(const char* congestion_control = nullptr)
+    {
+        int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_NE(listen_fd, -1);
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        socklen_t address_length = sizeof(address);
+        EXPECT_EQ(getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_length), 0);
+        EXPECT_EQ(listen(listen_fd, 1), 0);
+
+        sender_fd = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_NE(sender_fd, -1);
+        if (congestion_control)
+            EXPECT_EQ(setsockopt(sender_fd, IPPROTO_TCP, TCP_CONGESTION, congestion_control, strlen(congestion_control)), 0);
+        EXPECT_EQ(connect(sender_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        receiver_fd = accept(listen_fd, nullptr, nullptr);
+        EXPECT_NE(receiver_fd, -1);
+        close(listen_fd);
+
+        EXPECT_EQ(pthread_create(&receive_thread, nullptr, receive, this), 0);
+    }
+
+    ~LoopbackTransfer()
+    {
+        close(sender_fd);
+        EXPECT_EQ(pthread_join(receive_thread, nullptr), 0);
+        EXPECT_EQ(received, transfer_size);
+        EXPECT(received_intact);
+        close(receiver_fd);
+    }
+
+    static u8 byte_at(size_t offset) { return offset % 251; }
+
+    void send_all()
+    {
+        static u8 buffer[64 * KiB];
+        for (size_t sent = 0; sent < transfer_size;) {
+            size_t chunk_size = min(sizeof(buffer), transfer_size - sent);
+            for (size_t i = 0; i < chunk_size; ++i)
+                buffer[i] = byte_at(sent + i);
+            auto nwritten = write(sender_fd, buffer, chunk_size);
+            EXPECT(nwritten > 0);
+            if (nwritten <= 0)
+                return;
+            sent += nwritten;
+        }
+    }
+
+    static void* receive(void* argument)
+    {
+        auto& transfer = *static_cast<LoopbackTransfer*>(argument);
+        static u8 buffer[64 * KiB];
+        for (;;) {
+            auto nread = read(transfer.receiver_fd, buffer, sizeof(buffer));
+            if (nread <= 0)
+                return nullptr;
+            for (ssize_t i = 0; i < nread; ++i) {
+                if (buffer[i] != byte_at(transfer.received + i))
+                    transfer.received_intact = false;
+            }
+            transfer.received += nread;
+        }
+    }
+
+    int sender_fd { -1 };
+    int receiver_fd { -1 };
+    pthread_t receive_thread;
+    size_t received { 0 };
+    bool received_intact { true };
+};
+
+TEST_CASE(bulk_transfer_arrives_intact)
+{
+    LoopbackTransfer transfer;
+    transfer.send_all();
+}
+
+TEST_CASE(congestion_control_can_be_chosen)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_NE(fd, -1);
+
+    char name[16] {};
+    socklen_t name_length = sizeof(name);
+    EXPECT_EQ(setsockopt(fd, IPPROTO_TCP, TCP_CONGESTION, "reno", 4), 0);
+    EXPECT_EQ(getsockopt(fd, IPPROTO_TCP, TCP_CONGESTION, name, &name_length), 0);
+    EXPECT_EQ(strncmp(name, "reno", 4), 0);
+
+    EXPECT_EQ(setsockopt(fd, IPPROTO_TCP, TCP_CONGESTION, "no such thing", 13), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    close(fd);
+}
+
+BENCHMARK_CASE(bulk_transfer_with_reno)
+{
+    LoopbackTransfer transfer("reno");
+    transfer.send_all();
+}
+
+BENCHMARK_CASE(bulk_transfer_with_cubic)
+{
+    LoopbackTransfer transfer("cubic");
+    transfer.send_all();
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Vector.h>
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int add_watch(int epoll_fd, int fd, u32 events)
+{
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+static int wait_for_events(int epoll_fd, int timeout = 0)
+{
+    epoll_event events[8];
+    return epoll_wait(epoll_fd, events, 8, timeout);
+}
+
+TEST_CASE(level_triggered)
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT_NE(epoll_fd, -1);
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[0], EPOLLIN), 0);
+
+    EXPECT_EQ(wait_for_events(epoll_fd), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    epoll_event events[8];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 8, -1), 1);
+    EXPECT_EQ(events[0].events, EPOLLIN);
+    EXPECT_EQ(events[0].data.fd, pipe_fds[0]);
+
+    // Still readable, so it's reported again.
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+
+    char c;
+    EXPECT_EQ(read(pipe_fds[0], &c, 1), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd), 0);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epoll_fd);
+}
+
+TEST_CASE(edge_triggered)
+{
+    int epoll_fd = epoll_create1(0);
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[0], EPOLLIN | EPOLLET), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+    // Still readable, but nothing changed since.
+    EXPECT_EQ(wait_for_events(epoll_fd), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "y", 1), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epoll_fd);
+}
+
+TEST_CASE(one_shot)
+{
+    int epoll_fd = epoll_create1(0);
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[0], EPOLLIN | EPOLLONESHOT), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+    EXPECT_EQ(write(pipe_fds[1], "y", 1), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd), 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pipe_fds[0], &event), 0);
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epoll_fd);
+}
+
+TEST_CASE(interest_set_changes)
+{
+    int epoll_fd = epoll_create1(0);
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pipe_fds[0], &event), -1);
+    EXPECT_EQ(errno, ENOENT);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe_fds[0], nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[0], EPOLLIN), 0);
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[0], EPOLLIN), -1);
+    EXPECT_EQ(errno, EEXIST);
+    EXPECT_EQ(add_watch(epoll_fd, epoll_fd, EPOLLIN), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    // The write end is always writable.
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[1], EPOLLOUT), 0);
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe_fds[1], nullptr), 0);
+    EXPECT_EQ(wait_for_events(epoll_fd), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(wait_for_events(epoll_fd), 1);
+
+    // Closing the only fd for a description drops it from the interest set.
+    close(pipe_fds[0]);
+    EXPECT_EQ(wait_for_events(epoll_fd), 0);
+
+    close(pipe_fds[1]);
+    close(epoll_fd);
+}
+
+TEST_CASE(wait_times_out)
+{
+    int epoll_fd = epoll_create1(0);
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(add_watch(epoll_fd, pipe_fds[0], EPOLLIN), 0);
+
+    EXPECT_EQ(wait_for_events(epoll_fd, 10), 0);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(epoll_fd);
+}
+
+// One socket pair is busy, while every other fd we can open is an idle socket.
+struct IdleSockets {
+    IdleSockets()
+    {
+        EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, active_fds), 0);
+        long max_open = sysconf(_SC_OPEN_MAX);
+        for (;;) {
+            int fds[2];
+            if (static_cast<long>(idle_fds.size() + 16) >= max_open || socketpair(AF_LOCAL, SOCK_STREAM, 0, fds) < 0)
+                break;
+            idle_fds.append(fds[0]);
+            idle_fds.append(fds[1]);
+        }
+        EXPECT(idle_fds.size() >= 512);
+    }
+
+    ~IdleSockets()
+    {
+        for (auto fd : idle_fds)
+            close(fd);
+        close(active_fds[0]);
+        close(active_fds[1]);
+    }
+
+    void ping()
+    {
+        EXPECT_EQ(write(active_fds[1], "x", 1), 1);
+    }
+
+    void pong()
+    {
+        char c;
+        EXPECT_EQ(read(active_fds[0], &c, 1), 1);
+    }
+
+    int active_fds[2];
+    Vector<int> idle_fds;
+};
+
+static constexpr int round_trips = 1000;
+
+BENCHMARK_CASE(poll_with_idle_sockets)
+{
+    IdleSockets sockets;
+    Vector<pollfd> poll_fds;
+    for (auto fd : sockets.idle_fds)
+        poll_fds.append({ fd, POLLIN, 0 });
+    poll_fds.append({ sockets.active_fds[0], POLLIN, 0 });
+
+    for (int i = 0; i < round_trips; ++i) {
+        sockets.ping();
+        EXPECT_EQ(poll(poll_fds.data(), poll_fds.size(), -1), 1);
+        sockets.pong();
+    }
+}
+
+BENCHMARK_CASE(epoll_with_idle_sockets)
+{
+    IdleSockets sockets;
+    int epoll_fd = epoll_create1(0);
+    for (auto fd : sockets.idle_fds)
+        EXPECT_EQ(add_watch(epoll_fd, fd, EPOLLIN), 0);
+    EXPECT_EQ(add_watch(epoll_fd, sockets.active_fds[0], EPOLLIN), 0);
+
+    epoll_event events[64];
+    for (int i = 0; i < round_trips; ++i) {
+        sockets.ping();
+        EXPECT_EQ(epoll_wait(epoll_fd, events, 64, -1), 1);
+        sockets.pong();
+    }
+    close(epoll_fd);
+}
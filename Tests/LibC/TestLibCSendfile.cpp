@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int create_file(size_t size)
+{
+    char path[] = "/tmp/sendfile.XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_NE(fd, -1);
+    unlink(path);
+
+    char buffer[4096];
+    for (size_t i = 0; i < sizeof(buffer); ++i)
+        buffer[i] = static_cast<char>(i % 251);
+    for (size_t written = 0; written < size;) {
+        auto nwritten = write(fd, buffer, min(sizeof(buffer), size - written));
+        EXPECT(nwritten > 0);
+        written += nwritten;
+    }
+    EXPECT_EQ(lseek(fd, 0, SEEK_SET), 0);
+    return fd;
+}
+
+TEST_CASE(sends_from_the_file_offset)
+{
+    int file_fd = create_file(1000);
+    int sockets[2];
+    EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, sockets), 0);
+
+    EXPECT_EQ(sendfile(sockets[0], file_fd, nullptr, 600), 600);
+    EXPECT_EQ(lseek(file_fd, 0, SEEK_CUR), 600);
+    // Only what's left of the file is sent, and then there's nothing more.
+    EXPECT_EQ(sendfile(sockets[0], file_fd, nullptr, 600), 400);
+    EXPECT_EQ(sendfile(sockets[0], file_fd, nullptr, 600), 0);
+
+    char buffer[1000];
+    size_t nread = 0;
+    while (nread < sizeof(buffer)) {
+        auto rc = read(sockets[1], buffer + nread, sizeof(buffer) - nread);
+        EXPECT(rc > 0);
+        nread += rc;
+    }
+    for (size_t i = 0; i < sizeof(buffer); ++i)
+        EXPECT_EQ(static_cast<u8>(buffer[i]), i % 251);
+
+    close(sockets[0]);
+    close(sockets[1]);
+    close(file_fd);
+}
+
+TEST_CASE(sends_from_an_explicit_offset)
+{
+    int file_fd = create_file(1000);
+    int sockets[2];
+    EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, sockets), 0);
+
+    off_t offset = 300;
+    EXPECT_EQ(sendfile(sockets[0], file_fd, &offset, 100), 100);
+    EXPECT_EQ(offset, 400);
+    // The file offset is left alone.
+    EXPECT_EQ(lseek(file_fd, 0, SEEK_CUR), 0);
+
+    char buffer[100];
+    EXPECT_EQ(read(sockets[1], buffer, sizeof(buffer)), 100);
+    EXPECT_EQ(static_cast<u8>(buffer[0]), 300 % 251);
+
+    close(sockets[0]);
+    close(sockets[1]);
+    close(file_fd);
+}
+
+TEST_CASE(rejects_unseekable_input)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    int sockets[2];
+    EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, sockets), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(sendfile(sockets[0], pipe_fds[0], nullptr, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(sockets[0]);
+    close(sockets[1]);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+// Sends a file through a socket pair, with a thread on the other end throwing the data away.
+struct FileTransfer {
+    static constexpr size_t file_size = 64 * MiB;
+
+    FileTransfer()
+    {
+        file_fd = create_file(file_size);
+        EXPECT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, sockets), 0);
+        EXPECT_EQ(pthread_create(&drain_thread, nullptr, drain, this), 0);
+    }
+
+    ~FileTransfer()
+    {
+        close(sockets[0]);
+        EXPECT_EQ(pthread_join(drain_thread, nullptr), 0);
+        EXPECT_EQ(received, file_size);
+        close(sockets[1]);
+        close(file_fd);
+    }
+
+    static void* drain(void* argument)
+    {
+        auto& transfer = *static_cast<FileTransfer*>(argument);
+        static char buffer[64 * KiB];
+        for (;;) {
+            auto nread = read(transfer.sockets[1], buffer, sizeof(buffer));
+            if (nread <= 0)
+                return nullptr;
+            transfer.received += nread;
+        }
+    }
+
+    int file_fd { -1 };
+    int sockets[2];
+    pthread_t drain_thread;
+    size_t received { 0 };
+};
+
+BENCHMARK_CASE(read_write_loop_into_socket)
+{
+    FileTransfer transfer;
+    char buffer[64 * KiB];
+    for (;;) {
+        auto nread = read(transfer.file_fd, buffer, sizeof(buffer));
+        EXPECT(nread >= 0);
+        if (nread <= 0)
+            break;
+        EXPECT_EQ(write(transfer.sockets[0], buffer, nread), nread);
+    }
+}
+
+BENCHMARK_CASE(sendfile_into_socket)
+{
+    FileTransfer transfer;
+    for (;;) {
+        auto nsent = sendfile(transfer.sockets[0], transfer.file_fd, nullptr, FileTransfer::file_size);
+        EXPECT(nsent >= 0);
+        if (nsent <= 0)
+            break;
+    }
+}
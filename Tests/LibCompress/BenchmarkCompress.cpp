@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/MemoryStream.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/LZ4.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/File.h>
+
+#ifdef __serenity__
+static constexpr auto res_directory = "/res";
+#else
+static constexpr auto res_directory = "../../Base/res";
+#endif
+
+static void append_directory_contents(ByteBuffer& corpus, String const& directory)
+{
+    Core::DirIterator iterator(directory, Core::DirIterator::SkipDots);
+    while (iterator.has_next()) {
+        auto path = iterator.next_full_path();
+        if (Core::File::is_directory(path)) {
+            append_directory_contents(corpus, path);
+            continue;
+        }
+        auto file = Core::File::open(path, Core::OpenMode::ReadOnly);
+        if (!file.is_error())
+            corpus.append(file.value()->read_all());
+    }
+}
+
+// Everything in /res concatenated: a mix of text, fonts, and already-compressed images.
+static ByteBuffer const& res_corpus()
+{
+    static ByteBuffer corpus;
+    if (corpus.is_empty())
+        append_directory_contents(corpus, res_directory);
+    return corpus;
+}
+
+// The decompression benchmarks reuse the output of the compression ones, so they don't measure compression as well.
+static ByteBuffer s_lz4_compressed;
+static ByteBuffer s_deflate_compressed;
+
+static void report(StringView codec, size_t compressed_size)
+{
+    outln("{}: {} -> {} bytes ({}%)", codec, res_corpus().size(), compressed_size, compressed_size * 100 / max<size_t>(res_corpus().size(), 1));
+}
+
+BENCHMARK_CASE(lz4_compress_res)
+{
+    auto compressed = Compress::LZ4Compressor::compress_all(res_corpus());
+    EXPECT(compressed.has_value());
+    report("LZ4", compressed.value().size());
+    s_lz4_compressed = compressed.release_value();
+}
+
+BENCHMARK_CASE(lz4_decompress_res)
+{
+    if (s_lz4_compressed.is_empty())
+        s_lz4_compressed = Compress::LZ4Compressor::compress_all(res_corpus()).release_value();
+    auto decompressed = Compress::LZ4Decompressor::decompress_all(s_lz4_compressed);
+    EXPECT(decompressed.has_value());
+}
+
+BENCHMARK_CASE(deflate_fast_compress_res)
+{
+    auto compressed = Compress::DeflateCompressor::compress_all(res_corpus(), Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed.has_value());
+    report("Deflate (fast)", compressed.value().size());
+    s_deflate_compressed = compressed.release_value();
+}
+
+BENCHMARK_CASE(deflate_decompress_res)
+{
+    if (s_deflate_compressed.is_empty())
+        s_deflate_compressed = Compress::DeflateCompressor::compress_all(res_corpus(), Compress::DeflateCompressor::CompressionLevel::FAST).release_value();
+    auto decompressed = Compress::DeflateDecompressor::decompress_all(s_deflate_compressed);
+    EXPECT(decompressed.has_value());
+}
+
+BENCHMARK_CASE(deflate_decompress_res_streaming)
+{
+    // This is how gunzip and tar read their input, in small chunks through the stream interface.
+    if (s_deflate_compressed.is_empty())
+        s_deflate_compressed = Compress::DeflateCompressor::compress_all(res_corpus(), Compress::DeflateCompressor::CompressionLevel::FAST).release_value();
+
+    InputMemoryStream memory_stream { s_deflate_compressed };
+    Compress::DeflateDecompressor deflate_stream { memory_stream };
+    u8 buffer[4096];
+    size_t total_read = 0;
+    while (!deflate_stream.has_any_error() && !deflate_stream.unreliable_eof())
+        total_read += deflate_stream.read({ buffer, sizeof(buffer) });
+
+    EXPECT(!deflate_stream.handle_any_error());
+    EXPECT_EQ(total_read, res_corpus().size());
+}
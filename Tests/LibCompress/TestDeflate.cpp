@@ -28,7 +28,7 @@ TEST_CASE(canonical_code_simple)
 
     const auto huffman = Compress::CanonicalCode::from_bytes(code).value();
     auto memory_stream = InputMemoryStream { input };
-    auto bit_stream = InputBitStream { memory_stream };
+    auto bit_stream = LittleEndianInputBitStream { memory_stream };
 
     for (size_t idx = 0; idx < 9; ++idx)
         EXPECT_EQ(huffman.read_symbol(bit_stream), output[idx]);
@@ -48,12 +48,40 @@ TEST_CASE(canonical_code_complex)
 
     const auto huffman = Compress::CanonicalCode::from_bytes(code).value();
     auto memory_stream = InputMemoryStream { input };
-    auto bit_stream = InputBitStream { memory_stream };
+    auto bit_stream = LittleEndianInputBitStream { memory_stream };
 
     for (size_t idx = 0; idx < 12; ++idx)
         EXPECT_EQ(huffman.read_symbol(bit_stream), output[idx]);
 }
 
+TEST_CASE(canonical_code_long_codes)
+{
+    // Code lengths 1, 2, ..., 15, 15 form a complete code that needs overflow subtables for the longer codes.
+    Array<u8, 16> code;
+    for (size_t i = 0; i < 15; ++i)
+        code[i] = i + 1;
+    code[15] = 15;
+
+    const auto huffman = Compress::CanonicalCode::from_bytes(code).value();
+
+    DuplexMemoryStream output_stream;
+    OutputBitStream output_bit_stream { output_stream };
+    for (u32 symbol = 0; symbol < 16; ++symbol) {
+        huffman.write_symbol(output_bit_stream, symbol);
+        huffman.write_symbol(output_bit_stream, 15 - symbol);
+    }
+    output_bit_stream.align_to_byte_boundary();
+
+    auto buffer = output_stream.copy_into_contiguous_buffer();
+    auto memory_stream = InputMemoryStream { buffer };
+    auto bit_stream = LittleEndianInputBitStream { memory_stream };
+
+    for (u32 symbol = 0; symbol < 16; ++symbol) {
+        EXPECT_EQ(huffman.read_symbol(bit_stream), symbol);
+        EXPECT_EQ(huffman.read_symbol(bit_stream), 15 - symbol);
+    }
+}
+
 TEST_CASE(deflate_decompress_compressed_block)
 {
     const Array<u8, 28> compressed {
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/Random.h>
+#include <LibCompress/LZ4.h>
+
+TEST_CASE(lz4_decompress_simple)
+{
+    // Produced by the reference implementation, with content size, block and content checksums.
+    const Array<u8, 60> compressed {
+        0x04, 0x22, 0x4d, 0x18, 0x7c, 0x40, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0xeb, 0x1d, 0x00, 0x00, 0x00, 0xa0, 0x77, 0x6f, 0x72, 0x64,
+        0x31, 0x20, 0x61, 0x62, 0x63, 0x20, 0x0a, 0x00, 0x15, 0x32, 0x0a, 0x00,
+        0xb0, 0x31, 0x20, 0x61, 0x62, 0x63, 0x20, 0x77, 0x6f, 0x72, 0x64, 0x32,
+        0x65, 0x79, 0x4f, 0x38, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x2f, 0xce, 0xf0
+    };
+
+    const u8 uncompressed[] = "word1 abc word2 abc word1 abc word2";
+
+    EXPECT(Compress::LZ4Decompressor::is_likely_compressed(compressed));
+    const auto decompressed = Compress::LZ4Decompressor::decompress_all(compressed);
+    EXPECT(decompressed.value().bytes() == (ReadonlyBytes { uncompressed, sizeof(uncompressed) - 1 }));
+}
+
+TEST_CASE(lz4_decompress_corrupted)
+{
+    Array<u8, 60> compressed {
+        0x04, 0x22, 0x4d, 0x18, 0x7c, 0x40, 0x23, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0xeb, 0x1d, 0x00, 0x00, 0x00, 0xa0, 0x77, 0x6f, 0x72, 0x64,
+        0x31, 0x20, 0x61, 0x62, 0x63, 0x20, 0x0a, 0x00, 0x15, 0x32, 0x0a, 0x00,
+        0xb0, 0x31, 0x20, 0x61, 0x62, 0x63, 0x20, 0x77, 0x6f, 0x72, 0x64, 0x32,
+        0x65, 0x79, 0x4f, 0x38, 0x00, 0x00, 0x00, 0x00, 0xfa, 0x2f, 0xce, 0xf0
+    };
+
+    // Point the first match past the start of the output, and truncate the stream.
+    compressed[30] = 0xff;
+    EXPECT(!Compress::LZ4Decompressor::decompress_all(compressed).has_value());
+    EXPECT(!Compress::LZ4Decompressor::decompress_all(ReadonlyBytes { compressed }.trim(40)).has_value());
+}
+
+TEST_CASE(lz4_round_trip_empty)
+{
+    auto compressed = Compress::LZ4Compressor::compress_all({});
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::LZ4Decompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value().is_empty());
+}
+
+TEST_CASE(lz4_round_trip_random)
+{
+    // Random data is incompressible, so this ends up in uncompressed blocks.
+    auto original = ByteBuffer::create_uninitialized(1024);
+    fill_with_random(original.data(), 1024);
+    auto compressed = Compress::LZ4Compressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::LZ4Decompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+TEST_CASE(lz4_round_trip_compress_large)
+{
+    auto size = Compress::LZ4Compressor::block_size * 2 + 1234;
+    auto original = ByteBuffer::create_zeroed(size); // Span multiple blocks and make sure there are long runs and short repeats.
+    for (size_t i = 0; i < size; i += 4096)
+        fill_with_random(original.offset_pointer(i), 1024);
+    for (size_t i = 1024; i < size; i += 4096)
+        original[i] = i & 0xff;
+    auto compressed = Compress::LZ4Compressor::compress_all(original);
+    EXPECT(compressed.has_value());
+    EXPECT(compressed.value().size() < size / 2);
+    auto uncompressed = Compress::LZ4Decompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+TEST_CASE(lz4_block_round_trip)
+{
+    const u8 text[] = "abcabcabcabcabcabcabcabcabcabc abcd abcde abcdef abcdefg abcdefgh abcdefghi";
+    ReadonlyBytes original { text, sizeof(text) - 1 };
+
+    Array<u8, Compress::LZ4Compressor::max_compressed_block_size(sizeof(text))> compressed;
+    auto compressed_size = Compress::LZ4Compressor::compress_block(original, compressed);
+    EXPECT(compressed_size.has_value());
+    EXPECT(compressed_size.value() < original.size());
+
+    Array<u8, sizeof(text)> decompressed;
+    auto decompressed_size = Compress::LZ4Decompressor::decompress_block(compressed.span().trim(compressed_size.value()), decompressed);
+    EXPECT_EQ(decompressed_size.value(), original.size());
+    EXPECT(decompressed.span().trim(original.size()) == original);
+}
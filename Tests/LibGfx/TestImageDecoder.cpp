@@ -79,6 +79,97 @@ TEST_CASE(test_jpg)
     EXPECT(frame.duration == 0);
 }
 
+// Largest difference in any color channel between two bitmaps of the same size.
+static int max_channel_difference(Gfx::Bitmap const& a, Gfx::Bitmap const& b)
+{
+    int max_difference = 0;
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            auto pixel_a = a.get_pixel(x, y);
+            auto pixel_b = b.get_pixel(x, y);
+            max_difference = max(max_difference, abs(pixel_a.red() - pixel_b.red()));
+            max_difference = max(max_difference, abs(pixel_a.green() - pixel_b.green()));
+            max_difference = max(max_difference, abs(pixel_a.blue() - pixel_b.blue()));
+        }
+    }
+    return max_difference;
+}
+
+TEST_CASE(test_jpg_matches_reference)
+{
+    // pattern-decoded.png is pattern.jpg as decoded by libjpeg, whose integer IDCT rounds a little differently.
+    auto jpg = Gfx::load_jpg("/res/html/misc/jpgsuite_files/pattern.jpg");
+    auto reference = Gfx::load_png("/res/html/misc/jpgsuite_files/pattern-decoded.png");
+    EXPECT(jpg);
+    EXPECT(reference);
+    EXPECT_EQ(jpg->size(), reference->size());
+    EXPECT(max_channel_difference(*jpg, *reference) <= 4);
+}
+
+TEST_CASE(test_jpg_restart_markers)
+{
+    // The same image, with a restart marker every 3 MCUs.
+    auto jpg = Gfx::load_jpg("/res/html/misc/jpgsuite_files/pattern.jpg");
+    auto restarted = Gfx::load_jpg("/res/html/misc/jpgsuite_files/pattern-restart-markers.jpg");
+    EXPECT(jpg);
+    EXPECT(restarted);
+    EXPECT_EQ(restarted->size(), jpg->size());
+    EXPECT_EQ(max_channel_difference(*restarted, *jpg), 0);
+}
+
+TEST_CASE(test_jpg_optimized_huffman_tables)
+{
+    // The same image, with Huffman tables fitted to it instead of the example tables from the spec.
+    auto jpg = Gfx::load_jpg("/res/html/misc/jpgsuite_files/pattern.jpg");
+    auto optimized = Gfx::load_jpg("/res/html/misc/jpgsuite_files/pattern-optimized-huffman.jpg");
+    EXPECT(jpg);
+    EXPECT(optimized);
+    EXPECT_EQ(optimized->size(), jpg->size());
+    EXPECT_EQ(max_channel_difference(*optimized, *jpg), 0);
+}
+
+// A reduced-scale decode keeps only the low frequencies of each block, so it's close to, but not quite, the average of
+// the pixels it covers in a full decode. Checks that it is on the whole. The stripes in pattern.jpg are as fine as
+// a 1/4 scale decode can show, which makes it the worst case here at an average difference of about 4.
+static void expect_jpg_scaled_down(String const& path, int scale)
+{
+    auto full = Gfx::load_jpg(path);
+    EXPECT(full);
+    auto scaled = Gfx::load_jpg_for_size(path, { full->width() / scale, full->height() / scale });
+    EXPECT(scaled);
+    EXPECT_EQ(scaled->width(), (full->width() + scale - 1) / scale);
+    EXPECT_EQ(scaled->height(), (full->height() + scale - 1) / scale);
+
+    u64 total_difference = 0;
+    for (int y = 0; y < scaled->height(); ++y) {
+        for (int x = 0; x < scaled->width(); ++x) {
+            int red = 0, green = 0, blue = 0, count = 0;
+            for (int full_y = y * scale; full_y < min((y + 1) * scale, full->height()); ++full_y) {
+                for (int full_x = x * scale; full_x < min((x + 1) * scale, full->width()); ++full_x) {
+                    auto pixel = full->get_pixel(full_x, full_y);
+                    red += pixel.red();
+                    green += pixel.green();
+                    blue += pixel.blue();
+                    ++count;
+                }
+            }
+            auto pixel = scaled->get_pixel(x, y);
+            total_difference += abs(pixel.red() - red / count) + abs(pixel.green() - green / count) + abs(pixel.blue() - blue / count);
+        }
+    }
+    auto average_difference = (double)total_difference / (scaled->width() * scaled->height() * 3);
+    EXPECT(average_difference < 6);
+}
+
+TEST_CASE(test_jpg_reduced_scale)
+{
+    for (int scale : { 2, 4, 8 }) {
+        expect_jpg_scaled_down("/res/html/misc/jpgsuite_files/pattern.jpg", scale);
+        // Its chroma is subsampled in both directions.
+        expect_jpg_scaled_down("/res/html/misc/jpgsuite_files/chroma-quartered-lena.jpg", scale);
+    }
+}
+
 TEST_CASE(test_pbm)
 {
     auto image = Gfx::load_pbm("/res/html/misc/pbmsuite_files/buggie-raw.pbm");
@@ -121,6 +212,54 @@ TEST_CASE(test_png)
     EXPECT(frame.duration == 0);
 }
 
+// The images in pngsuite_files are 13x10, and row y is filtered with filter type y % 5, so that each filter sees both
+// the first row and the end of a row that doesn't fill its last byte.
+static void expect_png_pixels(String const& name, Function<Color(int x, int y)> expected_pixel)
+{
+    auto png = Gfx::load_png(String::formatted("/res/html/misc/pngsuite_files/{}", name));
+    EXPECT(png);
+    EXPECT_EQ(png->size(), Gfx::IntSize(13, 10));
+    for (int y = 0; y < png->height(); ++y) {
+        for (int x = 0; x < png->width(); ++x)
+            EXPECT_EQ(png->get_pixel(x, y), expected_pixel(x, y));
+    }
+}
+
+TEST_CASE(test_png_palette)
+{
+    for (int depth : { 1, 2, 4, 8 }) {
+        int color_count = 1 << depth;
+        expect_png_pixels(String::formatted("palette-{}-bit.png", depth), [&](int x, int y) {
+            int index = (x * 7 + y * 3) % color_count;
+            u8 red = index * 255 / (color_count - 1);
+            return Color(red, 255 - red, index * 37 % 256);
+        });
+    }
+}
+
+TEST_CASE(test_png_sub_byte_grayscale)
+{
+    for (int depth : { 1, 2, 4 }) {
+        int max_value = (1 << depth) - 1;
+        expect_png_pixels(String::formatted("grayscale-{}-bit.png", depth), [&](int x, int y) {
+            u8 gray = (x * 7 + y * 3) % (max_value + 1) * 255 / max_value;
+            return Color(gray, gray, gray);
+        });
+    }
+}
+
+TEST_CASE(test_png_16_bit)
+{
+    // Only the high byte of each sample is kept.
+    expect_png_pixels("grayscale-16-bit.png", [](int x, int y) {
+        u8 gray = ((x * 5000 + y * 9000) & 0xffff) >> 8;
+        return Color(gray, gray, gray);
+    });
+    expect_png_pixels("rgba-16-bit.png", [](int x, int y) {
+        return Color(((x * 5000 + y * 9000) & 0xffff) >> 8, ((x * 3000 ^ y * 7000) & 0xffff) >> 8, (((x + y) * 4000) & 0xffff) >> 8, (0xffff - y * 6000) >> 8);
+    });
+}
+
 TEST_CASE(test_ppm)
 {
     auto image = Gfx::load_ppm("/res/html/misc/ppmsuite_files/buggie-raw.ppm");
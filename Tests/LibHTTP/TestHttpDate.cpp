@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibHTTP/HttpDate.h>
+#include <LibTest/TestCase.h>
+#include <stdlib.h>
+#include <time.h>
+
+// HTTP dates mustn't depend on the local time zone, so the tests run in one that's a few hours off GMT
+// and has daylight saving time. It's given as a POSIX rule so that no time zone database is needed.
+static void use_non_utc_time_zone()
+{
+    setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+    tzset();
+}
+
+TEST_CASE(format_date)
+{
+    use_non_utc_time_zone();
+    EXPECT_EQ(HTTP::format_http_date(784111777), "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(HTTP::format_http_date(0), "Thu, 01 Jan 1970 00:00:00 GMT");
+}
+
+TEST_CASE(parse_date)
+{
+    use_non_utc_time_zone();
+    EXPECT_EQ(HTTP::parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT").value_or(-1), 784111777);
+    // 02:30 doesn't exist as local time on that day, but that doesn't matter for a time in GMT.
+    EXPECT_EQ(HTTP::parse_http_date("Sun, 13 Mar 2022 02:30:00 GMT").value_or(-1), 1647138600);
+
+    for (time_t time : { 0, 784111777, 1647138600, 1700000000 })
+        EXPECT_EQ(HTTP::parse_http_date(HTTP::format_http_date(time)).value_or(-1), time);
+}
+
+TEST_CASE(reject_malformed_date)
+{
+    EXPECT(!HTTP::parse_http_date("").has_value());
+    EXPECT(!HTTP::parse_http_date("Sun, 06 Nov 1994 08:49:37").has_value());
+    EXPECT(!HTTP::parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT ").has_value());
+    EXPECT(!HTTP::parse_http_date("Sun, 6 Nov 1994 08:49:37 GMT").has_value());
+    EXPECT(!HTTP::parse_http_date("Sun, 06 Foo 1994 08:49:37 GMT").has_value());
+    EXPECT(!HTTP::parse_http_date("Sun, 06 Nov 1994 24:49:37 GMT").has_value());
+    // The obsolete formats of RFC 7231, section 7.1.1.1 aren't taken.
+    EXPECT(!HTTP::parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT").has_value());
+    EXPECT(!HTTP::parse_http_date("Sun Nov  6 08:49:37 1994").has_value());
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/StringBuilder.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibRegex/Regex.h>
+
+// Something like a large server log: mostly uninteresting lines, with one that is worth looking for every now and then.
+static String const& log_corpus()
+{
+    static String corpus;
+    if (!corpus.is_null())
+        return corpus;
+
+    static constexpr StringView messages[] = {
+        "GET /index.html HTTP/1.1 200",
+        "POST /api/v1/session HTTP/1.1 201",
+        "cache hit for /static/style.css",
+        "worker 7 picked up job from queue",
+        "connection from 192.168.1.23 closed by peer",
+        "Warning: request took longer than expected",
+        "upstream timeout after 3000ms, retrying",
+        "ERROR: Connection refused",
+    };
+
+    StringBuilder builder;
+    u32 seed = 1;
+    for (size_t line = 0; line < 100'000; ++line) {
+        seed = seed * 1103515245 + 12345;
+        auto random = seed >> 16;
+        // The last two messages are the rare ones.
+        auto message = random % 64 == 0 ? messages[6 + random / 64 % 2] : messages[random % 6];
+        builder.appendff("2021-09-{:02} {:02}:{:02}:{:02} [{}] {}\n", random % 30 + 1, random % 24, random % 60, random / 60 % 60, random % 1000, message);
+    }
+    corpus = builder.build();
+    return corpus;
+}
+
+// Matches every line on its own, just like grep does.
+template<class Parser = PosixExtendedParser>
+static void grep(StringView pattern, size_t expected_matching_lines, typename regex::ParserTraits<Parser>::OptionsType options = {})
+{
+    using Options = typename regex::ParserTraits<Parser>::OptionsType;
+
+    auto& corpus = log_corpus();
+    Regex<Parser> re(pattern, options);
+    EXPECT_EQ(re.parser_result.error, regex::Error::NoError);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    size_t matching_lines = 0;
+    for (auto line : corpus.split_view('\n')) {
+        // Not ECMAScriptFlags::Global, which would continue where the match on the previous line ended.
+        if (re.match(line, Options { regex::AllOptions { regex::AllFlags::Global } }).success)
+            ++matching_lines;
+    }
+    auto elapsed = max(timer.elapsed(), 1);
+
+    EXPECT_EQ(matching_lines, expected_matching_lines);
+    outln("/{}/: {} lines matched in {} bytes, {}ms, {} MiB/s", pattern, matching_lines, corpus.length(), elapsed, corpus.length() * 1000 / elapsed / MiB);
+}
+
+BENCHMARK_CASE(grep_literal)
+{
+    grep("Connection refused", 796);
+}
+
+BENCHMARK_CASE(grep_literal_prefix)
+{
+    grep("timeout after [0-9]+ms", 813);
+}
+
+BENCHMARK_CASE(grep_alternation)
+{
+    grep("(Warning|ERROR): ", 17340);
+}
+
+BENCHMARK_CASE(grep_case_insensitive)
+{
+    grep("connection refused", 796, PosixFlags::Insensitive);
+}
+
+BENCHMARK_CASE(grep_character_class)
+{
+    grep("[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+", 16388);
+}
+
+// Backreferences need the backtracking matcher.
+BENCHMARK_CASE(grep_backreference)
+{
+    grep<ECMA262Parser>("\\[(\\d+)\\].*\\b\\1\\b", 204);
+}
+
+BENCHMARK_CASE(grep_repeated_field)
+{
+    grep<ECMA262Parser>("(\\d+):(\\d+):\\2", 1633);
+}
@@ -605,3 +605,114 @@ TEST_CASE(case_insensitive_match)
     EXPECT_EQ(result.success, true);
     EXPECT_EQ(result.matches.at(0).column, 4ul);
 }
+
+TEST_CASE(leftmost_first_match)
+{
+    // Alternatives are tried in order, the first one that matches wins, even if a later one would match more.
+    Regex<ECMA262> re("a|ab");
+    auto result = re.search("xab");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "a");
+    EXPECT_EQ(result.matches.at(0).column, 1ul);
+
+    Regex<ECMA262> re2("ab|a");
+    result = re2.search("xab");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "ab");
+
+    Regex<PosixExtended> re3("(a|ab)(c|bcd)");
+    result = re3.search("xabcd");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "abcd");
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "a");
+    EXPECT_EQ(result.capture_group_matches.at(0).at(1).view, "bcd");
+}
+
+TEST_CASE(catastrophic_backtracking)
+{
+    // A backtracking matcher needs exponential time to find out that these don't match.
+    auto haystack = String::repeated('a', 64);
+    Regex<ECMA262> re("(a+)+b");
+    EXPECT_EQ(re.search(haystack).success, false);
+
+    Regex<PosixExtended> re2("^(a|aa)+$");
+    EXPECT_EQ(re2.match(String::formatted("{}b", haystack)).success, false);
+
+    // Once there is a match, the capture groups are still filled in.
+    Regex<ECMA262> re3("(a|aa)+c");
+    auto result = re3.search(String::formatted("{}baac", haystack));
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "aac");
+    EXPECT_EQ(result.matches.at(0).column, 65ul);
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "a");
+}
+
+TEST_CASE(long_input)
+{
+    // Each iteration of a loop used to count towards the recursion limit of the backtracker.
+    auto haystack = String::formatted("{}b", String::repeated('a', 100000));
+    Regex<PosixExtended> re("a*b");
+    auto result = re.search(haystack);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view.length(), 100001ul);
+}
+
+TEST_CASE(skip_to_literal_prefix)
+{
+    // Lots of candidates for the first character that don't pan out.
+    auto haystack = String::formatted("{}needle, {}needles", String::repeated('n', 1000), String::repeated('e', 1000));
+    Regex<PosixExtended> re("needle[s]?");
+    auto result = re.search(haystack);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.count, 2u);
+    EXPECT_EQ(result.matches.at(0).column, 1000ul);
+    EXPECT_EQ(result.matches.at(1).view, "needles");
+
+    Regex<PosixExtended> re2("NEEDLE", PosixFlags::Insensitive);
+    result = re2.search(haystack);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.count, 2u);
+    EXPECT_EQ(result.matches.at(0).view, "needle");
+
+    // The prefix of a pattern is only what every match has to start with.
+    Regex<ECMA262> re3("(needle|e+)s");
+    result = re3.search(haystack);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "needles");
+}
+
+TEST_CASE(optimized_bytecode)
+{
+    // Alternatives that share a prefix or are single characters are rewritten, without changing which one wins.
+    Regex<ECMA262> re("(abc|abd|ab)(d?)e");
+    auto result = re.search("xabde");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "abde");
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "abd");
+    EXPECT_EQ(result.capture_group_matches.at(0).at(1).view, "");
+
+    Regex<PosixExtended> re2("(a|b|c)+d");
+    result = re2.search("xcabd");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.at(0).view, "cabd");
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "b");
+
+    Regex<PosixExtended> re3("(foo|foobar)(bar)?");
+    result = re3.search("foobar");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "foo");
+    EXPECT_EQ(result.capture_group_matches.at(0).at(1).view, "bar");
+
+    // Loops that never have to give back an iteration don't leave a state behind for every one of them.
+    auto haystack = String::formatted("{}={}", String::repeated('a', 100000), String::repeated('a', 100000));
+    Regex<ECMA262> re4("^(\\w+)=\\1$");
+    result = re4.match(haystack);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view.length(), 100000ul);
+
+    // But the ones that do still work.
+    Regex<ECMA262> re5("^(\\w+)\\w=\\1a$");
+    result = re5.match("aaaa=aaaa");
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.capture_group_matches.at(0).at(0).view, "aaa");
+}
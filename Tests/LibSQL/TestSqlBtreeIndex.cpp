@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
+#include <LibCore/ElapsedTimer.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Key.h>
@@ -309,3 +310,213 @@ TEST_CASE(btree_scan_50_keys)
 {
     insert_into_and_scan_btree(50);
 }
+
+NonnullRefPtr<SQL::BTree> setup_text_btree(SQL::Heap& heap);
+Vector<SQL::Key> generate_sorted_keys(SQL::BTree& btree, int num_keys);
+void verify_btree_contents(SQL::Heap& heap, NonnullRefPtr<SQL::BTree> (*setup)(SQL::Heap&), Vector<SQL::Key> const& keys);
+
+NonnullRefPtr<SQL::BTree> setup_text_btree(SQL::Heap& heap)
+{
+    SQL::TupleDescriptor tuple_descriptor;
+    tuple_descriptor.append({ "key_value", SQL::SQLType::Text, SQL::AST::Order::Ascending });
+
+    auto root_pointer = heap.user_value(0);
+    if (!root_pointer) {
+        root_pointer = heap.new_record_pointer();
+        heap.set_user_value(0, root_pointer);
+    }
+    auto btree = SQL::BTree::construct(heap, tuple_descriptor, true, root_pointer);
+    btree->on_new_root = [&]() {
+        heap.set_user_value(0, btree->root());
+    };
+    return btree;
+}
+
+Vector<SQL::Key> generate_sorted_keys(SQL::BTree& btree, int num_keys)
+{
+    Vector<SQL::Key> ret;
+    for (auto ix = 0; ix < num_keys; ix++) {
+        SQL::Key k(btree.descriptor());
+        if (btree.descriptor()[0].type == SQL::SQLType::Text)
+            k[0] = String::formatted("/usr/share/some/long/common/prefix/{:06}", ix);
+        else
+            k[0] = ix * 3;
+        k.set_pointer(ix + 1);
+        ret.append(k);
+    }
+    return ret;
+}
+
+void verify_btree_contents(SQL::Heap& heap, NonnullRefPtr<SQL::BTree> (*setup)(SQL::Heap&), Vector<SQL::Key> const& keys)
+{
+    auto btree = setup(heap);
+    for (auto& key : keys) {
+        SQL::Key k(key);
+        k.set_pointer(0);
+        auto pointer_opt = btree->get(k);
+        EXPECT(pointer_opt.has_value());
+        EXPECT_EQ(pointer_opt.value(), key.pointer());
+    }
+
+    size_t count = 0;
+    for (auto iter = btree->begin(); !iter.is_end(); iter++, count++) {
+        EXPECT(count < keys.size());
+        if (count >= keys.size())
+            break;
+        EXPECT_EQ((*iter).pointer(), keys[count].pointer());
+    }
+    EXPECT_EQ(count, keys.size());
+}
+
+TEST_CASE(btree_insert_many_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    Vector<SQL::Key> keys;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        keys = generate_sorted_keys(btree, 5000);
+
+        // Insert in an order which splits nodes all over the tree.
+        for (size_t ix = 0; ix < keys.size(); ix++)
+            EXPECT(btree->insert(keys[(ix * 7919) % keys.size()]));
+        EXPECT(!btree->insert(keys[42]));
+    }
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    verify_btree_contents(heap, setup_btree, keys);
+}
+
+TEST_CASE(btree_bulk_load)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    Vector<SQL::Key> keys;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        keys = generate_sorted_keys(btree, 5000);
+        EXPECT(btree->bulk_load(keys));
+    }
+    u32 bulk_loaded_blocks;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        bulk_loaded_blocks = heap->size();
+        verify_btree_contents(heap, setup_btree, keys);
+    }
+    unlink("/tmp/test.db");
+
+    // Inserting the same keys one at a time leaves every node about half full after it's split.
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        for (auto& key : keys)
+            btree->insert(key);
+    }
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(heap->size() > bulk_loaded_blocks);
+}
+
+TEST_CASE(btree_bulk_load_then_insert)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    Vector<SQL::Key> keys;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_btree(heap);
+        auto all_keys = generate_sorted_keys(btree, 3000);
+        for (size_t ix = 0; ix < all_keys.size(); ix += 2)
+            keys.append(all_keys[ix]);
+        EXPECT(btree->bulk_load(keys));
+
+        // A bulk loaded tree is a regular tree, and the keys in between go in with regular inserts.
+        for (size_t ix = 1; ix < all_keys.size(); ix += 2)
+            EXPECT(btree->insert(all_keys[ix]));
+        keys = move(all_keys);
+    }
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    verify_btree_contents(heap, setup_btree, keys);
+}
+
+TEST_CASE(btree_bulk_load_rejects_duplicates)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    auto btree = setup_btree(heap);
+    auto keys = generate_sorted_keys(btree, 10);
+    SQL::Key duplicate = keys[5];
+    keys.insert(5, duplicate);
+    EXPECT(!btree->bulk_load(keys));
+    EXPECT(btree->begin().is_end());
+}
+
+TEST_CASE(btree_bulk_load_small)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    for (int num_keys : { 0, 1, 2, 3 }) {
+        Vector<SQL::Key> keys;
+        {
+            auto heap = SQL::Heap::construct("/tmp/test.db");
+            auto btree = setup_btree(heap);
+            keys = generate_sorted_keys(btree, num_keys);
+            EXPECT(btree->bulk_load(keys));
+        }
+        {
+            auto heap = SQL::Heap::construct("/tmp/test.db");
+            verify_btree_contents(heap, setup_btree, keys);
+        }
+        unlink("/tmp/test.db");
+    }
+}
+
+TEST_CASE(btree_prefix_compressed_text_keys)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    Vector<SQL::Key> keys;
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_text_btree(heap);
+        keys = generate_sorted_keys(btree, 2000);
+        EXPECT(btree->bulk_load(keys));
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        verify_btree_contents(heap, setup_text_btree, keys);
+
+        // Uncompressed, these keys take 76 bytes each and at most 13 of them fit in a block.
+        EXPECT(heap->size() < 2000 / 13);
+    }
+    unlink("/tmp/test.db");
+
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        auto btree = setup_text_btree(heap);
+        for (size_t ix = 0; ix < keys.size(); ix++)
+            EXPECT(btree->insert(keys[(ix * 997) % keys.size()]));
+    }
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    verify_btree_contents(heap, setup_text_btree, keys);
+}
+
+BENCHMARK_CASE(btree_bulk_load_versus_insert)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    constexpr int num_keys = 50000;
+    for (auto bulk_load : { false, true }) {
+        Core::ElapsedTimer timer;
+        {
+            auto heap = SQL::Heap::construct("/tmp/test.db");
+            auto btree = setup_text_btree(heap);
+            auto keys = generate_sorted_keys(btree, num_keys);
+
+            timer.start();
+            if (bulk_load) {
+                EXPECT(btree->bulk_load(keys));
+            } else {
+                for (auto& key : keys)
+                    btree->insert(key);
+            }
+        }
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        outln("{}: {} keys in {} blocks, {} ms", bulk_load ? "Bulk load" : "Insert", num_keys, heap->size(), timer.elapsed());
+        unlink("/tmp/test.db");
+    }
+}
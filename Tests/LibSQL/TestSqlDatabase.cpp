@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
+#include <LibCore/File.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Heap.h>
@@ -20,6 +21,9 @@ NonnullRefPtr<SQL::SchemaDef> setup_table(SQL::Database&);
 void insert_into_table(SQL::Database&, int);
 void verify_table_contents(SQL::Database&, int);
 void insert_and_verify(int);
+void write_heap_blocks(SQL::Heap&, u32);
+void verify_heap_blocks(SQL::Heap&, u32);
+void copy_file(String const&, String const&);
 
 NonnullRefPtr<SQL::SchemaDef> setup_schema(SQL::Database& db)
 {
@@ -99,7 +103,112 @@ TEST_CASE(create_heap)
 {
     ScopeGuard guard([]() { unlink("/tmp/test.db"); });
     auto heap = SQL::Heap::construct("/tmp/test.db");
-    EXPECT_EQ(heap->version(), 0x00000001u);
+    EXPECT_EQ(heap->version(), SQL::HEAP_VERSION);
+}
+
+TEST_CASE(refuse_heap_with_other_version)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test.db");
+        unlink("/tmp/test.db.wal");
+    });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        heap->flush();
+    }
+    {
+        // Version 0.1 stored the B-tree nodes without prefix compression.
+        auto file = Core::File::open("/tmp/test.db", Core::OpenMode::ReadWrite);
+        EXPECT(!file.is_error());
+        u32 old_version = 0x00000001;
+        EXPECT(file.value()->seek(12));
+        EXPECT(file.value()->write(reinterpret_cast<u8 const*>(&old_version), sizeof(u32)));
+    }
+    EXPECT_CRASH("Heap with version 0.1", [] {
+        SQL::Heap::construct("/tmp/test.db");
+        return Test::Crash::Failure::DidNotCrash;
+    });
+}
+
+void write_heap_blocks(SQL::Heap& heap, u32 count)
+{
+    for (u32 ix = 0; ix < count; ix++) {
+        auto block = heap.new_record_pointer();
+        EXPECT_EQ(block, ix + 1);
+        auto buffer = ByteBuffer::create_zeroed(SQL::BLOCKSIZE);
+        buffer.overwrite(0, &block, sizeof(u32));
+        heap.add_to_wal(block, buffer);
+    }
+}
+
+void verify_heap_blocks(SQL::Heap& heap, u32 count)
+{
+    for (u32 block = 1; block <= count; block++) {
+        auto buffer_or_error = heap.read_block(block);
+        EXPECT(!buffer_or_error.is_error());
+        u32 contents;
+        memcpy(&contents, buffer_or_error.value().data(), sizeof(u32));
+        EXPECT_EQ(contents, block);
+    }
+}
+
+void copy_file(String const& from, String const& to)
+{
+    auto from_file = Core::File::open(from, Core::OpenMode::ReadOnly);
+    auto to_file = Core::File::open(to, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate);
+    EXPECT(!from_file.is_error() && !to_file.is_error());
+    auto contents = from_file.value()->read_all();
+    EXPECT(to_file.value()->write(contents.data(), contents.size()));
+}
+
+TEST_CASE(heap_buffer_pool_eviction)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db", 4);
+        write_heap_blocks(heap, 64);
+        verify_heap_blocks(heap, 64);
+
+        auto bytes_or_error = heap->pin_block(1);
+        EXPECT(!bytes_or_error.is_error());
+        verify_heap_blocks(heap, 64);
+        EXPECT_EQ(bytes_or_error.value()[0], 1);
+        heap->unpin_block(1);
+        heap->flush();
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db", 4);
+        EXPECT_EQ(heap->size(), 65u);
+        verify_heap_blocks(heap, 64);
+    }
+}
+
+TEST_CASE(heap_recover_from_wal)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test.db");
+        unlink("/tmp/test-crashed.db");
+        unlink("/tmp/test-crashed.db.wal");
+    });
+    {
+        auto heap = SQL::Heap::construct("/tmp/test.db");
+        write_heap_blocks(heap, 10);
+        heap->flush();
+
+        // Blocks written after the last flush are not committed, and should not survive a crash.
+        auto buffer = ByteBuffer::create_zeroed(SQL::BLOCKSIZE);
+        heap->add_to_wal(heap->new_record_pointer(), buffer);
+
+        // Take a copy of the heap as it is on disk right now, which is what a crash would leave behind.
+        copy_file("/tmp/test.db", "/tmp/test-crashed.db");
+        copy_file("/tmp/test.db.wal", "/tmp/test-crashed.db.wal");
+    }
+    {
+        auto heap = SQL::Heap::construct("/tmp/test-crashed.db");
+        EXPECT_EQ(heap->size(), 11u);
+        verify_heap_blocks(heap, 10);
+    }
+    EXPECT_EQ(access("/tmp/test-crashed.db.wal", F_OK), -1);
 }
 
 TEST_CASE(create_database)
@@ -158,6 +158,36 @@ TEST_CASE(column_name)
     validate("\"Column\n_Name\"", {}, {}, "Column\n_Name");
 }
 
+TEST_CASE(function_call_expression)
+{
+    EXPECT(parse("count(").is_error());
+    EXPECT(parse("count(*").is_error());
+    EXPECT(parse("max(1,)").is_error());
+
+    auto validate = [](StringView sql, StringView expected_name, size_t expected_argument_count, bool expected_select_all_arguments, bool expected_distinct) {
+        auto result = parse(sql);
+        EXPECT(!result.is_error());
+
+        auto expression = result.release_value();
+        EXPECT(is<SQL::AST::FunctionCallExpression>(*expression));
+
+        const auto& function_call = static_cast<const SQL::AST::FunctionCallExpression&>(*expression);
+        EXPECT_EQ(function_call.name(), expected_name);
+        EXPECT_EQ(function_call.arguments().size(), expected_argument_count);
+        EXPECT_EQ(function_call.select_all_arguments(), expected_select_all_arguments);
+        EXPECT_EQ(function_call.distinct(), expected_distinct);
+
+        for (const auto& argument : function_call.arguments())
+            EXPECT(!is<SQL::AST::ErrorExpression>(argument));
+    };
+
+    validate("random()", "RANDOM", 0, false, false);
+    validate("count(*)", "COUNT", 0, true, false);
+    validate("sum(column_name)", "SUM", 1, false, false);
+    validate("count(DISTINCT column_name)", "COUNT", 1, false, true);
+    validate("max(1, column_name + 2)", "MAX", 2, false, false);
+}
+
 TEST_CASE(unary_operator)
 {
     EXPECT(parse("-").is_error());
@@ -252,6 +282,46 @@ TEST_CASE(binary_operator)
     }
 }
 
+TEST_CASE(binary_operator_precedence)
+{
+    auto validate = [](StringView sql, SQL::AST::BinaryOperator expected_operator, SQL::AST::BinaryOperator expected_nested_operator, bool expect_nested_lhs) {
+        auto result = parse(sql);
+        EXPECT(!result.is_error());
+
+        auto expression = result.release_value();
+        EXPECT(is<SQL::AST::BinaryOperatorExpression>(*expression));
+
+        const auto& binary = static_cast<const SQL::AST::BinaryOperatorExpression&>(*expression);
+        EXPECT_EQ(binary.type(), expected_operator);
+
+        const auto& nested = expect_nested_lhs ? binary.lhs() : binary.rhs();
+        EXPECT(is<SQL::AST::BinaryOperatorExpression>(*nested));
+        EXPECT_EQ(static_cast<const SQL::AST::BinaryOperatorExpression&>(*nested).type(), expected_nested_operator);
+    };
+
+    validate("1 + 2 * 3", SQL::AST::BinaryOperator::Plus, SQL::AST::BinaryOperator::Multiplication, false);
+    validate("1 * 2 + 3", SQL::AST::BinaryOperator::Plus, SQL::AST::BinaryOperator::Multiplication, true);
+    validate("1 - 2 - 3", SQL::AST::BinaryOperator::Minus, SQL::AST::BinaryOperator::Minus, true);
+    validate("a = 1 AND b = 2", SQL::AST::BinaryOperator::And, SQL::AST::BinaryOperator::Equals, true);
+    validate("a = 1 OR b = 2 AND c = 3", SQL::AST::BinaryOperator::Or, SQL::AST::BinaryOperator::And, false);
+    validate("a < 1 = b", SQL::AST::BinaryOperator::Equals, SQL::AST::BinaryOperator::LessThan, true);
+    validate("a || b = c", SQL::AST::BinaryOperator::Equals, SQL::AST::BinaryOperator::Concatenate, true);
+
+    auto result = parse("NOT a = 1 AND b BETWEEN 1 + 1 AND 3");
+    EXPECT(!result.is_error());
+    auto expression = result.release_value();
+    EXPECT(is<SQL::AST::BinaryOperatorExpression>(*expression));
+
+    const auto& binary = static_cast<const SQL::AST::BinaryOperatorExpression&>(*expression);
+    EXPECT_EQ(binary.type(), SQL::AST::BinaryOperator::And);
+    EXPECT(is<SQL::AST::UnaryOperatorExpression>(*binary.lhs()));
+    EXPECT(is<SQL::AST::BetweenExpression>(*binary.rhs()));
+
+    const auto& between = static_cast<const SQL::AST::BetweenExpression&>(*binary.rhs());
+    EXPECT(is<SQL::AST::BinaryOperatorExpression>(*between.lhs()));
+    EXPECT(is<SQL::AST::NumericLiteral>(*between.rhs()));
+}
+
 TEST_CASE(chained_expression)
 {
     EXPECT(parse("()").is_error());
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <unistd.h>
+
+#include <AK/ScopeGuard.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/Lexer.h>
+#include <LibSQL/AST/Parser.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Operator.h>
+#include <LibSQL/Planner.h>
+#include <LibSQL/Row.h>
+#include <LibTest/TestCase.h>
+
+namespace {
+
+constexpr auto db_name = "/tmp/test.db";
+
+// Identifiers which aren't quoted are upper-cased by the lexer, so that is how the tables are defined here.
+void create_employees_table(SQL::Database& db, int count, bool with_index)
+{
+    auto schema = SQL::SchemaDef::construct("default");
+    db.add_schema(schema);
+
+    auto table = SQL::TableDef::construct(schema, "EMPLOYEES");
+    table->append_column("ID", SQL::SQLType::Integer);
+    table->append_column("NAME", SQL::SQLType::Text);
+    table->append_column("DEPARTMENT", SQL::SQLType::Integer);
+    table->append_column("SALARY", SQL::SQLType::Float);
+    db.add_table(table);
+
+    auto departments = SQL::TableDef::construct(schema, "DEPARTMENTS");
+    departments->append_column("ID", SQL::SQLType::Integer);
+    departments->append_column("NAME", SQL::SQLType::Text);
+    db.add_table(departments);
+
+    auto employees = db.get_table("default", "EMPLOYEES");
+    if (with_index) {
+        auto index = employees->add_index("EMPLOYEES_ID", true);
+        index->append_column("ID", SQL::SQLType::Integer);
+        EXPECT(db.add_index(*index));
+    }
+
+    for (int ix = 0; ix < count; ix++) {
+        SQL::Row row(employees);
+        row["ID"] = ix;
+        row["NAME"] = String::formatted("Employee{}", ix);
+        row["DEPARTMENT"] = ix % 4;
+        row["SALARY"] = 1000.0 + ix;
+        EXPECT(db.insert(row));
+    }
+
+    auto department_table = db.get_table("default", "DEPARTMENTS");
+    for (int ix = 0; ix < 3; ix++) {
+        SQL::Row row(department_table);
+        row["ID"] = ix;
+        row["NAME"] = String::formatted("Department{}", ix);
+        EXPECT(db.insert(row));
+    }
+    db.commit();
+}
+
+Result<NonnullOwnPtr<SQL::Operator>, String> plan(SQL::Database& db, StringView sql)
+{
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+    auto statement = parser.next_statement();
+    EXPECT(!parser.has_errors());
+    EXPECT(is<SQL::AST::Select>(*statement));
+
+    SQL::Planner planner(db);
+    return planner.plan(static_cast<SQL::AST::Select const&>(*statement));
+}
+
+Vector<SQL::Tuple> execute(SQL::Database& db, StringView sql)
+{
+    auto plan_or_error = plan(db, sql);
+    if (plan_or_error.is_error()) {
+        warnln("Could not plan '{}': {}", sql, plan_or_error.error());
+        return {};
+    }
+
+    auto root = plan_or_error.release_value();
+    Vector<SQL::Tuple> rows;
+    root->open();
+    SQL::Tuple row;
+    while (root->next(row))
+        rows.append(row);
+    return rows;
+}
+
+}
+
+TEST_CASE(select_all_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+
+    auto rows = execute(db, "SELECT * FROM Employees;");
+    EXPECT_EQ(rows.size(), 20u);
+    for (auto& row : rows) {
+        EXPECT_EQ(row.length(), 4u);
+        EXPECT_EQ(row[1].to_string().value(), String::formatted("Employee{}", row[0].to_int().value()));
+    }
+
+    rows = execute(db, "SELECT id * 2 + 1, name FROM employees WHERE id = 7;");
+    EXPECT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].length(), 2u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 15);
+    EXPECT_EQ(rows[0][1].to_string().value(), "Employee7");
+
+    rows = execute(db, "SELECT 1 + 2 * 3, 'text';");
+    EXPECT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 7);
+    EXPECT_EQ(rows[0][1].to_string().value(), "text");
+}
+
+TEST_CASE(filter_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE department = 1;").size(), 5u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE department = 1 AND id > 10;").size(), 2u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE department = 1 OR department = 2;").size(), 10u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id BETWEEN 5 AND 9;").size(), 5u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id NOT IN (1, 2, 3);").size(), 17u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE name LIKE 'employee1%';").size(), 11u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE salary >= 1015.5;").size(), 4u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE NULL;").size(), 0u);
+}
+
+TEST_CASE(choose_index_scan)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 100, true);
+
+    // A lookup in a unique index is always cheaper than reading every row.
+    auto plan_or_error = plan(db, "SELECT * FROM employees WHERE id = 42;");
+    EXPECT(!plan_or_error.is_error());
+    EXPECT(plan_or_error.value()->to_string().contains("IndexScan EMPLOYEES using EMPLOYEES_ID"));
+
+    auto rows = execute(db, "SELECT name FROM employees WHERE id = 42;");
+    EXPECT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0].to_string().value(), "Employee42");
+    EXPECT_EQ(execute(db, "SELECT name FROM employees WHERE 42 = id AND department = 1;").size(), 0u);
+
+    // Reading more than a quarter of the table through the index costs more than reading all of it sequentially.
+    auto range_plan_or_error = plan(db, "SELECT * FROM employees WHERE id > 42;");
+    EXPECT(!range_plan_or_error.is_error());
+    EXPECT(range_plan_or_error.value()->to_string().contains("TableScan EMPLOYEES"));
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id > 42;").size(), 57u);
+
+    // A few rows at the end of the key range are worth looking up.
+    auto narrow_range_plan_or_error = plan(db, "SELECT * FROM employees WHERE id >= 95;");
+    EXPECT(!narrow_range_plan_or_error.is_error());
+    EXPECT(narrow_range_plan_or_error.value()->to_string().contains("IndexScan EMPLOYEES using EMPLOYEES_ID"));
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id >= 95;").size(), 5u);
+
+    auto between_plan_or_error = plan(db, "SELECT * FROM employees WHERE id BETWEEN 10 AND 14 AND department = 2;");
+    EXPECT(!between_plan_or_error.is_error());
+    EXPECT(between_plan_or_error.value()->to_string().contains("IndexScan EMPLOYEES using EMPLOYEES_ID"));
+    rows = execute(db, "SELECT id FROM employees WHERE id BETWEEN 10 AND 14 AND department = 2;");
+    EXPECT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 10);
+    EXPECT_EQ(rows[1][0].to_int().value(), 14);
+
+    // Of two bounds on the same value, the exclusive one applies.
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id = 42 AND id > 42;").size(), 0u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id >= 95 AND id > 95;").size(), 4u);
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id <= 3 AND id < 3;").size(), 3u);
+
+    // The index can't be used if the literal would have to be converted.
+    auto text_plan_or_error = plan(db, "SELECT * FROM employees WHERE id = '42';");
+    EXPECT(!text_plan_or_error.is_error());
+    EXPECT(text_plan_or_error.value()->to_string().contains("TableScan EMPLOYEES"));
+}
+
+TEST_CASE(row_counts)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+
+    auto employees = db->get_table("default", "EMPLOYEES");
+    auto departments = db->get_table("default", "DEPARTMENTS");
+    EXPECT_EQ(db->row_count(*employees), 20u);
+    EXPECT_EQ(db->row_count(*departments), 3u);
+
+    SQL::Row row(departments);
+    row["ID"] = 3;
+    row["NAME"] = "Department3";
+    EXPECT(db->insert(row));
+    EXPECT_EQ(db->row_count(*departments), 4u);
+    EXPECT_EQ(db->row_count(*employees), 20u);
+}
+
+TEST_CASE(index_scan_bounds)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 50, true);
+
+    auto employees = db->get_table("default", "EMPLOYEES");
+    auto index = employees->indexes().ptr_at(0);
+
+    auto scan = [&](Optional<SQL::IndexScan::Bound> lower_bound, Optional<SQL::IndexScan::Bound> upper_bound) {
+        SQL::IndexScan index_scan(db, *employees, index, move(lower_bound), move(upper_bound));
+        Vector<int> ids;
+        SQL::Tuple row;
+        index_scan.open();
+        while (index_scan.next(row))
+            ids.append(row[0].to_int().value());
+        return ids;
+    };
+    auto bound = [](int id, bool inclusive) {
+        SQL::Value value(SQL::SQLType::Integer);
+        value = id;
+        return SQL::IndexScan::Bound { value, inclusive };
+    };
+
+    auto ids = scan({}, {});
+    EXPECT_EQ(ids.size(), 50u);
+    for (int ix = 0; ix < 50; ix++)
+        EXPECT_EQ(ids[ix], ix);
+
+    EXPECT_EQ(scan(bound(10, true), bound(20, true)).size(), 11u);
+    EXPECT_EQ(scan(bound(10, false), bound(20, false)).size(), 9u);
+    EXPECT_EQ(scan(bound(10, false), bound(20, false)).first(), 11);
+    EXPECT_EQ(scan(bound(45, true), {}).size(), 5u);
+    EXPECT_EQ(scan({}, bound(0, true)).size(), 1u);
+    EXPECT_EQ(scan(bound(50, true), {}).size(), 0u);
+}
+
+TEST_CASE(index_survives_reopen)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    {
+        auto db = SQL::Database::construct(db_name);
+        create_employees_table(db, 30, true);
+    }
+    {
+        auto db = SQL::Database::construct(db_name);
+        auto employees = db->get_table("default", "EMPLOYEES");
+        EXPECT_EQ(employees->num_indexes(), 1u);
+
+        auto plan_or_error = plan(db, "SELECT * FROM employees WHERE id = 29;");
+        EXPECT(!plan_or_error.is_error());
+        EXPECT(plan_or_error.value()->to_string().contains("IndexScan"));
+        EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE id = 29;").size(), 1u);
+
+        // Unique indexes reject duplicate keys.
+        SQL::Row row(employees);
+        row["ID"] = 29;
+        row["NAME"] = "Duplicate";
+        row["DEPARTMENT"] = 0;
+        row["SALARY"] = 0.0;
+        EXPECT(!db->insert(row));
+    }
+}
+
+TEST_CASE(index_existing_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+    auto employees = db->get_table("default", "EMPLOYEES");
+
+    // Every department has several employees, so a unique index can't be built over them.
+    auto unique_index = employees->add_index("EMPLOYEES_DEPARTMENT", true);
+    unique_index->append_column("DEPARTMENT", SQL::SQLType::Integer);
+    EXPECT(!db->add_index(*unique_index));
+    EXPECT_EQ(employees->num_indexes(), 0u);
+
+    auto index = employees->add_index("EMPLOYEES_DEPARTMENT", false);
+    index->append_column("DEPARTMENT", SQL::SQLType::Integer);
+    EXPECT(db->add_index(*index));
+    EXPECT_EQ(employees->num_indexes(), 1u);
+
+    auto plan_or_error = plan(db, "SELECT * FROM employees WHERE department = 2;");
+    EXPECT(!plan_or_error.is_error());
+    EXPECT(plan_or_error.value()->to_string().contains("IndexScan EMPLOYEES using EMPLOYEES_DEPARTMENT"));
+    EXPECT_EQ(execute(db, "SELECT * FROM employees WHERE department = 2;").size(), 5u);
+}
+
+TEST_CASE(join_tables)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+
+    // Department 3 doesn't exist, so its employees disappear from an inner join.
+    auto sql = "SELECT e.name, d.name FROM employees AS e, departments AS d WHERE e.department = d.id;"sv;
+    auto plan_or_error = plan(db, sql);
+    EXPECT(!plan_or_error.is_error());
+    EXPECT(plan_or_error.value()->to_string().contains("HashJoin"));
+
+    auto rows = execute(db, sql);
+    EXPECT_EQ(rows.size(), 15u);
+    for (auto& row : rows) {
+        auto id = row[0].to_string().value().substring_view(8).to_int().value();
+        EXPECT_EQ(row[1].to_string().value(), String::formatted("Department{}", id % 4));
+    }
+
+    sql = "SELECT e.id, d.id FROM employees e, departments d WHERE e.department < d.id AND d.name = 'Department2';"sv;
+    auto nested_loop_plan_or_error = plan(db, sql);
+    EXPECT(!nested_loop_plan_or_error.is_error());
+    EXPECT(nested_loop_plan_or_error.value()->to_string().contains("NestedLoopJoin"));
+    EXPECT_EQ(execute(db, sql).size(), 10u);
+
+    EXPECT_EQ(execute(db, "SELECT * FROM employees, departments;").size(), 60u);
+    EXPECT(plan(db, "SELECT id FROM employees, departments;").is_error());
+}
+
+TEST_CASE(sort_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+
+    auto rows = execute(db, "SELECT id FROM employees ORDER BY id;");
+    EXPECT_EQ(rows.size(), 20u);
+    for (int ix = 0; ix < 20; ix++)
+        EXPECT_EQ(rows[ix][0].to_int().value(), ix);
+
+    rows = execute(db, "SELECT id, department AS dept FROM employees ORDER BY dept DESC, 1;");
+    EXPECT_EQ(rows.size(), 20u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 3);
+    EXPECT_EQ(rows[1][0].to_int().value(), 7);
+    EXPECT_EQ(rows[19][0].to_int().value(), 16);
+
+    rows = execute(db, "SELECT id FROM employees ORDER BY salary DESC LIMIT 3 OFFSET 1;");
+    EXPECT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 18);
+    EXPECT_EQ(rows[2][0].to_int().value(), 16);
+}
+
+TEST_CASE(aggregate_rows)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 20, false);
+
+    auto rows = execute(db, "SELECT count(*), sum(id), min(name), max(salary), avg(id) FROM employees;");
+    EXPECT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 20);
+    EXPECT_EQ(rows[0][1].to_int().value(), 190);
+    EXPECT_EQ(rows[0][2].to_string().value(), "Employee0");
+    EXPECT_EQ(rows[0][3].to_double().value(), 1019.0);
+    EXPECT_EQ(rows[0][4].to_double().value(), 9.5);
+
+    rows = execute(db, "SELECT count(*), sum(id) FROM employees WHERE id > 100;");
+    EXPECT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0][0].to_int().value(), 0);
+    EXPECT(rows[0][1].is_null());
+
+    rows = execute(db, "SELECT department, count(*) AS employees, sum(id) FROM employees GROUP BY department HAVING count(*) > 4 ORDER BY department;");
+    EXPECT_EQ(rows.size(), 4u);
+    for (int ix = 0; ix < 4; ix++) {
+        EXPECT_EQ(rows[ix][0].to_int().value(), ix);
+        EXPECT_EQ(rows[ix][1].to_int().value(), 5);
+        EXPECT_EQ(rows[ix][2].to_int().value(), 40 + 5 * ix);
+    }
+
+    rows = execute(db, "SELECT d.name, count(e.id) FROM employees e, departments d WHERE e.department = d.id GROUP BY d.name ORDER BY count(e.id) DESC, d.name;");
+    EXPECT_EQ(rows.size(), 3u);
+    EXPECT_EQ(rows[0][0].to_string().value(), "Department0");
+
+    EXPECT_EQ(execute(db, "SELECT count(DISTINCT department) FROM employees;")[0][0].to_int().value(), 4);
+    EXPECT_EQ(execute(db, "SELECT DISTINCT department FROM employees;").size(), 4u);
+
+    EXPECT(plan(db, "SELECT * FROM employees GROUP BY department;").is_error());
+    EXPECT(plan(db, "SELECT name FROM employees GROUP BY department;").is_error());
+    EXPECT(plan(db, "SELECT * FROM employees WHERE count(*) > 1;").is_error());
+    EXPECT(plan(db, "SELECT max(count(*)) FROM employees;").is_error());
+}
+
+TEST_CASE(plan_errors)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto db = SQL::Database::construct(db_name);
+    create_employees_table(db, 1, false);
+
+    EXPECT(plan(db, "SELECT * FROM nonexistent;").is_error());
+    EXPECT(plan(db, "SELECT nonexistent FROM employees;").is_error());
+    EXPECT(plan(db, "SELECT nonexistent(id) FROM employees;").is_error());
+    EXPECT(plan(db, "SELECT * FROM employees ORDER BY 5;").is_error());
+    EXPECT(plan(db, "SELECT * FROM employees LIMIT id;").is_error());
+}
+
+namespace {
+
+constexpr int benchmark_row_count = 2000;
+
+SQL::Database& benchmark_database()
+{
+    static RefPtr<SQL::Database> s_database;
+    if (!s_database) {
+        unlink(db_name);
+        s_database = SQL::Database::construct(db_name);
+        create_employees_table(*s_database, benchmark_row_count, true);
+    }
+    return *s_database;
+}
+
+void run_benchmark_query(StringView sql, size_t expected_row_count)
+{
+    auto plan_or_error = plan(benchmark_database(), sql);
+    EXPECT(!plan_or_error.is_error());
+
+    for (int ix = 0; ix < 10; ix++)
+        EXPECT_EQ(execute(benchmark_database(), sql).size(), expected_row_count);
+}
+
+}
+
+BENCHMARK_CASE(point_lookups)
+{
+    run_benchmark_query("SELECT * FROM employees WHERE id = 1234;", 1);
+}
+
+BENCHMARK_CASE(range_scan)
+{
+    run_benchmark_query("SELECT * FROM employees WHERE id >= 1000;", benchmark_row_count / 2);
+}
+
+BENCHMARK_CASE(narrow_range_scan)
+{
+    run_benchmark_query("SELECT * FROM employees WHERE id BETWEEN 1000 AND 1049;", 50);
+}
+
+BENCHMARK_CASE(hash_join)
+{
+    run_benchmark_query("SELECT e.id, d.name FROM employees e, departments d WHERE e.department = d.id;", benchmark_row_count * 3 / 4);
+}
+
+BENCHMARK_CASE(group_by_and_sort)
+{
+    run_benchmark_query("SELECT department, count(*), avg(salary) FROM employees GROUP BY department ORDER BY 3 DESC;", 4);
+    unlink(db_name);
+}
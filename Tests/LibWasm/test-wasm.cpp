@@ -11,6 +11,9 @@
 
 TEST_ROOT("Userland/Libraries/LibWasm/Tests");
 
+TESTJS_PROGRAM_FLAG(use_native_compiler, "Run functions compiled to machine code where possible", "native-compiler", 0);
+TESTJS_PROGRAM_FLAG(use_ir_interpreter, "Run functions lowered to a register-based IR where possible", "ir-interpreter", 0);
+
 TESTJS_GLOBAL_FUNCTION(read_binary_wasm_file, readBinaryWasmFile)
 {
     auto filename = vm.argument(0).to_string(global_object);
@@ -42,6 +45,10 @@ public:
 
     static WebAssemblyModule* create(JS::GlobalObject& global_object, Wasm::Module module, HashMap<Wasm::Linker::Name, Wasm::ExternValue> const& imports)
     {
+        if (use_native_compiler)
+            machine().set_execution_engine(Wasm::ExecutionEngine::NativeCompiler);
+        else if (use_ir_interpreter)
+            machine().set_execution_engine(Wasm::ExecutionEngine::IRInterpreter);
         auto instance = global_object.heap().allocate<WebAssemblyModule>(global_object, *global_object.object_prototype());
         instance->m_module = move(module);
         Wasm::Linker linker(*instance->m_module);
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+#include <LibCore/File.h>
+#include <LibTest/TestCase.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr char const* grep_path = "/bin/grep";
+
+struct GrepResult {
+    String output;
+    int exit_status { -1 };
+};
+
+static GrepResult run_grep(Vector<char const*> arguments)
+{
+    int pipe_fds[2];
+    VERIFY(pipe(pipe_fds) == 0);
+
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&file_actions, pipe_fds[0]);
+    posix_spawn_file_actions_addclose(&file_actions, pipe_fds[1]);
+
+    arguments.prepend(grep_path);
+    arguments.append(nullptr);
+
+    pid_t pid;
+    auto rc = posix_spawn(&pid, grep_path, &file_actions, nullptr, const_cast<char**>(arguments.data()), environ);
+    posix_spawn_file_actions_destroy(&file_actions);
+    close(pipe_fds[1]);
+    EXPECT_EQ(rc, 0);
+    if (rc != 0) {
+        close(pipe_fds[0]);
+        return {};
+    }
+
+    StringBuilder output;
+    char buffer[4096];
+    ssize_t nread;
+    while ((nread = read(pipe_fds[0], buffer, sizeof(buffer))) > 0)
+        output.append(buffer, nread);
+    close(pipe_fds[0]);
+
+    int status = 0;
+    VERIFY(waitpid(pid, &status, 0) == pid);
+    return { output.build(), WIFEXITED(status) ? WEXITSTATUS(status) : -1 };
+}
+
+static void write_file(String const& path, StringView contents)
+{
+    auto file = Core::File::open(path, Core::OpenMode::WriteOnly | Core::OpenMode::Truncate);
+    VERIFY(!file.is_error());
+    VERIFY(file.value()->write(contents));
+}
+
+TEST_CASE(recursive_directory_followed_by_file)
+{
+    char directory_template[] = "/tmp/grep-test.XXXXXX";
+    String directory = mkdtemp(directory_template);
+    auto dir_path = String::formatted("{}/dir", directory);
+    auto nested_path = String::formatted("{}/dir/a.txt", directory);
+    auto file_path = String::formatted("{}/file.txt", directory);
+    auto last_path = String::formatted("{}/last.txt", directory);
+    ScopeGuard guard([&] {
+        unlink(nested_path.characters());
+        rmdir(dir_path.characters());
+        unlink(file_path.characters());
+        unlink(last_path.characters());
+        rmdir(directory.characters());
+    });
+    VERIFY(mkdir(dir_path.characters(), 0755) == 0);
+    write_file(nested_path, "foo in a\n");
+    write_file(file_path, "foo in file\nbar\n");
+    write_file(last_path, "foo in last\n");
+
+    // Files given after a directory used to wait for output from the directory itself, which never came.
+    for (auto* jobs : { "1", "4" }) {
+        auto result = run_grep({ "-j", jobs, "-r", "foo", dir_path.characters(), file_path.characters(), last_path.characters() });
+        EXPECT_EQ(result.exit_status, 0);
+        EXPECT(result.output.contains("foo\x1B[0m in a"));
+        EXPECT(result.output.contains("foo\x1B[0m in file"));
+        EXPECT(result.output.contains("foo\x1B[0m in last"));
+        EXPECT(!result.output.contains("bar"));
+
+        // Files given on the command line are still printed in order.
+        auto file_position = result.output.find("in file");
+        auto last_position = result.output.find("in last");
+        EXPECT(file_position.has_value() && last_position.has_value() && file_position.value() < last_position.value());
+    }
+}
+
+TEST_CASE(files_are_printed_in_order)
+{
+    char directory_template[] = "/tmp/grep-test.XXXXXX";
+    String directory = mkdtemp(directory_template);
+    Vector<String> paths;
+    ScopeGuard guard([&] {
+        for (auto& path : paths)
+            unlink(path.characters());
+        rmdir(directory.characters());
+    });
+
+    Vector<char const*> arguments { "-j", "4", "match" };
+    for (int i = 0; i < 20; ++i)
+        paths.append(String::formatted("{}/file{}.txt", directory, i));
+    for (auto& path : paths) {
+        write_file(path, String::formatted("match in {}\n", path));
+        arguments.append(path.characters());
+    }
+
+    auto result = run_grep(move(arguments));
+    EXPECT_EQ(result.exit_status, 0);
+    auto lines = result.output.split_view('\n');
+    EXPECT_EQ(lines.size(), paths.size());
+    for (size_t i = 0; i < min(lines.size(), paths.size()); ++i)
+        EXPECT(lines[i].ends_with(String::formatted("match\x1B[0m in {}", paths[i])));
+}
@@ -165,6 +165,9 @@ private:
     int virt$getsockname(FlatPtr);
     int virt$getpeername(FlatPtr);
     int virt$select(FlatPtr);
+    int virt$epoll_create(int);
+    int virt$epoll_ctl(FlatPtr);
+    int virt$epoll_wait(FlatPtr);
     int virt$get_stack_bounds(FlatPtr, FlatPtr);
     int virt$accept4(FlatPtr);
     int virt$bind(int sockfd, FlatPtr address, socklen_t address_length);
@@ -200,6 +203,7 @@ private:
     int virt$anon_create(size_t, int);
     int virt$recvfd(int, int);
     int virt$sendfd(int, int);
+    int virt$sendfile(FlatPtr);
     int virt$msyscall(FlatPtr);
     int virt$futex(FlatPtr);
 
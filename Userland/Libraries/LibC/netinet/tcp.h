@@ -7,3 +7,4 @@
 #pragma once
 
 #define TCP_NODELAY 10
+#define TCP_CONGESTION 13
@@ -8,7 +8,6 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/BinaryHeap.h>
-#include <AK/BinarySearch.h>
 #include <AK/MemoryStream.h>
 #include <string.h>
 
@@ -46,69 +45,102 @@ const CanonicalCode& CanonicalCode::fixed_distance_codes()
 
 Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
 {
-    // FIXME: I can't quite follow the algorithm here, but it seems to work.
-
     CanonicalCode code;
+    code.m_decode_table.resize(1 << primary_table_bits);
 
     auto non_zero_symbols = 0;
     auto last_non_zero = -1;
+    Array<u16, max_code_length + 1> length_counts {};
     for (size_t i = 0; i < bytes.size(); i++) {
+        if (bytes[i] > max_code_length)
+            return {};
         if (bytes[i] != 0) {
             non_zero_symbols++;
             last_non_zero = i;
+            length_counts[bytes[i]]++;
         }
     }
-    if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
-        code.m_symbol_values.append(last_non_zero);
+    if (non_zero_symbols == 1) { // special case - only 1 symbol, the other 1-bit code is invalid
+        for (size_t i = 0; i < code.m_decode_table.size(); i += 2)
+            code.m_decode_table[i] = (last_non_zero << 16) | 1;
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
         return code;
     }
 
-    auto next_code = 0;
-    for (size_t code_length = 1; code_length <= 15; ++code_length) {
-        next_code <<= 1;
-        auto start_bit = 1 << code_length;
+    // The code has to be complete, i.e. every possible sequence of bits must decode to some symbol.
+    u32 code_space = 0;
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length)
+        code_space += length_counts[code_length] << (max_code_length - code_length);
+    if (code_space != (1 << max_code_length))
+        return {};
+
+    Array<u16, max_code_length + 1> next_code {};
+    for (size_t code_length = 2; code_length <= max_code_length; ++code_length)
+        next_code[code_length] = (next_code[code_length - 1] + length_counts[code_length - 1]) << 1;
 
-        for (size_t symbol = 0; symbol < bytes.size(); ++symbol) {
-            if (bytes[symbol] != code_length)
-                continue;
+    constexpr u32 primary_table_mask = (1 << primary_table_bits) - 1;
+    Array<u8, 1 << primary_table_bits> subtable_bits {};
 
-            if (next_code > start_bit)
-                return {};
+    for (size_t symbol = 0; symbol < bytes.size(); ++symbol) {
+        auto code_length = bytes[symbol];
+        if (code_length == 0)
+            continue;
 
-            code.m_symbol_codes.append(start_bit | next_code);
-            code.m_symbol_values.append(symbol);
-            code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
-            code.m_bit_code_lengths[symbol] = code_length;
+        // DEFLATE writes huffman encoded symbols as lsb-first, so that is how we index our table as well.
+        u16 reversed_code = fast_reverse16(next_code[code_length]++, code_length);
+        code.m_bit_codes[symbol] = reversed_code;
+        code.m_bit_code_lengths[symbol] = code_length;
 
-            next_code++;
+        if (code_length <= primary_table_bits) {
+            for (size_t index = reversed_code; index <= primary_table_mask; index += 1 << code_length)
+                code.m_decode_table[index] = (symbol << 16) | code_length;
+        } else {
+            auto& bits = subtable_bits[reversed_code & primary_table_mask];
+            bits = max<u8>(bits, code_length - primary_table_bits);
         }
     }
 
-    if (next_code != (1 << 15)) {
-        return {};
+    for (size_t prefix = 0; prefix <= primary_table_mask; ++prefix) {
+        if (subtable_bits[prefix] == 0)
+            continue;
+        code.m_decode_table[prefix] = (code.m_decode_table.size() << 16) | subtable_flag | subtable_bits[prefix];
+        code.m_decode_table.resize(code.m_decode_table.size() + (1 << subtable_bits[prefix]));
+    }
+
+    for (size_t symbol = 0; symbol < bytes.size(); ++symbol) {
+        auto code_length = bytes[symbol];
+        if (code_length <= primary_table_bits)
+            continue;
+
+        auto reversed_code = code.m_bit_codes[symbol];
+        auto subtable_entry = code.m_decode_table[reversed_code & primary_table_mask];
+        auto subtable_offset = subtable_entry >> 16;
+        auto subtable_size = 1u << (subtable_entry & 0xff);
+        for (size_t index = reversed_code >> primary_table_bits; index < subtable_size; index += 1 << (code_length - primary_table_bits))
+            code.m_decode_table[subtable_offset + index] = (symbol << 16) | code_length;
     }
 
     return code;
 }
 
-u32 CanonicalCode::read_symbol(InputBitStream& stream) const
+u32 CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) const
 {
-    u32 code_bits = 1;
-
-    for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
-            return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
-
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
-    }
+    auto bits = stream.peek_bits(max_code_length);
+
+    auto entry = m_decode_table[bits & ((1 << primary_table_bits) - 1)];
+    if (entry & subtable_flag)
+        entry = m_decode_table[(entry >> 16) + ((bits >> primary_table_bits) & ((1 << (entry & 0xff)) - 1))];
+
+    auto code_length = entry & 0xff;
+    if (code_length == 0)
+        return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
+
+    stream.discard_bits(code_length);
+    if (stream.has_any_error())
+        return UINT32_MAX;
+
+    return entry >> 16;
 }
 
 void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
@@ -155,15 +187,16 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
         }
         const auto distance = m_decompressor.decode_distance(distance_symbol);
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
-                m_decompressor.set_fatal_error();
-                return false; // a back reference was requested that was too far back (outside our current sliding window)
-            }
-            m_decompressor.m_output_stream << byte;
+        // The back reference may overlap the bytes it produces, in which case it repeats the last `distance` bytes.
+        u8 buffer[DeflateCompressor::max_match_length];
+        auto nread = m_decompressor.m_output_stream.read({ buffer, length }, distance);
+        if (m_decompressor.m_output_stream.handle_any_error()) {
+            m_decompressor.set_fatal_error();
+            return false; // a back reference was requested that was too far back (outside our current sliding window)
         }
+        for (size_t idx = nread; idx < length; ++idx)
+            buffer[idx] = buffer[idx - distance];
+        m_decompressor.m_output_stream << ReadonlyBytes { buffer, length };
 
         return true;
     }
@@ -189,6 +222,12 @@ bool DeflateDecompressor::UncompressedBlock::try_read_more()
 }
 
 DeflateDecompressor::DeflateDecompressor(InputStream& stream)
+    : m_owned_input_stream(make<LittleEndianInputBitStream>(stream))
+    , m_input_stream(*m_owned_input_stream)
+{
+}
+
+DeflateDecompressor::DeflateDecompressor(LittleEndianInputBitStream& stream)
     : m_input_stream(stream)
 {
 }
@@ -11,6 +11,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/CircularDuplexStream.h>
 #include <AK/Endian.h>
+#include <AK/OwnPtr.h>
 #include <AK/Vector.h>
 #include <LibCompress/DeflateTables.h>
 
@@ -19,7 +20,7 @@ namespace Compress {
 class CanonicalCode {
 public:
     CanonicalCode() = default;
-    u32 read_symbol(InputBitStream&) const;
+    u32 read_symbol(LittleEndianInputBitStream&) const;
     void write_symbol(OutputBitStream&, u32) const;
 
     static const CanonicalCode& fixed_literal_codes();
@@ -28,9 +29,14 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
-    Vector<u16> m_symbol_values;
+    static constexpr size_t max_code_length = 15;
+    static constexpr size_t primary_table_bits = 9;
+
+    // Decompression - indexed by the next primary_table_bits bits of input. Each entry holds the
+    // symbol in the upper 16 bits and the length of its code in the lower bits. Codes that are longer
+    // than primary_table_bits point to a subtable instead, which is indexed by the bits that follow.
+    static constexpr u32 subtable_flag = 1 << 15;
+    Vector<u32, 1 << primary_table_bits> m_decode_table;
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -75,6 +81,7 @@ public:
     friend UncompressedBlock;
 
     DeflateDecompressor(InputStream&);
+    DeflateDecompressor(LittleEndianInputBitStream&);
     ~DeflateDecompressor();
 
     size_t read(Bytes) override;
@@ -99,7 +106,8 @@ private:
         UncompressedBlock m_uncompressed_block;
     };
 
-    InputBitStream m_input_stream;
+    OwnPtr<LittleEndianInputBitStream> m_owned_input_stream;
+    LittleEndianInputBitStream& m_input_stream;
     CircularDuplexStream<32 * KiB> m_output_stream;
 };
 
@@ -56,7 +56,7 @@ public:
 private:
     class Member {
     public:
-        Member(BlockHeader header, InputStream& stream)
+        Member(BlockHeader header, LittleEndianInputBitStream& stream)
             : m_header(header)
             , m_stream(stream)
         {
@@ -71,7 +71,8 @@ private:
     const Member& current_member() const { return m_current_member.value(); }
     Member& current_member() { return m_current_member.value(); }
 
-    InputStream& m_input_stream;
+    // This is shared with the DeflateDecompressor of each member, as it may buffer the bytes following the compressed data.
+    LittleEndianInputBitStream m_input_stream;
     u8 m_partial_header[sizeof(BlockHeader)];
     size_t m_partial_header_offset { 0 };
     Optional<Member> m_current_member;
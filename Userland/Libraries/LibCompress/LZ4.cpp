@@ -0,0 +1,646 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/Format.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/LZ4.h>
+
+namespace Compress {
+
+static ALWAYS_INLINE u32 read_u32_le(const u8* bytes)
+{
+    u32 value;
+    __builtin_memcpy(&value, bytes, sizeof(value));
+    return AK::convert_between_host_and_little_endian(value);
+}
+
+static ALWAYS_INLINE u64 read_u64(const u8* bytes)
+{
+    u64 value;
+    __builtin_memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static ALWAYS_INLINE void write_u32_le(u8* bytes, u32 value)
+{
+    value = AK::convert_between_host_and_little_endian(value);
+    __builtin_memcpy(bytes, &value, sizeof(value));
+}
+
+static size_t block_size_from_descriptor(u8 block_descriptor)
+{
+    switch ((block_descriptor >> 4) & 0b111) {
+    case 4:
+        return 64 * KiB;
+    case 5:
+        return 256 * KiB;
+    case 6:
+        return 1 * MiB;
+    case 7:
+        return 4 * MiB;
+    default:
+        return 0;
+    }
+}
+
+static u8 header_checksum(ReadonlyBytes descriptor)
+{
+    Crypto::Checksum::XXHash32 checksum { descriptor };
+    return (checksum.digest() >> 8) & 0xff;
+}
+
+bool LZ4Decompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    return bytes.size() >= 4 && read_u32_le(bytes.data()) == lz4_frame_magic;
+}
+
+Optional<size_t> LZ4Decompressor::decompress_block(ReadonlyBytes input, Bytes output, size_t prefix_size)
+{
+    VERIFY(prefix_size <= output.size());
+
+    const u8* in = input.data();
+    const u8* const in_end = in + input.size();
+    u8* const out_start = output.data();
+    u8* out = out_start + prefix_size;
+    u8* const out_end = out_start + output.size();
+
+    auto read_length_extension = [&](size_t& length) {
+        u8 byte;
+        do {
+            if (in >= in_end)
+                return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    for (;;) {
+        if (in >= in_end)
+            return {};
+        u8 token = *in++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length_extension(literal_length))
+            return {};
+        if (literal_length > (size_t)(in_end - in) || literal_length > (size_t)(out_end - out))
+            return {};
+
+        // Most literal runs are short, so copy a fixed 16 bytes when there is room to spare.
+        if (literal_length <= 16 && in_end - in >= 16 && out_end - out >= 16)
+            __builtin_memcpy(out, in, 16);
+        else
+            __builtin_memcpy(out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+
+        // The last sequence of a block consists of literals only.
+        if (in == in_end)
+            break;
+
+        if (in_end - in < 2)
+            return {};
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > (size_t)(out - out_start))
+            return {};
+
+        size_t match_length = token & 0xf;
+        if (match_length == 15 && !read_length_extension(match_length))
+            return {};
+        match_length += LZ4Compressor::min_match_length;
+        if (match_length > (size_t)(out_end - out))
+            return {};
+
+        const u8* match = out - offset;
+        if (offset >= 16 && out_end - out >= (ptrdiff_t)match_length + 16) {
+            // Every 16-byte chunk of the source was fully written before we copy it, so we may
+            // overshoot the end of the match; the extra bytes will be overwritten by what follows.
+            for (size_t i = 0; i < match_length; i += 16)
+                __builtin_memcpy(out + i, match + i, 16);
+        } else if (offset >= match_length) {
+            __builtin_memcpy(out, match, match_length);
+        } else if (offset == 1) {
+            __builtin_memset(out, *match, match_length);
+        } else {
+            // Overlapping match, this repeats the last `offset` bytes.
+            for (size_t i = 0; i < match_length; ++i)
+                out[i] = match[i];
+        }
+        out += match_length;
+    }
+
+    return out - out_start - prefix_size;
+}
+
+LZ4Decompressor::LZ4Decompressor(InputStream& stream)
+    : m_input_stream(stream)
+{
+}
+
+LZ4Decompressor::~LZ4Decompressor()
+{
+    m_current_frame.clear();
+}
+
+bool LZ4Decompressor::read_u32(u32& value)
+{
+    u8 bytes[4];
+    if (!m_input_stream.read_or_error({ bytes, sizeof(bytes) })) {
+        set_fatal_error();
+        return false;
+    }
+    value = read_u32_le(bytes);
+    return true;
+}
+
+bool LZ4Decompressor::read_frame_header()
+{
+    u8 descriptor[15];
+    size_t nread = m_input_stream.read({ descriptor, 4 });
+    if (nread == 0 && (m_input_stream.handle_any_error() || m_input_stream.unreliable_eof())) {
+        m_eof = true;
+        return false;
+    }
+    if (nread < 4 && !m_input_stream.read_or_error({ descriptor + nread, 4 - nread })) {
+        set_fatal_error();
+        return false;
+    }
+
+    u32 magic = read_u32_le(descriptor);
+    if ((magic & lz4_skippable_frame_magic_mask) == lz4_skippable_frame_magic) {
+        u32 frame_size;
+        if (!read_u32(frame_size))
+            return false;
+        if (!m_input_stream.discard_or_error(frame_size)) {
+            set_fatal_error();
+            return false;
+        }
+        return true;
+    }
+
+    if (magic != lz4_frame_magic) {
+        dbgln_if(LZ4_DEBUG, "LZ4: Invalid frame magic {:#08x}", magic);
+        set_fatal_error();
+        return false;
+    }
+
+    // The header checksum covers the descriptor bytes after the magic, up to the checksum itself.
+    if (!m_input_stream.read_or_error({ descriptor, 2 })) {
+        set_fatal_error();
+        return false;
+    }
+    u8 flags = descriptor[0];
+    u8 block_descriptor = descriptor[1];
+    size_t descriptor_size = 2;
+
+    Frame frame;
+    frame.independent_blocks = flags & LZ4FrameFlags::BLOCK_INDEPENDENCE;
+    frame.has_block_checksum = flags & LZ4FrameFlags::BLOCK_CHECKSUM;
+    frame.has_content_checksum = flags & LZ4FrameFlags::CONTENT_CHECKSUM;
+    frame.max_block_size = block_size_from_descriptor(block_descriptor);
+
+    if ((flags & LZ4FrameFlags::VERSION_MASK) != LZ4FrameFlags::VERSION || (flags & LZ4FrameFlags::RESERVED)
+        || (block_descriptor & 0b10001111) || frame.max_block_size == 0) {
+        dbgln_if(LZ4_DEBUG, "LZ4: Unsupported frame descriptor {:#02x} {:#02x}", flags, block_descriptor);
+        set_fatal_error();
+        return false;
+    }
+
+    if (flags & LZ4FrameFlags::DICTIONARY_ID) {
+        // We don't have any way of getting at predefined dictionaries.
+        dbgln_if(LZ4_DEBUG, "LZ4: Frames using a dictionary are not supported");
+        set_fatal_error();
+        return false;
+    }
+
+    if (flags & LZ4FrameFlags::CONTENT_SIZE) {
+        if (!m_input_stream.read_or_error({ descriptor + descriptor_size, 8 })) {
+            set_fatal_error();
+            return false;
+        }
+        u64 content_size = 0;
+        for (size_t i = 0; i < 8; ++i)
+            content_size |= (u64)descriptor[descriptor_size + i] << (i * 8);
+        frame.content_size = content_size;
+        descriptor_size += 8;
+    }
+
+    u8 checksum;
+    if (!m_input_stream.read_or_error({ &checksum, 1 })) {
+        set_fatal_error();
+        return false;
+    }
+    if (checksum != header_checksum({ descriptor, descriptor_size })) {
+        dbgln_if(LZ4_DEBUG, "LZ4: Frame header checksum mismatch");
+        set_fatal_error();
+        return false;
+    }
+
+    if (m_compressed_block.size() < frame.max_block_size)
+        m_compressed_block = ByteBuffer::create_uninitialized(frame.max_block_size);
+
+    size_t output_buffer_size = frame.max_block_size + (frame.independent_blocks ? 0 : history_size);
+    if (m_output_buffer.size() < output_buffer_size)
+        m_output_buffer = ByteBuffer::create_uninitialized(output_buffer_size);
+    m_output_offset = 0;
+    m_output_end = 0;
+
+    m_current_frame = move(frame);
+    return true;
+}
+
+bool LZ4Decompressor::read_block()
+{
+    auto& frame = m_current_frame.value();
+
+    u32 block_header;
+    if (!read_u32(block_header))
+        return false;
+
+    if (block_header == 0) {
+        // This is the end mark, the frame is complete.
+        if (frame.has_content_checksum) {
+            u32 content_checksum;
+            if (!read_u32(content_checksum))
+                return false;
+            if (content_checksum != frame.checksum.digest()) {
+                dbgln_if(LZ4_DEBUG, "LZ4: Content checksum mismatch");
+                set_fatal_error();
+                return false;
+            }
+        }
+        if (frame.content_size.has_value() && frame.content_size.value() != frame.nread) {
+            dbgln_if(LZ4_DEBUG, "LZ4: Content size mismatch, expected {} got {}", frame.content_size.value(), frame.nread);
+            set_fatal_error();
+            return false;
+        }
+        m_current_frame.clear();
+        return true;
+    }
+
+    bool is_uncompressed = block_header & 0x80000000;
+    size_t block_size = block_header & 0x7fffffff;
+    if (block_size > frame.max_block_size) {
+        set_fatal_error();
+        return false;
+    }
+
+    auto compressed_block = m_compressed_block.bytes().trim(block_size);
+    if (!m_input_stream.read_or_error(compressed_block)) {
+        set_fatal_error();
+        return false;
+    }
+
+    if (frame.has_block_checksum) {
+        u32 block_checksum;
+        if (!read_u32(block_checksum))
+            return false;
+        if (block_checksum != Crypto::Checksum::XXHash32(compressed_block).digest()) {
+            dbgln_if(LZ4_DEBUG, "LZ4: Block checksum mismatch");
+            set_fatal_error();
+            return false;
+        }
+    }
+
+    // Linked blocks may reference up to history_size bytes of previous output, so keep those around.
+    size_t prefix_size = 0;
+    if (!frame.independent_blocks) {
+        prefix_size = min(m_output_end, history_size);
+        if (prefix_size > 0 && m_output_end != prefix_size)
+            __builtin_memmove(m_output_buffer.data(), m_output_buffer.data() + m_output_end - prefix_size, prefix_size);
+    }
+
+    auto output = m_output_buffer.bytes().trim(prefix_size + frame.max_block_size);
+    size_t decompressed_size;
+    if (is_uncompressed) {
+        decompressed_size = compressed_block.copy_to(output.slice(prefix_size));
+    } else {
+        auto result = decompress_block(compressed_block, output, prefix_size);
+        if (!result.has_value()) {
+            dbgln_if(LZ4_DEBUG, "LZ4: Malformed block");
+            set_fatal_error();
+            return false;
+        }
+        decompressed_size = result.value();
+    }
+
+    m_output_offset = prefix_size;
+    m_output_end = prefix_size + decompressed_size;
+
+    auto decompressed = output.slice(prefix_size, decompressed_size);
+    if (frame.has_content_checksum)
+        frame.checksum.update(decompressed);
+    frame.nread += decompressed_size;
+    return true;
+}
+
+size_t LZ4Decompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (has_any_error() || m_eof)
+            break;
+
+        if (m_output_offset < m_output_end) {
+            auto nread = m_output_buffer.bytes().slice(m_output_offset, m_output_end - m_output_offset).copy_trimmed_to(bytes.slice(total_read));
+            m_output_offset += nread;
+            total_read += nread;
+            continue;
+        }
+
+        if (!m_current_frame.has_value()) {
+            if (!read_frame_header())
+                break;
+            continue;
+        }
+
+        if (!read_block())
+            break;
+    }
+    return total_read;
+}
+
+bool LZ4Decompressor::read_or_error(Bytes bytes)
+{
+    if (read(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+bool LZ4Decompressor::discard_or_error(size_t count)
+{
+    u8 buffer[4096];
+
+    size_t ndiscarded = 0;
+    while (ndiscarded < count) {
+        if (unreliable_eof()) {
+            set_fatal_error();
+            return false;
+        }
+
+        ndiscarded += read({ buffer, min<size_t>(count - ndiscarded, sizeof(buffer)) });
+    }
+
+    return true;
+}
+
+Optional<ByteBuffer> LZ4Decompressor::decompress_all(ReadonlyBytes bytes)
+{
+    InputMemoryStream memory_stream { bytes };
+    LZ4Decompressor lz4_stream { memory_stream };
+
+    // Decompress straight into the result instead of going through a DuplexMemoryStream, which
+    // would copy everything twice.
+    ByteBuffer output;
+    size_t output_size = 0;
+    while (!lz4_stream.has_any_error() && !lz4_stream.unreliable_eof()) {
+        if (output_size == output.size())
+            output.resize(max<size_t>(output.size() * 2, 64 * KiB));
+        output_size += lz4_stream.read(output.bytes().slice(output_size));
+    }
+
+    if (lz4_stream.handle_any_error())
+        return {};
+
+    output.resize(output_size);
+    return output;
+}
+
+bool LZ4Decompressor::unreliable_eof() const { return m_eof; }
+
+bool LZ4Decompressor::handle_any_error()
+{
+    bool handled_errors = m_input_stream.handle_any_error();
+    return Stream::handle_any_error() || handled_errors;
+}
+
+// Returns how many bytes starting at a and b are equal, without reading past a_limit.
+static ALWAYS_INLINE size_t count_common_bytes(const u8* a, const u8* b, const u8* a_limit)
+{
+    const u8* a_start = a;
+    while (a + 8 <= a_limit) {
+        u64 difference = read_u64(a) ^ read_u64(b);
+        if (difference != 0) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return a - a_start + __builtin_ctzll(difference) / 8;
+#else
+            return a - a_start + __builtin_clzll(difference) / 8;
+#endif
+        }
+        a += 8;
+        b += 8;
+    }
+    while (a < a_limit && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return a - a_start;
+}
+
+static ALWAYS_INLINE u32 hash_sequence(u32 sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ4Compressor::hash_bits);
+}
+
+Optional<size_t> LZ4Compressor::compress_block(ReadonlyBytes input, Bytes output)
+{
+    const u8* const in_start = input.data();
+    const u8* const in_end = in_start + input.size();
+    u8* out = output.data();
+    u8* const out_end = out + output.size();
+
+    auto write_length_extension = [&](size_t length) {
+        for (; length >= 255; length -= 255)
+            *out++ = 255;
+        *out++ = length;
+    };
+
+    auto emit_sequence = [&](const u8* literals, size_t literal_length, size_t offset, size_t match_length) {
+        // Token, length extensions, literals and the offset, see max_compressed_block_size().
+        size_t worst_case_size = 1 + (literal_length / 255 + 1) + literal_length + 2 + (match_length / 255 + 1);
+        if ((size_t)(out_end - out) < worst_case_size)
+            return false;
+
+        u8* token = out++;
+        *token = min<size_t>(literal_length, 15) << 4;
+        if (literal_length >= 15)
+            write_length_extension(literal_length - 15);
+        __builtin_memcpy(out, literals, literal_length);
+        out += literal_length;
+
+        if (match_length == 0)
+            return true;
+
+        *out++ = offset & 0xff;
+        *out++ = offset >> 8;
+        match_length -= min_match_length;
+        *token |= min<size_t>(match_length, 15);
+        if (match_length >= 15)
+            write_length_extension(match_length - 15);
+        return true;
+    };
+
+    const u8* anchor = in_start;
+
+    if (input.size() > match_find_limit) {
+        u32 hash_table[1 << hash_bits] {};
+
+        const u8* const match_limit = in_end - match_find_limit;
+        const u8* const match_end_limit = in_end - last_literals;
+
+        const u8* position = in_start + 1;
+        hash_table[hash_sequence(read_u32_le(in_start))] = 0;
+
+        while (position < match_limit) {
+            u32 sequence = read_u32_le(position);
+            auto& slot = hash_table[hash_sequence(sequence)];
+            const u8* candidate = in_start + slot;
+            slot = position - in_start;
+
+            if ((size_t)(position - candidate) > max_match_distance || candidate >= position || read_u32_le(candidate) != sequence) {
+                // Skip ahead faster the longer we go without finding a match, incompressible data
+                // would take forever otherwise.
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            while (position > anchor && candidate > in_start && position[-1] == candidate[-1]) {
+                --position;
+                --candidate;
+            }
+
+            const u8* match_end = position + min_match_length;
+            match_end += count_common_bytes(match_end, candidate + min_match_length, match_end_limit);
+
+            if (!emit_sequence(anchor, position - anchor, position - candidate, match_end - position))
+                return {};
+
+            position = match_end;
+            anchor = position;
+
+            // Seed the table with a position inside the match, this noticeably helps with repetitive data.
+            if (position < match_limit)
+                hash_table[hash_sequence(read_u32_le(position - 2))] = position - 2 - in_start;
+        }
+    }
+
+    if (!emit_sequence(anchor, in_end - anchor, 0, 0))
+        return {};
+
+    return out - output.data();
+}
+
+LZ4Compressor::LZ4Compressor(OutputStream& stream)
+    : m_output_stream(stream)
+    , m_pending_block(ByteBuffer::create_uninitialized(block_size))
+    , m_compressed_block(ByteBuffer::create_uninitialized(block_size))
+{
+}
+
+LZ4Compressor::~LZ4Compressor()
+{
+    VERIFY(m_finished);
+}
+
+void LZ4Compressor::write_frame_header()
+{
+    u8 header[7];
+    write_u32_le(header, lz4_frame_magic);
+    header[4] = LZ4FrameFlags::VERSION | LZ4FrameFlags::BLOCK_INDEPENDENCE | LZ4FrameFlags::CONTENT_CHECKSUM;
+    header[5] = 5 << 4; // 256 KiB maximum block size
+    header[6] = header_checksum({ header + 4, 2 });
+    m_output_stream << ReadonlyBytes { header, sizeof(header) };
+    m_wrote_frame_header = true;
+}
+
+void LZ4Compressor::flush()
+{
+    if (!m_wrote_frame_header)
+        write_frame_header();
+
+    if (m_pending_block_size == 0)
+        return;
+
+    auto pending_block = m_pending_block.bytes().trim(m_pending_block_size);
+    m_content_checksum.update(pending_block);
+
+    // Only keep the compressed block if it is actually smaller, otherwise store it as-is.
+    u8 block_header[4];
+    auto compressed_size = compress_block(pending_block, m_compressed_block.bytes().trim(m_pending_block_size - 1));
+    if (compressed_size.has_value()) {
+        write_u32_le(block_header, compressed_size.value());
+        m_output_stream << ReadonlyBytes { block_header, sizeof(block_header) };
+        m_output_stream << m_compressed_block.bytes().trim(compressed_size.value());
+    } else {
+        write_u32_le(block_header, 0x80000000 | m_pending_block_size);
+        m_output_stream << ReadonlyBytes { block_header, sizeof(block_header) };
+        m_output_stream << pending_block;
+    }
+
+    m_pending_block_size = 0;
+}
+
+size_t LZ4Compressor::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    size_t total_written = 0;
+    while (total_written < bytes.size()) {
+        auto n_written = bytes.slice(total_written).copy_trimmed_to(m_pending_block.bytes().slice(m_pending_block_size));
+        m_pending_block_size += n_written;
+        total_written += n_written;
+
+        if (m_pending_block_size == block_size)
+            flush();
+    }
+
+    return total_written;
+}
+
+bool LZ4Compressor::write_or_error(ReadonlyBytes bytes)
+{
+    if (write(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+void LZ4Compressor::final_flush()
+{
+    VERIFY(!m_finished);
+    m_finished = true;
+    flush();
+
+    u8 trailer[8];
+    write_u32_le(trailer, 0); // End mark
+    write_u32_le(trailer + 4, m_content_checksum.digest());
+    m_output_stream << ReadonlyBytes { trailer, sizeof(trailer) };
+}
+
+Optional<ByteBuffer> LZ4Compressor::compress_all(ReadonlyBytes bytes)
+{
+    DuplexMemoryStream output_stream;
+    LZ4Compressor lz4_stream { output_stream };
+
+    lz4_stream.write_or_error(bytes);
+
+    lz4_stream.final_flush();
+
+    if (lz4_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
+}
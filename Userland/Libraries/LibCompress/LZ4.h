@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/Stream.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/XXHash32.h>
+
+namespace Compress {
+
+// LZ4 block and frame formats, as described in:
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md
+// LZ4 trades compression ratio for speed, so it is a better fit than Deflate for data that is
+// written and read by the system itself and never leaves it (coredumps, caches, large IPC buffers).
+
+constexpr u32 lz4_frame_magic = 0x184D2204;
+constexpr u32 lz4_skippable_frame_magic = 0x184D2A50; // The low 4 bits are user-defined.
+constexpr u32 lz4_skippable_frame_magic_mask = 0xFFFFFFF0;
+
+struct LZ4FrameFlags {
+    static constexpr u8 VERSION_MASK = 0b11000000;
+    static constexpr u8 VERSION = 0b01000000;
+    static constexpr u8 BLOCK_INDEPENDENCE = 1 << 5;
+    static constexpr u8 BLOCK_CHECKSUM = 1 << 4;
+    static constexpr u8 CONTENT_SIZE = 1 << 3;
+    static constexpr u8 CONTENT_CHECKSUM = 1 << 2;
+    static constexpr u8 RESERVED = 1 << 1;
+    static constexpr u8 DICTIONARY_ID = 1 << 0;
+};
+
+class LZ4Decompressor final : public InputStream {
+public:
+    static constexpr size_t history_size = 64 * KiB; // Matches can reach at most this far back, also across linked blocks.
+
+    LZ4Decompressor(InputStream&);
+    ~LZ4Decompressor();
+
+    size_t read(Bytes) override;
+    bool read_or_error(Bytes) override;
+    bool discard_or_error(size_t) override;
+
+    bool unreliable_eof() const override;
+    bool handle_any_error() override;
+
+    static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes bytes);
+
+    // Decodes a single raw LZ4 block into output[prefix_size..]. The first prefix_size bytes of
+    // output may be referenced by matches, which is how linked blocks are decoded.
+    // Returns the number of decoded bytes, or an empty Optional if the block is malformed or does not fit.
+    static Optional<size_t> decompress_block(ReadonlyBytes input, Bytes output, size_t prefix_size = 0);
+
+private:
+    struct Frame {
+        bool independent_blocks { true };
+        bool has_block_checksum { false };
+        bool has_content_checksum { false };
+        Optional<u64> content_size;
+        size_t max_block_size { 0 };
+        Crypto::Checksum::XXHash32 checksum;
+        u64 nread { 0 };
+    };
+
+    bool read_u32(u32&);
+    bool read_frame_header();
+    bool read_block();
+
+    InputStream& m_input_stream;
+    Optional<Frame> m_current_frame;
+
+    ByteBuffer m_compressed_block;
+    ByteBuffer m_output_buffer; // Up to history_size bytes of already returned output, followed by the current block.
+    size_t m_output_offset { 0 };
+    size_t m_output_end { 0 };
+
+    bool m_eof { false };
+};
+
+class LZ4Compressor final : public OutputStream {
+public:
+    static constexpr size_t block_size = 256 * KiB;
+    static constexpr size_t hash_bits = 12;
+    static constexpr size_t min_match_length = 4;
+    static constexpr size_t last_literals = 5;     // The last 5 bytes of a block are always literals,
+    static constexpr size_t match_find_limit = 12; // and the last match must start at least 12 bytes before the end.
+    static constexpr size_t max_match_distance = 65535;
+
+    LZ4Compressor(OutputStream&);
+    ~LZ4Compressor();
+
+    size_t write(ReadonlyBytes) override;
+    bool write_or_error(ReadonlyBytes) override;
+    void final_flush();
+
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes);
+
+    // Encodes input as a single raw LZ4 block. Returns the number of bytes written to output,
+    // or an empty Optional if output is too small; max_compressed_block_size() is always enough.
+    static Optional<size_t> compress_block(ReadonlyBytes input, Bytes output);
+    static constexpr size_t max_compressed_block_size(size_t input_size) { return input_size + input_size / 255 + 16; }
+
+private:
+    void write_frame_header();
+    void flush();
+
+    OutputStream& m_output_stream;
+    bool m_wrote_frame_header { false };
+    bool m_finished { false };
+
+    ByteBuffer m_pending_block;
+    size_t m_pending_block_size { 0 };
+    ByteBuffer m_compressed_block;
+    Crypto::Checksum::XXHash32 m_content_checksum;
+};
+
+}
@@ -28,13 +28,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
+// Other hosts (like macOS, for Lagom) don't have epoll, so the event loop hands select() all its fds on every wait there.
+#if defined(__serenity__) || defined(__linux__)
+#    define EVENTLOOP_USES_EPOLL
+#    include <sys/epoll.h>
+#else
+#    include <sys/select.h>
+#endif
+
 namespace Core {
 
 class InspectorServerConnection;
@@ -61,7 +68,22 @@ static EventLoop* s_main_event_loop;
 static Vector<EventLoop&>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
-static HashTable<Notifier*>* s_notifiers;
+
+// All notifiers for the same fd share one entry here, and one watch in the interest set of s_epoll_fd.
+struct NotifiersForFD {
+    HashTable<Notifier*> notifiers;
+    u32 registered_events { 0 };
+    bool is_registered { false };
+
+    // Files that can't be watched (regular files on Linux) are always ready, like select() would have it.
+    bool is_always_ready { false };
+};
+
+static HashMap<int, NotifiersForFD>* s_notifiers;
+static size_t s_always_ready_fd_count;
+#ifdef EVENTLOOP_USES_EPOLL
+static int s_epoll_fd = -1;
+#endif
 int EventLoop::s_wake_pipe_fds[2];
 static RefPtr<InspectorServerConnection> s_inspector_server_connection;
 
@@ -259,7 +281,7 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
-        s_notifiers = new HashTable<Notifier*>;
+        s_notifiers = new HashMap<int, NotifiersForFD>;
     }
 
     if (!s_main_event_loop) {
@@ -274,6 +296,17 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
 
 #endif
         VERIFY(rc == 0);
+
+#ifdef EVENTLOOP_USES_EPOLL
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        VERIFY(s_epoll_fd >= 0);
+        epoll_event wake_event {};
+        wake_event.events = EPOLLIN;
+        wake_event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &wake_event);
+        VERIFY(rc == 0);
+#endif
+
         s_event_loop_stack->append(*this);
 
 #ifdef __serenity__
@@ -555,6 +588,14 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+        s_always_ready_fd_count = 0;
+#ifdef EVENTLOOP_USES_EPOLL
+        // The interest set is shared with the parent, so we must not touch it anymore.
+        if (s_epoll_fd >= 0) {
+            close(s_epoll_fd);
+            s_epoll_fd = -1;
+        }
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -569,33 +610,64 @@ void EventLoop::notify_forked(ForkEvent event)
     VERIFY_NOT_REACHED();
 }
 
-void EventLoop::wait_for_event(WaitMode mode)
-{
+struct ReadyFD {
+    int fd { -1 };
+    bool is_readable { false };
+    bool is_writable { false };
+};
+
+// Waits until the wake pipe or the fd of any notifier is ready, or until the timeout (in milliseconds, or -1 to wait
+// forever) has passed. Returns -1 and sets errno if that fails.
+static int wait_for_ready_fds([[maybe_unused]] int wake_fd, Vector<ReadyFD, 64>& ready_fds, int timeout_ms)
+{
+    ready_fds.clear();
+#ifdef EVENTLOOP_USES_EPOLL
+    epoll_event events[64];
+    int marked_fd_count = epoll_wait(s_epoll_fd, events, array_size(events), timeout_ms);
+    for (int i = 0; i < marked_fd_count; ++i) {
+        // Errors and hangups are reported regardless of what we asked for; like select(), let the reader and writer find out.
+        bool has_error = events[i].events & (EPOLLERR | EPOLLHUP);
+        ready_fds.append({ events[i].data.fd, has_error || (events[i].events & EPOLLIN), has_error || (events[i].events & EPOLLOUT) });
+    }
+    return marked_fd_count;
+#else
     fd_set rfds;
     fd_set wfds;
-retry:
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
+    FD_SET(wake_fd, &rfds);
+    int max_fd = wake_fd;
+    for (auto& it : *s_notifiers) {
+        for (auto* notifier : it.value.notifiers) {
+            if (notifier->event_mask() & Notifier::Read)
+                FD_SET(it.key, &rfds);
+            if (notifier->event_mask() & Notifier::Write)
+                FD_SET(it.key, &wfds);
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+        max_fd = max(max_fd, it.key);
+    }
 
-    int max_fd = 0;
-    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
-        FD_SET(fd, &set);
-        if (fd > max_fd)
-            max_fd = fd;
-    };
-
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
-            VERIFY_NOT_REACHED();
+    timeval timeout { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, timeout_ms < 0 ? nullptr : &timeout);
+    if (marked_fd_count < 0)
+        return marked_fd_count;
+    if (FD_ISSET(wake_fd, &rfds))
+        ready_fds.append({ wake_fd, true, false });
+    for (auto& it : *s_notifiers) {
+        bool is_readable = FD_ISSET(it.key, &rfds);
+        bool is_writable = FD_ISSET(it.key, &wfds);
+        if (is_readable || is_writable)
+            ready_fds.append({ it.key, is_readable, is_writable });
     }
+    return ready_fds.size();
+#endif
+}
 
+void EventLoop::wait_for_event(WaitMode mode)
+{
+retry:
     bool queued_events_is_empty;
     {
         Threading::Locker locker(m_private->lock);
@@ -603,38 +675,42 @@ retry:
     }
 
     timeval now;
-    struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
-    if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
+    int timeout_ms = 0;
+    if (mode == WaitMode::WaitForEvents && queued_events_is_empty && !s_always_ready_fd_count) {
         auto next_timer_expiration = get_next_timer_expiration();
         if (next_timer_expiration.has_value()) {
             timespec now_spec;
             clock_gettime(CLOCK_MONOTONIC_COARSE, &now_spec);
             now.tv_sec = now_spec.tv_sec;
             now.tv_usec = now_spec.tv_nsec / 1000;
+            timeval timeout;
             timeval_sub(next_timer_expiration.value(), now, timeout);
-            if (timeout.tv_sec < 0 || (timeout.tv_sec == 0 && timeout.tv_usec < 0)) {
-                timeout.tv_sec = 0;
-                timeout.tv_usec = 0;
-            }
+            // Round up, so that we don't wake up just before the timer expires.
+            if (timeout.tv_sec >= 0)
+                timeout_ms = timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
         } else {
-            should_wait_forever = true;
+            timeout_ms = -1;
         }
     }
 
-try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    Vector<ReadyFD, 64> ready_fds;
+try_wait_again:
+    int marked_fd_count = wait_for_ready_fds(s_wake_pipe_fds[0], ready_fds, timeout_ms);
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
             if (m_exit_requested)
                 return;
-            goto try_select_again;
+            goto try_wait_again;
         }
         dbgln_if(EVENTLOOP_DEBUG, "Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+
+    for (auto& ready_fd : ready_fds) {
+        if (ready_fd.fd != s_wake_pipe_fds[0])
+            continue;
+
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -644,15 +720,16 @@ try_select_again:
         VERIFY(nread > 0);
         bool wake_requested = false;
         int event_count = nread / sizeof(wake_events[0]);
-        for (int i = 0; i < event_count; i++) {
-            if (wake_events[i] != 0)
-                dispatch_signal(wake_events[i]);
+        for (int j = 0; j < event_count; j++) {
+            if (wake_events[j] != 0)
+                dispatch_signal(wake_events[j]);
             else
                 wake_requested = true;
         }
 
         if (!wake_requested && nread == sizeof(wake_events))
             goto retry;
+        break;
     }
 
     if (!s_timers->is_empty()) {
@@ -684,17 +761,28 @@ try_select_again:
         }
     }
 
-    if (!marked_fd_count)
-        return;
-
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->event_mask() & Notifier::Event::Read)
-                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+    auto post_notifier_events = [&](NotifiersForFD const& entry, int fd, bool is_readable, bool is_writable) {
+        for (auto* notifier : entry.notifiers) {
+            if (is_readable && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if (is_writable && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
         }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->event_mask() & Notifier::Event::Write)
-                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+    };
+
+    for (auto& ready_fd : ready_fds) {
+        if (ready_fd.fd == s_wake_pipe_fds[0])
+            continue;
+        auto it = s_notifiers->find(ready_fd.fd);
+        if (it == s_notifiers->end())
+            continue;
+        post_notifier_events(it->value, ready_fd.fd, ready_fd.is_readable, ready_fd.is_writable);
+    }
+
+    if (s_always_ready_fd_count) {
+        for (auto& it : *s_notifiers) {
+            if (it.value.is_always_ready)
+                post_notifier_events(it.value, it.key, true, true);
         }
     }
 }
@@ -757,14 +845,88 @@ bool EventLoop::unregister_timer(int timer_id)
     return true;
 }
 
+#ifndef EVENTLOOP_USES_EPOLL
+// select() is handed the event masks of all notifiers on every wait, so there's nothing to keep up to date.
+static void update_interest(int, NotifiersForFD&)
+{
+}
+#else
+static void update_interest(int fd, NotifiersForFD& entry)
+{
+    if (entry.is_always_ready)
+        return;
+
+    u32 events = 0;
+    for (auto* notifier : entry.notifiers) {
+        if (notifier->event_mask() & Notifier::Read)
+            events |= EPOLLIN;
+        if (notifier->event_mask() & Notifier::Write)
+            events |= EPOLLOUT;
+        if (notifier->event_mask() & Notifier::Exceptional)
+            VERIFY_NOT_REACHED();
+    }
+    if (entry.is_registered && events == entry.registered_events)
+        return;
+
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    int rc = epoll_ctl(s_epoll_fd, entry.is_registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+    // The fd may have been closed and reused behind our back, which drops it from the interest set,
+    // or still be watched from before such a close.
+    if (rc < 0 && errno == ENOENT)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    else if (rc < 0 && errno == EEXIST)
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+
+    if (rc < 0 && errno == EPERM) {
+        entry.is_always_ready = true;
+        ++s_always_ready_fd_count;
+        return;
+    }
+    if (rc < 0) {
+        dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+        return;
+    }
+    entry.registered_events = events;
+    entry.is_registered = true;
+}
+#endif
+
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    auto& entry = s_notifiers->ensure(notifier.fd());
+    entry.notifiers.set(&notifier);
+    update_interest(notifier.fd(), entry);
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end() || !it->value.notifiers.remove(&notifier))
+        return;
+
+    if (!it->value.notifiers.is_empty()) {
+        update_interest(it->key, it->value);
+        return;
+    }
+
+#ifdef EVENTLOOP_USES_EPOLL
+    // The fd may already be closed, so there's nothing to do if this fails.
+    if (it->value.is_registered)
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, it->key, nullptr);
+#endif
+    if (it->value.is_always_ready)
+        --s_always_ready_fd_count;
+    s_notifiers->remove(it);
+}
+
+void EventLoop::update_notifier(Badge<Notifier>, Notifier& notifier)
+{
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end() || !it->value.notifiers.contains(&notifier))
+        return;
+    update_interest(it->key, it->value);
 }
 
 void EventLoop::wake()
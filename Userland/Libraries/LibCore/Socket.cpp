@@ -74,6 +74,12 @@ void Socket::set_blocking(bool blocking)
     VERIFY(flags == 0);
 }
 
+void Socket::set_read_notifications_enabled(bool enabled)
+{
+    if (m_read_notifier)
+        m_read_notifier->set_enabled(enabled);
+}
+
 bool Socket::connect(const SocketAddress& address, int port)
 {
     VERIFY(!is_connected());
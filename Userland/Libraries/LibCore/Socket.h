@@ -36,6 +36,10 @@ public:
     bool is_connected() const { return m_connected; }
     void set_blocking(bool blocking);
 
+    // Stops on_ready_to_read from being called, e.g. while we're still busy with what we've read so far.
+    // The peer will then be held back by the socket's receive buffer filling up.
+    void set_read_notifications_enabled(bool);
+
     SocketAddress source_address() const { return m_source_address; }
     int source_port() const { return m_source_port; }
 
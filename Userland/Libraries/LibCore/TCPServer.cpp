@@ -38,7 +38,7 @@ TCPServer::~TCPServer()
     ::close(m_fd);
 }
 
-bool TCPServer::listen(const IPv4Address& address, u16 port)
+bool TCPServer::listen(const IPv4Address& address, u16 port, int backlog)
 {
     if (m_listening)
         return false;
@@ -50,7 +50,7 @@ bool TCPServer::listen(const IPv4Address& address, u16 port)
         return false;
     }
 
-    if (::listen(m_fd, 5) < 0) {
+    if (::listen(m_fd, backlog) < 0) {
         perror("TCPServer::listen: listen");
         return false;
     }
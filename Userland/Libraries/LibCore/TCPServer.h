@@ -18,7 +18,8 @@ public:
     virtual ~TCPServer() override;
 
     bool is_listening() const { return m_listening; }
-    bool listen(const IPv4Address& address, u16 port);
+    // The backlog is how many connections the kernel holds on to for us until we accept them.
+    bool listen(const IPv4Address& address, u16 port, int backlog = 5);
     void set_blocking(bool blocking);
 
     RefPtr<TCPSocket> accept();
@@ -7,6 +7,7 @@
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
 #include <LibCompress/Gzip.h>
+#include <LibCompress/LZ4.h>
 #include <LibCoreDump/Reader.h>
 #include <signal_numbers.h>
 #include <string.h>
@@ -39,9 +40,13 @@ Reader::Reader(ReadonlyBytes coredump_bytes)
 
 ByteBuffer Reader::decompress_coredump(const ReadonlyBytes& raw_coredump)
 {
-    if (!Compress::GzipDecompressor::is_likely_compressed(raw_coredump))
+    Optional<ByteBuffer> decompressed_coredump;
+    if (Compress::LZ4Decompressor::is_likely_compressed(raw_coredump))
+        decompressed_coredump = Compress::LZ4Decompressor::decompress_all(raw_coredump);
+    else if (Compress::GzipDecompressor::is_likely_compressed(raw_coredump))
+        decompressed_coredump = Compress::GzipDecompressor::decompress_all(raw_coredump); // handle core dumps from before we switched to LZ4
+    else
         return ByteBuffer::copy(raw_coredump); // handle old format core dumps (uncompressed)
-    auto decompressed_coredump = Compress::GzipDecompressor::decompress_all(raw_coredump);
     if (!decompressed_coredump.has_value())
         return ByteBuffer::copy(raw_coredump); // if we didn't manage to decompress it, try and parse it as decompressed core dump
     return decompressed_coredump.value();
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/XXHash32.h>
+
+namespace Crypto::Checksum {
+
+static ALWAYS_INLINE u32 rotate_left(u32 value, u32 count)
+{
+    return (value << count) | (value >> (32 - count));
+}
+
+static ALWAYS_INLINE u32 read_u32_le(const u8* bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((u32)bytes[3] << 24);
+}
+
+XXHash32::XXHash32(u32 seed)
+    : m_seed(seed)
+{
+    m_accumulators[0] = seed + prime1 + prime2;
+    m_accumulators[1] = seed + prime2;
+    m_accumulators[2] = seed;
+    m_accumulators[3] = seed - prime1;
+}
+
+void XXHash32::consume_stripe(const u8* stripe)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        auto& accumulator = m_accumulators[i];
+        accumulator += read_u32_le(stripe + i * 4) * prime2;
+        accumulator = rotate_left(accumulator, 13);
+        accumulator *= prime1;
+    }
+}
+
+void XXHash32::update(ReadonlyBytes data)
+{
+    m_total_length += data.size();
+
+    size_t offset = 0;
+    if (m_buffered > 0) {
+        auto needed = min(sizeof(m_buffer) - m_buffered, data.size());
+        __builtin_memcpy(m_buffer + m_buffered, data.data(), needed);
+        m_buffered += needed;
+        offset += needed;
+        if (m_buffered < sizeof(m_buffer))
+            return;
+        consume_stripe(m_buffer);
+        m_buffered = 0;
+    }
+
+    for (; offset + sizeof(m_buffer) <= data.size(); offset += sizeof(m_buffer))
+        consume_stripe(data.offset(offset));
+
+    m_buffered = data.size() - offset;
+    if (m_buffered > 0)
+        __builtin_memcpy(m_buffer, data.offset(offset), m_buffered);
+}
+
+u32 XXHash32::digest()
+{
+    u32 hash;
+    if (m_total_length >= sizeof(m_buffer)) {
+        hash = rotate_left(m_accumulators[0], 1) + rotate_left(m_accumulators[1], 7)
+            + rotate_left(m_accumulators[2], 12) + rotate_left(m_accumulators[3], 18);
+    } else {
+        hash = m_seed + prime5;
+    }
+
+    hash += (u32)m_total_length;
+
+    size_t offset = 0;
+    for (; offset + 4 <= m_buffered; offset += 4) {
+        hash += read_u32_le(m_buffer + offset) * prime3;
+        hash = rotate_left(hash, 17) * prime4;
+    }
+    for (; offset < m_buffered; ++offset) {
+        hash += m_buffer[offset] * prime5;
+        hash = rotate_left(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= prime2;
+    hash ^= hash >> 13;
+    hash *= prime3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+}
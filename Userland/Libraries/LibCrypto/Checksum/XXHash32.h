@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Checksum/ChecksumFunction.h>
+
+namespace Crypto::Checksum {
+
+// xxHash32, as used by the LZ4 frame format.
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+class XXHash32 : public ChecksumFunction<u32> {
+public:
+    XXHash32(u32 seed = 0);
+    XXHash32(ReadonlyBytes data)
+        : XXHash32()
+    {
+        update(data);
+    }
+
+    void update(ReadonlyBytes data);
+    u32 digest();
+
+private:
+    static constexpr u32 prime1 = 0x9E3779B1U;
+    static constexpr u32 prime2 = 0x85EBCA77U;
+    static constexpr u32 prime3 = 0xC2B2AE3DU;
+    static constexpr u32 prime4 = 0x27D4EB2FU;
+    static constexpr u32 prime5 = 0x165667B1U;
+
+    void consume_stripe(const u8*);
+
+    u32 m_seed { 0 };
+    u32 m_accumulators[4];
+    u8 m_buffer[16];
+    size_t m_buffered { 0 };
+    u64 m_total_length { 0 };
+};
+
+}
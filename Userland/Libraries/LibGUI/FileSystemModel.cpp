@@ -16,6 +16,7 @@
 #include <LibGUI/FileSystemModel.h>
 #include <LibGUI/Painter.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/JPGLoader.h>
 #include <LibThreading/BackgroundAction.h>
 #include <grp.h>
 #include <pwd.h>
@@ -550,7 +551,12 @@ static HashMap<String, RefPtr<Gfx::Bitmap>> s_thumbnail_cache;
 
 static RefPtr<Gfx::Bitmap> render_thumbnail(const StringView& path)
 {
-    auto png_bitmap = Gfx::Bitmap::load_from_file(path);
+    RefPtr<Gfx::Bitmap> png_bitmap;
+    // JPEGs can be decoded straight at a fraction of their size, which is most of the work for big photos.
+    if (path.ends_with(".jpg", CaseSensitivity::CaseInsensitive) || path.ends_with(".jpeg", CaseSensitivity::CaseInsensitive))
+        png_bitmap = Gfx::load_jpg_for_size(path, { 32, 32 });
+    else
+        png_bitmap = Gfx::Bitmap::load_from_file(path);
     if (!png_bitmap)
         return nullptr;
 
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/Bitmap.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Debug.h>
@@ -11,6 +12,7 @@
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
 #include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
@@ -74,6 +76,9 @@
 
 namespace Gfx {
 
+using AK::SIMD::f32x4;
+using AK::SIMD::i32x4;
+
 constexpr static u8 zigzag_map[64] {
     0, 1, 8, 16, 9, 2, 3, 10,
     17, 24, 32, 25, 18, 11, 4, 5,
@@ -155,12 +160,23 @@ struct StartOfFrame {
     u16 width { 0 };
 };
 
+// Codes up to this length are decoded with a single table lookup.
+constexpr static u8 huffman_lookahead_bits = 9;
+
 struct HuffmanTableSpec {
     u8 type { 0 };
     u8 destination_id { 0 };
     u8 code_counts[16] = { 0 };
     Vector<u8> symbols;
-    Vector<u16> codes;
+
+    // Indexed by the next `huffman_lookahead_bits` bits of the stream. Each entry is
+    // (code length << 8) | symbol, or 0 if the code is longer than the lookahead.
+    u16 lookahead[1 << huffman_lookahead_bits] = { 0 };
+
+    // For codes longer than the lookahead: the largest code of each length (-1 if there
+    // are none), and the offset from a code of that length to the index of its symbol.
+    i32 max_code[17] = { 0 };
+    i32 symbol_offset[17] = { 0 };
 };
 
 struct HuffmanStreamState {
@@ -179,6 +195,10 @@ struct JPGLoadingContext {
 
     State state { State::NotDecoded };
     const u8* data { nullptr };
+    IntSize target_size;
+    // Width and height of each decoded block: 8 for a full size decode, or 4, 2 and 1 when
+    // decoding at 1/2, 1/4 and 1/8 scale.
+    u8 idct_size { 8 };
     size_t data_size { 0 };
     u32 luma_table[64] = { 0 };
     u32 chroma_table[64] = { 0 };
@@ -196,54 +216,91 @@ struct JPGLoadingContext {
     MacroblockMeta mblock_meta;
 };
 
-static void generate_huffman_codes(HuffmanTableSpec& table)
+static bool generate_huffman_codes(HuffmanTableSpec& table)
 {
     unsigned code = 0;
-    for (auto number_of_codes : table.code_counts) {
-        for (int i = 0; i < number_of_codes; i++)
-            table.codes.append(code++);
+    size_t symbol_index = 0;
+    for (u8 length = 1; length <= 16; length++) {
+        auto number_of_codes = table.code_counts[length - 1];
+        if (code + number_of_codes > (1u << length) || symbol_index + number_of_codes > table.symbols.size()) {
+            dbgln_if(JPG_DEBUG, "Invalid huffman table: too many codes of length {}!", length);
+            return false;
+        }
+
+        table.symbol_offset[length] = (i32)symbol_index - (i32)code;
+        for (int i = 0; i < number_of_codes; i++) {
+            if (length <= huffman_lookahead_bits) {
+                // Every lookahead value starting with this code decodes to its symbol.
+                u8 unused_bits = huffman_lookahead_bits - length;
+                u16 entry = (length << 8) | table.symbols[symbol_index];
+                for (unsigned suffix = 0; suffix < (1u << unused_bits); suffix++)
+                    table.lookahead[(code << unused_bits) | suffix] = entry;
+            }
+            code++;
+            symbol_index++;
+        }
+        table.max_code[length] = number_of_codes > 0 ? (i32)code - 1 : -1;
         code <<= 1;
     }
+    return true;
 }
 
-static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t count = 1)
+// Returns the next `count` bits of the stream (MSB first) without consuming them. Bits past
+// the end of the stream read as zero.
+static inline u32 peek_huffman_bits(const HuffmanStreamState& hstream, u8 count)
 {
-    if (count > (8 * sizeof(size_t))) {
+    VERIFY(count <= 16);
+    auto* stream = hstream.stream.data();
+    auto stream_size = hstream.stream.size();
+    u32 window = 0;
+    for (size_t i = 0; i < 3; i++) {
+        size_t offset = hstream.byte_offset + i;
+        window = (window << 8) | (offset < stream_size ? stream[offset] : 0);
+    }
+    return (window >> (24 - hstream.bit_offset - count)) & ((1u << count) - 1);
+}
+
+static inline bool skip_huffman_bits(HuffmanStreamState& hstream, u8 count)
+{
+    size_t bit_position = hstream.bit_offset + count;
+    hstream.byte_offset += bit_position / 8;
+    hstream.bit_offset = bit_position % 8;
+    if (hstream.byte_offset > hstream.stream.size() || (hstream.byte_offset == hstream.stream.size() && hstream.bit_offset > 0)) {
+        dbgln_if(JPG_DEBUG, "Huffman stream exhausted. This could be an error!");
+        return false;
+    }
+    return true;
+}
+
+static Optional<size_t> read_huffman_bits(HuffmanStreamState& hstream, u8 count = 1)
+{
+    if (count > 16) {
         dbgln_if(JPG_DEBUG, "Can't read {} bits at once!", count);
         return {};
     }
-    size_t value = 0;
-    while (count--) {
-        if (hstream.byte_offset >= hstream.stream.size()) {
-            dbgln_if(JPG_DEBUG, "Huffman stream exhausted. This could be an error!");
-            return {};
-        }
-        u8 current_byte = hstream.stream[hstream.byte_offset];
-        u8 current_bit = 1u & (u32)(current_byte >> (7 - hstream.bit_offset)); // MSB first.
-        hstream.bit_offset++;
-        value = (value << 1) | (size_t)current_bit;
-        if (hstream.bit_offset == 8) {
-            hstream.byte_offset++;
-            hstream.bit_offset = 0;
-        }
-    }
+    size_t value = peek_huffman_bits(hstream, count);
+    if (!skip_huffman_bits(hstream, count))
+        return {};
     return value;
 }
 
 static Optional<u8> get_next_symbol(HuffmanStreamState& hstream, const HuffmanTableSpec& table)
 {
-    unsigned code = 0;
-    size_t code_cursor = 0;
-    for (int i = 0; i < 16; i++) { // Codes can't be longer than 16 bits.
-        auto result = read_huffman_bits(hstream);
-        if (!result.has_value())
+    auto entry = table.lookahead[peek_huffman_bits(hstream, huffman_lookahead_bits)];
+    if (entry != 0) {
+        if (!skip_huffman_bits(hstream, entry >> 8))
             return {};
-        code = (code << 1) | (i32)result.release_value();
-        for (int j = 0; j < table.code_counts[i]; j++) {
-            if (code == table.codes[code_cursor])
-                return table.symbols[code_cursor];
-            code_cursor++;
-        }
+        return entry & 0xFF;
+    }
+
+    // Codes can't be longer than 16 bits.
+    for (u8 length = huffman_lookahead_bits + 1; length <= 16; length++) {
+        i32 code = peek_huffman_bits(hstream, length);
+        if (code > table.max_code[length])
+            continue;
+        if (!skip_huffman_bits(hstream, length))
+            return {};
+        return table.symbols[code + table.symbol_offset[length]];
     }
 
     dbgln_if(JPG_DEBUG, "If you're seeing this...the jpeg decoder needs to support more kinds of JPEGs!");
@@ -381,17 +438,23 @@ static Optional<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& con
     }
 
     // Compute huffman codes for DC and AC tables.
-    for (auto it = context.dc_tables.begin(); it != context.dc_tables.end(); ++it)
-        generate_huffman_codes(it->value);
+    for (auto it = context.dc_tables.begin(); it != context.dc_tables.end(); ++it) {
+        if (!generate_huffman_codes(it->value))
+            return {};
+    }
 
-    for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it)
-        generate_huffman_codes(it->value);
+    for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it) {
+        if (!generate_huffman_codes(it->value))
+            return {};
+    }
 
+    // The restart interval counts MCUs, and there is no restart marker before the first one.
+    u32 mcu_index = 0;
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
+        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor, ++mcu_index) {
             u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
             if (context.dc_reset_interval > 0) {
-                if (i % context.dc_reset_interval == 0) {
+                if (mcu_index > 0 && mcu_index % context.dc_reset_interval == 0) {
                     context.previous_dc_values[0] = 0;
                     context.previous_dc_values[1] = 0;
                     context.previous_dc_values[2] = 0;
@@ -627,7 +690,7 @@ static bool read_huffman_table(InputMemoryStream& stream, JPGLoadingContext& con
             table.code_counts[i] = count;
         }
 
-        table.codes.ensure_capacity(total_codes);
+        table.symbols.ensure_capacity(total_codes);
 
         // Read symbols. Read X bytes, where X is the sum of the counts of codes read in the previous step.
         for (u32 i = 0; i < total_codes; i++) {
@@ -862,7 +925,9 @@ static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macrobloc
     }
 }
 
-static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+// Runs the 1-D AAN inverse DCT on four adjacent columns at once. Each vector holds the
+// values of one row of those columns.
+static inline void inverse_dct_8x4(f32x4 (&values)[8])
 {
     static const float m0 = 2.0 * cos(1.0 / 16.0 * 2.0 * M_PI);
     static const float m1 = 2.0 * cos(2.0 / 16.0 * 2.0 * M_PI);
@@ -879,6 +944,141 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
     static const float s6 = cos(6.0 / 16.0 * M_PI) / 2.0;
     static const float s7 = cos(7.0 / 16.0 * M_PI) / 2.0;
 
+    const f32x4 g0 = values[0] * s0;
+    const f32x4 g1 = values[4] * s4;
+    const f32x4 g2 = values[2] * s2;
+    const f32x4 g3 = values[6] * s6;
+    const f32x4 g4 = values[5] * s5;
+    const f32x4 g5 = values[1] * s1;
+    const f32x4 g6 = values[7] * s7;
+    const f32x4 g7 = values[3] * s3;
+
+    const f32x4 f0 = g0;
+    const f32x4 f1 = g1;
+    const f32x4 f2 = g2;
+    const f32x4 f3 = g3;
+    const f32x4 f4 = g4 - g7;
+    const f32x4 f5 = g5 + g6;
+    const f32x4 f6 = g5 - g6;
+    const f32x4 f7 = g4 + g7;
+
+    const f32x4 e0 = f0;
+    const f32x4 e1 = f1;
+    const f32x4 e2 = f2 - f3;
+    const f32x4 e3 = f2 + f3;
+    const f32x4 e4 = f4;
+    const f32x4 e5 = f5 - f7;
+    const f32x4 e6 = f6;
+    const f32x4 e7 = f5 + f7;
+    const f32x4 e8 = f4 + f6;
+
+    const f32x4 d0 = e0;
+    const f32x4 d1 = e1;
+    const f32x4 d2 = e2 * m1;
+    const f32x4 d3 = e3;
+    const f32x4 d4 = e4 * m2;
+    const f32x4 d5 = e5 * m3;
+    const f32x4 d6 = e6 * m4;
+    const f32x4 d7 = e7;
+    const f32x4 d8 = e8 * m5;
+
+    const f32x4 c0 = d0 + d1;
+    const f32x4 c1 = d0 - d1;
+    const f32x4 c2 = d2 - d3;
+    const f32x4 c3 = d3;
+    const f32x4 c4 = d4 + d8;
+    const f32x4 c5 = d5 + d7;
+    const f32x4 c6 = d6 - d8;
+    const f32x4 c7 = d7;
+    const f32x4 c8 = c5 - c6;
+
+    const f32x4 b0 = c0 + c3;
+    const f32x4 b1 = c1 + c2;
+    const f32x4 b2 = c1 - c2;
+    const f32x4 b3 = c0 - c3;
+    const f32x4 b4 = c4 - c8;
+    const f32x4 b5 = c8;
+    const f32x4 b6 = c6 - c7;
+    const f32x4 b7 = c7;
+
+    values[0] = b0 + b7;
+    values[1] = b1 + b6;
+    values[2] = b2 + b5;
+    values[3] = b3 + b4;
+    values[4] = b3 - b4;
+    values[5] = b2 - b5;
+    values[6] = b1 - b6;
+    values[7] = b0 - b7;
+}
+
+static void inverse_dct_block(i32* block_component)
+{
+    // The column pass stores its output transposed, so that the row pass can run on
+    // vectors of four rows as well. The row pass transposes it back.
+    float workspace[64];
+    for (u32 half = 0; half < 2; ++half) {
+        f32x4 values[8];
+        for (u32 row = 0; row < 8; ++row) {
+            i32x4 coefficients;
+            __builtin_memcpy(&coefficients, &block_component[row * 8 + half * 4], sizeof(coefficients));
+            values[row] = __builtin_convertvector(coefficients, f32x4);
+        }
+        inverse_dct_8x4(values);
+        for (u32 row = 0; row < 8; ++row) {
+            for (u32 lane = 0; lane < 4; ++lane)
+                workspace[(half * 4 + lane) * 8 + row] = values[row][lane];
+        }
+    }
+
+    for (u32 half = 0; half < 2; ++half) {
+        f32x4 values[8];
+        for (u32 column = 0; column < 8; ++column)
+            __builtin_memcpy(&values[column], &workspace[column * 8 + half * 4], sizeof(f32x4));
+        inverse_dct_8x4(values);
+        for (u32 column = 0; column < 8; ++column) {
+            for (u32 lane = 0; lane < 4; ++lane)
+                block_component[(half * 4 + lane) * 8 + column] = values[column][lane];
+        }
+    }
+}
+
+// Computes a size x size output block from the size x size lowest frequency coefficients,
+// leaving it in the top-left corner of the block. Each output sample approximates the
+// average of the (8 / size)^2 samples a full inverse DCT would produce.
+template<u8 size>
+static void inverse_dct_block_reduced(i32* block_component)
+{
+    static const auto basis = [] {
+        Array<float, size * size> basis;
+        for (u32 x = 0; x < size; ++x) {
+            for (u32 u = 0; u < size; ++u)
+                basis[x * size + u] = (u == 0 ? 1.0 / sqrt(8) : 0.5) * cos((2 * x + 1) * u * M_PI / (2 * size));
+        }
+        return basis;
+    }();
+
+    float workspace[size * size];
+    for (u32 y = 0; y < size; ++y) {
+        for (u32 u = 0; u < size; ++u) {
+            float sum = 0;
+            for (u32 v = 0; v < size; ++v)
+                sum += basis[y * size + v] * block_component[v * 8 + u];
+            workspace[y * size + u] = sum;
+        }
+    }
+
+    for (u32 y = 0; y < size; ++y) {
+        for (u32 x = 0; x < size; ++x) {
+            float sum = 0;
+            for (u32 u = 0; u < size; ++u)
+                sum += basis[x * size + u] * workspace[y * size + u];
+            block_component[y * 8 + x] = sum;
+        }
+    }
+}
+
+static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+{
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             for (u32 component_i = 0; component_i < context.component_count; component_i++) {
@@ -888,139 +1088,21 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
                         u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
                         Macroblock& block = macroblocks[mb_index];
                         i32* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            const float g0 = block_component[0 * 8 + k] * s0;
-                            const float g1 = block_component[4 * 8 + k] * s4;
-                            const float g2 = block_component[2 * 8 + k] * s2;
-                            const float g3 = block_component[6 * 8 + k] * s6;
-                            const float g4 = block_component[5 * 8 + k] * s5;
-                            const float g5 = block_component[1 * 8 + k] * s1;
-                            const float g6 = block_component[7 * 8 + k] * s7;
-                            const float g7 = block_component[3 * 8 + k] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            const float g0 = block_component[l * 8 + 0] * s0;
-                            const float g1 = block_component[l * 8 + 4] * s4;
-                            const float g2 = block_component[l * 8 + 2] * s2;
-                            const float g3 = block_component[l * 8 + 6] * s6;
-                            const float g4 = block_component[l * 8 + 5] * s5;
-                            const float g5 = block_component[l * 8 + 1] * s1;
-                            const float g6 = block_component[l * 8 + 7] * s7;
-                            const float g7 = block_component[l * 8 + 3] * s3;
-
-                            const float f0 = g0;
-                            const float f1 = g1;
-                            const float f2 = g2;
-                            const float f3 = g3;
-                            const float f4 = g4 - g7;
-                            const float f5 = g5 + g6;
-                            const float f6 = g5 - g6;
-                            const float f7 = g4 + g7;
-
-                            const float e0 = f0;
-                            const float e1 = f1;
-                            const float e2 = f2 - f3;
-                            const float e3 = f2 + f3;
-                            const float e4 = f4;
-                            const float e5 = f5 - f7;
-                            const float e6 = f6;
-                            const float e7 = f5 + f7;
-                            const float e8 = f4 + f6;
-
-                            const float d0 = e0;
-                            const float d1 = e1;
-                            const float d2 = e2 * m1;
-                            const float d3 = e3;
-                            const float d4 = e4 * m2;
-                            const float d5 = e5 * m3;
-                            const float d6 = e6 * m4;
-                            const float d7 = e7;
-                            const float d8 = e8 * m5;
-
-                            const float c0 = d0 + d1;
-                            const float c1 = d0 - d1;
-                            const float c2 = d2 - d3;
-                            const float c3 = d3;
-                            const float c4 = d4 + d8;
-                            const float c5 = d5 + d7;
-                            const float c6 = d6 - d8;
-                            const float c7 = d7;
-                            const float c8 = c5 - c6;
-
-                            const float b0 = c0 + c3;
-                            const float b1 = c1 + c2;
-                            const float b2 = c1 - c2;
-                            const float b3 = c0 - c3;
-                            const float b4 = c4 - c8;
-                            const float b5 = c8;
-                            const float b6 = c6 - c7;
-                            const float b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
+                        switch (context.idct_size) {
+                        case 8:
+                            inverse_dct_block(block_component);
+                            break;
+                        case 4:
+                            inverse_dct_block_reduced<4>(block_component);
+                            break;
+                        case 2:
+                            inverse_dct_block_reduced<2>(block_component);
+                            break;
+                        case 1:
+                            inverse_dct_block_reduced<1>(block_component);
+                            break;
+                        default:
+                            VERIFY_NOT_REACHED();
                         }
                     }
                 }
@@ -1029,56 +1111,71 @@ static void inverse_dct(const JPGLoadingContext& context, Vector<Macroblock>& ma
     }
 }
 
-static void ycbcr_to_rgb(const JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static inline i32x4 clamp_to_u8(i32x4 value)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            const Macroblock& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    i32* y = macroblocks[mb_index].y;
-                    i32* cb = macroblocks[mb_index].cb;
-                    i32* cr = macroblocks[mb_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
-                            y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
-                            cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
-                            cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
-                        }
-                    }
-                }
-            }
-        }
+    value = value < 0 ? 0 : value;
+    return value > 255 ? 255 : value;
+}
+
+// Converts the YCbCr samples of one scanline to RGB, four pixels at a time. The sample
+// buffers must be padded to a multiple of four.
+static void ycbcr_to_rgb(const i32* luma, const i32* cb, const i32* cr, RGBA32* scanline, u32 width)
+{
+    for (u32 x = 0; x < width; x += 4) {
+        i32x4 y_samples, cb_samples, cr_samples;
+        __builtin_memcpy(&y_samples, &luma[x], sizeof(i32x4));
+        __builtin_memcpy(&cb_samples, &cb[x], sizeof(i32x4));
+        __builtin_memcpy(&cr_samples, &cr[x], sizeof(i32x4));
+        const f32x4 y = __builtin_convertvector(y_samples, f32x4) + 128.0f;
+        const f32x4 cb_values = __builtin_convertvector(cb_samples, f32x4);
+        const f32x4 cr_values = __builtin_convertvector(cr_samples, f32x4);
+
+        const i32x4 r = clamp_to_u8(__builtin_convertvector(y + 1.402f * cr_values, i32x4));
+        const i32x4 g = clamp_to_u8(__builtin_convertvector(y - 0.344f * cb_values - 0.714f * cr_values, i32x4));
+        const i32x4 b = clamp_to_u8(__builtin_convertvector(y + 1.772f * cb_values, i32x4));
+        const i32x4 pixels = (i32)0xff000000 | (r << 16) | (g << 8) | b;
+
+        u32 pixel_count = min(4u, width - x);
+        for (u32 lane = 0; lane < pixel_count; ++lane)
+            scanline[x + lane] = pixels[lane];
     }
 }
 
 static bool compose_bitmap(JPGLoadingContext& context, const Vector<Macroblock>& macroblocks)
 {
-    context.bitmap = Bitmap::create_purgeable(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height });
+    const u32 block_size = context.idct_size;
+    const u32 width = (context.frame.width * block_size + 7) / 8;
+    const u32 height = (context.frame.height * block_size + 7) / 8;
+    context.bitmap = Bitmap::create_purgeable(BitmapFormat::BGRx8888, { (int)width, (int)height });
     if (!context.bitmap)
         return false;
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
+    // Gather each scanline's samples out of the macroblocks first, so that the color
+    // conversion can run on contiguous buffers.
+    const u32 padded_width = (width + 3) & ~3u;
+    Vector<i32> luma, cb, cr;
+    luma.resize(padded_width);
+    cb.resize(padded_width);
+    cr.resize(padded_width);
+
+    for (u32 y = 0; y < height; y++) {
+        const u32 block_row = y / block_size;
+        const u32 pixel_row = y % block_size;
+        // Chroma samples are stored in the top-left block of each MCU.
+        const u32 chroma_block_row = block_row - block_row % context.vsample_factor;
+        const u32 chroma_pixel_row = (pixel_row + (block_row - chroma_block_row) * block_size) / context.vsample_factor;
+        for (u32 x = 0; x < width; x++) {
+            const u32 block_column = x / block_size;
+            const u32 pixel_column = x % block_size;
+            const u32 chroma_block_column = block_column - block_column % context.hsample_factor;
+            const u32 chroma_pixel_column = (pixel_column + (block_column - chroma_block_column) * block_size) / context.hsample_factor;
             auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+            auto& chroma = macroblocks[chroma_block_row * context.mblock_meta.hpadded_count + chroma_block_column];
+            luma[x] = block.y[pixel_row * 8 + pixel_column];
+            cb[x] = chroma.cb[chroma_pixel_row * 8 + chroma_pixel_column];
+            cr[x] = chroma.cr[chroma_pixel_row * 8 + chroma_pixel_column];
         }
+        ycbcr_to_rgb(luma.data(), cb.data(), cr.data(), context.bitmap->scanline(y), width);
     }
 
     return true;
@@ -1197,12 +1294,24 @@ static bool scan_huffman_stream(InputMemoryStream& stream, JPGLoadingContext& co
     VERIFY_NOT_REACHED();
 }
 
+static u8 idct_size_for_target_size(const StartOfFrame& frame, const IntSize& target_size)
+{
+    // The image will be shrunk to fit the target size, so only its tighter axis matters.
+    float scale = min((float)target_size.width() / frame.width, (float)target_size.height() / frame.height);
+    u8 idct_size = 8;
+    while (idct_size > 1 && scale * 8 <= idct_size / 2)
+        idct_size /= 2;
+    return idct_size;
+}
+
 static bool decode_jpg(JPGLoadingContext& context)
 {
     InputMemoryStream stream { { context.data, context.data_size } };
 
     if (!parse_header(stream, context))
         return false;
+    if (!context.target_size.is_empty())
+        context.idct_size = idct_size_for_target_size(context.frame, context.target_size);
     if (!scan_huffman_stream(stream, context))
         return false;
 
@@ -1215,17 +1324,17 @@ static bool decode_jpg(JPGLoadingContext& context)
     auto macroblocks = result.release_value();
     dequantize(context, macroblocks);
     inverse_dct(context, macroblocks);
-    ycbcr_to_rgb(context, macroblocks);
     if (!compose_bitmap(context, macroblocks))
         return false;
     return true;
 }
 
-static RefPtr<Gfx::Bitmap> load_jpg_impl(const u8* data, size_t data_size)
+static RefPtr<Gfx::Bitmap> load_jpg_impl(const u8* data, size_t data_size, const IntSize& target_size = {})
 {
     JPGLoadingContext context;
     context.data = data;
     context.data_size = data_size;
+    context.target_size = target_size;
 
     if (!decode_jpg(context))
         return nullptr;
@@ -1244,6 +1353,17 @@ RefPtr<Gfx::Bitmap> load_jpg(String const& path)
     return bitmap;
 }
 
+RefPtr<Gfx::Bitmap> load_jpg_for_size(String const& path, IntSize const& target_size)
+{
+    auto file_or_error = MappedFile::map(path);
+    if (file_or_error.is_error())
+        return nullptr;
+    auto bitmap = load_jpg_impl((const u8*)file_or_error.value()->data(), file_or_error.value()->size(), target_size);
+    if (bitmap)
+        bitmap->set_mmap_name(String::formatted("Gfx::Bitmap [{}] - Decoded JPG: {}", bitmap->size(), LexicalPath::canonicalized_path(path)));
+    return bitmap;
+}
+
 RefPtr<Gfx::Bitmap> load_jpg_from_memory(const u8* data, size_t length)
 {
     auto bitmap = load_jpg_impl(data, length);
@@ -16,6 +16,10 @@ namespace Gfx {
 RefPtr<Gfx::Bitmap> load_jpg(String const& path);
 RefPtr<Gfx::Bitmap> load_jpg_from_memory(const u8* data, size_t length);
 
+// Decodes the image at 1/1, 1/2, 1/4 or 1/8 of its size, picking the smallest scale that still
+// has enough pixels to draw it shrunk to fit `target_size`. Much cheaper for thumbnails.
+RefPtr<Gfx::Bitmap> load_jpg_for_size(String const& path, IntSize const& target_size);
+
 struct JPGLoadingContext;
 
 class JPGImageDecoderPlugin : public ImageDecoderPlugin {
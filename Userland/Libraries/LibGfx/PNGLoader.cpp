@@ -8,7 +8,8 @@
 #include <AK/Endian.h>
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
-#include <LibCompress/Zlib.h>
+#include <AK/SIMD.h>
+#include <LibCompress/Deflate.h>
 #include <LibGfx/PNGLoader.h>
 #include <fcntl.h>
 #include <math.h>
@@ -19,12 +20,16 @@
 #include <unistd.h>
 
 #ifdef __serenity__
-#    include <LibCompress/Deflate.h>
 #    include <serenity.h>
 #endif
 
 namespace Gfx {
 
+using AK::SIMD::i32x4;
+using AK::SIMD::u16x4;
+using AK::SIMD::u8x16;
+using AK::SIMD::u8x4;
+
 static const u8 png_header[8] = { 0x89, 'P', 'N', 'G', 13, 10, 26, 10 };
 
 struct PNG_IHDR {
@@ -39,11 +44,6 @@ struct PNG_IHDR {
 
 static_assert(sizeof(PNG_IHDR) == 13);
 
-struct Scanline {
-    u8 filter { 0 };
-    ReadonlyBytes data {};
-};
-
 struct [[gnu::packed]] PaletteEntry {
     u8 r;
     u8 g;
@@ -99,10 +99,9 @@ struct PNGLoadingContext {
     u8 channels { 0 };
     bool has_seen_zlib_header { false };
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
-    Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
-    ByteBuffer* decompression_buffer { nullptr };
-    Vector<u8> compressed_data;
+    // The IDAT chunk payloads, pointing into `data`. Together they form the zlib stream.
+    Vector<ReadonlyBytes> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
 
@@ -119,6 +118,10 @@ struct PNGLoadingContext {
         }
         return row_size;
     }
+
+    // Filters predict each byte from the same byte of the previous pixel, or the previous byte
+    // for bit depths below 8.
+    size_t filter_stride() const { return max(1, channels * bit_depth / 8); }
 };
 
 class Streamer {
@@ -167,6 +170,62 @@ private:
     size_t m_size_remaining { 0 };
 };
 
+// Presents the IDAT chunks as one stream, so they can be inflated without copying them together first.
+class IDATStream final : public InputStream {
+public:
+    explicit IDATStream(const Vector<ReadonlyBytes>& chunks)
+        : m_chunks(chunks)
+    {
+    }
+
+    size_t read(Bytes bytes) override
+    {
+        if (has_any_error())
+            return 0;
+
+        size_t nread = 0;
+        while (nread < bytes.size() && m_chunk_index < m_chunks.size()) {
+            auto& chunk = m_chunks[m_chunk_index];
+            auto ncopied = chunk.slice(m_chunk_offset).copy_trimmed_to(bytes.slice(nread));
+            nread += ncopied;
+            m_chunk_offset += ncopied;
+            if (m_chunk_offset == chunk.size()) {
+                ++m_chunk_index;
+                m_chunk_offset = 0;
+            }
+        }
+        return nread;
+    }
+
+    bool read_or_error(Bytes bytes) override
+    {
+        if (read(bytes) < bytes.size()) {
+            set_fatal_error();
+            return false;
+        }
+        return true;
+    }
+
+    bool discard_or_error(size_t count) override
+    {
+        u8 buffer[4096];
+        while (count > 0) {
+            auto chunk_size = min(count, sizeof(buffer));
+            if (!read_or_error({ buffer, chunk_size }))
+                return false;
+            count -= chunk_size;
+        }
+        return true;
+    }
+
+    bool unreliable_eof() const override { return m_chunk_index >= m_chunks.size(); }
+
+private:
+    const Vector<ReadonlyBytes>& m_chunks;
+    size_t m_chunk_index { 0 };
+    size_t m_chunk_offset { 0 };
+};
+
 static RefPtr<Gfx::Bitmap> load_png_impl(const u8*, size_t);
 static bool process_chunk(Streamer&, PNGLoadingContext& context);
 
@@ -202,169 +261,161 @@ ALWAYS_INLINE static u8 paeth_predictor(int a, int b, int c)
     return c;
 }
 
-union [[gnu::packed]] Pixel {
-    RGBA32 rgba { 0 };
-    u8 v[4];
-    struct {
-        u8 r;
-        u8 g;
-        u8 b;
-        u8 a;
-    };
-};
-static_assert(sizeof(Pixel) == 4);
+ALWAYS_INLINE static i32x4 absolute_value(i32x4 value)
+{
+    return value < 0 ? -value : value;
+}
 
-template<bool has_alpha, u8 filter_type>
-ALWAYS_INLINE static void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void* dummy_scanline_data)
+ALWAYS_INLINE static u8x4 paeth_predictor(u8x4 a_bytes, u8x4 b_bytes, u8x4 c_bytes)
 {
-    auto* dummy_scanline = (const Pixel*)dummy_scanline_data;
-    if constexpr (filter_type == 0) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
+    auto a = __builtin_convertvector(a_bytes, i32x4);
+    auto b = __builtin_convertvector(b_bytes, i32x4);
+    auto c = __builtin_convertvector(c_bytes, i32x4);
+    // These are |p - a|, |p - b| and |p - c| with p = a + b - c.
+    auto pa = absolute_value(b - c);
+    auto pb = absolute_value(a - c);
+    auto pc = absolute_value(a + b - c - c);
+    auto prediction = ((pa <= pb) & (pa <= pc)) ? a : (pb <= pc ? b : c);
+    return __builtin_convertvector(prediction, u8x4);
+}
 
-    if constexpr (filter_type == 1) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        swap(pixels[0].r, pixels[0].b);
-        for (int i = 1; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            auto& a = (const Pixel&)pixels[i - 1];
-            x.v[0] += a.v[0];
-            x.v[1] += a.v[1];
-            x.v[2] += a.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += a.v[3];
-        }
-        return;
-    }
-    if constexpr (filter_type == 2) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] += b.v[0];
-            x.v[1] += b.v[1];
-            x.v[2] += b.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += b.v[3];
-        }
-        return;
-    }
-    if constexpr (filter_type == 3) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (const Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            if (i != 0)
-                a = pixels[i - 1];
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] = x.v[0] + ((a.v[0] + b.v[0]) / 2);
-            x.v[1] = x.v[1] + ((a.v[1] + b.v[1]) / 2);
-            x.v[2] = x.v[2] + ((a.v[2] + b.v[2]) / 2);
-            if constexpr (has_alpha)
-                x.v[3] = x.v[3] + ((a.v[3] + b.v[3]) / 2);
-        }
-        return;
-    }
-    if constexpr (filter_type == 4) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            const Pixel& b = pixels_y_minus_1[i];
-            Pixel c;
-            if (i != 0) {
-                a = pixels[i - 1];
-                c = pixels_y_minus_1[i - 1];
-            }
-            x.v[0] += paeth_predictor(a.v[0], b.v[0], c.v[0]);
-            x.v[1] += paeth_predictor(a.v[1], b.v[1], c.v[1]);
-            x.v[2] += paeth_predictor(a.v[2], b.v[2], c.v[2]);
-            if constexpr (has_alpha)
-                x.v[3] += paeth_predictor(a.v[3], b.v[3], c.v[3]);
-        }
+template<size_t stride>
+ALWAYS_INLINE static u8x4 load_pixel(const u8* data)
+{
+    u8x4 pixel {};
+    __builtin_memcpy(&pixel, data, stride);
+    return pixel;
+}
+
+template<size_t stride>
+ALWAYS_INLINE static void store_pixel(u8* data, u8x4 pixel)
+{
+    __builtin_memcpy(data, &pixel, stride);
+}
+
+// Unfilters 3 and 4 byte pixels, working on all bytes of a pixel at once.
+template<size_t stride, u8 filter_type>
+static void unfilter_pixels(Bytes scanline, ReadonlyBytes previous_scanline)
+{
+    static_assert(stride == 3 || stride == 4);
+    auto* data = scanline.data();
+    auto* previous_data = previous_scanline.data();
+    u8x4 a {};
+    u8x4 c {};
+    for (size_t i = 0; i + stride <= scanline.size(); i += stride) {
+        auto x = load_pixel<stride>(&data[i]);
+        auto b = load_pixel<stride>(&previous_data[i]);
+        if constexpr (filter_type == 1)
+            x += a;
+        if constexpr (filter_type == 3)
+            x += __builtin_convertvector((__builtin_convertvector(a, u16x4) + __builtin_convertvector(b, u16x4)) >> 1, u8x4);
+        if constexpr (filter_type == 4)
+            x += paeth_predictor(a, b, c);
+        store_pixel<stride>(&data[i], x);
+        a = x;
+        c = b;
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
-{
-    for (int y = 0; y < context.height; ++y) {
-        auto* gray_values = reinterpret_cast<const T*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = gray_values[i];
-            pixel.g = gray_values[i];
-            pixel.b = gray_values[i];
-            pixel.a = 0xff;
-        }
+template<size_t stride>
+static void unfilter_pixels(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline)
+{
+    switch (filter) {
+    case 1:
+        unfilter_pixels<stride, 1>(scanline, previous_scanline);
+        break;
+    case 3:
+        unfilter_pixels<stride, 3>(scanline, previous_scanline);
+        break;
+    case 4:
+        unfilter_pixels<stride, 4>(scanline, previous_scanline);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
-{
-    for (int y = 0; y < context.height; ++y) {
-        auto* tuples = reinterpret_cast<const Tuple<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = tuples[i].gray;
-            pixel.g = tuples[i].gray;
-            pixel.b = tuples[i].gray;
-            pixel.a = tuples[i].a;
+static void unfilter_bytes(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline, size_t stride)
+{
+    auto* data = scanline.data();
+    auto* previous_data = previous_scanline.data();
+    for (size_t i = 0; i < scanline.size(); ++i) {
+        u8 a = i >= stride ? data[i - stride] : 0;
+        u8 b = previous_data[i];
+        u8 c = i >= stride ? previous_data[i - stride] : 0;
+        switch (filter) {
+        case 1:
+            data[i] += a;
+            break;
+        case 3:
+            data[i] += (a + b) / 2;
+            break;
+        case 4:
+            data[i] += paeth_predictor(a, b, c);
+            break;
+        default:
+            VERIFY_NOT_REACHED();
         }
     }
 }
 
-template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
-{
-    for (int y = 0; y < context.height; ++y) {
-        auto* triplets = reinterpret_cast<const Triplet<T>*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = triplets[i].r;
-            pixel.g = triplets[i].g;
-            pixel.b = triplets[i].b;
-            pixel.a = 0xff;
+static void unfilter_scanline(u8 filter, Bytes scanline, ReadonlyBytes previous_scanline, size_t stride)
+{
+    VERIFY(scanline.size() == previous_scanline.size());
+
+    if (filter == 0)
+        return;
+
+    if (filter == 2) {
+        // Up doesn't depend on the pixel to the left, so it can run 16 bytes at a time.
+        auto* data = scanline.data();
+        auto* previous_data = previous_scanline.data();
+        size_t i = 0;
+        for (; i + sizeof(u8x16) <= scanline.size(); i += sizeof(u8x16)) {
+            u8x16 x, b;
+            __builtin_memcpy(&x, &data[i], sizeof(x));
+            __builtin_memcpy(&b, &previous_data[i], sizeof(b));
+            x += b;
+            __builtin_memcpy(&data[i], &x, sizeof(x));
         }
+        for (; i < scanline.size(); ++i)
+            data[i] += previous_data[i];
+        return;
     }
+
+    if (stride == 3)
+        unfilter_pixels<3>(filter, scanline, previous_scanline);
+    else if (stride == 4)
+        unfilter_pixels<4>(filter, scanline, previous_scanline);
+    else
+        unfilter_bytes(filter, scanline, previous_scanline, stride);
 }
 
-NEVER_INLINE FLATTEN static bool unfilter(PNGLoadingContext& context)
+// Converts one unfiltered scanline to BGRA pixels. 16-bit samples are big endian and get
+// truncated to their high byte.
+static bool unpack_scanline(const PNGLoadingContext& context, ReadonlyBytes scanline, RGBA32* pixels, int width)
 {
-    // First unpack the scanlines to RGBA:
+    auto* data = scanline.data();
+
+    auto sample_at = [&](int x) -> u8 {
+        auto pixels_per_byte = 8 / context.bit_depth;
+        auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
+        return (data[x / pixels_per_byte] >> bit_offset) & ((1 << context.bit_depth) - 1);
+    };
+
     switch (context.color_type) {
     case 0:
         if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x], data[x], data[x]).value();
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 2], data[x * 2], data[x * 2]).value();
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
-            auto bit_depth_squared = context.bit_depth * context.bit_depth;
-            auto pixels_per_byte = 8 / context.bit_depth;
-            auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* gray_values = context.scanlines[y].data.data();
-                for (int x = 0; x < context.width; ++x) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
-                    auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[x];
-                    pixel.r = value * (0xff / bit_depth_squared);
-                    pixel.g = value * (0xff / bit_depth_squared);
-                    pixel.b = value * (0xff / bit_depth_squared);
-                    pixel.a = 0xff;
-                }
+            auto max_value = (1 << context.bit_depth) - 1;
+            for (int x = 0; x < width; ++x) {
+                u8 gray = sample_at(x) * 0xff / max_value;
+                pixels[x] = Color(gray, gray, gray).value();
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -372,83 +423,47 @@ NEVER_INLINE FLATTEN static bool unfilter(PNGLoadingContext& context)
         break;
     case 4:
         if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 2], data[x * 2], data[x * 2], data[x * 2 + 1]).value();
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 4], data[x * 4], data[x * 4], data[x * 4 + 2]).value();
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 2:
         if (context.bit_depth == 8) {
-            unpack_triplets_without_alpha<u8>(context);
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 3], data[x * 3 + 1], data[x * 3 + 2]).value();
         } else if (context.bit_depth == 16) {
-            unpack_triplets_without_alpha<u16>(context);
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 6], data[x * 6 + 2], data[x * 6 + 4]).value();
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 6:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
-            }
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 4], data[x * 4 + 1], data[x * 4 + 2], data[x * 4 + 3]).value();
         } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = reinterpret_cast<const Quad<u16>*>(context.scanlines[y].data.data());
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r & 0xFF;
-                    pixel.g = triplets[i].g & 0xFF;
-                    pixel.b = triplets[i].b & 0xFF;
-                    pixel.a = triplets[i].a & 0xFF;
-                }
-            }
+            for (int x = 0; x < width; ++x)
+                pixels[x] = Color(data[x * 8], data[x * 8 + 2], data[x * 8 + 4], data[x * 8 + 6]).value();
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case 3:
-        if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_index = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if (palette_index[i] >= context.palette_data.size())
-                        return false;
-                    auto& color = context.palette_data.at((int)palette_index[i]);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
-                        ? context.palette_transparency_data.data()[palette_index[i]]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
-            }
-        } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
-            auto pixels_per_byte = 8 / context.bit_depth;
-            auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_indices = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
-                    auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if ((size_t)palette_index >= context.palette_data.size())
-                        return false;
-                    auto& color = context.palette_data.at(palette_index);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
-                        ? context.palette_transparency_data.data()[palette_index]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
-            }
-        } else {
-            VERIFY_NOT_REACHED();
+        for (int x = 0; x < width; ++x) {
+            size_t palette_index = context.bit_depth == 8 ? data[x] : sample_at(x);
+            if (palette_index >= context.palette_data.size())
+                return false;
+            auto& color = context.palette_data[palette_index];
+            auto transparency = palette_index < context.palette_transparency_data.size()
+                ? context.palette_transparency_data[palette_index]
+                : 0xff;
+            pixels[x] = Color(color.r, color.g, color.b, transparency).value();
         }
         break;
     default:
@@ -456,48 +471,6 @@ NEVER_INLINE FLATTEN static bool unfilter(PNGLoadingContext& context)
         break;
     }
 
-    u8 dummy_scanline[context.width * sizeof(RGBA32)];
-    memset(dummy_scanline, 0, sizeof(dummy_scanline));
-
-    for (int y = 0; y < context.height; ++y) {
-        auto filter = context.scanlines[y].filter;
-        if (filter == 0) {
-            if (context.has_alpha())
-                unfilter_impl<true, 0>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 0>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 1) {
-            if (context.has_alpha())
-                unfilter_impl<true, 1>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 1>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 2) {
-            if (context.has_alpha())
-                unfilter_impl<true, 2>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 2>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 3) {
-            if (context.has_alpha())
-                unfilter_impl<true, 3>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 3>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-        if (filter == 4) {
-            if (context.has_alpha())
-                unfilter_impl<true, 4>(*context.bitmap, y, dummy_scanline);
-            else
-                unfilter_impl<false, 4>(*context.bitmap, y, dummy_scanline);
-            continue;
-        }
-    }
-
     return true;
 }
 
@@ -563,8 +536,6 @@ static bool decode_png_chunks(PNGLoadingContext& context)
     const u8* data_ptr = context.data + sizeof(png_header);
     int data_remaining = context.data_size - sizeof(png_header);
 
-    context.compressed_data.ensure_capacity(context.data_size);
-
     Streamer streamer(data_ptr, data_remaining);
     while (!streamer.at_end()) {
         if (!process_chunk(streamer, context)) {
@@ -578,45 +549,6 @@ static bool decode_png_chunks(PNGLoadingContext& context)
     return true;
 }
 
-static bool decode_png_bitmap_simple(PNGLoadingContext& context)
-{
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-
-    for (int y = 0; y < context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-
-        if (filter > 4) {
-            dbgln_if(PNG_DEBUG, "Invalid PNG filter: {}", filter);
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-
-        context.scanlines.append({ filter });
-        auto& scanline_buffer = context.scanlines.last().data;
-        auto row_size = context.compute_row_size_for_width(context.width);
-        if (row_size.has_overflow())
-            return false;
-
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-    }
-
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height });
-
-    if (!context.bitmap) {
-        context.state = PNGLoadingContext::State::Error;
-        return false;
-    }
-
-    return unfilter(context);
-}
-
 static int adam7_height(PNGLoadingContext& context, int pass)
 {
     switch (pass) {
@@ -667,75 +599,100 @@ static int adam7_startx[8] = { 0, 0, 4, 0, 2, 0, 1, 0 };
 static int adam7_stepy[8] = { 1, 8, 8, 8, 4, 4, 2, 2 };
 static int adam7_stepx[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
 
-static bool decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, int pass)
+static bool read_scanline(PNGLoadingContext& context, InputStream& stream, Bytes scanline, ReadonlyBytes previous_scanline)
 {
-    PNGLoadingContext subimage_context;
-    subimage_context.width = adam7_width(context, pass);
-    subimage_context.height = adam7_height(context, pass);
-    subimage_context.channels = context.channels;
-    subimage_context.color_type = context.color_type;
-    subimage_context.palette_data = context.palette_data;
-    subimage_context.palette_transparency_data = context.palette_transparency_data;
-    subimage_context.bit_depth = context.bit_depth;
-    subimage_context.filter_method = context.filter_method;
+    u8 filter;
+    if (!stream.read_or_error({ &filter, sizeof(filter) }))
+        return false;
 
-    // For small images, some passes might be empty
-    if (!subimage_context.width || !subimage_context.height)
-        return true;
+    if (filter > 4) {
+        dbgln_if(PNG_DEBUG, "Invalid PNG filter: {}", filter);
+        return false;
+    }
 
-    subimage_context.scanlines.clear_with_capacity();
-    for (int y = 0; y < subimage_context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
+    if (!stream.read_or_error(scanline))
+        return false;
 
-        if (filter > 4) {
-            dbgln_if(PNG_DEBUG, "Invalid PNG filter: {}", filter);
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
+    unfilter_scanline(filter, scanline, previous_scanline, context.filter_stride());
+    return true;
+}
 
-        subimage_context.scanlines.append({ filter });
-        auto& scanline_buffer = subimage_context.scanlines.last().data;
+// Decodes one Adam7 pass, or the whole image if pass is 0. Scanlines are unfiltered and
+// unpacked as they come out of the decompressor, so only two of them are kept in memory.
+static bool decode_png_pass(PNGLoadingContext& context, InputStream& stream, int pass)
+{
+    int width = pass == 0 ? context.width : adam7_width(context, pass);
+    int height = pass == 0 ? context.height : adam7_height(context, pass);
 
-        auto row_size = context.compute_row_size_for_width(subimage_context.width);
-        if (row_size.has_overflow())
-            return false;
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-    }
+    // For small images, some passes might be empty
+    if (!width || !height)
+        return true;
 
-    subimage_context.bitmap = Bitmap::create(context.bitmap->format(), { subimage_context.width, subimage_context.height });
-    if (!unfilter(subimage_context)) {
-        subimage_context.bitmap = nullptr;
+    auto row_size = context.compute_row_size_for_width(width);
+    if (row_size.has_overflow())
         return false;
-    }
 
-    // Copy the subimage data into the main image according to the pass pattern
-    for (int y = 0, dy = adam7_starty[pass]; y < subimage_context.height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
-        for (int x = 0, dx = adam7_startx[pass]; x < subimage_context.width && dy < context.width; ++x, dx += adam7_stepx[pass]) {
-            context.bitmap->set_pixel(dx, dy, subimage_context.bitmap->get_pixel(x, y));
+    auto scanline = ByteBuffer::create_zeroed(row_size.value());
+    auto previous_scanline = ByteBuffer::create_zeroed(row_size.value());
+    Vector<RGBA32> pass_pixels;
+    if (pass != 0)
+        pass_pixels.resize(width);
+
+    for (int y = 0; y < height; ++y) {
+        if (!read_scanline(context, stream, scanline, previous_scanline))
+            return false;
+
+        if (pass == 0) {
+            if (!unpack_scanline(context, scanline, context.bitmap->scanline(y), width))
+                return false;
+        } else {
+            if (!unpack_scanline(context, scanline, pass_pixels.data(), width))
+                return false;
+
+            // Copy the pass pixels into the main image according to the pass pattern
+            int dy = adam7_starty[pass] + y * adam7_stepy[pass];
+            if (dy >= context.height)
+                break;
+            auto* destination = context.bitmap->scanline(dy);
+            for (int x = 0, dx = adam7_startx[pass]; x < width && dx < context.width; ++x, dx += adam7_stepx[pass])
+                destination[dx] = pass_pixels[x];
         }
+
+        swap(scanline, previous_scanline);
     }
     return true;
 }
 
-static bool decode_png_adam7(PNGLoadingContext& context)
+static bool decode_png_image_data(PNGLoadingContext& context)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height });
-    if (!context.bitmap)
+    IDATStream compressed_stream { context.compressed_data };
+
+    // The image data is a zlib stream: a two byte header, deflate data, and an Adler-32 checksum
+    // that we don't need to read.
+    u8 zlib_header[2];
+    if (!compressed_stream.read_or_error({ zlib_header, sizeof(zlib_header) })) {
+        compressed_stream.handle_any_error();
         return false;
+    }
+    u8 compression_method = zlib_header[0] & 0xF;
+    u8 compression_info = zlib_header[0] >> 4;
+    bool has_dictionary = zlib_header[1] & 0x20;
+    if (compression_method != 8 || compression_info > 7 || has_dictionary || (zlib_header[0] * 256 + zlib_header[1]) % 31 != 0) {
+        dbgln_if(PNG_DEBUG, "Invalid zlib header in PNG image data");
+        return false;
+    }
 
-    for (int pass = 1; pass <= 7; ++pass) {
-        if (!decode_adam7_pass(context, streamer, pass))
-            return false;
+    Compress::DeflateDecompressor decompressor { compressed_stream };
+    bool success = true;
+    if (context.interlace_method == PngInterlaceMethod::Null) {
+        success = decode_png_pass(context, decompressor, 0);
+    } else {
+        for (int pass = 1; pass <= 7 && success; ++pass)
+            success = decode_png_pass(context, decompressor, pass);
     }
-    return true;
+
+    decompressor.handle_any_error();
+    return success;
 }
 
 static bool decode_png_bitmap(PNGLoadingContext& context)
@@ -754,31 +711,19 @@ static bool decode_png_bitmap(PNGLoadingContext& context)
     if (context.color_type == 3 && context.palette_data.is_empty())
         return false; // Didn't see a PLTE chunk for a palettized image, or it was empty.
 
-    auto result = Compress::Zlib::decompress_all(context.compressed_data.span());
-    if (!result.has_value()) {
+    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height });
+    if (!context.bitmap) {
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
-    context.decompression_buffer = &result.value();
-    context.compressed_data.clear();
 
-    context.scanlines.ensure_capacity(context.height);
-    switch (context.interlace_method) {
-    case PngInterlaceMethod::Null:
-        if (!decode_png_bitmap_simple(context))
-            return false;
-        break;
-    case PngInterlaceMethod::Adam7:
-        if (!decode_png_adam7(context))
-            return false;
-        break;
-    default:
+    if (!decode_png_image_data(context)) {
+        context.bitmap = nullptr;
         context.state = PNGLoadingContext::State::Error;
         return false;
     }
 
-    context.decompression_buffer = nullptr;
-
+    context.compressed_data.clear();
     context.state = PNGLoadingContext::State::BitmapDecoded;
     return true;
 }
@@ -882,7 +827,7 @@ static bool process_IHDR(ReadonlyBytes data, PNGLoadingContext& context)
 
 static bool process_IDAT(ReadonlyBytes data, PNGLoadingContext& context)
 {
-    context.compressed_data.append(data.data(), data.size());
+    context.compressed_data.append(data);
     return true;
 }
 
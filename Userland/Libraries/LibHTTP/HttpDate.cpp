@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/GenericLexer.h>
+#include <LibHTTP/HttpDate.h>
+
+namespace HTTP {
+
+static constexpr StringView s_day_names[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static constexpr StringView s_month_names[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+String format_http_date(time_t time)
+{
+    struct tm tm;
+    gmtime_r(&time, &tm);
+    return String::formatted("{}, {:02} {} {:04} {:02}:{:02}:{:02} GMT",
+        s_day_names[tm.tm_wday], tm.tm_mday, s_month_names[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+}
+
+// Only takes the preferred format, e.g. "Sun, 06 Nov 1994 08:49:37 GMT". The fields are read
+// directly rather than through mktime(), which would take them as local time.
+Optional<time_t> parse_http_date(StringView const& string)
+{
+    GenericLexer lexer(string);
+
+    auto consume_name = [&](auto& names) -> Optional<int> {
+        auto name = lexer.consume(3);
+        for (size_t ix = 0; ix < array_size(names); ix++) {
+            if (name == names[ix])
+                return (int)ix;
+        }
+        return {};
+    };
+    auto consume_number = [&](size_t digits) -> Optional<int> {
+        auto number = lexer.consume(digits);
+        if (number.length() != digits)
+            return {};
+        int value = 0;
+        for (auto ch : number) {
+            if (!is_ascii_digit(ch))
+                return {};
+            value = value * 10 + parse_ascii_digit(ch);
+        }
+        return value;
+    };
+
+    if (!consume_name(s_day_names).has_value() || !lexer.consume_specific(", "))
+        return {};
+    auto day = consume_number(2);
+    if (!day.has_value() || !lexer.consume_specific(' '))
+        return {};
+    auto month = consume_name(s_month_names);
+    if (!month.has_value() || !lexer.consume_specific(' '))
+        return {};
+    auto year = consume_number(4);
+    if (!year.has_value() || !lexer.consume_specific(' '))
+        return {};
+    auto hour = consume_number(2);
+    if (!hour.has_value() || !lexer.consume_specific(':'))
+        return {};
+    auto minute = consume_number(2);
+    if (!minute.has_value() || !lexer.consume_specific(':'))
+        return {};
+    auto second = consume_number(2);
+    if (!second.has_value() || !lexer.consume_specific(" GMT") || !lexer.is_eof())
+        return {};
+
+    if (day.value() < 1 || day.value() > 31 || hour.value() > 23 || minute.value() > 59 || second.value() > 60)
+        return {};
+
+    struct tm tm {};
+    tm.tm_year = year.value() - 1900;
+    tm.tm_mon = month.value();
+    tm.tm_mday = day.value();
+    tm.tm_hour = hour.value();
+    tm.tm_min = minute.value();
+    tm.tm_sec = second.value();
+    return timegm(&tm);
+}
+
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringView.h>
+#include <time.h>
+
+namespace HTTP {
+
+// Dates in HTTP headers are always in GMT, whatever the local time zone (RFC 7231, section 7.1.1.1).
+String format_http_date(time_t);
+Optional<time_t> parse_http_date(StringView const&);
+
+}
@@ -13,9 +13,19 @@
 
 namespace HTTP {
 void HttpJob::start()
+{
+    start(Core::TCPSocket::construct(this));
+}
+
+void HttpJob::start(NonnullRefPtr<Core::Socket> socket)
 {
     VERIFY(!m_socket);
-    m_socket = Core::TCPSocket::construct(this);
+    m_socket = move(socket);
+    if (m_socket->is_connected()) {
+        dbgln_if(CHTTPJOB_DEBUG, "HttpJob: Reusing connection to {}", m_request.url().host());
+        on_socket_connected();
+        return;
+    }
     m_socket->on_connected = [this] {
         dbgln_if(CHTTPJOB_DEBUG, "HttpJob: on_connected callback");
         on_socket_connected();
@@ -34,8 +44,10 @@ void HttpJob::shutdown()
         return;
     m_socket->on_ready_to_read = nullptr;
     m_socket->on_connected = nullptr;
-    remove_child(*m_socket);
+    if (m_socket->parent() == this)
+        remove_child(*m_socket);
     m_socket = nullptr;
+    release_socket();
 }
 
 void HttpJob::register_on_ready_to_read(Function<void()> callback)
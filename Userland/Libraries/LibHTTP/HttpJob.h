@@ -28,6 +28,8 @@ public:
     }
 
     virtual void start() override;
+    // Sends the request on the given socket, which is connected first unless it already is.
+    void start(NonnullRefPtr<Core::Socket>);
     virtual void shutdown() override;
 
 protected:
@@ -55,7 +55,7 @@ ByteBuffer HttpRequest::to_raw_request() const
         builder.append(header.value);
         builder.append("\r\n");
     }
-    builder.append("Connection: close\r\n");
+    builder.append("Connection: keep-alive\r\n");
     if (!m_body.is_empty()) {
         builder.appendff("Content-Length: {}\r\n\r\n", m_body.size());
         builder.append((char const*)m_body.data(), m_body.size());
@@ -165,6 +165,7 @@ Optional<HttpRequest> HttpRequest::from_raw_request(ReadonlyBytes raw_request)
         return {};
 
     request.m_resource = URL::percent_decode(resource);
+    request.m_protocol = move(protocol);
     request.m_headers = move(headers);
 
     return request;
@@ -46,6 +46,9 @@ public:
     Method method() const { return m_method; }
     void set_method(Method method) { m_method = method; }
 
+    // The HTTP version of a parsed request, e.g. "HTTP/1.1".
+    String const& protocol() const { return m_protocol; }
+
     ByteBuffer const& body() const { return m_body; }
     void set_body(ReadonlyBytes body) { m_body = ByteBuffer::copy(body); }
     void set_body(ByteBuffer&& body) { m_body = move(body); }
@@ -62,6 +65,7 @@ public:
 private:
     URL m_url;
     String m_resource;
+    String m_protocol;
     Method m_method { GET };
     Vector<Header> m_headers;
     ByteBuffer m_body;
@@ -15,10 +15,17 @@
 namespace HTTP {
 
 void HttpsJob::start()
+{
+    start(TLS::TLSv12::construct(this));
+}
+
+void HttpsJob::start(NonnullRefPtr<TLS::TLSv12> socket)
 {
     VERIFY(!m_socket);
-    m_socket = TLS::TLSv12::construct(this);
-    m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
+    m_socket = move(socket);
+    bool is_reused = m_socket->is_established();
+    if (!is_reused)
+        m_socket->set_root_certificates(m_override_ca_certificates ? *m_override_ca_certificates : DefaultRootCACertificates::the().certificates());
     m_socket->on_tls_connected = [this] {
         dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: on_connected callback");
         on_socket_connected();
@@ -46,6 +53,11 @@ void HttpsJob::start()
         if (on_certificate_requested)
             on_certificate_requested(*this);
     };
+    if (is_reused) {
+        dbgln_if(HTTPSJOB_DEBUG, "HttpsJob: Reusing connection to {}", m_request.url().host());
+        on_socket_connected();
+        return;
+    }
     bool success = ((TLS::TLSv12&)*m_socket).connect(m_request.url().host(), m_request.url().port());
     if (!success) {
         deferred_invoke([this](auto&) {
@@ -59,9 +71,15 @@ void HttpsJob::shutdown()
     if (!m_socket)
         return;
     m_socket->on_tls_ready_to_read = nullptr;
+    m_socket->on_tls_ready_to_write = nullptr;
     m_socket->on_tls_connected = nullptr;
-    remove_child(*m_socket);
+    m_socket->on_tls_error = nullptr;
+    m_socket->on_tls_finished = nullptr;
+    m_socket->on_tls_certificate_request = nullptr;
+    if (m_socket->parent() == this)
+        remove_child(*m_socket);
     m_socket = nullptr;
+    release_socket();
 }
 
 void HttpsJob::set_certificate(String certificate, String private_key)
@@ -90,6 +108,11 @@ void HttpsJob::register_on_ready_to_read(Function<void()> callback)
 
 void HttpsJob::register_on_ready_to_write(Function<void()> callback)
 {
+    // The handshake of a reused connection is long done, so we won't be told about it again.
+    if (m_socket->is_established()) {
+        callback();
+        return;
+    }
     m_socket->on_tls_ready_to_write = [callback = move(callback)](auto&) {
         callback();
     };
@@ -29,6 +29,9 @@ public:
     }
 
     virtual void start() override;
+    // Sends the request on the given socket, which is connected first unless it already is. An established TLS
+    // connection is used as it is, without another handshake.
+    void start(NonnullRefPtr<TLS::TLSv12>);
     virtual void shutdown() override;
     void set_certificate(String certificate, String key);
 
@@ -131,221 +131,248 @@ void Job::on_socket_connected()
             return;
         }
 
-        if (m_state == State::InStatus) {
-            if (!can_read_line())
-                return;
-            auto line = read_line(PAGE_SIZE);
-            if (line.is_null()) {
-                warnln("Job: Expected HTTP status");
-                return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
-            }
-            auto parts = line.split_view(' ');
-            if (parts.size() < 3) {
-                warnln("Job: Expected 3-part HTTP status, got '{}'", line);
-                return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
-            }
-            auto code = parts[1].to_uint();
-            if (!code.has_value()) {
-                warnln("Job: Expected numeric HTTP status");
-                return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
-            }
-            m_code = code.value();
-            m_state = State::InHeaders;
-            return;
-        }
-        if (m_state == State::InHeaders || m_state == State::Trailers) {
-            if (!can_read_line())
-                return;
-            auto line = read_line(PAGE_SIZE);
-            if (line.is_null()) {
-                if (m_state == State::Trailers) {
-                    // Some servers like to send two ending chunks
-                    // use this fact as an excuse to ignore anything after the last chunk
-                    // that is not a valid trailing header.
-                    return finish_up();
-                }
-                warnln("Job: Expected HTTP header");
-                return did_fail(Core::NetworkJob::Error::ProtocolFailed);
-            }
-            if (line.is_empty()) {
-                if (m_state == State::Trailers) {
-                    return finish_up();
-                } else {
-                    if (on_headers_received)
-                        on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
-                    m_state = State::InBody;
+        // A connection that is kept open doesn't become readable again for data we've already buffered, so keep
+        // going for as long as there is some.
+        for (;;) {
+            if (m_state == State::InStatus) {
+                if (!can_read_line())
+                    return;
+                auto line = read_line(PAGE_SIZE);
+                if (line.is_null()) {
+                    warnln("Job: Expected HTTP status");
+                    return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
                 }
-                return;
-            }
-            auto parts = line.split_view(':');
-            if (parts.is_empty()) {
-                if (m_state == State::Trailers) {
-                    // Some servers like to send two ending chunks
-                    // use this fact as an excuse to ignore anything after the last chunk
-                    // that is not a valid trailing header.
-                    return finish_up();
+                auto parts = line.split_view(' ');
+                if (parts.size() < 3) {
+                    warnln("Job: Expected 3-part HTTP status, got '{}'", line);
+                    return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
                 }
-                warnln("Job: Expected HTTP header with key/value");
-                return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
-            }
-            auto name = parts[0];
-            if (line.length() < name.length() + 2) {
-                if (m_state == State::Trailers) {
-                    // Some servers like to send two ending chunks
-                    // use this fact as an excuse to ignore anything after the last chunk
-                    // that is not a valid trailing header.
-                    return finish_up();
+                auto code = parts[1].to_uint();
+                if (!code.has_value()) {
+                    warnln("Job: Expected numeric HTTP status");
+                    return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
                 }
-                warnln("Job: Malformed HTTP header: '{}' ({})", line, line.length());
-                return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
-            }
-            auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
-            m_headers.set(name, value);
-            if (name.equals_ignoring_case("Content-Encoding")) {
-                // Assume that any content-encoding means that we can't decode it as a stream :(
-                dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
-                m_can_stream_response = false;
+                m_code = code.value();
+                // HTTP/1.1 connections stay open unless either side says otherwise, HTTP/1.0 ones only if asked to.
+                m_server_keeps_connection_open = parts[0] != "HTTP/1.0";
+                m_state = State::InHeaders;
+                continue;
             }
-            dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
-            return;
-        }
-        VERIFY(m_state == State::InBody);
-        VERIFY(can_read());
-
-        read_while_data_available([&] {
-            auto read_size = 64 * KiB;
-            if (m_current_chunk_remaining_size.has_value()) {
-            read_chunk_size:;
-                auto remaining = m_current_chunk_remaining_size.value();
-                if (remaining == -1) {
-                    // read size
-                    auto size_data = read_line(PAGE_SIZE);
-                    if (m_should_read_chunk_ending_line) {
-                        VERIFY(size_data.is_empty());
-                        m_should_read_chunk_ending_line = false;
-                        return IterationDecision::Continue;
+            if (m_state == State::InHeaders || m_state == State::Trailers) {
+                if (!can_read_line())
+                    return;
+                auto line = read_line(PAGE_SIZE);
+                if (line.is_null()) {
+                    if (m_state == State::Trailers) {
+                        // Some servers like to send two ending chunks
+                        // use this fact as an excuse to ignore anything after the last chunk
+                        // that is not a valid trailing header.
+                        return finish_up();
                     }
-                    auto size_lines = size_data.view().lines();
-                    dbgln_if(JOB_DEBUG, "Job: Received a chunk with size '{}'", size_data);
-                    if (size_lines.size() == 0) {
-                        dbgln("Job: Reached end of stream");
-                        finish_up();
-                        return IterationDecision::Break;
+                    warnln("Job: Expected HTTP header");
+                    return did_fail(Core::NetworkJob::Error::ProtocolFailed);
+                }
+                if (line.is_empty()) {
+                    if (m_state == State::Trailers) {
+                        m_received_whole_response = true;
+                        return finish_up();
                     } else {
-                        auto chunk = size_lines[0].split_view(';', true);
-                        String size_string = chunk[0];
-                        char* endptr;
-                        auto size = strtoul(size_string.characters(), &endptr, 16);
-                        if (*endptr) {
-                            // invalid number
-                            deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
-                            return IterationDecision::Break;
-                        }
-                        if (size == 0) {
-                            // This is the last chunk
-                            // '0' *[; chunk-ext-name = chunk-ext-value]
-                            // We're going to ignore _all_ chunk extensions
-                            read_size = 0;
-                            m_current_chunk_total_size = 0;
-                            m_current_chunk_remaining_size = 0;
-
-                            dbgln_if(JOB_DEBUG, "Job: Received the last chunk with extensions '{}'", size_string.substring_view(1, size_string.length() - 1));
-                        } else {
-                            m_current_chunk_total_size = size;
-                            m_current_chunk_remaining_size = size;
-                            read_size = size;
-
-                            dbgln_if(JOB_DEBUG, "Job: Chunk of size '{}' started", size);
+                        if (on_headers_received)
+                            on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
+                        m_state = State::InBody;
+                        // Nothing more is coming for these, and if the server keeps the connection open, we won't
+                        // get an EOF either.
+                        if (m_request.method() == HttpRequest::Method::HEAD || m_code == 204 || m_code == 304 || m_headers.get("Content-Length") == "0") {
+                            m_received_whole_response = true;
+                            return finish_up();
                         }
                     }
-                } else {
-                    read_size = remaining;
-
-                    dbgln_if(JOB_DEBUG, "Job: Resuming chunk with '{}' bytes left over", remaining);
+                    continue;
                 }
-            } else {
-                auto transfer_encoding = m_headers.get("Transfer-Encoding");
-                if (transfer_encoding.has_value()) {
-                    // Note: Some servers add extra spaces around 'chunked', see #6302.
-                    auto encoding = transfer_encoding.value().trim_whitespace();
-
-                    dbgln_if(JOB_DEBUG, "Job: This content has transfer encoding '{}'", encoding);
-                    if (encoding.equals_ignoring_case("chunked")) {
-                        m_current_chunk_remaining_size = -1;
-                        goto read_chunk_size;
-                    } else {
-                        dbgln("Job: Unknown transfer encoding '{}', the result will likely be wrong!", encoding);
+                auto parts = line.split_view(':');
+                if (parts.is_empty()) {
+                    if (m_state == State::Trailers) {
+                        // Some servers like to send two ending chunks
+                        // use this fact as an excuse to ignore anything after the last chunk
+                        // that is not a valid trailing header.
+                        return finish_up();
                     }
+                    warnln("Job: Expected HTTP header with key/value");
+                    return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
                 }
+                auto name = parts[0];
+                if (line.length() < name.length() + 2) {
+                    if (m_state == State::Trailers) {
+                        // Some servers like to send two ending chunks
+                        // use this fact as an excuse to ignore anything after the last chunk
+                        // that is not a valid trailing header.
+                        return finish_up();
+                    }
+                    warnln("Job: Malformed HTTP header: '{}' ({})", line, line.length());
+                    return deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
+                }
+                auto value = line.substring(name.length() + 2, line.length() - name.length() - 2);
+                m_headers.set(name, value);
+                if (name.equals_ignoring_case("Connection")) {
+                    auto options = value.to_lowercase();
+                    if (options.contains("close"))
+                        m_server_keeps_connection_open = false;
+                    else if (options.contains("keep-alive"))
+                        m_server_keeps_connection_open = true;
+                }
+                if (name.equals_ignoring_case("Content-Encoding")) {
+                    // Assume that any content-encoding means that we can't decode it as a stream :(
+                    dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
+                    m_can_stream_response = false;
+                }
+                dbgln_if(JOB_DEBUG, "Job: [{}] = '{}'", name, value);
+                continue;
             }
+            VERIFY(m_state == State::InBody);
+            if (!can_read())
+                return;
+            auto received_size = m_received_size;
+
+            read_while_data_available([&] {
+                auto read_size = 64 * KiB;
+                if (m_current_chunk_remaining_size.has_value()) {
+                read_chunk_size:;
+                    auto remaining = m_current_chunk_remaining_size.value();
+                    if (remaining == -1) {
+                        // read size
+                        auto size_data = read_line(PAGE_SIZE);
+                        if (m_should_read_chunk_ending_line) {
+                            VERIFY(size_data.is_empty());
+                            m_should_read_chunk_ending_line = false;
+                            return IterationDecision::Continue;
+                        }
+                        auto size_lines = size_data.view().lines();
+                        dbgln_if(JOB_DEBUG, "Job: Received a chunk with size '{}'", size_data);
+                        if (size_lines.size() == 0) {
+                            dbgln("Job: Reached end of stream");
+                            finish_up();
+                            return IterationDecision::Break;
+                        } else {
+                            auto chunk = size_lines[0].split_view(';', true);
+                            String size_string = chunk[0];
+                            char* endptr;
+                            auto size = strtoul(size_string.characters(), &endptr, 16);
+                            if (*endptr) {
+                                // invalid number
+                                deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+                                return IterationDecision::Break;
+                            }
+                            if (size == 0) {
+                                // This is the last chunk
+                                // '0' *[; chunk-ext-name = chunk-ext-value]
+                                // We're going to ignore _all_ chunk extensions
+                                read_size = 0;
+                                m_current_chunk_total_size = 0;
+                                m_current_chunk_remaining_size = 0;
+
+                                dbgln_if(JOB_DEBUG, "Job: Received the last chunk with extensions '{}'", size_string.substring_view(1, size_string.length() - 1));
+                            } else {
+                                m_current_chunk_total_size = size;
+                                m_current_chunk_remaining_size = size;
+                                read_size = size;
+
+                                dbgln_if(JOB_DEBUG, "Job: Chunk of size '{}' started", size);
+                            }
+                        }
+                    } else {
+                        read_size = remaining;
 
-            auto payload = receive(read_size);
-            if (payload.is_empty()) {
-                if (eof()) {
-                    finish_up();
-                    return IterationDecision::Break;
+                        dbgln_if(JOB_DEBUG, "Job: Resuming chunk with '{}' bytes left over", remaining);
+                    }
+                } else {
+                    auto transfer_encoding = m_headers.get("Transfer-Encoding");
+                    if (transfer_encoding.has_value()) {
+                        // Note: Some servers add extra spaces around 'chunked', see #6302.
+                        auto encoding = transfer_encoding.value().trim_whitespace();
+
+                        dbgln_if(JOB_DEBUG, "Job: This content has transfer encoding '{}'", encoding);
+                        if (encoding.equals_ignoring_case("chunked")) {
+                            m_current_chunk_remaining_size = -1;
+                            goto read_chunk_size;
+                        } else {
+                            dbgln("Job: Unknown transfer encoding '{}', the result will likely be wrong!", encoding);
+                        }
+                    }
                 }
 
-                if (should_fail_on_empty_payload()) {
-                    deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
-                    return IterationDecision::Break;
+                auto payload = receive(read_size);
+                if (payload.is_empty()) {
+                    if (eof()) {
+                        finish_up();
+                        return IterationDecision::Break;
+                    }
+
+                    if (should_fail_on_empty_payload()) {
+                        deferred_invoke([this](auto&) { did_fail(Core::NetworkJob::Error::ProtocolFailed); });
+                        return IterationDecision::Break;
+                    }
                 }
-            }
 
-            m_received_buffers.append(payload);
-            m_buffered_size += payload.size();
-            m_received_size += payload.size();
-            flush_received_buffers();
+                m_received_buffers.append(payload);
+                m_buffered_size += payload.size();
+                m_received_size += payload.size();
+                flush_received_buffers();
 
-            if (m_current_chunk_remaining_size.has_value()) {
-                auto size = m_current_chunk_remaining_size.value() - payload.size();
+                if (m_current_chunk_remaining_size.has_value()) {
+                    auto size = m_current_chunk_remaining_size.value() - payload.size();
 
-                dbgln_if(JOB_DEBUG, "Job: We have {} bytes left over in this chunk", size);
-                if (size == 0) {
-                    dbgln_if(JOB_DEBUG, "Job: Finished a chunk of {} bytes", m_current_chunk_total_size.value());
+                    dbgln_if(JOB_DEBUG, "Job: We have {} bytes left over in this chunk", size);
+                    if (size == 0) {
+                        dbgln_if(JOB_DEBUG, "Job: Finished a chunk of {} bytes", m_current_chunk_total_size.value());
 
-                    if (m_current_chunk_total_size.value() == 0) {
-                        m_state = State::Trailers;
-                        return IterationDecision::Break;
-                    }
+                        if (m_current_chunk_total_size.value() == 0) {
+                            m_state = State::Trailers;
+                            return IterationDecision::Break;
+                        }
 
-                    // we've read everything, now let's get the next chunk
-                    size = -1;
-                    if (can_read_line()) {
-                        auto line = read_line(PAGE_SIZE);
-                        VERIFY(line.is_empty());
-                    } else {
-                        m_should_read_chunk_ending_line = true;
+                        // we've read everything, now let's get the next chunk
+                        size = -1;
+                        if (can_read_line()) {
+                            auto line = read_line(PAGE_SIZE);
+                            VERIFY(line.is_empty());
+                        } else {
+                            m_should_read_chunk_ending_line = true;
+                        }
                     }
+                    m_current_chunk_remaining_size = size;
                 }
-                m_current_chunk_remaining_size = size;
-            }
 
-            auto content_length_header = m_headers.get("Content-Length");
-            Optional<u32> content_length {};
+                auto content_length_header = m_headers.get("Content-Length");
+                Optional<u32> content_length {};
 
-            if (content_length_header.has_value()) {
-                auto length = content_length_header.value().to_uint();
-                if (length.has_value())
-                    content_length = length.value();
-            }
+                if (content_length_header.has_value()) {
+                    auto length = content_length_header.value().to_uint();
+                    if (length.has_value())
+                        content_length = length.value();
+                }
 
-            deferred_invoke([this, content_length](auto&) { did_progress(content_length, m_received_size); });
+                deferred_invoke([this, content_length](auto&) { did_progress(content_length, m_received_size); });
 
-            if (content_length.has_value()) {
-                auto length = content_length.value();
-                if (m_received_size >= length) {
-                    m_received_size = length;
-                    finish_up();
-                    return IterationDecision::Break;
+                if (content_length.has_value()) {
+                    auto length = content_length.value();
+                    if (m_received_size >= length) {
+                        m_received_size = length;
+                        m_received_whole_response = true;
+                        finish_up();
+                        return IterationDecision::Break;
+                    }
                 }
-            }
-            return IterationDecision::Continue;
-        });
+                return IterationDecision::Continue;
+            });
 
-        if (!is_established()) {
-            dbgln_if(JOB_DEBUG, "Connection appears to have closed, finishing up");
-            finish_up();
+            if (m_state == State::Finished)
+                return;
+            if (!is_established()) {
+                dbgln_if(JOB_DEBUG, "Connection appears to have closed, finishing up");
+                return finish_up();
+            }
+            if (m_state == State::InBody && m_received_size == received_size)
+                return;
         }
     });
 }
@@ -358,6 +385,15 @@ void Job::timer_event(Core::TimerEvent& event)
         stop_timer();
 }
 
+void Job::release_socket()
+{
+    if (!on_socket_released)
+        return;
+    auto on_released = move(on_socket_released);
+    on_socket_released = nullptr;
+    on_released(m_received_whole_response && m_server_keeps_connection_open);
+}
+
 void Job::finish_up()
 {
     VERIFY(!m_has_scheduled_finish);
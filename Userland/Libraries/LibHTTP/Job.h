@@ -27,8 +27,14 @@ public:
     HttpResponse* response() { return static_cast<HttpResponse*>(Core::NetworkJob::response()); }
     const HttpResponse* response() const { return static_cast<const HttpResponse*>(Core::NetworkJob::response()); }
 
+    // Set when the job was started on a socket that belongs to someone else, like a connection pool. Called once
+    // the job is done with the socket, which can then take another request if `can_reuse` is true: the whole
+    // response was read, and the server is keeping the connection open.
+    Function<void(bool can_reuse)> on_socket_released;
+
 protected:
     void finish_up();
+    void release_socket();
     void on_socket_connected();
     void flush_received_buffers();
     virtual void register_on_ready_to_read(Function<void()>) = 0;
@@ -65,6 +71,8 @@ protected:
     bool m_can_stream_response { true };
     bool m_should_read_chunk_ending_line { false };
     bool m_has_scheduled_finish { false };
+    bool m_received_whole_response { false };
+    bool m_server_keeps_connection_open { false };
 };
 
 }
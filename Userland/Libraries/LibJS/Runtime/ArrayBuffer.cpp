@@ -14,7 +14,7 @@ ArrayBuffer* ArrayBuffer::create(GlobalObject& global_object, size_t byte_size)
     return global_object.heap().allocate<ArrayBuffer>(global_object, byte_size, *global_object.array_buffer_prototype());
 }
 
-ArrayBuffer* ArrayBuffer::create(GlobalObject& global_object, ByteBuffer* buffer)
+ArrayBuffer* ArrayBuffer::create(GlobalObject& global_object, Bytes buffer)
 {
     return global_object.heap().allocate<ArrayBuffer>(global_object, buffer, *global_object.array_buffer_prototype());
 }
@@ -26,7 +26,7 @@ ArrayBuffer::ArrayBuffer(size_t byte_size, Object& prototype)
 {
 }
 
-ArrayBuffer::ArrayBuffer(ByteBuffer* buffer, Object& prototype)
+ArrayBuffer::ArrayBuffer(Bytes buffer, Object& prototype)
     : Object(prototype)
     , m_buffer(buffer)
     , m_detach_key(js_undefined())
@@ -21,15 +21,16 @@ class ArrayBuffer : public Object {
 
 public:
     static ArrayBuffer* create(GlobalObject&, size_t);
-    static ArrayBuffer* create(GlobalObject&, ByteBuffer*);
+    // Creates a view of memory owned by someone else, which has to stay valid until the ArrayBuffer is detached.
+    static ArrayBuffer* create(GlobalObject&, Bytes);
 
     ArrayBuffer(size_t, Object& prototype);
-    ArrayBuffer(ByteBuffer* buffer, Object& prototype);
+    ArrayBuffer(Bytes, Object& prototype);
     virtual ~ArrayBuffer() override;
 
     size_t byte_length() const { return buffer_impl().size(); }
-    ByteBuffer& buffer() { return buffer_impl(); }
-    const ByteBuffer& buffer() const { return buffer_impl(); }
+    Bytes buffer() { return buffer_impl(); }
+    ReadonlyBytes buffer() const { return buffer_impl(); }
 
     Value detach_key() const { return m_detach_key; }
     void set_detach_key(Value detach_key) { m_detach_key = detach_key; }
@@ -49,16 +50,16 @@ public:
 private:
     virtual void visit_edges(Visitor&) override;
 
-    ByteBuffer& buffer_impl()
+    Bytes buffer_impl()
     {
-        ByteBuffer* ptr { nullptr };
-        m_buffer.visit([&](Empty) { VERIFY_NOT_REACHED(); }, [&](auto* pointer) { ptr = pointer; }, [&](auto& value) { ptr = &value; });
-        return *ptr;
+        Bytes bytes;
+        m_buffer.visit([&](Empty) { VERIFY_NOT_REACHED(); }, [&](ByteBuffer& buffer) { bytes = buffer.bytes(); }, [&](Bytes external) { bytes = external; });
+        return bytes;
     }
 
-    const ByteBuffer& buffer_impl() const { return const_cast<ArrayBuffer*>(this)->buffer_impl(); }
+    ReadonlyBytes buffer_impl() const { return const_cast<ArrayBuffer*>(this)->buffer_impl(); }
 
-    Variant<Empty, ByteBuffer, ByteBuffer*> m_buffer;
+    Variant<Empty, ByteBuffer, Bytes> m_buffer;
     // The various detach related members of ArrayBuffer are not used by any ECMA262 functionality,
     // but are required to be available for the use of various harnesses like the Test262 test runner.
     Value m_detach_key;
@@ -110,7 +111,7 @@ Value ArrayBuffer::get_value(size_t byte_index, [[maybe_unused]] bool is_typed_a
 
     // FIXME: Check for shared buffer
 
-    auto raw_value = buffer_impl().slice(byte_index, element_size);
+    auto raw_value = ByteBuffer::copy(buffer_impl().slice(byte_index, element_size));
     return raw_bytes_to_numeric<T>(global_object(), move(raw_value), is_little_endian);
 }
 
@@ -186,7 +187,7 @@ Value ArrayBuffer::set_value(size_t byte_index, Value value, [[maybe_unused]] bo
 
     // FIXME: Check for shared buffer
 
-    raw_bytes.span().copy_to(buffer_impl().span().slice(byte_index));
+    raw_bytes.span().copy_to(buffer_impl().slice(byte_index));
     return js_undefined();
 }
 
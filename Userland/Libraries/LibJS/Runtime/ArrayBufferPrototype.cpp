@@ -119,7 +119,7 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayBufferPrototype::slice)
     }
 
     // This is ugly, is there a better way to do this?
-    array_buffer_object->buffer().span().slice(first, new_length).copy_to(new_array_buffer_object->buffer().span());
+    array_buffer_object->buffer().slice(first, new_length).copy_to(new_array_buffer_object->buffer());
     return new_array_buffer_object;
 }
 
@@ -117,6 +117,9 @@ void ByteCode::ensure_opcodes_initialized()
         case OpCodeId::ForkStay:
             s_opcodes[i] = make<OpCode_ForkStay>();
             break;
+        case OpCodeId::ForkReplaceStay:
+            s_opcodes[i] = make<OpCode_ForkReplaceStay>();
+            break;
         case OpCodeId::FailForks:
             s_opcodes[i] = make<OpCode_FailForks>();
             break;
@@ -229,6 +232,12 @@ ALWAYS_INLINE ExecutionResult OpCode_ForkStay::execute(const MatchInput&, MatchS
     return ExecutionResult::Fork_PrioLow;
 }
 
+ALWAYS_INLINE ExecutionResult OpCode_ForkReplaceStay::execute(const MatchInput&, MatchState& state, MatchOutput&) const
+{
+    state.fork_at_position = state.instruction_position + size() + offset();
+    return ExecutionResult::Fork_PrioLowReplace;
+}
+
 ALWAYS_INLINE ExecutionResult OpCode_CheckBegin::execute(const MatchInput& input, MatchState& state, MatchOutput&) const
 {
     if (0 == state.string_position && (input.regex_options & AllFlags::MatchNotBeginOfLine))
@@ -672,6 +681,17 @@ ALWAYS_INLINE void OpCode_Compare::compare_character_range(const MatchInput& inp
     }
 }
 
+bool OpCode_Compare::matches_code_point(u32 code_point, AllOptions options) const
+{
+    MatchInput input;
+    input.view = Utf32View { &code_point, 1 };
+    input.regex_options = options;
+    MatchState state;
+    state.instruction_position = this->state().instruction_position;
+    MatchOutput output;
+    return execute(input, state, output) == ExecutionResult::Continue && state.string_position == 1;
+}
+
 const String OpCode_Compare::arguments_string() const
 {
     return String::formatted("argc={}, args={} ", arguments_count(), arguments_size());
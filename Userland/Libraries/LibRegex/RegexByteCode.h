@@ -28,6 +28,7 @@ using ByteCodeValueType = u64;
     __ENUMERATE_OPCODE(Jump)                       \
     __ENUMERATE_OPCODE(ForkJump)                   \
     __ENUMERATE_OPCODE(ForkStay)                   \
+    __ENUMERATE_OPCODE(ForkReplaceStay)            \
     __ENUMERATE_OPCODE(FailForks)                  \
     __ENUMERATE_OPCODE(SaveLeftCaptureGroup)       \
     __ENUMERATE_OPCODE(SaveRightCaptureGroup)      \
@@ -464,6 +465,7 @@ private:
     __ENUMERATE_EXECUTION_RESULT(Continue)                   \
     __ENUMERATE_EXECUTION_RESULT(Fork_PrioHigh)              \
     __ENUMERATE_EXECUTION_RESULT(Fork_PrioLow)               \
+    __ENUMERATE_EXECUTION_RESULT(Fork_PrioLowReplace)        \
     __ENUMERATE_EXECUTION_RESULT(Failed)                     \
     __ENUMERATE_EXECUTION_RESULT(Failed_ExecuteLowPrioForks) \
     __ENUMERATE_EXECUTION_RESULT(Succeeded)
@@ -600,6 +602,20 @@ public:
     }
 };
 
+// Like ForkStay, but replaces the state the previous execution of this instruction left behind instead of adding
+// another one. The optimizer uses this for loops that never need to give back an iteration.
+class OpCode_ForkReplaceStay final : public OpCode {
+public:
+    ExecutionResult execute(const MatchInput& input, MatchState& state, MatchOutput& output) const override;
+    ALWAYS_INLINE OpCodeId opcode_id() const override { return OpCodeId::ForkReplaceStay; }
+    ALWAYS_INLINE size_t size() const override { return 2; }
+    ALWAYS_INLINE ssize_t offset() const { return argument(0); }
+    const String arguments_string() const override
+    {
+        return String::formatted("offset={} [&{}], sp: {}", offset(), state().instruction_position + size() + offset(), state().string_position);
+    }
+};
+
 class OpCode_CheckBegin final : public OpCode {
 public:
     ExecutionResult execute(const MatchInput& input, MatchState& state, MatchOutput& output) const override;
@@ -680,6 +696,9 @@ public:
     const String arguments_string() const override;
     const Vector<String> variable_arguments_to_string(Optional<MatchInput> input = {}) const;
 
+    // Whether this comparison would consume the given code point on its own, e.g. to find out what a match can start with.
+    bool matches_code_point(u32 code_point, AllOptions) const;
+
 private:
     ALWAYS_INLINE static void compare_char(const MatchInput& input, MatchState& state, u32 ch1, bool inverse, bool& inverse_matched);
     ALWAYS_INLINE static bool compare_string(const MatchInput& input, MatchState& state, const char* str, size_t length, bool& had_zero_length_match);
@@ -702,12 +721,30 @@ ALWAYS_INLINE bool is(const OpCode* opcode)
     return is<T>(*opcode);
 }
 
+template<>
+ALWAYS_INLINE bool is<OpCode_Jump>(const OpCode& opcode)
+{
+    return opcode.opcode_id() == OpCodeId::Jump;
+}
+
+template<>
+ALWAYS_INLINE bool is<OpCode_ForkJump>(const OpCode& opcode)
+{
+    return opcode.opcode_id() == OpCodeId::ForkJump;
+}
+
 template<>
 ALWAYS_INLINE bool is<OpCode_ForkStay>(const OpCode& opcode)
 {
     return opcode.opcode_id() == OpCodeId::ForkStay;
 }
 
+template<>
+ALWAYS_INLINE bool is<OpCode_ForkReplaceStay>(const OpCode& opcode)
+{
+    return opcode.opcode_id() == OpCodeId::ForkReplaceStay;
+}
+
 template<>
 ALWAYS_INLINE bool is<OpCode_Exit>(const OpCode& opcode)
 {
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexDFA.h"
+#include <AK/CharacterTypes.h>
+#include <AK/NumericLimits.h>
+#include <AK/QuickSort.h>
+
+namespace regex {
+
+// Once the states take up more memory than this, they are thrown away and built again as needed.
+static constexpr size_t c_max_cache_size = 2 * MiB;
+static constexpr u32 c_no_node = NumericLimits<u32>::max();
+
+OwnPtr<DFA> DFA::try_create(ByteCode const& bytecode)
+{
+    auto dfa = adopt_own(*new DFA(bytecode));
+    if (!dfa->build_nfa())
+        return {};
+    return dfa;
+}
+
+bool DFA::build_nfa()
+{
+    // The instruction positions each node continues at, in priority order. String comparisons are the exception, as
+    // all but their last character continue at the next node.
+    Vector<Vector<size_t, 2>> targets;
+    Vector<u32> instruction_nodes;
+    instruction_nodes.resize(m_bytecode.size());
+    for (auto& node : instruction_nodes)
+        node = c_no_node;
+
+    auto add_node = [&](Node::Type type, size_t instruction_position, Vector<size_t, 2> node_targets = {}) {
+        m_nodes.append({ type, instruction_position, 0, 0, {}, {}, {} });
+        targets.append(move(node_targets));
+    };
+
+    MatchState state;
+    while (state.instruction_position < m_bytecode.size()) {
+        auto& opcode = m_bytecode.get_opcode(state);
+        auto position = state.instruction_position;
+        auto next = position + opcode.size();
+        instruction_nodes[position] = m_nodes.size();
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto& compare = to<OpCode_Compare>(opcode);
+            auto offset = position + 3;
+            Optional<size_t> string_offset;
+            for (size_t i = 0; i < compare.arguments_count(); ++i) {
+                switch ((CharacterCompareType)m_bytecode[offset++]) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                    ++offset;
+                    break;
+                case CharacterCompareType::String:
+                    // Strings are always compared on their own, see ByteCode::insert_bytecode_compare_string().
+                    if (compare.arguments_count() != 1)
+                        return false;
+                    string_offset = offset;
+                    offset += m_bytecode[offset] + 1;
+                    break;
+                default:
+                    // Backreferences depend on what the capture groups matched, which a DFA can't remember.
+                    return false;
+                }
+            }
+
+            if (!string_offset.has_value()) {
+                add_node(Node::Type::Compare, position, { next });
+                break;
+            }
+
+            auto length = m_bytecode[*string_offset];
+            if (length == 0) {
+                add_node(Node::Type::Epsilon, position, { next });
+                break;
+            }
+            for (size_t i = 0; i < length; ++i) {
+                add_node(Node::Type::StringCharacter, position, i == length - 1 ? Vector<size_t, 2> { next } : Vector<size_t, 2> {});
+                m_nodes.last().code_point = static_cast<u8>(m_bytecode[*string_offset + 1 + i]);
+            }
+            break;
+        }
+        case OpCodeId::Jump:
+            add_node(Node::Type::Epsilon, position, { next + to<OpCode_Jump>(opcode).offset() });
+            break;
+        case OpCodeId::ForkJump:
+            add_node(Node::Type::Epsilon, position, { next + to<OpCode_ForkJump>(opcode).offset(), next });
+            break;
+        case OpCodeId::ForkStay:
+            add_node(Node::Type::Epsilon, position, { next, next + to<OpCode_ForkStay>(opcode).offset() });
+            break;
+        case OpCodeId::ForkReplaceStay:
+            // Only ever used where dropping the earlier states doesn't change which match is found first.
+            add_node(Node::Type::Epsilon, position, { next, next + to<OpCode_ForkReplaceStay>(opcode).offset() });
+            break;
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+            add_node(Node::Type::Epsilon, position, { next });
+            break;
+        case OpCodeId::CheckBegin:
+            add_node(Node::Type::CheckBegin, position, { next });
+            break;
+        case OpCodeId::CheckEnd:
+            add_node(Node::Type::CheckEnd, position, { next });
+            break;
+        default:
+            // Lookaround (Save, Restore, GoBack, FailForks), word boundaries and explicit exits.
+            return false;
+        }
+
+        state.instruction_position = next;
+    }
+
+    m_accept_node = m_nodes.size();
+    add_node(Node::Type::Accept, m_bytecode.size());
+
+    // Anything past the end of the bytecode makes the backtracker exit successfully, see ByteCode::get_opcode().
+    auto node_at = [&](size_t instruction_position) -> u32 {
+        if (instruction_position >= m_bytecode.size())
+            return m_accept_node;
+        return instruction_nodes[instruction_position];
+    };
+
+    m_entry_node = node_at(0);
+
+    for (u32 index = 0; index < m_nodes.size(); ++index) {
+        auto& node = m_nodes[index];
+        if (node.type == Node::Type::StringCharacter && targets[index].is_empty()) {
+            node.next.append(index + 1);
+            continue;
+        }
+        for (auto target : targets[index]) {
+            auto next = node_at(target);
+            if (next == c_no_node)
+                return false;
+            node.next.append(next);
+        }
+    }
+
+    HashMap<Vector<ByteCodeValueType>, u32, ComparisonTraits> comparisons;
+    for (u32 index = 0; index < m_nodes.size(); ++index) {
+        auto& node = m_nodes[index];
+        if (!node.consumes())
+            continue;
+        Vector<ByteCodeValueType> key;
+        if (node.type == Node::Type::StringCharacter) {
+            // Compare instructions are at least three values long, so this can't be mistaken for one.
+            key.append(static_cast<ByteCodeValueType>(OpCodeId::Compare));
+            key.append(node.code_point);
+        } else {
+            MatchState state;
+            state.instruction_position = node.instruction_position;
+            key.append(m_bytecode.data() + node.instruction_position, m_bytecode.get_opcode(state).size());
+        }
+        if (auto it = comparisons.find(key); it != comparisons.end()) {
+            node.comparison = it->value;
+            continue;
+        }
+        node.comparison = m_comparison_nodes.size();
+        m_comparison_nodes.append(index);
+        comparisons.set(move(key), node.comparison);
+    }
+
+    for (u32 index = 0; index < m_nodes.size(); ++index) {
+        auto& node = m_nodes[index];
+        for (auto next : node.next) {
+            if (node.consumes())
+                m_nodes[next].consuming_predecessors.append(index);
+            else
+                m_nodes[next].epsilon_predecessors.append(index);
+        }
+    }
+
+    m_visited.resize(m_nodes.size());
+    return true;
+}
+
+void DFA::configure(AllOptions options, bool is_u8_view)
+{
+    // Case insensitivity is the only option Compare looks at, and String comparisons only ever match UTF-8 views.
+    AllOptions relevant_options;
+    if (options.has_flag_set(AllFlags::Insensitive))
+        relevant_options |= AllFlags::Insensitive;
+
+    if (m_is_configured && m_is_u8_view == is_u8_view && m_options.value() == relevant_options.value())
+        return;
+
+    flush();
+    m_is_configured = true;
+    m_is_u8_view = is_u8_view;
+    m_options = relevant_options;
+
+    m_compare_results.clear_with_capacity();
+    m_compare_results.resize(m_comparison_nodes.size() * 256);
+    for (u32 comparison = 0; comparison < m_comparison_nodes.size(); ++comparison) {
+        for (u32 code_point = 0; code_point < 256; ++code_point)
+            m_compare_results[comparison * 256 + code_point] = evaluate_compare(m_nodes[m_comparison_nodes[comparison]], code_point);
+    }
+
+    // Refine the partition of the code points by every comparison in turn.
+    m_byte_classes.fill(0);
+    m_byte_class_count = 1;
+    for (u32 comparison = 0; comparison < m_comparison_nodes.size() && m_byte_class_count < 256; ++comparison) {
+        Array<int, 512> refined_classes;
+        refined_classes.fill(-1);
+        size_t refined_class_count = 0;
+        for (u32 code_point = 0; code_point < 256; ++code_point) {
+            auto& refined_class = refined_classes[m_byte_classes[code_point] * 2 + m_compare_results[comparison * 256 + code_point]];
+            if (refined_class < 0)
+                refined_class = refined_class_count++;
+            m_byte_classes[code_point] = refined_class;
+        }
+        m_byte_class_count = refined_class_count;
+    }
+}
+
+bool DFA::compare(u32 node, u32 code_point) const
+{
+    if (code_point < 256)
+        return m_compare_results[m_nodes[node].comparison * 256 + code_point];
+    return evaluate_compare(m_nodes[node], code_point);
+}
+
+bool DFA::evaluate_compare(Node const& node, u32 code_point) const
+{
+    if (node.type == Node::Type::StringCharacter) {
+        if (!m_is_u8_view)
+            return false;
+        if (m_options.has_flag_set(AllFlags::Insensitive))
+            return to_ascii_lowercase(code_point) == to_ascii_lowercase(node.code_point);
+        return code_point == node.code_point;
+    }
+
+    // Let the Compare instruction decide on its own, so the DFA and the backtracker can't disagree on what it matches.
+    MatchState state;
+    state.instruction_position = node.instruction_position;
+    return to<OpCode_Compare>(m_bytecode.get_opcode(state)).matches_code_point(code_point, m_options);
+}
+
+void DFA::start_generation()
+{
+    if (++m_generation == 0) {
+        for (auto& visited : m_visited)
+            visited = 0;
+        m_generation = 1;
+    }
+}
+
+void DFA::add_forward_threads(Vector<u32>& threads, u32 start, Context context, bool& matched)
+{
+    // A depth-first walk in priority order; a node that was already reached at this position belongs to a thread of
+    // higher priority, and everything found after the Accept node could never be preferred over it.
+    m_stack.clear();
+    m_stack.append(start);
+    while (!m_stack.is_empty()) {
+        auto index = m_stack.take_last();
+        if (m_visited[index] == m_generation)
+            continue;
+        m_visited[index] = m_generation;
+
+        auto& node = m_nodes[index];
+        switch (node.type) {
+        case Node::Type::Compare:
+        case Node::Type::StringCharacter:
+            threads.append(index);
+            continue;
+        case Node::Type::Accept:
+            threads.append(index);
+            matched = true;
+            return;
+        case Node::Type::CheckBegin:
+            if (!context.at_begin)
+                continue;
+            break;
+        case Node::Type::CheckEnd:
+            if (!context.at_end)
+                continue;
+            break;
+        case Node::Type::Epsilon:
+            break;
+        }
+
+        for (size_t i = node.next.size(); i > 0; --i)
+            m_stack.append(node.next[i - 1]);
+    }
+}
+
+DFA::State* DFA::forward_start_state(size_t position, size_t length, bool anchored)
+{
+    Vector<u32> threads;
+    bool matched = false;
+    start_generation();
+    add_forward_threads(threads, m_entry_node, { position == 0, position == length }, matched);
+    return intern(m_forward_states, move(threads), !anchored && !matched);
+}
+
+DFA::State* DFA::forward_step(State const& state, u32 code_point, Context context)
+{
+    Vector<u32> threads;
+    bool matched = false;
+    start_generation();
+    for (auto index : state.nodes) {
+        auto& node = m_nodes[index];
+        if (!node.consumes())
+            break;
+        if (compare(index, code_point))
+            add_forward_threads(threads, node.next.first(), context, matched);
+        if (matched)
+            break;
+    }
+
+    // A thread that starts here has the lowest priority of all, and once anything matched, the match can't start any later.
+    bool can_start = state.flag && !matched;
+    if (can_start) {
+        add_forward_threads(threads, m_entry_node, context, matched);
+        can_start = !matched;
+    }
+
+    return intern(m_forward_states, move(threads), can_start);
+}
+
+DFA::State** DFA::cached_transition(State& state, u32 code_point)
+{
+    if (code_point >= 256)
+        return nullptr;
+    return &state.transitions[m_byte_classes[code_point]];
+}
+
+DFA::State* DFA::forward_transition(State& state, u32 code_point, bool at_end)
+{
+    // Only the transition into the last position depends on where it is, so everything else can be cached.
+    auto** cached_state = at_end ? nullptr : cached_transition(state, code_point);
+    if (cached_state && *cached_state)
+        return *cached_state;
+
+    auto flush_count = m_flush_count;
+    auto* next = forward_step(state, code_point, { false, at_end });
+    if (cached_state && flush_count == m_flush_count)
+        *cached_state = next;
+    return next;
+}
+
+DFA::State* DFA::reverse_closure(Vector<u32> const& seeds, Context context)
+{
+    start_generation();
+    m_stack.clear();
+    m_stack.extend(seeds);
+
+    Vector<u32> nodes;
+    while (!m_stack.is_empty()) {
+        auto index = m_stack.take_last();
+        if (m_visited[index] == m_generation)
+            continue;
+        m_visited[index] = m_generation;
+
+        auto& node = m_nodes[index];
+        nodes.extend(node.consuming_predecessors);
+        for (auto predecessor : node.epsilon_predecessors) {
+            auto type = m_nodes[predecessor].type;
+            if ((type == Node::Type::CheckBegin && !context.at_begin) || (type == Node::Type::CheckEnd && !context.at_end))
+                continue;
+            m_stack.append(predecessor);
+        }
+    }
+
+    quick_sort(nodes);
+    Vector<u32> unique_nodes;
+    for (auto node : nodes) {
+        if (unique_nodes.is_empty() || unique_nodes.last() != node)
+            unique_nodes.append(node);
+    }
+
+    return intern(m_reverse_states, move(unique_nodes), m_visited[m_entry_node] == m_generation);
+}
+
+DFA::State* DFA::reverse_transition(State& state, u32 code_point, bool at_begin)
+{
+    auto** cached_state = at_begin ? nullptr : cached_transition(state, code_point);
+    if (cached_state && *cached_state)
+        return *cached_state;
+
+    Vector<u32> seeds;
+    for (auto index : state.nodes) {
+        if (compare(index, code_point))
+            seeds.append(index);
+    }
+
+    auto flush_count = m_flush_count;
+    auto* next = reverse_closure(seeds, { at_begin, false });
+    if (cached_state && flush_count == m_flush_count)
+        *cached_state = next;
+    return next;
+}
+
+DFA::State* DFA::intern(StateCache& cache, Vector<u32>&& nodes, bool flag)
+{
+    Vector<u32> key;
+    key.ensure_capacity(nodes.size() + 1);
+    key.extend(nodes);
+    key.append(flag);
+    if (auto it = cache.find(key); it != cache.end())
+        return it->value;
+
+    auto size = sizeof(State) + (nodes.size() + key.size()) * sizeof(u32) + m_byte_class_count * sizeof(State*);
+    if (m_cache_size + size > c_max_cache_size)
+        flush();
+    m_cache_size += size;
+
+    auto state = make<State>();
+    state->transitions.resize(m_byte_class_count);
+    state->nodes = move(nodes);
+    state->flag = flag;
+    state->is_match = !state->nodes.is_empty() && m_nodes[state->nodes.last()].type == Node::Type::Accept;
+    state->is_dead = !flag && (state->nodes.is_empty() || (state->is_match && state->nodes.size() == 1));
+
+    auto* pointer = state.ptr();
+    m_states.append(move(state));
+    cache.set(move(key), pointer);
+    return pointer;
+}
+
+void DFA::flush()
+{
+    m_forward_states.clear();
+    m_reverse_states.clear();
+    m_states.clear();
+    m_cache_size = 0;
+    ++m_flush_count;
+}
+
+Optional<DFA::Match> DFA::find(MatchInput const& input, size_t start, bool anchored)
+{
+    configure(input.regex_options, input.view.is_u8_view());
+
+    auto& view = input.view;
+    auto length = view.length();
+    if (start > length)
+        return {};
+
+    auto* state = forward_start_state(start, length, anchored);
+    Optional<size_t> end;
+    if (state->is_match)
+        end = start;
+    for (size_t position = start; position < length && !state->is_dead; ++position) {
+        state = forward_transition(*state, view[position], position + 1 == length);
+        if (state->is_match)
+            end = position + 1;
+    }
+
+    if (!end.has_value())
+        return {};
+    if (anchored)
+        return Match { start, *end };
+
+    // The match starts at the leftmost position from which the pattern can reach its end at all.
+    Vector<u32> seeds;
+    seeds.append(m_accept_node);
+    state = reverse_closure(seeds, { *end == 0, *end == length });
+    Optional<size_t> match_start;
+    if (state->flag)
+        match_start = *end;
+    for (size_t position = *end; position > start && !state->nodes.is_empty(); --position) {
+        state = reverse_transition(*state, view[position - 1], position == 1);
+        if (state->flag)
+            match_start = position - 1;
+    }
+
+    VERIFY(match_start.has_value());
+    return Match { *match_start, *end };
+}
+
+}
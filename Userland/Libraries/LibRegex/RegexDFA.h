@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+#include "RegexOptions.h"
+
+#include <AK/Array.h>
+#include <AK/HashFunctions.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// Matches patterns without backreferences and lookaround in time linear to the length of the input.
+//
+// The bytecode is turned into an NFA whose epsilon edges keep the priority of the forks, so simulating it finds the
+// same match the backtracking Matcher would. The NFA is simulated by a DFA whose states are only built once the input
+// reaches them: a forward pass finds where the leftmost match ends, and a backward pass over the reversed NFA then
+// finds where it starts.
+class DFA final {
+public:
+    struct Match {
+        size_t start { 0 };
+        size_t end { 0 };
+    };
+
+    // Returns null if the bytecode does something the DFA can't express, e.g. backreferences or lookaround.
+    static OwnPtr<DFA> try_create(ByteCode const&);
+
+    // Finds the first match that starts at or after `start`, or only a match that starts right at `start` if `anchored` is set.
+    // Options that change where CheckBegin and CheckEnd match (MatchNotBeginOfLine, MatchNotEndOfLine) are not supported.
+    Optional<Match> find(MatchInput const&, size_t start, bool anchored);
+
+private:
+    struct Node {
+        enum class Type : u8 {
+            Compare,
+            StringCharacter,
+            Epsilon,
+            CheckBegin,
+            CheckEnd,
+            Accept,
+        };
+
+        bool consumes() const { return type == Type::Compare || type == Type::StringCharacter; }
+
+        Type type { Type::Epsilon };
+        size_t instruction_position { 0 };
+        u32 code_point { 0 };
+
+        // Consuming nodes that compare the same way share their results, see m_compare_results.
+        u32 comparison { 0 };
+
+        // Successors, in the order the backtracker would try them. Nodes that consume or assert have exactly one.
+        Vector<u32, 2> next;
+
+        Vector<u32> epsilon_predecessors;
+        Vector<u32> consuming_predecessors;
+    };
+
+    struct State {
+        // Forward states list the consuming nodes of all live threads in priority order, with the Accept node last if a thread matched.
+        // Backward states list the consuming nodes through which a match could continue backwards, in ascending order.
+        Vector<u32> nodes;
+
+        // Forward states: threads may still start at later positions. Backward states: a match can start at this position.
+        bool flag { false };
+
+        bool is_match { false };
+        bool is_dead { false };
+
+        // Indexed by byte class, see m_byte_classes.
+        Vector<State*> transitions;
+    };
+
+    struct Context {
+        bool at_begin { false };
+        bool at_end { false };
+    };
+
+    struct NodeListTraits : public GenericTraits<Vector<u32>> {
+        static unsigned hash(Vector<u32> const& nodes)
+        {
+            unsigned hash = 0;
+            for (auto node : nodes)
+                hash = pair_int_hash(hash, node);
+            return hash;
+        }
+        static bool equals(Vector<u32> const& a, Vector<u32> const& b) { return a == b; }
+    };
+
+    using StateCache = HashMap<Vector<u32>, State*, NodeListTraits>;
+
+    struct ComparisonTraits : public GenericTraits<Vector<ByteCodeValueType>> {
+        static unsigned hash(Vector<ByteCodeValueType> const& comparison)
+        {
+            unsigned hash = 0;
+            for (auto value : comparison)
+                hash = pair_int_hash(hash, u64_hash(value));
+            return hash;
+        }
+        static bool equals(Vector<ByteCodeValueType> const& a, Vector<ByteCodeValueType> const& b) { return a == b; }
+    };
+
+    explicit DFA(ByteCode const& bytecode)
+        : m_bytecode(bytecode)
+    {
+    }
+
+    bool build_nfa();
+    void configure(AllOptions, bool is_u8_view);
+
+    bool compare(u32 node, u32 code_point) const;
+    bool evaluate_compare(Node const&, u32 code_point) const;
+    State** cached_transition(State&, u32 code_point);
+    void start_generation();
+
+    void add_forward_threads(Vector<u32>& threads, u32 node, Context, bool& matched);
+    State* forward_start_state(size_t position, size_t length, bool anchored);
+    State* forward_step(State const&, u32 code_point, Context);
+    State* forward_transition(State&, u32 code_point, bool at_end);
+
+    State* reverse_closure(Vector<u32> const& seeds, Context);
+    State* reverse_transition(State&, u32 code_point, bool at_begin);
+
+    State* intern(StateCache&, Vector<u32>&& nodes, bool flag);
+    void flush();
+
+    ByteCode const& m_bytecode;
+
+    Vector<Node> m_nodes;
+    u32 m_entry_node { 0 };
+    u32 m_accept_node { 0 };
+
+    bool m_is_configured { false };
+    bool m_is_u8_view { false };
+    AllOptions m_options;
+
+    // One node for each distinct comparison; repetitions like {1,63} copy the same Compare instruction many times.
+    Vector<u32> m_comparison_nodes;
+
+    // Whether each distinct comparison matches each of the first 256 code points.
+    Vector<bool> m_compare_results;
+
+    // Code points below 256 that all nodes treat the same share a byte class, and with it their transitions.
+    Array<u8, 256> m_byte_classes {};
+    size_t m_byte_class_count { 1 };
+
+    NonnullOwnPtrVector<State> m_states;
+    StateCache m_forward_states;
+    StateCache m_reverse_states;
+    size_t m_cache_size { 0 };
+    size_t m_flush_count { 0 };
+
+    Vector<u32> m_visited;
+    u32 m_generation { 0 };
+    Vector<u32> m_stack;
+};
+
+}
@@ -8,9 +8,11 @@
 #include "RegexDebug.h"
 #include "RegexParser.h"
 #include <AK/Debug.h>
+#include <AK/MemMem.h>
 #include <AK/ScopedValueRollback.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
+#include <string.h>
 
 namespace regex {
 
@@ -27,8 +29,10 @@ Regex<Parser>::Regex(StringView pattern, typename ParserTraits<Parser>::OptionsT
     Parser parser(lexer, regex_options);
     parser_result = parser.parse();
 
-    if (parser_result.error == regex::Error::NoError)
+    if (parser_result.error == regex::Error::NoError) {
+        run_optimization_passes(AllOptions { regex_options });
         matcher = make<Matcher<Parser>>(*this, regex_options);
+    }
 }
 
 template<class Parser>
@@ -138,6 +142,15 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
     if (input.regex_options.has_flag_set(AllFlags::Internal_Stateful))
         continue_search = false;
 
+    // The DFA finds matches in linear time. The backtracker then only runs at the start of a match that is known to
+    // exist, and only if somebody wants to know what the capture groups matched.
+    bool use_dfa = m_dfa && !input.regex_options.has_flag_set(AllFlags::MatchNotBeginOfLine) && !input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine);
+    bool anchored = !continue_search && !input.regex_options.has_flag_set(AllFlags::Internal_Stateful);
+    bool needs_capture_groups = !input.regex_options.has_flag_set(AllFlags::SkipSubExprResults)
+        && (m_pattern.parser_result.capture_groups_count || m_pattern.parser_result.named_capture_groups_count);
+    // Unless the match has to start right where we begin, skip ahead to where it could start at all.
+    bool skip_to_possible_match_start = continue_search || input.regex_options.has_flag_set(AllFlags::Internal_Stateful);
+
     for (auto& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -189,13 +202,43 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
             if (match_length_minimum && match_length_minimum > view_length - view_index)
                 break;
 
+            if (skip_to_possible_match_start) {
+                auto possible_match_start = find_possible_match_start(input, view_index);
+                if (!possible_match_start.has_value() || (match_length_minimum && match_length_minimum > view_length - *possible_match_start)) {
+                    // Leave the position where a failed execute() would have left it.
+                    state.string_position = 0;
+                    break;
+                }
+                view_index = *possible_match_start;
+            }
+
             input.column = match_count;
             input.match_index = match_count;
 
-            state.string_position = view_index;
-            state.instruction_position = 0;
+            Optional<bool> success;
+            if (use_dfa) {
+                auto match = m_dfa->find(input, view_index, anchored);
+                if (!match.has_value()) {
+                    // Leave the position where a failed execute() would have left it.
+                    state.string_position = 0;
+                    break;
+                }
+
+                view_index = match->start;
+                state.string_position = match->end;
+                success = true;
+
+                if (needs_capture_groups) {
+                    state.string_position = view_index;
+                    state.instruction_position = 0;
+                    success = execute(input, state, output, 0);
+                }
+            } else {
+                state.string_position = view_index;
+                state.instruction_position = 0;
+                success = execute(input, state, output, 0);
+            }
 
-            auto success = execute(input, state, output, 0);
             if (!success.has_value())
                 return { false, 0, {}, {}, {}, output.operations };
 
@@ -287,6 +330,69 @@ RegexResult Matcher<Parser>::match(const Vector<RegexStringView> views, Optional
     };
 }
 
+// memchr() is vectorized in most C libraries, so let it find the first byte of the prefix. If that turns up too many
+// false positives, the haystack is repetitive enough for AK::memmem() to be faster.
+static Optional<size_t> search_for_literal_prefix(StringView haystack, StringView prefix)
+{
+    auto const* haystack_characters = haystack.characters_without_null_termination();
+    auto const* prefix_characters = prefix.characters_without_null_termination();
+    size_t position = 0;
+    size_t false_positives = 0;
+    while (position + prefix.length() <= haystack.length()) {
+        if (false_positives * 16 > position + 256) {
+            auto offset = AK::memmem_optional(haystack_characters + position, haystack.length() - position, prefix_characters, prefix.length());
+            if (!offset.has_value())
+                return {};
+            return position + *offset;
+        }
+
+        auto const* candidate = static_cast<char const*>(memchr(haystack_characters + position, prefix[0], haystack.length() - prefix.length() + 1 - position));
+        if (!candidate)
+            return {};
+        position = candidate - haystack_characters;
+        if (!memcmp(candidate + 1, prefix_characters + 1, prefix.length() - 1))
+            return position;
+        ++position;
+        ++false_positives;
+    }
+    return {};
+}
+
+template<class Parser>
+Optional<size_t> Matcher<Parser>::find_possible_match_start(const MatchInput& input, size_t position) const
+{
+    auto& data = m_pattern.parser_result.optimization_data;
+    bool is_insensitive = input.regex_options.has_flag_set(AllFlags::Insensitive);
+    auto& view = input.view;
+
+    if (view.is_u8_view() && !is_insensitive && !data.literal_prefix.is_empty()) {
+        auto offset = search_for_literal_prefix(view.u8view().substring_view(position), data.literal_prefix);
+        if (!offset.has_value())
+            return {};
+        return position + *offset;
+    }
+
+    if (!data.starting_code_points.has_value() || is_insensitive != data.is_insensitive)
+        return position;
+
+    auto& starting_code_points = *data.starting_code_points;
+    if (view.is_u8_view()) {
+        auto const* characters = view.u8view().characters_without_null_termination();
+        for (; position < view.length(); ++position) {
+            if (starting_code_points[static_cast<u8>(characters[position])])
+                return position;
+        }
+        return {};
+    }
+
+    for (; position < view.length(); ++position) {
+        auto code_point = view[position];
+        if (code_point >= starting_code_points.size() || starting_code_points[code_point])
+            return position;
+    }
+    return {};
+}
+
 template<class Parser>
 Optional<bool> Matcher<Parser>::execute(const MatchInput& input, MatchState& state, MatchOutput& output, size_t recursion_level) const
 {
@@ -325,6 +431,13 @@ Optional<bool> Matcher<Parser>::execute(const MatchInput& input, MatchState& sta
         case ExecutionResult::Fork_PrioLow:
             reversed_fork_low_prio_states.append(state);
             continue;
+        case ExecutionResult::Fork_PrioLowReplace:
+            // Only this instruction leaves states behind that continue right after it, so a state like that on top is from its previous execution.
+            if (!reversed_fork_low_prio_states.is_empty() && reversed_fork_low_prio_states.last().instruction_position == state.instruction_position)
+                reversed_fork_low_prio_states.last() = state;
+            else
+                reversed_fork_low_prio_states.append(state);
+            continue;
         case ExecutionResult::Fork_PrioHigh:
             fork_high_prio_state = state;
             fork_high_prio_state.instruction_position = fork_high_prio_state.fork_at_position;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "RegexByteCode.h"
+#include "RegexDFA.h"
 #include "RegexMatch.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
@@ -47,6 +48,7 @@ public:
     Matcher(const Regex<Parser>& pattern, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {})
         : m_pattern(pattern)
         , m_regex_options(regex_options.value_or({}))
+        , m_dfa(DFA::try_create(pattern.parser_result.bytecode))
     {
     }
     ~Matcher() = default;
@@ -60,11 +62,13 @@ public:
     }
 
 private:
+    Optional<size_t> find_possible_match_start(const MatchInput& input, size_t position) const;
     Optional<bool> execute(const MatchInput& input, MatchState& state, MatchOutput& output, size_t recursion_level) const;
     ALWAYS_INLINE Optional<bool> execute_low_prio_forks(const MatchInput& input, MatchState& original_state, MatchOutput& output, Vector<MatchState> states, size_t recursion_level) const;
 
     const Regex<Parser>& m_pattern;
     const typename ParserTraits<Parser>::OptionsType m_regex_options;
+    mutable OwnPtr<DFA> m_dfa;
 };
 
 template<class Parser>
@@ -208,6 +212,9 @@ public:
         RegexResult result = matcher->match(views, AllOptions { regex_options.value_or({}) } | AllFlags::SkipSubExprResults);
         return result.success;
     }
+
+private:
+    void run_optimization_passes(AllOptions);
 };
 
 // free standing functions for match, search and has_match
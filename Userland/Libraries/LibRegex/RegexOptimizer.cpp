@@ -0,0 +1,661 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "RegexMatcher.h"
+#include <AK/CharacterTypes.h>
+#include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
+#include <AK/StringBuilder.h>
+
+namespace regex {
+
+// The characters the bytecode compares one after the other before it forks or jumps for the first time.
+static String find_literal_prefix(ByteCode const& bytecode)
+{
+    StringBuilder builder;
+    MatchState state;
+    while (state.instruction_position < bytecode.size()) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::CheckBegin:
+            break;
+        case OpCodeId::Compare: {
+            if (to<OpCode_Compare>(opcode).arguments_count() != 1)
+                return builder.build();
+            auto offset = state.instruction_position + 3;
+            auto type = (CharacterCompareType)bytecode[offset++];
+            if (type == CharacterCompareType::Char) {
+                if (!is_ascii(bytecode[offset]))
+                    return builder.build();
+                builder.append((char)bytecode[offset]);
+                break;
+            }
+            if (type == CharacterCompareType::String) {
+                auto length = bytecode[offset++];
+                for (size_t i = 0; i < length; ++i) {
+                    if (!is_ascii(bytecode[offset + i]))
+                        return builder.build();
+                    builder.append((char)bytecode[offset + i]);
+                }
+                break;
+            }
+            return builder.build();
+        }
+        default:
+            return builder.build();
+        }
+        state.instruction_position += opcode.size();
+    }
+    return builder.build();
+}
+
+// Collects what every comparison that can come first in a match accepts. Gives up on anything that could match
+// without consuming a code point first, or that looks at the input in ways this doesn't follow.
+static Optional<Array<bool, 256>> find_starting_code_points(ByteCode const& bytecode, AllOptions options)
+{
+    Array<bool, 256> code_points {};
+    Vector<bool> visited;
+    visited.resize(bytecode.size());
+    Vector<size_t> instruction_positions;
+    instruction_positions.append(0);
+
+    while (!instruction_positions.is_empty()) {
+        MatchState state;
+        state.instruction_position = instruction_positions.take_last();
+        // Running off the end of the bytecode is a match, and this one didn't consume anything.
+        if (state.instruction_position >= bytecode.size())
+            return {};
+        if (visited[state.instruction_position])
+            continue;
+        visited[state.instruction_position] = true;
+
+        auto& opcode = bytecode.get_opcode(state);
+        auto next = state.instruction_position + opcode.size();
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Jump:
+            instruction_positions.append(next + to<OpCode_Jump>(opcode).offset());
+            break;
+        case OpCodeId::ForkJump:
+            instruction_positions.append(next);
+            instruction_positions.append(next + to<OpCode_ForkJump>(opcode).offset());
+            break;
+        case OpCodeId::ForkStay:
+            instruction_positions.append(next);
+            instruction_positions.append(next + to<OpCode_ForkStay>(opcode).offset());
+            break;
+        case OpCodeId::ForkReplaceStay:
+            instruction_positions.append(next);
+            instruction_positions.append(next + to<OpCode_ForkReplaceStay>(opcode).offset());
+            break;
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            instruction_positions.append(next);
+            break;
+        case OpCodeId::Compare: {
+            auto& compare = to<OpCode_Compare>(opcode);
+            auto offset = state.instruction_position + 3;
+            if (compare.arguments_count() == 1 && (CharacterCompareType)bytecode[offset] == CharacterCompareType::String) {
+                // Strings are always compared on their own, and only ever match UTF-8 views, byte by byte.
+                auto length = bytecode[offset + 1];
+                if (length == 0) {
+                    instruction_positions.append(next);
+                    break;
+                }
+                auto first_byte = static_cast<u8>(bytecode[offset + 2]);
+                for (u32 code_point = 0; code_point < 256; ++code_point) {
+                    if (code_point == first_byte || (options.has_flag_set(AllFlags::Insensitive) && to_ascii_lowercase(code_point) == to_ascii_lowercase(first_byte)))
+                        code_points[code_point] = true;
+                }
+                break;
+            }
+
+            for (size_t i = 0; i < compare.arguments_count(); ++i) {
+                switch ((CharacterCompareType)bytecode[offset++]) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                    ++offset;
+                    break;
+                default:
+                    // Backreferences, which can match an empty capture group.
+                    return {};
+                }
+            }
+            for (u32 code_point = 0; code_point < 256; ++code_point) {
+                if (!code_points[code_point] && compare.matches_code_point(code_point, options))
+                    code_points[code_point] = true;
+            }
+            break;
+        }
+        default:
+            // Lookaround (Save, Restore, GoBack, FailForks) and explicit exits.
+            return {};
+        }
+    }
+
+    return code_points;
+}
+
+namespace {
+
+// The bytecode as a list of instructions, so that instructions can be added and removed without keeping track of jump
+// offsets. Jumps refer to the instruction they continue at by its id instead.
+class BytecodeRewriter {
+public:
+    static constexpr size_t end_id = NumericLimits<size_t>::max();
+
+    struct Instruction {
+        size_t id { 0 };
+        OpCodeId opcode_id { OpCodeId::Exit };
+        // Everything after the opcode id. Jumps and forks keep their offset as `target` instead.
+        Vector<ByteCodeValueType> arguments;
+        Optional<size_t> target;
+    };
+
+    static Optional<BytecodeRewriter> try_create(ByteCode const& bytecode)
+    {
+        BytecodeRewriter rewriter;
+        Vector<bool> is_instruction_start;
+        is_instruction_start.resize(bytecode.size());
+
+        MatchState state;
+        while (state.instruction_position < bytecode.size()) {
+            auto& opcode = bytecode.get_opcode(state);
+            auto position = state.instruction_position;
+            auto size = opcode.size();
+            if (position + size > bytecode.size())
+                return {};
+            // FailForks unwinds a fixed number of forks, which the passes below would change.
+            if (opcode.opcode_id() == OpCodeId::FailForks)
+                return {};
+
+            Instruction instruction { position, opcode.opcode_id(), {}, {} };
+            if (is_jump(opcode.opcode_id())) {
+                auto target = position + size + static_cast<ssize_t>(bytecode[position + 1]);
+                // Anything past the end of the bytecode makes the matcher exit successfully, see ByteCode::get_opcode().
+                instruction.target = target >= bytecode.size() ? end_id : target;
+            } else {
+                instruction.arguments.append(bytecode.data() + position + 1, size - 1);
+            }
+            is_instruction_start[position] = true;
+            rewriter.m_instructions.append(move(instruction));
+            state.instruction_position += size;
+        }
+
+        for (auto& instruction : rewriter.m_instructions) {
+            if (instruction.target.has_value() && *instruction.target != end_id && !is_instruction_start[*instruction.target])
+                return {};
+        }
+
+        rewriter.m_next_id = bytecode.size();
+        rewriter.update();
+        return rewriter;
+    }
+
+    ByteCode to_bytecode() const
+    {
+        HashMap<size_t, size_t> positions;
+        size_t position = 0;
+        for (auto& instruction : m_instructions) {
+            positions.set(instruction.id, position);
+            position += 1 + (instruction.target.has_value() ? 1 : instruction.arguments.size());
+        }
+        positions.set(end_id, position);
+
+        ByteCode bytecode;
+        for (auto& instruction : m_instructions) {
+            bytecode.empend(static_cast<ByteCodeValueType>(instruction.opcode_id));
+            if (instruction.target.has_value())
+                bytecode.empend(static_cast<ByteCodeValueType>(positions.get(*instruction.target).value() - (bytecode.size() + 1)));
+            else
+                bytecode.extend(instruction.arguments);
+        }
+        return bytecode;
+    }
+
+    void optimize_alternations()
+    {
+        // Later alternatives are nested in earlier ones, so going backwards deals with the inner ones first.
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (size_t index = m_instructions.size(); index-- > 0;) {
+                while (index < m_instructions.size() && (hoist_common_prefix(index) || merge_alternatives(index)))
+                    changed = true;
+            }
+        }
+    }
+
+    void make_loops_atomic()
+    {
+        for (size_t index = m_instructions.size(); index-- > 0;) {
+            if (!make_star_loop_atomic(index))
+                make_plus_loop_atomic(index);
+        }
+    }
+
+private:
+    // What a comparison can consume. Case insensitivity can still be switched on when matching, so this covers both.
+    struct CodePointSet {
+        Array<bool, 256> code_points {};
+        bool has_code_points_above_255 { false };
+
+        bool intersects(CodePointSet const& other) const
+        {
+            if (has_code_points_above_255 && other.has_code_points_above_255)
+                return true;
+            for (size_t i = 0; i < code_points.size(); ++i) {
+                if (code_points[i] && other.code_points[i])
+                    return true;
+            }
+            return false;
+        }
+
+        void add(CodePointSet const& other)
+        {
+            for (size_t i = 0; i < code_points.size(); ++i)
+                code_points[i] |= other.code_points[i];
+            has_code_points_above_255 |= other.has_code_points_above_255;
+        }
+    };
+
+    BytecodeRewriter() = default;
+
+    static bool is_jump(OpCodeId opcode_id)
+    {
+        return opcode_id == OpCodeId::Jump || opcode_id == OpCodeId::ForkJump || opcode_id == OpCodeId::ForkStay || opcode_id == OpCodeId::ForkReplaceStay;
+    }
+
+    static bool is_string_compare(Instruction const& instruction)
+    {
+        return instruction.opcode_id == OpCodeId::Compare && instruction.arguments[0] == 1 && (CharacterCompareType)instruction.arguments[2] == CharacterCompareType::String;
+    }
+
+    // Compares that consume a single code point out of a set, without inverting it.
+    static bool is_simple_compare(Instruction const& instruction)
+    {
+        if (instruction.opcode_id != OpCodeId::Compare)
+            return false;
+        size_t offset = 2;
+        for (size_t i = 0; i < instruction.arguments[0]; ++i) {
+            switch ((CharacterCompareType)instruction.arguments[offset++]) {
+            case CharacterCompareType::AnyChar:
+                break;
+            case CharacterCompareType::Char:
+            case CharacterCompareType::CharClass:
+            case CharacterCompareType::CharRange:
+                ++offset;
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static CodePointSet code_points_of_simple_compare(Instruction const& instruction)
+    {
+        CodePointSet set;
+        ByteCode bytecode;
+        bytecode.empend(static_cast<ByteCodeValueType>(OpCodeId::Compare));
+        bytecode.extend(instruction.arguments);
+        MatchState state;
+        auto& compare = to<OpCode_Compare>(bytecode.get_opcode(state));
+        for (u32 code_point = 0; code_point < 256; ++code_point) {
+            set.code_points[code_point] = compare.matches_code_point(code_point, {})
+                || compare.matches_code_point(code_point, AllOptions { AllFlags::Insensitive });
+        }
+
+        // Character classes only know about ASCII.
+        size_t offset = 2;
+        for (size_t i = 0; i < instruction.arguments[0]; ++i) {
+            switch ((CharacterCompareType)instruction.arguments[offset++]) {
+            case CharacterCompareType::AnyChar:
+                set.has_code_points_above_255 = true;
+                break;
+            case CharacterCompareType::Char:
+                set.has_code_points_above_255 |= instruction.arguments[offset] > 255;
+                ++offset;
+                break;
+            case CharacterCompareType::CharRange:
+                set.has_code_points_above_255 |= static_cast<CharRange>(instruction.arguments[offset]).to > 255;
+                ++offset;
+                break;
+            default:
+                ++offset;
+                break;
+            }
+        }
+        return set;
+    }
+
+    // What any path starting at `index` consumes first, if every path either consumes something before it looks at the
+    // input in any other way, or reaches the end of the bytecode.
+    Optional<CodePointSet> first_code_points(size_t start_index) const
+    {
+        CodePointSet set;
+        Vector<bool> visited;
+        visited.resize(m_instructions.size() + 1);
+        Vector<size_t> indices;
+        indices.append(start_index);
+        while (!indices.is_empty()) {
+            auto index = indices.take_last();
+            if (visited[index])
+                continue;
+            visited[index] = true;
+            if (index == m_instructions.size())
+                continue;
+
+            auto& instruction = m_instructions[index];
+            switch (instruction.opcode_id) {
+            case OpCodeId::Jump:
+                indices.append(index_of(*instruction.target));
+                break;
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkStay:
+            case OpCodeId::ForkReplaceStay:
+                indices.append(index + 1);
+                indices.append(index_of(*instruction.target));
+                break;
+            case OpCodeId::SaveLeftCaptureGroup:
+            case OpCodeId::SaveRightCaptureGroup:
+            case OpCodeId::SaveLeftNamedCaptureGroup:
+            case OpCodeId::SaveRightNamedCaptureGroup:
+                indices.append(index + 1);
+                break;
+            case OpCodeId::Compare:
+                if (is_simple_compare(instruction)) {
+                    set.add(code_points_of_simple_compare(instruction));
+                } else if (is_string_compare(instruction) && instruction.arguments[3] > 0) {
+                    // Strings only ever match UTF-8 views, byte by byte.
+                    auto first_byte = static_cast<u8>(instruction.arguments[4]);
+                    for (u32 code_point = 0; code_point < 256; ++code_point)
+                        set.code_points[code_point] |= to_ascii_lowercase(code_point) == to_ascii_lowercase(first_byte);
+                } else {
+                    return {};
+                }
+                break;
+            default:
+                return {};
+            }
+        }
+        return set;
+    }
+
+    // FORKSTAY _END; COMPARE; JUMP _START; _END: becomes atomic if nothing after the loop can start with what the loop
+    // consumes. Giving back an iteration would then only leave the loop in front of a code point that nothing after it
+    // accepts, so the only exit from the loop worth remembering is the last one.
+    bool make_star_loop_atomic(size_t index)
+    {
+        if (index + 2 >= m_instructions.size())
+            return false;
+        auto& fork = m_instructions[index];
+        auto& body = m_instructions[index + 1];
+        auto& jump = m_instructions[index + 2];
+        if (fork.opcode_id != OpCodeId::ForkStay || jump.opcode_id != OpCodeId::Jump || *jump.target != fork.id)
+            return false;
+        if (index_of(*fork.target) != index + 3 || !is_simple_compare(body))
+            return false;
+        if (!m_incoming_jumps[index + 1].is_empty() || !m_incoming_jumps[index + 2].is_empty())
+            return false;
+        if (!can_loop_be_atomic(body, index + 3))
+            return false;
+
+        fork.opcode_id = OpCodeId::ForkReplaceStay;
+        return true;
+    }
+
+    // COMPARE; FORKJUMP _START; is the same loop with one mandatory iteration, which is rewritten into that form first:
+    // COMPARE; _LOOP: FORKREPLACESTAY _END; COMPARE; JUMP _LOOP; _END:
+    bool make_plus_loop_atomic(size_t index)
+    {
+        if (index + 1 >= m_instructions.size())
+            return false;
+        auto& body = m_instructions[index];
+        auto& fork = m_instructions[index + 1];
+        if (fork.opcode_id != OpCodeId::ForkJump || *fork.target != body.id || !is_simple_compare(body))
+            return false;
+        if (!m_incoming_jumps[index + 1].is_empty())
+            return false;
+        if (!can_loop_be_atomic(body, index + 2))
+            return false;
+
+        auto end_target = index + 2 < m_instructions.size() ? m_instructions[index + 2].id : end_id;
+        fork.opcode_id = OpCodeId::ForkReplaceStay;
+        fork.target = end_target;
+        auto loop_id = fork.id;
+        m_instructions.insert(index + 2, Instruction { m_next_id++, OpCodeId::Compare, body.arguments, {} });
+        m_instructions.insert(index + 3, Instruction { m_next_id++, OpCodeId::Jump, {}, loop_id });
+        update();
+        return true;
+    }
+
+    bool can_loop_be_atomic(Instruction const& body, size_t continuation_index) const
+    {
+        auto continuation = first_code_points(continuation_index);
+        return continuation.has_value() && !code_points_of_simple_compare(body).intersects(*continuation);
+    }
+
+    struct Alternation {
+        size_t alternative { 0 };
+        size_t end { 0 };
+    };
+
+    // Recognizes FORKJUMP _ALT; (second alternative); JUMP _END; _ALT: (first alternative); _END: that nothing outside
+    // jumps into, and returns the indices of _ALT and _END.
+    Optional<Alternation> alternation_at(size_t index) const
+    {
+        auto& fork = m_instructions[index];
+        if (fork.opcode_id != OpCodeId::ForkJump || *fork.target == end_id)
+            return {};
+        auto alternative = index_of(*fork.target);
+        if (alternative < index + 2)
+            return {};
+        auto& jump = m_instructions[alternative - 1];
+        if (jump.opcode_id != OpCodeId::Jump)
+            return {};
+        auto end = index_of(*jump.target);
+        if (end < alternative)
+            return {};
+
+        for (auto inner = index + 1; inner < end; ++inner) {
+            for (auto source : m_incoming_jumps[inner]) {
+                if (source < index || source >= end)
+                    return {};
+            }
+            if (m_instructions[inner].target.has_value()) {
+                auto target = index_of(*m_instructions[inner].target);
+                if (target <= index || target > end)
+                    return {};
+            }
+        }
+        return Alternation { alternative, end };
+    }
+
+    // (a|b) becomes [ab], as long as both alternatives are a single compare of one code point.
+    bool merge_alternatives(size_t index)
+    {
+        auto alternation = alternation_at(index);
+        if (!alternation.has_value())
+            return false;
+        auto [alternative, end] = *alternation;
+        if (alternative != index + 3 || end != index + 4)
+            return false;
+        auto& second = m_instructions[index + 1];
+        auto& first = m_instructions[index + 3];
+        if (!is_simple_compare(first) || !is_simple_compare(second))
+            return false;
+
+        // Compare matches if any of its arguments does.
+        Instruction merged { m_instructions[index].id, OpCodeId::Compare, {}, {} };
+        merged.arguments.append(first.arguments[0] + second.arguments[0]);
+        merged.arguments.append(first.arguments[1] + second.arguments[1]);
+        merged.arguments.append(first.arguments.data() + 2, first.arguments.size() - 2);
+        merged.arguments.append(second.arguments.data() + 2, second.arguments.size() - 2);
+
+        m_instructions.remove(index, 4);
+        m_instructions.insert(index, move(merged));
+        update();
+        return true;
+    }
+
+    // abc|abd becomes ab(c|d). A compare only matches in one way, so this doesn't change which alternative wins.
+    bool hoist_common_prefix(size_t index)
+    {
+        auto alternation = alternation_at(index);
+        if (!alternation.has_value())
+            return false;
+        auto [alternative, end] = *alternation;
+
+        auto second_length = alternative - 1 - (index + 1);
+        auto first_length = end - alternative;
+        size_t prefix_length = 0;
+        while (prefix_length < min(first_length, second_length)) {
+            auto& second = m_instructions[index + 1 + prefix_length];
+            auto& first = m_instructions[alternative + prefix_length];
+            if (second.opcode_id != OpCodeId::Compare || first.opcode_id != OpCodeId::Compare)
+                break;
+            if (!m_incoming_jumps[index + 1 + prefix_length].is_empty() || m_incoming_jumps[alternative + prefix_length].size() != (prefix_length == 0 ? 1 : 0))
+                break;
+            if (first.arguments == second.arguments) {
+                ++prefix_length;
+                continue;
+            }
+            if (split_strings_at_common_prefix(index + 1 + prefix_length, alternative + prefix_length))
+                return true;
+            break;
+        }
+        if (prefix_length == 0)
+            return false;
+
+        auto second_begin = index + 1 + prefix_length;
+        auto first_begin = alternative + prefix_length;
+        auto fork_target = first_begin < end ? m_instructions[first_begin].id : *m_instructions[alternative - 1].target;
+
+        Vector<Instruction> rewritten;
+        for (size_t i = 0; i < prefix_length; ++i)
+            rewritten.append(m_instructions[alternative + i]);
+        // Whatever jumped to the alternation now has to go through the prefix first.
+        rewritten.first().id = m_instructions[index].id;
+        rewritten.append(Instruction { m_next_id++, OpCodeId::ForkJump, {}, fork_target });
+        for (auto i = second_begin; i < end; ++i) {
+            if (i < alternative || i >= first_begin)
+                rewritten.append(m_instructions[i]);
+        }
+
+        m_instructions.remove(index, end - index);
+        for (size_t i = 0; i < rewritten.size(); ++i)
+            m_instructions.insert(index + i, move(rewritten[i]));
+        update();
+        return true;
+    }
+
+    // Splits two string compares that start the same way, so the common part can be hoisted on its own.
+    bool split_strings_at_common_prefix(size_t second_index, size_t first_index)
+    {
+        auto& second = m_instructions[second_index];
+        auto& first = m_instructions[first_index];
+        if (!is_string_compare(second) || !is_string_compare(first))
+            return false;
+
+        auto string_of = [](Instruction const& instruction) {
+            return instruction.arguments.span().slice(4, instruction.arguments[3]);
+        };
+        auto second_string = string_of(second);
+        auto first_string = string_of(first);
+        size_t common_length = 0;
+        while (common_length < min(first_string.size(), second_string.size()) && first_string[common_length] == second_string[common_length])
+            ++common_length;
+        if (common_length == 0)
+            return false;
+
+        auto split = [&](size_t index) {
+            Vector<ByteCodeValueType> string;
+            string.append(string_of(m_instructions[index]).data(), m_instructions[index].arguments[3]);
+            if (common_length == string.size())
+                return;
+            auto make_string_compare = [](Span<ByteCodeValueType const> characters) {
+                Vector<ByteCodeValueType> arguments;
+                arguments.append(1);
+                arguments.append(characters.size() + 2);
+                arguments.append(static_cast<ByteCodeValueType>(CharacterCompareType::String));
+                arguments.append(characters.size());
+                arguments.append(characters.data(), characters.size());
+                return arguments;
+            };
+            m_instructions[index].arguments = make_string_compare(string.span().slice(0, common_length));
+            m_instructions.insert(index + 1, Instruction { m_next_id++, OpCodeId::Compare, make_string_compare(string.span().slice(common_length)), {} });
+        };
+        // The first alternative comes later, so splitting it first keeps the other index valid.
+        split(first_index);
+        split(second_index);
+        update();
+        return true;
+    }
+
+    size_t index_of(size_t id) const
+    {
+        if (id == end_id)
+            return m_instructions.size();
+        return m_indices.get(id).value();
+    }
+
+    void update()
+    {
+        m_indices.clear();
+        for (size_t i = 0; i < m_instructions.size(); ++i)
+            m_indices.set(m_instructions[i].id, i);
+
+        m_incoming_jumps.clear_with_capacity();
+        m_incoming_jumps.resize(m_instructions.size() + 1);
+        for (size_t i = 0; i < m_instructions.size(); ++i) {
+            if (m_instructions[i].target.has_value())
+                m_incoming_jumps[index_of(*m_instructions[i].target)].append(i);
+        }
+    }
+
+    Vector<Instruction> m_instructions;
+    HashMap<size_t, size_t> m_indices;
+    Vector<Vector<size_t, 1>> m_incoming_jumps;
+    size_t m_next_id { 0 };
+};
+
+}
+
+template<class Parser>
+void Regex<Parser>::run_optimization_passes(AllOptions options)
+{
+    auto& bytecode = parser_result.bytecode;
+    auto& data = parser_result.optimization_data;
+
+    if (auto rewriter = BytecodeRewriter::try_create(bytecode); rewriter.has_value()) {
+        rewriter->optimize_alternations();
+        rewriter->make_loops_atomic();
+        bytecode = rewriter->to_bytecode();
+    }
+
+    data.is_insensitive = options.has_flag_set(AllFlags::Insensitive);
+    if (!data.is_insensitive)
+        data.literal_prefix = find_literal_prefix(bytecode);
+    data.starting_code_points = find_starting_code_points(bytecode, options);
+}
+
+template void Regex<PosixExtendedParser>::run_optimization_passes(AllOptions);
+template void Regex<ECMA262Parser>::run_optimization_passes(AllOptions);
+
+}
@@ -155,7 +155,8 @@ Parser::Result Parser::parse(Optional<AllOptions> regex_options)
         move(m_parser_state.named_capture_groups_count),
         move(m_parser_state.match_length_minimum),
         move(m_parser_state.error),
-        move(m_parser_state.error_token)
+        move(m_parser_state.error_token),
+        {}
     };
 }
 
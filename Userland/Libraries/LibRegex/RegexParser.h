@@ -11,7 +11,10 @@
 #include "RegexLexer.h"
 #include "RegexOptions.h"
 
+#include <AK/Array.h>
 #include <AK/Forward.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
@@ -38,6 +41,18 @@ template<>
 struct ParserTraits<ECMA262Parser> : public GenericParserTraits<ECMAScriptOptions> {
 };
 
+// What the optimizer found out about a pattern, see Regex::run_optimization_passes().
+struct OptimizationData {
+    // Every match starts with these characters. Only ASCII is collected, so bytes and code points agree on them.
+    String literal_prefix;
+
+    // If known, which of the first 256 code points a match can start with. Code points above that are never ruled out.
+    Optional<Array<bool, 256>> starting_code_points;
+
+    // Both of the above only hold if the pattern is matched with the same case sensitivity.
+    bool is_insensitive { false };
+};
+
 class Parser {
 public:
     struct Result {
@@ -47,6 +62,7 @@ public:
         size_t match_length_minimum;
         Error error;
         Token error_token;
+        OptimizationData optimization_data;
     };
 
     explicit Parser(Lexer& lexer)
@@ -431,6 +431,28 @@ private:
     String m_column_name;
 };
 
+class FunctionCallExpression : public Expression {
+public:
+    FunctionCallExpression(String name, NonnullRefPtrVector<Expression> arguments, bool select_all_arguments, bool distinct)
+        : m_name(move(name))
+        , m_arguments(move(arguments))
+        , m_select_all_arguments(select_all_arguments)
+        , m_distinct(distinct)
+    {
+    }
+
+    const String& name() const { return m_name; }
+    const NonnullRefPtrVector<Expression>& arguments() const { return m_arguments; }
+    bool select_all_arguments() const { return m_select_all_arguments; }
+    bool distinct() const { return m_distinct; }
+
+private:
+    String m_name;
+    NonnullRefPtrVector<Expression> m_arguments;
+    bool m_select_all_arguments;
+    bool m_distinct;
+};
+
 enum class UnaryOperator {
     Minus,
     Plus,
@@ -352,6 +352,11 @@ RefPtr<CommonTableExpressionList> Parser::parse_common_table_expression_list()
 }
 
 NonnullRefPtr<Expression> Parser::parse_expression()
+{
+    return parse_expression(Precedence::Lowest);
+}
+
+NonnullRefPtr<Expression> Parser::parse_expression(Precedence minimum_precedence, RefPtr<Expression> with_parsed_primary)
 {
     if (++m_parser_state.m_current_expression_depth > Limits::maximum_expression_tree_depth) {
         syntax_error(String::formatted("Exceeded maximum expression tree depth of {}", Limits::maximum_expression_tree_depth));
@@ -359,13 +364,16 @@ NonnullRefPtr<Expression> Parser::parse_expression()
     }
 
     // https://sqlite.org/lang_expr.html
-    auto expression = parse_primary_expression();
+    NonnullRefPtr<Expression> expression = with_parsed_primary.is_null()
+        ? parse_primary_expression()
+        : with_parsed_primary.release_nonnull();
 
-    if (match_secondary_expression())
+    // Operators of the same precedence are left-associative, so only operators that bind tighter than the
+    // one which started this sub-expression are folded into it.
+    while (!has_errors() && match_secondary_expression() && secondary_expression_precedence() > minimum_precedence)
         expression = parse_secondary_expression(move(expression));
 
     // FIXME: Parse 'bind-parameter'.
-    // FIXME: Parse 'function-name'.
     // FIXME: Parse 'raise-function'.
 
     --m_parser_state.m_current_expression_depth;
@@ -469,6 +477,40 @@ bool Parser::match_secondary_expression() const
         || match(TokenType::In);
 }
 
+Parser::Precedence Parser::secondary_expression_precedence() const
+{
+    switch (m_parser_state.m_token.type()) {
+    case TokenType::Collate:
+        return Precedence::Collate;
+    case TokenType::DoublePipe:
+        return Precedence::Concatenate;
+    case TokenType::Asterisk:
+    case TokenType::Divide:
+    case TokenType::Modulus:
+        return Precedence::Multiplicative;
+    case TokenType::Plus:
+    case TokenType::Minus:
+        return Precedence::Additive;
+    case TokenType::ShiftLeft:
+    case TokenType::ShiftRight:
+    case TokenType::Ampersand:
+    case TokenType::Pipe:
+        return Precedence::Bitwise;
+    case TokenType::LessThan:
+    case TokenType::LessThanEquals:
+    case TokenType::GreaterThan:
+    case TokenType::GreaterThanEquals:
+        return Precedence::Comparison;
+    case TokenType::And:
+        return Precedence::And;
+    case TokenType::Or:
+        return Precedence::Or;
+    default:
+        // NOT (as in NOT LIKE, NOT IN, ...) and the remaining equality-like operators.
+        return Precedence::Equality;
+    }
+}
+
 Optional<NonnullRefPtr<Expression>> Parser::parse_literal_value_expression()
 {
     if (match(TokenType::NumericLiteral)) {
@@ -517,6 +559,8 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_column_name_expression(String
             table_name = move(first_identifier);
             column_name = move(second_identifier);
         }
+    } else if (match(TokenType::ParenOpen)) {
+        return parse_function_call_expression(move(first_identifier));
     } else {
         column_name = move(first_identifier);
     }
@@ -524,22 +568,45 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_column_name_expression(String
     return create_ast_node<ColumnNameExpression>(move(schema_name), move(table_name), move(column_name));
 }
 
+NonnullRefPtr<Expression> Parser::parse_function_call_expression(String function_name)
+{
+    // https://sqlite.org/syntax/simple-function-invocation.html
+    // https://sqlite.org/syntax/aggregate-function-invocation.html
+    consume(TokenType::ParenOpen);
+
+    NonnullRefPtrVector<Expression> arguments;
+    bool select_all_arguments = false;
+    bool distinct = false;
+
+    if (consume_if(TokenType::Asterisk)) {
+        select_all_arguments = true;
+    } else if (!match(TokenType::ParenClose)) {
+        distinct = consume_if(TokenType::Distinct);
+        parse_comma_separated_list(false, [&]() { arguments.append(parse_expression()); });
+    }
+
+    consume(TokenType::ParenClose);
+
+    // FIXME: Parse 'filter-clause' and 'over-clause'.
+    return create_ast_node<FunctionCallExpression>(move(function_name), move(arguments), select_all_arguments, distinct);
+}
+
 Optional<NonnullRefPtr<Expression>> Parser::parse_unary_operator_expression()
 {
     if (consume_if(TokenType::Minus))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Minus, parse_expression());
+        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Minus, parse_expression(Precedence::Unary));
 
     if (consume_if(TokenType::Plus))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Plus, parse_expression());
+        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Plus, parse_expression(Precedence::Unary));
 
     if (consume_if(TokenType::Tilde))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::BitwiseNot, parse_expression());
+        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::BitwiseNot, parse_expression(Precedence::Unary));
 
     if (consume_if(TokenType::Not)) {
         if (match(TokenType::Exists))
             return parse_exists_expression(true);
         else
-            return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Not, parse_expression());
+            return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Not, parse_expression(Precedence::Not));
     }
 
     return {};
@@ -548,58 +615,58 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_unary_operator_expression()
 Optional<NonnullRefPtr<Expression>> Parser::parse_binary_operator_expression(NonnullRefPtr<Expression> lhs)
 {
     if (consume_if(TokenType::DoublePipe))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Concatenate, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Concatenate, move(lhs), parse_expression(Precedence::Concatenate));
 
     if (consume_if(TokenType::Asterisk))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Multiplication, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Multiplication, move(lhs), parse_expression(Precedence::Multiplicative));
 
     if (consume_if(TokenType::Divide))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Division, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Division, move(lhs), parse_expression(Precedence::Multiplicative));
 
     if (consume_if(TokenType::Modulus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Modulo, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Modulo, move(lhs), parse_expression(Precedence::Multiplicative));
 
     if (consume_if(TokenType::Plus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Plus, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Plus, move(lhs), parse_expression(Precedence::Additive));
 
     if (consume_if(TokenType::Minus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Minus, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Minus, move(lhs), parse_expression(Precedence::Additive));
 
     if (consume_if(TokenType::ShiftLeft))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftLeft, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftLeft, move(lhs), parse_expression(Precedence::Bitwise));
 
     if (consume_if(TokenType::ShiftRight))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftRight, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftRight, move(lhs), parse_expression(Precedence::Bitwise));
 
     if (consume_if(TokenType::Ampersand))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseAnd, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseAnd, move(lhs), parse_expression(Precedence::Bitwise));
 
     if (consume_if(TokenType::Pipe))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseOr, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseOr, move(lhs), parse_expression(Precedence::Bitwise));
 
     if (consume_if(TokenType::LessThan))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThan, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThan, move(lhs), parse_expression(Precedence::Comparison));
 
     if (consume_if(TokenType::LessThanEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThanEquals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThanEquals, move(lhs), parse_expression(Precedence::Comparison));
 
     if (consume_if(TokenType::GreaterThan))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThan, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThan, move(lhs), parse_expression(Precedence::Comparison));
 
     if (consume_if(TokenType::GreaterThanEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThanEquals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThanEquals, move(lhs), parse_expression(Precedence::Comparison));
 
     if (consume_if(TokenType::Equals) || consume_if(TokenType::EqualsEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Equals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Equals, move(lhs), parse_expression(Precedence::Equality));
 
     if (consume_if(TokenType::NotEquals1) || consume_if(TokenType::NotEquals2))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::NotEquals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::NotEquals, move(lhs), parse_expression(Precedence::Equality));
 
     if (consume_if(TokenType::And))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::And, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::And, move(lhs), parse_expression(Precedence::And));
 
     if (consume_if(TokenType::Or))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Or, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Or, move(lhs), parse_expression(Precedence::Or));
 
     return {};
 }
@@ -707,7 +774,7 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_is_expression(NonnullRefPtr<Ex
         invert_expression = true;
     }
 
-    auto rhs = parse_expression();
+    auto rhs = parse_expression(Precedence::Equality);
     return create_ast_node<IsExpression>(move(expression), move(rhs), invert_expression);
 }
 
@@ -716,21 +783,21 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_match_expression(NonnullRefPtr
     auto parse_escape = [this]() {
         RefPtr<Expression> escape;
         if (consume_if(TokenType::Escape))
-            escape = parse_expression();
+            escape = parse_expression(Precedence::Equality);
         return escape;
     };
 
     if (consume_if(TokenType::Like))
-        return create_ast_node<MatchExpression>(MatchOperator::Like, move(lhs), parse_expression(), parse_escape(), invert_expression);
+        return create_ast_node<MatchExpression>(MatchOperator::Like, move(lhs), parse_expression(Precedence::Equality), parse_escape(), invert_expression);
 
     if (consume_if(TokenType::Glob))
-        return create_ast_node<MatchExpression>(MatchOperator::Glob, move(lhs), parse_expression(), parse_escape(), invert_expression);
+        return create_ast_node<MatchExpression>(MatchOperator::Glob, move(lhs), parse_expression(Precedence::Equality), parse_escape(), invert_expression);
 
     if (consume_if(TokenType::Match))
-        return create_ast_node<MatchExpression>(MatchOperator::Match, move(lhs), parse_expression(), parse_escape(), invert_expression);
+        return create_ast_node<MatchExpression>(MatchOperator::Match, move(lhs), parse_expression(Precedence::Equality), parse_escape(), invert_expression);
 
     if (consume_if(TokenType::Regexp))
-        return create_ast_node<MatchExpression>(MatchOperator::Regexp, move(lhs), parse_expression(), parse_escape(), invert_expression);
+        return create_ast_node<MatchExpression>(MatchOperator::Regexp, move(lhs), parse_expression(Precedence::Equality), parse_escape(), invert_expression);
 
     return {};
 }
@@ -753,19 +820,12 @@ Optional<NonnullRefPtr<Expression>> Parser::parse_between_expression(NonnullRefP
 
     consume();
 
-    auto nested = parse_expression();
-    if (!is<BinaryOperatorExpression>(*nested)) {
-        expected("Binary Expression");
-        return create_ast_node<ErrorExpression>();
-    }
-
-    const auto& binary_expression = static_cast<const BinaryOperatorExpression&>(*nested);
-    if (binary_expression.type() != BinaryOperator::And) {
-        expected("AND Expression");
-        return create_ast_node<ErrorExpression>();
-    }
+    // The AND separating the bounds binds looser than everything that may appear in them.
+    auto lower_bound = parse_expression(Precedence::And);
+    consume(TokenType::And);
+    auto upper_bound = parse_expression(Precedence::Equality);
 
-    return create_ast_node<BetweenExpression>(move(expression), binary_expression.lhs(), binary_expression.rhs(), invert_expression);
+    return create_ast_node<BetweenExpression>(move(expression), move(lower_bound), move(upper_bound), invert_expression);
 }
 
 Optional<NonnullRefPtr<Expression>> Parser::parse_in_expression(NonnullRefPtr<Expression> expression, bool invert_expression)
@@ -936,7 +996,7 @@ NonnullRefPtr<ResultColumn> Parser::parse_result_column()
 
     auto expression = table_name.is_null()
         ? parse_expression()
-        : static_cast<NonnullRefPtr<Expression>>(*parse_column_name_expression(move(table_name), parsed_period));
+        : parse_expression(Precedence::Lowest, *parse_column_name_expression(move(table_name), parsed_period));
 
     String column_alias;
     if (consume_if(TokenType::As) || match(TokenType::Identifier))
@@ -43,6 +43,22 @@ protected:
     NonnullRefPtr<Expression> parse_expression(); // Protected for unit testing.
 
 private:
+    // https://sqlite.org/lang_expr.html#operators, from loosest to tightest binding.
+    enum class Precedence {
+        Lowest,
+        Or,
+        And,
+        Not,
+        Equality, // = == != <> IS IN LIKE GLOB MATCH REGEXP BETWEEN ISNULL NOTNULL
+        Comparison,
+        Bitwise,
+        Additive,
+        Multiplicative,
+        Concatenate,
+        Collate,
+        Unary,
+    };
+
     struct ParserState {
         explicit ParserState(Lexer);
 
@@ -64,11 +80,14 @@ private:
     NonnullRefPtr<Select> parse_select_statement(RefPtr<CommonTableExpressionList>);
     RefPtr<CommonTableExpressionList> parse_common_table_expression_list();
 
+    NonnullRefPtr<Expression> parse_expression(Precedence minimum_precedence, RefPtr<Expression> with_parsed_primary = {});
     NonnullRefPtr<Expression> parse_primary_expression();
     NonnullRefPtr<Expression> parse_secondary_expression(NonnullRefPtr<Expression> primary);
     bool match_secondary_expression() const;
+    Precedence secondary_expression_precedence() const;
     Optional<NonnullRefPtr<Expression>> parse_literal_value_expression();
     Optional<NonnullRefPtr<Expression>> parse_column_name_expression(String with_parsed_identifier = {}, bool with_parsed_period = false);
+    NonnullRefPtr<Expression> parse_function_call_expression(String function_name);
     Optional<NonnullRefPtr<Expression>> parse_unary_operator_expression();
     Optional<NonnullRefPtr<Expression>> parse_binary_operator_expression(NonnullRefPtr<Expression> lhs);
     Optional<NonnullRefPtr<Expression>> parse_chained_expression();
@@ -29,6 +29,21 @@ BTreeIterator BTree::begin()
     return BTreeIterator(m_root, -1);
 }
 
+BTreeIterator BTree::last()
+{
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+
+    // The largest key is the last one in the rightmost leaf.
+    auto* node = m_root.ptr();
+    while (!node->is_leaf() && node->size() != 0)
+        node = node->down_node(node->size());
+    if (node->size() == 0)
+        return end();
+    return BTreeIterator(node, (int)node->size() - 1);
+}
+
 BTreeIterator BTree::end()
 {
     return BTreeIterator(nullptr, -1);
@@ -70,6 +85,113 @@ bool BTree::insert(Key const& key)
     return m_root->insert(key);
 }
 
+// Builds the tree bottom-up from keys which are already in sort order, which is a lot faster than
+// inserting them one by one and produces nodes which are filled up to the fill factor instead of
+// nodes which are only half full after being split. If the tree already contains keys, the keys are
+// inserted one by one instead. Returns false if a unique tree would end up with duplicate keys, in
+// which case nothing is changed.
+bool BTree::bulk_load(Vector<Key> const& sorted_keys, double fill_factor)
+{
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+
+    for (size_t ix = 1; ix < sorted_keys.size(); ix++) {
+        VERIFY(sorted_keys[ix - 1] <= sorted_keys[ix]);
+        if (!duplicates_allowed() && sorted_keys[ix - 1] == sorted_keys[ix])
+            return false;
+    }
+
+    if (m_root->size() > 0) {
+        for (auto& key : sorted_keys) {
+            if (!insert(key))
+                return false;
+        }
+        return true;
+    }
+    if (sorted_keys.is_empty())
+        return true;
+
+    auto target_length = clamp((size_t)(fill_factor * BLOCKSIZE), BLOCKSIZE / 2, BLOCKSIZE);
+    Vector<Key> keys = sorted_keys;
+    Vector<u32> children;
+    while (true) {
+        Vector<NonnullOwnPtr<TreeNode>> nodes;
+        Vector<Key> separators;
+        build_level(keys, children, target_length, nodes, separators);
+        if (nodes.size() == 1) {
+            // The root keeps the block the (empty) root was stored in, so the tree's pointer doesn't change.
+            auto root = move(nodes.first());
+            root->set_pointer(pointer());
+            add_to_write_ahead_log(root.ptr());
+            m_root = move(root);
+            return true;
+        }
+
+        children.clear();
+        for (auto& node : nodes) {
+            node->set_pointer(new_record_pointer());
+            add_to_write_ahead_log(node.ptr());
+            children.append(node->pointer());
+        }
+        keys = move(separators);
+    }
+}
+
+// Distributes the keys of one level of the tree over as few nodes as possible. For leaves, children
+// is empty; otherwise it holds the pointers of the nodes of the level below, one more than there are
+// keys. Every node but the last is closed when adding the next key would exceed the target length,
+// and that key moves up to the next level as the separator between the node and the next one.
+void BTree::build_level(Vector<Key> const& keys, Vector<u32> const& children, size_t target_length, Vector<NonnullOwnPtr<TreeNode>>& nodes, Vector<Key>& separators)
+{
+    auto is_leaf = children.is_empty();
+    auto down_length = is_leaf ? 0 : sizeof(u32);
+    size_t ix = 0;
+    while (true) {
+        auto node = make<TreeNode>(*this, nullptr, 0u);
+        if (!is_leaf) {
+            node->m_down.clear();
+            node->m_down.empend(node.ptr(), children[ix]);
+            node->m_is_leaf = false;
+        }
+
+        size_t length = sizeof(u32) + sizeof(u8) + down_length;
+        ByteBuffer previous;
+        while (ix < keys.size()) {
+            auto bytes = TreeNode::key_bytes(keys[ix]);
+            auto entry_length = TreeNode::encoded_key_length(previous, bytes) + down_length;
+
+            // The last key may fill the node beyond the target length, since it can't become a
+            // separator: there would be no keys left for the node to the right of it.
+            auto limit = (ix == keys.size() - 1) ? BLOCKSIZE : target_length;
+            if (node->size() > 0 && length + entry_length > limit)
+                break;
+
+            node->m_entries.append(keys[ix]);
+            node->m_down.empend(node.ptr(), is_leaf ? 0 : children[ix + 1]);
+            length += entry_length;
+            previous = move(bytes);
+            ix++;
+        }
+
+        if (ix == keys.size()) {
+            nodes.append(move(node));
+            return;
+        }
+
+        if (ix == keys.size() - 1) {
+            // Only the separator would be left for the next node. Give it this node's last key instead.
+            VERIFY(node->size() >= 2);
+            node->m_entries.take_last();
+            node->m_down.take_last();
+            ix--;
+        }
+        separators.append(keys[ix]);
+        ix++;
+        nodes.append(move(node));
+    }
+}
+
 bool BTree::update_key_pointer(Key const& key)
 {
     if (!m_root)
@@ -103,6 +225,30 @@ BTreeIterator BTree::find(Key const& key)
     return end();
 }
 
+// Returns an iterator pointing to the first key that is not less than the given key, comparing
+// only as many parts as the given key has. Unlike find(), this also works for trees with duplicates.
+BTreeIterator BTree::lower_bound(Key const& key)
+{
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+
+    // The first matching key of a node's subtree is either in the subtree left of the node's
+    // first matching key, or it is that key itself.
+    auto candidate = end();
+    for (auto* node = m_root.ptr(); node;) {
+        size_t ix = 0;
+        while (ix < node->size() && (*node)[ix] < key)
+            ix++;
+        if (ix < node->size())
+            candidate = BTreeIterator(node, (int)ix);
+        if (node->is_leaf())
+            break;
+        node = node->down_node(ix);
+    }
+    return candidate;
+}
+
 void BTree::list_tree()
 {
     if (!m_root)
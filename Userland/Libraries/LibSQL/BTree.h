@@ -77,6 +77,17 @@ public:
 
 private:
     TreeNode(BTree&, TreeNode*, DownPointer&, u32 = 0);
+
+    static ByteBuffer key_bytes(Key const&);
+    static size_t shared_prefix_length(ReadonlyBytes previous, ReadonlyBytes key);
+    static size_t suffix_length(ReadonlyBytes key, size_t shared);
+    static size_t encoded_key_length(size_t shared, size_t suffix_length);
+    static size_t encoded_key_length(ReadonlyBytes previous, ReadonlyBytes key);
+    static void serialize_length(ByteBuffer&, size_t);
+    static size_t deserialize_length(ByteBuffer&, size_t&);
+    [[nodiscard]] size_t serialized_length() const;
+    [[nodiscard]] bool is_overfull();
+
     void dump_if(int, String&& = "");
     bool insert_in_leaf(Key const&);
     void just_insert(Key const&, TreeNode* = nullptr);
@@ -97,14 +108,21 @@ class BTree : public Index {
     C_OBJECT(BTree);
 
 public:
+    // Nodes built by bulk_load() are filled up to this fraction of a block, leaving room for a few
+    // inserts before the first splits.
+    static constexpr double default_fill_factor = 0.9;
+
     ~BTree() override = default;
 
     u32 root() const { return (m_root) ? m_root->pointer() : 0; }
     bool insert(Key const&);
+    bool bulk_load(Vector<Key> const& sorted_keys, double fill_factor = default_fill_factor);
     bool update_key_pointer(Key const&);
     Optional<u32> get(Key&);
     BTreeIterator find(Key const& key);
+    BTreeIterator lower_bound(Key const& key);
     BTreeIterator begin();
+    BTreeIterator last();
     static BTreeIterator end();
     void list_tree();
 
@@ -115,6 +133,7 @@ private:
     BTree(Heap& heap, TupleDescriptor const&, u32 pointer);
     void initialize_root();
     TreeNode* new_root();
+    void build_level(Vector<Key> const& keys, Vector<u32> const& children, size_t target_length, Vector<NonnullOwnPtr<TreeNode>>& nodes, Vector<Key>& separators);
     OwnPtr<TreeNode> m_root { nullptr };
 
     friend BTreeIterator;
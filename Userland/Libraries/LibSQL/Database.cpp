@@ -5,6 +5,7 @@
  */
 
 #include <AK/Format.h>
+#include <AK/QuickSort.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 
@@ -22,6 +23,7 @@ Database::Database(String name)
     , m_schemas(BTree::construct(*m_heap, SchemaDef::index_def()->to_tuple_descriptor(), m_heap->schemas_root()))
     , m_tables(BTree::construct(*m_heap, TableDef::index_def()->to_tuple_descriptor(), m_heap->tables_root()))
     , m_table_columns(BTree::construct(*m_heap, ColumnDef::index_def()->to_tuple_descriptor(), m_heap->table_columns_root()))
+    , m_indexes(BTree::construct(*m_heap, IndexDef::index_def()->to_tuple_descriptor(), m_heap->indexes_root()))
 {
     m_schemas->on_new_root = [&]() {
         m_heap->set_schemas_root(m_schemas->root());
@@ -32,6 +34,9 @@ Database::Database(String name)
     m_table_columns->on_new_root = [&]() {
         m_heap->set_table_columns_root(m_table_columns->root());
     };
+    m_indexes->on_new_root = [&]() {
+        m_heap->set_indexes_root(m_indexes->root());
+    };
 }
 
 void Database::add_schema(SchemaDef const& schema)
@@ -94,16 +99,80 @@ RefPtr<TableDef> Database::get_table(String const& schema, String const& name)
     ret->set_pointer((*table_iterator).pointer());
     m_table_cache.set(key.hash(), ret);
     auto hash = ret->hash();
-    auto column_key = ColumnDef::make_key(ret);
+    auto column_key = ColumnDef::make_key(*ret);
 
     for (auto column_iterator = m_table_columns->find(column_key);
          !column_iterator.is_end() && ((*column_iterator)["table_hash"].to_u32().value() == hash);
          column_iterator++) {
         ret->append_column(*column_iterator);
     }
+
+    for (auto index_iterator = m_indexes->find(IndexDef::make_key(*ret));
+         !index_iterator.is_end() && ((*index_iterator)["table_hash"].to_u32().value() == hash);
+         index_iterator++) {
+        auto index_key = *index_iterator;
+        auto index = ret->add_index(index_key["index_name"].to_string().value(), index_key["unique"].to_int().value() != 0, index_key.pointer());
+        auto index_hash = index->hash();
+        for (auto column_iterator = m_table_columns->find(ColumnDef::make_key(*index));
+             !column_iterator.is_end() && ((*column_iterator)["table_hash"].to_u32().value() == index_hash);
+             column_iterator++) {
+            index->append_column((*column_iterator)["column_name"].to_string().value(), (SQLType)(*column_iterator)["column_type"].to_int().value());
+        }
+    }
     return ret;
 }
 
+bool Database::add_index(IndexDef& index)
+{
+    VERIFY(index.parent_relation());
+    auto table_or_empty = m_table_cache.get(index.parent_relation()->key().hash());
+    VERIFY(table_or_empty.has_value());
+    auto& table = table_or_empty.value();
+
+    // Existing rows have to be added to the new index as well. Sorting their keys first allows building
+    // the tree bottom-up, and finding rows that a unique index would have to reject.
+    auto descriptor = index.to_tuple_descriptor();
+    Vector<Key> keys;
+    for (auto& row : select_all(*table)) {
+        Key key(descriptor);
+        for (auto& part : descriptor)
+            key[part.name] = row[part.name];
+        key.set_pointer(row.pointer());
+        keys.append(move(key));
+    }
+    quick_sort(keys, [](auto& a, auto& b) { return a < b; });
+    if (index.unique()) {
+        for (size_t ix = 1; ix < keys.size(); ix++) {
+            if (keys[ix - 1] == keys[ix]) {
+                table->remove_index(index);
+                return false;
+            }
+        }
+    }
+
+    m_indexes->insert(index.key());
+    for (auto& part : index.key_definition()) {
+        m_table_columns->insert(part.key());
+    }
+    VERIFY(get_index_tree(index)->bulk_load(keys));
+    return true;
+}
+
+NonnullRefPtr<BTree> Database::get_index_tree(IndexDef& index)
+{
+    auto tree_or_empty = m_index_trees.get(index.hash());
+    if (tree_or_empty.has_value())
+        return *tree_or_empty.value();
+
+    auto tree = BTree::construct(*m_heap, index.to_tuple_descriptor(), index.unique(), index.pointer());
+    tree->on_new_root = [&, tree = tree.ptr(), index = NonnullRefPtr<IndexDef>(index)]() mutable {
+        index->set_pointer(tree->root());
+        VERIFY(m_indexes->update_key_pointer(index->key()));
+    };
+    m_index_trees.set(index.hash(), tree);
+    return tree;
+}
+
 Vector<Row> Database::select_all(TableDef const& table)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -117,6 +186,27 @@ Vector<Row> Database::select_all(TableDef const& table)
     return ret;
 }
 
+size_t Database::row_count(TableDef const& table)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    if (auto count = m_row_counts.get(table.hash()); count.has_value())
+        return count.value();
+
+    size_t count = 0;
+    for (auto pointer = table.pointer(); pointer; count++)
+        pointer = read_row(table, pointer).next_pointer();
+    m_row_counts.set(table.hash(), count);
+    return count;
+}
+
+Row Database::read_row(TableDef const& table, u32 pointer)
+{
+    auto buffer_or_error = m_heap->read_block(pointer);
+    if (buffer_or_error.is_error())
+        VERIFY_NOT_REACHED();
+    return Row(table, pointer, buffer_or_error.value());
+}
+
 Vector<Row> Database::match(TableDef const& table, Key const& key)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -139,16 +229,36 @@ Vector<Row> Database::match(TableDef const& table, Key const& key)
 bool Database::insert(Row& row)
 {
     VERIFY(m_table_cache.get(row.table()->key().hash()).has_value());
+
+    Vector<Key> index_keys;
+    for (auto& index : row.table()->indexes()) {
+        Key key(index.to_tuple_descriptor());
+        for (auto& part : index.key_definition())
+            key[part.name()] = row[part.name()];
+        if (index.unique()) {
+            auto iterator = get_index_tree(index)->find(key);
+            if (!iterator.is_end() && (*iterator == key))
+                return false;
+        }
+        index_keys.append(move(key));
+    }
+
     row.set_pointer(m_heap->new_record_pointer());
     row.next_pointer(row.table()->pointer());
     update(row);
 
-    // TODO update indexes defined on table.
+    auto indexes = row.table()->indexes();
+    for (size_t ix = 0; ix < indexes.size(); ix++) {
+        index_keys[ix].set_pointer(row.pointer());
+        VERIFY(get_index_tree(indexes[ix])->insert(index_keys[ix]));
+    }
 
     auto table_key = row.table()->key();
     table_key.set_pointer(row.pointer());
     VERIFY(m_tables->update_key_pointer(table_key));
     row.table()->set_pointer(row.pointer());
+    if (auto count = m_row_counts.find(row.table()->hash()); count != m_row_counts.end())
+        count->value++;
     return true;
 }
 
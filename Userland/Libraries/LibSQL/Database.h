@@ -36,19 +36,30 @@ public:
     static Key get_table_key(String const&, String const&);
     RefPtr<TableDef> get_table(String const&, String const&);
 
+    // Fails if the index is unique, but the table already has rows with the same key.
+    bool add_index(IndexDef&);
+    NonnullRefPtr<BTree> get_index_tree(IndexDef&);
+
     Vector<Row> select_all(TableDef const&);
     Vector<Row> match(TableDef const&, Key const&);
+    Row read_row(TableDef const&, u32 pointer);
     bool insert(Row&);
     bool update(Row&);
 
+    // The rows of a table are counted the first time this is called, and insert() keeps the count up to date.
+    size_t row_count(TableDef const&);
+
 private:
     RefPtr<Heap> m_heap;
     RefPtr<BTree> m_schemas;
     RefPtr<BTree> m_tables;
     RefPtr<BTree> m_table_columns;
+    RefPtr<BTree> m_indexes;
 
     HashMap<u32, RefPtr<SchemaDef>> m_schema_cache;
     HashMap<u32, RefPtr<TableDef>> m_table_cache;
+    HashMap<u32, NonnullRefPtr<BTree>> m_index_trees;
+    HashMap<u32, size_t> m_row_counts;
 };
 
 }
@@ -53,6 +53,7 @@ class ErrorExpression;
 class ErrorStatement;
 class ExistsExpression;
 class Expression;
+class FunctionCallExpression;
 class GroupByClause;
 class InChainedExpression;
 class InSelectionExpression;
@@ -5,31 +5,35 @@
  */
 
 #include <AK/Format.h>
+#include <AK/HashFunctions.h>
 #include <AK/QuickSort.h>
 #include <AK/String.h>
+#include <AK/StringHash.h>
 #include <LibCore/IODevice.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Serialize.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 namespace SQL {
 
-Heap::Heap(String file_name)
+// Each write-ahead log record consists of the block number and a checksum, followed by the
+// contents of the block. A commit record has no contents, and stores the number of block records
+// belonging to the transaction instead of a checksum.
+constexpr static u32 WAL_COMMIT_RECORD = 0xFFFFFFFF;
+constexpr static size_t WAL_RECORD_HEADER_SIZE = 2 * sizeof(u32);
+
+static u32 wal_checksum(u32 block, ReadonlyBytes contents)
+{
+    return pair_int_hash(block, string_hash(reinterpret_cast<char const*>(contents.data()), contents.size()));
+}
+
+Heap::Heap(String file_name, size_t buffer_pool_size)
 {
     set_name(move(file_name));
-    size_t file_size = 0;
-    struct stat stat_buffer;
-    if (stat(name().characters(), &stat_buffer) != 0) {
-        if (errno != ENOENT) {
-            perror("stat");
-            VERIFY_NOT_REACHED();
-        }
-    } else {
-        file_size = stat_buffer.st_size;
-    }
-    if (file_size > 0)
-        m_next_block = m_end_of_file = file_size / BLOCKSIZE;
+    VERIFY(buffer_pool_size > 0);
+    m_frames.resize(buffer_pool_size);
 
     auto file_or_error = Core::File::open(name(), Core::OpenMode::ReadWrite);
     if (file_or_error.is_error()) {
@@ -37,67 +41,209 @@ Heap::Heap(String file_name)
         VERIFY_NOT_REACHED();
     }
     m_file = file_or_error.value();
+
+    auto wal_file_name = String::formatted("{}.wal", name());
+    auto wal_file_or_error = Core::File::open(wal_file_name, Core::OpenMode::ReadWrite);
+    if (wal_file_or_error.is_error()) {
+        warnln("Couldn't open '{}': {}", wal_file_name, wal_file_or_error.error());
+        VERIFY_NOT_REACHED();
+    }
+    m_wal_file = wal_file_or_error.value();
+    recover_from_wal();
+
+    struct stat stat_buffer;
+    if (fstat(m_file->fd(), &stat_buffer) != 0) {
+        perror("fstat");
+        VERIFY_NOT_REACHED();
+    }
+    size_t file_size = stat_buffer.st_size;
+    if (file_size > 0)
+        m_next_block = m_end_of_file = file_size / BLOCKSIZE;
+
     if (file_size > 0)
         read_zero_block();
     else
         initialize_zero_block();
 }
 
-Result<ByteBuffer, String> Heap::read_block(u32 block)
+Heap::~Heap()
 {
-    auto buffer_or_empty = m_write_ahead_log.get(block);
-    if (buffer_or_empty.has_value())
-        return buffer_or_empty.value();
+    flush();
+    checkpoint();
+    if (unlink(m_wal_file->filename().characters()) < 0)
+        perror("unlink");
+}
 
-    VERIFY(block < m_next_block);
-    dbgln_if(SQL_DEBUG, "Read heap block {}", block);
-    if (!seek_block(block))
-        VERIFY_NOT_REACHED();
-    auto ret = m_file->read(BLOCKSIZE);
-    if (ret.is_empty())
-        return String("Could not read block");
+Result<ByteBuffer, String> Heap::read_block(u32 block)
+{
+    auto bytes_or_error = pin_block(block);
+    if (bytes_or_error.is_error())
+        return bytes_or_error.error();
+    auto ret = ByteBuffer::copy(bytes_or_error.value());
+    unpin_block(block);
     return ret;
 }
 
-bool Heap::write_block(u32 block, ByteBuffer& buffer)
+Result<Bytes, String> Heap::pin_block(u32 block)
+{
+    auto frame_index_or_error = frame_for_block(block, true);
+    if (frame_index_or_error.is_error())
+        return frame_index_or_error.error();
+    auto& frame = m_frames[frame_index_or_error.value()];
+    frame.pin_count++;
+    return frame.buffer.bytes();
+}
+
+void Heap::unpin_block(u32 block, bool is_dirty)
+{
+    auto frame_index = m_frame_for_block.get(block);
+    VERIFY(frame_index.has_value());
+    auto& frame = m_frames[frame_index.value()];
+    VERIFY(frame.pin_count > 0);
+    frame.pin_count--;
+    if (is_dirty)
+        frame.is_dirty = true;
+}
+
+void Heap::add_to_wal(u32 block, ByteBuffer& buffer)
 {
     VERIFY(block < m_next_block);
-    if (!seek_block(block))
-        VERIFY_NOT_REACHED();
-    dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
     VERIFY(buffer.size() <= BLOCKSIZE);
-    auto sz = buffer.size();
-    if (sz < BLOCKSIZE) {
-        buffer.resize(BLOCKSIZE);
-        memset(buffer.offset_pointer((int)sz), 0, BLOCKSIZE - sz);
+    auto frame_index_or_error = frame_for_block(block, false);
+    if (frame_index_or_error.is_error()) {
+        warnln("Could not write block {} of {}: {}", block, name(), frame_index_or_error.error());
+        VERIFY_NOT_REACHED();
     }
-    if (m_file->write(buffer.data(), (int)buffer.size())) {
-        if (block == m_end_of_file)
-            m_end_of_file++;
-        return true;
+    auto& frame = m_frames[frame_index_or_error.value()];
+    frame.buffer.overwrite(0, buffer.data(), buffer.size());
+    memset(frame.buffer.offset_pointer(buffer.size()), 0, BLOCKSIZE - buffer.size());
+    frame.is_dirty = true;
+}
+
+Result<size_t, String> Heap::frame_for_block(u32 block, bool load_contents)
+{
+    auto existing_frame_index = m_frame_for_block.get(block);
+    if (existing_frame_index.has_value()) {
+        m_frames[existing_frame_index.value()].is_referenced = true;
+        return existing_frame_index.value();
     }
-    return false;
+
+    auto frame_index_or_error = evict_frame();
+    if (frame_index_or_error.is_error())
+        return frame_index_or_error.error();
+    auto frame_index = frame_index_or_error.value();
+    auto& frame = m_frames[frame_index];
+    if (frame.buffer.is_empty())
+        frame.buffer = ByteBuffer::create_zeroed(BLOCKSIZE);
+
+    if (load_contents) {
+        if (!read_block_from_disk(block, frame.buffer))
+            return String("Could not read block");
+    }
+
+    frame.block = block;
+    frame.pin_count = 0;
+    frame.is_valid = true;
+    frame.is_dirty = false;
+    frame.is_referenced = true;
+    m_frame_for_block.set(block, frame_index);
+    return frame_index;
 }
 
-bool Heap::seek_block(u32 block)
+Result<size_t, String> Heap::evict_frame()
 {
-    if (block == m_end_of_file) {
-        off_t pos;
-        if (!m_file->seek(0, Core::SeekMode::FromEndPosition, &pos)) {
-            warnln("Could not seek block {} from file {}, which is at the end of the file", block, name());
-            warnln("FD: {} Position: {} error: {}", m_file->fd(), pos, m_file->error_string());
-            return false;
+    // Every unpinned frame gets a second chance: its referenced bit is cleared the first time the clock hand passes it.
+    for (size_t i = 0; i < 2 * m_frames.size(); ++i) {
+        auto frame_index = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % m_frames.size();
+
+        auto& frame = m_frames[frame_index];
+        if (!frame.is_valid)
+            return frame_index;
+        if (frame.pin_count > 0)
+            continue;
+        if (frame.is_referenced) {
+            frame.is_referenced = false;
+            continue;
         }
-    } else if (block > m_end_of_file) {
-        warnln("Seeking block {} of file {} which is beyond the end of the file", block, name());
-        return false;
+
+        if (frame.is_dirty && !append_to_wal(frame.block, frame.buffer))
+            return String("Could not write block to write-ahead log");
+        dbgln_if(SQL_DEBUG, "Evicting heap block {} from buffer pool", frame.block);
+        m_frame_for_block.remove(frame.block);
+        frame.is_valid = false;
+        frame.is_dirty = false;
+        return frame_index;
+    }
+    return String("All buffer pool frames are pinned");
+}
+
+bool Heap::read_block_from_disk(u32 block, ByteBuffer& buffer)
+{
+    VERIFY(buffer.size() == BLOCKSIZE);
+    ByteBuffer contents;
+    auto wal_offset = m_wal_index.get(block);
+    if (wal_offset.has_value()) {
+        dbgln_if(SQL_DEBUG, "Read heap block {} from write-ahead log", block);
+        if (!m_wal_file->seek(wal_offset.value() + WAL_RECORD_HEADER_SIZE))
+            return false;
+        contents = m_wal_file->read(BLOCKSIZE);
     } else {
-        if (!m_file->seek(block * BLOCKSIZE)) {
-            warnln("Could not seek block {} of file {}. The current size is {} blocks",
-                block, name(), m_end_of_file);
+        VERIFY(block < m_next_block);
+        dbgln_if(SQL_DEBUG, "Read heap block {}", block);
+        if (!m_file->seek(static_cast<i64>(block) * BLOCKSIZE))
             return false;
-        }
+        contents = m_file->read(BLOCKSIZE);
     }
+    if (contents.size() != BLOCKSIZE)
+        return false;
+    buffer.overwrite(0, contents.data(), BLOCKSIZE);
+    return true;
+}
+
+bool Heap::write_block(u32 block, ReadonlyBytes buffer)
+{
+    VERIFY(buffer.size() == BLOCKSIZE);
+    dbgln_if(SQL_DEBUG, "Write heap block {}", block);
+    if (!m_file->seek(static_cast<i64>(block) * BLOCKSIZE)) {
+        warnln("Could not seek block {} of file {}: {}", block, name(), m_file->error_string());
+        return false;
+    }
+    return m_file->write(buffer.data(), BLOCKSIZE);
+}
+
+bool Heap::append_to_wal(u32 block, ReadonlyBytes contents)
+{
+    VERIFY(contents.size() == BLOCKSIZE);
+    u32 header[2] = { block, wal_checksum(block, contents) };
+    auto record = ByteBuffer::create_uninitialized(WAL_RECORD_HEADER_SIZE + BLOCKSIZE);
+    record.overwrite(0, header, WAL_RECORD_HEADER_SIZE);
+    record.overwrite(WAL_RECORD_HEADER_SIZE, contents.data(), BLOCKSIZE);
+
+    if (!m_wal_file->seek(m_wal_size) || !m_wal_file->write(record.data(), record.size())) {
+        warnln("Could not append block {} to {}: {}", block, m_wal_file->filename(), m_wal_file->error_string());
+        return false;
+    }
+    dbgln_if(SQL_DEBUG, "Appended heap block {} to write-ahead log at offset {}", block, m_wal_size);
+    m_wal_index.set(block, m_wal_size);
+    m_wal_size += record.size();
+    m_uncommitted_wal_records++;
+    return true;
+}
+
+bool Heap::append_commit_record()
+{
+    u32 header[2] = { WAL_COMMIT_RECORD, m_uncommitted_wal_records };
+    if (!m_wal_file->seek(m_wal_size) || !m_wal_file->write(reinterpret_cast<u8 const*>(header), WAL_RECORD_HEADER_SIZE)) {
+        warnln("Could not append commit record to {}: {}", m_wal_file->filename(), m_wal_file->error_string());
+        return false;
+    }
+    if (fsync(m_wal_file->fd()) < 0) {
+        perror("fsync");
+        return false;
+    }
+    m_wal_size += WAL_RECORD_HEADER_SIZE;
+    m_uncommitted_wal_records = 0;
     return true;
 }
 
@@ -120,20 +266,101 @@ u32 Heap::new_record_pointer()
 
 void Heap::flush()
 {
+    Vector<size_t> dirty_frames;
+    for (size_t frame_index = 0; frame_index < m_frames.size(); ++frame_index) {
+        if (m_frames[frame_index].is_valid && m_frames[frame_index].is_dirty)
+            dirty_frames.append(frame_index);
+    }
+    if (dirty_frames.is_empty() && m_uncommitted_wal_records == 0)
+        return;
+
+    quick_sort(dirty_frames, [&](auto a, auto b) { return m_frames[a].block < m_frames[b].block; });
+    for (auto frame_index : dirty_frames) {
+        auto& frame = m_frames[frame_index];
+        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", frame.block, name());
+        if (!append_to_wal(frame.block, frame.buffer))
+            VERIFY_NOT_REACHED();
+        frame.is_dirty = false;
+    }
+    if (!append_commit_record())
+        VERIFY_NOT_REACHED();
+
+    for (auto& wal_entry : m_wal_index) {
+        if (wal_entry.key >= m_end_of_file)
+            m_end_of_file = wal_entry.key + 1;
+    }
+    if (m_wal_index.size() >= WAL_CHECKPOINT_THRESHOLD)
+        checkpoint();
+}
+
+void Heap::checkpoint()
+{
+    VERIFY(m_uncommitted_wal_records == 0);
+    if (m_wal_size == 0)
+        return;
+
     Vector<u32> blocks;
-    for (auto& wal_entry : m_write_ahead_log) {
+    for (auto& wal_entry : m_wal_index)
         blocks.append(wal_entry.key);
-    }
     quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_or_empty = m_write_ahead_log.get(block);
-        if (buffer_or_empty->is_empty()) {
+
+    dbgln_if(SQL_DEBUG, "Checkpointing {} blocks from write-ahead log to {}", blocks.size(), name());
+    auto buffer = ByteBuffer::create_uninitialized(BLOCKSIZE);
+    for (auto block : blocks) {
+        if (!read_block_from_disk(block, buffer) || !write_block(block, buffer))
             VERIFY_NOT_REACHED();
+    }
+    if (fsync(m_file->fd()) < 0) {
+        perror("fsync");
+        VERIFY_NOT_REACHED();
+    }
+
+    // Only now that the heap file is durable can the log be discarded. Replaying it again after a crash before this point is harmless.
+    m_wal_index.clear();
+    if (!m_wal_file->truncate(0)) {
+        warnln("Could not truncate {}: {}", m_wal_file->filename(), m_wal_file->error_string());
+        VERIFY_NOT_REACHED();
+    }
+    m_wal_size = 0;
+}
+
+void Heap::recover_from_wal()
+{
+    auto log = m_wal_file->read_all();
+    if (log.is_empty())
+        return;
+
+    // Block records are only applied once the commit record of their transaction has been found.
+    // Anything after the last intact commit record was either never committed or torn by a crash.
+    HashMap<u32, off_t> uncommitted_records;
+    u32 uncommitted_record_count = 0;
+    size_t offset = 0;
+    while (offset + WAL_RECORD_HEADER_SIZE <= log.size()) {
+        u32 header[2];
+        memcpy(header, log.offset_pointer(offset), WAL_RECORD_HEADER_SIZE);
+        if (header[0] == WAL_COMMIT_RECORD) {
+            if (header[1] != uncommitted_record_count)
+                break;
+            for (auto& record : uncommitted_records)
+                m_wal_index.set(record.key, record.value);
+            uncommitted_records.clear();
+            uncommitted_record_count = 0;
+            offset += WAL_RECORD_HEADER_SIZE;
+            continue;
         }
-        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
-        write_block(block, buffer_or_empty.value());
+
+        if (offset + WAL_RECORD_HEADER_SIZE + BLOCKSIZE > log.size())
+            break;
+        if (wal_checksum(header[0], log.bytes().slice(offset + WAL_RECORD_HEADER_SIZE, BLOCKSIZE)) != header[1])
+            break;
+        uncommitted_records.set(header[0], offset);
+        uncommitted_record_count++;
+        offset += WAL_RECORD_HEADER_SIZE + BLOCKSIZE;
     }
-    m_write_ahead_log.clear();
+
+    dbgln_if(SQL_DEBUG, "Recovering {} blocks from write-ahead log of {}", m_wal_index.size(), name());
+    m_wal_size = log.size();
+    checkpoint();
 }
 
 constexpr static const char* FILE_ID = "SerenitySQL ";
@@ -143,6 +370,7 @@ constexpr static int TABLES_ROOT_OFFSET = 20;
 constexpr static int TABLE_COLUMNS_ROOT_OFFSET = 24;
 constexpr static int FREE_LIST_OFFSET = 28;
 constexpr static int USER_VALUES_OFFSET = 32;
+constexpr static int INDEXES_ROOT_OFFSET = 96;
 
 void Heap::read_zero_block()
 {
@@ -160,6 +388,12 @@ void Heap::read_zero_block()
     dbgln_if(SQL_DEBUG, "Read zero block from {}", name());
     memcpy(&m_version, buffer.offset_pointer(VERSION_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Version: {}.{}", (m_version & 0xFFFF0000) >> 16, (m_version & 0x0000FFFF));
+    if (m_version != HEAP_VERSION) {
+        warnln("{} has version {}.{}, but only version {}.{} is supported", name(),
+            (m_version & 0xFFFF0000) >> 16, (m_version & 0x0000FFFF),
+            (HEAP_VERSION & 0xFFFF0000) >> 16, (HEAP_VERSION & 0x0000FFFF));
+        VERIFY_NOT_REACHED();
+    }
     memcpy(&m_schemas_root, buffer.offset_pointer(SCHEMAS_ROOT_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_tables_root);
     memcpy(&m_tables_root, buffer.offset_pointer(TABLES_ROOT_OFFSET), sizeof(u32));
@@ -169,6 +403,8 @@ void Heap::read_zero_block()
     memcpy(&m_free_list, buffer.offset_pointer(FREE_LIST_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Free list: {}", m_free_list);
     memcpy(m_user_values.data(), buffer.offset_pointer(USER_VALUES_OFFSET), m_user_values.size() * sizeof(u32));
+    memcpy(&m_indexes_root, buffer.offset_pointer(INDEXES_ROOT_OFFSET), sizeof(u32));
+    dbgln_if(SQL_DEBUG, "Indexes root node: {}", m_indexes_root);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix]) {
             dbgln_if(SQL_DEBUG, "User value {}: {}", ix, m_user_values[ix]);
@@ -183,6 +419,7 @@ void Heap::update_zero_block()
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_schemas_root);
     dbgln_if(SQL_DEBUG, "Tables root node: {}", m_tables_root);
     dbgln_if(SQL_DEBUG, "Table Columns root node: {}", m_table_columns_root);
+    dbgln_if(SQL_DEBUG, "Indexes root node: {}", m_indexes_root);
     dbgln_if(SQL_DEBUG, "Free list: {}", m_free_list);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix]) {
@@ -198,16 +435,18 @@ void Heap::update_zero_block()
     buffer.overwrite(TABLE_COLUMNS_ROOT_OFFSET, &m_table_columns_root, sizeof(u32));
     buffer.overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
     buffer.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
+    buffer.overwrite(INDEXES_ROOT_OFFSET, &m_indexes_root, sizeof(u32));
 
     add_to_wal(0, buffer);
 }
 
 void Heap::initialize_zero_block()
 {
-    m_version = 0x00000001;
+    m_version = HEAP_VERSION;
     m_schemas_root = 0;
     m_tables_root = 0;
     m_table_columns_root = 0;
+    m_indexes_root = 0;
     m_next_block = 1;
     m_free_list = 0;
     for (auto& user : m_user_values) {
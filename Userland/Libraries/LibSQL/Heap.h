@@ -18,6 +18,11 @@
 namespace SQL {
 
 constexpr static u32 BLOCKSIZE = 1024;
+constexpr static size_t BUFFER_POOL_SIZE = 256;
+constexpr static size_t WAL_CHECKPOINT_THRESHOLD = 1024;
+// The major version is in the upper 16 bits. This has to change whenever the layout of any block on disk does,
+// because files with another version are refused.
+constexpr static u32 HEAP_VERSION = 0x00000002;
 
 /**
  * A Heap is a logical container for database (SQL) data. Conceptually a
@@ -29,17 +34,32 @@ constexpr static u32 BLOCKSIZE = 1024;
  * assumed that a single SQL database is backed by a single Heap.
  *
  * Currently only B-Trees and tuple stores are implemented.
+ *
+ * Blocks are cached in a fixed-size buffer pool. Frames are recycled using
+ * the clock algorithm; pinned frames are never evicted. Modified blocks are
+ * appended to a write-ahead log (the heap's file name with a ".wal" suffix)
+ * when they are evicted or when the heap is flushed. A flush appends a commit
+ * record and fsyncs the log once, and the logged blocks are only copied back
+ * into the heap file (checkpointed) once enough of them have accumulated, or
+ * when the heap is closed. Committed transactions found in the log when a
+ * heap is opened are replayed, so data survives a crash once flush() has
+ * returned.
  */
 class Heap : public Core::Object {
     C_OBJECT(Heap);
 
 public:
-    explicit Heap(String);
-    virtual ~Heap() override { flush(); }
+    explicit Heap(String, size_t buffer_pool_size = BUFFER_POOL_SIZE);
+    virtual ~Heap() override;
 
     u32 size() const { return m_end_of_file; }
     Result<ByteBuffer, String> read_block(u32);
-    bool write_block(u32, ByteBuffer&);
+
+    // Returns the contents of the block in the buffer pool. The bytes stay valid
+    // until the block is unpinned again. A block can be pinned more than once.
+    Result<Bytes, String> pin_block(u32);
+    void unpin_block(u32, bool is_dirty = false);
+
     u32 new_record_pointer();
     [[nodiscard]] bool has_block(u32 block) const { return block < size(); }
 
@@ -66,6 +86,14 @@ public:
         m_table_columns_root = root;
         update_zero_block();
     }
+
+    u32 indexes_root() const { return m_indexes_root; }
+
+    void set_indexes_root(u32 root)
+    {
+        m_indexes_root = root;
+        update_zero_block();
+    }
     u32 version() const { return m_version; }
 
     u32 user_value(size_t index) const
@@ -81,25 +109,50 @@ public:
         update_zero_block();
     }
 
-    void add_to_wal(u32 block, ByteBuffer& buffer) { m_write_ahead_log.set(block, buffer); }
+    void add_to_wal(u32 block, ByteBuffer& buffer);
     void flush();
+    void checkpoint();
 
 private:
-    bool seek_block(u32);
+    struct Frame {
+        u32 block { 0 };
+        ByteBuffer buffer;
+        u32 pin_count { 0 };
+        bool is_valid { false };
+        bool is_dirty { false };
+        bool is_referenced { false };
+    };
+
+    Result<size_t, String> frame_for_block(u32, bool load_contents);
+    Result<size_t, String> evict_frame();
+    bool read_block_from_disk(u32, ByteBuffer&);
+    bool write_block(u32, ReadonlyBytes);
+    bool append_to_wal(u32 block, ReadonlyBytes);
+    bool append_commit_record();
+    void recover_from_wal();
     void read_zero_block();
     void initialize_zero_block();
     void update_zero_block();
 
     RefPtr<Core::File> m_file;
+    RefPtr<Core::File> m_wal_file;
     u32 m_free_list { 0 };
     u32 m_next_block { 1 };
     u32 m_end_of_file { 1 };
     u32 m_schemas_root { 0 };
     u32 m_tables_root { 0 };
     u32 m_table_columns_root { 0 };
-    u32 m_version { 0x00000001 };
+    u32 m_indexes_root { 0 };
+    u32 m_version { HEAP_VERSION };
     Array<u32, 16> m_user_values;
-    HashMap<u32, ByteBuffer> m_write_ahead_log;
+
+    Vector<Frame> m_frames;
+    HashMap<u32, size_t> m_frame_for_block;
+    size_t m_clock_hand { 0 };
+
+    HashMap<u32, off_t> m_wal_index; // Offsets of the most recent logged version of each block not checkpointed yet.
+    off_t m_wal_size { 0 };
+    u32 m_uncommitted_wal_records { 0 };
 };
 
 }
@@ -59,10 +59,10 @@ Key ColumnDef::key() const
     return key;
 }
 
-Key ColumnDef::make_key(TableDef const& table_def)
+Key ColumnDef::make_key(Relation const& relation)
 {
     Key key(index_def());
-    key["table_hash"] = table_def.key().hash();
+    key["table_hash"] = relation.key().hash();
     return key;
 }
 
@@ -117,6 +117,7 @@ Key IndexDef::key() const
     key["table_hash"] = parent_relation()->key().hash();
     key["index_name"] = name();
     key["unique"] = unique() ? 1 : 0;
+    key.set_pointer(pointer());
     return key;
 }
 
@@ -176,6 +177,18 @@ void TableDef::append_column(Key const& column)
         (SQLType)((int)column["column_type"]));
 }
 
+NonnullRefPtr<IndexDef> TableDef::add_index(String name, bool unique, u32 pointer)
+{
+    auto index = IndexDef::construct(this, move(name), unique, pointer);
+    m_indexes.append(index);
+    return index;
+}
+
+void TableDef::remove_index(IndexDef const& index)
+{
+    m_indexes.remove_first_matching([&](auto& entry) { return entry.ptr() == &index; });
+}
+
 Key TableDef::make_key(SchemaDef const& schema_def)
 {
     return TableDef::make_key(schema_def.key());
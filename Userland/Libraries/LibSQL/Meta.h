@@ -76,7 +76,7 @@ public:
     SQLType type() const { return m_type; }
     size_t column_number() const { return m_index; }
     static NonnullRefPtr<IndexDef> index_def();
-    static Key make_key(TableDef const&);
+    static Key make_key(Relation const&);
 
 protected:
     ColumnDef(Relation*, size_t, String, SQLType);
@@ -129,6 +129,8 @@ public:
     Key key() const override;
     void append_column(String, SQLType);
     void append_column(Key const&);
+    NonnullRefPtr<IndexDef> add_index(String, bool unique = false, u32 pointer = 0);
+    void remove_index(IndexDef const&);
     size_t num_columns() { return m_columns.size(); }
     size_t num_indexes() { return m_indexes.size(); }
     NonnullRefPtrVector<ColumnDef> columns() const { return m_columns; }
@@ -0,0 +1,647 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BitCast.h>
+#include <AK/HashFunctions.h>
+#include <AK/QuickSort.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Operator.h>
+#include <LibSQL/Row.h>
+#include <stdlib.h>
+
+namespace SQL {
+
+bool is_true(Value const& value)
+{
+    auto number = numeric_value(value);
+    return number.has_value() && number.value() != 0;
+}
+
+Optional<double> numeric_value(Value const& value)
+{
+    if (value.is_null())
+        return {};
+    if (value.type() != SQLType::Text)
+        return value.to_double();
+
+    auto string = value.to_string().value();
+    if (string.is_empty())
+        return {};
+    char* end_ptr;
+    auto number = strtod(string.characters(), &end_ptr);
+    if (end_ptr != string.characters() + string.length())
+        return {};
+    return number;
+}
+
+int compare_values(Value const& a, Value const& b)
+{
+    if (a.is_null() || b.is_null())
+        return (a.is_null() ? 0 : 1) - (b.is_null() ? 0 : 1);
+
+    if (a.type() == SQLType::Integer && b.type() == SQLType::Integer) {
+        auto a_int = a.to_int().value();
+        auto b_int = b.to_int().value();
+        return (a_int > b_int) - (a_int < b_int);
+    }
+
+    if (a.type() != SQLType::Text || b.type() != SQLType::Text) {
+        auto a_number = numeric_value(a);
+        auto b_number = numeric_value(b);
+        if (a_number.has_value() && b_number.has_value())
+            return (a_number.value() > b_number.value()) - (a_number.value() < b_number.value());
+        // A number always sorts before text which isn't one.
+        if (a_number.has_value() != b_number.has_value())
+            return a_number.has_value() ? -1 : 1;
+    }
+
+    auto a_string = a.to_string().value();
+    auto b_string = b.to_string().value();
+    if (a_string == b_string)
+        return 0;
+    return (a_string < b_string) ? -1 : 1;
+}
+
+bool values_are_equal(Tuple const& a, Tuple const& b)
+{
+    if (a.length() != b.length())
+        return false;
+    for (size_t ix = 0; ix < a.length(); ix++) {
+        if (compare_values(a[ix], b[ix]) != 0)
+            return false;
+    }
+    return true;
+}
+
+u32 hash_values(Tuple const& tuple)
+{
+    u32 hash = 0;
+    for (size_t ix = 0; ix < tuple.length(); ix++) {
+        auto const& value = tuple[ix];
+        u32 value_hash = 0;
+        if (value.is_null())
+            value_hash = 0;
+        else if (value.type() == SQLType::Text)
+            value_hash = value.hash();
+        else
+            value_hash = u64_hash(bit_cast<u64>(value.to_double().value() + 0.0)); // + 0.0 turns -0.0 into 0.0.
+        hash = ix ? pair_int_hash(hash, value_hash) : value_hash;
+    }
+    return hash;
+}
+
+Tuple concatenate(Tuple const& a, Tuple const& b)
+{
+    Tuple ret;
+    for (size_t ix = 0; ix < a.length(); ix++)
+        ret.append(a[ix]);
+    for (size_t ix = 0; ix < b.length(); ix++)
+        ret.append(b[ix]);
+    return ret;
+}
+
+String Operator::to_string() const
+{
+    StringBuilder builder;
+    dump(builder, 0);
+    return builder.build();
+}
+
+void Operator::dump(StringBuilder& builder, int indent) const
+{
+    for (auto ix = 0; ix < indent; ix++)
+        builder.append("  ");
+    builder.append(description());
+    builder.append('\n');
+    for (auto* input : inputs())
+        input->dump(builder, indent + 1);
+}
+
+TableScan::TableScan(Database& database, NonnullRefPtr<TableDef> table)
+    : m_database(database)
+    , m_table(move(table))
+{
+}
+
+void TableScan::open()
+{
+    m_next_pointer = m_table->pointer();
+}
+
+bool TableScan::next(Tuple& tuple)
+{
+    if (!m_next_pointer)
+        return false;
+
+    auto row = m_database.read_row(*m_table, m_next_pointer);
+    m_next_pointer = row.next_pointer();
+
+    Tuple result;
+    for (size_t ix = 0; ix < row.length(); ix++)
+        result.append(row[ix]);
+    tuple = move(result);
+    return true;
+}
+
+String TableScan::description() const
+{
+    return String::formatted("TableScan {}", m_table->name());
+}
+
+IndexScan::IndexScan(Database& database, NonnullRefPtr<TableDef> table, NonnullRefPtr<IndexDef> index, Optional<Bound> lower_bound, Optional<Bound> upper_bound)
+    : m_database(database)
+    , m_table(move(table))
+    , m_index(move(index))
+    , m_tree(database.get_index_tree(*m_index))
+    , m_lower_bound(move(lower_bound))
+    , m_upper_bound(move(upper_bound))
+{
+    VERIFY(m_index->size() == 1);
+}
+
+void IndexScan::open()
+{
+    if (!m_lower_bound.has_value()) {
+        m_iterator = m_tree->begin();
+        return;
+    }
+
+    Key key(m_index->to_tuple_descriptor());
+    key[0] = m_lower_bound->value;
+    m_iterator = m_tree->lower_bound(key);
+}
+
+bool IndexScan::next(Tuple& tuple)
+{
+    while (m_iterator.has_value() && !m_iterator->is_end()) {
+        Key key = **m_iterator;
+        ++(*m_iterator);
+
+        if (m_lower_bound.has_value() && !m_lower_bound->inclusive && compare_values(key[0], m_lower_bound->value) == 0)
+            continue;
+
+        if (m_upper_bound.has_value()) {
+            auto comparison = compare_values(key[0], m_upper_bound->value);
+            if (comparison > 0 || (comparison == 0 && !m_upper_bound->inclusive)) {
+                m_iterator.clear();
+                return false;
+            }
+        }
+
+        auto row = m_database.read_row(*m_table, key.pointer());
+        Tuple result;
+        for (size_t ix = 0; ix < row.length(); ix++)
+            result.append(row[ix]);
+        tuple = move(result);
+        return true;
+    }
+    return false;
+}
+
+String IndexScan::description() const
+{
+    StringBuilder builder;
+    builder.appendff("IndexScan {} using {}", m_table->name(), m_index->name());
+    if (m_lower_bound.has_value())
+        builder.appendff(" {} {}", m_lower_bound->inclusive ? ">=" : ">", m_lower_bound->value.to_string().value());
+    if (m_upper_bound.has_value())
+        builder.appendff(" {} {}", m_upper_bound->inclusive ? "<=" : "<", m_upper_bound->value.to_string().value());
+    return builder.build();
+}
+
+Filter::Filter(NonnullOwnPtr<Operator> input, Evaluator predicate)
+    : m_input(move(input))
+    , m_predicate(move(predicate))
+{
+}
+
+bool Filter::next(Tuple& tuple)
+{
+    while (m_input->next(tuple)) {
+        if (is_true(m_predicate(tuple)))
+            return true;
+    }
+    return false;
+}
+
+Projection::Projection(NonnullOwnPtr<Operator> input, Vector<Evaluator> columns)
+    : m_input(move(input))
+    , m_columns(move(columns))
+{
+}
+
+bool Projection::next(Tuple& tuple)
+{
+    if (!m_input->next(m_input_row))
+        return false;
+
+    Tuple result;
+    for (auto& column : m_columns)
+        result.append(column(m_input_row));
+    tuple = move(result);
+    return true;
+}
+
+NestedLoopJoin::NestedLoopJoin(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right, Optional<Evaluator> predicate)
+    : m_left(move(left))
+    , m_right(move(right))
+    , m_predicate(move(predicate))
+{
+}
+
+void NestedLoopJoin::open()
+{
+    m_right_rows.clear();
+    m_right->open();
+    Tuple row;
+    while (m_right->next(row))
+        m_right_rows.append(move(row));
+
+    m_left->open();
+    m_has_left_row = false;
+    m_right_index = 0;
+}
+
+bool NestedLoopJoin::next(Tuple& tuple)
+{
+    if (m_right_rows.is_empty())
+        return false;
+
+    for (;;) {
+        if (!m_has_left_row || m_right_index == m_right_rows.size()) {
+            if (!m_left->next(m_left_row))
+                return false;
+            m_has_left_row = true;
+            m_right_index = 0;
+        }
+
+        auto joined = concatenate(m_left_row, m_right_rows[m_right_index++]);
+        if (!m_predicate.has_value() || is_true(m_predicate.value()(joined))) {
+            tuple = move(joined);
+            return true;
+        }
+    }
+}
+
+HashJoin::HashJoin(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right, Vector<Evaluator> left_keys, Vector<Evaluator> right_keys)
+    : m_left(move(left))
+    , m_right(move(right))
+    , m_left_keys(move(left_keys))
+    , m_right_keys(move(right_keys))
+{
+    VERIFY(!m_left_keys.is_empty());
+    VERIFY(m_left_keys.size() == m_right_keys.size());
+}
+
+Optional<Tuple> HashJoin::evaluate_keys(Vector<Evaluator> const& evaluators, Tuple const& row)
+{
+    Tuple keys;
+    for (auto& evaluator : evaluators) {
+        auto value = evaluator(row);
+        if (value.is_null())
+            return {};
+        keys.append(value);
+    }
+    return keys;
+}
+
+void HashJoin::open()
+{
+    m_buckets.clear();
+    m_right_rows.clear();
+    m_right_row_keys.clear();
+
+    m_right->open();
+    Tuple row;
+    while (m_right->next(row)) {
+        auto keys = evaluate_keys(m_right_keys, row);
+        if (!keys.has_value())
+            continue;
+        auto hash = hash_values(keys.value());
+        m_buckets.ensure(hash).append(m_right_rows.size());
+        m_right_rows.append(move(row));
+        m_right_row_keys.append(keys.release_value());
+    }
+
+    m_left->open();
+    m_matches = nullptr;
+    m_match_index = 0;
+}
+
+bool HashJoin::next(Tuple& tuple)
+{
+    if (m_right_rows.is_empty())
+        return false;
+
+    for (;;) {
+        while (m_matches && m_match_index < m_matches->size()) {
+            auto right_index = m_matches->at(m_match_index++);
+            if (values_are_equal(m_left_row_key, m_right_row_keys[right_index])) {
+                tuple = concatenate(m_left_row, m_right_rows[right_index]);
+                return true;
+            }
+        }
+
+        m_matches = nullptr;
+        if (!m_left->next(m_left_row))
+            return false;
+
+        auto keys = evaluate_keys(m_left_keys, m_left_row);
+        if (!keys.has_value())
+            continue;
+
+        if (auto bucket = m_buckets.find(hash_values(keys.value())); bucket != m_buckets.end()) {
+            m_left_row_key = keys.release_value();
+            m_matches = &bucket->value;
+            m_match_index = 0;
+        }
+    }
+}
+
+Sort::Sort(NonnullOwnPtr<Operator> input, Vector<SortKey> keys)
+    : m_input(move(input))
+    , m_keys(move(keys))
+{
+}
+
+void Sort::open()
+{
+    m_rows.clear();
+    m_row_keys.clear();
+    m_order.clear();
+    m_index = 0;
+
+    m_input->open();
+    Tuple row;
+    while (m_input->next(row)) {
+        Tuple keys;
+        for (auto& key : m_keys)
+            keys.append(key.evaluator(row));
+        m_order.append(m_rows.size());
+        m_rows.append(move(row));
+        m_row_keys.append(move(keys));
+    }
+
+    // Ties are broken by input order, which keeps the sort stable.
+    quick_sort(m_order, [&](size_t a, size_t b) {
+        for (size_t ix = 0; ix < m_keys.size(); ix++) {
+            auto const& a_value = m_row_keys[a][ix];
+            auto const& b_value = m_row_keys[b][ix];
+            if (a_value.is_null() != b_value.is_null())
+                return a_value.is_null() == (m_keys[ix].nulls == AST::Nulls::First);
+
+            auto comparison = compare_values(a_value, b_value);
+            if (comparison != 0)
+                return (m_keys[ix].order == AST::Order::Ascending) ? (comparison < 0) : (comparison > 0);
+        }
+        return a < b;
+    });
+}
+
+bool Sort::next(Tuple& tuple)
+{
+    if (m_index >= m_order.size())
+        return false;
+    tuple = m_rows[m_order[m_index++]];
+    return true;
+}
+
+Aggregate::Aggregate(NonnullOwnPtr<Operator> input, Vector<Evaluator> group_keys, Vector<AggregateColumn> aggregates)
+    : m_input(move(input))
+    , m_group_keys(move(group_keys))
+    , m_aggregates(move(aggregates))
+{
+}
+
+Optional<AggregateFunction> Aggregate::function_for_name(StringView name)
+{
+    if (name.equals_ignoring_case("COUNT"))
+        return AggregateFunction::Count;
+    if (name.equals_ignoring_case("SUM"))
+        return AggregateFunction::Sum;
+    if (name.equals_ignoring_case("AVG"))
+        return AggregateFunction::Average;
+    if (name.equals_ignoring_case("MIN"))
+        return AggregateFunction::Minimum;
+    if (name.equals_ignoring_case("MAX"))
+        return AggregateFunction::Maximum;
+    return {};
+}
+
+void Aggregate::accumulate(Accumulator& accumulator, AggregateColumn const& aggregate, Tuple const& row)
+{
+    if (!aggregate.argument.has_value()) {
+        accumulator.count++;
+        return;
+    }
+
+    auto value = aggregate.argument.value()(row);
+    if (value.is_null())
+        return;
+
+    if (aggregate.distinct) {
+        Tuple distinct_value;
+        distinct_value.append(value);
+        auto& seen = accumulator.seen_values.ensure(hash_values(distinct_value));
+        for (auto& seen_value : seen) {
+            if (values_are_equal(seen_value, distinct_value))
+                return;
+        }
+        seen.append(move(distinct_value));
+    }
+
+    accumulator.count++;
+    switch (aggregate.function) {
+    case AggregateFunction::Count:
+        break;
+    case AggregateFunction::Sum:
+    case AggregateFunction::Average:
+        if (value.type() == SQLType::Integer) {
+            accumulator.integer_sum += value.to_int().value();
+        } else {
+            accumulator.is_integer = false;
+            accumulator.float_sum += numeric_value(value).value_or(0);
+        }
+        break;
+    case AggregateFunction::Minimum:
+        if (accumulator.count == 1 || compare_values(value, accumulator.value.value()) < 0)
+            accumulator.value = value;
+        break;
+    case AggregateFunction::Maximum:
+        if (accumulator.count == 1 || compare_values(value, accumulator.value.value()) > 0)
+            accumulator.value = value;
+        break;
+    }
+}
+
+Value Aggregate::result(Accumulator const& accumulator, AggregateColumn const& aggregate) const
+{
+    switch (aggregate.function) {
+    case AggregateFunction::Count: {
+        Value count(SQLType::Integer);
+        count = static_cast<int>(accumulator.count);
+        return count;
+    }
+    case AggregateFunction::Sum:
+    case AggregateFunction::Average: {
+        if (!accumulator.count)
+            return Value::null();
+        auto sum = static_cast<double>(accumulator.integer_sum) + accumulator.float_sum;
+        if (aggregate.function == AggregateFunction::Average) {
+            Value average(SQLType::Float);
+            average = sum / static_cast<double>(accumulator.count);
+            return average;
+        }
+        if (accumulator.is_integer && accumulator.integer_sum >= NumericLimits<int>::min() && accumulator.integer_sum <= NumericLimits<int>::max()) {
+            Value integer_sum(SQLType::Integer);
+            integer_sum = static_cast<int>(accumulator.integer_sum);
+            return integer_sum;
+        }
+        Value float_sum(SQLType::Float);
+        float_sum = sum;
+        return float_sum;
+    }
+    case AggregateFunction::Minimum:
+    case AggregateFunction::Maximum:
+        if (!accumulator.value.has_value())
+            return Value::null();
+        return accumulator.value.value();
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void Aggregate::open()
+{
+    Vector<Tuple> group_keys;
+    Vector<Vector<Accumulator>> accumulators;
+    HashMap<u32, Vector<size_t>> groups;
+
+    if (m_group_keys.is_empty()) {
+        groups.set(hash_values({}), { 0 });
+        group_keys.append({});
+        accumulators.append({});
+        accumulators.last().resize(m_aggregates.size());
+    }
+
+    m_input->open();
+    Tuple row;
+    while (m_input->next(row)) {
+        Tuple keys;
+        for (auto& group_key : m_group_keys)
+            keys.append(group_key(row));
+
+        Optional<size_t> group_index;
+        auto& group = groups.ensure(hash_values(keys));
+        for (auto index : group) {
+            if (values_are_equal(group_keys[index], keys)) {
+                group_index = index;
+                break;
+            }
+        }
+        if (!group_index.has_value()) {
+            group_index = group_keys.size();
+            group.append(group_index.value());
+            group_keys.append(move(keys));
+            accumulators.append({});
+            accumulators.last().resize(m_aggregates.size());
+        }
+
+        for (size_t ix = 0; ix < m_aggregates.size(); ix++)
+            accumulate(accumulators[group_index.value()][ix], m_aggregates[ix], row);
+    }
+
+    m_results.clear();
+    m_index = 0;
+    for (size_t group_index = 0; group_index < group_keys.size(); group_index++) {
+        Tuple result = group_keys[group_index];
+        for (size_t ix = 0; ix < m_aggregates.size(); ix++)
+            result.append(this->result(accumulators[group_index][ix], m_aggregates[ix]));
+        m_results.append(move(result));
+    }
+}
+
+bool Aggregate::next(Tuple& tuple)
+{
+    if (m_index >= m_results.size())
+        return false;
+    tuple = m_results[m_index++];
+    return true;
+}
+
+Distinct::Distinct(NonnullOwnPtr<Operator> input)
+    : m_input(move(input))
+{
+}
+
+void Distinct::open()
+{
+    m_seen.clear();
+    m_input->open();
+}
+
+bool Distinct::next(Tuple& tuple)
+{
+    while (m_input->next(tuple)) {
+        auto& seen = m_seen.ensure(hash_values(tuple));
+        bool is_duplicate = false;
+        for (auto& seen_tuple : seen) {
+            if (values_are_equal(seen_tuple, tuple)) {
+                is_duplicate = true;
+                break;
+            }
+        }
+        if (!is_duplicate) {
+            seen.append(tuple);
+            return true;
+        }
+    }
+    return false;
+}
+
+Limit::Limit(NonnullOwnPtr<Operator> input, Optional<size_t> limit, size_t offset)
+    : m_input(move(input))
+    , m_limit(limit)
+    , m_offset(offset)
+{
+}
+
+void Limit::open()
+{
+    m_produced = 0;
+    m_input->open();
+    Tuple skipped;
+    for (size_t ix = 0; ix < m_offset && m_input->next(skipped); ix++)
+        ;
+}
+
+bool Limit::next(Tuple& tuple)
+{
+    if (m_limit.has_value() && m_produced >= m_limit.value())
+        return false;
+    if (!m_input->next(tuple))
+        return false;
+    m_produced++;
+    return true;
+}
+
+String Limit::description() const
+{
+    if (!m_limit.has_value())
+        return String::formatted("Limit offset {}", m_offset);
+    return String::formatted("Limit {} offset {}", m_limit.value(), m_offset);
+}
+
+bool SingleRow::next(Tuple& tuple)
+{
+    if (m_done)
+        return false;
+    m_done = true;
+    tuple = Tuple();
+    return true;
+}
+
+}
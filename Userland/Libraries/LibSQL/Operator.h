@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Tuple.h>
+#include <LibSQL/Value.h>
+
+namespace SQL {
+
+// Query plans are trees of operators which pull rows from their children one at a time ("volcano" style),
+// so rows are only ever materialized by operators which cannot produce output before seeing all of their
+// input: the build side of a join, sorts and aggregates. Rows passed between operators are plain tuples
+// without a descriptor; the planner keeps track of what each position holds.
+
+using Evaluator = Function<Value(Tuple const&)>;
+
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // (Re)starts producing rows from the beginning. Must be called before the first call to next().
+    virtual void open() = 0;
+
+    // Stores the next row in the given tuple. Returns false once all rows have been produced.
+    virtual bool next(Tuple&) = 0;
+
+    // Dumps this operator and its inputs, one operator per line.
+    String to_string() const;
+
+protected:
+    virtual String description() const = 0;
+    virtual Vector<Operator const*> inputs() const { return {}; }
+
+private:
+    void dump(StringBuilder&, int indent) const;
+};
+
+class TableScan final : public Operator {
+public:
+    TableScan(Database&, NonnullRefPtr<TableDef>);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override;
+
+    Database& m_database;
+    NonnullRefPtr<TableDef> m_table;
+    u32 m_next_pointer { 0 };
+};
+
+// Produces the rows of a table whose (single column) index key lies between the given bounds, in index order.
+class IndexScan final : public Operator {
+public:
+    struct Bound {
+        Value value;
+        bool inclusive { true };
+    };
+
+    IndexScan(Database&, NonnullRefPtr<TableDef>, NonnullRefPtr<IndexDef>, Optional<Bound> lower_bound, Optional<Bound> upper_bound);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override;
+
+    Database& m_database;
+    NonnullRefPtr<TableDef> m_table;
+    NonnullRefPtr<IndexDef> m_index;
+    NonnullRefPtr<BTree> m_tree;
+    Optional<Bound> m_lower_bound;
+    Optional<Bound> m_upper_bound;
+    Optional<BTreeIterator> m_iterator;
+};
+
+class Filter final : public Operator {
+public:
+    Filter(NonnullOwnPtr<Operator> input, Evaluator predicate);
+
+    void open() override { m_input->open(); }
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return "Filter"; }
+    Vector<Operator const*> inputs() const override { return { m_input.ptr() }; }
+
+    NonnullOwnPtr<Operator> m_input;
+    Evaluator m_predicate;
+};
+
+class Projection final : public Operator {
+public:
+    Projection(NonnullOwnPtr<Operator> input, Vector<Evaluator> columns);
+
+    void open() override { m_input->open(); }
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return String::formatted("Projection ({} columns)", m_columns.size()); }
+    Vector<Operator const*> inputs() const override { return { m_input.ptr() }; }
+
+    NonnullOwnPtr<Operator> m_input;
+    Vector<Evaluator> m_columns;
+    Tuple m_input_row;
+};
+
+// Joins every row of the left input with every row of the right input that satisfies the (optional)
+// predicate. The right input is materialized when the join is opened.
+class NestedLoopJoin final : public Operator {
+public:
+    NestedLoopJoin(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right, Optional<Evaluator> predicate);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return "NestedLoopJoin"; }
+    Vector<Operator const*> inputs() const override { return { m_left.ptr(), m_right.ptr() }; }
+
+    NonnullOwnPtr<Operator> m_left;
+    NonnullOwnPtr<Operator> m_right;
+    Optional<Evaluator> m_predicate;
+    Vector<Tuple> m_right_rows;
+    Tuple m_left_row;
+    bool m_has_left_row { false };
+    size_t m_right_index { 0 };
+};
+
+// Equi-join which builds a hash table over the right input and probes it with the rows of the left input.
+// Rows whose join keys contain NULL never match. Keys are hashed with hash_values(), so the join keys on
+// both sides have to be of the same type category (text or numeric) for equal keys to be found.
+class HashJoin final : public Operator {
+public:
+    HashJoin(NonnullOwnPtr<Operator> left, NonnullOwnPtr<Operator> right, Vector<Evaluator> left_keys, Vector<Evaluator> right_keys);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return String::formatted("HashJoin ({} keys)", m_left_keys.size()); }
+    Vector<Operator const*> inputs() const override { return { m_left.ptr(), m_right.ptr() }; }
+
+    static Optional<Tuple> evaluate_keys(Vector<Evaluator> const&, Tuple const&);
+
+    NonnullOwnPtr<Operator> m_left;
+    NonnullOwnPtr<Operator> m_right;
+    Vector<Evaluator> m_left_keys;
+    Vector<Evaluator> m_right_keys;
+    HashMap<u32, Vector<size_t>> m_buckets;
+    Vector<Tuple> m_right_rows;
+    Vector<Tuple> m_right_row_keys;
+    Tuple m_left_row;
+    Tuple m_left_row_key;
+    Vector<size_t> const* m_matches { nullptr };
+    size_t m_match_index { 0 };
+};
+
+class Sort final : public Operator {
+public:
+    struct SortKey {
+        Evaluator evaluator;
+        AST::Order order { AST::Order::Ascending };
+        AST::Nulls nulls { AST::Nulls::First };
+    };
+
+    Sort(NonnullOwnPtr<Operator> input, Vector<SortKey> keys);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return String::formatted("Sort ({} keys)", m_keys.size()); }
+    Vector<Operator const*> inputs() const override { return { m_input.ptr() }; }
+
+    NonnullOwnPtr<Operator> m_input;
+    Vector<SortKey> m_keys;
+    Vector<Tuple> m_rows;
+    Vector<Tuple> m_row_keys;
+    Vector<size_t> m_order;
+    size_t m_index { 0 };
+};
+
+enum class AggregateFunction {
+    Count,
+    Sum,
+    Average,
+    Minimum,
+    Maximum,
+};
+
+// Groups its input by the group keys and produces one row per group, holding the group keys followed by
+// the aggregate values. Without group keys, exactly one row is produced, even for empty input.
+class Aggregate final : public Operator {
+public:
+    struct AggregateColumn {
+        AggregateFunction function;
+        Optional<Evaluator> argument; // Empty for COUNT(*).
+        bool distinct { false };
+    };
+
+    Aggregate(NonnullOwnPtr<Operator> input, Vector<Evaluator> group_keys, Vector<AggregateColumn> aggregates);
+
+    static Optional<AggregateFunction> function_for_name(StringView);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    struct Accumulator {
+        size_t count { 0 };
+        Optional<Value> value; // The current minimum or maximum.
+        bool is_integer { true };
+        i64 integer_sum { 0 };
+        double float_sum { 0 };
+        HashMap<u32, Vector<Tuple>> seen_values; // Only used for DISTINCT aggregates.
+    };
+
+    String description() const override { return String::formatted("Aggregate ({} group keys, {} aggregates)", m_group_keys.size(), m_aggregates.size()); }
+    Vector<Operator const*> inputs() const override { return { m_input.ptr() }; }
+
+    void accumulate(Accumulator&, AggregateColumn const&, Tuple const&);
+    Value result(Accumulator const&, AggregateColumn const&) const;
+
+    NonnullOwnPtr<Operator> m_input;
+    Vector<Evaluator> m_group_keys;
+    Vector<AggregateColumn> m_aggregates;
+    Vector<Tuple> m_results;
+    size_t m_index { 0 };
+};
+
+class Distinct final : public Operator {
+public:
+    explicit Distinct(NonnullOwnPtr<Operator> input);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return "Distinct"; }
+    Vector<Operator const*> inputs() const override { return { m_input.ptr() }; }
+
+    NonnullOwnPtr<Operator> m_input;
+    HashMap<u32, Vector<Tuple>> m_seen;
+};
+
+class Limit final : public Operator {
+public:
+    Limit(NonnullOwnPtr<Operator> input, Optional<size_t> limit, size_t offset);
+
+    void open() override;
+    bool next(Tuple&) override;
+
+private:
+    String description() const override;
+    Vector<Operator const*> inputs() const override { return { m_input.ptr() }; }
+
+    NonnullOwnPtr<Operator> m_input;
+    Optional<size_t> m_limit;
+    size_t m_offset { 0 };
+    size_t m_produced { 0 };
+};
+
+// Produces a single empty row, which is the input of a SELECT without a FROM clause.
+class SingleRow final : public Operator {
+public:
+    void open() override { m_done = false; }
+    bool next(Tuple&) override;
+
+private:
+    String description() const override { return "SingleRow"; }
+
+    bool m_done { false };
+};
+
+// Helpers to evaluate expressions with SQL semantics on Values of any type. NULL compares equal to NULL
+// and less than everything else, which is what sorting, grouping and DISTINCT need. Integers and floats
+// are compared numerically, text with a number is compared numerically if the text holds a number.
+bool is_true(Value const&);
+Optional<double> numeric_value(Value const&);
+int compare_values(Value const&, Value const&);
+bool values_are_equal(Tuple const&, Tuple const&);
+u32 hash_values(Tuple const&);
+Tuple concatenate(Tuple const&, Tuple const&);
+
+}
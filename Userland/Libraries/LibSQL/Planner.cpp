@@ -0,0 +1,1158 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/Debug.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Planner.h>
+#include <math.h>
+
+namespace SQL {
+
+namespace {
+
+Value integer_value(i64 integer)
+{
+    if (integer < NumericLimits<int>::min() || integer > NumericLimits<int>::max()) {
+        Value value(SQLType::Float);
+        value = static_cast<double>(integer);
+        return value;
+    }
+    Value value(SQLType::Integer);
+    value = static_cast<int>(integer);
+    return value;
+}
+
+Value float_value(double number)
+{
+    Value value(SQLType::Float);
+    value = number;
+    return value;
+}
+
+Value boolean_value(bool boolean)
+{
+    Value value(SQLType::Integer);
+    value = boolean ? 1 : 0;
+    return value;
+}
+
+Value text_value(String const& string)
+{
+    Value value(SQLType::Text);
+    value = string;
+    return value;
+}
+
+bool is_numeric(SQLType type)
+{
+    return type == SQLType::Integer || type == SQLType::Float;
+}
+
+// Matches with LIKE semantics: % matches any sequence of characters, _ matches any single character, and
+// ASCII letters match case-insensitively.
+bool matches_like_pattern(StringView string, StringView pattern)
+{
+    size_t string_index = 0;
+    size_t pattern_index = 0;
+    Optional<size_t> backtrack_pattern_index;
+    size_t backtrack_string_index = 0;
+
+    while (string_index < string.length()) {
+        if (pattern_index < pattern.length() && pattern[pattern_index] == '%') {
+            backtrack_pattern_index = ++pattern_index;
+            backtrack_string_index = string_index;
+        } else if (pattern_index < pattern.length() && (pattern[pattern_index] == '_' || to_ascii_lowercase(pattern[pattern_index]) == to_ascii_lowercase(string[string_index]))) {
+            pattern_index++;
+            string_index++;
+        } else if (backtrack_pattern_index.has_value()) {
+            pattern_index = backtrack_pattern_index.value();
+            string_index = ++backtrack_string_index;
+        } else {
+            return false;
+        }
+    }
+
+    while (pattern_index < pattern.length() && pattern[pattern_index] == '%')
+        pattern_index++;
+    return pattern_index == pattern.length();
+}
+
+void for_each_subexpression(AST::Expression const& expression, Function<void(AST::Expression const&)> const& callback)
+{
+    if (is<AST::BetweenExpression>(expression))
+        callback(*static_cast<AST::BetweenExpression const&>(expression).expression());
+
+    if (is<AST::NestedExpression>(expression))
+        callback(*static_cast<AST::NestedExpression const&>(expression).expression());
+
+    if (is<AST::NestedDoubleExpression>(expression)) {
+        callback(*static_cast<AST::NestedDoubleExpression const&>(expression).lhs());
+        callback(*static_cast<AST::NestedDoubleExpression const&>(expression).rhs());
+    }
+
+    if (is<AST::MatchExpression>(expression)) {
+        if (auto const& escape = static_cast<AST::MatchExpression const&>(expression).escape(); !escape.is_null())
+            callback(*escape);
+    }
+
+    if (is<AST::InChainedExpression>(expression))
+        callback(*static_cast<AST::InChainedExpression const&>(expression).expression_chain());
+
+    if (is<AST::ChainedExpression>(expression)) {
+        for (auto const& chained_expression : static_cast<AST::ChainedExpression const&>(expression).expressions())
+            callback(chained_expression);
+    }
+
+    if (is<AST::FunctionCallExpression>(expression)) {
+        for (auto const& argument : static_cast<AST::FunctionCallExpression const&>(expression).arguments())
+            callback(argument);
+    }
+
+    if (is<AST::CaseExpression>(expression)) {
+        auto const& case_expression = static_cast<AST::CaseExpression const&>(expression);
+        if (!case_expression.case_expression().is_null())
+            callback(*case_expression.case_expression());
+        for (auto const& clause : case_expression.when_then_clauses()) {
+            callback(*clause.when);
+            callback(*clause.then);
+        }
+        if (!case_expression.else_expression().is_null())
+            callback(*case_expression.else_expression());
+    }
+}
+
+bool is_aggregate_call(AST::Expression const& expression)
+{
+    return is<AST::FunctionCallExpression>(expression)
+        && Aggregate::function_for_name(static_cast<AST::FunctionCallExpression const&>(expression).name()).has_value();
+}
+
+void collect_aggregate_calls(AST::Expression const& expression, Vector<AST::FunctionCallExpression const*>& calls)
+{
+    if (is_aggregate_call(expression)) {
+        calls.append(static_cast<AST::FunctionCallExpression const*>(&expression));
+        return;
+    }
+    for_each_subexpression(expression, [&](auto const& subexpression) { collect_aggregate_calls(subexpression, calls); });
+}
+
+void split_conjuncts(AST::Expression const& expression, Vector<AST::Expression const*>& conjuncts)
+{
+    if (is<AST::BinaryOperatorExpression>(expression)) {
+        auto const& binary_expression = static_cast<AST::BinaryOperatorExpression const&>(expression);
+        if (binary_expression.type() == AST::BinaryOperator::And) {
+            split_conjuncts(*binary_expression.lhs(), conjuncts);
+            split_conjuncts(*binary_expression.rhs(), conjuncts);
+            return;
+        }
+    }
+    if (is<AST::ChainedExpression>(expression)) {
+        auto const& chain = static_cast<AST::ChainedExpression const&>(expression).expressions();
+        if (chain.size() == 1) {
+            split_conjuncts(chain.first(), conjuncts);
+            return;
+        }
+    }
+    conjuncts.append(&expression);
+}
+
+Optional<SQLType> sql_type_for_name(StringView name)
+{
+    // https://sqlite.org/datatype3.html#determination_of_column_affinity
+    if (name.contains("INT", CaseSensitivity::CaseInsensitive))
+        return SQLType::Integer;
+    if (name.contains("CHAR", CaseSensitivity::CaseInsensitive) || name.contains("CLOB", CaseSensitivity::CaseInsensitive) || name.contains("TEXT", CaseSensitivity::CaseInsensitive))
+        return SQLType::Text;
+    if (name.contains("REAL", CaseSensitivity::CaseInsensitive) || name.contains("FLOA", CaseSensitivity::CaseInsensitive) || name.contains("DOUB", CaseSensitivity::CaseInsensitive))
+        return SQLType::Float;
+    return {};
+}
+
+Value evaluate_arithmetic(AST::BinaryOperator type, Value const& lhs, Value const& rhs)
+{
+    if (lhs.is_null() || rhs.is_null())
+        return Value::null();
+
+    if (lhs.type() == SQLType::Integer && rhs.type() == SQLType::Integer) {
+        i64 a = lhs.to_int().value();
+        i64 b = rhs.to_int().value();
+        switch (type) {
+        case AST::BinaryOperator::Plus:
+            return integer_value(a + b);
+        case AST::BinaryOperator::Minus:
+            return integer_value(a - b);
+        case AST::BinaryOperator::Multiplication:
+            return integer_value(a * b);
+        case AST::BinaryOperator::Division:
+            return b ? integer_value(a / b) : Value::null();
+        case AST::BinaryOperator::Modulo:
+            return b ? integer_value(a % b) : Value::null();
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+
+    auto a = numeric_value(lhs).value_or(0);
+    auto b = numeric_value(rhs).value_or(0);
+    switch (type) {
+    case AST::BinaryOperator::Plus:
+        return float_value(a + b);
+    case AST::BinaryOperator::Minus:
+        return float_value(a - b);
+    case AST::BinaryOperator::Multiplication:
+        return float_value(a * b);
+    case AST::BinaryOperator::Division:
+        return b != 0 ? float_value(a / b) : Value::null();
+    case AST::BinaryOperator::Modulo:
+        return b != 0 ? float_value(fmod(a, b)) : Value::null();
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+Value evaluate_bitwise(AST::BinaryOperator type, Value const& lhs, Value const& rhs)
+{
+    if (lhs.is_null() || rhs.is_null())
+        return Value::null();
+
+    auto a = static_cast<i64>(numeric_value(lhs).value_or(0));
+    auto b = static_cast<i64>(numeric_value(rhs).value_or(0));
+    switch (type) {
+    case AST::BinaryOperator::ShiftLeft:
+        return integer_value((b >= 0 && b < 64) ? (a << b) : 0);
+    case AST::BinaryOperator::ShiftRight:
+        return integer_value((b >= 0 && b < 64) ? (a >> b) : (a < 0 ? -1 : 0));
+    case AST::BinaryOperator::BitwiseAnd:
+        return integer_value(a & b);
+    case AST::BinaryOperator::BitwiseOr:
+        return integer_value(a | b);
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+Value evaluate_comparison(AST::BinaryOperator type, Value const& lhs, Value const& rhs)
+{
+    if (lhs.is_null() || rhs.is_null())
+        return Value::null();
+
+    auto comparison = compare_values(lhs, rhs);
+    switch (type) {
+    case AST::BinaryOperator::LessThan:
+        return boolean_value(comparison < 0);
+    case AST::BinaryOperator::LessThanEquals:
+        return boolean_value(comparison <= 0);
+    case AST::BinaryOperator::GreaterThan:
+        return boolean_value(comparison > 0);
+    case AST::BinaryOperator::GreaterThanEquals:
+        return boolean_value(comparison >= 0);
+    case AST::BinaryOperator::Equals:
+        return boolean_value(comparison == 0);
+    case AST::BinaryOperator::NotEquals:
+        return boolean_value(comparison != 0);
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+}
+
+Planner::Planner(Database& database)
+    : m_database(database)
+{
+}
+
+Result<size_t, String> Planner::resolve_column(AST::ColumnNameExpression const& expression) const
+{
+    Optional<size_t> position;
+    for (size_t ix = 0; ix < m_scope.size(); ix++) {
+        auto const& column = m_scope[ix];
+        if (column.column_name.is_empty() || !column.column_name.equals_ignoring_case(expression.column_name()))
+            continue;
+        if (!expression.table_name().is_empty() && !column.table_name.equals_ignoring_case(expression.table_name()))
+            continue;
+        if (!expression.schema_name().is_empty() && !column.schema_name.equals_ignoring_case(expression.schema_name()))
+            continue;
+        if (position.has_value())
+            return String::formatted("Column name '{}' is ambiguous", expression.column_name());
+        position = ix;
+    }
+
+    if (!position.has_value()) {
+        if (expression.table_name().is_empty())
+            return String::formatted("Column '{}' does not exist", expression.column_name());
+        return String::formatted("Column '{}.{}' does not exist", expression.table_name(), expression.column_name());
+    }
+    return position.value();
+}
+
+Result<Vector<size_t>, String> Planner::referenced_tables(AST::Expression const& expression) const
+{
+    Vector<size_t> tables;
+    Optional<String> error;
+
+    Function<void(AST::Expression const&)> visit = [&](AST::Expression const& subexpression) {
+        if (error.has_value())
+            return;
+        if (is<AST::ColumnNameExpression>(subexpression)) {
+            auto position_or_error = resolve_column(static_cast<AST::ColumnNameExpression const&>(subexpression));
+            if (position_or_error.is_error()) {
+                error = position_or_error.release_error();
+                return;
+            }
+            auto table_index = m_scope[position_or_error.value()].table_index;
+            if (!tables.contains_slow(table_index))
+                tables.append(table_index);
+            return;
+        }
+        if (is_aggregate_call(subexpression)) {
+            error = String::formatted("Aggregate function '{}' is not allowed here", static_cast<AST::FunctionCallExpression const&>(subexpression).name());
+            return;
+        }
+        for_each_subexpression(subexpression, visit);
+    };
+    visit(expression);
+
+    if (error.has_value())
+        return error.release_value();
+    return tables;
+}
+
+Optional<SQLType> Planner::static_type(AST::Expression const& expression) const
+{
+    if (is<AST::ColumnNameExpression>(expression)) {
+        auto position_or_error = resolve_column(static_cast<AST::ColumnNameExpression const&>(expression));
+        if (position_or_error.is_error())
+            return {};
+        return m_scope[position_or_error.value()].type;
+    }
+    if (is<AST::NumericLiteral>(expression)) {
+        auto value = static_cast<AST::NumericLiteral const&>(expression).value();
+        if (value == trunc(value) && value >= NumericLimits<int>::min() && value <= NumericLimits<int>::max())
+            return SQLType::Integer;
+        return SQLType::Float;
+    }
+    if (is<AST::StringLiteral>(expression))
+        return SQLType::Text;
+    return {};
+}
+
+Result<Value, String> Planner::evaluate_constant(AST::Expression const& expression) const
+{
+    auto tables_or_error = referenced_tables(expression);
+    if (tables_or_error.is_error())
+        return tables_or_error.release_error();
+    if (!tables_or_error.value().is_empty())
+        return String { "Expected a constant expression" };
+
+    auto evaluator_or_error = compile(expression, 0);
+    if (evaluator_or_error.is_error())
+        return evaluator_or_error.release_error();
+    return evaluator_or_error.value()(Tuple {});
+}
+
+Result<Evaluator, String> Planner::compile(AST::Expression const& expression, size_t offset) const
+{
+    if (auto computed_position = m_computed_expressions.get(&expression); computed_position.has_value()) {
+        auto position = computed_position.value() - offset;
+        return Evaluator { [position](Tuple const& row) { return row[position]; } };
+    }
+
+    auto compile_subexpressions = [&](auto const&... subexpressions) -> Result<Vector<Evaluator>, String> {
+        Vector<Evaluator> evaluators;
+        Optional<String> error;
+        auto compile_one = [&](AST::Expression const& subexpression) {
+            if (error.has_value())
+                return;
+            auto evaluator_or_error = compile(subexpression, offset);
+            if (evaluator_or_error.is_error())
+                error = evaluator_or_error.release_error();
+            else
+                evaluators.append(evaluator_or_error.release_value());
+        };
+        (compile_one(subexpressions), ...);
+        if (error.has_value())
+            return error.release_value();
+        return evaluators;
+    };
+
+    if (is<AST::NumericLiteral>(expression)) {
+        auto number = static_cast<AST::NumericLiteral const&>(expression).value();
+        auto value = static_type(expression) == SQLType::Integer ? integer_value(static_cast<i64>(number)) : float_value(number);
+        return Evaluator { [value = move(value)](Tuple const&) { return value; } };
+    }
+
+    if (is<AST::StringLiteral>(expression)) {
+        auto value = text_value(static_cast<AST::StringLiteral const&>(expression).value());
+        return Evaluator { [value = move(value)](Tuple const&) { return value; } };
+    }
+
+    if (is<AST::NullLiteral>(expression))
+        return Evaluator { [](Tuple const&) { return Value::null(); } };
+
+    if (is<AST::ColumnNameExpression>(expression)) {
+        auto position_or_error = resolve_column(static_cast<AST::ColumnNameExpression const&>(expression));
+        if (position_or_error.is_error())
+            return position_or_error.release_error();
+        auto position = position_or_error.value() - offset;
+        return Evaluator { [position](Tuple const& row) { return row[position]; } };
+    }
+
+    if (is<AST::ChainedExpression>(expression)) {
+        auto const& chain = static_cast<AST::ChainedExpression const&>(expression).expressions();
+        if (chain.size() != 1)
+            return String { "Row values are not supported" };
+        return compile(chain.first(), offset);
+    }
+
+    if (is<AST::UnaryOperatorExpression>(expression)) {
+        auto const& unary_expression = static_cast<AST::UnaryOperatorExpression const&>(expression);
+        auto operand_or_error = compile(*unary_expression.expression(), offset);
+        if (operand_or_error.is_error())
+            return operand_or_error.release_error();
+
+        return Evaluator { [type = unary_expression.type(), operand = operand_or_error.release_value()](Tuple const& row) {
+            auto value = operand(row);
+            if (value.is_null())
+                return Value::null();
+            switch (type) {
+            case AST::UnaryOperator::Minus:
+                if (value.type() == SQLType::Integer)
+                    return integer_value(-static_cast<i64>(value.to_int().value()));
+                return float_value(-numeric_value(value).value_or(0));
+            case AST::UnaryOperator::Plus:
+                return value;
+            case AST::UnaryOperator::BitwiseNot:
+                return integer_value(~static_cast<i64>(numeric_value(value).value_or(0)));
+            case AST::UnaryOperator::Not:
+                return boolean_value(!is_true(value));
+            }
+            VERIFY_NOT_REACHED();
+        } };
+    }
+
+    if (is<AST::BinaryOperatorExpression>(expression)) {
+        auto const& binary_expression = static_cast<AST::BinaryOperatorExpression const&>(expression);
+        auto operands_or_error = compile_subexpressions(*binary_expression.lhs(), *binary_expression.rhs());
+        if (operands_or_error.is_error())
+            return operands_or_error.release_error();
+        auto operands = operands_or_error.release_value();
+        auto lhs = move(operands[0]);
+        auto rhs = move(operands[1]);
+
+        switch (auto type = binary_expression.type(); type) {
+        case AST::BinaryOperator::Concatenate:
+            return Evaluator { [lhs = move(lhs), rhs = move(rhs)](Tuple const& row) {
+                auto a = lhs(row);
+                auto b = rhs(row);
+                if (a.is_null() || b.is_null())
+                    return Value::null();
+                return text_value(String::formatted("{}{}", a.to_string().value(), b.to_string().value()));
+            } };
+        case AST::BinaryOperator::Multiplication:
+        case AST::BinaryOperator::Division:
+        case AST::BinaryOperator::Modulo:
+        case AST::BinaryOperator::Plus:
+        case AST::BinaryOperator::Minus:
+            return Evaluator { [type, lhs = move(lhs), rhs = move(rhs)](Tuple const& row) { return evaluate_arithmetic(type, lhs(row), rhs(row)); } };
+        case AST::BinaryOperator::ShiftLeft:
+        case AST::BinaryOperator::ShiftRight:
+        case AST::BinaryOperator::BitwiseAnd:
+        case AST::BinaryOperator::BitwiseOr:
+            return Evaluator { [type, lhs = move(lhs), rhs = move(rhs)](Tuple const& row) { return evaluate_bitwise(type, lhs(row), rhs(row)); } };
+        case AST::BinaryOperator::LessThan:
+        case AST::BinaryOperator::LessThanEquals:
+        case AST::BinaryOperator::GreaterThan:
+        case AST::BinaryOperator::GreaterThanEquals:
+        case AST::BinaryOperator::Equals:
+        case AST::BinaryOperator::NotEquals:
+            return Evaluator { [type, lhs = move(lhs), rhs = move(rhs)](Tuple const& row) { return evaluate_comparison(type, lhs(row), rhs(row)); } };
+        case AST::BinaryOperator::And:
+            // Three-valued logic: FALSE AND NULL is FALSE, TRUE AND NULL is NULL.
+            return Evaluator { [lhs = move(lhs), rhs = move(rhs)](Tuple const& row) {
+                auto a = lhs(row);
+                if (!a.is_null() && !is_true(a))
+                    return boolean_value(false);
+                auto b = rhs(row);
+                if (!b.is_null() && !is_true(b))
+                    return boolean_value(false);
+                return (a.is_null() || b.is_null()) ? Value::null() : boolean_value(true);
+            } };
+        case AST::BinaryOperator::Or:
+            return Evaluator { [lhs = move(lhs), rhs = move(rhs)](Tuple const& row) {
+                auto a = lhs(row);
+                if (is_true(a))
+                    return boolean_value(true);
+                auto b = rhs(row);
+                if (is_true(b))
+                    return boolean_value(true);
+                return (a.is_null() || b.is_null()) ? Value::null() : boolean_value(false);
+            } };
+        }
+        VERIFY_NOT_REACHED();
+    }
+
+    if (is<AST::NullExpression>(expression)) {
+        auto const& null_expression = static_cast<AST::NullExpression const&>(expression);
+        auto operand_or_error = compile(*null_expression.expression(), offset);
+        if (operand_or_error.is_error())
+            return operand_or_error.release_error();
+        return Evaluator { [invert = null_expression.invert_expression(), operand = operand_or_error.release_value()](Tuple const& row) {
+            return boolean_value(operand(row).is_null() != invert);
+        } };
+    }
+
+    if (is<AST::IsExpression>(expression)) {
+        auto const& is_expression = static_cast<AST::IsExpression const&>(expression);
+        auto operands_or_error = compile_subexpressions(*is_expression.lhs(), *is_expression.rhs());
+        if (operands_or_error.is_error())
+            return operands_or_error.release_error();
+        auto operands = operands_or_error.release_value();
+        return Evaluator { [invert = is_expression.invert_expression(), lhs = move(operands[0]), rhs = move(operands[1])](Tuple const& row) {
+            return boolean_value((compare_values(lhs(row), rhs(row)) == 0) != invert);
+        } };
+    }
+
+    if (is<AST::BetweenExpression>(expression)) {
+        auto const& between_expression = static_cast<AST::BetweenExpression const&>(expression);
+        auto operands_or_error = compile_subexpressions(*between_expression.expression(), *between_expression.lhs(), *between_expression.rhs());
+        if (operands_or_error.is_error())
+            return operands_or_error.release_error();
+        auto operands = operands_or_error.release_value();
+        return Evaluator { [invert = between_expression.invert_expression(), operands = move(operands)](Tuple const& row) {
+            auto value = operands[0](row);
+            auto lower_bound = operands[1](row);
+            auto upper_bound = operands[2](row);
+            if (value.is_null() || lower_bound.is_null() || upper_bound.is_null())
+                return Value::null();
+            auto is_between = compare_values(value, lower_bound) >= 0 && compare_values(value, upper_bound) <= 0;
+            return boolean_value(is_between != invert);
+        } };
+    }
+
+    if (is<AST::InChainedExpression>(expression)) {
+        auto const& in_expression = static_cast<AST::InChainedExpression const&>(expression);
+        auto operand_or_error = compile(*in_expression.expression(), offset);
+        if (operand_or_error.is_error())
+            return operand_or_error.release_error();
+
+        Vector<Evaluator> candidates;
+        for (auto const& candidate : in_expression.expression_chain()->expressions()) {
+            auto candidate_or_error = compile(candidate, offset);
+            if (candidate_or_error.is_error())
+                return candidate_or_error.release_error();
+            candidates.append(candidate_or_error.release_value());
+        }
+
+        return Evaluator { [invert = in_expression.invert_expression(), operand = operand_or_error.release_value(), candidates = move(candidates)](Tuple const& row) {
+            auto value = operand(row);
+            if (value.is_null())
+                return Value::null();
+            bool found = false;
+            for (auto& candidate : candidates) {
+                if (compare_values(value, candidate(row)) == 0) {
+                    found = true;
+                    break;
+                }
+            }
+            return boolean_value(found != invert);
+        } };
+    }
+
+    if (is<AST::MatchExpression>(expression)) {
+        auto const& match_expression = static_cast<AST::MatchExpression const&>(expression);
+        auto type = match_expression.type();
+        if ((type != AST::MatchOperator::Like && type != AST::MatchOperator::Glob) || !match_expression.escape().is_null())
+            return String { "Only LIKE and GLOB without ESCAPE are supported" };
+
+        auto operands_or_error = compile_subexpressions(*match_expression.lhs(), *match_expression.rhs());
+        if (operands_or_error.is_error())
+            return operands_or_error.release_error();
+        auto operands = operands_or_error.release_value();
+        return Evaluator { [type, invert = match_expression.invert_expression(), lhs = move(operands[0]), rhs = move(operands[1])](Tuple const& row) {
+            auto value = lhs(row);
+            auto pattern = rhs(row);
+            if (value.is_null() || pattern.is_null())
+                return Value::null();
+            auto string = value.to_string().value();
+            auto matches = (type == AST::MatchOperator::Like)
+                ? matches_like_pattern(string, pattern.to_string().value())
+                : string.matches(pattern.to_string().value(), CaseSensitivity::CaseSensitive);
+            return boolean_value(matches != invert);
+        } };
+    }
+
+    if (is<AST::CastExpression>(expression)) {
+        auto const& cast_expression = static_cast<AST::CastExpression const&>(expression);
+        auto type = sql_type_for_name(cast_expression.type_name()->name());
+        if (!type.has_value())
+            return String::formatted("Cannot cast to type '{}'", cast_expression.type_name()->name());
+
+        auto operand_or_error = compile(*cast_expression.expression(), offset);
+        if (operand_or_error.is_error())
+            return operand_or_error.release_error();
+        return Evaluator { [type = type.value(), operand = operand_or_error.release_value()](Tuple const& row) {
+            auto value = operand(row);
+            Value result(type);
+            if (value.is_null() || !result.can_cast(value))
+                return Value::null();
+            result = value;
+            return result;
+        } };
+    }
+
+    if (is<AST::CaseExpression>(expression)) {
+        auto const& case_expression = static_cast<AST::CaseExpression const&>(expression);
+
+        Optional<Evaluator> base;
+        if (!case_expression.case_expression().is_null()) {
+            auto base_or_error = compile(*case_expression.case_expression(), offset);
+            if (base_or_error.is_error())
+                return base_or_error.release_error();
+            base = base_or_error.release_value();
+        }
+
+        Vector<Evaluator> clauses;
+        for (auto const& clause : case_expression.when_then_clauses()) {
+            auto clause_or_error = compile_subexpressions(*clause.when, *clause.then);
+            if (clause_or_error.is_error())
+                return clause_or_error.release_error();
+            clauses.extend(clause_or_error.release_value());
+        }
+
+        Optional<Evaluator> otherwise;
+        if (!case_expression.else_expression().is_null()) {
+            auto otherwise_or_error = compile(*case_expression.else_expression(), offset);
+            if (otherwise_or_error.is_error())
+                return otherwise_or_error.release_error();
+            otherwise = otherwise_or_error.release_value();
+        }
+
+        return Evaluator { [base = move(base), clauses = move(clauses), otherwise = move(otherwise)](Tuple const& row) {
+            Optional<Value> base_value;
+            if (base.has_value())
+                base_value = base.value()(row);
+
+            for (size_t ix = 0; ix < clauses.size(); ix += 2) {
+                auto when = clauses[ix](row);
+                auto matches = base_value.has_value()
+                    ? (!base_value->is_null() && !when.is_null() && compare_values(base_value.value(), when) == 0)
+                    : is_true(when);
+                if (matches)
+                    return clauses[ix + 1](row);
+            }
+            return otherwise.has_value() ? otherwise.value()(row) : Value::null();
+        } };
+    }
+
+    if (is<AST::FunctionCallExpression>(expression)) {
+        auto const& function_call = static_cast<AST::FunctionCallExpression const&>(expression);
+        if (is_aggregate_call(expression))
+            return String::formatted("Aggregate function '{}' is not allowed here", function_call.name());
+        return String::formatted("Function '{}' does not exist", function_call.name());
+    }
+
+    return String { "Expression is not supported" };
+}
+
+Planner::AccessPath Planner::choose_access_path(NonnullRefPtr<TableDef> const& table, size_t table_index, Vector<AST::Expression const*> const& conjuncts)
+{
+    auto row_count = static_cast<double>(m_database.row_count(*table));
+    auto lookup_cost = log2(row_count + 1);
+
+    AccessPath best { make<TableScan>(m_database, table), row_count, {} };
+
+    struct Candidate {
+        Optional<IndexScan::Bound> lower_bound;
+        Optional<IndexScan::Bound> upper_bound;
+        bool is_equality { false };
+        Vector<AST::Expression const*> conjuncts;
+    };
+
+    // Returns the value of the literal, if it can be compared to the indexed column without any conversion.
+    auto literal_for_column = [&](AST::Expression const& expression, SQLType column_type) -> Optional<Value> {
+        if (!is<AST::NumericLiteral>(expression) && !is<AST::StringLiteral>(expression))
+            return {};
+        auto type = static_type(expression);
+        if (type != column_type && !(column_type == SQLType::Float && type == SQLType::Integer))
+            return {};
+        auto value_or_error = evaluate_constant(expression);
+        if (value_or_error.is_error())
+            return {};
+        Value value(column_type);
+        value = value_or_error.release_value();
+        return value;
+    };
+
+    auto indexed_column = [&](AST::Expression const& expression, IndexDef const& index) -> bool {
+        if (!is<AST::ColumnNameExpression>(expression))
+            return false;
+        auto position_or_error = resolve_column(static_cast<AST::ColumnNameExpression const&>(expression));
+        if (position_or_error.is_error() || m_scope[position_or_error.value()].table_index != table_index)
+            return false;
+        return m_scope[position_or_error.value()].column_name == index.key_definition()[0].name();
+    };
+
+    for (auto& index : table->indexes()) {
+        if (index.size() != 1 || index.key_definition()[0].sort_order() != AST::Order::Ascending)
+            continue;
+        auto column_type = index.key_definition()[0].type();
+
+        Candidate candidate;
+        // Every matched conjunct is dropped from the filter, so of two bounds on the same value the exclusive one wins.
+        auto tighten_lower_bound = [&](Value value, bool inclusive) {
+            if (candidate.lower_bound.has_value()) {
+                auto comparison = compare_values(value, candidate.lower_bound->value);
+                if (comparison < 0 || (comparison == 0 && inclusive))
+                    return;
+            }
+            candidate.lower_bound = IndexScan::Bound { move(value), inclusive };
+        };
+        auto tighten_upper_bound = [&](Value value, bool inclusive) {
+            if (candidate.upper_bound.has_value()) {
+                auto comparison = compare_values(value, candidate.upper_bound->value);
+                if (comparison > 0 || (comparison == 0 && inclusive))
+                    return;
+            }
+            candidate.upper_bound = IndexScan::Bound { move(value), inclusive };
+        };
+
+        for (auto* conjunct : conjuncts) {
+            if (is<AST::BetweenExpression>(*conjunct)) {
+                auto const& between_expression = static_cast<AST::BetweenExpression const&>(*conjunct);
+                if (between_expression.invert_expression() || !indexed_column(*between_expression.expression(), index))
+                    continue;
+                auto lower_bound = literal_for_column(*between_expression.lhs(), column_type);
+                auto upper_bound = literal_for_column(*between_expression.rhs(), column_type);
+                if (!lower_bound.has_value() || !upper_bound.has_value())
+                    continue;
+                tighten_lower_bound(lower_bound.release_value(), true);
+                tighten_upper_bound(upper_bound.release_value(), true);
+                candidate.conjuncts.append(conjunct);
+                continue;
+            }
+
+            if (!is<AST::BinaryOperatorExpression>(*conjunct))
+                continue;
+            auto const& binary_expression = static_cast<AST::BinaryOperatorExpression const&>(*conjunct);
+            auto type = binary_expression.type();
+
+            // Normalize to "column <op> literal".
+            Optional<Value> literal;
+            if (indexed_column(*binary_expression.lhs(), index)) {
+                literal = literal_for_column(*binary_expression.rhs(), column_type);
+            } else if (indexed_column(*binary_expression.rhs(), index)) {
+                literal = literal_for_column(*binary_expression.lhs(), column_type);
+                if (type == AST::BinaryOperator::LessThan)
+                    type = AST::BinaryOperator::GreaterThan;
+                else if (type == AST::BinaryOperator::LessThanEquals)
+                    type = AST::BinaryOperator::GreaterThanEquals;
+                else if (type == AST::BinaryOperator::GreaterThan)
+                    type = AST::BinaryOperator::LessThan;
+                else if (type == AST::BinaryOperator::GreaterThanEquals)
+                    type = AST::BinaryOperator::LessThanEquals;
+            }
+            if (!literal.has_value())
+                continue;
+
+            switch (type) {
+            case AST::BinaryOperator::Equals:
+                tighten_lower_bound(literal.value(), true);
+                tighten_upper_bound(literal.release_value(), true);
+                candidate.is_equality = true;
+                break;
+            case AST::BinaryOperator::LessThan:
+            case AST::BinaryOperator::LessThanEquals:
+                tighten_upper_bound(literal.release_value(), type == AST::BinaryOperator::LessThanEquals);
+                break;
+            case AST::BinaryOperator::GreaterThan:
+            case AST::BinaryOperator::GreaterThanEquals:
+                tighten_lower_bound(literal.release_value(), type == AST::BinaryOperator::GreaterThanEquals);
+                break;
+            default:
+                continue;
+            }
+            candidate.conjuncts.append(conjunct);
+        }
+
+        if (candidate.conjuncts.is_empty())
+            continue;
+
+        auto selectivity = candidate.is_equality ? equality_selectivity : estimate_range_selectivity(index, candidate.lower_bound, candidate.upper_bound);
+
+        auto fetched_rows = (candidate.is_equality && index.unique()) ? 1.0 : max(1.0, row_count * selectivity);
+        auto cost = lookup_cost + fetched_rows * random_fetch_cost;
+        dbgln_if(SQL_DEBUG, "Index {} on {}: cost {} (table scan: {})", index.name(), table->name(), cost, row_count);
+        if (cost < best.cost)
+            best = { make<IndexScan>(m_database, table, index, move(candidate.lower_bound), move(candidate.upper_bound)), cost, move(candidate.conjuncts) };
+    }
+    return best;
+}
+
+double Planner::estimate_range_selectivity(IndexDef& index, Optional<IndexScan::Bound> const& lower_bound, Optional<IndexScan::Bound> const& upper_bound)
+{
+    auto column_type = index.key_definition()[0].type();
+    if (column_type != SQLType::Integer && column_type != SQLType::Float)
+        return (lower_bound.has_value() && upper_bound.has_value()) ? between_selectivity : range_selectivity;
+
+    auto tree = m_database.get_index_tree(index);
+    auto first = tree->begin();
+    auto last = tree->last();
+    if (first.is_end() || last.is_end())
+        return 0;
+    auto smallest = (*first)[0].to_double();
+    auto largest = (*last)[0].to_double();
+    if (!smallest.has_value() || !largest.has_value())
+        return (lower_bound.has_value() && upper_bound.has_value()) ? between_selectivity : range_selectivity;
+
+    auto low = smallest.value();
+    auto high = largest.value();
+    if (lower_bound.has_value())
+        low = max(low, lower_bound->value.to_double().value_or(low));
+    if (upper_bound.has_value())
+        high = min(high, upper_bound->value.to_double().value_or(high));
+    if (high < low)
+        return 0;
+
+    // Integers are counted rather than measured, so that a range of a single value isn't empty.
+    auto extra = column_type == SQLType::Integer ? 1.0 : 0.0;
+    auto width = largest.value() - smallest.value() + extra;
+    return width > 0 ? (high - low + extra) / width : 1.0;
+}
+
+Result<NonnullOwnPtr<Operator>, String> Planner::add_filter(NonnullOwnPtr<Operator> input, Vector<AST::Expression const*> const& conjuncts, size_t offset) const
+{
+    for (auto* conjunct : conjuncts) {
+        auto predicate_or_error = compile(*conjunct, offset);
+        if (predicate_or_error.is_error())
+            return predicate_or_error.release_error();
+        input = make<Filter>(move(input), predicate_or_error.release_value());
+    }
+    return input;
+}
+
+Result<NonnullOwnPtr<Operator>, String> Planner::plan_aggregate(NonnullOwnPtr<Operator> input, AST::Select const& select, Vector<AST::Expression const*> const& ordering_expressions)
+{
+    Vector<AST::FunctionCallExpression const*> calls;
+    for (auto const& result_column : select.result_column_list()) {
+        if (result_column.select_from_expression())
+            collect_aggregate_calls(*result_column.expression(), calls);
+    }
+    auto const& group_by_clause = select.group_by_clause();
+    if (!group_by_clause.is_null() && !group_by_clause->having_clause().is_null())
+        collect_aggregate_calls(*group_by_clause->having_clause(), calls);
+    for (auto* expression : ordering_expressions)
+        collect_aggregate_calls(*expression, calls);
+
+    if (calls.is_empty() && group_by_clause.is_null())
+        return input;
+
+    for (auto const& result_column : select.result_column_list()) {
+        if (!result_column.select_from_expression())
+            return String { "Cannot select all columns from an aggregate query" };
+    }
+
+    Vector<Column> scope;
+    Vector<Evaluator> group_keys;
+    Vector<Aggregate::AggregateColumn> aggregates;
+    HashMap<AST::Expression const*, size_t> computed_expressions;
+
+    if (!group_by_clause.is_null()) {
+        for (auto const& group_by_expression : group_by_clause->group_by_list()) {
+            auto evaluator_or_error = compile(group_by_expression, 0);
+            if (evaluator_or_error.is_error())
+                return evaluator_or_error.release_error();
+            group_keys.append(evaluator_or_error.release_value());
+
+            // Grouped columns can still be referred to by their name after aggregation.
+            if (is<AST::ColumnNameExpression>(group_by_expression)) {
+                auto position = resolve_column(static_cast<AST::ColumnNameExpression const&>(group_by_expression)).release_value();
+                scope.append(m_scope[position]);
+            } else {
+                scope.append({});
+            }
+            computed_expressions.set(&group_by_expression, scope.size() - 1);
+        }
+    }
+
+    for (auto* call : calls) {
+        // An ORDER BY term referring to a result column by position or alias is the same expression again.
+        if (computed_expressions.contains(call))
+            continue;
+        auto function = Aggregate::function_for_name(call->name()).value();
+        Optional<Evaluator> argument;
+        if (call->select_all_arguments()) {
+            if (function != AggregateFunction::Count)
+                return String::formatted("{}(*) is not supported", call->name());
+        } else {
+            if (call->arguments().size() != 1)
+                return String::formatted("Aggregate function '{}' takes exactly one argument", call->name());
+            auto argument_or_error = compile(call->arguments().first(), 0);
+            if (argument_or_error.is_error())
+                return argument_or_error.release_error();
+            argument = argument_or_error.release_value();
+        }
+        aggregates.append({ function, move(argument), call->distinct() });
+        scope.append({});
+        computed_expressions.set(call, scope.size() - 1);
+    }
+
+    NonnullOwnPtr<Operator> aggregate = make<Aggregate>(move(input), move(group_keys), move(aggregates));
+    m_scope = move(scope);
+    m_computed_expressions = move(computed_expressions);
+
+    if (!group_by_clause.is_null() && !group_by_clause->having_clause().is_null())
+        return add_filter(move(aggregate), { group_by_clause->having_clause().ptr() }, 0);
+    return aggregate;
+}
+
+Result<NonnullOwnPtr<Operator>, String> Planner::plan(AST::Select const& select)
+{
+    m_scope.clear();
+    m_table_offsets.clear();
+    m_computed_expressions.clear();
+
+    if (!select.common_table_expression_list().is_null())
+        return String { "Common table expressions are not supported" };
+
+    NonnullRefPtrVector<TableDef> tables;
+    for (auto const& table_or_subquery : select.table_or_subquery_list()) {
+        if (!table_or_subquery.is_table())
+            return String { "Subqueries are not supported" };
+
+        auto schema_name = table_or_subquery.schema_name().is_empty() ? String("default") : table_or_subquery.schema_name();
+        auto table = m_database.get_table(schema_name, table_or_subquery.table_name());
+        if (!table)
+            return String::formatted("Table '{}' does not exist", table_or_subquery.table_name());
+
+        auto table_name = table_or_subquery.table_alias().is_empty() ? table_or_subquery.table_name() : table_or_subquery.table_alias();
+        m_table_offsets.append(m_scope.size());
+        for (auto& column : table->columns())
+            m_scope.append({ schema_name, table_name, column.name(), column.type(), tables.size() });
+        tables.append(table.release_nonnull());
+    }
+
+    // Split the WHERE clause into the conjuncts that can be evaluated on the rows of a single table,
+    // and the ones which have to wait until the tables they refer to are joined.
+    Vector<Vector<AST::Expression const*>> table_conjuncts;
+    table_conjuncts.resize(max<size_t>(tables.size(), 1));
+    Vector<AST::Expression const*> join_conjuncts;
+    Vector<Vector<size_t>> join_conjunct_tables;
+
+    if (!select.where_clause().is_null()) {
+        Vector<AST::Expression const*> conjuncts;
+        split_conjuncts(*select.where_clause(), conjuncts);
+        for (auto* conjunct : conjuncts) {
+            auto tables_or_error = referenced_tables(*conjunct);
+            if (tables_or_error.is_error())
+                return tables_or_error.release_error();
+            auto referenced = tables_or_error.release_value();
+            if (referenced.size() <= 1) {
+                table_conjuncts[referenced.is_empty() ? 0 : referenced.first()].append(conjunct);
+            } else {
+                join_conjuncts.append(conjunct);
+                join_conjunct_tables.append(move(referenced));
+            }
+        }
+    }
+
+    auto access_path_for_table = [&](size_t table_index) -> Result<NonnullOwnPtr<Operator>, String> {
+        auto conjuncts = table_conjuncts[table_index];
+        auto access_path = choose_access_path(tables[table_index], table_index, conjuncts);
+        conjuncts.remove_all_matching([&](auto* conjunct) { return access_path.conjuncts.contains_slow(conjunct); });
+        return add_filter(move(access_path.scan), conjuncts, m_table_offsets[table_index]);
+    };
+
+    NonnullOwnPtr<Operator> plan = make<SingleRow>();
+    if (tables.is_empty()) {
+        auto plan_or_error = add_filter(move(plan), table_conjuncts[0], 0);
+        if (plan_or_error.is_error())
+            return plan_or_error.release_error();
+        plan = plan_or_error.release_value();
+    } else {
+        auto plan_or_error = access_path_for_table(0);
+        if (plan_or_error.is_error())
+            return plan_or_error.release_error();
+        plan = plan_or_error.release_value();
+    }
+
+    for (size_t table_index = 1; table_index < tables.size(); table_index++) {
+        auto right_or_error = access_path_for_table(table_index);
+        if (right_or_error.is_error())
+            return right_or_error.release_error();
+
+        // All join conjuncts which only refer to tables joined so far can be evaluated now.
+        Vector<AST::Expression const*> applicable_conjuncts;
+        for (size_t ix = 0; ix < join_conjuncts.size(); ix++) {
+            if (!join_conjunct_tables[ix].contains_slow(table_index))
+                continue;
+            bool applicable = true;
+            for (auto referenced_table : join_conjunct_tables[ix])
+                applicable &= referenced_table <= table_index;
+            if (applicable)
+                applicable_conjuncts.append(join_conjuncts[ix]);
+        }
+
+        // Equality predicates between the new table and the tables to its left become hash join keys.
+        Vector<Evaluator> left_keys;
+        Vector<Evaluator> right_keys;
+        Vector<AST::Expression const*> remaining_conjuncts;
+        for (auto* conjunct : applicable_conjuncts) {
+            auto is_hash_key = [&]() -> bool {
+                if (!is<AST::BinaryOperatorExpression>(*conjunct))
+                    return false;
+                auto const& binary_expression = static_cast<AST::BinaryOperatorExpression const&>(*conjunct);
+                if (binary_expression.type() != AST::BinaryOperator::Equals)
+                    return false;
+
+                auto lhs_tables = referenced_tables(*binary_expression.lhs()).release_value();
+                auto rhs_tables = referenced_tables(*binary_expression.rhs()).release_value();
+                auto const* left_side = binary_expression.lhs().ptr();
+                auto const* right_side = binary_expression.rhs().ptr();
+                if (lhs_tables.size() == 1 && lhs_tables.first() == table_index) {
+                    swap(lhs_tables, rhs_tables);
+                    swap(left_side, right_side);
+                }
+                if (rhs_tables.size() != 1 || rhs_tables.first() != table_index || lhs_tables.is_empty() || lhs_tables.contains_slow(table_index))
+                    return false;
+
+                // hash_values() only finds equal values of the same type category.
+                auto left_type = static_type(*left_side);
+                auto right_type = static_type(*right_side);
+                if (!left_type.has_value() || !right_type.has_value() || is_numeric(left_type.value()) != is_numeric(right_type.value()))
+                    return false;
+
+                left_keys.append(compile(*left_side, 0).release_value());
+                right_keys.append(compile(*right_side, m_table_offsets[table_index]).release_value());
+                return true;
+            };
+            if (!is_hash_key())
+                remaining_conjuncts.append(conjunct);
+        }
+
+        if (!left_keys.is_empty()) {
+            plan = make<HashJoin>(move(plan), right_or_error.release_value(), move(left_keys), move(right_keys));
+            auto plan_or_error = add_filter(move(plan), remaining_conjuncts, 0);
+            if (plan_or_error.is_error())
+                return plan_or_error.release_error();
+            plan = plan_or_error.release_value();
+            continue;
+        }
+
+        Optional<Evaluator> predicate;
+        for (auto* conjunct : remaining_conjuncts) {
+            auto evaluator_or_error = compile(*conjunct, 0);
+            if (evaluator_or_error.is_error())
+                return evaluator_or_error.release_error();
+            if (!predicate.has_value()) {
+                predicate = evaluator_or_error.release_value();
+                continue;
+            }
+            predicate = Evaluator { [lhs = predicate.release_value(), rhs = evaluator_or_error.release_value()](Tuple const& row) {
+                return boolean_value(is_true(lhs(row)) && is_true(rhs(row)));
+            } };
+        }
+        plan = make<NestedLoopJoin>(move(plan), right_or_error.release_value(), move(predicate));
+    }
+
+    // ORDER BY terms may refer to result columns by their alias or by their position.
+    Vector<AST::Expression const*> ordering_expressions;
+    for (auto const& ordering_term : select.ordering_term_list()) {
+        auto const* expression = ordering_term.expression().ptr();
+        if (is<AST::NumericLiteral>(*expression)) {
+            auto position = static_cast<AST::NumericLiteral const&>(*expression).value();
+            if (position < 1 || position > select.result_column_list().size() || position != trunc(position))
+                return String::formatted("ORDER BY term {} does not match any result column", position);
+            auto const& result_column = select.result_column_list()[static_cast<size_t>(position) - 1];
+            if (!result_column.select_from_expression())
+                return String::formatted("ORDER BY term {} does not match any result column", position);
+            expression = result_column.expression().ptr();
+        } else if (is<AST::ColumnNameExpression>(*expression)) {
+            auto const& column_name_expression = static_cast<AST::ColumnNameExpression const&>(*expression);
+            if (column_name_expression.table_name().is_empty()) {
+                for (auto const& result_column : select.result_column_list()) {
+                    if (result_column.select_from_expression() && result_column.column_alias().equals_ignoring_case(column_name_expression.column_name())) {
+                        expression = result_column.expression().ptr();
+                        break;
+                    }
+                }
+            }
+        }
+        ordering_expressions.append(expression);
+    }
+
+    auto plan_or_error = plan_aggregate(move(plan), select, ordering_expressions);
+    if (plan_or_error.is_error())
+        return plan_or_error.release_error();
+    plan = plan_or_error.release_value();
+
+    if (!ordering_expressions.is_empty()) {
+        Vector<Sort::SortKey> keys;
+        for (size_t ix = 0; ix < ordering_expressions.size(); ix++) {
+            auto evaluator_or_error = compile(*ordering_expressions[ix], 0);
+            if (evaluator_or_error.is_error())
+                return evaluator_or_error.release_error();
+            auto const& ordering_term = select.ordering_term_list()[ix];
+            keys.append({ evaluator_or_error.release_value(), ordering_term.order(), ordering_term.nulls() });
+        }
+        plan = make<Sort>(move(plan), move(keys));
+    }
+
+    Vector<Evaluator> columns;
+    for (auto const& result_column : select.result_column_list()) {
+        if (result_column.select_from_expression()) {
+            auto evaluator_or_error = compile(*result_column.expression(), 0);
+            if (evaluator_or_error.is_error())
+                return evaluator_or_error.release_error();
+            columns.append(evaluator_or_error.release_value());
+            continue;
+        }
+
+        bool found_table = false;
+        for (size_t position = 0; position < m_scope.size(); position++) {
+            if (result_column.select_from_table() && !m_scope[position].table_name.equals_ignoring_case(result_column.table_name()))
+                continue;
+            found_table = true;
+            columns.append([position](Tuple const& row) { return row[position]; });
+        }
+        if (result_column.select_from_table() && !found_table)
+            return String::formatted("Table '{}' does not exist", result_column.table_name());
+    }
+    plan = make<Projection>(move(plan), move(columns));
+
+    if (!select.select_all())
+        plan = make<Distinct>(move(plan));
+
+    if (auto const& limit_clause = select.limit_clause(); !limit_clause.is_null()) {
+        m_scope.clear();
+        m_computed_expressions.clear();
+
+        auto limit_or_error = evaluate_constant(*limit_clause->limit_expression());
+        if (limit_or_error.is_error())
+            return limit_or_error.release_error();
+        Optional<size_t> limit;
+        if (auto limit_value = numeric_value(limit_or_error.value()); limit_value.has_value() && limit_value.value() >= 0)
+            limit = static_cast<size_t>(limit_value.value());
+
+        size_t offset = 0;
+        if (!limit_clause->offset_expression().is_null()) {
+            auto offset_or_error = evaluate_constant(*limit_clause->offset_expression());
+            if (offset_or_error.is_error())
+                return offset_or_error.release_error();
+            offset = static_cast<size_t>(max(0.0, numeric_value(offset_or_error.value()).value_or(0)));
+        }
+        plan = make<Limit>(move(plan), limit, offset);
+    }
+
+    dbgln_if(SQL_DEBUG, "Query plan:\n{}", plan->to_string());
+    return plan;
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Result.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Operator.h>
+#include <LibSQL/Type.h>
+
+namespace SQL {
+
+// Turns a SELECT statement into a tree of operators. Predicates in the WHERE clause are split at their
+// top-level ANDs and every conjunct is evaluated as early as possible: conjuncts referring to a single
+// table filter that table's rows before any join, and conjuncts of the form "column <op> literal" may be
+// answered by an index instead of a table scan, if the estimated cost of the index lookup is lower.
+// Tables are joined left-deep in the order in which they are listed, with a hash join if there are
+// equality predicates between the tables and a nested loop join otherwise.
+class Planner {
+public:
+    // Cost model, in units of sequentially reading one row. Fetching a row found through an index is a
+    // random read, which is assumed to be this many times as expensive as a sequential one.
+    static constexpr double random_fetch_cost = 4.0;
+    static constexpr double equality_selectivity = 0.1;
+    // Ranges over numbers are estimated from the smallest and largest key in the index. These are the guesses
+    // for ranges over other types, with one bound or with both.
+    static constexpr double range_selectivity = 1.0 / 3.0;
+    static constexpr double between_selectivity = 1.0 / 16.0;
+
+    explicit Planner(Database&);
+
+    Result<NonnullOwnPtr<Operator>, String> plan(AST::Select const&);
+
+private:
+    struct Column {
+        String schema_name;
+        String table_name; // The alias of the table, if it has one.
+        String column_name;
+        SQLType type { SQLType::Text };
+        size_t table_index { 0 };
+    };
+
+    struct AccessPath {
+        NonnullOwnPtr<Operator> scan;
+        double cost { 0 };
+        Vector<AST::Expression const*> conjuncts; // The conjuncts which the scan already guarantees to hold.
+    };
+
+    Result<size_t, String> resolve_column(AST::ColumnNameExpression const&) const;
+    Result<Vector<size_t>, String> referenced_tables(AST::Expression const&) const;
+    Optional<SQLType> static_type(AST::Expression const&) const;
+    Result<Value, String> evaluate_constant(AST::Expression const&) const;
+
+    // Compiles an expression which is evaluated on tuples that start at the given position of the scope.
+    Result<Evaluator, String> compile(AST::Expression const&, size_t offset) const;
+
+    AccessPath choose_access_path(NonnullRefPtr<TableDef> const&, size_t table_index, Vector<AST::Expression const*> const& conjuncts);
+    // The fraction of rows with a key between the bounds, assuming that the keys are spread evenly.
+    double estimate_range_selectivity(IndexDef&, Optional<IndexScan::Bound> const& lower_bound, Optional<IndexScan::Bound> const& upper_bound);
+    Result<NonnullOwnPtr<Operator>, String> add_filter(NonnullOwnPtr<Operator>, Vector<AST::Expression const*> const& conjuncts, size_t offset) const;
+    Result<NonnullOwnPtr<Operator>, String> plan_aggregate(NonnullOwnPtr<Operator>, AST::Select const&, Vector<AST::Expression const*> const& ordering_expressions);
+
+    Database& m_database;
+
+    // The columns of the tuples flowing through the plan. Until aggregation, these are the columns of all
+    // tables in the FROM clause, and each table's columns start at its offset.
+    Vector<Column> m_scope;
+    Vector<size_t> m_table_offsets;
+
+    // Expressions which have already been computed by an earlier operator (aggregates and GROUP BY terms),
+    // mapped to their position in the input tuple.
+    HashMap<AST::Expression const*, size_t> m_computed_expressions;
+};
+
+}
@@ -7,6 +7,7 @@
 #include <AK/Debug.h>
 #include <AK/Format.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/NumericLimits.h>
 #include <AK/StringBuilder.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Serialize.h>
@@ -114,19 +115,41 @@ TreeNode::TreeNode(BTree& tree, TreeNode* up, u32 pointer, ByteBuffer& buffer, s
     deserialize_from<u32>(buffer, at_offset, nodes);
     dbgln_if(SQL_DEBUG, "Deserializing node. Size {}", nodes);
     if (nodes > 0) {
+        u8 is_leaf;
+        deserialize_from<u8>(buffer, at_offset, is_leaf);
+        m_is_leaf = is_leaf != 0;
+
+        auto value_length = m_tree.descriptor().data_length() - sizeof(u32);
+        ByteBuffer previous;
         for (u32 i = 0; i < nodes; i++) {
-            u32 left;
-            deserialize_from<u32>(buffer, at_offset, left);
+            u32 left = 0;
+            if (!m_is_leaf)
+                deserialize_from<u32>(buffer, at_offset, left);
             dbgln_if(SQL_DEBUG, "Down[{}] {}", i, left);
-            if (!m_down.is_empty())
-                VERIFY((left == 0) == m_is_leaf);
-            else
-                m_is_leaf = (left == 0);
-            m_entries.append(Key(m_tree.descriptor(), buffer, at_offset));
+            VERIFY((left == 0) == m_is_leaf);
+
+            u32 key_pointer;
+            deserialize_from<u32>(buffer, at_offset, key_pointer);
+            auto shared = deserialize_length(buffer, at_offset);
+            auto suffix_length = deserialize_length(buffer, at_offset);
+            VERIFY(shared <= previous.size() && shared + suffix_length <= value_length);
+
+            // Reassemble the full serialized key: the prefix shared with the previous key, the stored
+            // suffix, and the trailing zeroes that were left out.
+            auto key_buffer = ByteBuffer::create_zeroed(sizeof(u32) + value_length);
+            key_buffer.overwrite(0, &key_pointer, sizeof(u32));
+            key_buffer.overwrite(sizeof(u32), previous.data(), shared);
+            key_buffer.overwrite(sizeof(u32) + shared, buffer.offset_pointer(at_offset), suffix_length);
+            at_offset += suffix_length;
+
+            size_t key_offset = 0;
+            m_entries.append(Key(m_tree.descriptor(), key_buffer, key_offset));
             m_down.empend(this, left);
+            previous = key_buffer.slice(sizeof(u32), value_length);
         }
-        u32 right;
-        deserialize_from<u32>(buffer, at_offset, right);
+        u32 right = 0;
+        if (!m_is_leaf)
+            deserialize_from<u32>(buffer, at_offset, right);
         dbgln_if(SQL_DEBUG, "Right {}", right);
         VERIFY((right == 0) == m_is_leaf);
         m_down.empend(this, right);
@@ -179,14 +202,19 @@ bool TreeNode::insert_in_leaf(Key const& key)
     return true;
 }
 
+// The number of keys which fit in a node even if none of them can be compressed. Nodes with more keys
+// than this have to be measured to find out whether they still fit in a block.
 size_t TreeNode::max_keys_in_node()
 {
-    auto descriptor = m_tree.descriptor();
-    auto key_size = descriptor.data_length() + sizeof(u32);
-    auto ret = (BLOCKSIZE - 2 * sizeof(u32)) / key_size;
-    if ((ret % 2) == 0)
-        --ret;
-    return ret;
+    auto value_length = m_tree.descriptor().data_length() - sizeof(u32);
+    auto max_entry_length = encoded_key_length(value_length, value_length) + (is_leaf() ? 0 : sizeof(u32));
+    auto header_length = sizeof(u32) + sizeof(u8) + (is_leaf() ? 0 : sizeof(u32));
+    return (BLOCKSIZE - header_length) / max_entry_length;
+}
+
+bool TreeNode::is_overfull()
+{
+    return size() > max_keys_in_node() && serialized_length() > BLOCKSIZE;
 }
 
 Key const& TreeNode::operator[](size_t ix) const
@@ -263,20 +291,112 @@ Optional<u32> TreeNode::get(Key& key)
     return down_node(size())->get(key);
 }
 
+// Keys are stored in the order they sort in, so neighbouring keys tend to start with the same bytes.
+// Each key is stored as the number of leading bytes it shares with the previous key in the node,
+// followed by the rest of its serialized bytes with any trailing zeroes stripped. This mostly removes
+// the padding of text values and the common prefixes of keys which only differ in their last parts.
+ByteBuffer TreeNode::key_bytes(Key const& key)
+{
+    ByteBuffer buffer;
+    for (size_t ix = 0; ix < key.length(); ix++)
+        key[ix].serialize(buffer);
+    return buffer;
+}
+
+size_t TreeNode::shared_prefix_length(ReadonlyBytes previous, ReadonlyBytes key)
+{
+    size_t shared = 0;
+    while (shared < previous.size() && shared < key.size() && previous[shared] == key[shared])
+        shared++;
+    return shared;
+}
+
+size_t TreeNode::suffix_length(ReadonlyBytes key, size_t shared)
+{
+    auto end = key.size();
+    while (end > shared && key[end - 1] == 0)
+        end--;
+    return end - shared;
+}
+
+size_t TreeNode::encoded_key_length(size_t shared, size_t suffix_length)
+{
+    auto length_of_length = [](size_t length) { return (length < 0xFF) ? sizeof(u8) : sizeof(u8) + sizeof(u16); };
+    return sizeof(u32) + length_of_length(shared) + length_of_length(suffix_length) + suffix_length;
+}
+
+size_t TreeNode::encoded_key_length(ReadonlyBytes previous, ReadonlyBytes key)
+{
+    auto shared = shared_prefix_length(previous, key);
+    return encoded_key_length(shared, suffix_length(key, shared));
+}
+
+void TreeNode::serialize_length(ByteBuffer& buffer, size_t length)
+{
+    VERIFY(length <= NumericLimits<u16>::max());
+    if (length < 0xFF) {
+        serialize_to<u8>(buffer, length);
+        return;
+    }
+    serialize_to<u8>(buffer, 0xFF);
+    serialize_to<u16>(buffer, length);
+}
+
+size_t TreeNode::deserialize_length(ByteBuffer& buffer, size_t& at_offset)
+{
+    u8 length;
+    deserialize_from<u8>(buffer, at_offset, length);
+    if (length < 0xFF)
+        return length;
+    u16 long_length;
+    deserialize_from<u16>(buffer, at_offset, long_length);
+    return long_length;
+}
+
+size_t TreeNode::serialized_length() const
+{
+    size_t length = sizeof(u32);
+    if (size() == 0)
+        return length;
+    length += sizeof(u8) + (is_leaf() ? 0 : sizeof(u32));
+    ByteBuffer previous;
+    for (auto& entry : m_entries) {
+        auto bytes = key_bytes(entry);
+        length += encoded_key_length(previous, bytes) + (is_leaf() ? 0 : sizeof(u32));
+        previous = move(bytes);
+    }
+    return length;
+}
+
 void TreeNode::serialize(ByteBuffer& buffer) const
 {
     u32 sz = size();
     serialize_to<u32>(buffer, sz);
     if (sz > 0) {
+        serialize_to<u8>(buffer, is_leaf() ? 1 : 0);
+        ByteBuffer previous;
         for (auto ix = 0u; ix < size(); ix++) {
             auto& entry = m_entries[ix];
-            dbgln_if(SQL_DEBUG, "Serializing Left[{}] = {}", ix, m_down[ix].pointer());
-            serialize_to<u32>(buffer, is_leaf() ? 0u : m_down[ix].pointer());
-            entry.serialize(buffer);
+            if (!is_leaf()) {
+                dbgln_if(SQL_DEBUG, "Serializing Left[{}] = {}", ix, m_down[ix].pointer());
+                serialize_to<u32>(buffer, m_down[ix].pointer());
+            }
+
+            auto bytes = key_bytes(entry);
+            auto shared = shared_prefix_length(previous, bytes);
+            auto suffix = suffix_length(bytes, shared);
+            serialize_to<u32>(buffer, entry.pointer());
+            serialize_length(buffer, shared);
+            serialize_length(buffer, suffix);
+            buffer.append(bytes.offset_pointer(shared), suffix);
+            previous = move(bytes);
+        }
+        if (!is_leaf()) {
+            dbgln_if(SQL_DEBUG, "Serializing Right = {}", m_down[size()].pointer());
+            serialize_to<u32>(buffer, m_down[size()].pointer());
         }
-        dbgln_if(SQL_DEBUG, "Serializing Right = {}", m_down[size()].pointer());
-        serialize_to<u32>(buffer, is_leaf() ? 0u : m_down[size()].pointer());
     }
+    VERIFY(buffer.size() <= BLOCKSIZE);
 }
 
 void TreeNode::just_insert(Key const& key, TreeNode* right)
@@ -289,7 +409,7 @@ void TreeNode::just_insert(Key const& key, TreeNode* right)
             m_entries.insert(ix, key);
             VERIFY(is_leaf() == (right == nullptr));
             m_down.insert(ix + 1, DownPointer(this, right));
-            if (size() > max_keys_in_node()) {
+            if (is_overfull()) {
                 split();
             } else {
                 dump_if(SQL_DEBUG, "To WAL");
@@ -301,7 +421,7 @@ void TreeNode::just_insert(Key const& key, TreeNode* right)
     m_entries.append(key);
     m_down.empend(this, right);
 
-    if (size() > max_keys_in_node()) {
+    if (is_overfull()) {
         split();
     } else {
         dump_if(SQL_DEBUG, "To WAL");
@@ -316,16 +436,34 @@ void TreeNode::split()
         // Make new m_up. This is the new root node.
         m_up = m_tree.new_root();
 
+    VERIFY(size() >= 3);
+
+    // Keys are compressed, so they don't all take the same space. Split at the key where the first
+    // half of the node's bytes end, so that both halves are guaranteed to fit in a block.
+    size_t total_length = 0;
+    Vector<size_t> entry_lengths;
+    ByteBuffer previous;
+    for (auto& entry : m_entries) {
+        auto bytes = key_bytes(entry);
+        entry_lengths.append(encoded_key_length(previous, bytes));
+        total_length += entry_lengths.last();
+        previous = move(bytes);
+    }
+    size_t median_index = 0;
+    for (size_t length = 0; median_index < size() - 2 && length + entry_lengths[median_index] < total_length / 2; median_index++)
+        length += entry_lengths[median_index];
+    median_index = max(median_index, (size_t)1);
+
     // Take the left pointer for the new node:
-    DownPointer left = m_down.take(max_keys_in_node() / 2 + 1);
+    DownPointer left = m_down.take(median_index + 1);
 
     // Create the new right node:
     auto* new_node = new TreeNode(tree(), m_up, left);
 
     // Move the rightmost keys from this node to the new right node:
-    while (m_entries.size() > max_keys_in_node() / 2 + 1) {
-        auto entry = m_entries.take(max_keys_in_node() / 2 + 1);
-        auto down = m_down.take(max_keys_in_node() / 2 + 1);
+    while (m_entries.size() > median_index + 1) {
+        auto entry = m_entries.take(median_index + 1);
+        auto down = m_down.take(median_index + 1);
 
         // Reparent to new right node:
         if (down.m_node != nullptr) {
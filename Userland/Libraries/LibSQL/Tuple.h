@@ -36,9 +36,11 @@ public:
     Tuple(TupleDescriptor const&, ByteBuffer&, size_t&);
     Tuple(TupleDescriptor const&, ByteBuffer&);
     Tuple(Tuple const&);
+    Tuple(Tuple&&) = default;
     virtual ~Tuple() = default;
 
     Tuple& operator=(Tuple const&);
+    Tuple& operator=(Tuple&&) = default;
 
     [[nodiscard]] String to_string() const;
     explicit operator String() const { return to_string(); }
@@ -65,7 +67,7 @@ public:
     void set_pointer(u32 ptr) { m_pointer = ptr; }
 
     [[nodiscard]] size_t size() const;
-    [[nodiscard]] size_t length() const { return m_descriptor.size(); }
+    [[nodiscard]] size_t length() const { return m_data.size(); }
     [[nodiscard]] TupleDescriptor descriptor() const { return m_descriptor; }
     [[nodiscard]] int compare(Tuple const&) const;
     [[nodiscard]] int match(Tuple const&) const;
@@ -396,7 +396,9 @@ void Value::setup_float()
             return 1;
         }
         auto diff = m_impl.get<double>() - casted.value();
-        return (diff < NumericLimits<double>::epsilon()) ? 0 : ((diff > 0) ? 1 : -1);
+        if (diff > -NumericLimits<double>::epsilon() && diff < NumericLimits<double>::epsilon())
+            return 0;
+        return (diff > 0) ? 1 : -1;
     };
 
     m_can_cast = [](Value const& other) -> bool {
@@ -34,7 +34,6 @@ void Threading::Thread::start()
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
             auto exit_code = self->m_action();
-            self->m_tid = 0;
             return reinterpret_cast<void*>(exit_code);
         },
         static_cast<void*>(this));
@@ -7,11 +7,104 @@
 #include <LibWasm/AbstractMachine/AbstractMachine.h>
 #include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/AbstractMachine/IRInterpreter.h>
 #include <LibWasm/AbstractMachine/Interpreter.h>
+#include <LibWasm/AbstractMachine/NativeInterpreter.h>
 #include <LibWasm/Types.h>
+#include <sys/mman.h>
 
 namespace Wasm {
 
+// Enough address space for a 32-bit address plus a 32-bit offset plus the size of the largest access.
+static constexpr u64 guarded_reservation_size = 8 * GiB + Constants::page_size;
+
+static constexpr bool guard_regions_are_supported()
+{
+#if defined(__serenity__)
+    // Page faults in userspace crash the process instead of raising a signal it could handle.
+    return false;
+#else
+    return sizeof(FlatPtr) == sizeof(u64);
+#endif
+}
+
+// Memory is mapped with mmap, so that growing it only makes more of the reserved pages accessible. Where faults
+// can be handled, the reservation covers every address a load or store can compute; otherwise it covers the
+// declared maximum if possible, and the memory has to be moved if it grows past that.
+MemoryInstance::MemoryInstance(MemoryType const& type)
+    : m_type(type)
+{
+    if constexpr (guard_regions_are_supported())
+        m_has_guard_region = reserve(guarded_reservation_size);
+    if (!m_has_guard_region) {
+        auto pages = static_cast<size_t>(m_type.limits().max().value_or(m_type.limits().min()));
+        if (!reserve(pages * Constants::page_size))
+            reserve(m_type.limits().min() * Constants::page_size);
+    }
+    grow(m_type.limits().min() * Constants::page_size);
+}
+
+MemoryInstance::MemoryInstance(MemoryInstance&& other)
+    : on_grow(move(other.on_grow))
+    , m_type(other.m_type)
+    , m_data(exchange(other.m_data, nullptr))
+    , m_size(exchange(other.m_size, 0))
+    , m_reserved_size(exchange(other.m_reserved_size, 0))
+    , m_has_guard_region(exchange(other.m_has_guard_region, false))
+{
+}
+
+MemoryInstance::~MemoryInstance()
+{
+    if (m_data)
+        munmap(m_data, m_reserved_size);
+}
+
+// Maps a new inaccessible range and moves the contents of the memory there.
+bool MemoryInstance::reserve(size_t size)
+{
+    if (size == 0)
+        return false;
+    auto* mapping = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED)
+        return false;
+    auto* data = static_cast<u8*>(mapping);
+    if (m_size != 0) {
+        if (mprotect(data, m_size, PROT_READ | PROT_WRITE) < 0) {
+            munmap(mapping, size);
+            return false;
+        }
+        __builtin_memcpy(data, m_data, m_size);
+    }
+    if (m_data)
+        munmap(m_data, m_reserved_size);
+    m_data = data;
+    m_reserved_size = size;
+    return true;
+}
+
+bool MemoryInstance::grow(size_t size_to_grow)
+{
+    if (size_to_grow == 0)
+        return true;
+    auto new_size = m_size + size_to_grow;
+    auto maximum_size = static_cast<u64>(m_type.limits().max().value_or(Constants::max_memory_pages)) * Constants::page_size;
+    if (new_size > maximum_size)
+        return false;
+    if (new_size > m_reserved_size) {
+        VERIFY(!m_has_guard_region);
+        if (!reserve(min(max(new_size, m_reserved_size * 2), maximum_size)) && !reserve(new_size))
+            return false;
+    }
+    // The spec requires the new pages to be zeroed, which pages that have never been accessible already are.
+    if (mprotect(m_data + m_size, size_to_grow, PROT_READ | PROT_WRITE) < 0)
+        return false;
+    m_size = new_size;
+    if (on_grow)
+        on_grow();
+    return true;
+}
+
 Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Function const& function)
 {
     FunctionAddress address { m_functions.size() };
@@ -100,6 +193,28 @@ ElementInstance* Store::get(ElementAddress address)
     return &m_elements[value];
 }
 
+AbstractMachine::AbstractMachine() = default;
+
+AbstractMachine::~AbstractMachine() = default;
+
+void AbstractMachine::set_execution_engine(ExecutionEngine engine)
+{
+    if (engine == m_execution_engine)
+        return;
+    m_execution_engine = engine;
+    switch (engine) {
+    case ExecutionEngine::Interpreter:
+        m_interpreter = nullptr;
+        break;
+    case ExecutionEngine::IRInterpreter:
+        m_interpreter = make<IRInterpreter>();
+        break;
+    case ExecutionEngine::NativeCompiler:
+        m_interpreter = make<NativeInterpreter>();
+        break;
+    }
+}
+
 InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<ExternValue> externs)
 {
     auto main_module_instance_pointer = make<ModuleInstance>();
@@ -148,6 +263,11 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
     if (auto result = allocate_all_initial_phase(module, main_module_instance, externs, global_values); result.has_value())
         return result.release_value();
 
+    // Function bodies may reuse the addresses of bodies of modules which have since been destroyed, so this has to
+    // happen for every instantiation to replace any stale code.
+    if (m_interpreter)
+        m_interpreter->compile(main_module_instance, m_store);
+
     module.for_each_section_of_type<ElementSection>([&](ElementSection const& section) {
         for (auto& segment : section.segments()) {
             Vector<Reference> references;
@@ -285,12 +405,14 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                     }
                     auto address = main_module_instance.memories()[data.index.value()];
                     if (auto instance = m_store.get(address)) {
-                        if (instance->type().limits().max().value_or(data.init.size() + offset + 1) <= data.init.size() + offset) {
-                            instantiation_result = InstantiationError { String::formatted("Data segment attempted to write to out-of-bounds memory ({}) of max {} bytes", data.init.size() + offset, instance->type().limits().max().value()) };
+                        auto maximum_size = static_cast<u64>(instance->type().limits().max().value_or(Constants::max_memory_pages)) * Constants::page_size;
+                        if (maximum_size < data.init.size() + offset) {
+                            instantiation_result = InstantiationError { String::formatted("Data segment attempted to write to out-of-bounds memory ({}) of max {} bytes", data.init.size() + offset, maximum_size) };
                             return;
                         }
+                        // Memory only ever grows by whole pages.
                         if (instance->size() < data.init.size() + offset)
-                            instance->grow(data.init.size() + offset - instance->size());
+                            instance->grow(round_up_to_power_of_two(data.init.size() + offset - instance->size(), Constants::page_size));
                         instance->data().overwrite(offset, data.init.data(), data.init.size());
                     }
                 },
@@ -422,6 +544,8 @@ Optional<InstantiationError> AbstractMachine::allocate_all_final_phase(Module co
 
 Result AbstractMachine::invoke(FunctionAddress address, Vector<Value> arguments)
 {
+    if (m_interpreter)
+        return invoke(*m_interpreter, address, move(arguments));
     BytecodeInterpreter interpreter;
     return invoke(interpreter, address, move(arguments));
 }
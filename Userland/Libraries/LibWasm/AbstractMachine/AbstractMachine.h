@@ -9,6 +9,7 @@
 #include <AK/Function.h>
 #include <AK/HashMap.h>
 #include <AK/HashTable.h>
+#include <AK/Noncopyable.h>
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
 #include <LibWasm/Types.h>
@@ -16,6 +17,7 @@
 namespace Wasm {
 
 class Configuration;
+struct BytecodeInterpreter;
 struct Interpreter;
 
 struct InstantiationError {
@@ -333,37 +335,37 @@ private:
 };
 
 class MemoryInstance {
+    AK_MAKE_NONCOPYABLE(MemoryInstance);
+
 public:
-    explicit MemoryInstance(MemoryType const& type)
-        : m_type(type)
-    {
-        grow(m_type.limits().min() * Constants::page_size);
-    }
+    explicit MemoryInstance(MemoryType const& type);
+    MemoryInstance(MemoryInstance&&);
+    ~MemoryInstance();
 
     auto& type() const { return m_type; }
     auto size() const { return m_size; }
-    auto& data() const { return m_data; }
-    auto& data() { return m_data; }
+    Bytes data() { return { m_data, m_size }; }
+    ReadonlyBytes data() const { return { m_data, m_size }; }
 
-    bool grow(size_t size_to_grow)
-    {
-        if (size_to_grow == 0)
-            return true;
-        auto new_size = m_data.size() + size_to_grow;
-        if (m_type.limits().max().value_or(new_size) < new_size)
-            return false;
-        auto previous_size = m_size;
-        m_data.resize(new_size);
-        m_size = new_size;
-        // The spec requires that we zero out everything on grow
-        __builtin_memset(m_data.offset_pointer(previous_size), 0, size_to_grow);
-        return true;
-    }
+    // If true, every address a load or store can compute (a 32-bit address plus a 32-bit offset) lies within the
+    // mapping of this memory, and everything in it past size() is inaccessible. Out-of-bounds accesses then fault
+    // instead of having to be checked, see MemoryFaultScope.
+    bool has_guard_region() const { return m_has_guard_region; }
+    ReadonlyBytes reserved_region() const { return { m_data, m_reserved_size }; }
+
+    bool grow(size_t size_to_grow);
+
+    // Called whenever the memory has grown. Growing may move the memory, so views of data() have to be dropped.
+    Function<void()> on_grow;
 
 private:
+    bool reserve(size_t);
+
     MemoryType const& m_type;
+    u8* m_data { nullptr };
     size_t m_size { 0 };
-    ByteBuffer m_data;
+    size_t m_reserved_size { 0 };
+    bool m_has_guard_region { false };
 };
 
 class GlobalInstance {
@@ -488,9 +490,21 @@ private:
 
 using InstantiationResult = AK::Result<NonnullOwnPtr<ModuleInstance>, InstantiationError>;
 
+enum class ExecutionEngine {
+    Interpreter,
+    IRInterpreter,
+    NativeCompiler,
+};
+
 class AbstractMachine {
 public:
-    explicit AbstractMachine() = default;
+    explicit AbstractMachine();
+    ~AbstractMachine();
+
+    // Functions of modules instantiated after selecting another engine are translated to its representation where
+    // possible; invoke() then runs them with that engine, and everything else with the bytecode interpreter.
+    void set_execution_engine(ExecutionEngine);
+    auto execution_engine() const { return m_execution_engine; }
 
     // Load and instantiate a module, and link it into this interpreter.
     InstantiationResult instantiate(Module const&, Vector<ExternValue>);
@@ -504,6 +518,8 @@ private:
     Optional<InstantiationError> allocate_all_initial_phase(Module const&, ModuleInstance&, Vector<ExternValue>&, Vector<Value>& global_values);
     Optional<InstantiationError> allocate_all_final_phase(Module const&, ModuleInstance&, Vector<Vector<Reference>>& elements);
     Store m_store;
+    ExecutionEngine m_execution_engine { ExecutionEngine::Interpreter };
+    OwnPtr<BytecodeInterpreter> m_interpreter;
 };
 
 class Linker {
@@ -94,14 +94,15 @@ void BytecodeInterpreter::load_and_push(Configuration& configuration, Instructio
         m_trap = Trap { "Memory access out of bounds" };
         return;
     }
-    auto instance_address = base.value() + static_cast<i64>(arg.offset);
-    if (instance_address < 0 || static_cast<u64>(instance_address + sizeof(ReadType)) > memory->size()) {
+    // Addresses are unsigned, and the offset is added without wrapping around.
+    auto instance_address = static_cast<u64>(static_cast<u32>(base.value())) + arg.offset;
+    if (instance_address + sizeof(ReadType) > memory->size()) {
         m_trap = Trap { "Memory access out of bounds" };
         dbgln("LibWasm: Memory access out of bounds (expected 0 <= {} and {} <= {})", instance_address, instance_address + sizeof(ReadType), memory->size());
         return;
     }
     dbgln_if(WASM_TRACE_DEBUG, "load({} : {}) -> stack", instance_address, sizeof(ReadType));
-    auto slice = memory->data().bytes().slice(instance_address, sizeof(ReadType));
+    auto slice = memory->data().slice(instance_address, sizeof(ReadType));
     configuration.stack().peek() = Value(static_cast<PushType>(read_value<ReadType>(slice)));
 }
 
@@ -115,14 +116,15 @@ void BytecodeInterpreter::store_to_memory(Configuration& configuration, Instruct
     TRAP_IF_NOT(entry.has<Value>());
     auto base = entry.get<Value>().to<i32>();
     TRAP_IF_NOT(base.has_value());
-    auto instance_address = base.value() + static_cast<i64>(arg.offset);
-    if (instance_address < 0 || static_cast<u64>(instance_address + data.size()) > memory->size()) {
+    // Addresses are unsigned, and the offset is added without wrapping around.
+    auto instance_address = static_cast<u64>(static_cast<u32>(base.value())) + arg.offset;
+    if (instance_address + data.size() > memory->size()) {
         m_trap = Trap { "Memory access out of bounds" };
         dbgln("LibWasm: Memory access out of bounds (expected 0 <= {} and {} <= {})", instance_address, instance_address + data.size(), memory->size());
         return;
     }
     dbgln_if(WASM_TRACE_DEBUG, "tempoaray({}b) -> store({})", data.size(), instance_address);
-    data.copy_to(memory->data().bytes().slice(instance_address, data.size()));
+    data.copy_to(memory->data().slice(instance_address, data.size()));
 }
 
 void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAddress address)
@@ -853,7 +855,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_le.value():
         BINARY_NUMERIC_OPERATION(double, <=, i32);
     case Instructions::f64_ge.value():
-        BINARY_NUMERIC_OPERATION(double, >, i32);
+        BINARY_NUMERIC_OPERATION(double, >=, i32);
     case Instructions::i32_clz.value():
         UNARY_NUMERIC_OPERATION(i32, clz);
     case Instructions::i32_ctz.value():
@@ -937,7 +939,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f32_trunc.value():
         UNARY_NUMERIC_OPERATION(float, truncf);
     case Instructions::f32_nearest.value():
-        UNARY_NUMERIC_OPERATION(float, roundf);
+        UNARY_NUMERIC_OPERATION(float, nearbyintf);
     case Instructions::f32_sqrt.value():
         UNARY_NUMERIC_OPERATION(float, sqrtf);
     case Instructions::f32_add.value():
@@ -965,7 +967,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_trunc.value():
         UNARY_NUMERIC_OPERATION(double, trunc);
     case Instructions::f64_nearest.value():
-        UNARY_NUMERIC_OPERATION(double, round);
+        UNARY_NUMERIC_OPERATION(double, nearbyint);
     case Instructions::f64_sqrt.value():
         UNARY_NUMERIC_OPERATION(double, sqrt);
     case Instructions::f64_add.value():
@@ -18,6 +18,9 @@ struct BytecodeInterpreter : public Interpreter {
     virtual String trap_reason() const override { return m_trap.value().reason; }
     virtual void clear_trap() override { m_trap.clear(); }
 
+    // Called for every module instance created by the machine, so that functions can be translated ahead of time.
+    virtual void compile(ModuleInstance const&, Store&) { }
+
     struct CallFrameHandle {
         explicit CallFrameHandle(BytecodeInterpreter& interpreter, Configuration& configuration)
             : m_configuration_handle(configuration)
@@ -0,0 +1,652 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/AbstractMachine/IRInterpreter.h>
+#include <LibWasm/AbstractMachine/MemoryFaultScope.h>
+#include <LibWasm/AbstractMachine/Operators.h>
+#include <LibWasm/Compiler/NativeCompiler.h>
+
+namespace Wasm {
+
+using namespace Operators;
+
+void IRInterpreter::compile(ModuleInstance const& module, Store& store)
+{
+    for (auto address : module.functions()) {
+        auto* function = store.get(address);
+        if (!function || !function->has<WasmFunction>())
+            continue;
+        auto& wasm_function = function->get<WasmFunction>();
+        if (&wasm_function.module() != &module)
+            continue;
+        auto* body = &wasm_function.code().body();
+        if (auto lowered = IR::lower(store, module, wasm_function))
+            m_functions.set(body, lowered.release_nonnull());
+        else
+            m_functions.remove(body);
+    }
+}
+
+void IRInterpreter::interpret(Configuration& configuration)
+{
+    auto it = m_functions.find(&configuration.frame().expression());
+    if (it == m_functions.end())
+        return BytecodeInterpreter::interpret(configuration);
+
+    auto& function = *it->value;
+    m_trap.clear();
+
+    Vector<u64, 64> slots;
+    slots.resize(function.slot_count);
+    auto& locals = configuration.frame().locals();
+    for (size_t i = 0; i < locals.size(); ++i)
+        slots[i] = to_native_value(locals[i]);
+    for (size_t i = 0; i < function.constants.size(); ++i)
+        slots[function.local_count + i] = function.constants[i];
+
+    MemoryInstance* memory { nullptr };
+    if (!configuration.frame().module().memories().is_empty())
+        memory = configuration.store().get(configuration.frame().module().memories().first());
+    MemoryFaultScope fault_scope { memory };
+    if (sigsetjmp(fault_scope.recovery_point(), 0) != 0) {
+        m_trap = Trap { "Memory access out of bounds" };
+        return;
+    }
+
+    if (!execute(configuration, function, slots.data()))
+        return;
+
+    for (size_t i = 0; i < function.results.size(); ++i)
+        configuration.stack().push(from_native_value(function.results[i], slots[function.result_slot + i]));
+}
+
+static bool types_match(FunctionType const& lhs, FunctionType const& rhs)
+{
+    auto kinds_match = [](Vector<ValueType> const& a, Vector<ValueType> const& b) {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].kind() != b[i].kind())
+                return false;
+        }
+        return true;
+    };
+    return kinds_match(lhs.parameters(), rhs.parameters()) && kinds_match(lhs.results(), rhs.results());
+}
+
+bool IRInterpreter::call_address(Configuration& configuration, FunctionAddress address, u64* values)
+{
+    if (configuration.depth() > Constants::max_allowed_call_stack_depth) {
+        m_trap = Trap { "Exceeded maximum allowed call stack depth" };
+        return false;
+    }
+
+    auto* instance = configuration.store().get(address);
+    if (!instance) {
+        m_trap = Trap { "Call to a nonexistent function" };
+        return false;
+    }
+    FunctionType const* type { nullptr };
+    instance->visit([&](auto const& function) { type = &function.type(); });
+
+    Vector<Value> arguments;
+    arguments.ensure_capacity(type->parameters().size());
+    for (size_t i = 0; i < type->parameters().size(); ++i)
+        arguments.unchecked_append(from_native_value(type->parameters()[i], values[i]));
+
+    Result result { Trap { ""sv } };
+    {
+        CallFrameHandle handle { *this, configuration };
+        result = configuration.call(*this, address, move(arguments));
+    }
+
+    if (result.is_trap()) {
+        m_trap = move(result.trap());
+        return false;
+    }
+    if (result.values().size() != type->results().size()) {
+        m_trap = Trap { "Call returned an unexpected number of values" };
+        return false;
+    }
+    for (size_t i = 0; i < result.values().size(); ++i)
+        values[i] = to_native_value(result.values()[i]);
+    return true;
+}
+
+bool IRInterpreter::call_indirect(Configuration& configuration, Instruction::IndirectCallArgs const& arguments, u64* values)
+{
+    auto& module = configuration.frame().module();
+    auto& expected_type = module.types()[arguments.type.value()];
+
+    // The table index follows the arguments.
+    auto index = native_value_as<u32>(values[expected_type.parameters().size()]);
+    auto* table = configuration.store().get(module.tables()[arguments.table.value()]);
+    if (!table || index >= table->elements().size()) {
+        m_trap = Trap { "Indirect call to an element outside of the table" };
+        return false;
+    }
+    auto& element = table->elements()[index];
+    if (!element.has_value() || !element->ref().has<Reference::Func>()) {
+        m_trap = Trap { "Indirect call to an uninitialized element" };
+        return false;
+    }
+
+    auto address = element->ref().get<Reference::Func>().address;
+    auto* instance = configuration.store().get(address);
+    if (!instance) {
+        m_trap = Trap { "Call to a nonexistent function" };
+        return false;
+    }
+    if (!instance->visit([&](auto const& function) { return types_match(function.type(), expected_type); })) {
+        m_trap = Trap { "Indirect call type mismatch" };
+        return false;
+    }
+    return call_address(configuration, address, values);
+}
+
+bool IRInterpreter::execute(Configuration& configuration, IR::Function const& function, u64* slots)
+{
+    MemoryInstance* memory { nullptr };
+    if (!configuration.frame().module().memories().is_empty())
+        memory = configuration.store().get(configuration.frame().module().memories().first());
+
+    // Accesses to memory with a guard region are not checked, faults are handled by interpret() instead.
+    bool const check_bounds = memory && !memory->has_guard_region();
+
+    auto trap = [&](StringView reason) {
+        m_trap = Trap { reason };
+        return false;
+    };
+
+    auto* instructions = function.instructions.data();
+    i64 remaining_loop_iterations = Constants::max_allowed_executed_instructions_per_call;
+    size_t ip = 0;
+
+    for (;;) {
+        auto& instruction = instructions[ip++];
+
+        // Returns a pointer to the accessed bytes, or null if any of them are out of bounds.
+        auto memory_at = [&](size_t size) -> u8* {
+            u64 address = static_cast<u64>(static_cast<u32>(slots[instruction.lhs])) + instruction.immediate;
+            if (check_bounds && address + size > memory->size())
+                return nullptr;
+            return memory->data().data() + address;
+        };
+
+        // Jumping backwards is how loops repeat, so that is where the number of iterations is limited.
+        auto jump_to = [&](u64 target) {
+            if (target < ip && --remaining_loop_iterations < 0)
+                return false;
+            ip = target;
+            return true;
+        };
+
+#define LHS(T) native_value_as<T>(slots[instruction.lhs])
+#define RHS(T) native_value_as<T>(slots[instruction.rhs])
+#define RESULT(value) slots[instruction.destination] = native_value_from(value)
+
+#define UNARY(T, expression)      \
+    do {                          \
+        auto value = LHS(T);      \
+        RESULT((expression));     \
+    } while (false);              \
+    break
+#define BINARY(T, expression)     \
+    do {                          \
+        auto lhs = LHS(T);        \
+        auto rhs = RHS(T);        \
+        RESULT((expression));     \
+    } while (false);              \
+    break
+#define COMPARE(T, op) BINARY(T, static_cast<i32>(lhs op rhs))
+#define WRAPPING(T, op) BINARY(T, static_cast<T>(lhs op rhs))
+#define SHIFT(T, op) BINARY(T, static_cast<T>(lhs op(rhs & (sizeof(T) * 8 - 1))))
+#define ROTATE(T, op) BINARY(T, op(lhs, static_cast<unsigned>(rhs)))
+#define DIVIDE(T, op)                                                   \
+    do {                                                                \
+        auto lhs = LHS(T);                                              \
+        auto rhs = RHS(T);                                              \
+        if (rhs == 0)                                                   \
+            return trap("Integer division by zero");                    \
+        if constexpr (IsSigned<T>) {                                    \
+            if (rhs == -1 && lhs == NumericLimits<T>::min())            \
+                return trap("Integer overflow");                        \
+        }                                                               \
+        RESULT(static_cast<T>(lhs op rhs));                             \
+    } while (false);                                                    \
+    break
+#define REMAINDER(T)                                                    \
+    do {                                                                \
+        auto lhs = LHS(T);                                              \
+        auto rhs = RHS(T);                                              \
+        if (rhs == 0)                                                   \
+            return trap("Integer division by zero");                    \
+        /* The smallest integer divided by -1 overflows, but the remainder is 0. */ \
+        if constexpr (IsSigned<T>) {                                    \
+            if (rhs == -1) {                                            \
+                RESULT(static_cast<T>(0));                              \
+                break;                                                  \
+            }                                                           \
+        }                                                               \
+        RESULT(static_cast<T>(lhs % rhs));                              \
+    } while (false);                                                    \
+    break
+#define LOAD(Stored, T)                                     \
+    do {                                                    \
+        auto* data = memory_at(sizeof(Stored));             \
+        if (!data)                                          \
+            return trap("Memory access out of bounds");     \
+        Stored value;                                       \
+        __builtin_memcpy(&value, data, sizeof(value));      \
+        RESULT(static_cast<T>(value));                      \
+    } while (false);                                        \
+    break
+#define STORE(Stored)                                       \
+    do {                                                    \
+        auto* data = memory_at(sizeof(Stored));             \
+        if (!data)                                          \
+            return trap("Memory access out of bounds");     \
+        auto value = static_cast<Stored>(slots[instruction.rhs]); \
+        __builtin_memcpy(data, &value, sizeof(value));      \
+    } while (false);                                        \
+    break
+#define CHECKED_TRUNCATE(From, To)                                  \
+    do {                                                            \
+        To result;                                                  \
+        if (auto* error = checked_truncate(LHS(From), result))      \
+            return trap(error);                                     \
+        RESULT(result);                                             \
+    } while (false);                                                \
+    break
+
+        switch (instruction.opcode.value()) {
+        case IR::Opcodes::copy.value():
+            slots[instruction.destination] = slots[instruction.lhs];
+            break;
+        case IR::Opcodes::jump.value():
+            if (!jump_to(instruction.immediate))
+                return trap("Exceeded maximum allowed number of loop iterations");
+            break;
+        case IR::Opcodes::jump_if_zero.value():
+            if (LHS(u32) == 0 && !jump_to(instruction.immediate))
+                return trap("Exceeded maximum allowed number of loop iterations");
+            break;
+        case IR::Opcodes::jump_if_not_zero.value():
+            if (LHS(u32) != 0 && !jump_to(instruction.immediate))
+                return trap("Exceeded maximum allowed number of loop iterations");
+            break;
+        case IR::Opcodes::jump_table.value():
+            ip += min(static_cast<u64>(LHS(u32)), instruction.immediate);
+            break;
+        case IR::Opcodes::return_.value():
+            return true;
+        case Instructions::unreachable.value():
+            return trap("Unreachable");
+        case Instructions::call.value():
+            if (!call_address(configuration, configuration.frame().module().functions()[instruction.immediate], slots + instruction.lhs))
+                return false;
+            break;
+        case Instructions::call_indirect.value():
+            if (!call_indirect(configuration, *reinterpret_cast<Instruction::IndirectCallArgs const*>(static_cast<FlatPtr>(instruction.immediate)), slots + instruction.lhs))
+                return false;
+            break;
+        case Instructions::select.value():
+            slots[instruction.destination] = static_cast<u32>(slots[instruction.immediate]) != 0 ? slots[instruction.lhs] : slots[instruction.rhs];
+            break;
+        case Instructions::global_get.value():
+            slots[instruction.destination] = to_native_value(configuration.store().get(configuration.frame().module().globals()[instruction.immediate])->value());
+            break;
+        case Instructions::global_set.value(): {
+            auto* global = configuration.store().get(configuration.frame().module().globals()[instruction.immediate]);
+            global->set_value(from_native_value(global->value().type(), slots[instruction.lhs]));
+            break;
+        }
+        case Instructions::memory_size.value():
+            RESULT(static_cast<u32>(memory->size() / Constants::page_size));
+            break;
+        case Instructions::memory_grow.value(): {
+            u64 old_pages = memory->size() / Constants::page_size;
+            u64 delta = LHS(u32);
+            if (old_pages + delta > Constants::max_memory_pages || !memory->grow(delta * Constants::page_size))
+                RESULT(static_cast<i32>(-1));
+            else
+                RESULT(static_cast<u32>(old_pages));
+            break;
+        }
+        case Instructions::i32_load.value():
+            LOAD(u32, u32);
+        case Instructions::i64_load.value():
+            LOAD(u64, u64);
+        case Instructions::f32_load.value():
+            LOAD(float, float);
+        case Instructions::f64_load.value():
+            LOAD(double, double);
+        case Instructions::i32_load8_s.value():
+            LOAD(i8, i32);
+        case Instructions::i32_load8_u.value():
+            LOAD(u8, u32);
+        case Instructions::i32_load16_s.value():
+            LOAD(i16, i32);
+        case Instructions::i32_load16_u.value():
+            LOAD(u16, u32);
+        case Instructions::i64_load8_s.value():
+            LOAD(i8, i64);
+        case Instructions::i64_load8_u.value():
+            LOAD(u8, u64);
+        case Instructions::i64_load16_s.value():
+            LOAD(i16, i64);
+        case Instructions::i64_load16_u.value():
+            LOAD(u16, u64);
+        case Instructions::i64_load32_s.value():
+            LOAD(i32, i64);
+        case Instructions::i64_load32_u.value():
+            LOAD(u32, u64);
+        case Instructions::i32_store.value():
+        case Instructions::f32_store.value():
+        case Instructions::i64_store32.value():
+            STORE(u32);
+        case Instructions::i64_store.value():
+        case Instructions::f64_store.value():
+            STORE(u64);
+        case Instructions::i32_store8.value():
+        case Instructions::i64_store8.value():
+            STORE(u8);
+        case Instructions::i32_store16.value():
+        case Instructions::i64_store16.value():
+            STORE(u16);
+        case Instructions::i32_eqz.value():
+            UNARY(u32, static_cast<i32>(value == 0));
+        case Instructions::i32_eq.value():
+            COMPARE(u32, ==);
+        case Instructions::i32_ne.value():
+            COMPARE(u32, !=);
+        case Instructions::i32_lts.value():
+            COMPARE(i32, <);
+        case Instructions::i32_ltu.value():
+            COMPARE(u32, <);
+        case Instructions::i32_gts.value():
+            COMPARE(i32, >);
+        case Instructions::i32_gtu.value():
+            COMPARE(u32, >);
+        case Instructions::i32_les.value():
+            COMPARE(i32, <=);
+        case Instructions::i32_leu.value():
+            COMPARE(u32, <=);
+        case Instructions::i32_ges.value():
+            COMPARE(i32, >=);
+        case Instructions::i32_geu.value():
+            COMPARE(u32, >=);
+        case Instructions::i64_eqz.value():
+            UNARY(u64, static_cast<i32>(value == 0));
+        case Instructions::i64_eq.value():
+            COMPARE(u64, ==);
+        case Instructions::i64_ne.value():
+            COMPARE(u64, !=);
+        case Instructions::i64_lts.value():
+            COMPARE(i64, <);
+        case Instructions::i64_ltu.value():
+            COMPARE(u64, <);
+        case Instructions::i64_gts.value():
+            COMPARE(i64, >);
+        case Instructions::i64_gtu.value():
+            COMPARE(u64, >);
+        case Instructions::i64_les.value():
+            COMPARE(i64, <=);
+        case Instructions::i64_leu.value():
+            COMPARE(u64, <=);
+        case Instructions::i64_ges.value():
+            COMPARE(i64, >=);
+        case Instructions::i64_geu.value():
+            COMPARE(u64, >=);
+        case Instructions::f32_eq.value():
+            COMPARE(float, ==);
+        case Instructions::f32_ne.value():
+            COMPARE(float, !=);
+        case Instructions::f32_lt.value():
+            COMPARE(float, <);
+        case Instructions::f32_gt.value():
+            COMPARE(float, >);
+        case Instructions::f32_le.value():
+            COMPARE(float, <=);
+        case Instructions::f32_ge.value():
+            COMPARE(float, >=);
+        case Instructions::f64_eq.value():
+            COMPARE(double, ==);
+        case Instructions::f64_ne.value():
+            COMPARE(double, !=);
+        case Instructions::f64_lt.value():
+            COMPARE(double, <);
+        case Instructions::f64_gt.value():
+            COMPARE(double, >);
+        case Instructions::f64_le.value():
+            COMPARE(double, <=);
+        case Instructions::f64_ge.value():
+            COMPARE(double, >=);
+        case Instructions::i32_clz.value():
+            UNARY(u32, static_cast<u32>(value == 0 ? 32 : __builtin_clz(value)));
+        case Instructions::i32_ctz.value():
+            UNARY(u32, static_cast<u32>(value == 0 ? 32 : __builtin_ctz(value)));
+        case Instructions::i32_popcnt.value():
+            UNARY(u32, population_count(value));
+        case Instructions::i32_add.value():
+            WRAPPING(u32, +);
+        case Instructions::i32_sub.value():
+            WRAPPING(u32, -);
+        case Instructions::i32_mul.value():
+            WRAPPING(u32, *);
+        case Instructions::i32_divs.value():
+            DIVIDE(i32, /);
+        case Instructions::i32_divu.value():
+            DIVIDE(u32, /);
+        case Instructions::i32_rems.value():
+            REMAINDER(i32);
+        case Instructions::i32_remu.value():
+            REMAINDER(u32);
+        case Instructions::i32_and.value():
+            WRAPPING(u32, &);
+        case Instructions::i32_or.value():
+            WRAPPING(u32, |);
+        case Instructions::i32_xor.value():
+            WRAPPING(u32, ^);
+        case Instructions::i32_shl.value():
+            SHIFT(u32, <<);
+        case Instructions::i32_shrs.value():
+            SHIFT(i32, >>);
+        case Instructions::i32_shru.value():
+            SHIFT(u32, >>);
+        case Instructions::i32_rotl.value():
+            ROTATE(u32, rotate_left);
+        case Instructions::i32_rotr.value():
+            ROTATE(u32, rotate_right);
+        case Instructions::i64_clz.value():
+            UNARY(u64, static_cast<u64>(value == 0 ? 64 : __builtin_clzll(value)));
+        case Instructions::i64_ctz.value():
+            UNARY(u64, static_cast<u64>(value == 0 ? 64 : __builtin_ctzll(value)));
+        case Instructions::i64_popcnt.value():
+            UNARY(u64, population_count(value));
+        case Instructions::i64_add.value():
+            WRAPPING(u64, +);
+        case Instructions::i64_sub.value():
+            WRAPPING(u64, -);
+        case Instructions::i64_mul.value():
+            WRAPPING(u64, *);
+        case Instructions::i64_divs.value():
+            DIVIDE(i64, /);
+        case Instructions::i64_divu.value():
+            DIVIDE(u64, /);
+        case Instructions::i64_rems.value():
+            REMAINDER(i64);
+        case Instructions::i64_remu.value():
+            REMAINDER(u64);
+        case Instructions::i64_and.value():
+            WRAPPING(u64, &);
+        case Instructions::i64_or.value():
+            WRAPPING(u64, |);
+        case Instructions::i64_xor.value():
+            WRAPPING(u64, ^);
+        case Instructions::i64_shl.value():
+            SHIFT(u64, <<);
+        case Instructions::i64_shrs.value():
+            SHIFT(i64, >>);
+        case Instructions::i64_shru.value():
+            SHIFT(u64, >>);
+        case Instructions::i64_rotl.value():
+            ROTATE(u64, rotate_left);
+        case Instructions::i64_rotr.value():
+            ROTATE(u64, rotate_right);
+        case Instructions::f32_abs.value():
+            UNARY(u32, value & ~(1u << 31));
+        case Instructions::f32_neg.value():
+            UNARY(u32, value ^ (1u << 31));
+        case Instructions::f32_ceil.value():
+            UNARY(float, float_ceil(value));
+        case Instructions::f32_floor.value():
+            UNARY(float, float_floor(value));
+        case Instructions::f32_trunc.value():
+            UNARY(float, float_truncate(value));
+        case Instructions::f32_nearest.value():
+            UNARY(float, float_nearest(value));
+        case Instructions::f32_sqrt.value():
+            UNARY(float, float_square_root(value));
+        case Instructions::f32_add.value():
+            BINARY(float, lhs + rhs);
+        case Instructions::f32_sub.value():
+            BINARY(float, lhs - rhs);
+        case Instructions::f32_mul.value():
+            BINARY(float, lhs * rhs);
+        case Instructions::f32_div.value():
+            BINARY(float, lhs / rhs);
+        case Instructions::f32_min.value():
+            BINARY(float, float_minimum(lhs, rhs));
+        case Instructions::f32_max.value():
+            BINARY(float, float_maximum(lhs, rhs));
+        case Instructions::f32_copysign.value():
+            BINARY(float, float_copysign(lhs, rhs));
+        case Instructions::f64_abs.value():
+            UNARY(u64, value & ~(1ull << 63));
+        case Instructions::f64_neg.value():
+            UNARY(u64, value ^ (1ull << 63));
+        case Instructions::f64_ceil.value():
+            UNARY(double, float_ceil(value));
+        case Instructions::f64_floor.value():
+            UNARY(double, float_floor(value));
+        case Instructions::f64_trunc.value():
+            UNARY(double, float_truncate(value));
+        case Instructions::f64_nearest.value():
+            UNARY(double, float_nearest(value));
+        case Instructions::f64_sqrt.value():
+            UNARY(double, float_square_root(value));
+        case Instructions::f64_add.value():
+            BINARY(double, lhs + rhs);
+        case Instructions::f64_sub.value():
+            BINARY(double, lhs - rhs);
+        case Instructions::f64_mul.value():
+            BINARY(double, lhs * rhs);
+        case Instructions::f64_div.value():
+            BINARY(double, lhs / rhs);
+        case Instructions::f64_min.value():
+            BINARY(double, float_minimum(lhs, rhs));
+        case Instructions::f64_max.value():
+            BINARY(double, float_maximum(lhs, rhs));
+        case Instructions::f64_copysign.value():
+            BINARY(double, float_copysign(lhs, rhs));
+        case Instructions::i32_wrap_i64.value():
+            UNARY(u64, static_cast<u32>(value));
+        case Instructions::i32_trunc_sf32.value():
+            CHECKED_TRUNCATE(float, i32);
+        case Instructions::i32_trunc_uf32.value():
+            CHECKED_TRUNCATE(float, u32);
+        case Instructions::i32_trunc_sf64.value():
+            CHECKED_TRUNCATE(double, i32);
+        case Instructions::i32_trunc_uf64.value():
+            CHECKED_TRUNCATE(double, u32);
+        case Instructions::i64_extend_si32.value():
+            UNARY(i32, static_cast<i64>(value));
+        case Instructions::i64_extend_ui32.value():
+            UNARY(u32, static_cast<u64>(value));
+        case Instructions::i64_trunc_sf32.value():
+            CHECKED_TRUNCATE(float, i64);
+        case Instructions::i64_trunc_uf32.value():
+            CHECKED_TRUNCATE(float, u64);
+        case Instructions::i64_trunc_sf64.value():
+            CHECKED_TRUNCATE(double, i64);
+        case Instructions::i64_trunc_uf64.value():
+            CHECKED_TRUNCATE(double, u64);
+        case Instructions::f32_convert_si32.value():
+            UNARY(i32, static_cast<float>(value));
+        case Instructions::f32_convert_ui32.value():
+            UNARY(u32, static_cast<float>(value));
+        case Instructions::f32_convert_si64.value():
+            UNARY(i64, static_cast<float>(value));
+        case Instructions::f32_convert_ui64.value():
+            UNARY(u64, static_cast<float>(value));
+        case Instructions::f32_demote_f64.value():
+            UNARY(double, static_cast<float>(value));
+        case Instructions::f64_convert_si32.value():
+            UNARY(i32, static_cast<double>(value));
+        case Instructions::f64_convert_ui32.value():
+            UNARY(u32, static_cast<double>(value));
+        case Instructions::f64_convert_si64.value():
+            UNARY(i64, static_cast<double>(value));
+        case Instructions::f64_convert_ui64.value():
+            UNARY(u64, static_cast<double>(value));
+        case Instructions::f64_promote_f32.value():
+            UNARY(float, static_cast<double>(value));
+        case Instructions::i32_reinterpret_f32.value():
+        case Instructions::i64_reinterpret_f64.value():
+        case Instructions::f32_reinterpret_i32.value():
+        case Instructions::f64_reinterpret_i64.value():
+            slots[instruction.destination] = slots[instruction.lhs];
+            break;
+        case Instructions::i32_extend8_s.value():
+            UNARY(u32, static_cast<i32>(static_cast<i8>(value)));
+        case Instructions::i32_extend16_s.value():
+            UNARY(u32, static_cast<i32>(static_cast<i16>(value)));
+        case Instructions::i64_extend8_s.value():
+            UNARY(u64, static_cast<i64>(static_cast<i8>(value)));
+        case Instructions::i64_extend16_s.value():
+            UNARY(u64, static_cast<i64>(static_cast<i16>(value)));
+        case Instructions::i64_extend32_s.value():
+            UNARY(u64, static_cast<i64>(static_cast<i32>(value)));
+        case Instructions::i32_trunc_sat_f32_s.value():
+            UNARY(float, (saturating_truncate<float, i32>(value)));
+        case Instructions::i32_trunc_sat_f32_u.value():
+            UNARY(float, (saturating_truncate<float, u32>(value)));
+        case Instructions::i32_trunc_sat_f64_s.value():
+            UNARY(double, (saturating_truncate<double, i32>(value)));
+        case Instructions::i32_trunc_sat_f64_u.value():
+            UNARY(double, (saturating_truncate<double, u32>(value)));
+        case Instructions::i64_trunc_sat_f32_s.value():
+            UNARY(float, (saturating_truncate<float, i64>(value)));
+        case Instructions::i64_trunc_sat_f32_u.value():
+            UNARY(float, (saturating_truncate<float, u64>(value)));
+        case Instructions::i64_trunc_sat_f64_s.value():
+            UNARY(double, (saturating_truncate<double, i64>(value)));
+        case Instructions::i64_trunc_sat_f64_u.value():
+            UNARY(double, (saturating_truncate<double, u64>(value)));
+        default:
+            VERIFY_NOT_REACHED();
+        }
+
+#undef LHS
+#undef RHS
+#undef RESULT
+#undef UNARY
+#undef BINARY
+#undef COMPARE
+#undef WRAPPING
+#undef SHIFT
+#undef ROTATE
+#undef DIVIDE
+#undef REMAINDER
+#undef LOAD
+#undef STORE
+#undef CHECKED_TRUNCATE
+    }
+}
+
+}
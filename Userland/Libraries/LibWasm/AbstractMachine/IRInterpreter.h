@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/IR/IR.h>
+
+namespace Wasm {
+
+// Runs functions which were lowered to the register-based IR, and everything else with the bytecode interpreter.
+struct IRInterpreter : public BytecodeInterpreter {
+    virtual void interpret(Configuration&) override;
+    virtual ~IRInterpreter() override = default;
+
+    // Lowers all functions defined by the module instance, replacing any code previously lowered for their bodies.
+    virtual void compile(ModuleInstance const&, Store&) override;
+
+private:
+    bool execute(Configuration&, IR::Function const&, u64* slots);
+    bool call_address(Configuration&, FunctionAddress, u64* values);
+    bool call_indirect(Configuration&, Instruction::IndirectCallArgs const&, u64* values);
+
+    HashMap<Expression const*, NonnullOwnPtr<IR::Function>> m_functions;
+};
+
+}
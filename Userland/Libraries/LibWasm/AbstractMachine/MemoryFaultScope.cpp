@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWasm/AbstractMachine/MemoryFaultScope.h>
+#include <signal.h>
+
+namespace Wasm {
+
+static __thread MemoryFaultScope* s_innermost_scope;
+static struct sigaction s_previous_segv_action;
+static struct sigaction s_previous_bus_action;
+
+static void handle_fault(int signal, siginfo_t* info, void* context)
+{
+    auto* scope = s_innermost_scope;
+    if (scope && scope->contains(reinterpret_cast<FlatPtr>(info->si_addr)))
+        siglongjmp(scope->recovery_point(), 1);
+
+    // Not an access to a guard region, so pass it on. Restoring the default action and returning retries the
+    // faulting instruction, which then crashes as it would have without us. That's also what happens if the
+    // signal was ignored, since ignoring it would retry the instruction forever.
+    auto& previous = signal == SIGSEGV ? s_previous_segv_action : s_previous_bus_action;
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(signal, info, context);
+    } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+        previous.sa_handler(signal);
+    } else {
+        struct sigaction default_action {};
+        default_action.sa_handler = SIG_DFL;
+        sigemptyset(&default_action.sa_mask);
+        sigaction(signal, &default_action, nullptr);
+    }
+}
+
+static void install_fault_handler()
+{
+    [[maybe_unused]] static bool const installed = [] {
+        struct sigaction action {};
+        action.sa_sigaction = handle_fault;
+        // The handler leaves by siglongjmp() without restoring the signal mask, so the signal must not be blocked
+        // while it runs.
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &s_previous_segv_action);
+        // Some systems raise SIGBUS rather than SIGSEGV for accesses to inaccessible pages.
+        sigaction(SIGBUS, &action, &s_previous_bus_action);
+        return true;
+    }();
+}
+
+MemoryFaultScope::MemoryFaultScope(MemoryInstance const* memory)
+    : m_previous(s_innermost_scope)
+{
+    if (memory && memory->has_guard_region()) {
+        install_fault_handler();
+        m_region_start = reinterpret_cast<FlatPtr>(memory->reserved_region().data());
+        m_region_size = memory->reserved_region().size();
+    }
+    s_innermost_scope = this;
+}
+
+MemoryFaultScope::~MemoryFaultScope()
+{
+    s_innermost_scope = m_previous;
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <setjmp.h>
+
+namespace Wasm {
+
+// While a scope is the innermost one on its thread, faults caused by accessing the guard region of its memory
+// return to its recovery point, which has to be set by the function that created the scope:
+//
+//     MemoryFaultScope scope { memory };
+//     if (sigsetjmp(scope.recovery_point(), 0) != 0)
+//         return trap("Memory access out of bounds");
+//
+// Nothing is unwound on the way back, so all frames between the two must be free of anything with a destructor.
+// That is the case for compiled code, and for interpreter loops which do not own any resources.
+class MemoryFaultScope {
+    AK_MAKE_NONCOPYABLE(MemoryFaultScope);
+    AK_MAKE_NONMOVABLE(MemoryFaultScope);
+
+public:
+    // The scope handles no faults at all if the memory is null or doesn't have a guard region.
+    explicit MemoryFaultScope(MemoryInstance const*);
+    ~MemoryFaultScope();
+
+    sigjmp_buf& recovery_point() { return m_recovery_point; }
+    bool contains(FlatPtr address) const { return address - m_region_start < m_region_size; }
+
+private:
+    sigjmp_buf m_recovery_point;
+    FlatPtr m_region_start { 0 };
+    size_t m_region_size { 0 };
+    MemoryFaultScope* m_previous { nullptr };
+};
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/AbstractMachine/MemoryFaultScope.h>
+#include <LibWasm/AbstractMachine/NativeInterpreter.h>
+
+namespace Wasm {
+
+void NativeInterpreter::interpret(Configuration& configuration)
+{
+    MemoryInstance* memory { nullptr };
+    if (!configuration.frame().module().memories().is_empty())
+        memory = configuration.store().get(configuration.frame().module().memories().first());
+
+    auto& functions = functions_for(memory);
+    auto it = functions.find(&configuration.frame().expression());
+    if (it == functions.end())
+        return BytecodeInterpreter::interpret(configuration);
+
+    auto& function = *it->value;
+    m_trap.clear();
+
+    Vector<u64, 64> slots;
+    slots.resize(function.slot_count);
+    auto& locals = configuration.frame().locals();
+    for (size_t i = 0; i < locals.size(); ++i)
+        slots[i] = to_native_value(locals[i]);
+
+    NativeContext context;
+    context.interpreter = this;
+    context.configuration = &configuration;
+    context.remaining_loop_iterations = Constants::max_allowed_executed_instructions_per_call;
+    context.refresh_memory();
+
+    MemoryFaultScope fault_scope { memory };
+    if (sigsetjmp(fault_scope.recovery_point(), 0) != 0) {
+        set_trap(native_trap_reason(NativeTrap::MemoryAccessOutOfBounds));
+        return;
+    }
+
+    auto result = function.entry(&context, slots.data());
+    if (result != NativeTrap::None) {
+        if (result != NativeTrap::Runtime)
+            set_trap(native_trap_reason(result));
+        return;
+    }
+
+    for (size_t i = 0; i < function.results.size(); ++i)
+        configuration.stack().push(from_native_value(function.results[i], slots[i]));
+}
+
+void NativeInterpreter::compile(ModuleInstance const& module, Store& store)
+{
+    if constexpr (!NativeCompiler::is_supported())
+        return;
+
+    MemoryInstance const* memory { nullptr };
+    if (!module.memories().is_empty())
+        memory = store.get(module.memories().first());
+    auto& functions = functions_for(memory);
+
+    NativeCompiler compiler { store, module };
+    for (auto address : module.functions()) {
+        auto* function = store.get(address);
+        if (!function || !function->has<WasmFunction>())
+            continue;
+        auto& wasm_function = function->get<WasmFunction>();
+        if (&wasm_function.module() != &module)
+            continue;
+        functions.remove(&wasm_function.code().body());
+        compiler.compile(wasm_function);
+    }
+
+    for (auto& function : compiler.finish()) {
+        auto* body = function.body;
+        functions.set(body, make<NativeFunction>(move(function)));
+    }
+}
+
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/Compiler/NativeCompiler.h>
+
+namespace Wasm {
+
+// Runs functions which were compiled to machine code natively, and everything else with the bytecode interpreter.
+struct NativeInterpreter : public BytecodeInterpreter {
+    virtual void interpret(Configuration&) override;
+    virtual ~NativeInterpreter() override = default;
+
+    // Compiles all functions defined by the module instance, replacing any code previously compiled for their bodies
+    // and the same kind of memory.
+    virtual void compile(ModuleInstance const&, Store&) override;
+
+    void set_trap(String reason) { m_trap = Trap { move(reason) }; }
+
+private:
+    using FunctionMap = HashMap<Expression const*, NonnullOwnPtr<NativeFunction>>;
+
+    // Code compiled for memory with a guard region leaves out the bounds checks, so it's kept apart from the
+    // code for other instances of the same module.
+    FunctionMap& functions_for(MemoryInstance const* memory) { return memory && memory->has_guard_region() ? m_functions_for_guarded_memory : m_functions; }
+
+    FunctionMap m_functions;
+    FunctionMap m_functions_for_guarded_memory;
+};
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BitCast.h>
+#include <AK/NumericLimits.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <math.h>
+
+// Numeric operations whose Wasm semantics differ from (or aren't directly provided by) C++, shared by the
+// execution engines which keep values in raw 64-bit slots.
+
+namespace Wasm::Operators {
+
+// i32 and f32 values are stored in the lower half of a slot, with the upper half cleared.
+template<typename T>
+ALWAYS_INLINE T native_value_as(u64 raw)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<float>(static_cast<u32>(raw));
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<double>(raw);
+    else
+        return static_cast<T>(raw);
+}
+
+template<typename T>
+ALWAYS_INLINE u64 native_value_from(T value)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<u32>(value);
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<u64>(value);
+    else if constexpr (sizeof(T) == sizeof(u32))
+        return static_cast<u32>(value);
+    else
+        return static_cast<u64>(value);
+}
+
+template<typename T>
+ALWAYS_INLINE T rotate_left(T value, unsigned shift)
+{
+    constexpr unsigned mask = sizeof(T) * 8 - 1;
+    shift &= mask;
+    return (value << shift) | (value >> ((-shift) & mask));
+}
+
+template<typename T>
+ALWAYS_INLINE T rotate_right(T value, unsigned shift)
+{
+    constexpr unsigned mask = sizeof(T) * 8 - 1;
+    shift &= mask;
+    return (value >> shift) | (value << ((-shift) & mask));
+}
+
+template<typename T>
+static constexpr bool is_single_precision = IsSame<T, float>;
+
+template<typename T>
+T float_ceil(T value) { return is_single_precision<T> ? ceilf(value) : ceil(value); }
+template<typename T>
+T float_floor(T value) { return is_single_precision<T> ? floorf(value) : floor(value); }
+template<typename T>
+T float_truncate(T value) { return is_single_precision<T> ? truncf(value) : trunc(value); }
+// Rounds half-way cases to even, as the default rounding mode does.
+template<typename T>
+T float_nearest(T value) { return is_single_precision<T> ? nearbyintf(value) : nearbyint(value); }
+template<typename T>
+T float_square_root(T value) { return is_single_precision<T> ? sqrtf(value) : sqrt(value); }
+template<typename T>
+T float_copysign(T lhs, T rhs) { return is_single_precision<T> ? copysignf(lhs, rhs) : copysign(lhs, rhs); }
+
+template<typename T>
+T float_minimum(T lhs, T rhs)
+{
+    if (isnan(lhs) || isnan(rhs))
+        return lhs + rhs;
+    if (lhs == rhs)
+        return signbit(lhs) ? lhs : rhs;
+    return lhs < rhs ? lhs : rhs;
+}
+
+template<typename T>
+T float_maximum(T lhs, T rhs)
+{
+    if (isnan(lhs) || isnan(rhs))
+        return lhs + rhs;
+    if (lhs == rhs)
+        return signbit(lhs) ? rhs : lhs;
+    return lhs > rhs ? lhs : rhs;
+}
+
+template<typename T>
+T population_count(T value)
+{
+    return __builtin_popcountll(static_cast<u64>(value));
+}
+
+template<typename From, typename To>
+To convert(From value)
+{
+    return static_cast<To>(value);
+}
+
+// The bounds of the range of truncated values which fit into the integer type, [lower, upper).
+template<typename To>
+static constexpr double truncation_lower_bound = static_cast<double>(NumericLimits<To>::min());
+template<typename To>
+static constexpr double truncation_upper_bound = -2.0 * static_cast<double>(NumericLimits<MakeSigned<To>>::min()) / (IsSigned<To> ? 2.0 : 1.0);
+
+template<typename From, typename To>
+To saturating_truncate(From value)
+{
+    if (isnan(value))
+        return 0;
+    auto truncated = trunc(static_cast<double>(value));
+    if (truncated < truncation_lower_bound<To>)
+        return NumericLimits<To>::min();
+    if (truncated >= truncation_upper_bound<To>)
+        return NumericLimits<To>::max();
+    return static_cast<To>(truncated);
+}
+
+// Returns the reason to trap with if the value can't be represented by the integer type.
+template<typename From, typename To>
+char const* checked_truncate(From value, To& result)
+{
+    if (isnan(value))
+        return "Invalid conversion to integer";
+    auto truncated = trunc(static_cast<double>(value));
+    if (truncated < truncation_lower_bound<To> || truncated >= truncation_upper_bound<To>)
+        return "Integer overflow";
+    result = static_cast<To>(truncated);
+    return nullptr;
+}
+
+}
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <initializer_list>
+
+namespace Wasm::X86_64 {
+
+enum class Reg : u8 {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R8 = 8,
+    R12 = 12,
+};
+
+// XMM registers share the encoding of the general purpose registers with the same number.
+enum class XmmReg : u8 {
+    XMM0 = 0,
+    XMM1 = 1,
+};
+
+enum class Condition : u8 {
+    Overflow = 0x0,
+    Below = 0x2,
+    AboveOrEqual = 0x3,
+    Equal = 0x4,
+    NotEqual = 0x5,
+    BelowOrEqual = 0x6,
+    Above = 0x7,
+    Sign = 0x8,
+    Less = 0xc,
+    GreaterOrEqual = 0xd,
+    LessOrEqual = 0xe,
+    Greater = 0xf,
+};
+
+struct Memory {
+    Reg base;
+    i32 displacement { 0 };
+};
+
+// A minimal encoder for the subset of x86_64 which the Wasm compiler emits. Operand sizes are chosen with
+// the `wide` flags: 64-bit operations when set, 32-bit operations (which zero the upper half of the
+// destination register) otherwise.
+class Assembler {
+public:
+    class Label {
+    public:
+        bool is_bound() const { return m_offset.has_value(); }
+        bool is_used() const { return m_offset.has_value() || !m_jump_sites.is_empty(); }
+
+    private:
+        friend class Assembler;
+        Optional<size_t> m_offset;
+        Vector<size_t> m_jump_sites; // Offsets of the rel32 operands that refer to this label.
+    };
+
+    Vector<u8> const& code() const { return m_code; }
+    size_t offset() const { return m_code.size(); }
+
+    void bind(Label& label)
+    {
+        VERIFY(!label.is_bound());
+        label.m_offset = offset();
+        for (auto site : label.m_jump_sites)
+            patch_rel32(site, offset());
+        label.m_jump_sites.clear();
+    }
+
+    // Integer loads and stores between registers and memory.
+    void load(bool wide, Reg destination, Memory source) { emit_rm(0, wide, { 0x8b }, to_underlying(destination), source); }
+    void store(bool wide, Memory destination, Reg source) { emit_rm(0, wide, { 0x89 }, to_underlying(source), destination); }
+    void store8(Memory destination, Reg source) { emit_rm(0, false, { 0x88 }, to_underlying(source), destination); }
+    void store16(Memory destination, Reg source) { emit_rm(0x66, false, { 0x89 }, to_underlying(source), destination); }
+    void load_zero_extend8(Reg destination, Memory source) { emit_rm(0, false, { 0x0f, 0xb6 }, to_underlying(destination), source); }
+    void load_zero_extend16(Reg destination, Memory source) { emit_rm(0, false, { 0x0f, 0xb7 }, to_underlying(destination), source); }
+    void load_sign_extend8(bool wide, Reg destination, Memory source) { emit_rm(0, wide, { 0x0f, 0xbe }, to_underlying(destination), source); }
+    void load_sign_extend16(bool wide, Reg destination, Memory source) { emit_rm(0, wide, { 0x0f, 0xbf }, to_underlying(destination), source); }
+    void load_sign_extend32(Reg destination, Memory source) { emit_rm(0, true, { 0x63 }, to_underlying(destination), source); }
+    void lea(Reg destination, Memory source) { emit_rm(0, true, { 0x8d }, to_underlying(destination), source); }
+
+    void mov(bool wide, Reg destination, Reg source) { emit_rm(0, wide, { 0x8b }, to_underlying(destination), source); }
+    void mov(Reg destination, u64 immediate)
+    {
+        if (immediate <= NumericLimits<u32>::max()) {
+            emit_rex(false, 0, to_underlying(destination));
+            m_code.append(0xb8 + (to_underlying(destination) & 7));
+            append_le<u32>(immediate);
+            return;
+        }
+        emit_rex(true, 0, to_underlying(destination));
+        m_code.append(0xb8 + (to_underlying(destination) & 7));
+        append_le<u64>(immediate);
+    }
+
+    enum class ArithmeticOp : u8 {
+        Add = 0,
+        Or = 1,
+        And = 4,
+        Sub = 5,
+        Xor = 6,
+        Compare = 7,
+    };
+
+    void arithmetic(ArithmeticOp op, bool wide, Reg destination, Memory source) { emit_rm(0, wide, { static_cast<u8>((to_underlying(op) << 3) | 3) }, to_underlying(destination), source); }
+    void arithmetic(ArithmeticOp op, bool wide, Reg destination, Reg source) { emit_rm(0, wide, { static_cast<u8>((to_underlying(op) << 3) | 3) }, to_underlying(destination), source); }
+    void arithmetic(ArithmeticOp op, bool wide, Reg destination, i32 immediate)
+    {
+        if (immediate >= -128 && immediate <= 127) {
+            emit_rm(0, wide, { 0x83 }, to_underlying(op), destination);
+            m_code.append(static_cast<u8>(immediate));
+        } else {
+            emit_rm(0, wide, { 0x81 }, to_underlying(op), destination);
+            append_le<u32>(static_cast<u32>(immediate));
+        }
+    }
+
+    void multiply(bool wide, Reg destination, Memory source) { emit_rm(0, wide, { 0x0f, 0xaf }, to_underlying(destination), source); }
+    void test(bool wide, Reg lhs, Reg rhs) { emit_rm(0, wide, { 0x85 }, to_underlying(rhs), lhs); }
+
+    enum class ShiftOp : u8 {
+        RotateLeft = 0,
+        RotateRight = 1,
+        ShiftLeft = 4,
+        ShiftRightLogical = 5,
+        ShiftRightArithmetic = 7,
+    };
+
+    // Shifts the register by the count in CL.
+    void shift(ShiftOp op, bool wide, Reg destination) { emit_rm(0, wide, { 0xd3 }, to_underlying(op), destination); }
+
+    // Sign-extends RAX into RDX (cdq / cqo).
+    void sign_extend_rax_into_rdx(bool wide)
+    {
+        emit_rex(wide, 0, 0);
+        m_code.append(0x99);
+    }
+    void signed_divide(bool wide, Reg divisor) { emit_rm(0, wide, { 0xf7 }, 7, divisor); }
+    void unsigned_divide(bool wide, Reg divisor) { emit_rm(0, wide, { 0xf7 }, 6, divisor); }
+
+    void bit_scan_reverse(bool wide, Reg destination, Reg source) { emit_rm(0, wide, { 0x0f, 0xbd }, to_underlying(destination), source); }
+    void bit_scan_forward(bool wide, Reg destination, Reg source) { emit_rm(0, wide, { 0x0f, 0xbc }, to_underlying(destination), source); }
+    void bit_test_and_complement(bool wide, Reg destination, u8 bit) { emit_bit_test(7, wide, destination, bit); }
+    void bit_test_and_reset(bool wide, Reg destination, u8 bit) { emit_bit_test(6, wide, destination, bit); }
+
+    // Sets the register to 0 or 1 depending on the condition.
+    void set(Condition condition, Reg destination)
+    {
+        VERIFY(to_underlying(destination) < 4);
+        emit_rm(0, false, { 0x0f, static_cast<u8>(0x90 | to_underlying(condition)) }, 0, destination);
+        emit_rm(0, false, { 0x0f, 0xb6 }, to_underlying(destination), destination);
+    }
+
+    void decrement(Memory destination) { emit_rm(0, true, { 0xff }, 1, destination); }
+
+    void push(Reg reg)
+    {
+        emit_rex(false, 0, to_underlying(reg));
+        m_code.append(0x50 + (to_underlying(reg) & 7));
+    }
+    void pop(Reg reg)
+    {
+        emit_rex(false, 0, to_underlying(reg));
+        m_code.append(0x58 + (to_underlying(reg) & 7));
+    }
+    void ret() { m_code.append(0xc3); }
+
+    // Calls the function at the given absolute address, clobbering RAX.
+    void call(FlatPtr address)
+    {
+        mov(Reg::RAX, static_cast<u64>(address));
+        emit_rm(0, false, { 0xff }, 2, Reg::RAX);
+    }
+
+    void jump(Label& label)
+    {
+        m_code.append(0xe9);
+        emit_label_reference(label);
+    }
+    void jump_if(Condition condition, Label& label)
+    {
+        m_code.append(0x0f);
+        m_code.append(0x80 | to_underlying(condition));
+        emit_label_reference(label);
+    }
+
+    // Scalar floating point operations; `wide` selects double precision, single precision otherwise.
+    enum class FloatOp : u8 {
+        SquareRoot = 0x51,
+        Add = 0x58,
+        Multiply = 0x59,
+        Subtract = 0x5c,
+        Divide = 0x5e,
+    };
+
+    void load_float(bool wide, XmmReg destination, Memory source) { emit_rm(wide ? 0xf2 : 0xf3, false, { 0x0f, 0x10 }, to_underlying(destination), source); }
+    void store_float(bool wide, Memory destination, XmmReg source) { emit_rm(wide ? 0xf2 : 0xf3, false, { 0x0f, 0x11 }, to_underlying(source), destination); }
+    void float_operation(FloatOp op, bool wide, XmmReg destination, Memory source) { emit_rm(wide ? 0xf2 : 0xf3, false, { 0x0f, to_underlying(op) }, to_underlying(destination), source); }
+
+    enum class FloatComparison : u8 {
+        Equal = 0,
+        LessThan = 1,
+        LessOrEqual = 2,
+        NotEqual = 4,
+    };
+
+    // Sets the destination to all ones if the comparison holds, to all zeroes otherwise.
+    void compare_float(FloatComparison comparison, bool wide, XmmReg destination, Memory source)
+    {
+        emit_rm(wide ? 0xf2 : 0xf3, false, { 0x0f, 0xc2 }, to_underlying(destination), source);
+        m_code.append(to_underlying(comparison));
+    }
+    void move_float_to_integer(Reg destination, XmmReg source) { emit_rm(0x66, false, { 0x0f, 0x7e }, to_underlying(source), destination); }
+
+private:
+    template<typename T>
+    void append_le(T value)
+    {
+        for (size_t i = 0; i < sizeof(T); ++i)
+            m_code.append(static_cast<u8>(value >> (i * 8)));
+    }
+
+    void emit_rex(bool wide, u8 reg, u8 rm)
+    {
+        u8 rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (rex != 0x40)
+            m_code.append(rex);
+    }
+
+    void emit_rm(u8 prefix, bool wide, std::initializer_list<u8> opcode, u8 reg, Reg rm)
+    {
+        if (prefix)
+            m_code.append(prefix);
+        emit_rex(wide, reg, to_underlying(rm));
+        for (auto byte : opcode)
+            m_code.append(byte);
+        m_code.append(0xc0 | ((reg & 7) << 3) | (to_underlying(rm) & 7));
+    }
+
+    void emit_rm(u8 prefix, bool wide, std::initializer_list<u8> opcode, u8 reg, Memory memory)
+    {
+        if (prefix)
+            m_code.append(prefix);
+        auto base = to_underlying(memory.base);
+        emit_rex(wide, reg, base);
+        for (auto byte : opcode)
+            m_code.append(byte);
+
+        u8 mode;
+        if (memory.displacement == 0 && (base & 7) != 5)
+            mode = 0;
+        else if (memory.displacement >= -128 && memory.displacement <= 127)
+            mode = 1;
+        else
+            mode = 2;
+        m_code.append((mode << 6) | ((reg & 7) << 3) | (base & 7));
+        // RSP and R12 can only be used as a base with a SIB byte.
+        if ((base & 7) == 4)
+            m_code.append(0x24);
+        if (mode == 1)
+            m_code.append(static_cast<u8>(memory.displacement));
+        else if (mode == 2)
+            append_le<u32>(static_cast<u32>(memory.displacement));
+    }
+
+    void emit_bit_test(u8 extension, bool wide, Reg destination, u8 bit)
+    {
+        emit_rm(0, wide, { 0x0f, 0xba }, extension, destination);
+        m_code.append(bit);
+    }
+
+    void emit_label_reference(Label& label)
+    {
+        auto site = offset();
+        append_le<u32>(0);
+        if (label.is_bound())
+            patch_rel32(site, *label.m_offset);
+        else
+            label.m_jump_sites.append(site);
+    }
+
+    void patch_rel32(size_t site, size_t target)
+    {
+        auto relative = static_cast<i32>(static_cast<i64>(target) - static_cast<i64>(site + 4));
+        for (size_t i = 0; i < 4; ++i)
+            m_code[site + i] = static_cast<u8>(static_cast<u32>(relative) >> (i * 8));
+    }
+
+    Vector<u8> m_code;
+};
+
+}
@@ -0,0 +1,1331 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
+#include <LibWasm/AbstractMachine/Configuration.h>
+#include <LibWasm/AbstractMachine/NativeInterpreter.h>
+#include <LibWasm/AbstractMachine/Operators.h>
+#include <LibWasm/Compiler/NativeCompiler.h>
+#include <LibWasm/Opcode.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __serenity__
+#    include <serenity.h>
+#endif
+
+namespace Wasm {
+
+using namespace Operators;
+
+char const* native_trap_reason(NativeTrap trap)
+{
+    switch (trap) {
+    case NativeTrap::None:
+        return "No trap";
+    case NativeTrap::Unreachable:
+        return "Unreachable";
+    case NativeTrap::DivisionByZero:
+        return "Integer division by zero";
+    case NativeTrap::IntegerOverflow:
+        return "Integer overflow";
+    case NativeTrap::MemoryAccessOutOfBounds:
+        return "Memory access out of bounds";
+    case NativeTrap::ExceededLoopIterations:
+        return "Exceeded maximum allowed number of loop iterations";
+    case NativeTrap::Runtime:
+        return "Runtime error";
+    }
+    VERIFY_NOT_REACHED();
+}
+
+u64 to_native_value(Value const& value)
+{
+    return value.value().visit(
+        [](Reference const&) -> u64 { VERIFY_NOT_REACHED(); },
+        [](auto number) { return native_value_from(number); });
+}
+
+Value from_native_value(ValueType type, u64 raw)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+        return Value(native_value_as<i32>(raw));
+    case ValueType::I64:
+        return Value(native_value_as<i64>(raw));
+    case ValueType::F32:
+        return Value(native_value_as<float>(raw));
+    case ValueType::F64:
+        return Value(native_value_as<double>(raw));
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+void NativeContext::refresh_memory()
+{
+    auto& memories = configuration->frame().module().memories();
+    if (memories.is_empty()) {
+        memory_base = nullptr;
+        memory_size = 0;
+        return;
+    }
+    auto* memory = configuration->store().get(memories.first());
+    memory_base = memory->data().data();
+    memory_size = memory->size();
+}
+
+RefPtr<ExecutableCode> ExecutableCode::create(ReadonlyBytes code)
+{
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto size = (code.size() + page_size - 1) / page_size * page_size;
+#ifdef __serenity__
+    // Anonymous memory can never be made executable, so the code is written through a writable mapping of an
+    // anonymous file which is then mapped a second time as executable.
+    int fd = anon_create(size, O_CLOEXEC);
+    if (fd < 0)
+        return {};
+    auto* writable = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (writable == MAP_FAILED) {
+        close(fd);
+        return {};
+    }
+    memcpy(writable, code.data(), code.size());
+    munmap(writable, size);
+    auto* executable = mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+    close(fd);
+    if (executable == MAP_FAILED)
+        return {};
+#else
+    auto* executable = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (executable == MAP_FAILED)
+        return {};
+    memcpy(executable, code.data(), code.size());
+    if (mprotect(executable, size, PROT_READ | PROT_EXEC) < 0) {
+        munmap(executable, size);
+        return {};
+    }
+#endif
+    return adopt_ref(*new ExecutableCode(static_cast<u8 const*>(executable), size));
+}
+
+ExecutableCode::~ExecutableCode()
+{
+    munmap(const_cast<u8*>(m_data), m_size);
+}
+
+// Runtime helpers called from compiled code. Helpers which operate on operand stack entries get a pointer to the
+// first slot they use and store their results in place. Helpers which need the context return a non-zero value
+// after recording a trap.
+
+using RuntimeHelper = u32 (*)(NativeContext*, u64 immediate, u64* values);
+using PureHelper = void (*)(u64* values);
+
+static u32 trap(NativeContext* context, String reason)
+{
+    context->interpreter->set_trap(move(reason));
+    return 1;
+}
+
+static bool types_match(FunctionType const& lhs, FunctionType const& rhs)
+{
+    auto kinds_match = [](Vector<ValueType> const& a, Vector<ValueType> const& b) {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].kind() != b[i].kind())
+                return false;
+        }
+        return true;
+    };
+    return kinds_match(lhs.parameters(), rhs.parameters()) && kinds_match(lhs.results(), rhs.results());
+}
+
+static u32 call_address(NativeContext* context, FunctionAddress address, u64* values)
+{
+    auto& configuration = *context->configuration;
+    if (configuration.depth() > Constants::max_allowed_call_stack_depth)
+        return trap(context, "Exceeded maximum allowed call stack depth");
+
+    auto* instance = configuration.store().get(address);
+    if (!instance)
+        return trap(context, "Call to a nonexistent function");
+    FunctionType const* type { nullptr };
+    instance->visit([&](auto const& function) { type = &function.type(); });
+
+    Vector<Value> arguments;
+    arguments.ensure_capacity(type->parameters().size());
+    for (size_t i = 0; i < type->parameters().size(); ++i)
+        arguments.unchecked_append(from_native_value(type->parameters()[i], values[i]));
+
+    Result result { Trap { ""sv } };
+    {
+        BytecodeInterpreter::CallFrameHandle handle { *context->interpreter, configuration };
+        result = configuration.call(*context->interpreter, address, move(arguments));
+    }
+    context->refresh_memory();
+
+    if (result.is_trap())
+        return trap(context, move(result.trap().reason));
+    if (result.values().size() != type->results().size())
+        return trap(context, "Call returned an unexpected number of values");
+    for (size_t i = 0; i < result.values().size(); ++i)
+        values[i] = to_native_value(result.values()[i]);
+    return 0;
+}
+
+static u32 call_function(NativeContext* context, u64 index, u64* values)
+{
+    auto address = context->configuration->frame().module().functions()[index];
+    return call_address(context, address, values);
+}
+
+static u32 call_indirect(NativeContext* context, u64 immediate, u64* values)
+{
+    auto& arguments = *reinterpret_cast<Instruction::IndirectCallArgs const*>(static_cast<FlatPtr>(immediate));
+    auto& configuration = *context->configuration;
+    auto& module = configuration.frame().module();
+    auto& expected_type = module.types()[arguments.type.value()];
+
+    // The table index follows the arguments on the stack.
+    auto index = native_value_as<u32>(values[expected_type.parameters().size()]);
+    auto* table = configuration.store().get(module.tables()[arguments.table.value()]);
+    if (!table || index >= table->elements().size())
+        return trap(context, "Indirect call to an element outside of the table");
+    auto& element = table->elements()[index];
+    if (!element.has_value() || !element->ref().has<Reference::Func>())
+        return trap(context, "Indirect call to an uninitialized element");
+
+    auto address = element->ref().get<Reference::Func>().address;
+    auto* instance = configuration.store().get(address);
+    if (!instance)
+        return trap(context, "Call to a nonexistent function");
+    bool type_matches = instance->visit([&](auto const& function) { return types_match(function.type(), expected_type); });
+    if (!type_matches)
+        return trap(context, "Indirect call type mismatch");
+    return call_address(context, address, values);
+}
+
+static u32 global_get(NativeContext* context, u64 index, u64* values)
+{
+    auto& configuration = *context->configuration;
+    auto* global = configuration.store().get(configuration.frame().module().globals()[index]);
+    values[0] = to_native_value(global->value());
+    return 0;
+}
+
+static u32 global_set(NativeContext* context, u64 index, u64* values)
+{
+    auto& configuration = *context->configuration;
+    auto* global = configuration.store().get(configuration.frame().module().globals()[index]);
+    global->set_value(from_native_value(global->value().type(), values[0]));
+    return 0;
+}
+
+static u32 memory_size(NativeContext* context, u64, u64* values)
+{
+    values[0] = context->memory_size / Constants::page_size;
+    return 0;
+}
+
+static u32 memory_grow(NativeContext* context, u64, u64* values)
+{
+    auto& configuration = *context->configuration;
+    auto* memory = configuration.store().get(configuration.frame().module().memories().first());
+    u64 old_pages = memory->size() / Constants::page_size;
+    u64 delta = native_value_as<u32>(values[0]);
+    if (old_pages + delta > Constants::max_memory_pages || !memory->grow(delta * Constants::page_size))
+        values[0] = native_value_from<i32>(-1);
+    else
+        values[0] = native_value_from<u32>(old_pages);
+    context->refresh_memory();
+    return 0;
+}
+
+template<typename From, typename To>
+static u32 checked_truncate(NativeContext* context, u64, u64* values)
+{
+    To result;
+    if (auto* error = Operators::checked_truncate(native_value_as<From>(values[0]), result))
+        return trap(context, error);
+    values[0] = native_value_from(result);
+    return 0;
+}
+
+template<typename T, typename R, R (*operation)(T)>
+static void unary_helper(u64* values)
+{
+    values[0] = native_value_from(operation(native_value_as<T>(values[0])));
+}
+
+template<typename T, T (*operation)(T, T)>
+static void binary_helper(u64* values)
+{
+    values[0] = native_value_from(operation(native_value_as<T>(values[0]), native_value_as<T>(values[1])));
+}
+
+#if ARCH(X86_64)
+
+using namespace X86_64;
+
+namespace {
+
+class FunctionCompiler {
+public:
+    FunctionCompiler(Store& store, ModuleInstance const& module, WasmFunction const& function)
+        : m_store(store)
+        , m_module(module)
+        , m_function(function)
+    {
+    }
+
+    bool compile();
+
+    Vector<u8> const& code() const { return m_assembler.code(); }
+    size_t slot_count() const { return max(max(m_local_count + m_max_stack_height, m_function.type().results().size()), 1u); }
+
+private:
+    struct ControlFrame {
+        enum class Kind {
+            Function,
+            Block,
+            Loop,
+            If,
+        };
+
+        Kind kind;
+        size_t stack_height { 0 }; // The height of the operand stack when the frame was entered.
+        size_t arity { 0 };
+        Assembler::Label end {};
+        Assembler::Label loop_or_else {}; // The loop header of loops, the start of the else branch of ifs.
+        bool has_else { false };
+    };
+
+    using ArithmeticOp = Assembler::ArithmeticOp;
+    using FloatComparison = Assembler::FloatComparison;
+    using FloatOp = Assembler::FloatOp;
+    using ShiftOp = Assembler::ShiftOp;
+
+    static Memory slot(size_t index) { return { Reg::RBX, static_cast<i32>(index * sizeof(u64)) }; }
+    static Memory context_field(size_t offset) { return { Reg::R12, static_cast<i32>(offset) }; }
+    Memory stack(size_t index) const { return slot(m_local_count + index); }
+    Memory top(size_t depth = 0) const { return stack(m_stack_height - 1 - depth); }
+
+    bool has_operands(size_t count) const { return m_stack_height >= m_frames.last().stack_height + count; }
+    void push(size_t count = 1)
+    {
+        m_stack_height += count;
+        m_max_stack_height = max(m_max_stack_height, m_stack_height);
+    }
+    void pop(size_t count = 1) { m_stack_height -= count; }
+
+    Assembler::Label& trap_label(NativeTrap trap) { return m_trap_labels[to_underlying(trap)]; }
+
+    bool compile(Instruction const&);
+    bool compile_block(Instruction const&, ControlFrame::Kind);
+    bool compile_else();
+    bool compile_end();
+
+    bool branch(size_t depth);
+    bool branch_needs_copy(size_t depth) const;
+    Assembler::Label& branch_target(size_t depth);
+
+    void copy(Memory source, Memory destination);
+    void binary(ArithmeticOp, bool wide);
+    void compare(Condition, bool wide);
+    void shift(ShiftOp, bool wide);
+    void divide(bool wide, bool is_signed, bool remainder);
+    void count_zeroes(bool wide, bool leading);
+    void float_binary(FloatOp, bool wide);
+    void float_compare(FloatComparison, bool wide, bool swap_operands);
+    void float_sign(bool wide, bool negate);
+    void compute_address(Instruction::MemoryArgument const&, size_t access_size);
+    bool load(Instruction const&, size_t access_size, Function<void()> emit_load);
+    bool store(Instruction const&, size_t access_size);
+
+    void call_pure_helper(PureHelper, size_t first_operand);
+    void call_runtime_helper(RuntimeHelper, u64 immediate, size_t first_operand, bool may_trap);
+
+    Assembler m_assembler;
+    Store& m_store;
+    ModuleInstance const& m_module;
+    WasmFunction const& m_function;
+
+    size_t m_local_count { 0 };
+    size_t m_stack_height { 0 };
+    size_t m_max_stack_height { 0 };
+    Vector<ControlFrame> m_frames;
+
+    // Instructions after a branch are never executed until the end of the enclosing block, they are skipped.
+    bool m_unreachable { false };
+    size_t m_unreachable_depth { 0 };
+
+    Assembler::Label m_epilogue;
+    Array<Assembler::Label, to_underlying(NativeTrap::Runtime) + 1> m_trap_labels;
+};
+
+static bool is_numeric(Vector<ValueType> const& types)
+{
+    for (auto& type : types) {
+        if (!type.is_numeric())
+            return false;
+    }
+    return true;
+}
+
+static bool is_numeric(FunctionType const& type)
+{
+    return is_numeric(type.parameters()) && is_numeric(type.results());
+}
+
+bool FunctionCompiler::compile()
+{
+    auto& type = m_function.type();
+    if (!is_numeric(type) || !is_numeric(m_function.code().locals()))
+        return false;
+    m_local_count = type.parameters().size() + m_function.code().locals().size();
+
+    // Stay within the reach of 32-bit slot displacements.
+    static constexpr size_t max_slot_count = 1 * MiB;
+    if (m_local_count > max_slot_count)
+        return false;
+
+    m_assembler.push(Reg::RBP);
+    m_assembler.mov(true, Reg::RBP, Reg::RSP);
+    m_assembler.push(Reg::RBX);
+    m_assembler.push(Reg::R12);
+    m_assembler.mov(true, Reg::R12, Reg::RDI);
+    m_assembler.mov(true, Reg::RBX, Reg::RSI);
+
+    m_frames.append({ .kind = ControlFrame::Kind::Function, .stack_height = 0, .arity = type.results().size() });
+    for (auto& instruction : m_function.code().body().instructions()) {
+        if (!compile(instruction))
+            return false;
+        if (m_local_count + m_max_stack_height > max_slot_count)
+            return false;
+    }
+    if (m_frames.size() != 1)
+        return false;
+
+    // Falling off the end of the body returns the values on the stack.
+    auto& frame = m_frames.first();
+    if (!m_unreachable) {
+        if (m_stack_height != frame.arity)
+            return false;
+        for (size_t i = 0; i < frame.arity; ++i)
+            copy(stack(i), slot(i));
+    }
+    m_assembler.bind(frame.end);
+    m_assembler.arithmetic(ArithmeticOp::Xor, false, Reg::RAX, Reg::RAX);
+    m_assembler.bind(m_epilogue);
+    m_assembler.pop(Reg::R12);
+    m_assembler.pop(Reg::RBX);
+    m_assembler.pop(Reg::RBP);
+    m_assembler.ret();
+
+    for (size_t i = 0; i < m_trap_labels.size(); ++i) {
+        if (!m_trap_labels[i].is_used())
+            continue;
+        m_assembler.bind(m_trap_labels[i]);
+        m_assembler.mov(Reg::RAX, i);
+        m_assembler.jump(m_epilogue);
+    }
+    return true;
+}
+
+void FunctionCompiler::copy(Memory source, Memory destination)
+{
+    m_assembler.load(true, Reg::RAX, source);
+    m_assembler.store(true, destination, Reg::RAX);
+}
+
+void FunctionCompiler::binary(ArithmeticOp op, bool wide)
+{
+    m_assembler.load(wide, Reg::RAX, top(1));
+    m_assembler.arithmetic(op, wide, Reg::RAX, top(0));
+    m_assembler.store(true, top(1), Reg::RAX);
+    pop();
+}
+
+void FunctionCompiler::compare(Condition condition, bool wide)
+{
+    m_assembler.load(wide, Reg::RAX, top(1));
+    m_assembler.arithmetic(ArithmeticOp::Compare, wide, Reg::RAX, top(0));
+    m_assembler.set(condition, Reg::RAX);
+    m_assembler.store(true, top(1), Reg::RAX);
+    pop();
+}
+
+void FunctionCompiler::shift(ShiftOp op, bool wide)
+{
+    // The shift count is masked to the operand size by the processor, just like Wasm requires.
+    m_assembler.load(wide, Reg::RAX, top(1));
+    m_assembler.load(false, Reg::RCX, top(0));
+    m_assembler.shift(op, wide, Reg::RAX);
+    m_assembler.store(true, top(1), Reg::RAX);
+    pop();
+}
+
+void FunctionCompiler::divide(bool wide, bool is_signed, bool remainder)
+{
+    m_assembler.load(wide, Reg::RAX, top(1));
+    m_assembler.load(wide, Reg::RCX, top(0));
+    m_assembler.test(wide, Reg::RCX, Reg::RCX);
+    m_assembler.jump_if(Condition::Equal, trap_label(NativeTrap::DivisionByZero));
+
+    Assembler::Label done;
+    if (is_signed) {
+        // Dividing the smallest integer by -1 overflows, which the processor reports with an exception.
+        Assembler::Label regular;
+        m_assembler.arithmetic(ArithmeticOp::Compare, wide, Reg::RCX, -1);
+        m_assembler.jump_if(Condition::NotEqual, regular);
+        if (remainder) {
+            m_assembler.arithmetic(ArithmeticOp::Xor, false, Reg::RDX, Reg::RDX);
+            m_assembler.jump(done);
+        } else {
+            m_assembler.mov(Reg::RDX, wide ? 0x8000000000000000ull : 0x80000000ull);
+            m_assembler.arithmetic(ArithmeticOp::Compare, wide, Reg::RAX, Reg::RDX);
+            m_assembler.jump_if(Condition::Equal, trap_label(NativeTrap::IntegerOverflow));
+        }
+        m_assembler.bind(regular);
+        m_assembler.sign_extend_rax_into_rdx(wide);
+        m_assembler.signed_divide(wide, Reg::RCX);
+    } else {
+        m_assembler.arithmetic(ArithmeticOp::Xor, false, Reg::RDX, Reg::RDX);
+        m_assembler.unsigned_divide(wide, Reg::RCX);
+    }
+    m_assembler.bind(done);
+    m_assembler.store(true, top(1), remainder ? Reg::RDX : Reg::RAX);
+    pop();
+}
+
+void FunctionCompiler::count_zeroes(bool wide, bool leading)
+{
+    auto bits = wide ? 64 : 32;
+    Assembler::Label done;
+    m_assembler.load(wide, Reg::RCX, top());
+    m_assembler.mov(Reg::RAX, bits);
+    m_assembler.test(wide, Reg::RCX, Reg::RCX);
+    m_assembler.jump_if(Condition::Equal, done);
+    if (leading) {
+        // The index of the highest set bit, subtracted from bits - 1.
+        m_assembler.bit_scan_reverse(wide, Reg::RAX, Reg::RCX);
+        m_assembler.arithmetic(ArithmeticOp::Xor, wide, Reg::RAX, bits - 1);
+    } else {
+        m_assembler.bit_scan_forward(wide, Reg::RAX, Reg::RCX);
+    }
+    m_assembler.bind(done);
+    m_assembler.store(true, top(), Reg::RAX);
+}
+
+void FunctionCompiler::float_binary(FloatOp op, bool wide)
+{
+    m_assembler.load_float(wide, XmmReg::XMM0, top(1));
+    m_assembler.float_operation(op, wide, XmmReg::XMM0, top(0));
+    m_assembler.store_float(wide, top(1), XmmReg::XMM0);
+    pop();
+}
+
+void FunctionCompiler::float_compare(FloatComparison comparison, bool wide, bool swap_operands)
+{
+    m_assembler.load_float(wide, XmmReg::XMM0, swap_operands ? top(0) : top(1));
+    m_assembler.compare_float(comparison, wide, XmmReg::XMM0, swap_operands ? top(1) : top(0));
+    m_assembler.move_float_to_integer(Reg::RAX, XmmReg::XMM0);
+    m_assembler.arithmetic(ArithmeticOp::And, false, Reg::RAX, 1);
+    m_assembler.store(true, top(1), Reg::RAX);
+    pop();
+}
+
+void FunctionCompiler::float_sign(bool wide, bool negate)
+{
+    auto sign_bit = wide ? 63 : 31;
+    m_assembler.load(wide, Reg::RAX, top());
+    if (negate)
+        m_assembler.bit_test_and_complement(wide, Reg::RAX, sign_bit);
+    else
+        m_assembler.bit_test_and_reset(wide, Reg::RAX, sign_bit);
+    m_assembler.store(true, top(), Reg::RAX);
+}
+
+// Leaves the host address of the accessed memory in RAX, or traps if any byte of the access is out of bounds.
+// Memory with a guard region doesn't need the check, since out-of-bounds accesses fault there.
+void FunctionCompiler::compute_address(Instruction::MemoryArgument const& argument, size_t access_size)
+{
+    m_assembler.load(false, Reg::RAX, top());
+    if (argument.offset <= static_cast<u32>(NumericLimits<i32>::max())) {
+        if (argument.offset != 0)
+            m_assembler.arithmetic(ArithmeticOp::Add, true, Reg::RAX, static_cast<i32>(argument.offset));
+    } else {
+        m_assembler.mov(Reg::RCX, argument.offset);
+        m_assembler.arithmetic(ArithmeticOp::Add, true, Reg::RAX, Reg::RCX);
+    }
+    if (!m_store.get(m_module.memories().first())->has_guard_region()) {
+        m_assembler.lea(Reg::RCX, { Reg::RAX, static_cast<i32>(access_size) });
+        m_assembler.arithmetic(ArithmeticOp::Compare, true, Reg::RCX, context_field(offsetof(NativeContext, memory_size)));
+        m_assembler.jump_if(Condition::Above, trap_label(NativeTrap::MemoryAccessOutOfBounds));
+    }
+    m_assembler.arithmetic(ArithmeticOp::Add, true, Reg::RAX, context_field(offsetof(NativeContext, memory_base)));
+}
+
+bool FunctionCompiler::load(Instruction const& instruction, size_t access_size, Function<void()> emit_load)
+{
+    if (m_module.memories().is_empty() || !has_operands(1))
+        return false;
+    compute_address(instruction.arguments().get<Instruction::MemoryArgument>(), access_size);
+    emit_load();
+    m_assembler.store(true, top(), Reg::RAX);
+    return true;
+}
+
+bool FunctionCompiler::store(Instruction const& instruction, size_t access_size)
+{
+    if (m_module.memories().is_empty() || !has_operands(2))
+        return false;
+    m_assembler.load(true, Reg::RDX, top());
+    pop();
+    compute_address(instruction.arguments().get<Instruction::MemoryArgument>(), access_size);
+    Memory destination { Reg::RAX };
+    switch (access_size) {
+    case 1:
+        m_assembler.store8(destination, Reg::RDX);
+        break;
+    case 2:
+        m_assembler.store16(destination, Reg::RDX);
+        break;
+    case 4:
+        m_assembler.store(false, destination, Reg::RDX);
+        break;
+    case 8:
+        m_assembler.store(true, destination, Reg::RDX);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    pop();
+    return true;
+}
+
+void FunctionCompiler::call_pure_helper(PureHelper helper, size_t first_operand)
+{
+    m_assembler.lea(Reg::RDI, stack(first_operand));
+    m_assembler.call(reinterpret_cast<FlatPtr>(helper));
+}
+
+void FunctionCompiler::call_runtime_helper(RuntimeHelper helper, u64 immediate, size_t first_operand, bool may_trap)
+{
+    m_assembler.mov(true, Reg::RDI, Reg::R12);
+    m_assembler.mov(Reg::RSI, immediate);
+    m_assembler.lea(Reg::RDX, stack(first_operand));
+    m_assembler.call(reinterpret_cast<FlatPtr>(helper));
+    if (may_trap) {
+        m_assembler.test(false, Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Condition::NotEqual, trap_label(NativeTrap::Runtime));
+    }
+}
+
+Assembler::Label& FunctionCompiler::branch_target(size_t depth)
+{
+    auto& frame = m_frames[m_frames.size() - 1 - depth];
+    return frame.kind == ControlFrame::Kind::Loop ? frame.loop_or_else : frame.end;
+}
+
+bool FunctionCompiler::branch_needs_copy(size_t depth) const
+{
+    auto& frame = m_frames[m_frames.size() - 1 - depth];
+    if (frame.kind == ControlFrame::Kind::Loop || frame.arity == 0)
+        return false;
+    auto destination = frame.kind == ControlFrame::Kind::Function ? 0 : m_local_count + frame.stack_height;
+    return destination != m_local_count + m_stack_height - frame.arity;
+}
+
+// Moves the values which the target label expects to where the code after the label expects them, and jumps.
+// Branches out of the function leave the results in the first slots.
+bool FunctionCompiler::branch(size_t depth)
+{
+    if (depth >= m_frames.size())
+        return false;
+    auto& frame = m_frames[m_frames.size() - 1 - depth];
+    auto arity = frame.kind == ControlFrame::Kind::Loop ? 0 : frame.arity;
+    if (m_stack_height < frame.stack_height + arity)
+        return false;
+
+    // Values only ever move towards the bottom of the stack, so copying them in order never overwrites a value
+    // which still has to be copied.
+    auto destination = frame.kind == ControlFrame::Kind::Function ? 0 : m_local_count + frame.stack_height;
+    auto source = m_local_count + m_stack_height - arity;
+    if (destination != source) {
+        for (size_t i = 0; i < arity; ++i)
+            copy(slot(source + i), slot(destination + i));
+    }
+    m_assembler.jump(branch_target(depth));
+    return true;
+}
+
+bool FunctionCompiler::compile_block(Instruction const& instruction, ControlFrame::Kind kind)
+{
+    auto& block_type = instruction.arguments().get<Instruction::StructuredInstructionArgs>().block_type;
+    size_t arity = 0;
+    if (block_type.kind() == BlockType::Index)
+        return false;
+    if (block_type.kind() == BlockType::Type) {
+        if (!block_type.value_type().is_numeric())
+            return false;
+        arity = 1;
+    }
+
+    if (kind == ControlFrame::Kind::If) {
+        if (!has_operands(1))
+            return false;
+        m_assembler.load(false, Reg::RAX, top());
+        pop();
+        m_assembler.test(false, Reg::RAX, Reg::RAX);
+    }
+
+    m_frames.append({ .kind = kind, .stack_height = m_stack_height, .arity = arity });
+    auto& frame = m_frames.last();
+    if (kind == ControlFrame::Kind::If)
+        m_assembler.jump_if(Condition::Equal, frame.loop_or_else);
+    if (kind == ControlFrame::Kind::Loop) {
+        m_assembler.bind(frame.loop_or_else);
+        m_assembler.decrement(context_field(offsetof(NativeContext, remaining_loop_iterations)));
+        m_assembler.jump_if(Condition::Sign, trap_label(NativeTrap::ExceededLoopIterations));
+    }
+    return true;
+}
+
+bool FunctionCompiler::compile_else()
+{
+    auto& frame = m_frames.last();
+    if (frame.kind != ControlFrame::Kind::If || frame.has_else)
+        return false;
+    if (!m_unreachable) {
+        if (m_stack_height != frame.stack_height + frame.arity)
+            return false;
+        m_assembler.jump(frame.end);
+    }
+    m_assembler.bind(frame.loop_or_else);
+    frame.has_else = true;
+    m_stack_height = frame.stack_height;
+    m_unreachable = false;
+    return true;
+}
+
+bool FunctionCompiler::compile_end()
+{
+    // The end of the function body itself is implicit.
+    if (m_frames.size() < 2)
+        return false;
+    auto frame = m_frames.take_last();
+    if (!m_unreachable && m_stack_height != frame.stack_height + frame.arity)
+        return false;
+    if (frame.kind == ControlFrame::Kind::If && !frame.has_else) {
+        if (frame.arity != 0)
+            return false;
+        m_assembler.bind(frame.loop_or_else);
+    }
+    m_assembler.bind(frame.end);
+    m_stack_height = frame.stack_height;
+    push(frame.arity);
+    m_unreachable = false;
+    return true;
+}
+
+bool FunctionCompiler::compile(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    if (m_unreachable) {
+        if (opcode == Instructions::block || opcode == Instructions::loop || opcode == Instructions::if_) {
+            ++m_unreachable_depth;
+            return true;
+        }
+        if (opcode != Instructions::structured_end && opcode != Instructions::structured_else)
+            return true;
+        if (m_unreachable_depth > 0) {
+            if (opcode == Instructions::structured_end)
+                --m_unreachable_depth;
+            return true;
+        }
+    }
+
+    // Checks that the instruction's operands are on the stack.
+    auto operands = [&](size_t count) { return has_operands(count); };
+
+#    define UNARY(...)            \
+        do {                      \
+            if (!operands(1))     \
+                return false;     \
+            __VA_ARGS__;          \
+            return true;          \
+        } while (false)
+#    define BINARY(...)           \
+        do {                      \
+            if (!operands(2))     \
+                return false;     \
+            __VA_ARGS__;          \
+            return true;          \
+        } while (false)
+#    define PURE_UNARY(T, R, operation) \
+        UNARY(call_pure_helper(unary_helper<T, R, operation>, m_stack_height - 1))
+#    define PURE_BINARY(T, operation) \
+        BINARY(call_pure_helper(binary_helper<T, operation>, m_stack_height - 2); pop())
+#    define CHECKED_TRUNCATE(From, To) \
+        UNARY(call_runtime_helper(checked_truncate<From, To>, 0, m_stack_height - 1, true))
+#    define LOAD(size, ...) \
+        return load(instruction, size, [&] { __VA_ARGS__; })
+
+    Memory address { Reg::RAX };
+
+    switch (opcode.value()) {
+    case Instructions::unreachable.value():
+        m_assembler.jump(trap_label(NativeTrap::Unreachable));
+        m_unreachable = true;
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+        return compile_block(instruction, ControlFrame::Kind::Block);
+    case Instructions::loop.value():
+        return compile_block(instruction, ControlFrame::Kind::Loop);
+    case Instructions::if_.value():
+        return compile_block(instruction, ControlFrame::Kind::If);
+    case Instructions::structured_else.value():
+        return compile_else();
+    case Instructions::structured_end.value():
+        return compile_end();
+    case Instructions::br.value():
+        if (!branch(instruction.arguments().get<LabelIndex>().value()))
+            return false;
+        m_unreachable = true;
+        return true;
+    case Instructions::br_if.value(): {
+        auto depth = instruction.arguments().get<LabelIndex>().value();
+        if (depth >= m_frames.size() || !operands(1))
+            return false;
+        m_assembler.load(false, Reg::RAX, top());
+        pop();
+        m_assembler.test(false, Reg::RAX, Reg::RAX);
+        if (!branch_needs_copy(depth)) {
+            m_assembler.jump_if(Condition::NotEqual, branch_target(depth));
+            return true;
+        }
+        Assembler::Label not_taken;
+        m_assembler.jump_if(Condition::Equal, not_taken);
+        if (!branch(depth))
+            return false;
+        m_assembler.bind(not_taken);
+        return true;
+    }
+    case Instructions::br_table.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
+        if (!operands(1))
+            return false;
+        m_assembler.load(false, Reg::RCX, top());
+        pop();
+        for (size_t i = 0; i < arguments.labels.size(); ++i) {
+            auto depth = arguments.labels[i].value();
+            if (depth >= m_frames.size())
+                return false;
+            m_assembler.arithmetic(ArithmeticOp::Compare, false, Reg::RCX, static_cast<i32>(i));
+            if (!branch_needs_copy(depth)) {
+                m_assembler.jump_if(Condition::Equal, branch_target(depth));
+                continue;
+            }
+            Assembler::Label next;
+            m_assembler.jump_if(Condition::NotEqual, next);
+            if (!branch(depth))
+                return false;
+            m_assembler.bind(next);
+        }
+        if (!branch(arguments.default_.value()))
+            return false;
+        m_unreachable = true;
+        return true;
+    }
+    case Instructions::return_.value():
+        if (!branch(m_frames.size() - 1))
+            return false;
+        m_unreachable = true;
+        return true;
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        auto* callee = m_store.get(m_module.functions()[index]);
+        if (!callee)
+            return false;
+        FunctionType const* type { nullptr };
+        callee->visit([&](auto const& function) { type = &function.type(); });
+        if (!is_numeric(*type) || !operands(type->parameters().size()))
+            return false;
+        auto base = m_stack_height - type->parameters().size();
+        pop(type->parameters().size());
+        push(type->results().size());
+        call_runtime_helper(call_function, index, base, true);
+        return true;
+    }
+    case Instructions::call_indirect.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        if (arguments.type.value() >= m_module.types().size() || arguments.table.value() >= m_module.tables().size())
+            return false;
+        auto& type = m_module.types()[arguments.type.value()];
+        if (!is_numeric(type) || !operands(type.parameters().size() + 1))
+            return false;
+        auto base = m_stack_height - type.parameters().size() - 1;
+        pop(type.parameters().size() + 1);
+        push(type.results().size());
+        call_runtime_helper(call_indirect, reinterpret_cast<FlatPtr>(&arguments), base, true);
+        return true;
+    }
+    case Instructions::drop.value():
+        UNARY(pop());
+    case Instructions::select.value():
+    case Instructions::select_typed.value(): {
+        if (auto* types = instruction.arguments().get_pointer<Vector<ValueType>>(); types && !is_numeric(*types))
+            return false;
+        if (!operands(3))
+            return false;
+        Assembler::Label keep_first;
+        m_assembler.load(false, Reg::RAX, top());
+        m_assembler.test(false, Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Condition::NotEqual, keep_first);
+        copy(top(1), top(2));
+        m_assembler.bind(keep_first);
+        pop(2);
+        return true;
+    }
+    case Instructions::local_get.value(): {
+        auto index = instruction.arguments().get<LocalIndex>().value();
+        if (index >= m_local_count)
+            return false;
+        push();
+        copy(slot(index), top());
+        return true;
+    }
+    case Instructions::local_set.value():
+    case Instructions::local_tee.value(): {
+        auto index = instruction.arguments().get<LocalIndex>().value();
+        if (index >= m_local_count || !operands(1))
+            return false;
+        copy(top(), slot(index));
+        if (opcode == Instructions::local_set)
+            pop();
+        return true;
+    }
+    case Instructions::global_get.value():
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= m_module.globals().size())
+            return false;
+        auto* global = m_store.get(m_module.globals()[index]);
+        if (!global || !global->value().type().is_numeric())
+            return false;
+        if (opcode == Instructions::global_get) {
+            push();
+            call_runtime_helper(global_get, index, m_stack_height - 1, false);
+            return true;
+        }
+        if (!global->is_mutable() || !operands(1))
+            return false;
+        call_runtime_helper(global_set, index, m_stack_height - 1, false);
+        pop();
+        return true;
+    }
+    case Instructions::i32_load.value():
+    case Instructions::f32_load.value():
+        LOAD(4, m_assembler.load(false, Reg::RAX, address));
+    case Instructions::i64_load.value():
+    case Instructions::f64_load.value():
+        LOAD(8, m_assembler.load(true, Reg::RAX, address));
+    case Instructions::i32_load8_s.value():
+        LOAD(1, m_assembler.load_sign_extend8(false, Reg::RAX, address));
+    case Instructions::i32_load8_u.value():
+    case Instructions::i64_load8_u.value():
+        LOAD(1, m_assembler.load_zero_extend8(Reg::RAX, address));
+    case Instructions::i32_load16_s.value():
+        LOAD(2, m_assembler.load_sign_extend16(false, Reg::RAX, address));
+    case Instructions::i32_load16_u.value():
+    case Instructions::i64_load16_u.value():
+        LOAD(2, m_assembler.load_zero_extend16(Reg::RAX, address));
+    case Instructions::i64_load8_s.value():
+        LOAD(1, m_assembler.load_sign_extend8(true, Reg::RAX, address));
+    case Instructions::i64_load16_s.value():
+        LOAD(2, m_assembler.load_sign_extend16(true, Reg::RAX, address));
+    case Instructions::i64_load32_s.value():
+        LOAD(4, m_assembler.load_sign_extend32(Reg::RAX, address));
+    case Instructions::i64_load32_u.value():
+        LOAD(4, m_assembler.load(false, Reg::RAX, address));
+    case Instructions::i32_store.value():
+    case Instructions::f32_store.value():
+    case Instructions::i64_store32.value():
+        return store(instruction, 4);
+    case Instructions::i64_store.value():
+    case Instructions::f64_store.value():
+        return store(instruction, 8);
+    case Instructions::i32_store8.value():
+    case Instructions::i64_store8.value():
+        return store(instruction, 1);
+    case Instructions::i32_store16.value():
+    case Instructions::i64_store16.value():
+        return store(instruction, 2);
+    case Instructions::memory_size.value():
+        if (m_module.memories().is_empty())
+            return false;
+        push();
+        call_runtime_helper(memory_size, 0, m_stack_height - 1, false);
+        return true;
+    case Instructions::memory_grow.value():
+        if (m_module.memories().is_empty())
+            return false;
+        UNARY(call_runtime_helper(memory_grow, 0, m_stack_height - 1, false));
+    case Instructions::i32_const.value():
+        push();
+        m_assembler.mov(Reg::RAX, native_value_from(instruction.arguments().get<i32>()));
+        m_assembler.store(true, top(), Reg::RAX);
+        return true;
+    case Instructions::i64_const.value():
+        push();
+        m_assembler.mov(Reg::RAX, native_value_from(instruction.arguments().get<i64>()));
+        m_assembler.store(true, top(), Reg::RAX);
+        return true;
+    case Instructions::f32_const.value():
+        push();
+        m_assembler.mov(Reg::RAX, native_value_from(instruction.arguments().get<float>()));
+        m_assembler.store(true, top(), Reg::RAX);
+        return true;
+    case Instructions::f64_const.value():
+        push();
+        m_assembler.mov(Reg::RAX, native_value_from(instruction.arguments().get<double>()));
+        m_assembler.store(true, top(), Reg::RAX);
+        return true;
+    case Instructions::i32_eqz.value():
+    case Instructions::i64_eqz.value(): {
+        auto wide = opcode == Instructions::i64_eqz;
+        UNARY(m_assembler.load(wide, Reg::RAX, top()); m_assembler.test(wide, Reg::RAX, Reg::RAX); m_assembler.set(Condition::Equal, Reg::RAX); m_assembler.store(true, top(), Reg::RAX));
+    }
+    case Instructions::i32_eq.value():
+        BINARY(compare(Condition::Equal, false));
+    case Instructions::i32_ne.value():
+        BINARY(compare(Condition::NotEqual, false));
+    case Instructions::i32_lts.value():
+        BINARY(compare(Condition::Less, false));
+    case Instructions::i32_ltu.value():
+        BINARY(compare(Condition::Below, false));
+    case Instructions::i32_gts.value():
+        BINARY(compare(Condition::Greater, false));
+    case Instructions::i32_gtu.value():
+        BINARY(compare(Condition::Above, false));
+    case Instructions::i32_les.value():
+        BINARY(compare(Condition::LessOrEqual, false));
+    case Instructions::i32_leu.value():
+        BINARY(compare(Condition::BelowOrEqual, false));
+    case Instructions::i32_ges.value():
+        BINARY(compare(Condition::GreaterOrEqual, false));
+    case Instructions::i32_geu.value():
+        BINARY(compare(Condition::AboveOrEqual, false));
+    case Instructions::i64_eq.value():
+        BINARY(compare(Condition::Equal, true));
+    case Instructions::i64_ne.value():
+        BINARY(compare(Condition::NotEqual, true));
+    case Instructions::i64_lts.value():
+        BINARY(compare(Condition::Less, true));
+    case Instructions::i64_ltu.value():
+        BINARY(compare(Condition::Below, true));
+    case Instructions::i64_gts.value():
+        BINARY(compare(Condition::Greater, true));
+    case Instructions::i64_gtu.value():
+        BINARY(compare(Condition::Above, true));
+    case Instructions::i64_les.value():
+        BINARY(compare(Condition::LessOrEqual, true));
+    case Instructions::i64_leu.value():
+        BINARY(compare(Condition::BelowOrEqual, true));
+    case Instructions::i64_ges.value():
+        BINARY(compare(Condition::GreaterOrEqual, true));
+    case Instructions::i64_geu.value():
+        BINARY(compare(Condition::AboveOrEqual, true));
+    case Instructions::f32_eq.value():
+        BINARY(float_compare(FloatComparison::Equal, false, false));
+    case Instructions::f32_ne.value():
+        BINARY(float_compare(FloatComparison::NotEqual, false, false));
+    case Instructions::f32_lt.value():
+        BINARY(float_compare(FloatComparison::LessThan, false, false));
+    case Instructions::f32_gt.value():
+        BINARY(float_compare(FloatComparison::LessThan, false, true));
+    case Instructions::f32_le.value():
+        BINARY(float_compare(FloatComparison::LessOrEqual, false, false));
+    case Instructions::f32_ge.value():
+        BINARY(float_compare(FloatComparison::LessOrEqual, false, true));
+    case Instructions::f64_eq.value():
+        BINARY(float_compare(FloatComparison::Equal, true, false));
+    case Instructions::f64_ne.value():
+        BINARY(float_compare(FloatComparison::NotEqual, true, false));
+    case Instructions::f64_lt.value():
+        BINARY(float_compare(FloatComparison::LessThan, true, false));
+    case Instructions::f64_gt.value():
+        BINARY(float_compare(FloatComparison::LessThan, true, true));
+    case Instructions::f64_le.value():
+        BINARY(float_compare(FloatComparison::LessOrEqual, true, false));
+    case Instructions::f64_ge.value():
+        BINARY(float_compare(FloatComparison::LessOrEqual, true, true));
+    case Instructions::i32_clz.value():
+        UNARY(count_zeroes(false, true));
+    case Instructions::i32_ctz.value():
+        UNARY(count_zeroes(false, false));
+    case Instructions::i32_popcnt.value():
+        PURE_UNARY(u32, u32, population_count<u32>);
+    case Instructions::i32_add.value():
+        BINARY(binary(ArithmeticOp::Add, false));
+    case Instructions::i32_sub.value():
+        BINARY(binary(ArithmeticOp::Sub, false));
+    case Instructions::i32_mul.value():
+        BINARY(m_assembler.load(false, Reg::RAX, top(1)); m_assembler.multiply(false, Reg::RAX, top(0)); m_assembler.store(true, top(1), Reg::RAX); pop());
+    case Instructions::i32_divs.value():
+        BINARY(divide(false, true, false));
+    case Instructions::i32_divu.value():
+        BINARY(divide(false, false, false));
+    case Instructions::i32_rems.value():
+        BINARY(divide(false, true, true));
+    case Instructions::i32_remu.value():
+        BINARY(divide(false, false, true));
+    case Instructions::i32_and.value():
+        BINARY(binary(ArithmeticOp::And, false));
+    case Instructions::i32_or.value():
+        BINARY(binary(ArithmeticOp::Or, false));
+    case Instructions::i32_xor.value():
+        BINARY(binary(ArithmeticOp::Xor, false));
+    case Instructions::i32_shl.value():
+        BINARY(shift(ShiftOp::ShiftLeft, false));
+    case Instructions::i32_shrs.value():
+        BINARY(shift(ShiftOp::ShiftRightArithmetic, false));
+    case Instructions::i32_shru.value():
+        BINARY(shift(ShiftOp::ShiftRightLogical, false));
+    case Instructions::i32_rotl.value():
+        BINARY(shift(ShiftOp::RotateLeft, false));
+    case Instructions::i32_rotr.value():
+        BINARY(shift(ShiftOp::RotateRight, false));
+    case Instructions::i64_clz.value():
+        UNARY(count_zeroes(true, true));
+    case Instructions::i64_ctz.value():
+        UNARY(count_zeroes(true, false));
+    case Instructions::i64_popcnt.value():
+        PURE_UNARY(u64, u64, population_count<u64>);
+    case Instructions::i64_add.value():
+        BINARY(binary(ArithmeticOp::Add, true));
+    case Instructions::i64_sub.value():
+        BINARY(binary(ArithmeticOp::Sub, true));
+    case Instructions::i64_mul.value():
+        BINARY(m_assembler.load(true, Reg::RAX, top(1)); m_assembler.multiply(true, Reg::RAX, top(0)); m_assembler.store(true, top(1), Reg::RAX); pop());
+    case Instructions::i64_divs.value():
+        BINARY(divide(true, true, false));
+    case Instructions::i64_divu.value():
+        BINARY(divide(true, false, false));
+    case Instructions::i64_rems.value():
+        BINARY(divide(true, true, true));
+    case Instructions::i64_remu.value():
+        BINARY(divide(true, false, true));
+    case Instructions::i64_and.value():
+        BINARY(binary(ArithmeticOp::And, true));
+    case Instructions::i64_or.value():
+        BINARY(binary(ArithmeticOp::Or, true));
+    case Instructions::i64_xor.value():
+        BINARY(binary(ArithmeticOp::Xor, true));
+    case Instructions::i64_shl.value():
+        BINARY(shift(ShiftOp::ShiftLeft, true));
+    case Instructions::i64_shrs.value():
+        BINARY(shift(ShiftOp::ShiftRightArithmetic, true));
+    case Instructions::i64_shru.value():
+        BINARY(shift(ShiftOp::ShiftRightLogical, true));
+    case Instructions::i64_rotl.value():
+        BINARY(shift(ShiftOp::RotateLeft, true));
+    case Instructions::i64_rotr.value():
+        BINARY(shift(ShiftOp::RotateRight, true));
+    case Instructions::f32_abs.value():
+        UNARY(float_sign(false, false));
+    case Instructions::f32_neg.value():
+        UNARY(float_sign(false, true));
+    case Instructions::f32_ceil.value():
+        PURE_UNARY(float, float, float_ceil<float>);
+    case Instructions::f32_floor.value():
+        PURE_UNARY(float, float, float_floor<float>);
+    case Instructions::f32_trunc.value():
+        PURE_UNARY(float, float, float_truncate<float>);
+    case Instructions::f32_nearest.value():
+        PURE_UNARY(float, float, float_nearest<float>);
+    case Instructions::f32_sqrt.value():
+        UNARY(m_assembler.float_operation(FloatOp::SquareRoot, false, XmmReg::XMM0, top()); m_assembler.store_float(false, top(), XmmReg::XMM0));
+    case Instructions::f32_add.value():
+        BINARY(float_binary(FloatOp::Add, false));
+    case Instructions::f32_sub.value():
+        BINARY(float_binary(FloatOp::Subtract, false));
+    case Instructions::f32_mul.value():
+        BINARY(float_binary(FloatOp::Multiply, false));
+    case Instructions::f32_div.value():
+        BINARY(float_binary(FloatOp::Divide, false));
+    case Instructions::f32_min.value():
+        PURE_BINARY(float, float_minimum<float>);
+    case Instructions::f32_max.value():
+        PURE_BINARY(float, float_maximum<float>);
+    case Instructions::f32_copysign.value():
+        PURE_BINARY(float, float_copysign<float>);
+    case Instructions::f64_abs.value():
+        UNARY(float_sign(true, false));
+    case Instructions::f64_neg.value():
+        UNARY(float_sign(true, true));
+    case Instructions::f64_ceil.value():
+        PURE_UNARY(double, double, float_ceil<double>);
+    case Instructions::f64_floor.value():
+        PURE_UNARY(double, double, float_floor<double>);
+    case Instructions::f64_trunc.value():
+        PURE_UNARY(double, double, float_truncate<double>);
+    case Instructions::f64_nearest.value():
+        PURE_UNARY(double, double, float_nearest<double>);
+    case Instructions::f64_sqrt.value():
+        UNARY(m_assembler.float_operation(FloatOp::SquareRoot, true, XmmReg::XMM0, top()); m_assembler.store_float(true, top(), XmmReg::XMM0));
+    case Instructions::f64_add.value():
+        BINARY(float_binary(FloatOp::Add, true));
+    case Instructions::f64_sub.value():
+        BINARY(float_binary(FloatOp::Subtract, true));
+    case Instructions::f64_mul.value():
+        BINARY(float_binary(FloatOp::Multiply, true));
+    case Instructions::f64_div.value():
+        BINARY(float_binary(FloatOp::Divide, true));
+    case Instructions::f64_min.value():
+        PURE_BINARY(double, float_minimum<double>);
+    case Instructions::f64_max.value():
+        PURE_BINARY(double, float_maximum<double>);
+    case Instructions::f64_copysign.value():
+        PURE_BINARY(double, float_copysign<double>);
+    case Instructions::i32_wrap_i64.value():
+    case Instructions::i64_extend_ui32.value():
+        UNARY(m_assembler.load(false, Reg::RAX, top()); m_assembler.store(true, top(), Reg::RAX));
+    case Instructions::i64_extend_si32.value():
+    case Instructions::i64_extend32_s.value():
+        UNARY(m_assembler.load_sign_extend32(Reg::RAX, top()); m_assembler.store(true, top(), Reg::RAX));
+    case Instructions::i32_extend8_s.value():
+        UNARY(m_assembler.load_sign_extend8(false, Reg::RAX, top()); m_assembler.store(true, top(), Reg::RAX));
+    case Instructions::i32_extend16_s.value():
+        UNARY(m_assembler.load_sign_extend16(false, Reg::RAX, top()); m_assembler.store(true, top(), Reg::RAX));
+    case Instructions::i64_extend8_s.value():
+        UNARY(m_assembler.load_sign_extend8(true, Reg::RAX, top()); m_assembler.store(true, top(), Reg::RAX));
+    case Instructions::i64_extend16_s.value():
+        UNARY(m_assembler.load_sign_extend16(true, Reg::RAX, top()); m_assembler.store(true, top(), Reg::RAX));
+    case Instructions::i32_trunc_sf32.value():
+        CHECKED_TRUNCATE(float, i32);
+    case Instructions::i32_trunc_uf32.value():
+        CHECKED_TRUNCATE(float, u32);
+    case Instructions::i32_trunc_sf64.value():
+        CHECKED_TRUNCATE(double, i32);
+    case Instructions::i32_trunc_uf64.value():
+        CHECKED_TRUNCATE(double, u32);
+    case Instructions::i64_trunc_sf32.value():
+        CHECKED_TRUNCATE(float, i64);
+    case Instructions::i64_trunc_uf32.value():
+        CHECKED_TRUNCATE(float, u64);
+    case Instructions::i64_trunc_sf64.value():
+        CHECKED_TRUNCATE(double, i64);
+    case Instructions::i64_trunc_uf64.value():
+        CHECKED_TRUNCATE(double, u64);
+    case Instructions::i32_trunc_sat_f32_s.value():
+        PURE_UNARY(float, i32, (saturating_truncate<float, i32>));
+    case Instructions::i32_trunc_sat_f32_u.value():
+        PURE_UNARY(float, u32, (saturating_truncate<float, u32>));
+    case Instructions::i32_trunc_sat_f64_s.value():
+        PURE_UNARY(double, i32, (saturating_truncate<double, i32>));
+    case Instructions::i32_trunc_sat_f64_u.value():
+        PURE_UNARY(double, u32, (saturating_truncate<double, u32>));
+    case Instructions::i64_trunc_sat_f32_s.value():
+        PURE_UNARY(float, i64, (saturating_truncate<float, i64>));
+    case Instructions::i64_trunc_sat_f32_u.value():
+        PURE_UNARY(float, u64, (saturating_truncate<float, u64>));
+    case Instructions::i64_trunc_sat_f64_s.value():
+        PURE_UNARY(double, i64, (saturating_truncate<double, i64>));
+    case Instructions::i64_trunc_sat_f64_u.value():
+        PURE_UNARY(double, u64, (saturating_truncate<double, u64>));
+    case Instructions::f32_convert_si32.value():
+        PURE_UNARY(i32, float, (convert<i32, float>));
+    case Instructions::f32_convert_ui32.value():
+        PURE_UNARY(u32, float, (convert<u32, float>));
+    case Instructions::f32_convert_si64.value():
+        PURE_UNARY(i64, float, (convert<i64, float>));
+    case Instructions::f32_convert_ui64.value():
+        PURE_UNARY(u64, float, (convert<u64, float>));
+    case Instructions::f32_demote_f64.value():
+        PURE_UNARY(double, float, (convert<double, float>));
+    case Instructions::f64_convert_si32.value():
+        PURE_UNARY(i32, double, (convert<i32, double>));
+    case Instructions::f64_convert_ui32.value():
+        PURE_UNARY(u32, double, (convert<u32, double>));
+    case Instructions::f64_convert_si64.value():
+        PURE_UNARY(i64, double, (convert<i64, double>));
+    case Instructions::f64_convert_ui64.value():
+        PURE_UNARY(u64, double, (convert<u64, double>));
+    case Instructions::f64_promote_f32.value():
+        PURE_UNARY(float, double, (convert<float, double>));
+    case Instructions::i32_reinterpret_f32.value():
+    case Instructions::i64_reinterpret_f64.value():
+    case Instructions::f32_reinterpret_i32.value():
+    case Instructions::f64_reinterpret_i64.value():
+        // Slots hold the bits of the value regardless of its type.
+        UNARY();
+    default:
+        // Reference types, tables and bulk memory operations are left to the interpreter.
+        return false;
+    }
+
+#    undef UNARY
+#    undef BINARY
+#    undef PURE_UNARY
+#    undef PURE_BINARY
+#    undef CHECKED_TRUNCATE
+#    undef LOAD
+}
+
+}
+
+#endif
+
+bool NativeCompiler::compile(WasmFunction const& function)
+{
+#if ARCH(X86_64)
+    FunctionCompiler compiler { m_store, m_module, function };
+    if (!compiler.compile())
+        return false;
+
+    while (m_code.size() % 16 != 0)
+        m_code.append(0xcc);
+    m_functions.append({ &function.code().body(), m_code.size(), compiler.slot_count(), function.type().results() });
+    m_code.extend(compiler.code());
+    return true;
+#else
+    (void)function;
+    return false;
+#endif
+}
+
+Vector<NativeFunction> NativeCompiler::finish()
+{
+    Vector<NativeFunction> functions;
+    if (m_functions.is_empty())
+        return functions;
+    auto code = ExecutableCode::create(m_code);
+    if (!code)
+        return functions;
+
+    functions.ensure_capacity(m_functions.size());
+    for (auto& function : m_functions) {
+        auto entry = reinterpret_cast<NativeFunction::Entry>(code->data() + function.offset);
+        functions.unchecked_append({ function.body, *code, entry, function.slot_count, move(function.results) });
+    }
+    m_functions.clear();
+    m_code.clear();
+    return functions;
+}
+
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/Compiler/Assembler.h>
+
+namespace Wasm {
+
+struct NativeInterpreter;
+
+// Compiled functions keep every local and every operand stack entry in a 64-bit slot of a buffer owned by the
+// caller: locals first, then the operand stack. i32 and f32 values live in the lower half of their slot.
+// When a function returns, its results are in the first slots of the buffer.
+
+// The state which compiled code and the runtime helpers it calls share. The memory fields are refreshed by every
+// helper which may grow the memory or move its data.
+struct NativeContext {
+    NativeInterpreter* interpreter { nullptr };
+    Configuration* configuration { nullptr };
+    u8* memory_base { nullptr };
+    u64 memory_size { 0 };
+    i64 remaining_loop_iterations { 0 };
+
+    void refresh_memory();
+};
+
+// Returned by compiled functions. Traps which are detected by runtime helpers have already recorded their reason
+// in the interpreter when `Runtime` is returned.
+enum class NativeTrap : u32 {
+    None,
+    Unreachable,
+    DivisionByZero,
+    IntegerOverflow,
+    MemoryAccessOutOfBounds,
+    ExceededLoopIterations,
+    Runtime,
+};
+
+char const* native_trap_reason(NativeTrap);
+
+u64 to_native_value(Value const&);
+Value from_native_value(ValueType, u64);
+
+class ExecutableCode : public RefCounted<ExecutableCode> {
+public:
+    static RefPtr<ExecutableCode> create(ReadonlyBytes);
+    ~ExecutableCode();
+
+    u8 const* data() const { return m_data; }
+
+private:
+    ExecutableCode(u8 const* data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+    u8 const* m_data { nullptr };
+    size_t m_size { 0 };
+};
+
+struct NativeFunction {
+    using Entry = NativeTrap (*)(NativeContext*, u64* slots);
+
+    Expression const* body { nullptr };
+    NonnullRefPtr<ExecutableCode> code;
+    Entry entry { nullptr };
+    size_t slot_count { 0 };
+    Vector<ValueType> results;
+};
+
+// Translates function bodies of a module instance to x86_64 machine code in a single pass. Functions which use
+// reference types, tables, bulk memory operations or multi-value blocks are not compiled, and have to be run
+// by the interpreter instead. Compiled code depends on the module the functions belong to, and on whether the
+// memory of the instance has a guard region, since memory accesses are only bounds checked if it doesn't. It
+// may be shared by instances of that module whose memories agree in this.
+class NativeCompiler {
+public:
+    static constexpr bool is_supported()
+    {
+#if ARCH(X86_64)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    NativeCompiler(Store& store, ModuleInstance const& module)
+        : m_store(store)
+        , m_module(module)
+    {
+    }
+
+    // Returns false if the function can't be compiled, in which case nothing is emitted for it.
+    bool compile(WasmFunction const&);
+
+    // Makes the code of all compiled functions executable.
+    Vector<NativeFunction> finish();
+
+private:
+    struct PendingFunction {
+        Expression const* body { nullptr };
+        size_t offset { 0 };
+        size_t slot_count { 0 };
+        Vector<ValueType> results;
+    };
+
+    Store& m_store;
+    ModuleInstance const& m_module;
+    Vector<u8> m_code;
+    Vector<PendingFunction> m_functions;
+};
+
+}
@@ -35,6 +35,7 @@ static constexpr auto extern_memory_tag = 0x02;
 static constexpr auto extern_global_tag = 0x03;
 
 static constexpr auto page_size = 64 * KiB;
+static constexpr auto max_memory_pages = 65536;
 
 // Limits
 static constexpr auto max_allowed_call_stack_depth = 1000;
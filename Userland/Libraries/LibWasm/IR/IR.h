@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/Opcode.h>
+
+// A register-based form of function bodies which is cheaper to interpret than the parsed instructions.
+//
+// Every value a function works with lives in a 64-bit slot of its frame: the parameters and locals come first,
+// followed by the constants used by the body, followed by the operand stack. Instructions name the slots of
+// their operands and of their result explicitly, so reading a local or a constant doesn't need an instruction,
+// and neither does writing a result straight into a local. Branch targets are instruction indices.
+
+namespace Wasm::IR {
+
+// Instructions which only exist in lowered code. All others use the opcode of the Wasm instruction they were
+// lowered from, and the same operand conventions:
+// - numeric operations read `lhs` (and `rhs`) and write `destination`,
+// - loads read the address from `lhs`, stores additionally read the value from `rhs`; the offset is `immediate`,
+// - select writes `lhs` or `rhs` to `destination`, depending on the slot given by `immediate`,
+// - calls read the arguments from the slots starting at `lhs` and write the results to the same slots; the function
+//   index (or the IndirectCallArgs for call_indirect) is `immediate`,
+// - global.get writes `destination`, global.set reads `lhs`; the global index is `immediate`.
+namespace Opcodes {
+
+static constexpr OpCode copy = 0xfe00,
+                        jump = 0xfe01,
+                        jump_if_zero = 0xfe02,
+                        jump_if_not_zero = 0xfe03,
+                        // Continues at the jump which follows this instruction at index min(`lhs`, `immediate`).
+                        jump_table = 0xfe04,
+                        return_ = 0xfe05;
+
+}
+
+struct Instruction {
+    OpCode opcode;
+    u32 destination { 0 };
+    u32 lhs { 0 };
+    u32 rhs { 0 };
+    u64 immediate { 0 };
+};
+
+struct Function {
+    Vector<Instruction> instructions;
+    Vector<u64> constants;
+    size_t local_count { 0 };
+    size_t slot_count { 0 };
+    // The slot holding the first result when the function returns.
+    size_t result_slot { 0 };
+    Vector<ValueType> results;
+};
+
+// Returns null if the function uses features which aren't supported by the IR, such as reference types, tables,
+// bulk memory operations and multi-value block types.
+OwnPtr<Function> lower(Store&, ModuleInstance const&, WasmFunction const&);
+
+}
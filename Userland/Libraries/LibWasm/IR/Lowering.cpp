@@ -0,0 +1,715 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <LibWasm/AbstractMachine/Operators.h>
+#include <LibWasm/IR/IR.h>
+
+namespace Wasm::IR {
+
+namespace {
+
+// Wasm instructions are lowered one by one while keeping track of where the value of each operand stack entry
+// currently is. Pushing a local or a constant only records its slot, and the value is copied to the entry's own
+// slot on the stack (its "home") only once that is necessary: before the local is overwritten, and wherever
+// control flow merges, since all incoming paths have to agree on where values are.
+class Lowering {
+public:
+    Lowering(Store& store, ModuleInstance const& module, WasmFunction const& function)
+        : m_store(store)
+        , m_module(module)
+        , m_function(function)
+    {
+    }
+
+    OwnPtr<Function> lower();
+
+private:
+    struct ControlFrame {
+        enum class Kind {
+            Function,
+            Block,
+            Loop,
+            If,
+        };
+
+        Kind kind;
+        size_t stack_height { 0 };
+        size_t arity { 0 };
+        size_t end_label { 0 };
+        size_t loop_or_else_label { 0 }; // The loop header of loops, the start of the else branch of ifs.
+        bool has_else { false };
+    };
+
+    struct Label {
+        Optional<u32> target;
+        Vector<u32> jump_sites;
+    };
+
+    // The result of the last emitted instruction, which may still be redirected into a local.
+    struct PendingResult {
+        size_t instruction { 0 };
+        size_t stack_index { 0 };
+    };
+
+    u32 home(size_t stack_index) const { return m_stack_base + stack_index; }
+    bool has_operands(size_t count) const { return m_stack.size() >= m_frames.last().stack_height + count; }
+
+    u32 pop() { return m_stack.take_last(); }
+    void push(u32 slot)
+    {
+        m_stack.append(slot);
+        m_max_stack_height = max(m_max_stack_height, m_stack.size());
+    }
+    u32 push_home()
+    {
+        push(home(m_stack.size()));
+        return m_stack.last();
+    }
+
+    size_t emit(OpCode opcode, u32 destination = 0, u32 lhs = 0, u32 rhs = 0, u64 immediate = 0)
+    {
+        m_pending_result.clear();
+        m_instructions.append({ opcode, destination, lhs, rhs, immediate });
+        return m_instructions.size() - 1;
+    }
+    void emit_result(OpCode opcode, u32 lhs = 0, u32 rhs = 0, u64 immediate = 0)
+    {
+        auto destination = push_home();
+        auto index = emit(opcode, destination, lhs, rhs, immediate);
+        m_pending_result = PendingResult { index, m_stack.size() - 1 };
+    }
+    void emit_copy(u32 destination, u32 source)
+    {
+        if (destination != source)
+            emit(Opcodes::copy, destination, source);
+    }
+
+    size_t create_label()
+    {
+        m_labels.append({});
+        return m_labels.size() - 1;
+    }
+    void bind(size_t label_index)
+    {
+        auto& label = m_labels[label_index];
+        label.target = m_instructions.size();
+        for (auto site : label.jump_sites)
+            m_instructions[site].immediate = *label.target;
+        label.jump_sites.clear();
+        m_pending_result.clear();
+    }
+    void emit_jump(OpCode opcode, size_t label_index, u32 condition = 0)
+    {
+        auto& label = m_labels[label_index];
+        auto site = emit(opcode, 0, condition, 0, label.target.value_or(0));
+        if (!label.target.has_value())
+            label.jump_sites.append(site);
+    }
+
+    void materialize(size_t stack_index)
+    {
+        emit_copy(home(stack_index), m_stack[stack_index]);
+        m_stack[stack_index] = home(stack_index);
+    }
+    void materialize_from(size_t stack_index)
+    {
+        for (size_t i = stack_index; i < m_stack.size(); ++i)
+            materialize(i);
+    }
+    void materialize_uses_of_local(u32 local, size_t stack_end)
+    {
+        for (size_t i = 0; i < stack_end; ++i) {
+            if (m_stack[i] == local)
+                materialize(i);
+        }
+    }
+
+    u32 constant_slot(u64 value) const { return m_local_count + m_constant_indices.get(value).value(); }
+    void collect_constants();
+
+    bool lower(Wasm::Instruction const&);
+    bool lower_block(Wasm::Instruction const&, ControlFrame::Kind);
+    bool lower_else();
+    bool lower_end();
+    bool lower_local_set(size_t local, bool tee);
+    bool lower_branch_if(size_t depth);
+    bool lower_branch_table(Wasm::Instruction::TableBranchArgs const&);
+    bool lower_call(FunctionType const&, u64 immediate, size_t extra_operands, OpCode);
+
+    ControlFrame const& frame(size_t depth) const { return m_frames[m_frames.size() - 1 - depth]; }
+    u32 branch_destination(size_t depth) const { return home(frame(depth).stack_height); }
+    size_t branch_arity(size_t depth) const { return frame(depth).kind == ControlFrame::Kind::Loop ? 0 : frame(depth).arity; }
+    size_t branch_label(size_t depth) const
+    {
+        auto& target = frame(depth);
+        return target.kind == ControlFrame::Kind::Loop ? target.loop_or_else_label : target.end_label;
+    }
+    bool branch_needs_copy(size_t depth) const;
+    void emit_branch_copies(size_t depth);
+    bool lower_branch(size_t depth);
+
+    Store& m_store;
+    ModuleInstance const& m_module;
+    WasmFunction const& m_function;
+
+    Vector<Instruction> m_instructions;
+    Vector<Label> m_labels;
+    Vector<ControlFrame> m_frames;
+    Vector<u32> m_stack;
+    size_t m_max_stack_height { 0 };
+    Optional<PendingResult> m_pending_result;
+
+    u32 m_local_count { 0 };
+    u32 m_stack_base { 0 };
+    Vector<u64> m_constants;
+    HashMap<u64, u32> m_constant_indices;
+
+    // Instructions after a branch are never executed until the end of the enclosing block, they are skipped.
+    bool m_unreachable { false };
+    size_t m_unreachable_depth { 0 };
+};
+
+static bool is_numeric(Vector<ValueType> const& types)
+{
+    for (auto& type : types) {
+        if (!type.is_numeric())
+            return false;
+    }
+    return true;
+}
+
+static bool is_numeric(FunctionType const& type)
+{
+    return is_numeric(type.parameters()) && is_numeric(type.results());
+}
+
+// The number of operands of instructions which pop their operands and push a single result, or 0 for all others.
+static size_t numeric_operand_count(OpCode opcode)
+{
+    auto value = opcode.value();
+    if (value == Wasm::Instructions::i32_eqz.value() || value == Wasm::Instructions::i64_eqz.value())
+        return 1;
+    if (value >= Wasm::Instructions::i32_eq.value() && value <= Wasm::Instructions::f64_ge.value())
+        return 2;
+    if (value >= Wasm::Instructions::i32_clz.value() && value <= Wasm::Instructions::i32_popcnt.value())
+        return 1;
+    if (value >= Wasm::Instructions::i32_add.value() && value <= Wasm::Instructions::i32_rotr.value())
+        return 2;
+    if (value >= Wasm::Instructions::i64_clz.value() && value <= Wasm::Instructions::i64_popcnt.value())
+        return 1;
+    if (value >= Wasm::Instructions::i64_add.value() && value <= Wasm::Instructions::i64_rotr.value())
+        return 2;
+    if (value >= Wasm::Instructions::f32_abs.value() && value <= Wasm::Instructions::f32_sqrt.value())
+        return 1;
+    if (value >= Wasm::Instructions::f32_add.value() && value <= Wasm::Instructions::f32_copysign.value())
+        return 2;
+    if (value >= Wasm::Instructions::f64_abs.value() && value <= Wasm::Instructions::f64_sqrt.value())
+        return 1;
+    if (value >= Wasm::Instructions::f64_add.value() && value <= Wasm::Instructions::f64_copysign.value())
+        return 2;
+    if (value >= Wasm::Instructions::i32_wrap_i64.value() && value <= Wasm::Instructions::i64_extend32_s.value())
+        return 1;
+    if (value >= Wasm::Instructions::i32_trunc_sat_f32_s.value() && value <= Wasm::Instructions::i64_trunc_sat_f64_u.value())
+        return 1;
+    return 0;
+}
+
+static Optional<size_t> memory_access_size(OpCode opcode)
+{
+    switch (opcode.value()) {
+    case Wasm::Instructions::i32_load8_s.value():
+    case Wasm::Instructions::i32_load8_u.value():
+    case Wasm::Instructions::i64_load8_s.value():
+    case Wasm::Instructions::i64_load8_u.value():
+    case Wasm::Instructions::i32_store8.value():
+    case Wasm::Instructions::i64_store8.value():
+        return 1;
+    case Wasm::Instructions::i32_load16_s.value():
+    case Wasm::Instructions::i32_load16_u.value():
+    case Wasm::Instructions::i64_load16_s.value():
+    case Wasm::Instructions::i64_load16_u.value():
+    case Wasm::Instructions::i32_store16.value():
+    case Wasm::Instructions::i64_store16.value():
+        return 2;
+    case Wasm::Instructions::i32_load.value():
+    case Wasm::Instructions::f32_load.value():
+    case Wasm::Instructions::i64_load32_s.value():
+    case Wasm::Instructions::i64_load32_u.value():
+    case Wasm::Instructions::i32_store.value():
+    case Wasm::Instructions::f32_store.value():
+    case Wasm::Instructions::i64_store32.value():
+        return 4;
+    case Wasm::Instructions::i64_load.value():
+    case Wasm::Instructions::f64_load.value():
+    case Wasm::Instructions::i64_store.value():
+    case Wasm::Instructions::f64_store.value():
+        return 8;
+    default:
+        return {};
+    }
+}
+
+static bool is_store(OpCode opcode)
+{
+    return opcode.value() >= Wasm::Instructions::i32_store.value() && opcode.value() <= Wasm::Instructions::i64_store32.value();
+}
+
+void Lowering::collect_constants()
+{
+    for (auto& instruction : m_function.code().body().instructions()) {
+        u64 value;
+        switch (instruction.opcode().value()) {
+        case Wasm::Instructions::i32_const.value():
+            value = Operators::native_value_from(instruction.arguments().get<i32>());
+            break;
+        case Wasm::Instructions::i64_const.value():
+            value = Operators::native_value_from(instruction.arguments().get<i64>());
+            break;
+        case Wasm::Instructions::f32_const.value():
+            value = Operators::native_value_from(instruction.arguments().get<float>());
+            break;
+        case Wasm::Instructions::f64_const.value():
+            value = Operators::native_value_from(instruction.arguments().get<double>());
+            break;
+        default:
+            continue;
+        }
+        if (m_constant_indices.contains(value))
+            continue;
+        m_constant_indices.set(value, m_constants.size());
+        m_constants.append(value);
+    }
+}
+
+OwnPtr<Function> Lowering::lower()
+{
+    auto& type = m_function.type();
+    if (!is_numeric(type) || !is_numeric(m_function.code().locals()))
+        return {};
+
+    // Stay within the reach of 32-bit slot indices.
+    static constexpr size_t max_slot_count = 1 * MiB;
+    auto local_count = type.parameters().size() + m_function.code().locals().size();
+    if (local_count > max_slot_count)
+        return {};
+    m_local_count = local_count;
+    collect_constants();
+    m_stack_base = m_local_count + m_constants.size();
+
+    m_frames.append({ .kind = ControlFrame::Kind::Function, .stack_height = 0, .arity = type.results().size(), .end_label = create_label() });
+    for (auto& instruction : m_function.code().body().instructions()) {
+        if (!lower(instruction))
+            return {};
+        if (m_stack_base + m_max_stack_height > max_slot_count)
+            return {};
+    }
+    if (m_frames.size() != 1)
+        return {};
+
+    // Falling off the end of the body returns the values on the stack.
+    if (!m_unreachable) {
+        if (m_stack.size() != m_frames.first().arity)
+            return {};
+        materialize_from(0);
+    }
+    bind(m_frames.first().end_label);
+    emit(Opcodes::return_);
+
+    auto function = make<Function>();
+    function->instructions = move(m_instructions);
+    function->constants = move(m_constants);
+    function->local_count = m_local_count;
+    function->slot_count = max(m_stack_base + max(m_max_stack_height, type.results().size()), 1u);
+    function->result_slot = m_stack_base;
+    function->results = type.results();
+    return function;
+}
+
+bool Lowering::lower_block(Wasm::Instruction const& instruction, ControlFrame::Kind kind)
+{
+    auto& block_type = instruction.arguments().get<Wasm::Instruction::StructuredInstructionArgs>().block_type;
+    size_t arity = 0;
+    if (block_type.kind() == BlockType::Index)
+        return false;
+    if (block_type.kind() == BlockType::Type) {
+        if (!block_type.value_type().is_numeric())
+            return false;
+        arity = 1;
+    }
+
+    Optional<u32> condition;
+    if (kind == ControlFrame::Kind::If) {
+        if (!has_operands(1))
+            return false;
+        condition = pop();
+    }
+
+    // Code inside the block may or may not run, so values below it must not be moved lazily in there.
+    materialize_from(0);
+    m_frames.append({ .kind = kind, .stack_height = m_stack.size(), .arity = arity, .end_label = create_label(), .loop_or_else_label = create_label() });
+    if (kind == ControlFrame::Kind::If)
+        emit_jump(Opcodes::jump_if_zero, m_frames.last().loop_or_else_label, *condition);
+    if (kind == ControlFrame::Kind::Loop)
+        bind(m_frames.last().loop_or_else_label);
+    return true;
+}
+
+bool Lowering::lower_else()
+{
+    auto& frame = m_frames.last();
+    if (frame.kind != ControlFrame::Kind::If || frame.has_else)
+        return false;
+    if (!m_unreachable) {
+        if (m_stack.size() != frame.stack_height + frame.arity)
+            return false;
+        materialize_from(frame.stack_height);
+        emit_jump(Opcodes::jump, frame.end_label);
+    }
+    bind(frame.loop_or_else_label);
+    frame.has_else = true;
+    m_stack.resize(frame.stack_height);
+    m_unreachable = false;
+    return true;
+}
+
+bool Lowering::lower_end()
+{
+    // The end of the function body itself is implicit.
+    if (m_frames.size() < 2)
+        return false;
+    auto frame = m_frames.take_last();
+    if (!m_unreachable) {
+        if (m_stack.size() != frame.stack_height + frame.arity)
+            return false;
+        materialize_from(frame.stack_height);
+    }
+    if (frame.kind == ControlFrame::Kind::If && !frame.has_else) {
+        if (frame.arity != 0)
+            return false;
+        bind(frame.loop_or_else_label);
+    }
+    bind(frame.end_label);
+    m_stack.resize(frame.stack_height);
+    for (size_t i = 0; i < frame.arity; ++i)
+        push_home();
+    m_unreachable = false;
+    return true;
+}
+
+bool Lowering::lower_local_set(size_t local, bool tee)
+{
+    if (local >= m_local_count || !has_operands(1))
+        return false;
+
+    auto top = m_stack.size() - 1;
+    materialize_uses_of_local(local, top);
+
+    // Have the instruction which computed the value write it to the local directly.
+    if (m_pending_result.has_value() && m_pending_result->instruction == m_instructions.size() - 1 && m_pending_result->stack_index == top) {
+        m_instructions.last().destination = local;
+        m_pending_result.clear();
+        m_stack[top] = local;
+    } else {
+        emit_copy(local, m_stack[top]);
+    }
+
+    if (!tee)
+        pop();
+    return true;
+}
+
+bool Lowering::branch_needs_copy(size_t depth) const
+{
+    auto arity = branch_arity(depth);
+    auto destination = branch_destination(depth);
+    for (size_t i = 0; i < arity; ++i) {
+        if (m_stack[m_stack.size() - arity + i] != destination + i)
+            return true;
+    }
+    return false;
+}
+
+// Moves the values which the target label expects to where the code after the label expects them. Values only
+// ever move towards the bottom of the stack, so copying them in order never overwrites one which still has to be
+// copied.
+void Lowering::emit_branch_copies(size_t depth)
+{
+    auto arity = branch_arity(depth);
+    auto destination = branch_destination(depth);
+    for (size_t i = 0; i < arity; ++i)
+        emit_copy(destination + i, m_stack[m_stack.size() - arity + i]);
+}
+
+bool Lowering::lower_branch(size_t depth)
+{
+    if (depth >= m_frames.size() || m_stack.size() < frame(depth).stack_height + branch_arity(depth))
+        return false;
+    emit_branch_copies(depth);
+    emit_jump(Opcodes::jump, branch_label(depth));
+    m_unreachable = true;
+    return true;
+}
+
+bool Lowering::lower_branch_if(size_t depth)
+{
+    if (depth >= m_frames.size() || !has_operands(1))
+        return false;
+
+    // Branch on the operand of a preceding eqz instead of computing it.
+    auto jump_if_taken = Opcodes::jump_if_not_zero;
+    auto jump_if_not_taken = Opcodes::jump_if_zero;
+    auto condition_index = m_stack.size() - 1;
+    u32 condition;
+    if (m_pending_result.has_value() && m_pending_result->stack_index == condition_index
+        && m_pending_result->instruction == m_instructions.size() - 1 && m_instructions.last().opcode == Wasm::Instructions::i32_eqz) {
+        condition = m_instructions.take_last().lhs;
+        m_pending_result.clear();
+        swap(jump_if_taken, jump_if_not_taken);
+        pop();
+    } else {
+        condition = pop();
+    }
+
+    if (m_stack.size() < frame(depth).stack_height + branch_arity(depth))
+        return false;
+    if (!branch_needs_copy(depth)) {
+        emit_jump(jump_if_taken, branch_label(depth), condition);
+        return true;
+    }
+    auto not_taken = create_label();
+    emit_jump(jump_if_not_taken, not_taken, condition);
+    emit_branch_copies(depth);
+    emit_jump(Opcodes::jump, branch_label(depth));
+    bind(not_taken);
+    return true;
+}
+
+bool Lowering::lower_branch_table(Wasm::Instruction::TableBranchArgs const& arguments)
+{
+    if (!has_operands(1))
+        return false;
+    auto selector = pop();
+
+    auto target_count = arguments.labels.size() + 1;
+    auto label_at = [&](size_t i) { return i < arguments.labels.size() ? arguments.labels[i].value() : arguments.default_.value(); };
+    for (size_t i = 0; i < target_count; ++i) {
+        auto depth = label_at(i);
+        if (depth >= m_frames.size() || m_stack.size() < frame(depth).stack_height + branch_arity(depth))
+            return false;
+    }
+
+    emit(Opcodes::jump_table, 0, selector, 0, arguments.labels.size());
+    Vector<Optional<size_t>> stubs;
+    stubs.resize(target_count);
+    for (size_t i = 0; i < target_count; ++i) {
+        auto depth = label_at(i);
+        if (branch_needs_copy(depth)) {
+            stubs[i] = create_label();
+            emit_jump(Opcodes::jump, *stubs[i]);
+        } else {
+            emit_jump(Opcodes::jump, branch_label(depth));
+        }
+    }
+    for (size_t i = 0; i < target_count; ++i) {
+        if (!stubs[i].has_value())
+            continue;
+        bind(*stubs[i]);
+        emit_branch_copies(label_at(i));
+        emit_jump(Opcodes::jump, branch_label(label_at(i)));
+    }
+    m_unreachable = true;
+    return true;
+}
+
+bool Lowering::lower_call(FunctionType const& type, u64 immediate, size_t extra_operands, OpCode opcode)
+{
+    auto operand_count = type.parameters().size() + extra_operands;
+    if (!is_numeric(type) || !has_operands(operand_count))
+        return false;
+    auto first_operand = m_stack.size() - operand_count;
+    materialize_from(first_operand);
+    auto base = home(first_operand);
+    m_stack.resize(first_operand);
+    for (size_t i = 0; i < type.results().size(); ++i)
+        push_home();
+    emit(opcode, 0, base, 0, immediate);
+    return true;
+}
+
+bool Lowering::lower(Wasm::Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    if (m_unreachable) {
+        if (opcode == Wasm::Instructions::block || opcode == Wasm::Instructions::loop || opcode == Wasm::Instructions::if_) {
+            ++m_unreachable_depth;
+            return true;
+        }
+        if (opcode != Wasm::Instructions::structured_end && opcode != Wasm::Instructions::structured_else)
+            return true;
+        if (m_unreachable_depth > 0) {
+            if (opcode == Wasm::Instructions::structured_end)
+                --m_unreachable_depth;
+            return true;
+        }
+    }
+
+    if (auto operand_count = numeric_operand_count(opcode); operand_count != 0) {
+        if (!has_operands(operand_count))
+            return false;
+        // These only reinterpret the bits of the slot, which i32 values already keep zero-extended.
+        if (opcode == Wasm::Instructions::i32_reinterpret_f32 || opcode == Wasm::Instructions::i64_reinterpret_f64
+            || opcode == Wasm::Instructions::f32_reinterpret_i32 || opcode == Wasm::Instructions::f64_reinterpret_i64
+            || opcode == Wasm::Instructions::i64_extend_ui32)
+            return true;
+        auto rhs = operand_count == 2 ? pop() : 0;
+        auto lhs = pop();
+        emit_result(opcode, lhs, rhs);
+        return true;
+    }
+
+    if (auto access_size = memory_access_size(opcode); access_size.has_value()) {
+        if (m_module.memories().is_empty())
+            return false;
+        auto offset = instruction.arguments().get<Wasm::Instruction::MemoryArgument>().offset;
+        if (is_store(opcode)) {
+            if (!has_operands(2))
+                return false;
+            auto value = pop();
+            auto address = pop();
+            emit(opcode, 0, address, value, offset);
+        } else {
+            if (!has_operands(1))
+                return false;
+            emit_result(opcode, pop(), 0, offset);
+        }
+        return true;
+    }
+
+    switch (opcode.value()) {
+    case Wasm::Instructions::unreachable.value():
+        emit(opcode);
+        m_unreachable = true;
+        return true;
+    case Wasm::Instructions::nop.value():
+        return true;
+    case Wasm::Instructions::block.value():
+        return lower_block(instruction, ControlFrame::Kind::Block);
+    case Wasm::Instructions::loop.value():
+        return lower_block(instruction, ControlFrame::Kind::Loop);
+    case Wasm::Instructions::if_.value():
+        return lower_block(instruction, ControlFrame::Kind::If);
+    case Wasm::Instructions::structured_else.value():
+        return lower_else();
+    case Wasm::Instructions::structured_end.value():
+        return lower_end();
+    case Wasm::Instructions::br.value():
+        return lower_branch(instruction.arguments().get<LabelIndex>().value());
+    case Wasm::Instructions::br_if.value():
+        return lower_branch_if(instruction.arguments().get<LabelIndex>().value());
+    case Wasm::Instructions::br_table.value():
+        return lower_branch_table(instruction.arguments().get<Wasm::Instruction::TableBranchArgs>());
+    case Wasm::Instructions::return_.value():
+        return lower_branch(m_frames.size() - 1);
+    case Wasm::Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        auto* callee = m_store.get(m_module.functions()[index]);
+        if (!callee)
+            return false;
+        FunctionType const* type { nullptr };
+        callee->visit([&](auto const& function) { type = &function.type(); });
+        return lower_call(*type, index, 0, opcode);
+    }
+    case Wasm::Instructions::call_indirect.value(): {
+        auto& arguments = instruction.arguments().get<Wasm::Instruction::IndirectCallArgs>();
+        if (arguments.type.value() >= m_module.types().size() || arguments.table.value() >= m_module.tables().size())
+            return false;
+        return lower_call(m_module.types()[arguments.type.value()], reinterpret_cast<FlatPtr>(&arguments), 1, opcode);
+    }
+    case Wasm::Instructions::drop.value():
+        if (!has_operands(1))
+            return false;
+        pop();
+        return true;
+    case Wasm::Instructions::select.value():
+    case Wasm::Instructions::select_typed.value(): {
+        if (auto* types = instruction.arguments().get_pointer<Vector<ValueType>>(); types && !is_numeric(*types))
+            return false;
+        if (!has_operands(3))
+            return false;
+        auto condition = pop();
+        auto rhs = pop();
+        auto lhs = pop();
+        emit_result(Wasm::Instructions::select, lhs, rhs, condition);
+        return true;
+    }
+    case Wasm::Instructions::local_get.value(): {
+        auto index = instruction.arguments().get<LocalIndex>().value();
+        if (index >= m_local_count)
+            return false;
+        push(index);
+        return true;
+    }
+    case Wasm::Instructions::local_set.value():
+        return lower_local_set(instruction.arguments().get<LocalIndex>().value(), false);
+    case Wasm::Instructions::local_tee.value():
+        return lower_local_set(instruction.arguments().get<LocalIndex>().value(), true);
+    case Wasm::Instructions::global_get.value():
+    case Wasm::Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= m_module.globals().size())
+            return false;
+        auto* global = m_store.get(m_module.globals()[index]);
+        if (!global || !global->value().type().is_numeric())
+            return false;
+        if (opcode == Wasm::Instructions::global_get) {
+            emit_result(opcode, 0, 0, index);
+            return true;
+        }
+        if (!global->is_mutable() || !has_operands(1))
+            return false;
+        emit(opcode, 0, pop(), 0, index);
+        return true;
+    }
+    case Wasm::Instructions::memory_size.value():
+        if (m_module.memories().is_empty())
+            return false;
+        emit_result(opcode);
+        return true;
+    case Wasm::Instructions::memory_grow.value():
+        if (m_module.memories().is_empty() || !has_operands(1))
+            return false;
+        emit_result(opcode, pop());
+        return true;
+    case Wasm::Instructions::i32_const.value():
+        push(constant_slot(Operators::native_value_from(instruction.arguments().get<i32>())));
+        return true;
+    case Wasm::Instructions::i64_const.value():
+        push(constant_slot(Operators::native_value_from(instruction.arguments().get<i64>())));
+        return true;
+    case Wasm::Instructions::f32_const.value():
+        push(constant_slot(Operators::native_value_from(instruction.arguments().get<float>())));
+        return true;
+    case Wasm::Instructions::f64_const.value():
+        push(constant_slot(Operators::native_value_from(instruction.arguments().get<double>())));
+        return true;
+    default:
+        // Reference types, tables and bulk memory operations are left to the bytecode interpreter.
+        return false;
+    }
+}
+
+}
+
+OwnPtr<Function> lower(Store& store, ModuleInstance const& module, WasmFunction const& function)
+{
+    return Lowering { store, module, function }.lower();
+}
+
+}
@@ -0,0 +1,9 @@
+// Fixtures/Modules/coremark.wasm is also a benchmark, see coremark.wat. Its checksum was computed independently,
+// and has to be the same for every execution engine.
+test("coremark checksum", () => {
+    const module = parseWebAssemblyModule(readBinaryWasmFile("Fixtures/Modules/coremark.wasm"));
+    const run = module.getExport("run");
+    expect(module.invoke(run, 0)).toBe(0);
+    expect(module.invoke(run, 10)).toBe(29507);
+    expect(module.invoke(run, 10)).toBe(29507);
+});
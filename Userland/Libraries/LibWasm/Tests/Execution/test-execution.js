@@ -0,0 +1,144 @@
+// The functions in this module cover control flow, calls, memory and numeric instructions.
+// Running test-wasm with --ir-interpreter or --native-compiler runs them with those engines instead of the interpreter.
+// prettier-ignore
+const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x44, 0x0d, 0x60, 0x01, 0x7f, 0x01, 0x7e,
+        0x60, 0x01, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x03, 0x7f, 0x7f, 0x7f,
+        0x01, 0x7f, 0x60, 0x02, 0x7c, 0x7c, 0x01, 0x7c, 0x60, 0x02, 0x7c, 0x7c, 0x01, 0x7f, 0x60, 0x01,
+        0x7c, 0x01, 0x7c, 0x60, 0x01, 0x7e, 0x01, 0x7e, 0x60, 0x02, 0x7e, 0x7e, 0x01, 0x7e, 0x60, 0x00,
+        0x01, 0x7f, 0x60, 0x00, 0x00, 0x60, 0x01, 0x7c, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7c, 0x03, 0x1a,
+        0x19, 0x00, 0x01, 0x01, 0x01, 0x02, 0x02, 0x01, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x02, 0x01,
+        0x09, 0x01, 0x01, 0x0a, 0x0b, 0x01, 0x0a, 0x08, 0x0c, 0x01, 0x04, 0x04, 0x01, 0x70, 0x00, 0x02,
+        0x05, 0x03, 0x01, 0x00, 0x01, 0x06, 0x06, 0x01, 0x7f, 0x01, 0x41, 0x00, 0x0b, 0x07, 0xe4, 0x01,
+        0x18, 0x03, 0x66, 0x61, 0x63, 0x00, 0x00, 0x03, 0x66, 0x69, 0x62, 0x00, 0x01, 0x03, 0x73, 0x75,
+        0x6d, 0x00, 0x02, 0x04, 0x6c, 0x6f, 0x61, 0x64, 0x00, 0x03, 0x05, 0x64, 0x69, 0x76, 0x5f, 0x73,
+        0x00, 0x04, 0x05, 0x72, 0x65, 0x6d, 0x5f, 0x73, 0x00, 0x05, 0x06, 0x73, 0x77, 0x69, 0x74, 0x63,
+        0x68, 0x00, 0x06, 0x06, 0x73, 0x65, 0x6c, 0x65, 0x63, 0x74, 0x00, 0x07, 0x05, 0x68, 0x79, 0x70,
+        0x6f, 0x74, 0x00, 0x08, 0x06, 0x66, 0x36, 0x34, 0x5f, 0x67, 0x65, 0x00, 0x09, 0x07, 0x6e, 0x65,
+        0x61, 0x72, 0x65, 0x73, 0x74, 0x00, 0x0a, 0x04, 0x62, 0x69, 0x74, 0x73, 0x00, 0x0b, 0x04, 0x72,
+        0x6f, 0x74, 0x6c, 0x00, 0x0c, 0x0d, 0x63, 0x61, 0x6c, 0x6c, 0x5f, 0x69, 0x6e, 0x64, 0x69, 0x72,
+        0x65, 0x63, 0x74, 0x00, 0x0d, 0x07, 0x63, 0x6f, 0x75, 0x6e, 0x74, 0x65, 0x72, 0x00, 0x0f, 0x04,
+        0x67, 0x72, 0x6f, 0x77, 0x00, 0x10, 0x06, 0x6e, 0x65, 0x73, 0x74, 0x65, 0x64, 0x00, 0x11, 0x0b,
+        0x75, 0x6e, 0x72, 0x65, 0x61, 0x63, 0x68, 0x61, 0x62, 0x6c, 0x65, 0x00, 0x12, 0x05, 0x74, 0x72,
+        0x75, 0x6e, 0x63, 0x00, 0x13, 0x0c, 0x65, 0x61, 0x72, 0x6c, 0x79, 0x5f, 0x72, 0x65, 0x74, 0x75,
+        0x72, 0x6e, 0x00, 0x14, 0x08, 0x69, 0x6e, 0x66, 0x69, 0x6e, 0x69, 0x74, 0x65, 0x00, 0x15, 0x0c,
+        0x69, 0x36, 0x34, 0x5f, 0x6d, 0x75, 0x6c, 0x5f, 0x64, 0x69, 0x76, 0x75, 0x00, 0x16, 0x08, 0x6d,
+        0x69, 0x6e, 0x5f, 0x7a, 0x65, 0x72, 0x6f, 0x00, 0x17, 0x08, 0x62, 0x79, 0x74, 0x65, 0x5f, 0x6f,
+        0x70, 0x73, 0x00, 0x18, 0x09, 0x08, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x02, 0x0e, 0x01, 0x0a, 0xd0,
+        0x03, 0x19, 0x26, 0x01, 0x01, 0x7e, 0x42, 0x01, 0x21, 0x01, 0x02, 0x40, 0x20, 0x00, 0x45, 0x0d,
+        0x00, 0x03, 0x40, 0x20, 0x01, 0x20, 0x00, 0xad, 0x7e, 0x21, 0x01, 0x20, 0x00, 0x41, 0x7f, 0x6a,
+        0x22, 0x00, 0x0d, 0x00, 0x0b, 0x0b, 0x20, 0x01, 0x0b, 0x1c, 0x00, 0x20, 0x00, 0x41, 0x02, 0x48,
+        0x04, 0x7f, 0x20, 0x00, 0x05, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x10, 0x01, 0x20, 0x00, 0x41, 0x02,
+        0x6b, 0x10, 0x01, 0x6a, 0x0b, 0x0b, 0x52, 0x02, 0x01, 0x7f, 0x01, 0x7f, 0x02, 0x40, 0x03, 0x40,
+        0x20, 0x01, 0x20, 0x00, 0x4e, 0x0d, 0x01, 0x20, 0x01, 0x41, 0x04, 0x6c, 0x20, 0x01, 0x41, 0x03,
+        0x6c, 0x36, 0x02, 0x00, 0x20, 0x01, 0x41, 0x01, 0x6a, 0x21, 0x01, 0x0c, 0x00, 0x0b, 0x0b, 0x41,
+        0x00, 0x21, 0x01, 0x02, 0x40, 0x03, 0x40, 0x20, 0x01, 0x20, 0x00, 0x4e, 0x0d, 0x01, 0x20, 0x02,
+        0x20, 0x01, 0x41, 0x04, 0x6c, 0x28, 0x02, 0x00, 0x6a, 0x21, 0x02, 0x20, 0x01, 0x41, 0x01, 0x6a,
+        0x21, 0x01, 0x0c, 0x00, 0x0b, 0x0b, 0x20, 0x02, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x28, 0x02, 0x04,
+        0x0b, 0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x6d, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x6f,
+        0x0b, 0x22, 0x00, 0x02, 0x40, 0x02, 0x40, 0x02, 0x40, 0x02, 0x40, 0x20, 0x00, 0x0e, 0x03, 0x00,
+        0x01, 0x02, 0x03, 0x0b, 0x41, 0x0a, 0x0f, 0x0b, 0x41, 0x14, 0x0f, 0x0b, 0x41, 0x1e, 0x0f, 0x0b,
+        0x41, 0xe3, 0x00, 0x0b, 0x09, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20, 0x02, 0x1b, 0x0b, 0x0e, 0x00,
+        0x20, 0x00, 0x20, 0x00, 0xa2, 0x20, 0x01, 0x20, 0x01, 0xa2, 0xa0, 0x9f, 0x0b, 0x07, 0x00, 0x20,
+        0x00, 0x20, 0x01, 0x66, 0x0b, 0x05, 0x00, 0x20, 0x00, 0x9e, 0x0b, 0x16, 0x00, 0x20, 0x00, 0x7b,
+        0x20, 0x00, 0x79, 0x42, 0xe4, 0x00, 0x7e, 0x7c, 0x20, 0x00, 0x7a, 0x42, 0x90, 0xce, 0x00, 0x7e,
+        0x7c, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x89, 0x0b, 0x09, 0x00, 0x20, 0x01, 0x20, 0x00,
+        0x11, 0x01, 0x00, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x41, 0x02, 0x6c, 0x0b, 0x0b, 0x00, 0x23, 0x00,
+        0x41, 0x01, 0x6a, 0x24, 0x00, 0x23, 0x00, 0x0b, 0x09, 0x00, 0x20, 0x00, 0x40, 0x00, 0x1a, 0x3f,
+        0x00, 0x0b, 0x16, 0x00, 0x02, 0x7f, 0x41, 0x07, 0x02, 0x7f, 0x41, 0x01, 0x41, 0x02, 0x20, 0x00,
+        0x0c, 0x01, 0x0b, 0x1a, 0x0b, 0x41, 0x05, 0x6a, 0x0b, 0x03, 0x00, 0x00, 0x0b, 0x05, 0x00, 0x20,
+        0x00, 0xaa, 0x0b, 0x1f, 0x01, 0x01, 0x7f, 0x03, 0x40, 0x20, 0x01, 0x41, 0x01, 0x6a, 0x22, 0x01,
+        0x20, 0x00, 0x46, 0x04, 0x40, 0x20, 0x01, 0x41, 0xe8, 0x07, 0x6c, 0x0f, 0x0b, 0x0c, 0x00, 0x0b,
+        0x41, 0x7f, 0x0b, 0x07, 0x00, 0x03, 0x40, 0x0c, 0x00, 0x0b, 0x0b, 0x0d, 0x00, 0x20, 0x00, 0x20,
+        0x01, 0x7e, 0x20, 0x01, 0x80, 0x20, 0x00, 0x7c, 0x0b, 0x1f, 0x00, 0x44, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0xf0, 0x3f, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x44, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa4, 0xa6, 0x0b, 0x17, 0x00, 0x41, 0xe4, 0x00, 0x20, 0x00,
+        0x3a, 0x00, 0x00, 0x41, 0xe4, 0x00, 0x2c, 0x00, 0x00, 0x41, 0xe4, 0x00, 0x2f, 0x01, 0x00, 0x6a,
+        0x0b
+]);
+
+const module = parseWebAssemblyModule(binary);
+const call = (name, ...args) => module.invoke(module.getExport(name), ...args);
+
+test("loops and branches", () => {
+    expect(call("fac", 0)).toBe(1);
+    expect(call("fac", 20)).toBe(2432902008176640000);
+    expect(call("early_return", 4)).toBe(4000);
+    expect(call("nested", 9)).toBe(14);
+});
+
+test("br_table", () => {
+    expect(call("switch", 0)).toBe(10);
+    expect(call("switch", 1)).toBe(20);
+    expect(call("switch", 2)).toBe(30);
+    expect(call("switch", 3)).toBe(99);
+    expect(call("switch", 1000)).toBe(99);
+});
+
+test("select", () => {
+    expect(call("select", 1, 2, 1)).toBe(1);
+    expect(call("select", 1, 2, 0)).toBe(2);
+});
+
+test("recursive calls", () => {
+    expect(call("fib", 1)).toBe(1);
+    expect(call("fib", 20)).toBe(6765);
+});
+
+test("indirect calls", () => {
+    expect(call("call_indirect", 0, 21)).toBe(42);
+    expect(call("call_indirect", 1, 10)).toBe(55);
+    expect(() => call("call_indirect", 2, 10)).toThrowWithMessage(TypeError, "Execution trapped");
+});
+
+test("globals", () => {
+    const first = call("counter");
+    expect(call("counter")).toBe(first + 1);
+});
+
+test("memory", () => {
+    expect(call("sum", 100)).toBe(14850);
+    expect(call("load", 65528)).toBe(0);
+    expect(() => call("load", 65529)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(() => call("load", -1)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(() => call("load", -0x80000000)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(call("byte_ops", 255)).toBe(254);
+    expect(call("byte_ops", 127)).toBe(254);
+});
+
+test("memory.grow", () => {
+    const pages = call("grow", 0);
+    expect(call("grow", 2)).toBe(pages + 2);
+    expect(() => call("load", pages * 65536 + 65528)).not.toThrow();
+});
+
+test("integer arithmetic", () => {
+    expect(call("div_s", 7, 2)).toBe(3);
+    expect(call("rem_s", 7, 3)).toBe(1);
+    expect(() => call("div_s", 7, 0)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(() => call("rem_s", 7, 0)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(call("bits", 4096)).toBe(125101);
+    expect(call("rotl", 1, 65)).toBe(2);
+    expect(call("i64_mul_divu", 6, 3)).toBe(12);
+});
+
+test("floating point arithmetic", () => {
+    expect(call("hypot", 3, 4)).toBe(5);
+    expect(call("f64_ge", 1, 1)).toBe(1);
+    expect(call("f64_ge", 2, 1)).toBe(1);
+    expect(call("f64_ge", 1, 2)).toBe(0);
+    expect(call("nearest", 2.5)).toBe(2);
+    expect(call("nearest", -1.5)).toBe(-2);
+    expect(call("min_zero")).toBe(-1);
+});
+
+test("conversions", () => {
+    expect(call("trunc", 42.9)).toBe(42);
+    expect(call("trunc", -42.9)).toBe(-42);
+    expect(() => call("trunc", 3e10)).toThrowWithMessage(TypeError, "Execution trapped");
+    expect(() => call("trunc", NaN)).toThrowWithMessage(TypeError, "Execution trapped");
+});
+
+test("unreachable", () => {
+    expect(() => call("unreachable")).toThrowWithMessage(TypeError, "Execution trapped");
+});
@@ -0,0 +1,478 @@
+;; A CoreMark-style benchmark for the execution engines of LibWasm.
+;;
+;; Every iteration runs a linked list, a matrix and a state machine kernel over pseudo-random data, and folds their
+;; results into a CRC16, just like CoreMark does. The checksum only depends on the number of iterations, so all
+;; engines have to agree on it:
+;;
+;;     wasm --engine interpreter coremark.wasm -e run --arg 1000
+;;     wasm --engine ir coremark.wasm -e run --arg 1000
+;;     wasm --engine native coremark.wasm -e run --arg 1000
+;;
+;; coremark.wasm is this file assembled by wat2wasm.
+
+(module
+  (memory 1)
+
+  ;; Memory layout:
+  ;;   0x0008  linked list, 128 nodes of 8 bytes (next, value), a next of 0 ends the list
+  ;;   0x1000  matrix A, 16x16 i32
+  ;;   0x1400  matrix B, 16x16 i32
+  ;;   0x1800  matrix C = A * B, 16x16 i32
+  ;;   0x2000  state machine input, 256 bytes
+  ;;   0x2200  alphabet of the state machine input
+
+  (data (i32.const 0x2200) "0123456789.,e+-E")
+
+  (global $seed (mut i32) (i32.const 0x66))
+
+  (func $random (result i32)
+    global.get $seed
+    i32.const 1103515245
+    i32.mul
+    i32.const 12345
+    i32.add
+    global.set $seed
+    global.get $seed
+    i32.const 16
+    i32.shr_u)
+
+  (func $crc8 (param $data i32) (param $crc i32) (result i32)
+    (local $i i32) (local $x16 i32)
+    i32.const 8
+    local.set $i
+    loop $bits
+      local.get $data
+      local.get $crc
+      i32.xor
+      i32.const 1
+      i32.and
+      local.set $x16
+      local.get $data
+      i32.const 1
+      i32.shr_u
+      local.set $data
+      local.get $crc
+      i32.const 0x4002
+      i32.xor
+      local.get $crc
+      local.get $x16
+      select
+      i32.const 1
+      i32.shr_u
+      local.get $x16
+      i32.const 15
+      i32.shl
+      i32.or
+      local.set $crc
+      local.get $i
+      i32.const 1
+      i32.sub
+      local.tee $i
+      br_if $bits
+    end
+    local.get $crc)
+
+  (func $crc16 (param $value i32) (param $crc i32) (result i32)
+    local.get $value
+    i32.const 8
+    i32.shr_u
+    i32.const 0xff
+    i32.and
+    local.get $value
+    i32.const 0xff
+    i32.and
+    local.get $crc
+    call $crc8
+    call $crc8)
+
+  (func $crc32 (param $value i32) (param $crc i32) (result i32)
+    local.get $value
+    i32.const 16
+    i32.shr_u
+    local.get $value
+    i32.const 0xffff
+    i32.and
+    local.get $crc
+    call $crc16
+    call $crc16)
+
+  (func $init (result i32)
+    (local $i i32) (local $node i32)
+    i32.const 0x66
+    global.set $seed
+    ;; The list is linked in memory order at first.
+    i32.const 8
+    local.set $node
+    loop $nodes
+      local.get $node
+      local.get $node
+      i32.const 8
+      i32.add
+      i32.const 0
+      local.get $node
+      i32.const 0x400
+      i32.lt_u
+      select
+      i32.store
+      local.get $node
+      call $random
+      i32.const 0x7fff
+      i32.and
+      i32.store offset=4
+      local.get $node
+      i32.const 8
+      i32.add
+      local.tee $node
+      i32.const 0x408
+      i32.lt_u
+      br_if $nodes
+    end
+    i32.const 0
+    local.set $i
+    loop $matrices
+      local.get $i
+      call $random
+      i32.const 0xff
+      i32.and
+      i32.store offset=0x1000
+      local.get $i
+      call $random
+      i32.const 0xff
+      i32.and
+      i32.store offset=0x1400
+      local.get $i
+      i32.const 4
+      i32.add
+      local.tee $i
+      i32.const 0x400
+      i32.lt_u
+      br_if $matrices
+    end
+    i32.const 0
+    local.set $i
+    loop $input
+      local.get $i
+      call $random
+      i32.const 15
+      i32.and
+      i32.load8_u offset=0x2200
+      i32.store8 offset=0x2000
+      local.get $i
+      i32.const 1
+      i32.add
+      local.tee $i
+      i32.const 256
+      i32.lt_u
+      br_if $input
+    end
+    i32.const 8)
+
+  ;; Reverses the list in place, and returns its new head.
+  (func $list_reverse (param $node i32) (result i32)
+    (local $previous i32) (local $next i32)
+    block $done
+      loop $nodes
+        local.get $node
+        i32.eqz
+        br_if $done
+        local.get $node
+        i32.load
+        local.set $next
+        local.get $node
+        local.get $previous
+        i32.store
+        local.get $node
+        local.set $previous
+        local.get $next
+        local.set $node
+        br $nodes
+      end
+    end
+    local.get $previous)
+
+  ;; Folds the values of the list in list order, and counts the values whose low byte matches the key.
+  (func $list_checksum (param $node i32) (param $key i32) (result i32)
+    (local $sum i32) (local $found i32) (local $value i32)
+    block $done
+      loop $nodes
+        local.get $node
+        i32.eqz
+        br_if $done
+        local.get $node
+        i32.load offset=4
+        local.set $value
+        local.get $sum
+        i32.const 31
+        i32.mul
+        local.get $value
+        i32.add
+        local.set $sum
+        local.get $found
+        local.get $value
+        i32.const 0xff
+        i32.and
+        local.get $key
+        i32.eq
+        i32.add
+        local.set $found
+        local.get $node
+        i32.load
+        local.set $node
+        br $nodes
+      end
+    end
+    local.get $sum
+    local.get $found
+    i32.const 16
+    i32.shl
+    i32.xor)
+
+  ;; Adds a scalar to A, computes C = A * B and returns a checksum of C.
+  (func $matrix (param $scalar i32) (result i32)
+    (local $i i32) (local $j i32) (local $k i32) (local $sum i32) (local $checksum i32)
+    i32.const 0
+    local.set $i
+    loop $add
+      local.get $i
+      local.get $i
+      i32.load offset=0x1000
+      local.get $scalar
+      i32.add
+      i32.const 0xffff
+      i32.and
+      i32.store offset=0x1000
+      local.get $i
+      i32.const 4
+      i32.add
+      local.tee $i
+      i32.const 0x400
+      i32.lt_u
+      br_if $add
+    end
+    i32.const 0
+    local.set $i
+    loop $rows
+      i32.const 0
+      local.set $j
+      loop $columns
+        i32.const 0
+        local.set $sum
+        i32.const 0
+        local.set $k
+        loop $products
+          local.get $sum
+          local.get $i
+          i32.const 6
+          i32.shl
+          local.get $k
+          i32.const 2
+          i32.shl
+          i32.add
+          i32.load offset=0x1000
+          local.get $k
+          i32.const 6
+          i32.shl
+          local.get $j
+          i32.const 2
+          i32.shl
+          i32.add
+          i32.load offset=0x1400
+          i32.mul
+          i32.add
+          local.set $sum
+          local.get $k
+          i32.const 1
+          i32.add
+          local.tee $k
+          i32.const 16
+          i32.lt_u
+          br_if $products
+        end
+        local.get $i
+        i32.const 6
+        i32.shl
+        local.get $j
+        i32.const 2
+        i32.shl
+        i32.add
+        local.get $sum
+        i32.store offset=0x1800
+        local.get $checksum
+        i32.const 5
+        i32.rotl
+        local.get $sum
+        i32.xor
+        local.set $checksum
+        local.get $j
+        i32.const 1
+        i32.add
+        local.tee $j
+        i32.const 16
+        i32.lt_u
+        br_if $columns
+      end
+      local.get $i
+      i32.const 1
+      i32.add
+      local.tee $i
+      i32.const 16
+      i32.lt_u
+      br_if $rows
+    end
+    local.get $checksum)
+
+  ;; Scans the input for comma separated numbers, starting at an offset which depends on the iteration. Returns the
+  ;; final states of all tokens and the number of state transitions.
+  ;; States: 0 start, 1 integer, 2 float, 3 exponent, 4 scientific, 5 invalid.
+  (func $state_machine (param $start i32) (result i32)
+    (local $i i32) (local $c i32) (local $digit i32) (local $state i32) (local $previous i32)
+    (local $transitions i32) (local $checksum i32)
+    loop $scan
+      local.get $start
+      local.get $i
+      i32.add
+      i32.const 0xff
+      i32.and
+      i32.load8_u offset=0x2000
+      local.set $c
+      block $next
+        local.get $c
+        i32.const 44
+        i32.eq
+        if
+          local.get $checksum
+          i32.const 7
+          i32.mul
+          local.get $state
+          i32.add
+          local.set $checksum
+          i32.const 0
+          local.set $state
+          br $next
+        end
+        local.get $c
+        i32.const 48
+        i32.sub
+        i32.const 10
+        i32.lt_u
+        local.set $digit
+        local.get $state
+        local.set $previous
+        block $invalid
+          block $scientific
+            block $exponent
+              block $float
+                block $integer
+                  local.get $state
+                  br_table $integer $integer $float $exponent $scientific $invalid
+                end
+                ;; start and integer
+                i32.const 1
+                i32.const 2
+                i32.const 5
+                local.get $c
+                i32.const 46
+                i32.eq
+                select
+                local.get $digit
+                select
+                local.set $state
+                br $invalid
+              end
+              ;; float
+              i32.const 2
+              i32.const 3
+              i32.const 5
+              local.get $c
+              i32.const 32
+              i32.or
+              i32.const 101
+              i32.eq
+              select
+              local.get $digit
+              select
+              local.set $state
+              br $invalid
+            end
+            ;; exponent
+            i32.const 4
+            i32.const 5
+            local.get $digit
+            local.get $c
+            i32.const 43
+            i32.eq
+            i32.or
+            local.get $c
+            i32.const 45
+            i32.eq
+            i32.or
+            select
+            local.set $state
+            br $invalid
+          end
+          ;; scientific
+          i32.const 4
+          i32.const 5
+          local.get $digit
+          select
+          local.set $state
+        end
+        local.get $transitions
+        local.get $state
+        local.get $previous
+        i32.ne
+        i32.add
+        local.set $transitions
+      end
+      local.get $i
+      i32.const 1
+      i32.add
+      local.tee $i
+      i32.const 256
+      i32.lt_u
+      br_if $scan
+    end
+    local.get $checksum
+    local.get $transitions
+    i32.const 16
+    i32.shl
+    i32.xor)
+
+  (func (export "run") (param $iterations i32) (result i32)
+    (local $i i32) (local $crc i32) (local $list i32)
+    call $init
+    local.set $list
+    block $done
+      loop $iteration
+        local.get $i
+        local.get $iterations
+        i32.ge_u
+        br_if $done
+        local.get $list
+        call $list_reverse
+        local.tee $list
+        local.get $i
+        call $list_checksum
+        local.get $crc
+        call $crc32
+        local.set $crc
+        local.get $i
+        call $matrix
+        local.get $crc
+        call $crc32
+        local.set $crc
+        local.get $i
+        i32.const 7
+        i32.mul
+        call $state_machine
+        local.get $crc
+        call $crc32
+        local.set $crc
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br $iteration
+      end
+    end
+    local.get $crc))
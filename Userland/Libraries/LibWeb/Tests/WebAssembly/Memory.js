@@ -0,0 +1,38 @@
+describe("WebAssembly.Memory", () => {
+    loadLocalPage("/res/html/misc/blank.html");
+
+    afterInitialPageLoad(page => {
+        test("buffer stays the same until the memory grows", () => {
+            const memory = new page.WebAssembly.Memory({ initial: 1 });
+            const buffer = memory.buffer;
+            expect(memory.buffer).toBe(buffer);
+            expect(buffer.byteLength).toBe(65536);
+        });
+
+        test("grow() detaches the old buffer", () => {
+            const memory = new page.WebAssembly.Memory({ initial: 1 });
+            const buffer = memory.buffer;
+            const bytes = new Uint8Array(buffer);
+            bytes[0] = 42;
+
+            expect(memory.grow(1)).toBe(1);
+            expect(buffer.byteLength).toBe(0);
+            expect(bytes.length).toBe(0);
+            expect(bytes[0]).toBeUndefined();
+
+            expect(memory.buffer).not.toBe(buffer);
+            expect(memory.buffer.byteLength).toBe(131072);
+            expect(new Uint8Array(memory.buffer)[0]).toBe(42);
+        });
+
+        test("grow(0) detaches the old buffer as well", () => {
+            const memory = new page.WebAssembly.Memory({ initial: 1 });
+            const buffer = memory.buffer;
+            expect(memory.grow(0)).toBe(1);
+            expect(buffer.byteLength).toBe(0);
+            expect(memory.buffer.byteLength).toBe(65536);
+        });
+    });
+
+    waitForPageToLoad();
+});
@@ -38,6 +38,8 @@ JS_DEFINE_NATIVE_FUNCTION(WebAssemblyMemoryPrototype::grow)
         vm.throw_exception<JS::TypeError>(global_object, "Memory.grow() grows past the stated limit of the memory instance");
         return {};
     }
+    // The old buffer is detached even when growing by zero pages, which doesn't call the memory's on_grow.
+    WebAssemblyObject::detach_memory_buffer(address);
 
     return JS::Value(static_cast<u32>(previous_size));
 }
@@ -49,15 +51,10 @@ JS_DEFINE_NATIVE_GETTER(WebAssemblyMemoryPrototype::buffer_getter)
         vm.throw_exception<JS::TypeError>(global_object, JS::ErrorType::NotA, "Memory");
         return {};
     }
-    auto* memory_object = static_cast<WebAssemblyMemoryObject*>(this_object);
-    auto address = memory_object->address();
-    auto* memory = WebAssemblyObject::s_abstract_machine.store().get(address);
-    if (!memory)
+    auto* buffer = static_cast<WebAssemblyMemoryObject*>(this_object)->buffer();
+    if (!buffer)
         return JS::js_undefined();
-
-    auto array_buffer = JS::ArrayBuffer::create(global_object, &memory->data());
-    array_buffer->set_detach_key(JS::js_string(vm, "WebAssembly.Memory"));
-    return array_buffer;
+    return buffer;
 }
 
 }
@@ -62,6 +62,7 @@ NonnullOwnPtrVector<Wasm::ModuleInstance> WebAssemblyObject::s_instantiated_modu
 Vector<WebAssemblyObject::ModuleCache> WebAssemblyObject::s_module_caches;
 WebAssemblyObject::GlobalModuleCache WebAssemblyObject::s_global_cache;
 Wasm::AbstractMachine WebAssemblyObject::s_abstract_machine;
+HashMap<Wasm::MemoryAddress, JS::ArrayBuffer*> WebAssemblyObject::s_memory_buffers;
 
 void WebAssemblyObject::visit_edges(Visitor& visitor)
 {
@@ -75,6 +76,17 @@ void WebAssemblyObject::visit_edges(Visitor& visitor)
         for (auto& entry : module_cache.memory_instances)
             visitor.visit(entry.value);
     }
+    for (auto& entry : s_memory_buffers)
+        visitor.visit(entry.value);
+}
+
+void WebAssemblyObject::detach_memory_buffer(Wasm::MemoryAddress address)
+{
+    auto buffer = s_memory_buffers.get(address);
+    if (!buffer.has_value())
+        return;
+    buffer.value()->detach_buffer();
+    s_memory_buffers.remove(address);
 }
 
 JS_DEFINE_NATIVE_FUNCTION(WebAssemblyObject::validate)
@@ -92,10 +104,10 @@ Result<size_t, JS::Value> parse_module(JS::GlobalObject& global_object, JS::Obje
         data = buffer.buffer();
     } else if (is<JS::TypedArrayBase>(buffer_object)) {
         auto& buffer = static_cast<JS::TypedArrayBase&>(*buffer_object);
-        data = buffer.viewed_array_buffer()->buffer().span().slice(buffer.byte_offset(), buffer.byte_length());
+        data = buffer.viewed_array_buffer()->buffer().slice(buffer.byte_offset(), buffer.byte_length());
     } else if (is<JS::DataView>(buffer_object)) {
         auto& buffer = static_cast<JS::DataView&>(*buffer_object);
-        data = buffer.viewed_array_buffer()->buffer().span().slice(buffer.byte_offset(), buffer.byte_length());
+        data = buffer.viewed_array_buffer()->buffer().slice(buffer.byte_offset(), buffer.byte_length());
     } else {
         auto error = JS::TypeError::create(global_object, "Not a BufferSource");
         return JS::Value { error };
@@ -459,4 +471,20 @@ WebAssemblyMemoryObject::WebAssemblyMemoryObject(JS::GlobalObject& global_object
 {
 }
 
+JS::ArrayBuffer* WebAssemblyMemoryObject::buffer()
+{
+    if (auto buffer = WebAssemblyObject::s_memory_buffers.get(m_address); buffer.has_value())
+        return buffer.value();
+
+    auto* memory = WebAssemblyObject::s_abstract_machine.store().get(m_address);
+    if (!memory)
+        return nullptr;
+
+    auto* buffer = JS::ArrayBuffer::create(global_object(), memory->data());
+    buffer->set_detach_key(JS::js_string(vm(), "WebAssembly.Memory"));
+    WebAssemblyObject::s_memory_buffers.set(m_address, buffer);
+    memory->on_grow = [address = m_address] { WebAssemblyObject::detach_memory_buffer(address); };
+    return buffer;
+}
+
 }
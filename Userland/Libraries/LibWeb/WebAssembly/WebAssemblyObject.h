@@ -52,6 +52,11 @@ public:
         HashMap<Wasm::FunctionAddress, JS::NativeFunction*> function_instances;
     };
 
+    // The ArrayBuffer that WebAssembly.Memory's buffer returns for each memory. It views the memory directly, so
+    // it's detached when the memory grows, which may move it, and a new one is handed out after that.
+    static HashMap<Wasm::MemoryAddress, JS::ArrayBuffer*> s_memory_buffers;
+    static void detach_memory_buffer(Wasm::MemoryAddress);
+
     static NonnullOwnPtrVector<CompiledWebAssemblyModule> s_compiled_modules;
     static NonnullOwnPtrVector<Wasm::ModuleInstance> s_instantiated_modules;
     static Vector<ModuleCache> s_module_caches;
@@ -73,6 +78,7 @@ public:
     virtual ~WebAssemblyMemoryObject() override = default;
 
     auto address() const { return m_address; }
+    JS::ArrayBuffer* buffer();
 
 private:
     Wasm::MemoryAddress m_address;
@@ -7,7 +7,7 @@
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
 #include <Kernel/API/InodeWatcherEvent.h>
-#include <LibCompress/Gzip.h>
+#include <LibCompress/LZ4.h>
 #include <LibCore/File.h>
 #include <LibCore/FileWatcher.h>
 #include <LibCoreDump/Backtrace.h>
@@ -41,12 +41,12 @@ static bool compress_coredump(const String& coredump_path)
         return false;
     }
     auto coredump_file = file_or_error.value();
-    auto compressed_coredump = Compress::GzipCompressor::compress_all(coredump_file->bytes());
+    auto compressed_coredump = Compress::LZ4Compressor::compress_all(coredump_file->bytes());
     if (!compressed_coredump.has_value()) {
         dbgln("Could not compress coredump '{}'", coredump_path);
         return false;
     }
-    auto output_path = String::formatted("{}.gz", coredump_path);
+    auto output_path = String::formatted("{}.lz4", coredump_path);
     auto output_file_or_error = Core::File::open(output_path, Core::OpenMode::WriteOnly);
     if (output_file_or_error.is_error()) {
         dbgln("Could not open '{}' for writing: {}", output_path, output_file_or_error.error());
@@ -133,7 +133,7 @@ int main()
         if (event.value().type != Core::FileWatcherEvent::Type::ChildCreated)
             continue;
         auto& coredump_path = event.value().event_path;
-        if (coredump_path.ends_with(".gz"))
+        if (coredump_path.ends_with(".lz4"))
             continue; // stops compress_coredump from accidentally triggering us
         dbgln("New coredump file: {}", coredump_path);
         wait_until_coredump_is_ready(coredump_path);
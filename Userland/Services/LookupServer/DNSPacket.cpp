@@ -117,8 +117,9 @@ Optional<DNSPacket> DNSPacket::from_raw_packet(const u8* raw_data, size_t raw_si
     packet.m_query_or_response = header.is_response();
     packet.m_code = header.response_code();
 
-    // FIXME: Should we parse further in this case?
-    if (packet.code() != Code::NOERROR)
+    // NOTE: NXDOMAIN responses are parsed too, their authority section says how long the name is known not to exist.
+    // FIXME: Should we parse further in other cases?
+    if (packet.code() != Code::NOERROR && packet.code() != Code::NXDOMAIN)
         return packet;
 
     size_t offset = sizeof(DNSPacketHeader);
@@ -176,6 +177,32 @@ Optional<DNSPacket> DNSPacket::from_raw_packet(const u8* raw_data, size_t raw_si
         offset += record.data_length();
     }
 
+    // A negative response (NXDOMAIN, or NOERROR without any answers) has the zone's SOA record in its authority section.
+    // We may cache the negative result for the lesser of the SOA record's TTL and its MINIMUM field (RFC 2308, section 5).
+    for (u16 i = 0; i < header.authority_count(); ++i) {
+        DNSName::parse(raw_data, offset, raw_size);
+        if (offset + sizeof(DNSRecordWithoutName) > raw_size)
+            break;
+
+        auto& record = *(const DNSRecordWithoutName*)(&raw_data[offset]);
+        offset += sizeof(DNSRecordWithoutName);
+        if (offset + record.data_length() > raw_size)
+            break;
+
+        if ((DNSRecordType)record.type() == DNSRecordType::SOA) {
+            size_t soa_offset = offset;
+            // Skip MNAME and RNAME, the fields after them are SERIAL, REFRESH, RETRY, EXPIRE and MINIMUM.
+            DNSName::parse(raw_data, soa_offset, raw_size);
+            DNSName::parse(raw_data, soa_offset, raw_size);
+            if (soa_offset + 5 * sizeof(u32) <= offset + record.data_length()) {
+                u32 minimum = *(const NetworkOrdered<u32>*)(&raw_data[soa_offset + 4 * sizeof(u32)]);
+                packet.m_negative_caching_ttl = min(record.ttl(), minimum);
+                dbgln_if(LOOKUPSERVER_DEBUG, "Authority #{}: SOA, ttl={}, minimum={}", i, record.ttl(), minimum);
+            }
+        }
+        offset += record.data_length();
+    }
+
     return packet;
 }
 
@@ -56,6 +56,9 @@ public:
         return m_answers.size();
     }
 
+    // How long a negative response may be cached, if the server told us (see RFC 2308).
+    Optional<u32> negative_caching_ttl() const { return m_negative_caching_ttl; }
+
     void add_question(const DNSQuestion&);
     void add_answer(const DNSAnswer&);
 
@@ -84,6 +87,7 @@ private:
     bool m_recursion_available { true };
     Vector<DNSQuestion> m_questions;
     Vector<DNSAnswer> m_answers;
+    Optional<u32> m_negative_caching_ttl;
 };
 
 }
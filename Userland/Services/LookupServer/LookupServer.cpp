@@ -27,6 +27,14 @@ namespace LookupServer {
 static LookupServer* s_the;
 // NOTE: This is the TTL we return for the hostname or answers from /etc/hosts.
 static constexpr u32 s_static_ttl = 86400;
+// NOTE: When the cache holds this many names, the least recently used one makes room for a new one.
+static constexpr size_t s_max_cached_names = 256;
+// NOTE: We don't remember that a name doesn't exist for longer than this, whatever its zone says.
+static constexpr u32 s_max_negative_ttl = 15 * 60;
+// NOTE: Names looked up at least this often are looked up again shortly before their answers expire,
+//       so clients that keep using them don't have to wait for the nameservers.
+static constexpr u32 s_prefetch_hit_threshold = 2;
+static constexpr int s_cache_cleanup_interval_ms = 60 * 1000;
 
 LookupServer& LookupServer::the()
 {
@@ -74,6 +82,16 @@ LookupServer::LookupServer()
     }
     m_mdns = MulticastDNS::construct(this);
 
+    m_cache_cleanup_timer = Core::Timer::create_repeating(
+        s_cache_cleanup_interval_ms, [this] {
+            remove_expired_cache_entries();
+            dbgln_if(LOOKUPSERVER_DEBUG, "Cache: {} names, {} hits, {} negative hits, {} misses, {} prefetches, {} evictions",
+                m_lookup_cache.size(), m_cache_statistics.hits, m_cache_statistics.negative_hits, m_cache_statistics.misses,
+                m_cache_statistics.prefetches, m_cache_statistics.evictions);
+        },
+        this);
+    m_cache_cleanup_timer->start();
+
     m_local_server = Core::LocalServer::construct(this);
     m_local_server->on_ready_to_accept = [this]() {
         auto socket = m_local_server->accept();
@@ -187,17 +205,35 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.get(name); cached_answers.has_value()) {
-        for (auto& answer : cached_answers.value()) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
+    if (auto it = m_lookup_cache.find(name); it != m_lookup_cache.end()) {
+        auto& entry = it->value;
+        auto now = time(nullptr);
+        entry.answers.remove_all_matching([](auto& answer) { return answer.has_expired(); });
+        entry.negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.expiry_time <= now; });
+
+        for (auto& answer : entry.answers) {
+            if (answer.type() == record_type) {
                 dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
                 add_answer(answer);
             }
         }
-        if (!answers.is_empty())
+        if (!answers.is_empty()) {
+            ++m_cache_statistics.hits;
+            entry.last_used = now;
+            ++entry.hit_count;
+            prefetch_if_about_to_expire(name, record_type, entry);
             return answers;
+        }
+        if (entry.is_known_not_to_have(record_type, now)) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Negative cache hit: {} has no {} records", name.as_string(), record_type);
+            ++m_cache_statistics.negative_hits;
+            entry.last_used = now;
+            return {};
+        }
+        if (entry.answers.is_empty() && entry.negative_answers.is_empty())
+            m_lookup_cache.remove(it);
     }
+    ++m_cache_statistics.misses;
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
     if (name.as_string().ends_with(".local")) {
@@ -208,6 +244,14 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
     }
 
     // Fifth, ask the upstream nameservers.
+    for (auto& answer : lookup_upstream(name, record_type))
+        add_answer(answer);
+
+    return answers;
+}
+
+Vector<DNSAnswer> LookupServer::lookup_upstream(const DNSName& name, DNSRecordType record_type)
+{
     for (auto& nameserver : m_nameservers) {
         dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
         bool did_get_response = false;
@@ -218,25 +262,21 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, DNSRecordType record
             if (did_get_response)
                 break;
         } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers)
-                add_answer(answer);
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
-    }
+        if (!upstream_answers.is_empty())
+            return upstream_answers;
 
-    // Sixth, fail.
-    if (answers.is_empty()) {
-        dbgln("Tried all nameservers but never got a response :(");
-        return {};
+        if (!did_get_response) {
+            dbgln("Never got a response from '{}', trying next nameserver", nameserver);
+            continue;
+        }
+        // The other nameservers would only tell us the same.
+        if (auto entry = m_lookup_cache.get(name); entry.has_value() && entry.value().is_known_not_to_have(record_type, time(nullptr)))
+            return {};
+        dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
     }
 
-    return answers;
+    dbgln("Tried all nameservers but never got a response :(");
+    return {};
 }
 
 Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase should_randomize_case)
@@ -316,8 +356,17 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& namese
         }
     }
 
+    if (response.code() == DNSPacket::Code::NXDOMAIN) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "LookupServer: '{}' does not exist", name.as_string());
+        if (auto ttl = response.negative_caching_ttl(); ttl.has_value())
+            put_in_negative_cache(name, record_type, true, ttl.value());
+        return {};
+    }
+
     if (response.answer_count() < 1) {
         dbgln("LookupServer: No answers :(");
+        if (auto ttl = response.negative_caching_ttl(); ttl.has_value())
+            put_in_negative_cache(name, record_type, false, ttl.value());
         return {};
     }
 
@@ -332,36 +381,113 @@ Vector<DNSAnswer> LookupServer::lookup(const DNSName& name, const String& namese
     return answers;
 }
 
+LookupServer::CacheEntry& LookupServer::ensure_cache_entry(const DNSName& name)
+{
+    if (auto it = m_lookup_cache.find(name); it != m_lookup_cache.end())
+        return it->value;
+
+    // Prevent the cache from growing too big.
+    if (m_lookup_cache.size() >= s_max_cached_names) {
+        remove_expired_cache_entries();
+        if (m_lookup_cache.size() >= s_max_cached_names) {
+            auto least_recently_used = m_lookup_cache.begin();
+            for (auto it = m_lookup_cache.begin(); it != m_lookup_cache.end(); ++it) {
+                if (it->value.last_used < least_recently_used->value.last_used)
+                    least_recently_used = it;
+            }
+            dbgln_if(LOOKUPSERVER_DEBUG, "Evicting cache entry: {}", least_recently_used->key.as_string());
+            m_lookup_cache.remove(least_recently_used);
+            ++m_cache_statistics.evictions;
+        }
+    }
+
+    CacheEntry entry;
+    entry.last_used = time(nullptr);
+    m_lookup_cache.set(name, move(entry));
+    return m_lookup_cache.find(name)->value;
+}
+
 void LookupServer::put_in_cache(const DNSAnswer& answer)
 {
     if (answer.has_expired())
         return;
 
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
-
-    auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
-
-            it->value.remove_all_matching([&](DNSAnswer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
-
-                if (other_answer.received_time() >= now - 1)
-                    return false;
-
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
-        }
-        it->value.append(answer);
+    auto& entry = ensure_cache_entry(answer.name());
+    auto now = time(nullptr);
+    entry.answers.remove_all_matching([&](DNSAnswer const& other_answer) {
+        if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
+            return false;
+
+        // A fresh copy of a record we already have replaces it.
+        if (other_answer.record_data() == answer.record_data())
+            return true;
+
+        if (!answer.mdns_cache_flush() || other_answer.received_time() >= now - 1)
+            return false;
+
+        dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
+        return true;
+    });
+    entry.negative_answers.remove_all_matching([&](auto& negative_answer) {
+        return negative_answer.name_does_not_exist || negative_answer.type == answer.type();
+    });
+    entry.answers.append(answer);
+}
+
+void LookupServer::put_in_negative_cache(const DNSName& name, DNSRecordType record_type, bool name_does_not_exist, u32 ttl)
+{
+    ttl = min(ttl, s_max_negative_ttl);
+    if (ttl == 0)
+        return;
+
+    auto& entry = ensure_cache_entry(name);
+    entry.negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.type == record_type; });
+    entry.negative_answers.append({ record_type, name_does_not_exist, time(nullptr) + ttl });
+}
+
+void LookupServer::remove_expired_cache_entries()
+{
+    auto now = time(nullptr);
+    Vector<DNSName> names_to_remove;
+    for (auto& it : m_lookup_cache) {
+        auto& entry = it.value;
+        entry.answers.remove_all_matching([](auto& answer) { return answer.has_expired(); });
+        entry.negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.expiry_time <= now; });
+        if (entry.answers.is_empty() && entry.negative_answers.is_empty() && !entry.is_being_prefetched)
+            names_to_remove.append(it.key);
+    }
+    for (auto& name : names_to_remove)
+        m_lookup_cache.remove(name);
+}
+
+void LookupServer::prefetch_if_about_to_expire(const DNSName& name, DNSRecordType record_type, CacheEntry& entry)
+{
+    // mDNS responders announce changes to their records themselves.
+    if (entry.is_being_prefetched || entry.hit_count < s_prefetch_hit_threshold || name.as_string().ends_with(".local"))
+        return;
+
+    // Refresh the answers once they're into the last tenth of their lifetime.
+    auto now = time(nullptr);
+    bool is_about_to_expire = false;
+    for (auto& answer : entry.answers) {
+        if (answer.type() == record_type && (answer.received_time() + answer.ttl() - now) * 10 <= (time_t)answer.ttl())
+            is_about_to_expire = true;
     }
+    if (!is_about_to_expire)
+        return;
+
+    entry.is_being_prefetched = true;
+    // Only after the client has got its answer.
+    deferred_invoke([this, name, record_type](auto&) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Prefetching '{}' before its answers expire", name.as_string());
+        ++m_cache_statistics.prefetches;
+        lookup_upstream(name, record_type);
+        if (auto it = m_lookup_cache.find(name); it != m_lookup_cache.end()) {
+            it->value.is_being_prefetched = false;
+            // It has to earn its next prefetch.
+            it->value.hit_count = 0;
+        }
+    });
 }
 
 }
@@ -12,6 +12,8 @@
 #include "MulticastDNS.h"
 #include <LibCore/FileWatcher.h>
 #include <LibCore/Object.h>
+#include <LibCore/Timer.h>
+#include <time.h>
 
 namespace LookupServer {
 
@@ -25,11 +27,50 @@ public:
     Vector<DNSAnswer> lookup(const DNSName& name, DNSRecordType record_type);
 
 private:
+    // We remember that a name doesn't exist (NXDOMAIN), or that it has no records of some type (NODATA), for as long as
+    // its zone says we may (RFC 2308), so looking it up again doesn't mean asking every nameserver all over again.
+    struct NegativeAnswer {
+        DNSRecordType type { 0 };
+        bool name_does_not_exist { false };
+        time_t expiry_time { 0 };
+    };
+
+    struct CacheEntry {
+        Vector<DNSAnswer> answers;
+        Vector<NegativeAnswer> negative_answers;
+        // For picking which entries to evict when the cache is full, and which ones to refresh before they expire.
+        time_t last_used { 0 };
+        u32 hit_count { 0 };
+        bool is_being_prefetched { false };
+
+        bool is_known_not_to_have(DNSRecordType type, time_t now) const
+        {
+            for (auto& negative_answer : negative_answers) {
+                if ((negative_answer.name_does_not_exist || negative_answer.type == type) && negative_answer.expiry_time > now)
+                    return true;
+            }
+            return false;
+        }
+    };
+
+    struct CacheStatistics {
+        u64 hits { 0 };
+        u64 negative_hits { 0 };
+        u64 misses { 0 };
+        u64 prefetches { 0 };
+        u64 evictions { 0 };
+    };
+
     LookupServer();
 
     void load_etc_hosts();
+    CacheEntry& ensure_cache_entry(const DNSName&);
     void put_in_cache(const DNSAnswer&);
+    void put_in_negative_cache(const DNSName&, DNSRecordType, bool name_does_not_exist, u32 ttl);
+    void remove_expired_cache_entries();
+    void prefetch_if_about_to_expire(const DNSName&, DNSRecordType, CacheEntry&);
 
+    Vector<DNSAnswer> lookup_upstream(const DNSName&, DNSRecordType);
     Vector<DNSAnswer> lookup(const DNSName& hostname, const String& nameserver, bool& did_get_response, DNSRecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
 
     RefPtr<Core::LocalServer> m_local_server;
@@ -38,7 +79,9 @@ private:
     Vector<String> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_etc_hosts;
-    HashMap<DNSName, Vector<DNSAnswer>, DNSName::Traits> m_lookup_cache;
+    HashMap<DNSName, CacheEntry, DNSName::Traits> m_lookup_cache;
+    RefPtr<Core::Timer> m_cache_cleanup_timer;
+    CacheStatistics m_cache_statistics;
 };
 
 }
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Debug.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/TCPSocket.h>
+#include <LibCore/Timer.h>
+#include <LibTLS/TLSv12.h>
+
+namespace RequestServer {
+
+// Keeps connections to each origin open between requests, so loading a page with lots of resources from the same
+// server only pays for the TCP (and TLS) handshakes of a few connections instead of one per request.
+// Requests aren't pipelined, each connection carries one request at a time.
+template<typename SocketType>
+class ConnectionCache {
+public:
+    // Like other browsers, so we don't hog servers.
+    static constexpr size_t maximum_connections_per_origin = 6;
+    // Servers close idle connections after a while (Apache after 5 seconds by default). We'd rather drop them
+    // first than find out by sending a request into a connection that's just been closed.
+    static constexpr int idle_timeout_ms = 4000;
+
+    // Calls `start` with a connection to the URL's origin as soon as there's one: an idle one left over from an
+    // earlier request, a new one, or, once there are too many of those, whichever another request is done with
+    // first. `start` returns false if it doesn't want the connection anymore, e.g. because the request was stopped
+    // while waiting.
+    using StartFunction = Function<bool(NonnullRefPtr<SocketType>)>;
+    void request_connection(const URL& url, StartFunction start)
+    {
+        auto key = origin_key(url);
+        if (!m_origins.contains(key))
+            m_origins.set(key, make<Origin>());
+        auto& origin = *m_origins.get(key).value();
+        origin.waiting_requests.append(move(start));
+        serve_waiting_requests(key, origin);
+    }
+
+    // A request is done with a connection. It's kept for the next request only if `can_reuse` is true, i.e. the
+    // whole response has been read and the server is keeping the connection open.
+    void release_connection(const URL& url, const SocketType& socket, bool can_reuse)
+    {
+        auto key = origin_key(url);
+        auto& origin = *m_origins.get(key).value();
+        auto index = index_of(origin, socket);
+        VERIFY(index.has_value());
+        VERIFY(origin.connections[index.value()].is_in_use);
+
+        if (can_reuse) {
+            dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: Keeping connection to {} for later", key);
+            set_idle(key, origin.connections[index.value()]);
+        } else {
+            remove_connection(origin, index.value());
+        }
+        serve_waiting_requests(key, origin);
+    }
+
+private:
+    struct Connection {
+        NonnullRefPtr<SocketType> socket;
+        NonnullRefPtr<Core::Timer> idle_timer;
+        bool is_in_use { false };
+    };
+
+    struct Origin {
+        NonnullOwnPtrVector<Connection> connections;
+        Vector<StartFunction> waiting_requests;
+    };
+
+    static String origin_key(const URL& url) { return String::formatted("{}:{}", url.host(), url.port()); }
+
+    static Optional<size_t> index_of(const Origin& origin, const SocketType& socket)
+    {
+        for (size_t i = 0; i < origin.connections.size(); ++i) {
+            if (origin.connections[i].socket.ptr() == &socket)
+                return i;
+        }
+        return {};
+    }
+
+    // An idle connection shouldn't have anything to read. If it does, the server either closed it or sent
+    // something we didn't ask for, and either way it's no good for another request.
+    static bool is_still_open(SocketType& socket)
+    {
+        if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+            if (!socket.is_established())
+                return false;
+        }
+        return socket.is_connected() && !socket.eof() && !socket.Core::Socket::can_read();
+    }
+
+    void serve_waiting_requests(const String& key, Origin& origin)
+    {
+        while (!origin.waiting_requests.is_empty()) {
+            auto index = find_or_open_connection(key, origin);
+            if (!index.has_value())
+                return;
+
+            auto& connection = origin.connections[index.value()];
+            connection.is_in_use = true;
+            connection.idle_timer->stop();
+            clear_handlers(*connection.socket);
+
+            auto start = origin.waiting_requests.take_first();
+            if (start(connection.socket))
+                continue;
+            if (connection.socket->is_connected())
+                set_idle(key, connection);
+            else
+                remove_connection(origin, index.value());
+        }
+    }
+
+    Optional<size_t> find_or_open_connection(const String& key, Origin& origin)
+    {
+        for (size_t i = 0; i < origin.connections.size();) {
+            auto& connection = origin.connections[i];
+            if (connection.is_in_use) {
+                ++i;
+                continue;
+            }
+            if (!is_still_open(*connection.socket)) {
+                remove_connection(origin, i);
+                continue;
+            }
+            dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: Reusing connection to {}", key);
+            return i;
+        }
+
+        if (origin.connections.size() >= maximum_connections_per_origin)
+            return {};
+
+        dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: Opening connection #{} to {}", origin.connections.size() + 1, key);
+        auto socket = SocketType::construct(nullptr);
+        auto idle_timer = Core::Timer::create_single_shot(idle_timeout_ms, [this, key, socket = socket.ptr()] {
+            drop_idle_connection(key, *socket);
+        });
+        origin.connections.append(adopt_own(*new Connection { move(socket), move(idle_timer) }));
+        return origin.connections.size() - 1;
+    }
+
+    void set_idle(const String& key, Connection& connection)
+    {
+        connection.is_in_use = false;
+        connection.idle_timer->restart();
+
+        auto* socket = connection.socket.ptr();
+        if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+            socket->on_tls_ready_to_read = [this, key, socket](auto&) { drop_idle_connection(key, *socket); };
+            socket->on_tls_error = [this, key, socket](auto) { drop_idle_connection(key, *socket); };
+            socket->on_tls_finished = [this, key, socket] { drop_idle_connection(key, *socket); };
+        } else {
+            socket->on_ready_to_read = [this, key, socket] { drop_idle_connection(key, *socket); };
+        }
+    }
+
+    static void clear_handlers(SocketType& socket)
+    {
+        if constexpr (IsSame<SocketType, TLS::TLSv12>) {
+            socket.on_tls_ready_to_read = nullptr;
+            socket.on_tls_error = nullptr;
+            socket.on_tls_finished = nullptr;
+        } else {
+            socket.on_ready_to_read = nullptr;
+        }
+    }
+
+    void drop_idle_connection(const String& key, SocketType& socket)
+    {
+        auto origin = m_origins.get(key);
+        if (!origin.has_value())
+            return;
+        auto index = index_of(*origin.value(), socket);
+        if (!index.has_value() || origin.value()->connections[index.value()].is_in_use)
+            return;
+        dbgln_if(REQUESTSERVER_DEBUG, "ConnectionCache: Dropping idle connection to {}", key);
+        remove_connection(*origin.value(), index.value());
+    }
+
+    // We may be inside one of the socket's (or the timer's) own callbacks here, so the connection is only
+    // destroyed once we're back in the event loop.
+    static void remove_connection(Origin& origin, size_t index)
+    {
+        auto connection = origin.connections.take(index);
+        connection->idle_timer->stop();
+        clear_handlers(*connection->socket);
+        auto& socket = *connection->socket;
+        socket.deferred_invoke([connection = move(connection)](auto&) {});
+    }
+
+    HashMap<String, NonnullOwnPtr<Origin>> m_origins;
+};
+
+}
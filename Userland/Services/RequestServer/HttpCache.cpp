@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/GenericLexer.h>
+#include <AK/Hex.h>
+#include <AK/QuickSort.h>
+#include <AK/StringBuilder.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/File.h>
+#include <LibCore/StandardPaths.h>
+#include <LibCrypto/Hash/SHA1.h>
+#include <LibHTTP/HttpDate.h>
+#include <RequestServer/HttpCache.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace RequestServer {
+
+static constexpr size_t maximum_cache_size = 64 * MiB;
+static constexpr size_t maximum_entry_size = 8 * MiB;
+// RFC 7234, section 4.2.2 suggests 10% of the time since the response was last modified, but that can be a long time.
+static constexpr time_t maximum_heuristic_lifetime = 24 * 60 * 60;
+// Left behind by an instance that crashed while storing a response.
+static constexpr time_t abandoned_temporary_file_age = 60 * 60;
+static constexpr StringView entry_signature = "SerenityOS HTTP cache entry 1";
+
+static HashMap<String, String> cache_control_directives(const HttpCache::Headers& headers)
+{
+    HashMap<String, String> directives;
+    auto header = headers.get("Cache-Control");
+    if (!header.has_value())
+        return directives;
+    for (auto& part : header.value().split_view(',')) {
+        auto directive = part.trim_whitespace();
+        auto equals = directive.find('=');
+        if (!equals.has_value()) {
+            directives.set(directive.to_lowercase_string(), {});
+            continue;
+        }
+        auto value = directive.substring_view(equals.value() + 1).trim_whitespace();
+        if (value.length() >= 2 && value.starts_with('"') && value.ends_with('"'))
+            value = value.substring_view(1, value.length() - 2);
+        directives.set(directive.substring_view(0, equals.value()).trim_whitespace().to_lowercase_string(), value);
+    }
+    return directives;
+}
+
+static Optional<time_t> header_time(const HttpCache::Headers& headers, const StringView& name)
+{
+    auto value = headers.get(name);
+    if (!value.has_value())
+        return {};
+    return HTTP::parse_http_date(value.value());
+}
+
+// How long a response stays fresh after the server sent it (RFC 7234, section 4.2.1).
+static time_t freshness_lifetime(const HttpCache::Headers& headers, time_t response_time)
+{
+    if (auto max_age = cache_control_directives(headers).get("max-age"); max_age.has_value())
+        return max_age.value().to_uint().value_or(0);
+
+    auto date = header_time(headers, "Date").value_or(response_time);
+    if (headers.contains("Expires")) {
+        // Invalid dates, like "0", mean that the response has already expired.
+        auto expires = header_time(headers, "Expires");
+        if (!expires.has_value())
+            return 0;
+        return max<time_t>(0, expires.value() - date);
+    }
+
+    auto last_modified = header_time(headers, "Last-Modified");
+    if (last_modified.has_value() && last_modified.value() < date)
+        return min((date - last_modified.value()) / 10, maximum_heuristic_lifetime);
+    return 0;
+}
+
+// RFC 7234, section 4.2.3.
+static time_t current_age(const HttpCache::Entry& entry)
+{
+    auto date = header_time(entry.headers, "Date").value_or(entry.response_time);
+    time_t apparent_age = max<time_t>(0, entry.response_time - date);
+    time_t age_value = entry.headers.get("Age").value_or("0").to_uint().value_or(0);
+    time_t corrected_age_value = age_value + (entry.response_time - entry.request_time);
+    time_t corrected_initial_age = max(apparent_age, corrected_age_value);
+    return corrected_initial_age + (time(nullptr) - entry.response_time);
+}
+
+bool HttpCache::Entry::is_fresh() const
+{
+    if (cache_control_directives(headers).contains("no-cache"))
+        return false;
+    return freshness_lifetime(headers, response_time) > current_age(*this);
+}
+
+bool HttpCache::Entry::can_be_revalidated() const
+{
+    return headers.contains("ETag") || headers.contains("Last-Modified");
+}
+
+bool HttpCache::Entry::may_be_served_stale() const
+{
+    auto directives = cache_control_directives(headers);
+    return !directives.contains("must-revalidate") && !directives.contains("no-cache");
+}
+
+static bool is_storable(u32 status_code, const HttpCache::Headers& headers)
+{
+    // These are the ones that are cacheable by default (RFC 7231, section 6.1), minus partial content and things
+    // without a body.
+    switch (status_code) {
+    case 200:
+    case 203:
+    case 300:
+    case 301:
+    case 404:
+    case 405:
+    case 410:
+    case 414:
+    case 501:
+        break;
+    default:
+        return false;
+    }
+
+    if (cache_control_directives(headers).contains("no-store"))
+        return false;
+
+    // We always ask for the same encodings, so that's the only thing a response can vary on and still be reused.
+    if (auto vary = headers.get("Vary"); vary.has_value()) {
+        for (auto& field : vary.value().split_view(',')) {
+            if (!field.trim_whitespace().equals_ignoring_case("Accept-Encoding"))
+                return false;
+        }
+    }
+
+    // Unless we can ask the server whether it's still good, a response that's stale right away isn't worth keeping.
+    return headers.contains("ETag") || headers.contains("Last-Modified") || freshness_lifetime(headers, time(nullptr)) > 0;
+}
+
+static bool write_all(int fd, ReadonlyBytes bytes)
+{
+    while (!bytes.is_empty()) {
+        auto nwritten = ::write(fd, bytes.data(), bytes.size());
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            dbgln("HttpCache: Write failed: {}", strerror(errno));
+            return false;
+        }
+        bytes = bytes.slice(nwritten);
+    }
+    return true;
+}
+
+HttpCache& HttpCache::the()
+{
+    static HttpCache s_the;
+    return s_the;
+}
+
+HttpCache::HttpCache()
+{
+    auto directory = String::formatted("{}/RequestServer", Core::StandardPaths::cache_directory());
+    if (!Core::File::ensure_parent_directories(directory) || (mkdir(directory.characters(), 0700) < 0 && errno != EEXIST)) {
+        dbgln("HttpCache: Can't create {}: {}, not caching anything", directory, strerror(errno));
+        return;
+    }
+    m_directory = directory;
+}
+
+bool HttpCache::can_use_for_request(const String& method, const HashMap<String, String>& headers, ReadonlyBytes body)
+{
+    if (!method.equals_ignoring_case("GET") || !body.is_empty())
+        return false;
+    for (auto& it : headers) {
+        // The client is either doing its own caching, or wants something other than the plain response.
+        if (it.key.starts_with("If-", CaseSensitivity::CaseInsensitive) || it.key.equals_ignoring_case("Range"))
+            return false;
+        if (it.key.equals_ignoring_case("Cache-Control") && it.value.contains("no-store", CaseSensitivity::CaseInsensitive))
+            return false;
+    }
+    return true;
+}
+
+String HttpCache::path_for(const URL& url) const
+{
+    auto key = url.serialize(URL::ExcludeFragment::Yes);
+    auto digest = Crypto::Hash::SHA1::hash(key);
+    return String::formatted("{}/{}", m_directory, encode_hex({ digest.immutable_data(), digest.data_length() }));
+}
+
+Optional<HttpCache::Entry> HttpCache::find(const URL& url)
+{
+    if (!is_enabled())
+        return {};
+
+    auto path = path_for(url);
+    auto file_or_error = MappedFile::map(path);
+    if (file_or_error.is_error())
+        return {};
+    auto file = file_or_error.release_value();
+
+    GenericLexer lexer { StringView { file->bytes() } };
+    Entry entry { url, 0, {}, 0, 0, file, 0 };
+    auto is_valid = [&] {
+        if (lexer.consume_line() != entry_signature)
+            return false;
+        // Two URLs might end up with the same file name, the one that's been stored last wins.
+        if (lexer.consume_line() != url.serialize(URL::ExcludeFragment::Yes))
+            return false;
+        auto status_code = lexer.consume_line().to_uint();
+        auto request_time = lexer.consume_line().to_uint<time_t>();
+        auto response_time = lexer.consume_line().to_uint<time_t>();
+        if (!status_code.has_value() || !request_time.has_value() || !response_time.has_value())
+            return false;
+        entry.status_code = status_code.value();
+        entry.request_time = request_time.value();
+        entry.response_time = response_time.value();
+        for (;;) {
+            if (lexer.is_eof())
+                return false;
+            auto line = lexer.consume_line();
+            if (line.is_empty())
+                break;
+            auto colon = line.find(':');
+            if (!colon.has_value())
+                return false;
+            entry.headers.set(line.substring_view(0, colon.value()), line.substring_view(colon.value() + 1).trim_whitespace());
+        }
+        entry.body_offset = lexer.tell();
+        return true;
+    };
+    if (!is_valid()) {
+        dbgln_if(REQUESTSERVER_DEBUG, "HttpCache: Ignoring invalid entry {}", path);
+        return {};
+    }
+
+    // The modification time is when the entry was last used, so that we know which ones to evict first.
+    if (utime(path.characters(), nullptr) < 0)
+        dbgln_if(REQUESTSERVER_DEBUG, "HttpCache: utime({}) failed: {}", path, strerror(errno));
+    dbgln_if(REQUESTSERVER_DEBUG, "HttpCache: Found {} ({} bytes) for {}", entry.status_code, entry.body().size(), url);
+    return entry;
+}
+
+void HttpCache::add_validators(const Entry& entry, HashMap<String, String>& request_headers)
+{
+    if (auto etag = entry.headers.get("ETag"); etag.has_value())
+        request_headers.set("If-None-Match", etag.value());
+    if (auto last_modified = entry.headers.get("Last-Modified"); last_modified.has_value())
+        request_headers.set("If-Modified-Since", last_modified.value());
+}
+
+void HttpCache::update(Entry& entry, const Headers& headers)
+{
+    for (auto& it : headers) {
+        // These describe the (empty) body of the 304 response, not the one we have (RFC 7234, section 4.3.4).
+        if (it.key.equals_ignoring_case("Content-Length") || it.key.equals_ignoring_case("Transfer-Encoding"))
+            continue;
+        entry.headers.set(it.key, it.value);
+    }
+    // FIXME: This makes the response look a little younger than it is, by however long the request took.
+    entry.request_time = entry.response_time = time(nullptr);
+
+    int fd = -1;
+    auto temporary_path = create_temporary_file(entry.url, fd);
+    if (fd < 0)
+        return;
+    bool success = write_header(fd, entry.url, entry.status_code, entry.headers, entry.request_time, entry.response_time) && write_all(fd, entry.body());
+    close(fd);
+    if (!success || rename(temporary_path.characters(), path_for(entry.url).characters()) < 0)
+        unlink(temporary_path.characters());
+}
+
+String HttpCache::create_temporary_file(const URL& url, int& fd)
+{
+    static unsigned s_next_temporary_file_id = 0;
+    auto path = String::formatted("{}.{}.{}.tmp", path_for(url), getpid(), s_next_temporary_file_id++);
+    fd = open(path.characters(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        dbgln("HttpCache: Can't create {}: {}", path, strerror(errno));
+        return {};
+    }
+    return path;
+}
+
+bool HttpCache::write_header(int fd, const URL& url, u32 status_code, const Headers& headers, time_t request_time, time_t response_time)
+{
+    StringBuilder builder;
+    builder.appendff("{}\n{}\n{}\n{}\n{}\n", entry_signature, url.serialize(URL::ExcludeFragment::Yes), status_code, request_time, response_time);
+    for (auto& it : headers)
+        builder.appendff("{}: {}\n", it.key, it.value);
+    builder.append('\n');
+    return write_all(fd, builder.string_view().bytes());
+}
+
+void HttpCache::did_store(size_t size)
+{
+    m_size_estimate += size;
+    if (!m_size_is_known || m_size_estimate > maximum_cache_size)
+        evict_least_recently_used_entries();
+}
+
+// Other instances are storing responses too, so we take a fresh look at the directory every time.
+void HttpCache::evict_least_recently_used_entries()
+{
+    struct File {
+        String path;
+        size_t size { 0 };
+        time_t last_used { 0 };
+    };
+    Vector<File> files;
+    size_t total_size = 0;
+    auto now = time(nullptr);
+
+    Core::DirIterator iterator(m_directory, Core::DirIterator::SkipDots);
+    while (iterator.has_next()) {
+        auto path = iterator.next_full_path();
+        struct stat st;
+        if (lstat(path.characters(), &st) < 0 || !S_ISREG(st.st_mode))
+            continue;
+        if (path.ends_with(".tmp")) {
+            if (now - st.st_mtime > abandoned_temporary_file_age)
+                unlink(path.characters());
+            continue;
+        }
+        files.append({ move(path), static_cast<size_t>(st.st_size), st.st_mtime });
+        total_size += st.st_size;
+    }
+
+    // Make some room, so that we don't have to do this again for every response we store.
+    quick_sort(files, [](auto& a, auto& b) { return a.last_used < b.last_used; });
+    for (auto& file : files) {
+        if (total_size <= maximum_cache_size * 3 / 4)
+            break;
+        dbgln_if(REQUESTSERVER_DEBUG, "HttpCache: Evicting {} ({} bytes)", file.path, file.size);
+        if (unlink(file.path.characters()) == 0)
+            total_size -= file.size;
+    }
+
+    m_size_estimate = total_size;
+    m_size_is_known = true;
+}
+
+HttpCache::Writer::Writer(HttpCache& cache, const URL& url, OutputStream& stream)
+    : m_cache(cache)
+    , m_url(url)
+    , m_stream(stream)
+    , m_request_time(time(nullptr))
+{
+}
+
+HttpCache::Writer::~Writer()
+{
+    discard();
+}
+
+void HttpCache::Writer::begin(u32 status_code, const Headers& headers)
+{
+    // We may get more headers after the body, which we don't keep.
+    if (m_has_begun)
+        return;
+    m_has_begun = true;
+    if (!m_cache.is_enabled() || !is_storable(status_code, headers))
+        return;
+
+    // The job decodes the body before writing it to us, so the length would be the encoded one.
+    if (!headers.contains("Content-Encoding")) {
+        if (auto content_length = headers.get("Content-Length"); content_length.has_value()) {
+            m_content_length = content_length.value().to_uint<size_t>();
+            if (m_content_length.value_or(0) > maximum_entry_size)
+                return;
+        }
+    }
+
+    m_temporary_path = m_cache.create_temporary_file(m_url, m_fd);
+    if (m_fd >= 0 && !m_cache.write_header(m_fd, m_url, status_code, headers, m_request_time, time(nullptr)))
+        discard();
+}
+
+void HttpCache::Writer::finish(bool success)
+{
+    if (m_fd < 0)
+        return;
+    if (!success || (m_content_length.has_value() && m_content_length.value() != m_body_size)) {
+        discard();
+        return;
+    }
+
+    close(m_fd);
+    m_fd = -1;
+    auto path = m_cache.path_for(m_url);
+    if (rename(m_temporary_path.characters(), path.characters()) < 0) {
+        dbgln("HttpCache: Can't rename {} to {}: {}", m_temporary_path, path, strerror(errno));
+        unlink(m_temporary_path.characters());
+        return;
+    }
+    dbgln_if(REQUESTSERVER_DEBUG, "HttpCache: Stored {} bytes for {}", m_body_size, m_url);
+    m_cache.did_store(m_body_size);
+}
+
+void HttpCache::Writer::discard()
+{
+    if (m_fd < 0)
+        return;
+    close(m_fd);
+    m_fd = -1;
+    unlink(m_temporary_path.characters());
+}
+
+size_t HttpCache::Writer::write(ReadonlyBytes bytes)
+{
+    auto nwritten = m_stream.write(bytes);
+    if (m_fd >= 0) {
+        m_body_size += nwritten;
+        if (m_body_size > maximum_entry_size || !write_all(m_fd, bytes.trim(nwritten)))
+            discard();
+    }
+    return nwritten;
+}
+
+bool HttpCache::Writer::write_or_error(ReadonlyBytes bytes)
+{
+    if (write(bytes) < bytes.size()) {
+        set_recoverable_error();
+        return false;
+    }
+    return true;
+}
+
+bool HttpCache::Writer::handle_any_error()
+{
+    m_stream.handle_any_error();
+    return Stream::handle_any_error();
+}
+
+}
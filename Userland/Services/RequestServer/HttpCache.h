@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/MappedFile.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Stream.h>
+#include <AK/String.h>
+#include <AK/URL.h>
+#include <time.h>
+
+namespace RequestServer {
+
+// A private HTTP cache (RFC 7234) on disk, shared by all RequestServer instances of a user. Each response is kept in
+// a file of its own, named after its URL, with the status and headers in front of the body. Files are only ever
+// replaced as a whole, so an instance that has one mapped keeps seeing the old response while another one updates it.
+class HttpCache {
+public:
+    using Headers = HashMap<String, String, CaseInsensitiveStringTraits>;
+
+    struct Entry {
+        URL url;
+        u32 status_code { 0 };
+        Headers headers;
+        // When we sent the request and received the response, used to work out the response's age.
+        time_t request_time { 0 };
+        time_t response_time { 0 };
+        NonnullRefPtr<MappedFile> file;
+        size_t body_offset { 0 };
+
+        ReadonlyBytes body() const { return file->bytes().slice(body_offset); }
+        bool is_fresh() const;
+        bool can_be_revalidated() const;
+        bool may_be_served_stale() const;
+    };
+
+    // Forwards a response body to the client, and keeps a copy in the cache if the response can be stored.
+    class Writer final : public OutputStream {
+    public:
+        Writer(HttpCache&, const URL&, OutputStream&);
+        virtual ~Writer() override;
+
+        void begin(u32 status_code, const Headers&);
+        void finish(bool success);
+
+        virtual size_t write(ReadonlyBytes) override;
+        virtual bool write_or_error(ReadonlyBytes) override;
+        virtual bool handle_any_error() override;
+
+    private:
+        void discard();
+
+        HttpCache& m_cache;
+        URL m_url;
+        OutputStream& m_stream;
+        time_t m_request_time { 0 };
+        Optional<size_t> m_content_length;
+        String m_temporary_path;
+        int m_fd { -1 };
+        size_t m_body_size { 0 };
+        bool m_has_begun { false };
+    };
+
+    static HttpCache& the();
+
+    bool is_enabled() const { return !m_directory.is_null(); }
+    const String& directory() const { return m_directory; }
+
+    static bool can_use_for_request(const String& method, const HashMap<String, String>& headers, ReadonlyBytes body);
+    Optional<Entry> find(const URL&);
+
+    // Asks the server to only send the response if it has changed since we stored it.
+    static void add_validators(const Entry&, HashMap<String, String>& request_headers);
+    // The server has told us that the response we have is still good (with a 304), and sent us new headers for it.
+    void update(Entry&, const Headers&);
+
+    NonnullOwnPtr<Writer> create_writer(const URL& url, OutputStream& stream) { return make<Writer>(*this, url, stream); }
+
+private:
+    HttpCache();
+
+    String path_for(const URL&) const;
+    String create_temporary_file(const URL&, int& fd);
+    bool write_header(int fd, const URL&, u32 status_code, const Headers&, time_t request_time, time_t response_time);
+    void did_store(size_t size);
+    void evict_least_recently_used_entries();
+
+    String m_directory;
+    size_t m_size_estimate { 0 };
+    bool m_size_is_known { false };
+};
+
+}
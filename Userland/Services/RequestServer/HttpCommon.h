@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/Debug.h>
 #include <AK/HashMap.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Optional.h>
@@ -15,6 +16,8 @@
 #include <AK/Types.h>
 #include <LibHTTP/HttpRequest.h>
 #include <RequestServer/ClientConnection.h>
+#include <RequestServer/ConnectionCache.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
 
 namespace RequestServer::Detail {
@@ -23,12 +26,33 @@ template<typename TSelf, typename TJob>
 void init(TSelf* self, TJob job)
 {
     job->on_headers_received = [self](auto& headers, auto response_code) {
+        // The server has confirmed that the response we have is still good, the client gets that one instead.
+        if (response_code.value_or(0) == 304 && self->cached_response().has_value())
+            return;
+        if (auto* cache_writer = self->cache_writer(); cache_writer && response_code.has_value())
+            cache_writer->begin(response_code.value(), headers);
         if (response_code.has_value())
             self->set_status_code(response_code.value());
         self->set_response_headers(headers);
     };
 
     job->on_finish = [self](bool success) {
+        if (auto& cached_response = self->cached_response(); cached_response.has_value()) {
+            auto* response = self->job().response();
+            if (success && response && response->code() == 304) {
+                HttpCache::the().update(cached_response.value(), response->headers());
+                self->send_cached_response();
+                return;
+            }
+            // We couldn't ask the server, but a stale response is still better than none (RFC 7234, section 4.2.4).
+            if (!success && !self->status_code().has_value() && cached_response->may_be_served_stale()) {
+                self->send_cached_response();
+                return;
+            }
+        }
+        if (auto* cache_writer = self->cache_writer())
+            cache_writer->finish(success);
+
         if (auto* response = self->job().response()) {
             self->set_status_code(response->code());
             self->set_response_headers(response->headers());
@@ -53,30 +77,71 @@ void init(TSelf* self, TJob job)
 }
 
 template<typename TBadgedProtocol, typename TPipeResult>
-OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ClientConnection& client, const String& method, const URL& url, const HashMap<String, String>& headers, ReadonlyBytes body, TPipeResult&& pipe_result)
+OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ClientConnection& client, const String& method, const URL& url, const HashMap<String, String>& headers, ReadonlyBytes body, TPipeResult&& pipe_result, ConnectionCache<typename TBadgedProtocol::Type::SocketType>& connection_cache)
 {
     using TJob = typename TBadgedProtocol::Type::JobType;
     using TRequest = typename TBadgedProtocol::Type::RequestType;
+    using TSocket = typename TBadgedProtocol::Type::SocketType;
 
     if (pipe_result.is_error()) {
         return {};
     }
 
+    auto request_headers = headers;
+    Optional<HttpCache::Entry> cached_response;
+    bool can_use_cache = HttpCache::the().is_enabled() && HttpCache::can_use_for_request(method, headers, body);
+    if (can_use_cache) {
+        cached_response = HttpCache::the().find(url);
+        if (cached_response.has_value() && !cached_response->is_fresh()) {
+            if (cached_response->can_be_revalidated())
+                HttpCache::add_validators(cached_response.value(), request_headers);
+            else
+                cached_response.clear();
+        }
+    }
+
     HTTP::HttpRequest request;
     if (method.equals_ignoring_case("post"))
         request.set_method(HTTP::HttpRequest::Method::POST);
     else
         request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
-    request.set_headers(headers);
+    request.set_headers(request_headers);
     request.set_body(body);
 
     auto output_stream = make<OutputFileStream>(pipe_result.value().write_fd);
     output_stream->make_unbuffered();
-    auto job = TJob::construct(request, *output_stream);
+    OwnPtr<HttpCache::Writer> cache_writer;
+    if (can_use_cache)
+        cache_writer = HttpCache::the().create_writer(url, *output_stream);
+    auto job = TJob::construct(request, cache_writer ? static_cast<OutputStream&>(*cache_writer) : *output_stream);
     auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
     protocol_request->set_request_fd(pipe_result.value().read_fd);
-    job->start();
+    protocol_request->set_response_fd(pipe_result.value().write_fd);
+    if (cache_writer)
+        protocol_request->set_cache_writer(cache_writer.release_nonnull());
+
+    if (cached_response.has_value()) {
+        bool is_fresh = cached_response->is_fresh();
+        protocol_request->set_cached_response(cached_response.release_value());
+        if (is_fresh) {
+            dbgln_if(REQUESTSERVER_DEBUG, "HttpCache: Using fresh response for {}", url);
+            protocol_request->send_cached_response();
+            return protocol_request;
+        }
+    }
+
+    connection_cache.request_connection(url, [&connection_cache, url, weak_job = job->template make_weak_ptr<TJob>()](NonnullRefPtr<TSocket> socket) {
+        // The request may have been stopped while waiting for a connection.
+        auto job = weak_job.strong_ref();
+        if (!job)
+            return false;
+        job->on_socket_released = [&connection_cache, url, socket](bool can_reuse) {
+            connection_cache.release_connection(url, *socket, can_reuse);
+        };
+        job->start(move(socket));
+        return true;
+    });
     return protocol_request;
 }
 
@@ -13,6 +13,7 @@
 #include <AK/URL.h>
 #include <LibHTTP/HttpJob.h>
 #include <RequestServer/ClientConnection.h>
+#include <RequestServer/ConnectionCache.h>
 #include <RequestServer/HttpRequest.h>
 #include <RequestServer/Protocol.h>
 #include <RequestServer/Request.h>
@@ -23,11 +24,15 @@ class HttpProtocol final : public Protocol {
 public:
     using JobType = HTTP::HttpJob;
     using RequestType = HttpRequest;
+    using SocketType = Core::TCPSocket;
 
     HttpProtocol();
     ~HttpProtocol() override = default;
 
     virtual OwnPtr<Request> start_request(ClientConnection&, const String& method, const URL&, const HashMap<String, String>& headers, ReadonlyBytes body) override;
+
+private:
+    ConnectionCache<SocketType> m_connection_cache;
 };
 
 }
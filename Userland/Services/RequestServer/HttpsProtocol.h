@@ -13,6 +13,7 @@
 #include <AK/URL.h>
 #include <LibHTTP/HttpsJob.h>
 #include <RequestServer/ClientConnection.h>
+#include <RequestServer/ConnectionCache.h>
 #include <RequestServer/HttpsRequest.h>
 #include <RequestServer/Protocol.h>
 #include <RequestServer/Request.h>
@@ -23,11 +24,15 @@ class HttpsProtocol final : public Protocol {
 public:
     using JobType = HTTP::HttpsJob;
     using RequestType = HttpsRequest;
+    using SocketType = TLS::TLSv12;
 
     HttpsProtocol();
     ~HttpsProtocol() override = default;
 
     virtual OwnPtr<Request> start_request(ClientConnection&, const String& method, const URL&, const HashMap<String, String>& headers, ReadonlyBytes body) override;
+
+private:
+    ConnectionCache<SocketType> m_connection_cache;
 };
 
 }
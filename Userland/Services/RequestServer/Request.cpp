@@ -51,6 +51,40 @@ void Request::did_progress(Optional<u32> total_size, u32 downloaded_size)
     m_client.did_progress_request({}, *this);
 }
 
+void Request::send_cached_response()
+{
+    VERIFY(m_cached_response.has_value());
+    VERIFY(m_response_fd != -1);
+
+    // The client doesn't know about this request until we've returned it, so everything is sent from the event loop.
+    // The body is written as fast as the client reads it, straight from the mapped file.
+    m_cached_response_notifier = Core::Notifier::construct(m_response_fd, Core::Notifier::Event::Write);
+    m_cached_response_notifier->on_ready_to_write = [this, sent_size = Optional<size_t> {}]() mutable {
+        auto& response = m_cached_response.value();
+        auto body = response.body();
+        if (!sent_size.has_value()) {
+            set_status_code(response.status_code);
+            set_response_headers(response.headers);
+            sent_size = 0;
+        }
+
+        if (sent_size.value() < body.size()) {
+            auto nwritten = m_output_stream->write(body.slice(sent_size.value()));
+            m_output_stream->handle_any_error();
+            sent_size.value() += nwritten;
+            did_progress(body.size(), sent_size.value());
+            if (sent_size.value() < body.size())
+                return;
+        }
+
+        m_cached_response_notifier->set_enabled(false);
+        // The client wants to know the total size, even if there's nothing to send.
+        if (body.is_empty())
+            did_progress(0, 0);
+        did_finish(true);
+    };
+}
+
 void Request::did_request_certificates()
 {
     m_client.did_request_certificates({}, *this);
@@ -12,7 +12,9 @@
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/URL.h>
+#include <LibCore/Notifier.h>
 #include <RequestServer/Forward.h>
+#include <RequestServer/HttpCache.h>
 
 namespace RequestServer {
 
@@ -34,6 +36,17 @@ public:
     // FIXME: Want Badge<Protocol>, but can't make one from HttpProtocol, etc.
     void set_request_fd(int fd) { m_request_fd = fd; }
     int request_fd() const { return m_request_fd; }
+    void set_response_fd(int fd) { m_response_fd = fd; }
+
+    // A response from the HTTP cache, which is sent either right away or once the server has confirmed that it's
+    // still good.
+    const Optional<HttpCache::Entry>& cached_response() const { return m_cached_response; }
+    Optional<HttpCache::Entry>& cached_response() { return m_cached_response; }
+    void set_cached_response(HttpCache::Entry entry) { m_cached_response = move(entry); }
+    void send_cached_response();
+
+    HttpCache::Writer* cache_writer() { return m_cache_writer.ptr(); }
+    void set_cache_writer(NonnullOwnPtr<HttpCache::Writer> writer) { m_cache_writer = move(writer); }
 
     void did_finish(bool success);
     void did_progress(Optional<u32> total_size, u32 downloaded_size);
@@ -50,12 +63,16 @@ private:
     ClientConnection& m_client;
     i32 m_id { 0 };
     int m_request_fd { -1 }; // Passed to client.
+    int m_response_fd { -1 }; // Our end of the same pipe.
     URL m_url;
     Optional<u32> m_status_code;
     Optional<u32> m_total_size {};
     size_t m_downloaded_size { 0 };
     NonnullOwnPtr<OutputFileStream> m_output_stream;
     HashMap<String, String, CaseInsensitiveStringTraits> m_response_headers;
+    Optional<HttpCache::Entry> m_cached_response;
+    RefPtr<Core::Notifier> m_cached_response_notifier;
+    OwnPtr<HttpCache::Writer> m_cache_writer;
 };
 
 }
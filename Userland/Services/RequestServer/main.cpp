@@ -10,22 +10,25 @@
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ClientConnection.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
 
 int main(int, char**)
 {
-    if (pledge("stdio inet accept unix rpath sendfd recvfd", nullptr) < 0) {
+    if (pledge("stdio inet accept unix rpath wpath cpath fattr sendfd recvfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
 
     // Ensure the certificates are read out here.
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
+    // This looks up (and creates) the cache directory.
+    auto& http_cache = RequestServer::HttpCache::the();
 
     Core::EventLoop event_loop;
     // FIXME: Establish a connection to LookupServer and then drop "unix"?
-    if (pledge("stdio inet accept unix sendfd recvfd", nullptr) < 0) {
+    if (pledge("stdio inet accept unix rpath wpath cpath fattr sendfd recvfd", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -33,6 +36,10 @@ int main(int, char**)
         perror("unveil");
         return 1;
     }
+    if (http_cache.is_enabled() && unveil(http_cache.directory().characters(), "rwc") < 0) {
+        perror("unveil");
+        return 1;
+    }
     if (unveil(nullptr, nullptr) < 0) {
         perror("unveil");
         return 1;
@@ -7,27 +7,45 @@
 
 #include <AK/Base64.h>
 #include <AK/Debug.h>
+#include <AK/HashMap.h>
 #include <AK/LexicalPath.h>
 #include <AK/MappedFile.h>
-#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
+#include <LibCompress/Gzip.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Timer.h>
+#include <LibHTTP/HttpDate.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 namespace WebServer {
 
+// How long we keep a connection open while waiting for the client's next request (or for it to take more of a response).
+static constexpr int s_idle_timeout_ms = 10 * 1000;
+// We don't take requests with more headers than this.
+static constexpr size_t s_max_request_size = 64 * KiB;
+// Smaller responses aren't worth compressing, larger files take too long to compress on the fly.
+static constexpr size_t s_min_size_to_compress = 1 * KiB;
+static constexpr size_t s_max_size_to_compress = 1 * MiB;
+static constexpr size_t s_max_compressed_files_size = 8 * MiB;
+
 Client::Client(NonnullRefPtr<Core::TCPSocket> socket, Core::Object* parent)
     : Core::Object(parent)
     , m_socket(socket)
@@ -36,6 +54,16 @@ Client::Client(NonnullRefPtr<Core::TCPSocket> socket, Core::Object* parent)
 
 void Client::die()
 {
+    if (m_is_dying)
+        return;
+    m_is_dying = true;
+    m_socket->on_ready_to_read = nullptr;
+    m_socket->set_read_notifications_enabled(false);
+    if (m_write_notifier)
+        m_write_notifier->set_enabled(false);
+    if (m_idle_timer)
+        m_idle_timer->stop();
+
     deferred_invoke([this](auto& object) {
         NonnullRefPtr protector { object };
         remove_from_parent();
@@ -44,28 +72,278 @@ void Client::die()
 
 void Client::start()
 {
+    m_socket->set_blocking(false);
+    // The headers and the body of a response go out in separate writes. Without this, the body waits for the client to
+    // acknowledge the headers, which it may put off in the hope of sending the acknowledgement along with a request.
+    int nodelay = 1;
+    (void)setsockopt(m_socket->fd(), IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    m_write_notifier = Core::Notifier::construct(m_socket->fd(), Core::Notifier::Event::Write, this);
+    m_write_notifier->set_enabled(false);
+    m_write_notifier->on_ready_to_write = [this] {
+        send_pending_data();
+        handle_buffered_requests();
+    };
+
+    m_idle_timer = Core::Timer::create_single_shot(
+        s_idle_timeout_ms, [this] {
+            dbgln_if(WEBSERVER_DEBUG, "Closing idle connection");
+            die();
+        },
+        this);
+    m_idle_timer->start();
+
     m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
-        for (;;) {
-            auto line = m_socket->read_line();
-            if (line.is_empty())
+        auto data = m_socket->read(PAGE_SIZE);
+        if (data.is_empty()) {
+            if (!m_socket->eof()) {
+                if (m_socket->error() != EAGAIN)
+                    die();
+                return;
+            }
+            // The client won't send any more requests, but still wants responses to the ones it has sent.
+            m_has_received_eof = true;
+            m_socket->set_read_notifications_enabled(false);
+        } else {
+            m_idle_timer->restart();
+            m_request_buffer.append(data);
+        }
+        handle_buffered_requests();
+    };
+}
+
+void Client::handle_buffered_requests()
+{
+    // We only take on the next request once the response to the previous one is out, so responses go out in order, and
+    // a client can't make us buffer up more than one of them at a time.
+    while (!m_is_sending_response && !m_is_dying) {
+        Optional<size_t> end_of_request;
+        for (size_t i = 3; i < m_request_buffer.size(); ++i) {
+            if (memcmp(m_request_buffer.data() + i - 3, "\r\n\r\n", 4) == 0) {
+                end_of_request = i + 1;
                 break;
-            builder.append(line);
-            builder.append("\r\n");
+            }
+        }
+
+        if (!end_of_request.has_value()) {
+            if (m_has_received_eof) {
+                die();
+            } else if (m_request_buffer.size() > s_max_request_size) {
+                dbgln("Request is too large, closing the connection");
+                die();
+            }
+            return;
+        }
+
+        auto raw_request = m_request_buffer.slice(0, end_of_request.value());
+        m_request_buffer = m_request_buffer.slice(end_of_request.value(), m_request_buffer.size() - end_of_request.value());
+        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(raw_request));
+
+        m_is_sending_response = true;
+        m_socket->set_read_notifications_enabled(false);
+        handle_request(raw_request);
+        if (m_is_dying)
+            return;
+        send_pending_data();
+    }
+}
+
+// Sends as much of the response as the socket takes without blocking, and waits until it's ready for more otherwise.
+void Client::send_pending_data()
+{
+    if (m_is_dying || !m_is_sending_response)
+        return;
+
+    while (m_send_buffer_offset < m_send_buffer.size()) {
+        auto nwritten = write(m_socket->fd(), m_send_buffer.data() + m_send_buffer_offset, m_send_buffer.size() - m_send_buffer_offset);
+        if (nwritten < 0) {
+            if (errno == EAGAIN) {
+                m_write_notifier->set_enabled(true);
+                return;
+            }
+            dbgln_if(WEBSERVER_DEBUG, "Failed to send response: {}", strerror(errno));
+            die();
+            return;
+        }
+        m_send_buffer_offset += nwritten;
+        m_idle_timer->restart();
+    }
+    m_send_buffer.clear();
+    m_send_buffer_offset = 0;
+
+    // Let the kernel move the file into the socket, which saves copying every page through our buffer.
+    while (m_file_to_send && m_file_offset < m_file_size) {
+        auto nsent = sendfile(m_socket->fd(), m_file_to_send->fd(), &m_file_offset, m_file_size - m_file_offset);
+        if (nsent < 0 && errno == EAGAIN) {
+            m_write_notifier->set_enabled(true);
+            return;
+        }
+        // We've promised the client a Content-Length, so if the file shrank, all we can do is close the connection.
+        if (nsent <= 0) {
+            if (nsent < 0)
+                perror("sendfile");
+            die();
+            return;
         }
+        m_idle_timer->restart();
+    }
+    m_file_to_send = nullptr;
 
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
-        handle_request(request);
+    m_write_notifier->set_enabled(false);
+    m_is_sending_response = false;
+    if (!m_keep_alive) {
         die();
-    };
+        return;
+    }
+    if (!m_has_received_eof)
+        m_socket->set_read_notifications_enabled(true);
+    m_idle_timer->restart();
+}
+
+static Optional<String> header_value(HTTP::HttpRequest const& request, StringView name)
+{
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case(name))
+            return header.value;
+    }
+    return {};
+}
+
+static bool has_header_token(HTTP::HttpRequest const& request, StringView name, StringView token)
+{
+    auto value = header_value(request, name);
+    if (!value.has_value())
+        return false;
+    for (auto& part : value->split_view(',')) {
+        if (part.trim_whitespace().equals_ignoring_case(token))
+            return true;
+    }
+    return false;
+}
+
+static bool wants_keep_alive(HTTP::HttpRequest const& request)
+{
+    // We don't read request bodies, so we couldn't tell where the next request begins.
+    if (header_value(request, "Content-Length").value_or("0") != "0" || header_value(request, "Transfer-Encoding").has_value())
+        return false;
+    // Connections stay open by default in HTTP/1.1, and only when asked to in HTTP/1.0.
+    if (request.protocol() == "HTTP/1.1")
+        return !has_header_token(request, "Connection", "close");
+    return has_header_token(request, "Connection", "keep-alive");
+}
+
+static bool accepts_gzip(HTTP::HttpRequest const& request)
+{
+    auto accept_encoding = header_value(request, "Accept-Encoding");
+    if (!accept_encoding.has_value())
+        return false;
+    for (auto& coding : accept_encoding->split_view(',')) {
+        auto parameters = coding.split_view(';');
+        if (parameters.is_empty() || !parameters[0].trim_whitespace().equals_ignoring_case("gzip"))
+            continue;
+        // "gzip;q=0" means that the client doesn't want it after all.
+        for (size_t i = 1; i < parameters.size(); ++i) {
+            auto parameter = parameters[i].trim_whitespace();
+            if (!parameter.starts_with("q="))
+                continue;
+            bool is_zero = true;
+            for (auto ch : parameter.substring_view(2))
+                is_zero = is_zero && (ch == '0' || ch == '.');
+            if (is_zero)
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool is_compressible(StringView content_type)
+{
+    return content_type.starts_with("text/")
+        || content_type == "application/javascript"
+        || content_type == "application/json"
+        || content_type == "image/svg+xml";
+}
+
+// Returns the data compressed with gzip, unless that doesn't make it noticeably smaller.
+static Optional<ByteBuffer> compress_if_worthwhile(ReadonlyBytes data)
+{
+    if (data.size() < s_min_size_to_compress || data.size() > s_max_size_to_compress)
+        return {};
+    auto compressed = Compress::GzipCompressor::compress_all(data);
+    if (!compressed.has_value() || compressed->size() > data.size() / 10 * 9)
+        return {};
+    return compressed;
+}
+
+// Compressing a file takes much longer than sending it, so we keep what we've compressed around until the file changes.
+struct CompressedFile {
+    time_t modification_time { 0 };
+    off_t size { 0 };
+    // Empty if compressing the file didn't help.
+    Optional<ByteBuffer> data;
+};
+static HashMap<String, CompressedFile> s_compressed_files;
+static size_t s_compressed_files_size = 0;
+
+// Returns the cached compressed copy of the file, which stays valid until the next call.
+static ByteBuffer const* compressed_file(String const& path, Core::File& file, struct stat const& st)
+{
+    if (auto cached = s_compressed_files.find(path); cached != s_compressed_files.end()) {
+        auto& entry = cached->value;
+        if (entry.modification_time == st.st_mtime && entry.size == st.st_size)
+            return entry.data.has_value() ? &entry.data.value() : nullptr;
+        s_compressed_files_size -= entry.data.has_value() ? entry.data->size() : 0;
+        s_compressed_files.remove(cached);
+    }
+
+    if ((size_t)st.st_size < s_min_size_to_compress || (size_t)st.st_size > s_max_size_to_compress)
+        return nullptr;
+    auto contents = file.read_all();
+    if (contents.size() != (size_t)st.st_size)
+        return nullptr;
+    auto compressed = compress_if_worthwhile(contents);
+
+    auto compressed_size = compressed.has_value() ? compressed->size() : 0;
+    if (s_compressed_files_size + compressed_size > s_max_compressed_files_size) {
+        s_compressed_files.clear();
+        s_compressed_files_size = 0;
+    }
+    s_compressed_files_size += compressed_size;
+    s_compressed_files.set(path, { st.st_mtime, st.st_size, move(compressed) });
+    auto& entry = s_compressed_files.find(path)->value;
+    return entry.data.has_value() ? &entry.data.value() : nullptr;
+}
+
+// Whether the client's copy of the file is still the current one (RFC 7232, section 3).
+static bool is_not_modified(HTTP::HttpRequest const& request, String const& etag, time_t modification_time)
+{
+    // If-None-Match takes precedence over If-Modified-Since.
+    if (auto if_none_match = header_value(request, "If-None-Match"); if_none_match.has_value()) {
+        for (auto& tag : if_none_match->split_view(',')) {
+            auto trimmed_tag = tag.trim_whitespace();
+            // A GET only needs a weak comparison, so it doesn't matter if either tag is weak.
+            if (trimmed_tag.starts_with("W/"))
+                trimmed_tag = trimmed_tag.substring_view(2);
+            if (trimmed_tag == "*" || trimmed_tag == etag)
+                return true;
+        }
+        return false;
+    }
+    if (auto if_modified_since = header_value(request, "If-Modified-Since"); if_modified_since.has_value()) {
+        auto date = HTTP::parse_http_date(if_modified_since.value());
+        return date.has_value() && modification_time <= date.value();
+    }
+    return false;
 }
 
 void Client::handle_request(ReadonlyBytes raw_request)
 {
     auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
-    if (!request_or_error.has_value())
+    if (!request_or_error.has_value()) {
+        die();
         return;
+    }
     auto& request = request_or_error.value();
 
     if constexpr (WEBSERVER_DEBUG) {
@@ -75,7 +353,10 @@ void Client::handle_request(ReadonlyBytes raw_request)
         }
     }
 
-    if (request.method() != HTTP::HttpRequest::Method::GET) {
+    m_keep_alive = wants_keep_alive(request);
+
+    if (request.method() != HTTP::HttpRequest::Method::GET && request.method() != HTTP::HttpRequest::Method::HEAD) {
+        m_keep_alive = false;
         send_error_response(501, request);
         return;
     }
@@ -120,60 +401,119 @@ void Client::handle_request(ReadonlyBytes raw_request)
         real_path = index_html_path;
     }
 
+    send_file(real_path, request);
+}
+
+void Client::send_file(String const& real_path, HTTP::HttpRequest const& request)
+{
     auto file = Core::File::construct(real_path);
     if (!file->open(Core::OpenMode::ReadOnly)) {
         send_error_response(404, request);
         return;
     }
 
-    if (file->is_device()) {
+    struct stat st;
+    if (file->is_device() || fstat(file->fd(), &st) < 0 || !S_ISREG(st.st_mode)) {
         send_error_response(403, request);
         return;
     }
 
-    Core::InputFileStream stream { file };
+    auto content_type = Core::guess_mime_type_based_on_filename(real_path);
+    Vector<String> headers;
+    headers.append(String::formatted("Content-Type: {}", content_type));
+    headers.append("X-Frame-Options: SAMEORIGIN");
+    headers.append("X-Content-Type-Options: nosniff");
+    // Clients may keep the file, but have to ask us whether it's still current before using it.
+    headers.append("Cache-Control: no-cache");
+
+    // Prefer a compressed copy that's been put next to the file (e.g. "index.html.gz"), then one we make ourselves.
+    auto precompressed_file = Core::File::construct(String::formatted("{}.gz", real_path));
+    struct stat precompressed_st;
+    bool has_precompressed_file = precompressed_file->open(Core::OpenMode::ReadOnly)
+        && fstat(precompressed_file->fd(), &precompressed_st) == 0
+        && S_ISREG(precompressed_st.st_mode)
+        && precompressed_st.st_mtime >= st.st_mtime;
+
+    // The body, unless it's sent straight from the file.
+    Optional<ReadonlyBytes> body;
+    ByteBuffer file_contents;
+    String content_encoding_suffix;
+    if (has_precompressed_file || is_compressible(content_type)) {
+        headers.append("Vary: Accept-Encoding");
+        if (accepts_gzip(request)) {
+            if (has_precompressed_file) {
+                file = precompressed_file;
+                st = precompressed_st;
+                content_encoding_suffix = "-gzip";
+            } else if (auto* compressed = compressed_file(real_path, *file, st)) {
+                body = compressed->bytes();
+                content_encoding_suffix = "-gzip";
+            }
+        }
+    }
+    if (!content_encoding_suffix.is_empty())
+        headers.append("Content-Encoding: gzip");
+
+    // Files that don't know their size, like those in /proc, may still have contents.
+    if (!body.has_value() && st.st_size == 0) {
+        file_contents = file->read_all();
+        body = file_contents.bytes();
+    }
+
+    auto etag = String::formatted("\"{:x}-{:x}{}\"", st.st_mtime, st.st_size, content_encoding_suffix);
+    headers.append(String::formatted("ETag: {}", etag));
+    headers.append(String::formatted("Last-Modified: {}", HTTP::format_http_date(st.st_mtime)));
+
+    if (is_not_modified(request, etag, st.st_mtime)) {
+        send_response_headers(304, request, headers, {});
+        return;
+    }
+
+    if (body.has_value()) {
+        send_response(200, request, headers, body.value());
+        return;
+    }
 
-    send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path));
+    send_response_headers(200, request, headers, st.st_size);
+    if (request.method() == HTTP::HttpRequest::Method::HEAD)
+        return;
+    m_file_to_send = move(file);
+    m_file_offset = 0;
+    m_file_size = st.st_size;
 }
 
-void Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+void Client::send_response_headers(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers, Optional<u64> content_length)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n");
+    builder.appendff("HTTP/1.1 {} {}\r\n", code, HTTP::HttpResponse::reason_phrase_for_code(code));
     builder.append("Server: WebServer (SerenityOS)\r\n");
-    builder.append("X-Frame-Options: SAMEORIGIN\r\n");
-    builder.append("X-Content-Type-Options: nosniff\r\n");
-    builder.append("Pragma: no-cache\r\n");
-    builder.append("Content-Type: ");
-    builder.append(content_type);
-    builder.append("\r\n");
+    builder.appendff("Date: {}\r\n", HTTP::format_http_date(time(nullptr)));
+    for (auto& header : headers) {
+        builder.append(header);
+        builder.append("\r\n");
+    }
+    if (content_length.has_value())
+        builder.appendff("Content-Length: {}\r\n", content_length.value());
+    if (!m_keep_alive)
+        builder.append("Connection: close\r\n");
+    else if (request.protocol() != "HTTP/1.1")
+        builder.append("Connection: keep-alive\r\n");
     builder.append("\r\n");
 
-    m_socket->write(builder.to_string());
-    log_response(200, request);
-
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = response.read({ buffer, sizeof(buffer) });
-        if (response.unreliable_eof() && size == 0)
-            break;
+    m_send_buffer.append(builder.string_view().bytes());
+    log_response(code, request);
+}
 
-        m_socket->write({ buffer, size });
-    } while (true);
+void Client::send_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers, ReadonlyBytes body)
+{
+    send_response_headers(code, request, headers, body.size());
+    if (request.method() != HTTP::HttpRequest::Method::HEAD)
+        m_send_buffer.append(body);
 }
 
 void Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
 {
-    StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n");
-    builder.append("Location: ");
-    builder.append(redirect_path);
-    builder.append("\r\n");
-    builder.append("\r\n");
-
-    m_socket->write(builder.to_string());
-
-    log_response(301, request);
+    send_response(301, request, { String::formatted("Location: {}", redirect_path) }, {});
 }
 
 static String folder_image_data()
@@ -271,32 +611,29 @@ void Client::handle_directory_listing(String const& requested_path, String const
     builder.append("</body>\n");
     builder.append("</html>\n");
 
-    auto response = builder.to_string();
-    InputMemoryStream stream { response.bytes() };
-    send_response(stream, request, "text/html");
+    Vector<String> headers { "Content-Type: text/html", "Cache-Control: no-cache", "Vary: Accept-Encoding" };
+    auto body = builder.to_byte_buffer();
+    if (accepts_gzip(request)) {
+        if (auto compressed = compress_if_worthwhile(body); compressed.has_value()) {
+            headers.append("Content-Encoding: gzip");
+            body = compressed.release_value();
+        }
+    }
+    send_response(200, request, headers, body);
 }
 
 void Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
 {
     auto reason_phrase = HTTP::HttpResponse::reason_phrase_for_code(code);
     StringBuilder builder;
-    builder.appendff("HTTP/1.0 {} ", code);
-    builder.append(reason_phrase);
-    builder.append("\r\n");
-
-    for (auto& header : headers) {
-        builder.append(header);
-        builder.append("\r\n");
-    }
-
-    builder.append("\r\n");
     builder.append("<!DOCTYPE html><html><body><h1>");
     builder.appendff("{} ", code);
     builder.append(reason_phrase);
     builder.append("</h1></body></html>");
-    m_socket->write(builder.to_string());
 
-    log_response(code, request);
+    Vector<String> all_headers { "Content-Type: text/html" };
+    all_headers.extend(headers);
+    send_response(code, request, all_headers, builder.to_byte_buffer());
 }
 
 void Client::log_response(unsigned code, HTTP::HttpRequest const& request)
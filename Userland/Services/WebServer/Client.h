@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
+#include <LibCore/Forward.h>
 #include <LibCore/Object.h>
 #include <LibCore/TCPSocket.h>
 #include <LibHTTP/Forward.h>
@@ -21,16 +23,35 @@ public:
 private:
     Client(NonnullRefPtr<Core::TCPSocket>, Core::Object* parent);
 
+    void handle_buffered_requests();
     void handle_request(ReadonlyBytes);
-    void send_response(InputStream&, HTTP::HttpRequest const&, String const& content_type);
+    void send_file(String const& real_path, HTTP::HttpRequest const&);
+    void send_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers, ReadonlyBytes body);
+    void send_response_headers(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers, Optional<u64> content_length);
     void send_redirect(StringView redirect, HTTP::HttpRequest const&);
     void send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
+    void send_pending_data();
     void die();
     void log_response(unsigned code, HTTP::HttpRequest const&);
     void handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
     NonnullRefPtr<Core::TCPSocket> m_socket;
+    RefPtr<Core::Notifier> m_write_notifier;
+    RefPtr<Core::Timer> m_idle_timer;
+    ByteBuffer m_request_buffer;
+
+    // What's left of the response we're sending: the buffer (headers and small bodies) goes out first, then the file.
+    ByteBuffer m_send_buffer;
+    size_t m_send_buffer_offset { 0 };
+    RefPtr<Core::File> m_file_to_send;
+    off_t m_file_offset { 0 };
+    off_t m_file_size { 0 };
+
+    bool m_is_sending_response { false };
+    bool m_keep_alive { false };
+    bool m_has_received_eof { false };
+    bool m_is_dying { false };
 };
 
 }
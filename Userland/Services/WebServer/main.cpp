@@ -13,6 +13,7 @@
 #include <LibHTTP/HttpRequest.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <signal.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -58,6 +59,9 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    // A client closing its connection while we're sending it something shouldn't take the whole server down.
+    signal(SIGPIPE, SIG_IGN);
+
     if (pledge("stdio accept rpath inet unix", nullptr) < 0) {
         perror("pledge");
         return 1;
@@ -79,7 +83,8 @@ int main(int argc, char** argv)
         client->start();
     };
 
-    if (!server->listen(ipv4_address.value(), port)) {
+    // Browsers open several connections at once, and more than a handful of them shouldn't have to wait for a retry.
+    if (!server->listen(ipv4_address.value(), port, 64)) {
         warnln("Failed to listen on {}:{}", ipv4_address.value(), port);
         return 1;
     }
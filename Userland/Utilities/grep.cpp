@@ -6,15 +6,24 @@
 
 #include <AK/Assertions.h>
 #include <AK/ByteBuffer.h>
+#include <AK/MappedFile.h>
+#include <AK/MemMem.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
 #include <AK/ScopeGuard.h>
 #include <AK/String.h>
+#include <AK/StringBuilder.h>
 #include <AK/Utf8View.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
 #include <LibRegex/Regex.h>
+#include <LibThreading/Thread.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 enum class BinaryFileMode {
@@ -32,9 +41,232 @@ void fail(StringView format, Ts... args)
     abort();
 }
 
+struct SearchOptions {
+    bool invert_match { false };
+    BinaryFileMode binary_mode { BinaryFileMode::Binary };
+};
+
+// Prints the line, with what the pattern matched highlighted, if it should be selected.
+static bool print_line_if_selected(StringBuilder& output, Regex<PosixExtended>& re, StringView line, SearchOptions const& options, StringView filename, bool print_filename, bool is_binary)
+{
+    auto result = re.match(line, PosixFlags::Global);
+    if (!(result.success ^ options.invert_match))
+        return false;
+
+    if (is_binary && options.binary_mode == BinaryFileMode::Binary) {
+        output.appendff("binary file \x1B[34m{}\x1B[0m matches\n", filename);
+        return true;
+    }
+
+    if ((result.matches.size() || options.invert_match) && print_filename)
+        output.appendff("\x1B[34m{}:\x1B[0m", filename);
+
+    size_t last_printed_char_pos { 0 };
+    for (auto& match : result.matches) {
+        output.appendff("{}\x1B[32m{}\x1B[0m",
+            line.substring_view(last_printed_char_pos, match.global_offset - last_printed_char_pos),
+            match.view.to_string());
+        last_printed_char_pos = match.global_offset + match.view.length();
+    }
+    output.appendff("{}\n", line.substring_view(last_printed_char_pos));
+    return true;
+}
+
+// Searches the whole buffer for a substring that every match has to contain, and only splits the lines around those hits.
+static bool search_buffer(StringBuilder& output, Regex<PosixExtended>& re, StringView buffer, SearchOptions const& options, StringView filename, bool print_filename)
+{
+    auto is_binary = memchr(buffer.characters_without_null_termination(), 0, buffer.length()) != nullptr;
+    if (is_binary && options.binary_mode == BinaryFileMode::Skip)
+        return false;
+
+    auto const& literal = re.parser_result.optimization_data.literal_prefix;
+    auto find_literal = [&](size_t position) -> size_t {
+        auto offset = AK::memmem_optional(buffer.characters_without_null_termination() + position, buffer.length() - position, literal.characters(), literal.length());
+        return offset.has_value() ? position + offset.value() : buffer.length();
+    };
+
+    bool did_match = false;
+    size_t next_hit = 0;
+    size_t position = 0;
+    if (!literal.is_empty())
+        next_hit = find_literal(0);
+    while (position < buffer.length()) {
+        if (!literal.is_empty() && next_hit < position)
+            next_hit = find_literal(position);
+
+        if (!literal.is_empty() && !options.invert_match) {
+            // Lines before the next hit can't match, so there is no need to look for where they end.
+            if (next_hit == buffer.length())
+                break;
+            auto line_start = next_hit;
+            while (line_start > position && buffer[line_start - 1] != '\n')
+                --line_start;
+            position = line_start;
+        }
+
+        auto* newline = static_cast<char const*>(memchr(buffer.characters_without_null_termination() + position, '\n', buffer.length() - position));
+        auto line_end = newline ? newline - buffer.characters_without_null_termination() : buffer.length();
+        auto line = buffer.substring_view(position, line_end - position);
+
+        bool selected;
+        if (!literal.is_empty() && next_hit >= line_end) {
+            // The line doesn't contain the literal, so it doesn't match.
+            selected = options.invert_match;
+            if (selected) {
+                if (is_binary && options.binary_mode == BinaryFileMode::Binary)
+                    output.appendff("binary file \x1B[34m{}\x1B[0m matches\n", filename);
+                else if (print_filename)
+                    output.appendff("\x1B[34m{}:\x1B[0m{}\n", filename, line);
+                else
+                    output.appendff("{}\n", line);
+            }
+        } else {
+            selected = print_line_if_selected(output, re, line, options, filename, print_filename, is_binary);
+        }
+
+        did_match = did_match || selected;
+        if (selected && is_binary && options.binary_mode == BinaryFileMode::Binary)
+            return true;
+        position = line_end + 1;
+    }
+    return did_match;
+}
+
+static bool search_file(StringBuilder& output, Regex<PosixExtended>& re, String const& path, SearchOptions const& options, StringView filename, bool print_filename, bool& failed)
+{
+    struct stat st;
+    if (stat(path.characters(), &st) < 0) {
+        warnln("Failed to open {}: {}", filename, strerror(errno));
+        failed = true;
+        return false;
+    }
+
+    // Directories are only searched with -r.
+    if (S_ISDIR(st.st_mode))
+        return false;
+
+    if (S_ISREG(st.st_mode)) {
+        // Empty files can't be mapped, and have no lines to select either.
+        if (st.st_size == 0)
+            return false;
+
+        auto mapped_file = MappedFile::map(path);
+        if (mapped_file.is_error()) {
+            warnln("Failed to open {}: {}", filename, mapped_file.error());
+            failed = true;
+            return false;
+        }
+        auto bytes = mapped_file.value()->bytes();
+        return search_buffer(output, re, { bytes.data(), bytes.size() }, options, filename, print_filename);
+    }
+
+    // Pipes and devices can't be mapped.
+    auto file = Core::File::construct(path);
+    if (!file->open(Core::OpenMode::ReadOnly)) {
+        warnln("Failed to open {}: {}", filename, file->error_string());
+        failed = true;
+        return false;
+    }
+    auto contents = file->read_all();
+    return search_buffer(output, re, { contents.data(), contents.size() }, options, filename, print_filename);
+}
+
+// Files and directories still to be searched, shared by all the threads.
+class WorkQueue {
+public:
+    struct Job {
+        String path;
+        String filename;
+        bool is_directory { false };
+        // Files given on the command line are printed in the order they were given, the others as soon as they are searched.
+        // Directories given on the command line have an index as well, so the files after them don't wait for them forever.
+        Optional<size_t> output_index;
+    };
+
+    WorkQueue()
+    {
+        pthread_mutex_init(&m_mutex, nullptr);
+        pthread_cond_init(&m_condition, nullptr);
+    }
+
+    ~WorkQueue()
+    {
+        pthread_cond_destroy(&m_condition);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    void add(Job job)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_jobs.append(move(job));
+        ++m_unfinished_job_count;
+        pthread_cond_signal(&m_condition);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    // Blocks until there is a job, or returns nothing once all of them are done.
+    Optional<Job> take()
+    {
+        pthread_mutex_lock(&m_mutex);
+        while (m_jobs.is_empty() && m_unfinished_job_count > 0)
+            pthread_cond_wait(&m_condition, &m_mutex);
+        Optional<Job> job;
+        if (!m_jobs.is_empty())
+            job = m_jobs.take_last();
+        pthread_mutex_unlock(&m_mutex);
+        return job;
+    }
+
+    // Must be called once for every job that was taken, after the jobs it added.
+    void finish()
+    {
+        pthread_mutex_lock(&m_mutex);
+        if (--m_unfinished_job_count == 0)
+            pthread_cond_broadcast(&m_condition);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void print(Optional<size_t> output_index, String output)
+    {
+        pthread_mutex_lock(&m_mutex);
+        if (!output_index.has_value()) {
+            out("{}", output);
+        } else {
+            if (m_ordered_outputs.size() <= *output_index)
+                m_ordered_outputs.resize(*output_index + 1);
+            m_ordered_outputs[*output_index] = move(output);
+            for (; m_next_ordered_output < m_ordered_outputs.size() && m_ordered_outputs[m_next_ordered_output].has_value(); ++m_next_ordered_output) {
+                out("{}", *m_ordered_outputs[m_next_ordered_output]);
+                m_ordered_outputs[m_next_ordered_output] = String::empty();
+            }
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    // Prints whatever ordered output is still waiting for the output before it, once all jobs are done.
+    void flush()
+    {
+        pthread_mutex_lock(&m_mutex);
+        for (; m_next_ordered_output < m_ordered_outputs.size(); ++m_next_ordered_output) {
+            if (m_ordered_outputs[m_next_ordered_output].has_value())
+                out("{}", *m_ordered_outputs[m_next_ordered_output]);
+        }
+        m_ordered_outputs.clear();
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+private:
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_condition;
+    Vector<Job> m_jobs;
+    size_t m_unfinished_job_count { 0 };
+    Vector<Optional<String>> m_ordered_outputs;
+    size_t m_next_ordered_output { 0 };
+};
+
 int main(int argc, char** argv)
 {
-    if (pledge("stdio rpath", nullptr) < 0) {
+    if (pledge("stdio rpath thread", nullptr) < 0) {
         perror("pledge");
         return 1;
     }
@@ -47,9 +279,10 @@ int main(int argc, char** argv)
     BinaryFileMode binary_mode { BinaryFileMode::Binary };
     bool case_insensitive = false;
     bool invert_match = false;
+    int thread_count = max<long>(sysconf(_SC_NPROCESSORS_ONLN), 1);
 
     Core::ArgsParser args_parser;
-    args_parser.add_option(recursive, "Recursively scan files starting in working directory", "recursive", 'r');
+    args_parser.add_option(recursive, "Recursively scan the given directories, or the working directory", "recursive", 'r');
     args_parser.add_option(use_ere, "Extended regular expressions (default)", "extended-regexp", 'E');
     args_parser.add_option(pattern, "Pattern", "regexp", 'e', "Pattern");
     args_parser.add_option(case_insensitive, "Make matches case-insensitive", nullptr, 'i');
@@ -90,6 +323,7 @@ int main(int argc, char** argv)
             return true;
         },
     });
+    args_parser.add_option(thread_count, "Number of threads to search files with (default: number of CPUs)", "jobs", 'j', "count");
     args_parser.add_positional_argument(files, "File(s) to process", "file", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
@@ -109,65 +343,7 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    auto matches = [&](StringView str, StringView filename = "", bool print_filename = false, bool is_binary = false) {
-        size_t last_printed_char_pos { 0 };
-        if (is_binary && binary_mode == BinaryFileMode::Skip)
-            return false;
-
-        auto result = re.match(str, PosixFlags::Global);
-        if (result.success ^ invert_match) {
-            if (is_binary && binary_mode == BinaryFileMode::Binary) {
-                outln("binary file \x1B[34m{}\x1B[0m matches", filename);
-            } else {
-                if ((result.matches.size() || invert_match) && print_filename) {
-                    out("\x1B[34m{}:\x1B[0m", filename);
-                }
-
-                for (auto& match : result.matches) {
-
-                    out("{}\x1B[32m{}\x1B[0m",
-                        StringView(&str[last_printed_char_pos], match.global_offset - last_printed_char_pos),
-                        match.view.to_string());
-                    last_printed_char_pos = match.global_offset + match.view.length();
-                }
-                outln("{}", StringView(&str[last_printed_char_pos], str.length() - last_printed_char_pos));
-            }
-
-            return true;
-        }
-
-        return false;
-    };
-
-    auto handle_file = [&matches, binary_mode](StringView filename, bool print_filename) -> bool {
-        auto file = Core::File::construct(filename);
-        if (!file->open(Core::OpenMode::ReadOnly)) {
-            warnln("Failed to open {}: {}", filename, file->error_string());
-            return false;
-        }
-
-        while (file->can_read_line()) {
-            auto line = file->read_line();
-            auto is_binary = memchr(line.characters(), 0, line.length()) != nullptr;
-
-            if (matches(line, filename, print_filename, is_binary) && is_binary && binary_mode == BinaryFileMode::Binary)
-                return true;
-        }
-        return true;
-    };
-
-    auto add_directory = [&handle_file](String base, Optional<String> recursive, auto handle_directory) -> void {
-        Core::DirIterator it(recursive.value_or(base), Core::DirIterator::Flags::SkipDots);
-        while (it.has_next()) {
-            auto path = it.next_full_path();
-            if (!Core::File::is_directory(path)) {
-                auto key = path.substring_view(base.length() + 1, path.length() - base.length() - 1);
-                handle_file(key, true);
-            } else {
-                handle_directory(base, path, handle_directory);
-            }
-        }
-    };
+    SearchOptions search_options { invert_match, binary_mode };
 
     bool did_match_something = false;
     if (!files.size() && !recursive) {
@@ -185,22 +361,74 @@ int main(int argc, char** argv)
             if (is_binary && binary_mode == BinaryFileMode::Skip)
                 return 1;
 
-            auto matched = matches(line_view, "stdin", false, is_binary);
+            StringBuilder output;
+            auto matched = print_line_if_selected(output, re, line_view, search_options, "stdin", false, is_binary);
+            out("{}", output.string_view());
             did_match_something = did_match_something || matched;
             if (matched && is_binary && binary_mode == BinaryFileMode::Binary)
                 return 0;
         }
     } else {
-        if (recursive) {
-            add_directory(".", {}, add_directory);
-
+        WorkQueue queue;
+        if (recursive && files.is_empty()) {
+            queue.add({ ".", "", true, {} });
         } else {
-            bool print_filename { files.size() > 1 };
-            for (auto& filename : files) {
-                if (!handle_file(filename, print_filename))
-                    return 1;
+            for (size_t i = 0; i < files.size(); ++i) {
+                bool is_directory = recursive && Core::File::is_directory(files[i]);
+                queue.add({ files[i], files[i], is_directory, i });
             }
         }
+        bool print_filename = recursive || files.size() > 1;
+
+        Atomic<bool> did_match { false };
+        Atomic<bool> did_fail { false };
+        auto search = [&]() -> intptr_t {
+            // The matcher keeps caches around, so every thread needs a regex of its own.
+            Regex<PosixExtended> regex(pattern, options);
+            for (;;) {
+                auto job = queue.take();
+                if (!job.has_value())
+                    break;
+                if (job->is_directory) {
+                    Core::DirIterator it(job->path, Core::DirIterator::Flags::SkipDots);
+                    while (it.has_next()) {
+                        auto name = it.next_path();
+                        auto path = String::formatted("{}/{}", job->path, name);
+                        // Paths below the working directory are printed without the leading "./".
+                        auto filename = job->filename.is_empty() ? name : String::formatted("{}/{}", job->filename, name);
+                        queue.add({ path, move(filename), Core::File::is_directory(path), {} });
+                    }
+                    // The files in the directory are printed as they are searched, so it has no output of its own.
+                    if (job->output_index.has_value())
+                        queue.print(job->output_index, String::empty());
+                } else {
+                    StringBuilder output;
+                    bool failed = false;
+                    if (search_file(output, regex, job->path, search_options, job->filename, print_filename, failed))
+                        did_match = true;
+                    if (failed)
+                        did_fail = true;
+                    queue.print(job->output_index, output.build());
+                }
+                queue.finish();
+            }
+            return 0;
+        };
+
+        NonnullRefPtrVector<Threading::Thread> threads;
+        for (int i = 1; i < thread_count; ++i) {
+            auto thread = Threading::Thread::construct([&] { return search(); });
+            thread->start();
+            threads.append(move(thread));
+        }
+        search();
+        for (auto& thread : threads)
+            (void)thread.join();
+        queue.flush();
+
+        if (did_fail)
+            return 1;
+        did_match_something = did_match;
     }
 
     return did_match_something ? 0 : 1;
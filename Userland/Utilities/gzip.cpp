@@ -4,21 +4,70 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/MappedFile.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <LibCompress/Gzip.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/FileStream.h>
+#include <LibThreading/Thread.h>
 #include <unistd.h>
 
+// Concatenated gzip members are a valid gzip file too (RFC 1952, section 2.2), so we split large inputs into
+// chunks and compress them as separate members at the same time. This costs some compression ratio, as
+// matches can't reach across chunk boundaries.
+static constexpr size_t parallel_chunk_size = 1 * MiB;
+
+static Optional<ByteBuffer> compress_in_parallel(ReadonlyBytes input, size_t thread_count)
+{
+    auto chunk_count = (input.size() + parallel_chunk_size - 1) / parallel_chunk_size;
+    thread_count = min(thread_count, chunk_count);
+    if (thread_count <= 1)
+        return Compress::GzipCompressor::compress_all(input);
+
+    Vector<Optional<ByteBuffer>> compressed_chunks;
+    compressed_chunks.resize(chunk_count);
+    Atomic<size_t> next_chunk { 0 };
+
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto thread = Threading::Thread::construct([&]() -> intptr_t {
+            for (;;) {
+                auto chunk = next_chunk.fetch_add(1);
+                if (chunk >= chunk_count)
+                    return 0;
+                auto offset = chunk * parallel_chunk_size;
+                compressed_chunks[chunk] = Compress::GzipCompressor::compress_all(input.slice(offset, min(parallel_chunk_size, input.size() - offset)));
+            }
+        },
+            "gzip");
+        thread->start();
+        threads.append(move(thread));
+    }
+
+    for (auto& thread : threads)
+        (void)thread.join();
+
+    ByteBuffer output;
+    for (auto& compressed_chunk : compressed_chunks) {
+        if (!compressed_chunk.has_value())
+            return {};
+        output.append(compressed_chunk.value().bytes());
+    }
+    return output;
+}
+
 int main(int argc, char** argv)
 {
     Vector<String> filenames;
     bool keep_input_files { false };
     bool write_to_stdout { false };
+    int thread_count = max<long>(sysconf(_SC_NPROCESSORS_ONLN), 1);
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
+    args_parser.add_option(thread_count, "Number of threads to compress with (default: number of CPUs)", "jobs", 'j', "count");
     args_parser.add_positional_argument(filenames, "File to compress", "FILE");
     args_parser.parse(argc, argv);
 
@@ -37,7 +86,7 @@ int main(int argc, char** argv)
         }
         auto file = file_or_error.value();
 
-        auto compressed_file = Compress::GzipCompressor::compress_all(file->bytes());
+        auto compressed_file = compress_in_parallel(file->bytes(), max(thread_count, 1));
         if (!compressed_file.has_value()) {
             warnln("Failed gzip compressing input file");
             return 1;
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/QuickSort.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Keeps a number of connections busy requesting the same URL over and over, and reports how many requests per second
+// the server managed to answer.
+
+static u64 microseconds_now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1'000'000 + now.tv_nsec / 1000;
+}
+
+struct Connection {
+    int fd { -1 };
+    ByteBuffer header;
+    // Set once we've got the whole header.
+    Optional<unsigned> status_code;
+    Optional<size_t> content_length;
+    size_t body_received { 0 };
+    bool server_closes_connection { false };
+    u64 request_start_time { 0 };
+};
+
+struct Statistics {
+    u64 successful_requests { 0 };
+    u64 failed_requests { 0 };
+    u64 connections_opened { 0 };
+    u64 bytes_received { 0 };
+    Vector<u32> latencies_us;
+};
+
+static bool open_connection(Connection& connection, sockaddr_in const& address, Statistics& statistics)
+{
+    connection.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connection.fd < 0) {
+        perror("socket");
+        return false;
+    }
+    if (connect(connection.fd, (sockaddr const*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        close(connection.fd);
+        connection.fd = -1;
+        return false;
+    }
+    ++statistics.connections_opened;
+    return true;
+}
+
+static void close_connection(Connection& connection)
+{
+    if (connection.fd >= 0)
+        close(connection.fd);
+    connection.fd = -1;
+}
+
+static bool send_request(Connection& connection, ByteBuffer const& request)
+{
+    connection.header.clear();
+    connection.status_code = {};
+    connection.content_length = {};
+    connection.body_received = 0;
+    connection.server_closes_connection = false;
+    connection.request_start_time = microseconds_now();
+
+    size_t offset = 0;
+    while (offset < request.size()) {
+        auto nwritten = write(connection.fd, request.data() + offset, request.size() - offset);
+        if (nwritten <= 0)
+            return false;
+        offset += nwritten;
+    }
+    return true;
+}
+
+// Returns how many bytes at the start of `data` belonged to the header, once it's complete.
+static Optional<size_t> parse_header(Connection& connection, ReadonlyBytes data)
+{
+    size_t old_size = connection.header.size();
+    connection.header.append(data);
+    auto header = StringView { connection.header.data(), connection.header.size() };
+    auto end_of_header = header.find("\r\n\r\n");
+    if (!end_of_header.has_value())
+        return {};
+
+    auto lines = header.substring_view(0, end_of_header.value()).lines();
+    if (lines.is_empty())
+        return 0;
+    auto status_line = lines[0].split_view(' ');
+    connection.status_code = status_line.size() >= 2 ? status_line[1].to_uint().value_or(0) : 0;
+    for (size_t i = 1; i < lines.size(); ++i) {
+        auto colon = lines[i].find(':');
+        if (!colon.has_value())
+            continue;
+        auto name = lines[i].substring_view(0, colon.value());
+        auto value = lines[i].substring_view(colon.value() + 1).trim_whitespace();
+        if (name.equals_ignoring_case("Content-Length")) {
+            if (auto length = value.to_uint(); length.has_value())
+                connection.content_length = length.value();
+        } else if (name.equals_ignoring_case("Connection") && value.equals_ignoring_case("close")) {
+            connection.server_closes_connection = true;
+        }
+    }
+    // These never have a body, whatever they say about its length.
+    if (connection.status_code.value() == 304 || connection.status_code.value() == 204)
+        connection.content_length = 0;
+
+    return end_of_header.value() + 4 - old_size;
+}
+
+int main(int argc, char** argv)
+{
+    const char* url_string = nullptr;
+    int connection_count = 8;
+    int duration_in_seconds = 10;
+    bool close_after_each_request = false;
+    Vector<String> extra_headers;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure how many requests per second an HTTP server can answer.");
+    args_parser.add_option(connection_count, "Number of connections to keep busy (default: 8)", "connections", 'c', "count");
+    args_parser.add_option(duration_in_seconds, "How long to run for (default: 10)", "duration", 'd', "seconds");
+    args_parser.add_option(close_after_each_request, "Open a new connection for each request", "close", 'C');
+    args_parser.add_option(Core::ArgsParser::Option {
+        .requires_argument = true,
+        .help_string = "Add a header to each request, e.g. \"Accept-Encoding: gzip\"",
+        .long_name = "header",
+        .short_name = 'H',
+        .value_name = "header",
+        .accept_value = [&](auto* value) {
+            extra_headers.append(value);
+            return true;
+        },
+    });
+    args_parser.add_positional_argument(url_string, "URL to request, e.g. http://localhost:8000/", "url");
+    args_parser.parse(argc, argv);
+
+    URL url(url_string);
+    if (!url.is_valid() || url.scheme() != "http") {
+        warnln("Invalid URL: '{}' (only http:// is supported)", url_string);
+        return 1;
+    }
+    if (connection_count <= 0 || duration_in_seconds <= 0) {
+        warnln("The number of connections and the duration have to be positive");
+        return 1;
+    }
+
+    if (pledge("stdio inet unix", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
+    auto* hostent = gethostbyname(url.host().characters());
+    if (!hostent) {
+        warnln("Lookup failed for '{}'", url.host());
+        return 1;
+    }
+
+    if (pledge("stdio inet", nullptr) < 0) {
+        perror("pledge");
+        return 1;
+    }
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(url.port());
+    address.sin_addr.s_addr = *(const in_addr_t*)hostent->h_addr_list[0];
+
+    StringBuilder request_builder;
+    request_builder.appendff("GET {}", url.path());
+    if (!url.query().is_empty())
+        request_builder.appendff("?{}", url.query());
+    request_builder.append(" HTTP/1.1\r\n");
+    request_builder.appendff("Host: {}\r\n", url.host());
+    request_builder.append("User-Agent: http_benchmark (SerenityOS)\r\n");
+    for (auto& header : extra_headers)
+        request_builder.appendff("{}\r\n", header);
+    if (close_after_each_request)
+        request_builder.append("Connection: close\r\n");
+    request_builder.append("\r\n");
+    auto request = request_builder.to_byte_buffer();
+
+    outln("Requesting {} over {} connection(s) for {} second(s)...", url, connection_count, duration_in_seconds);
+
+    Statistics statistics;
+    NonnullOwnPtrVector<Connection> connections;
+    for (int i = 0; i < connection_count; ++i) {
+        auto connection = make<Connection>();
+        if (!open_connection(*connection, address, statistics) || !send_request(*connection, request)) {
+            warnln("Failed to connect to {}:{}", url.host(), url.port());
+            return 1;
+        }
+        connections.append(move(connection));
+    }
+
+    auto start_time = microseconds_now();
+    auto end_time = start_time + (u64)duration_in_seconds * 1'000'000;
+
+    // Starts the next request on a connection, on a new one if the server won't take any more requests on this one.
+    auto next_request = [&](Connection& connection, bool can_reuse) {
+        if (!can_reuse) {
+            close_connection(connection);
+            if (!open_connection(connection, address, statistics))
+                return;
+        }
+        if (!send_request(connection, request)) {
+            ++statistics.failed_requests;
+            close_connection(connection);
+        }
+    };
+
+    auto did_finish_response = [&](Connection& connection) {
+        auto status_code = connection.status_code.value_or(0);
+        if (status_code >= 200 && status_code < 400) {
+            ++statistics.successful_requests;
+            statistics.latencies_us.append(microseconds_now() - connection.request_start_time);
+        } else {
+            ++statistics.failed_requests;
+        }
+    };
+
+    Vector<pollfd> poll_fds;
+    u8 buffer[64 * KiB];
+    while (microseconds_now() < end_time) {
+        poll_fds.clear();
+        for (auto& connection : connections) {
+            if (connection.fd < 0)
+                next_request(connection, false);
+            poll_fds.append({ connection.fd, POLLIN, 0 });
+        }
+
+        int rc = poll(poll_fds.data(), poll_fds.size(), 100);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            return 1;
+        }
+
+        for (size_t i = 0; i < connections.size(); ++i) {
+            if (!(poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            auto& connection = connections[i];
+            auto nread = read(connection.fd, buffer, sizeof(buffer));
+            if (nread <= 0) {
+                // Without a Content-Length, the response ends when the server closes the connection.
+                if (nread == 0 && connection.status_code.has_value() && !connection.content_length.has_value())
+                    did_finish_response(connection);
+                else
+                    ++statistics.failed_requests;
+                close_connection(connection);
+                continue;
+            }
+            statistics.bytes_received += nread;
+
+            ReadonlyBytes data { buffer, (size_t)nread };
+            if (!connection.status_code.has_value()) {
+                auto header_size = parse_header(connection, data);
+                if (!header_size.has_value())
+                    continue;
+                data = data.slice(header_size.value());
+            }
+            connection.body_received += data.size();
+            if (!connection.content_length.has_value() || connection.body_received < connection.content_length.value())
+                continue;
+
+            // We don't pipeline requests, so there shouldn't be anything after the response.
+            bool can_reuse = !connection.server_closes_connection && connection.body_received == connection.content_length.value();
+            did_finish_response(connection);
+            next_request(connection, can_reuse);
+        }
+    }
+
+    auto elapsed_seconds = (microseconds_now() - start_time) / 1'000'000.0;
+    for (auto& connection : connections)
+        close_connection(connection);
+
+    outln("{} requests in {:.2} seconds, {} failed, {} connection(s) opened", statistics.successful_requests, elapsed_seconds, statistics.failed_requests, statistics.connections_opened);
+    outln("Requests per second: {:.1}", statistics.successful_requests / elapsed_seconds);
+    outln("Transfer rate: {:.1} KiB/s", statistics.bytes_received / elapsed_seconds / KiB);
+
+    if (!statistics.latencies_us.is_empty()) {
+        auto& latencies = statistics.latencies_us;
+        quick_sort(latencies);
+        u64 total = 0;
+        for (auto latency : latencies)
+            total += latency;
+        auto percentile = [&](size_t percent) { return latencies[min(latencies.size() - 1, latencies.size() * percent / 100)] / 1000.0; };
+        outln("Latency (ms): average {:.2}, median {:.2}, 99th percentile {:.2}, max {:.2}", total / latencies.size() / 1000.0, percentile(50), percentile(99), latencies.last() / 1000.0);
+    }
+
+    return 0;
+}
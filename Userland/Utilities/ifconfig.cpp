@@ -60,6 +60,7 @@ int main(int argc, char** argv)
             auto bytes_in = if_object.get("bytes_in").to_u32();
             auto packets_out = if_object.get("packets_out").to_u32();
             auto bytes_out = if_object.get("bytes_out").to_u32();
+            auto packets_dropped = if_object.get("packets_dropped").to_u32();
             auto mtu = if_object.get("mtu").to_u32();
 
             outln("{}:", name);
@@ -68,7 +69,7 @@ int main(int argc, char** argv)
             outln("\tnetmask: {}", netmask);
             outln("\tgateway: {}", gateway);
             outln("\tclass: {}", class_name);
-            outln("\tRX: {} packets {} bytes ({})", packets_in, bytes_in, human_readable_size(bytes_in));
+            outln("\tRX: {} packets {} bytes ({}) {} dropped", packets_in, bytes_in, human_readable_size(bytes_in), packets_dropped);
             outln("\tTX: {} packets {} bytes ({})", packets_out, bytes_out, human_readable_size(bytes_out));
             outln("\tMTU: {}", mtu);
             outln();
@@ -346,7 +346,7 @@ static void print_promise(const JS::Object& object, HashTable<JS::Object*>& seen
 static void print_array_buffer(const JS::Object& object, HashTable<JS::Object*>& seen_objects)
 {
     auto& array_buffer = static_cast<const JS::ArrayBuffer&>(object);
-    auto& buffer = array_buffer.buffer();
+    auto buffer = array_buffer.buffer();
     auto byte_length = array_buffer.byte_length();
     print_type("ArrayBuffer");
     out("\n  byteLength: ");
@@ -16,7 +16,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -175,6 +177,10 @@ int main(int argc, char** argv)
     bool stdin_closed = false;
     bool fd_closed = false;
 
+    // When stdin is a file (e.g. `nc host port < file`), the kernel can send it without us copying it around.
+    struct stat stdin_stat;
+    bool stdin_is_file = fstat(STDIN_FILENO, &stdin_stat) == 0 && S_ISREG(stdin_stat.st_mode);
+
     fd_set readfds, writefds, exceptfds;
 
     while (!stdin_closed || !fd_closed) {
@@ -205,11 +211,24 @@ int main(int argc, char** argv)
         }
 
         if (!stdin_closed && FD_ISSET(STDIN_FILENO, &readfds)) {
-            char buf[1024];
-            int nread = read(STDIN_FILENO, buf, sizeof(buf));
-            if (nread < 0) {
-                perror("read(STDIN_FILENO)");
-                return 1;
+            ssize_t nread;
+            if (stdin_is_file) {
+                nread = sendfile(fd, STDIN_FILENO, nullptr, 64 * KiB);
+                if (nread < 0) {
+                    perror("sendfile");
+                    return 1;
+                }
+            } else {
+                char buf[1024];
+                nread = read(STDIN_FILENO, buf, sizeof(buf));
+                if (nread < 0) {
+                    perror("read(STDIN_FILENO)");
+                    return 1;
+                }
+                if (nread > 0 && write(fd, buf, nread) < 0) {
+                    perror("write(fd)");
+                    return 1;
+                }
             }
 
             // stdin closed
@@ -221,9 +240,6 @@ int main(int argc, char** argv)
                     close(fd);
                     fd_closed = true;
                 }
-            } else if (write(fd, buf, nread) < 0) {
-                perror("write(fd)");
-                return 1;
             }
         }
 
@@ -125,7 +125,7 @@ static bool pre_interpret_hook(Wasm::Configuration& config, Wasm::InstructionPoi
                     warnln("invalid memory index {} (not found)", args[2]);
                     continue;
                 }
-                warnln("{:>32hex-dump}", mem->data().bytes());
+                warnln("{:>32hex-dump}", mem->data());
                 continue;
             }
             if (what.is_one_of("i", "instr", "instruction")) {
@@ -276,6 +276,7 @@ int main(int argc, char* argv[])
     String exported_function_to_execute;
     Vector<u64> values_to_push;
     Vector<String> modules_to_link_in;
+    auto engine = Wasm::ExecutionEngine::Interpreter;
 
     Core::ArgsParser parser;
     parser.add_positional_argument(filename, "File name to parse", "file");
@@ -313,6 +314,24 @@ int main(int argc, char* argv[])
             return false;
         },
     });
+    parser.add_option(Core::ArgsParser::Option {
+        .requires_argument = true,
+        .help_string = "Select how functions are executed (default=interpreter)",
+        .long_name = "engine",
+        .short_name = 0,
+        .value_name = "interpreter|ir|native",
+        .accept_value = [&](char const* str) {
+            if (StringView { str } == "interpreter"sv)
+                engine = Wasm::ExecutionEngine::Interpreter;
+            else if (StringView { str } == "ir"sv)
+                engine = Wasm::ExecutionEngine::IRInterpreter;
+            else if (StringView { str } == "native"sv)
+                engine = Wasm::ExecutionEngine::NativeCompiler;
+            else
+                return false;
+            return true;
+        },
+    });
     parser.parse(argc, argv);
 
     if (shell_mode) {
@@ -320,6 +339,11 @@ int main(int argc, char* argv[])
         attempt_instantiate = true;
     }
 
+    if (debug && engine != Wasm::ExecutionEngine::Interpreter) {
+        warnln("The debugger can only be used with the interpreter");
+        return 1;
+    }
+
     if (!shell_mode && debug && exported_function_to_execute.is_empty()) {
         warnln("Debug what? (pass -e fn)");
         return 1;
@@ -344,6 +368,7 @@ int main(int argc, char* argv[])
 
     if (attempt_instantiate) {
         Wasm::AbstractMachine machine;
+        machine.set_execution_engine(engine);
         Core::EventLoop main_loop;
         if (debug) {
             g_line_editor = Line::Editor::construct();
@@ -507,13 +532,15 @@ int main(int argc, char* argv[])
                 outln();
             }
 
-            auto result = machine.invoke(g_interpreter, run_address.value(), move(values));
+            auto result = debug ? machine.invoke(g_interpreter, run_address.value(), move(values)) : machine.invoke(run_address.value(), move(values));
 
             if (debug)
                 launch_repl();
 
-            if (result.is_trap())
-                warnln("Execution trapped!");
+            if (result.is_trap()) {
+                warnln("Execution trapped: {}", result.trap().reason);
+                return 1;
+            }
             if (!result.values().is_empty())
                 warnln("Returned:");
             for (auto& value : result.values()) {
@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/LexicalPath.h>
+#include <AK/NonnullRefPtrVector.h>
 #include <LibArchive/Zip.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/ArgsParser.h>
@@ -12,6 +14,50 @@
 #include <LibCore/File.h>
 #include <LibCore/FileStream.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/Thread.h>
+#include <unistd.h>
+
+struct PendingFile {
+    String path;
+    ByteBuffer file_buffer;
+    Optional<ByteBuffer> deflate_buffer;
+    u32 crc32 { 0 };
+};
+
+// Files are read on the main thread, and then compressed in batches using all threads. Their
+// members are added in the original order once the whole batch is done.
+static constexpr size_t max_batch_size = 64 * MiB;
+
+static void compress_in_parallel(Vector<PendingFile>& files, size_t thread_count)
+{
+    Atomic<size_t> next_file { 0 };
+    auto compress_files = [&]() -> intptr_t {
+        for (;;) {
+            auto index = next_file.fetch_add(1);
+            if (index >= files.size())
+                return 0;
+            auto& file = files[index];
+            file.deflate_buffer = Compress::DeflateCompressor::compress_all(file.file_buffer);
+            file.crc32 = Crypto::Checksum::CRC32 { file.file_buffer.bytes() }.digest();
+        }
+    };
+
+    thread_count = min(thread_count, files.size());
+    if (thread_count <= 1) {
+        compress_files();
+        return;
+    }
+
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto thread = Threading::Thread::construct([&] { return compress_files(); }, "zip");
+        thread->start();
+        threads.append(move(thread));
+    }
+
+    for (auto& thread : threads)
+        (void)thread.join();
+}
 
 int main(int argc, char** argv)
 {
@@ -19,12 +65,14 @@ int main(int argc, char** argv)
     Vector<String> source_paths;
     bool recurse = false;
     bool force = false;
+    int thread_count = max<long>(sysconf(_SC_NPROCESSORS_ONLN), 1);
 
     Core::ArgsParser args_parser;
     args_parser.add_positional_argument(zip_path, "Zip file path", "zipfile", Core::ArgsParser::Required::Yes);
     args_parser.add_positional_argument(source_paths, "Input files to be archived", "files", Core::ArgsParser::Required::Yes);
     args_parser.add_option(recurse, "Travel the directory structure recursively", "recurse-paths", 'r');
     args_parser.add_option(force, "Overwrite existing zip file", "force", 'f');
+    args_parser.add_option(thread_count, "Number of threads to compress with (default: number of CPUs)", "jobs", 'j', "count");
     args_parser.parse(argc, argv);
 
     String zip_file_path { zip_path };
@@ -48,6 +96,36 @@ int main(int argc, char** argv)
     auto file_stream = file_stream_or_error.value();
     Archive::ZipOutputStream zip_stream { file_stream };
 
+    Vector<PendingFile> pending_files;
+    size_t pending_size = 0;
+
+    auto flush_pending_files = [&] {
+        compress_in_parallel(pending_files, max(thread_count, 1));
+
+        for (auto& file : pending_files) {
+            Archive::ZipMember member {};
+            member.name = file.path;
+
+            if (file.deflate_buffer.has_value() && file.deflate_buffer.value().size() < file.file_buffer.size()) {
+                member.compressed_data = file.deflate_buffer.value().bytes();
+                member.compression_method = Archive::ZipCompressionMethod::Deflate;
+                auto compression_ratio = (double)file.deflate_buffer.value().size() / file.file_buffer.size();
+                outln("  adding: {} (deflated {}%)", file.path, (int)(compression_ratio * 100));
+            } else {
+                member.compressed_data = file.file_buffer.bytes();
+                member.compression_method = Archive::ZipCompressionMethod::Store;
+                outln("  adding: {} (stored 0%)", file.path);
+            }
+            member.uncompressed_size = file.file_buffer.size();
+            member.crc32 = file.crc32;
+            member.is_directory = false;
+            zip_stream.add_member(member);
+        }
+
+        pending_files.clear();
+        pending_size = 0;
+    };
+
     auto add_file = [&](String path) {
         auto file = Core::File::construct(path);
         if (!file->open(Core::OpenMode::ReadOnly)) {
@@ -55,30 +133,17 @@ int main(int argc, char** argv)
             return;
         }
 
-        auto canonicalized_path = LexicalPath::canonicalized_path(path);
         auto file_buffer = file->read_all();
-        Archive::ZipMember member {};
-        member.name = canonicalized_path;
+        pending_size += file_buffer.size();
+        pending_files.append({ LexicalPath::canonicalized_path(path), move(file_buffer), {}, 0 });
 
-        auto deflate_buffer = Compress::DeflateCompressor::compress_all(file_buffer);
-        if (deflate_buffer.has_value() && deflate_buffer.value().size() < file_buffer.size()) {
-            member.compressed_data = deflate_buffer.value().bytes();
-            member.compression_method = Archive::ZipCompressionMethod::Deflate;
-            auto compression_ratio = (double)deflate_buffer.value().size() / file_buffer.size();
-            outln("  adding: {} (deflated {}%)", canonicalized_path, (int)(compression_ratio * 100));
-        } else {
-            member.compressed_data = file_buffer.bytes();
-            member.compression_method = Archive::ZipCompressionMethod::Store;
-            outln("  adding: {} (stored 0%)", canonicalized_path);
-        }
-        member.uncompressed_size = file_buffer.size();
-        Crypto::Checksum::CRC32 checksum { file_buffer.bytes() };
-        member.crc32 = checksum.digest();
-        member.is_directory = false;
-        zip_stream.add_member(member);
+        if (pending_size >= max_batch_size)
+            flush_pending_files();
     };
 
     auto add_directory = [&](String path, auto handle_directory) -> void {
+        flush_pending_files();
+
         auto canonicalized_path = String::formatted("{}/", LexicalPath::canonicalized_path(path));
         Archive::ZipMember member {};
         member.name = canonicalized_path;
@@ -112,6 +177,7 @@ int main(int argc, char** argv)
         }
     }
 
+    flush_pending_files();
     zip_stream.finish();
 
     return 0;